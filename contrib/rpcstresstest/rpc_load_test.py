@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The Gridcoin developers
+# Distributed under the MIT/X11 software license, see the accompanying
+# file COPYING or https://opensource.org/licenses/mit-license.php.
+"""Loopback load test for the JSON-RPC server.
+
+Opens a number of keep-alive connections to a running wallet and sends one RPC
+method on each connection as fast as the server answers for a fixed duration.
+Reports the throughput, the latency percentiles and the number of requests
+that the server rejected because its work queue was full (HTTP 503).
+
+Example:
+
+    ./rpc_load_test.py --rpcuser=user --rpcpassword=pass --testnet \\
+        --connections=64 --duration=30 getblockcount
+"""
+
+import argparse
+import asyncio
+import base64
+import json
+import time
+
+MAINNET_RPC_PORT = 15715
+TESTNET_RPC_PORT = 25715
+
+
+class Stats:
+    def __init__(self):
+        self.latencies = []
+        self.status_counts = {}
+        self.errors = 0
+
+    def percentile(self, fraction):
+        if not self.latencies:
+            return 0.0
+        ordered = sorted(self.latencies)
+        index = min(len(ordered) - 1, int(fraction * len(ordered)))
+        return ordered[index]
+
+
+async def read_response(reader):
+    status_line = await reader.readline()
+    if not status_line:
+        raise ConnectionError("connection closed by server")
+
+    status = int(status_line.split()[1])
+    length = 0
+    chunked = False
+    keepalive = True
+
+    while True:
+        line = await reader.readline()
+        if line in (b"\r\n", b"\n", b""):
+            break
+        name, _, value = line.decode().partition(":")
+        name = name.strip().lower()
+        if name == "content-length":
+            length = int(value.strip())
+        elif name == "transfer-encoding":
+            chunked = value.strip().lower() == "chunked"
+        elif name == "connection":
+            keepalive = value.strip().lower() != "close"
+
+    if not chunked:
+        await reader.readexactly(length)
+        return status, keepalive
+
+    # Streamed results arrive in chunks that end with an empty chunk:
+    while True:
+        size = int((await reader.readline()).split(b";")[0].strip(), 16)
+        if size == 0:
+            break
+        await reader.readexactly(size + 2)
+
+    while (await reader.readline()) not in (b"\r\n", b"\n", b""):
+        pass
+
+    return status, keepalive
+
+
+async def run_connection(args, request, deadline, stats):
+    reader = writer = None
+
+    while time.monotonic() < deadline:
+        try:
+            if writer is None:
+                reader, writer = await asyncio.open_connection(args.rpcconnect, args.rpcport)
+
+            start = time.perf_counter()
+            writer.write(request)
+            await writer.drain()
+            status, keepalive = await read_response(reader)
+            stats.latencies.append(time.perf_counter() - start)
+            stats.status_counts[status] = stats.status_counts.get(status, 0) + 1
+
+            if not keepalive:
+                writer.close()
+                writer = None
+        except (ConnectionError, asyncio.IncompleteReadError, OSError, ValueError, IndexError):
+            stats.errors += 1
+            if writer is not None:
+                writer.close()
+                writer = None
+            await asyncio.sleep(0.01)
+
+    if writer is not None:
+        writer.close()
+
+
+async def run(args):
+    body = json.dumps({
+        "jsonrpc": "1.0",
+        "id": "loadtest",
+        "method": args.method,
+        "params": json.loads(args.params),
+    }).encode()
+
+    credentials = base64.b64encode("{}:{}".format(args.rpcuser, args.rpcpassword).encode()).decode()
+
+    request = (
+        "POST / HTTP/1.1\r\n"
+        "Host: {}\r\n"
+        "Authorization: Basic {}\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: {}\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n".format(args.rpcconnect, credentials, len(body))
+    ).encode() + body
+
+    stats = Stats()
+    start = time.monotonic()
+    deadline = start + args.duration
+
+    await asyncio.gather(*(
+        run_connection(args, request, deadline, stats) for _ in range(args.connections)
+    ))
+
+    elapsed = time.monotonic() - start
+    completed = len(stats.latencies)
+
+    print("method:       {}".format(args.method))
+    print("connections:  {}".format(args.connections))
+    print("duration:     {:.1f} s".format(elapsed))
+    print("requests:     {}".format(completed))
+    print("throughput:   {:.0f} req/s".format(completed / elapsed if elapsed else 0))
+    print("latency p50:  {:.2f} ms".format(stats.percentile(0.50) * 1000))
+    print("latency p90:  {:.2f} ms".format(stats.percentile(0.90) * 1000))
+    print("latency p99:  {:.2f} ms".format(stats.percentile(0.99) * 1000))
+    print("latency max:  {:.2f} ms".format(max(stats.latencies, default=0) * 1000))
+
+    for status, count in sorted(stats.status_counts.items()):
+        label = " (work queue full)" if status == 503 else ""
+        print("HTTP {}:     {}{}".format(status, count, label))
+
+    print("socket errors: {}".format(stats.errors))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("method", help="RPC method to call")
+    parser.add_argument("--params", default="[]", help="JSON array of method parameters (default: [])")
+    parser.add_argument("--rpcconnect", default="127.0.0.1", help="Server address (default: 127.0.0.1)")
+    parser.add_argument("--rpcport", type=int, help="Server port (default: mainnet or testnet RPC port)")
+    parser.add_argument("--testnet", action="store_true", help="Use the testnet RPC port")
+    parser.add_argument("--rpcuser", required=True)
+    parser.add_argument("--rpcpassword", required=True)
+    parser.add_argument("--connections", type=int, default=16, help="Concurrent connections (default: 16)")
+    parser.add_argument("--duration", type=float, default=10, help="Seconds to run (default: 10)")
+    args = parser.parse_args()
+
+    if args.rpcport is None:
+        args.rpcport = TESTNET_RPC_PORT if args.testnet else MAINNET_RPC_PORT
+
+    asyncio.run(run(args))
+
+
+if __name__ == "__main__":
+    main()
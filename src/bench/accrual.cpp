@@ -0,0 +1,77 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data.h>
+
+#include "gridcoin/account.h"
+#include "gridcoin/tally.h"
+
+namespace {
+constexpr size_t NUM_CPIDS = 5000;
+constexpr uint32_t SUPERBLOCK_HEIGHT = 2500000;
+constexpr int64_t SUPERBLOCK_TIME = 1700000000;
+} // Anonymous namespace
+
+//!
+//! \brief Calculate the research rewards of a superblock's worth of CPIDs as
+//! the tally and the reward claim checks do.
+//!
+//! Half of the accounts last staked before the superblock and half after it
+//! to cover both of the snapshot accrual paths.
+//!
+static void SnapshotAccrual(benchmark::State& state)
+{
+    CBlockIndex superblock_index;
+    superblock_index.nHeight = SUPERBLOCK_HEIGHT;
+    superblock_index.nTime = SUPERBLOCK_TIME;
+
+    const GRC::SuperblockPtr superblock = GRC::SuperblockPtr::BindShared(
+        bench_data::MakeSuperblock(NUM_CPIDS, 30),
+        &superblock_index);
+
+    // Reward blocks spaced a day apart before and after the superblock:
+    std::vector<CBlockIndex> reward_blocks(20);
+
+    for (size_t i = 0; i < reward_blocks.size(); ++i) {
+        reward_blocks[i].nHeight = SUPERBLOCK_HEIGHT - 10 * 960 + i * 960;
+        reward_blocks[i].nTime = SUPERBLOCK_TIME - 10 * 86400 + i * 86400;
+    }
+
+    std::vector<GRC::Cpid> cpids;
+    std::vector<GRC::ResearchAccount> accounts;
+
+    for (size_t i = 0; i < NUM_CPIDS; ++i) {
+        GRC::ResearchAccount account(i * 1000);
+        account.m_total_research_subsidy = i * COIN;
+        account.m_first_block_ptr = &reward_blocks.front();
+        account.m_last_block_ptr = &reward_blocks[i % reward_blocks.size()];
+
+        cpids.push_back(bench_data::MakeCpid(i));
+        accounts.push_back(account);
+    }
+
+    CBlockIndex payment_block;
+    payment_block.nHeight = reward_blocks.back().nHeight + 60;
+    payment_block.nTime = reward_blocks.back().nTime + 3600;
+
+    while (state.KeepRunning()) {
+        CAmount total = 0;
+
+        for (size_t i = 0; i < NUM_CPIDS; ++i) {
+            const GRC::AccrualComputer computer = GRC::Tally::GetSnapshotComputer(
+                cpids[i],
+                accounts[i],
+                payment_block.nTime,
+                &payment_block,
+                superblock);
+
+            total += computer->Accrual();
+        }
+
+        assert(total > 0);
+    }
+}
+
+BENCHMARK(SnapshotAccrual, 500);
@@ -0,0 +1,186 @@
+// Copyright (c) 2015-2018 The Bitcoin Core developers
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include <univalue.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <regex>
+
+namespace {
+double Median(std::vector<double> values)
+{
+    if (values.empty()) {
+        return 0;
+    }
+
+    std::sort(values.begin(), values.end());
+
+    const size_t middle = values.size() / 2;
+
+    if (values.size() % 2 == 0) {
+        return (values[middle - 1] + values[middle]) / 2;
+    }
+
+    return values[middle];
+}
+} // Anonymous namespace
+
+void benchmark::ConsolePrinter::header()
+{
+    std::cout << "# Benchmark, evals, iterations, total, min, max, median" << std::endl;
+}
+
+void benchmark::ConsolePrinter::result(const State& state)
+{
+    auto results = state.m_elapsed_results;
+    std::sort(results.begin(), results.end());
+
+    double total = state.m_num_iters * std::accumulate(results.begin(), results.end(), 0.0);
+
+    double front = 0;
+    double back = 0;
+
+    if (!results.empty()) {
+        front = results.front();
+        back = results.back();
+    }
+
+    std::cout << std::setprecision(6);
+    std::cout << state.m_name << ", " << state.m_num_evals << ", " << state.m_num_iters << ", " << total << ", "
+              << front << ", " << back << ", " << Median(results) << std::endl;
+}
+
+void benchmark::ConsolePrinter::footer() {}
+
+benchmark::JsonPrinter::JsonPrinter(std::string file_name) : m_file_name(std::move(file_name))
+{
+}
+
+void benchmark::JsonPrinter::header() {}
+
+void benchmark::JsonPrinter::result(const State& state)
+{
+    m_results.push_back({state.m_name, state.m_num_evals, state.m_num_iters, state.m_elapsed_results});
+}
+
+void benchmark::JsonPrinter::footer()
+{
+    UniValue benchmarks(UniValue::VARR);
+
+    for (const auto& result : m_results) {
+        std::vector<double> sorted = result.m_elapsed_results;
+        std::sort(sorted.begin(), sorted.end());
+
+        UniValue evaluations(UniValue::VARR);
+
+        for (const double elapsed : result.m_elapsed_results) {
+            evaluations.push_back(elapsed);
+        }
+
+        UniValue json(UniValue::VOBJ);
+        json.pushKV("name", result.m_name);
+        json.pushKV("evals", result.m_num_evals);
+        json.pushKV("iterations", result.m_num_iters);
+        json.pushKV("min", sorted.empty() ? 0 : sorted.front());
+        json.pushKV("max", sorted.empty() ? 0 : sorted.back());
+        json.pushKV("median", Median(sorted));
+        json.pushKV("results", evaluations);
+
+        benchmarks.push_back(json);
+    }
+
+    UniValue output(UniValue::VOBJ);
+    output.pushKV("unit", "seconds per iteration");
+    output.pushKV("benchmarks", benchmarks);
+
+    std::ofstream file(m_file_name);
+
+    if (!file.is_open()) {
+        std::cerr << "Error: cannot write to " << m_file_name << std::endl;
+        return;
+    }
+
+    file << output.write(4) << std::endl;
+}
+
+void benchmark::CombinedPrinter::header()
+{
+    for (Printer* printer : m_printers) {
+        printer->header();
+    }
+}
+
+void benchmark::CombinedPrinter::result(const State& state)
+{
+    for (Printer* printer : m_printers) {
+        printer->result(state);
+    }
+}
+
+void benchmark::CombinedPrinter::footer()
+{
+    for (Printer* printer : m_printers) {
+        printer->footer();
+    }
+}
+
+benchmark::BenchRunner::BenchmarkMap& benchmark::BenchRunner::benchmarks()
+{
+    static std::map<std::string, Bench> benchmarks_map;
+    return benchmarks_map;
+}
+
+benchmark::BenchRunner::BenchRunner(std::string name, benchmark::BenchFunction func, uint64_t num_iters_for_one_second)
+{
+    benchmarks().insert(std::make_pair(name, Bench{func, num_iters_for_one_second}));
+}
+
+void benchmark::BenchRunner::RunAll(Printer& printer, uint64_t num_evals, double scaling, const std::string& filter, bool is_list_only)
+{
+    std::regex reFilter(filter);
+    std::smatch baseMatch;
+
+    printer.header();
+
+    for (const auto& p : benchmarks()) {
+        if (!std::regex_match(p.first, baseMatch, reFilter)) {
+            continue;
+        }
+
+        uint64_t num_iters = static_cast<uint64_t>(p.second.num_iters_for_one_second * scaling);
+        if (0 == num_iters) {
+            num_iters = 1;
+        }
+        State state(p.first, num_evals, num_iters);
+        if (!is_list_only) {
+            p.second.func(state);
+        }
+        printer.result(state);
+    }
+
+    printer.footer();
+}
+
+bool benchmark::State::UpdateTimer(const benchmark::time_point current_time)
+{
+    if (m_start_time != time_point()) {
+        std::chrono::duration<double> diff = current_time - m_start_time;
+        m_elapsed_results.push_back(diff.count() / m_num_iters);
+
+        if (m_elapsed_results.size() == m_num_evals) {
+            return false;
+        }
+    }
+
+    m_num_iters_left = m_num_iters - 1;
+    return true;
+}
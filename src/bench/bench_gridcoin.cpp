@@ -0,0 +1,203 @@
+// Copyright (c) 2015-2018 The Bitcoin Core developers
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/chain.h>
+
+#include "chainparams.h"
+#include "crypto/sha256.h"
+#include "key.h"
+#include "random.h"
+#include "util.h"
+#include "util/system.h"
+
+#include <leveldb/db.h>
+#include <leveldb/env.h>
+#include <leveldb/helpers/memenv/memenv.h>
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+extern leveldb::DB *txdb;
+extern void SetupEnvironment();
+extern void InitLogging();
+
+static const int64_t DEFAULT_BENCH_EVALUATIONS = 5;
+static const char* DEFAULT_BENCH_FILTER = ".*";
+static const char* DEFAULT_BENCH_SCALING = "1.0";
+static const int64_t DEFAULT_REPLAY_BLOCKS = 2000;
+
+static void SetupBenchArgs(ArgsManager& argsman)
+{
+    SetupHelpOptions(argsman);
+
+    argsman.AddArg("-list", "List benchmarks without executing them. Can be combined with -scaling and -filter",
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-evals=<n>", strprintf("Number of measurement evaluations to perform (default: %u)",
+                                           DEFAULT_BENCH_EVALUATIONS),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-filter=<regex>", strprintf("Regular expression filter to select benchmark by name (default: %s)",
+                                                DEFAULT_BENCH_FILTER),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-scaling=<n>", strprintf("Scaling factor for benchmark's runtime (default: %s)",
+                                             DEFAULT_BENCH_SCALING),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-output_json=<file>", "Also write the results to <file> as JSON to compare them between builds",
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-replay", "Instead of the benchmarks, replay a synthetic chain from block files and report the "
+                              "throughput and the time of each validation stage",
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-replay_blocks=<n>", strprintf("Number of blocks to generate for -replay (default: %u)",
+                                                   DEFAULT_REPLAY_BLOCKS),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-replay_dir=<dir>", "Directory of the block files for -replay. Generates a synthetic chain into it "
+                                        "when it contains no block files (default: a temporary directory)",
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+}
+
+//!
+//! \brief Replay the block files of -replay_dir, or of a newly generated
+//! synthetic chain, and print the report.
+//!
+static int RunReplay()
+{
+    bench_chain::ChainOptions options;
+    const int64_t blocks = gArgs.GetArg("-replay_blocks", DEFAULT_REPLAY_BLOCKS);
+
+    if (blocks <= 0) {
+        tfm::format(std::cerr, "Error: -replay_blocks must be a positive number\n");
+        return EXIT_FAILURE;
+    }
+
+    options.m_blocks = blocks;
+
+    const fs::path dir = gArgs.IsArgSet("-replay_dir")
+        ? fs::absolute(gArgs.GetArg("-replay_dir", ""))
+        : GetDataDir() / "replay";
+
+    if (!bench_chain::HasBlockFiles(dir)) {
+        tfm::format(std::cout, "Generating %u blocks in %s\n", options.m_blocks, dir.string());
+
+        if (!bench_chain::WriteChain(options, dir)) {
+            tfm::format(std::cerr, "Error: cannot write the block files to %s\n", dir.string());
+            return EXIT_FAILURE;
+        }
+    }
+
+    const bench_chain::ReplayStats stats = bench_chain::ReplayBlockFiles(dir, bench_chain::GetStartHeight());
+
+    std::cout << bench_chain::FormatReplayReport(stats);
+
+    if (gArgs.IsArgSet("-output_json")) {
+        std::ofstream file(gArgs.GetArg("-output_json", ""));
+        file << bench_chain::ReplayReportToJson(stats).write(4) << std::endl;
+    }
+
+    return stats.m_failures > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+//!
+//! \brief Global state that the benchmarks share, set up like the unit test
+//! fixture: main network parameters, no debug log, and a transaction database
+//! in memory.
+//!
+class BenchSetup
+{
+public:
+    BenchSetup()
+    {
+        SetupEnvironment();
+
+        m_path_root = fs::temp_directory_path() / "bench_" PACKAGE_NAME / GetRandHash().ToString();
+        fs::create_directories(m_path_root);
+        gArgs.ForceSetArg("-datadir", m_path_root.string());
+        gArgs.ClearPathCache();
+        SelectParams(CBaseChainParams::MAIN);
+
+        gArgs.ForceSetArg("-debuglogfile", "none");
+        gArgs.SoftSetBoolArg("-printtoconsole", false);
+        gArgs.SoftSetBoolArg("-logasync", false);
+
+        InitLogging();
+        SHA256AutoDetect();
+        RandomInit();
+        ECC_Start();
+
+        leveldb::Options db_options;
+        db_options.env = m_txdb_env = leveldb::NewMemEnv(leveldb::Env::Default());
+        db_options.create_if_missing = true;
+        db_options.error_if_exists = true;
+        assert(leveldb::DB::Open(db_options, "", &txdb).ok());
+    }
+
+    ~BenchSetup()
+    {
+        delete txdb;
+        txdb = nullptr;
+        delete m_txdb_env;
+
+        ECC_Stop();
+
+        fs::remove_all(m_path_root);
+    }
+
+private:
+    fs::path m_path_root;
+    leveldb::Env* m_txdb_env = nullptr;
+};
+
+int main(int argc, char** argv)
+{
+    SetupBenchArgs(gArgs);
+    std::string error;
+    if (!gArgs.ParseParameters(argc, argv, error)) {
+        tfm::format(std::cerr, "Error parsing command line arguments: %s\n", error);
+        return EXIT_FAILURE;
+    }
+
+    if (HelpRequested(gArgs)) {
+        std::cout << gArgs.GetHelpMessage();
+
+        return EXIT_SUCCESS;
+    }
+
+    int64_t evaluations = gArgs.GetArg("-evals", DEFAULT_BENCH_EVALUATIONS);
+    std::string regex_filter = gArgs.GetArg("-filter", DEFAULT_BENCH_FILTER);
+    std::string scaling_str = gArgs.GetArg("-scaling", DEFAULT_BENCH_SCALING);
+    bool is_list_only = gArgs.GetBoolArg("-list", false);
+
+    if (evaluations <= 0) {
+        tfm::format(std::cerr, "Error: -evals must be a positive number\n");
+        return EXIT_FAILURE;
+    }
+
+    double scaling_factor;
+    if (!ParseDouble(scaling_str, &scaling_factor)) {
+        tfm::format(std::cerr, "Error parsing scaling factor as double: %s\n", scaling_str);
+        return EXIT_FAILURE;
+    }
+
+    BenchSetup setup;
+
+    if (gArgs.GetBoolArg("-replay", false)) {
+        return RunReplay();
+    }
+
+    benchmark::ConsolePrinter console_printer;
+    std::vector<benchmark::Printer*> printers { &console_printer };
+    std::unique_ptr<benchmark::JsonPrinter> json_printer;
+
+    if (gArgs.IsArgSet("-output_json")) {
+        json_printer = std::make_unique<benchmark::JsonPrinter>(gArgs.GetArg("-output_json", ""));
+        printers.push_back(json_printer.get());
+    }
+
+    benchmark::CombinedPrinter printer(printers);
+
+    benchmark::BenchRunner::RunAll(printer, evaluations, scaling_factor, regex_filter, is_list_only);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,160 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include "chainparams.h"
+#include "clientversion.h"
+#include "consensus/merkle.h"
+#include "index/disktxpos.h"
+#include "main.h"
+#include "node/blockstorage.h"
+
+namespace {
+//!
+//! \brief Number of payment outputs in the benchmark block. The outputs pay
+//! the same script, like the payouts of a pool, so the block compresses.
+//!
+constexpr size_t NUM_OUTPUTS = 2000;
+
+//!
+//! \brief A block written to the block files and the positions to read it.
+//!
+struct StoredBlock
+{
+    CBlock m_block;
+    unsigned int m_file = 0;
+    unsigned int m_block_pos = 0;
+    CDiskTxPos m_tx_pos;       //!< Position of the last transaction.
+};
+
+CBlock MakeBlock(const int height)
+{
+    CBlock block;
+    block.nVersion = 11;
+    block.nTime = 1700000000 + height;
+
+    CTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].prevout.SetNull();
+    coinbase.vin[0].scriptSig = CScript() << height;
+    coinbase.vout.resize(1);
+    coinbase.vout[0].SetEmpty();
+    block.vtx.push_back(coinbase);
+
+    CTransaction coinstake;
+    coinstake.vin.emplace_back(COutPoint(uint256S("a"), height));
+    coinstake.vout.resize(1);
+    coinstake.vout[0].SetEmpty();
+    coinstake.vout.emplace_back(10 * COIN, CScript() << OP_TRUE);
+    block.vtx.push_back(coinstake);
+
+    CTransaction payment;
+    payment.vin.emplace_back(COutPoint(uint256S("b"), height));
+
+    for (size_t i = 0; i < NUM_OUTPUTS; ++i) {
+        payment.vout.emplace_back(COIN, CScript() << OP_DUP << OP_HASH160 << std::vector<unsigned char>(20, 1));
+    }
+
+    block.vtx.push_back(payment);
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+
+    return block;
+}
+
+//!
+//! \brief Write a block with compression on or off, like ConnectBlock() does.
+//!
+StoredBlock WriteBlock(const bool compress)
+{
+    LOCK(cs_main);
+
+    StoredBlock stored;
+    stored.m_block = MakeBlock(compress ? 1 : 2);
+
+    fCompressBlocks = compress;
+    bool written = WriteBlockToDisk(stored.m_block, stored.m_file, stored.m_block_pos, Params().MessageStart());
+    fCompressBlocks = DEFAULT_COMPRESS_BLOCKS;
+    assert(written);
+
+    unsigned int tx_pos = stored.m_block_pos
+        + ::GetSerializeSize<CBlockHeader>(stored.m_block, SER_DISK, CLIENT_VERSION)
+        + GetSizeOfCompactSize(stored.m_block.vtx.size());
+
+    for (size_t i = 0; i + 1 < stored.m_block.vtx.size(); ++i) {
+        tx_pos += ::GetSerializeSize(stored.m_block.vtx[i], SER_DISK, CLIENT_VERSION);
+    }
+
+    stored.m_tx_pos = CDiskTxPos(stored.m_file, stored.m_block_pos, tx_pos);
+
+    return stored;
+}
+
+void ReadBlock(benchmark::State& state, const bool compress)
+{
+    const StoredBlock stored = WriteBlock(compress);
+
+    while (state.KeepRunning()) {
+        CBlock block;
+        bool read = ReadBlockFromDisk(block, stored.m_file, stored.m_block_pos, Params().GetConsensus());
+        assert(read && block.vtx.size() == stored.m_block.vtx.size());
+    }
+}
+
+//!
+//! \brief Read the last transaction of the block.
+//!
+//! \param cold Drop the decompressed block before each read, like a read of
+//! a block that left the cache. This reads the file header again as well.
+//!
+void ReadTx(benchmark::State& state, const bool compress, const bool cold)
+{
+    const StoredBlock stored = WriteBlock(compress);
+
+    while (state.KeepRunning()) {
+        if (cold) {
+            ForgetBlockFile(stored.m_file);
+        }
+
+        CTransaction tx;
+        bool read = ReadTxFromDisk(tx, stored.m_tx_pos, nullptr);
+        assert(read && tx.vout.size() == NUM_OUTPUTS);
+    }
+}
+} // Anonymous namespace
+
+// ConnectBlock() reads the inputs of each transaction with ReadTxFromDisk(),
+// and the staking and voting code reads single transactions as well. These
+// compare both read paths for blocks stored raw and compressed.
+
+static void ReadBlockFromDiskRaw(benchmark::State& state)
+{
+    ReadBlock(state, false);
+}
+
+static void ReadBlockFromDiskCompressed(benchmark::State& state)
+{
+    ReadBlock(state, true);
+}
+
+static void ReadTxFromDiskRaw(benchmark::State& state)
+{
+    ReadTx(state, false, false);
+}
+
+static void ReadTxFromDiskCompressed(benchmark::State& state)
+{
+    ReadTx(state, true, false);
+}
+
+static void ReadTxFromDiskCompressedCold(benchmark::State& state)
+{
+    ReadTx(state, true, true);
+}
+
+BENCHMARK(ReadBlockFromDiskRaw, 500);
+BENCHMARK(ReadBlockFromDiskCompressed, 500);
+BENCHMARK(ReadTxFromDiskRaw, 2000);
+BENCHMARK(ReadTxFromDiskCompressed, 2000);
+BENCHMARK(ReadTxFromDiskCompressedCold, 500);
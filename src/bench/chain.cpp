@@ -0,0 +1,633 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <bench/chain.h>
+#include <bench/data.h>
+
+#include "chainparams.h"
+#include "clientversion.h"
+#include "consensus/merkle.h"
+#include "gridcoin/beacon.h"
+#include "gridcoin/claim.h"
+#include "gridcoin/contract/contract.h"
+#include "gridcoin/mrc.h"
+#include "gridcoin/voting/claims.h"
+#include "gridcoin/voting/payloads.h"
+#include "gridcoin/voting/vote.h"
+#include "keystore.h"
+#include "main.h"
+#include "random.h"
+#include "script.h"
+#include "streams.h"
+
+#include <algorithm>
+#include <memory>
+
+using namespace GRC;
+using namespace bench_chain;
+
+namespace {
+constexpr int64_t BLOCK_TIME = 1700000000;
+constexpr int64_t BLOCK_SPACING = 90;
+constexpr CAmount FEE = COIN / 100;
+constexpr CAmount BLOCK_SUBSIDY = 10 * COIN;
+constexpr CAmount FUNDING_VALUE = 10000 * COIN;
+constexpr CAmount STAKE_VALUE = 50000 * COIN;
+constexpr size_t WALLET_KEYS = 200;
+
+//!
+//! \brief An output that the generator can spend.
+//!
+struct Coin
+{
+    COutPoint m_outpoint;
+    CTxOut m_txout;
+    size_t m_key; //!< Index of the wallet or staker key that owns the output.
+};
+
+//!
+//! \brief An MRC contract included in the block under construction.
+//!
+struct PendingMrc
+{
+    Cpid m_cpid;
+    uint256 m_txid;
+    size_t m_researcher;
+    CAmount m_payout;
+};
+
+//!
+//! \brief Builds the blocks of a synthetic chain one at a time.
+//!
+//! The generator owns every key in the chain. Outputs created by a block
+//! become spendable in the next block.
+//!
+class ChainGenerator
+{
+public:
+    explicit ChainGenerator(const ChainOptions& options)
+        : m_options(options)
+        , m_rng(Hash(MakeUCharSpan(std::string("synthetic chain"))))
+        , m_height(bench_chain::GetStartHeight())
+        , m_time(BLOCK_TIME)
+        , m_prev_hash(Hash(MakeUCharSpan(std::string("synthetic chain parent"))))
+    {
+        for (size_t i = 0; i < WALLET_KEYS; ++i) {
+            m_wallet_keys.push_back(MakeKey("wallet", i));
+        }
+
+        for (size_t i = 0; i < std::max<size_t>(m_options.m_stakers, 1); ++i) {
+            m_staker_keys.push_back(MakeKey("staker", i));
+        }
+
+        for (size_t i = 0; i < std::min(m_options.m_researchers, m_staker_keys.size()); ++i) {
+            m_beacon_keys.push_back(MakeKey("beacon", i));
+            m_cpids.push_back(bench_data::MakeCpid(1000000 + i));
+        }
+
+        // The outputs that the first block spends. No block contains this
+        // transaction, so a replay cannot verify the inputs that spend it:
+        //
+        CTransaction premine;
+        premine.nTime = m_time - BLOCK_SPACING;
+        premine.vin.emplace_back(COutPoint(m_prev_hash, 0));
+
+        for (size_t i = 0; i < m_staker_keys.size(); ++i) {
+            premine.vout.emplace_back(STAKE_VALUE, CScript() << m_staker_keys[i].GetPubKey() << OP_CHECKSIG);
+        }
+
+        premine.vout.emplace_back(FundingOutputs() * FUNDING_VALUE + COIN, WalletScript(0));
+
+        for (uint32_t i = 0; i < premine.vout.size(); ++i) {
+            Coin coin { COutPoint(premine.GetHash(), i), premine.vout[i], i };
+
+            if (i < m_staker_keys.size()) {
+                m_stakes.push_back(std::move(coin));
+            } else {
+                coin.m_key = 0;
+                m_funding.push_back(std::move(coin));
+            }
+        }
+    }
+
+    CBlock GenerateBlock(const size_t index)
+    {
+        const size_t staker = m_rng.randrange(m_staker_keys.size());
+
+        std::vector<CTransaction> txs;
+
+        if (index == 0) {
+            txs.push_back(MakeFunding());
+        }
+
+        // The outputs of the funding transaction pay for the contracts from
+        // the second block:
+        //
+        if (!m_coins.empty()) {
+            if (m_beacons_sent < m_beacon_keys.size()) {
+                txs.push_back(MakeBeacon(m_beacons_sent++));
+            } else if (index % std::max<size_t>(m_options.m_contract_interval, 1) == 0) {
+                switch ((index / std::max<size_t>(m_options.m_contract_interval, 1)) % 3) {
+                    case 0:
+                        txs.push_back(MakePoll());
+                        break;
+                    case 1:
+                        txs.push_back(m_poll_txids.empty() ? MakePoll() : MakeVote());
+                        break;
+                    default:
+                        if (!m_beacon_keys.empty()) {
+                            txs.push_back(MakeBeacon(m_rng.randrange(m_beacon_keys.size())));
+                        }
+                        break;
+                }
+            }
+
+            if (m_active_beacons > 1
+                && index % std::max<size_t>(m_options.m_mrc_interval, 1) == 0)
+            {
+                size_t researcher = m_rng.randrange(m_active_beacons);
+
+                // The staker claims its own research reward in the block:
+                if (researcher == staker) {
+                    researcher = (researcher + 1) % m_active_beacons;
+                }
+
+                txs.push_back(MakeMrc(researcher));
+            }
+        }
+
+        for (size_t i = 0; i < m_options.m_txs_per_block && !m_coins.empty(); ++i) {
+            txs.push_back(MakePayment());
+        }
+
+        CBlock block;
+        block.nVersion = 12;
+        block.hashPrevBlock = m_prev_hash;
+        block.nTime = m_time;
+        block.nBits = 0x1d00ffff;
+
+        const CTransaction coinstake = MakeCoinstake(staker);
+
+        block.vtx.push_back(MakeCoinbase(index, staker, coinstake));
+        block.vtx.push_back(coinstake);
+        block.vtx.insert(block.vtx.end(), txs.begin(), txs.end());
+
+        block.hashMerkleRoot = BlockMerkleRoot(block);
+        m_staker_keys[staker].Sign(block.GetHash(), block.vchBlockSig);
+
+        m_prev_hash = block.GetHash();
+        m_time += BLOCK_SPACING;
+        ++m_height;
+
+        m_coins.insert(m_coins.end(), m_new_coins.begin(), m_new_coins.end());
+        m_new_coins.clear();
+        m_mrcs.clear();
+        m_active_beacons = m_beacons_sent;
+
+        return block;
+    }
+
+private:
+    const ChainOptions& m_options;
+    FastRandomContext m_rng;
+    CBasicKeyStore m_keystore;
+    std::vector<CKey> m_wallet_keys;
+    std::vector<CKey> m_staker_keys;
+    std::vector<CKey> m_beacon_keys;       //!< Beacon keys of the first stakers.
+    std::vector<Cpid> m_cpids;             //!< CPIDs of the first stakers.
+    std::vector<Coin> m_stakes;            //!< Staked output of each staker.
+    std::vector<Coin> m_funding;
+    std::vector<Coin> m_coins;             //!< Spendable wallet outputs.
+    std::vector<Coin> m_new_coins;         //!< Outputs of the block under construction.
+    std::vector<std::pair<uint32_t, size_t>> m_pending_outputs;
+    std::vector<PendingMrc> m_mrcs;
+    std::vector<uint256> m_poll_txids;
+    size_t m_beacons_sent = 0;
+    size_t m_active_beacons = 0;           //!< Beacons in the previous blocks.
+    int m_height;
+    int64_t m_time;
+    uint256 m_prev_hash;
+
+    CKey MakeKey(const std::string& kind, const uint64_t seed)
+    {
+        CKey key;
+
+        for (uint64_t nonce = 0; !key.IsValid(); ++nonce) {
+            const uint256 secret = Hash(MakeUCharSpan(kind + std::to_string(seed) + "/" + std::to_string(nonce)));
+            key.Set(secret.begin(), secret.end(), true);
+        }
+
+        m_keystore.AddKey(key);
+
+        return key;
+    }
+
+    size_t FundingOutputs() const
+    {
+        return m_options.m_txs_per_block * 10 + 100;
+    }
+
+    CScript WalletScript(const size_t key) const
+    {
+        CScript script;
+        script.SetDestination(m_wallet_keys[key].GetPubKey().GetID());
+
+        return script;
+    }
+
+    Coin TakeCoin()
+    {
+        const size_t i = m_rng.randrange(m_coins.size());
+
+        Coin coin = std::move(m_coins[i]);
+        m_coins[i] = std::move(m_coins.back());
+        m_coins.pop_back();
+
+        return coin;
+    }
+
+    std::vector<Coin> TakeCoins(const CAmount amount)
+    {
+        std::vector<Coin> inputs;
+        CAmount total = 0;
+
+        while (total < amount && !m_coins.empty()) {
+            inputs.push_back(TakeCoin());
+            total += inputs.back().m_txout.nValue;
+        }
+
+        return inputs;
+    }
+
+    CTransaction StartTransaction(const std::vector<Coin>& inputs) const
+    {
+        CTransaction tx;
+        tx.nTime = m_time;
+
+        for (const auto& input : inputs) {
+            tx.vin.emplace_back(input.m_outpoint);
+        }
+
+        return tx;
+    }
+
+    void Pay(CTransaction& tx, const CAmount value, const size_t key)
+    {
+        m_pending_outputs.emplace_back(tx.vout.size(), key);
+        tx.vout.emplace_back(value, WalletScript(key));
+    }
+
+    //!
+    //! \brief Add the burn, payment, and change outputs, sign the inputs, and
+    //! make the outputs spendable from the next block.
+    //!
+    CTransaction FinishTransaction(CTransaction tx, const std::vector<Coin>& inputs, const CAmount burn)
+    {
+        CAmount total = -burn - FEE;
+
+        for (const auto& input : inputs) {
+            total += input.m_txout.nValue;
+        }
+
+        if (burn > 0) {
+            tx.vout.emplace_back(burn, CScript() << OP_RETURN);
+        }
+
+        if (total > 2 * COIN) {
+            const CAmount payment = total / 10 * (1 + m_rng.randrange(8));
+
+            Pay(tx, payment, m_rng.randrange(m_wallet_keys.size()));
+            Pay(tx, total - payment, inputs.front().m_key);
+        } else {
+            Pay(tx, std::max<CAmount>(total, 0), inputs.front().m_key);
+        }
+
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            assert(SignSignature(m_keystore, inputs[i].m_txout.scriptPubKey, tx, i));
+        }
+
+        const uint256 txid = tx.GetHash();
+
+        for (const auto& output : m_pending_outputs) {
+            m_new_coins.push_back({ COutPoint(txid, output.first), tx.vout[output.first], output.second });
+        }
+
+        m_pending_outputs.clear();
+
+        return tx;
+    }
+
+    CTransaction MakeFunding()
+    {
+        CTransaction tx = StartTransaction(m_funding);
+
+        for (size_t i = 0; i < FundingOutputs(); ++i) {
+            Pay(tx, FUNDING_VALUE, i % m_wallet_keys.size());
+        }
+
+        return FinishTransaction(std::move(tx), m_funding, 0);
+    }
+
+    CTransaction MakePayment()
+    {
+        std::vector<Coin> inputs { TakeCoin() };
+
+        if (!m_coins.empty() && m_rng.randbool()) {
+            inputs.push_back(TakeCoin());
+        }
+
+        return FinishTransaction(StartTransaction(inputs), inputs, 0);
+    }
+
+    CTransaction MakeBeacon(const size_t researcher)
+    {
+        const std::vector<Coin> inputs = TakeCoins(COIN + FEE);
+        CTransaction tx = StartTransaction(inputs);
+
+        BeaconPayload payload(
+            BeaconPayload::CURRENT_VERSION,
+            m_cpids[researcher],
+            Beacon(m_beacon_keys[researcher].GetPubKey()));
+
+        assert(payload.Sign(m_beacon_keys[researcher]));
+
+        tx.vContracts.emplace_back(MakeContract<BeaconPayload>(ContractAction::ADD, std::move(payload)));
+        const CAmount burn = tx.vContracts.back().RequiredBurnAmount();
+
+        return FinishTransaction(std::move(tx), inputs, burn);
+    }
+
+    //!
+    //! \brief Sign an address claim for the inputs of the first input's key.
+    //!
+    AddressClaim MakeAddressClaim(const std::vector<Coin>& inputs, const ClaimMessage& message)
+    {
+        std::vector<COutPoint> outpoints;
+
+        for (const auto& input : inputs) {
+            if (input.m_key == inputs.front().m_key) {
+                outpoints.push_back(input.m_outpoint);
+            }
+        }
+
+        std::sort(outpoints.begin(), outpoints.end());
+
+        CKey& key = m_wallet_keys[inputs.front().m_key];
+
+        AddressClaim claim(std::move(outpoints));
+        claim.m_public_key = key.GetPubKey();
+        assert(claim.Sign(key, message));
+
+        return claim;
+    }
+
+    CTransaction MakePoll()
+    {
+        const std::vector<Coin> inputs = TakeCoins(100 * COIN);
+        CTransaction tx = StartTransaction(inputs);
+
+        Poll::ChoiceList choices;
+        choices.Add("Yes");
+        choices.Add("No");
+        choices.Add("Abstain");
+
+        Poll poll(
+            PollType::SURVEY,
+            PollWeightType::BALANCE,
+            PollResponseType::SINGLE_CHOICE,
+            Poll::MIN_DURATION_DAYS,
+            "Synthetic poll at height " + std::to_string(m_height),
+            "https://gridcoin.us/",
+            "Which answer do you choose?",
+            std::move(choices),
+            tx.nTime);
+
+        PollEligibilityClaim claim;
+        claim.m_address_claim = MakeAddressClaim(inputs, PackPollMessage(poll, tx));
+
+        tx.vContracts.emplace_back(MakeContract<PollPayload>(
+            ContractAction::ADD,
+            PollPayload::CURRENT_VERSION,
+            std::move(poll),
+            std::move(claim)));
+        const CAmount burn = tx.vContracts.back().RequiredBurnAmount();
+
+        CTransaction final_tx = FinishTransaction(std::move(tx), inputs, burn);
+        m_poll_txids.push_back(final_tx.GetHash());
+
+        return final_tx;
+    }
+
+    CTransaction MakeVote()
+    {
+        const std::vector<Coin> inputs = TakeCoins(COIN + FEE);
+        CTransaction tx = StartTransaction(inputs);
+
+        Vote vote(
+            Vote::CURRENT_VERSION,
+            m_poll_txids[m_rng.randrange(m_poll_txids.size())],
+            { static_cast<uint8_t>(m_rng.randrange(3)) },
+            VoteWeightClaim());
+
+        vote.m_claim.m_balance_claim.m_address_claims.push_back(
+            MakeAddressClaim(inputs, PackVoteMessage(vote, tx)));
+
+        tx.vContracts.emplace_back(MakeContract<Vote>(ContractAction::ADD, std::move(vote)));
+        const CAmount burn = tx.vContracts.back().RequiredBurnAmount();
+
+        return FinishTransaction(std::move(tx), inputs, burn);
+    }
+
+    CTransaction MakeMrc(const size_t researcher)
+    {
+        const std::vector<Coin> inputs = TakeCoins(10 * COIN);
+        CTransaction tx = StartTransaction(inputs);
+
+        MRC mrc;
+        mrc.m_mining_id = m_cpids[researcher];
+        mrc.m_client_version = "bench";
+        mrc.m_organization = "bench";
+        mrc.m_research_subsidy = (10 + m_rng.randrange(90)) * COIN;
+        mrc.m_fee = mrc.m_research_subsidy / 5;
+        mrc.m_magnitude = 1 + m_rng.randrange(2000);
+        mrc.m_magnitude_unit = 0.25;
+        mrc.m_last_block_hash = m_prev_hash;
+
+        assert(mrc.Sign(m_beacon_keys[researcher]));
+
+        const Cpid cpid = m_cpids[researcher];
+        const CAmount payout = mrc.m_research_subsidy - mrc.m_fee;
+
+        tx.vContracts.emplace_back(MakeContract<MRC>(ContractAction::ADD, std::move(mrc)));
+        const CAmount burn = tx.vContracts.back().RequiredBurnAmount();
+
+        CTransaction final_tx = FinishTransaction(std::move(tx), inputs, burn);
+        m_mrcs.push_back({ cpid, final_tx.GetHash(), researcher, payout });
+
+        return final_tx;
+    }
+
+    CAmount ResearchSubsidy(const size_t staker) const
+    {
+        if (staker >= m_active_beacons) {
+            return 0;
+        }
+
+        return (1 + (m_height + staker) % 50) * COIN;
+    }
+
+    CTransaction MakeCoinstake(const size_t staker)
+    {
+        Coin& stake = m_stakes[staker];
+
+        CAmount reward = BLOCK_SUBSIDY + ResearchSubsidy(staker);
+
+        for (const auto& mrc : m_mrcs) {
+            // The staker receives the MRC fees:
+            reward += mrc.m_payout / 4;
+        }
+
+        // Half of the stakers split off a tenth of the reward for a sidestake:
+        const CAmount sidestake = staker % 2 == 0 ? reward / 10 : 0;
+
+        CTransaction coinstake;
+        coinstake.nTime = m_time;
+        coinstake.vin.emplace_back(stake.m_outpoint);
+        coinstake.vout.resize(1);
+        coinstake.vout[0].SetEmpty();
+        coinstake.vout.emplace_back(
+            stake.m_txout.nValue + reward - sidestake,
+            CScript() << m_staker_keys[staker].GetPubKey() << OP_CHECKSIG);
+
+        if (sidestake > 0) {
+            Pay(coinstake, sidestake, staker % m_wallet_keys.size());
+        }
+
+        for (const auto& mrc : m_mrcs) {
+            Pay(coinstake, mrc.m_payout, mrc.m_researcher);
+        }
+
+        assert(SignSignature(m_keystore, stake.m_txout.scriptPubKey, coinstake, 0));
+
+        const uint256 txid = coinstake.GetHash();
+
+        for (const auto& output : m_pending_outputs) {
+            m_new_coins.push_back({ COutPoint(txid, output.first), coinstake.vout[output.first], output.second });
+        }
+
+        m_pending_outputs.clear();
+
+        stake = { COutPoint(txid, 1), coinstake.vout[1], staker };
+
+        return coinstake;
+    }
+
+    CTransaction MakeCoinbase(const size_t index, const size_t staker, const CTransaction& coinstake)
+    {
+        Claim claim;
+        claim.m_client_version = "bench";
+        claim.m_organization = "bench";
+        claim.m_block_subsidy = BLOCK_SUBSIDY;
+
+        if (const CAmount research = ResearchSubsidy(staker)) {
+            claim.m_mining_id = m_cpids[staker];
+            claim.m_research_subsidy = research;
+            claim.m_magnitude = 1 + (m_height + staker) % 2000;
+            claim.m_magnitude_unit = 0.25;
+        } else {
+            claim.m_mining_id = MiningId::ForInvestor();
+        }
+
+        for (const auto& mrc : m_mrcs) {
+            claim.m_mrc_tx_map.emplace(mrc.m_cpid, mrc.m_txid);
+        }
+
+        if (index > 0 && m_options.m_superblock_interval > 0 && index % m_options.m_superblock_interval == 0) {
+            Superblock superblock = bench_data::MakeSuperblock(
+                m_options.m_superblock_cpids,
+                m_options.m_superblock_projects);
+
+            for (size_t i = 0; i < m_cpids.size(); ++i) {
+                superblock.m_cpids.Add(m_cpids[i], Magnitude::RoundFrom(1 + (m_height + i) % 1000));
+            }
+
+            claim.m_quorum_hash = superblock.GetHash();
+            claim.m_superblock.Replace(std::move(superblock));
+        }
+
+        if (claim.m_mining_id.Which() == MiningId::Kind::CPID) {
+            assert(claim.Sign(m_beacon_keys[staker], m_prev_hash, coinstake));
+        }
+
+        CTransaction coinbase;
+        coinbase.nTime = m_time;
+        coinbase.vin.resize(1);
+        coinbase.vin[0].prevout.SetNull();
+        coinbase.vin[0].scriptSig = CScript() << m_height << OP_0;
+        coinbase.vout.resize(1);
+        coinbase.vout[0].SetEmpty();
+        coinbase.vContracts.emplace_back(MakeContract<Claim>(ContractAction::ADD, std::move(claim)));
+
+        return coinbase;
+    }
+};
+} // Anonymous namespace
+
+int bench_chain::GetStartHeight()
+{
+    return Params().GetConsensus().BlockV12Height;
+}
+
+void bench_chain::GenerateChain(const ChainOptions& options, const std::function<void(const CBlock&)>& sink)
+{
+    ChainGenerator generator(options);
+
+    for (size_t i = 0; i < options.m_blocks; ++i) {
+        sink(generator.GenerateBlock(i));
+    }
+}
+
+bool bench_chain::WriteChain(const ChainOptions& options, const fs::path& dir)
+{
+    fs::create_directories(dir);
+
+    unsigned int file_number = 1;
+    auto fileout = std::make_unique<CAutoFile>(
+        fsbridge::fopen(GetBlockFilePath(dir, file_number), "wb"),
+        SER_DISK,
+        CLIENT_VERSION);
+
+    GenerateChain(options, [&](const CBlock& block) {
+        if (fileout->IsNull()) {
+            return;
+        }
+
+        // Roll over to a new file at the size limit of the node:
+        if (ftell(fileout->Get()) >= (long)(0x7F000000 - MAX_SIZE)) {
+            fileout = std::make_unique<CAutoFile>(
+                fsbridge::fopen(GetBlockFilePath(dir, ++file_number), "wb"),
+                SER_DISK,
+                CLIENT_VERSION);
+
+            if (fileout->IsNull()) {
+                return;
+            }
+        }
+
+        const unsigned int size = GetSerializeSize(*fileout, block);
+        *fileout << Params().MessageStart() << size << block;
+    });
+
+    return !fileout->IsNull();
+}
+
+fs::path bench_chain::GetBlockFilePath(const fs::path& dir, const unsigned int file_number)
+{
+    return dir / strprintf("blk%04u.dat", file_number);
+}
+
+bool bench_chain::HasBlockFiles(const fs::path& dir)
+{
+    return fs::exists(GetBlockFilePath(dir, 1));
+}
@@ -0,0 +1,146 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_BENCH_CHAIN_H
+#define BITCOIN_BENCH_CHAIN_H
+
+#include "fs.h"
+
+#include <univalue.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class CBlock;
+
+namespace bench_chain {
+//!
+//! \brief Describes the synthetic chain to generate.
+//!
+//! The defaults approximate the mix of the main network with a denser
+//! schedule of contracts and superblocks so that a chain of a few thousand
+//! blocks exercises every kind of payload.
+//!
+struct ChainOptions
+{
+    size_t m_blocks = 2000;                //!< Number of blocks to generate.
+    size_t m_txs_per_block = 20;           //!< Ordinary transactions in each block.
+    size_t m_stakers = 50;                 //!< Number of staking keys.
+    size_t m_researchers = 20;             //!< Stakers with a beacon that claim research rewards.
+    size_t m_contract_interval = 4;        //!< Blocks between beacon, poll, and vote contracts.
+    size_t m_mrc_interval = 10;            //!< Blocks between MRC contracts.
+    size_t m_superblock_interval = 240;    //!< Blocks between superblocks.
+    size_t m_superblock_cpids = 2000;      //!< CPIDs in each superblock.
+    size_t m_superblock_projects = 20;     //!< Projects in each superblock.
+};
+
+//!
+//! \brief Get the height of the first block of a synthetic chain: the first
+//! block version 12 height of the selected network.
+//!
+int GetStartHeight();
+
+//!
+//! \brief Generate a deterministic chain of signed version 12 blocks.
+//!
+//! The blocks link by their hashes and carry the data of a busy network:
+//! investor and research reward claims signed with beacon keys, superblocks,
+//! beacon, poll, vote, and MRC contracts with their burn outputs, sidestake
+//! and MRC payout outputs in the coinstakes, and pay-to-pubkey-hash payments
+//! that spend the outputs of earlier blocks. Each block passes CheckBlock()
+//! with its signature checks.
+//!
+//! The chain does NOT satisfy the contextual consensus rules: the stake
+//! kernels, the difficulty, and the rewards are not valid, so a node cannot
+//! connect the blocks. The inputs of the first block spend outputs that the
+//! chain does not contain.
+//!
+//! The same options generate the same blocks.
+//!
+//! \param options Describes the chain.
+//! \param sink    Receives each block in order.
+//!
+void GenerateChain(const ChainOptions& options, const std::function<void(const CBlock&)>& sink);
+
+//!
+//! \brief Generate a chain into block files in the format of the node: the
+//! message start, the size, and the block, in files named blk0001.dat and up.
+//!
+//! \return \c false if a file cannot be written.
+//!
+bool WriteChain(const ChainOptions& options, const fs::path& dir);
+
+//!
+//! \brief Get the path of a block file in a directory. Numbers start at 1.
+//!
+fs::path GetBlockFilePath(const fs::path& dir, unsigned int file_number);
+
+//!
+//! \brief Determine whether a directory contains block files to replay.
+//!
+bool HasBlockFiles(const fs::path& dir);
+
+//!
+//! \brief Measurements of a replay of block files.
+//!
+struct ReplayStats
+{
+    //!
+    //! \brief The time spent in each stage of the replay, in microseconds.
+    //!
+    struct Stages
+    {
+        int64_t m_read_us = 0;       //!< Scan the files and deserialize the blocks.
+        int64_t m_check_us = 0;      //!< CheckBlock() with the signature checks.
+        int64_t m_contracts_us = 0;  //!< Check the contracts and their signatures.
+        int64_t m_scripts_us = 0;    //!< Verify the input scripts and update the outputs.
+    };
+
+    uint64_t m_blocks = 0;
+    uint64_t m_transactions = 0;
+    uint64_t m_inputs = 0;
+    uint64_t m_unknown_inputs = 0;     //!< Inputs that spend outputs outside of the files.
+    uint64_t m_contracts = 0;
+    uint64_t m_superblocks = 0;
+    uint64_t m_tx_hashes = 0;          //!< Transaction hashes computed to process the blocks.
+    uint64_t m_bytes = 0;
+    uint64_t m_failures = 0;           //!< Blocks that failed a check.
+    std::string m_first_failure;
+
+    Stages m_stages;
+    int64_t m_elapsed_us = 0;
+    std::vector<int64_t> m_block_us;   //!< Time to process each block after reading it.
+    int64_t m_peak_rss_kb = 0;         //!< Peak resident set size of the process.
+};
+
+//!
+//! \brief Replay the block files in a directory the way that a node imports
+//! them with -loadblock, without connecting the blocks to a chain.
+//!
+//! Each block goes through the checks that do not need the chain state:
+//! CheckBlock() with the signature checks, CheckContracts(), the signatures
+//! of the claims, beacons, polls, votes, and MRCs against the beacon keys
+//! seen earlier in the files, and the input scripts against the outputs seen
+//! earlier in the files.
+//!
+//! \param dir          Directory of the block files.
+//! \param start_height Height of the first block in the files.
+//!
+ReplayStats ReplayBlockFiles(const fs::path& dir, int start_height);
+
+//!
+//! \brief Format the results of a replay as a table for the console.
+//!
+std::string FormatReplayReport(const ReplayStats& stats);
+
+//!
+//! \brief Format the results of a replay as JSON to compare between builds.
+//!
+UniValue ReplayReportToJson(const ReplayStats& stats);
+} // namespace bench_chain
+
+#endif // BITCOIN_BENCH_CHAIN_H
@@ -0,0 +1,108 @@
+// Copyright (c) 2016-2018 The Bitcoin Core developers
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data.h>
+
+#include "gridcoin/cpid.h"
+#include "main.h"
+#include "streams.h"
+#include "validation.h"
+
+// These are the time-sinks which happen after we have fully received a block
+// off the wire, before we can connect it, and when the block index is written
+// to and loaded from disk.
+
+static void DeserializeBlockTest(benchmark::State& state)
+{
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+    stream << bench_data::MakeBlock(1000);
+
+    // Note that CDataStream::read() consumes the data, so copy the stream for
+    // each iteration:
+    while (state.KeepRunning()) {
+        CDataStream copy(stream);
+        CBlock block;
+        copy >> block;
+        assert(copy.empty());
+    }
+}
+
+static void SerializeBlockTest(benchmark::State& state)
+{
+    const CBlock block = bench_data::MakeBlock(1000);
+
+    while (state.KeepRunning()) {
+        CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+        stream.reserve(GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION));
+        stream << block;
+    }
+}
+
+static void DeserializeAndCheckBlockTest(benchmark::State& state)
+{
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+    stream << bench_data::MakeBlock(1000);
+
+    LOCK(cs_main);
+
+    while (state.KeepRunning()) {
+        CDataStream copy(stream);
+        CBlock block;
+        copy >> block;
+
+        // Skip the proof-of-work and signature checks: the synthetic block has
+        // neither. This leaves the size, transaction, duplicate, sigop and
+        // merkle root checks that every block goes through.
+        bool checked = CheckBlock(block, nGrandfather + 1, false, true, false);
+        assert(checked);
+    }
+}
+
+static void TransactionRoundTrip(benchmark::State& state)
+{
+    const CBlock block = bench_data::MakeBlock(2);
+    const CTransaction& tx = block.vtx.back();
+
+    while (state.KeepRunning()) {
+        CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+        stream << tx;
+
+        CTransaction copy;
+        stream >> copy;
+        assert(copy.GetHash() == tx.GetHash());
+    }
+}
+
+static void DiskBlockIndexRoundTrip(benchmark::State& state)
+{
+    CBlock block = bench_data::MakeBlock(2);
+    const uint256 hash = block.GetHash(true);
+
+    CBlockIndex pindex_prev;
+    CBlockIndex pindex(0, 0, block);
+    pindex.pprev = &pindex_prev;
+    pindex.phashBlock = &hash;
+    pindex.nHeight = nGrandfather + 1;
+    pindex.SetResearcherContext(GRC::Cpid::Parse("00010203040506070809101112131415"), 10 * COIN, 1234);
+
+    // Each read takes a researcher context from the block index pool like the
+    // block index load does, so keep the iteration count moderate.
+
+    while (state.KeepRunning()) {
+        CDataStream stream(SER_DISK, PROTOCOL_VERSION);
+        stream << CDiskBlockIndex(&pindex);
+
+        CDiskBlockIndex disk_index;
+        stream >> disk_index;
+        assert(disk_index.nHeight == pindex.nHeight);
+    }
+}
+
+BENCHMARK(DeserializeBlockTest, 1300);
+BENCHMARK(SerializeBlockTest, 2500);
+BENCHMARK(DeserializeAndCheckBlockTest, 500);
+BENCHMARK(TransactionRoundTrip, 400 * 1000);
+BENCHMARK(DiskBlockIndexRoundTrip, 100 * 1000);
@@ -0,0 +1,91 @@
+// Copyright (c) 2016-2018 The Bitcoin Core developers
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include "crypto/ripemd160.h"
+#include "crypto/sha256.h"
+#include "crypto/sha512.h"
+#include "hash.h"
+#include "scrypt.h"
+#include "uint256.h"
+
+#include <vector>
+
+/* Number of bytes to hash per iteration */
+static const uint64_t BUFFER_SIZE = 1000*1000;
+
+static void RIPEMD160(benchmark::State& state)
+{
+    uint8_t hash[CRIPEMD160::OUTPUT_SIZE];
+    std::vector<uint8_t> in(BUFFER_SIZE,0);
+    while (state.KeepRunning())
+        CRIPEMD160().Write(in.data(), in.size()).Finalize(hash);
+}
+
+static void SHA256(benchmark::State& state)
+{
+    uint8_t hash[CSHA256::OUTPUT_SIZE];
+    std::vector<uint8_t> in(BUFFER_SIZE,0);
+    while (state.KeepRunning())
+        CSHA256().Write(in.data(), in.size()).Finalize(hash);
+}
+
+static void SHA256_32b(benchmark::State& state)
+{
+    std::vector<uint8_t> in(32,0);
+    while (state.KeepRunning()) {
+        CSHA256()
+            .Write(in.data(), in.size())
+            .Finalize(in.data());
+    }
+}
+
+static void SHA256D64_1024(benchmark::State& state)
+{
+    std::vector<uint8_t> in(64 * 1024, 0);
+    while (state.KeepRunning()) {
+        SHA256D64(in.data(), in.data(), 1024);
+    }
+}
+
+static void SHA512(benchmark::State& state)
+{
+    uint8_t hash[CSHA512::OUTPUT_SIZE];
+    std::vector<uint8_t> in(BUFFER_SIZE,0);
+    while (state.KeepRunning())
+        CSHA512().Write(in.data(), in.size()).Finalize(hash);
+}
+
+//! Double-SHA256 of a block header, the hash of version 7+ blocks.
+static void HashBlockHeader(benchmark::State& state)
+{
+    std::vector<uint8_t> in(80, 0);
+    uint256 hash;
+    while (state.KeepRunning()) {
+        hash = Hash(in);
+        in[0] = hash.GetUint64(0);
+    }
+}
+
+//! Scrypt proof-of-work hash of a block header, which the legacy blocks used.
+static void ScryptBlockHash(benchmark::State& state)
+{
+    std::vector<uint8_t> in(80, 0);
+    uint256 hash;
+    while (state.KeepRunning()) {
+        hash = scrypt_blockhash(in.data());
+        in[0] = hash.GetUint64(0);
+    }
+}
+
+BENCHMARK(RIPEMD160, 440);
+BENCHMARK(SHA256, 340);
+BENCHMARK(SHA512, 330);
+
+BENCHMARK(SHA256_32b, 4700 * 1000);
+BENCHMARK(SHA256D64_1024, 7400);
+BENCHMARK(HashBlockHeader, 2000 * 1000);
+BENCHMARK(ScryptBlockHash, 5000);
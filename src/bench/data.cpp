@@ -0,0 +1,114 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <bench/data.h>
+
+#include "consensus/merkle.h"
+#include "script.h"
+
+namespace {
+constexpr uint32_t BLOCK_TIME = 1600000000;
+
+uint256 FakeHash(uint64_t seed)
+{
+    return Hash(MakeUCharSpan(std::to_string(seed)));
+}
+
+CScript FakeScriptSig(uint64_t seed)
+{
+    // About the size of a DER signature and a compressed public key:
+    std::vector<unsigned char> sig(72, seed & 0xff);
+    std::vector<unsigned char> pubkey(33, (seed >> 8) & 0xff);
+
+    return CScript() << sig << pubkey;
+}
+
+CScript FakeScriptPubKey(uint64_t seed)
+{
+    const uint256 hash = FakeHash(seed);
+
+    return CScript()
+        << OP_DUP
+        << OP_HASH160
+        << std::vector<unsigned char>(hash.begin(), hash.begin() + 20)
+        << OP_EQUALVERIFY
+        << OP_CHECKSIG;
+}
+
+CTransaction MakeTransaction(uint64_t seed)
+{
+    CTransaction tx;
+    tx.nVersion = 1;
+    tx.nTime = BLOCK_TIME;
+
+    for (uint64_t i = 0; i < 2; ++i) {
+        tx.vin.emplace_back(COutPoint(FakeHash(seed * 4 + i), i), FakeScriptSig(seed + i));
+    }
+
+    for (uint64_t i = 0; i < 2; ++i) {
+        tx.vout.emplace_back((seed % 1000 + 1) * COIN, FakeScriptPubKey(seed * 4 + 2 + i));
+    }
+
+    return tx;
+}
+} // Anonymous namespace
+
+CBlock bench_data::MakeBlock(size_t num_txs)
+{
+    CBlock block;
+    block.nVersion = 10;
+    block.hashPrevBlock = FakeHash(0);
+    block.nTime = BLOCK_TIME;
+    block.nBits = 0x1d00ffff;
+
+    CTransaction coinbase;
+    coinbase.nVersion = 1;
+    coinbase.nTime = BLOCK_TIME;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].prevout.SetNull();
+    coinbase.vin[0].scriptSig = CScript() << 1234567 << OP_0;
+    coinbase.vout.resize(1);
+    coinbase.vout[0].SetEmpty();
+    block.vtx.push_back(coinbase);
+
+    CTransaction coinstake;
+    coinstake.nVersion = 1;
+    coinstake.nTime = BLOCK_TIME;
+    coinstake.vin.emplace_back(COutPoint(FakeHash(1), 1), FakeScriptSig(1));
+    coinstake.vout.resize(1);
+    coinstake.vout[0].SetEmpty();
+    coinstake.vout.emplace_back(1000 * COIN, FakeScriptPubKey(1));
+    block.vtx.push_back(coinstake);
+
+    for (size_t i = 0; i < num_txs; ++i) {
+        block.vtx.push_back(MakeTransaction(i + 2));
+    }
+
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+
+    return block;
+}
+
+GRC::Cpid bench_data::MakeCpid(uint64_t seed)
+{
+    const uint256 hash = FakeHash(seed);
+
+    return GRC::Cpid(std::vector<unsigned char>(hash.begin(), hash.begin() + 16));
+}
+
+GRC::Superblock bench_data::MakeSuperblock(size_t num_cpids, size_t num_projects)
+{
+    GRC::Superblock superblock;
+
+    for (size_t i = 0; i < num_cpids; ++i) {
+        // Spread the magnitudes over the small, medium, and large classes:
+        superblock.m_cpids.Add(MakeCpid(i), GRC::Magnitude::RoundFrom((i % 20000) / 10.0 + 0.01));
+    }
+
+    for (size_t i = 0; i < num_projects; ++i) {
+        superblock.m_projects.Add("project_" + std::to_string(i), GRC::Superblock::ProjectStats(1000 + i, 100000 + i * 1000));
+    }
+
+    return superblock;
+}
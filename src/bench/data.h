@@ -0,0 +1,42 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_BENCH_DATA_H
+#define BITCOIN_BENCH_DATA_H
+
+#include "gridcoin/cpid.h"
+#include "gridcoin/superblock.h"
+#include "main.h"
+
+#include <cstddef>
+
+namespace bench_data {
+//!
+//! \brief Build a deterministic proof-of-stake block for the benchmarks.
+//!
+//! The block has a version 10 layout: a coinbase with an empty output, a
+//! coinstake, and \p num_txs ordinary transactions that each spend two inputs
+//! into two pay-to-pubkey-hash outputs with signature-sized scripts. It passes
+//! CheckBlock() with the proof-of-work and signature checks disabled.
+//!
+//! \param num_txs Number of transactions after the coinstake.
+//!
+CBlock MakeBlock(size_t num_txs);
+
+//!
+//! \brief Get a deterministic CPID for a number.
+//!
+GRC::Cpid MakeCpid(uint64_t seed);
+
+//!
+//! \brief Build a deterministic superblock of about the size of the mainnet
+//! superblocks or larger.
+//!
+//! \param num_cpids     Number of CPIDs with magnitude, from MakeCpid(0) up.
+//! \param num_projects  Number of whitelisted projects.
+//!
+GRC::Superblock MakeSuperblock(size_t num_cpids, size_t num_projects);
+} // namespace bench_data
+
+#endif // BITCOIN_BENCH_DATA_H
@@ -0,0 +1,70 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+
+#include "hash.h"
+#include "main.h"
+#include "txdb.h"
+
+namespace {
+constexpr int REORG_DEPTH = 500;
+constexpr int TXS_PER_BLOCK = 20;
+
+uint256 GetTxHash(const int height, const int n)
+{
+    return (CHashWriter(SER_GETHASH, 0) << height << n).GetHash();
+}
+} // Anonymous namespace
+
+// Reorganizing the chain disconnects and connects every block in a single
+// transaction of the transaction database. Each block reads back the index
+// entries that earlier blocks in the same batch wrote, so the cost of those
+// reads decides whether a deep reorganization takes linear or quadratic time.
+
+static void ReorganizeTxIndex(benchmark::State& state)
+{
+    CTxDB txdb;
+
+    while (state.KeepRunning()) {
+        bool ok = txdb.TxnBegin();
+
+        for (int height = 0; height < REORG_DEPTH; ++height) {
+            for (int n = 0; n < TXS_PER_BLOCK; ++n) {
+                const CDiskTxPos pos(1, height, n);
+
+                if (height > 0) {
+                    CTxIndex prev;
+                    ok &= txdb.ReadTxIndex(GetTxHash(height - 1, n), prev);
+                    prev.vSpent[0] = pos;
+                    ok &= txdb.UpdateTxIndex(GetTxHash(height - 1, n), prev);
+                }
+
+                ok &= txdb.UpdateTxIndex(GetTxHash(height, n), CTxIndex(pos, 1));
+            }
+        }
+
+        for (int height = REORG_DEPTH - 1; height >= 0; --height) {
+            for (int n = 0; n < TXS_PER_BLOCK; ++n) {
+                CTxIndex txindex;
+                ok &= txdb.ReadTxIndex(GetTxHash(height, n), txindex);
+
+                if (height > 0) {
+                    CTxIndex prev;
+                    ok &= txdb.ReadTxIndex(GetTxHash(height - 1, n), prev);
+                    prev.vSpent[0].SetNull();
+                    ok &= txdb.UpdateTxIndex(GetTxHash(height - 1, n), prev);
+                }
+
+                ok &= txdb.EraseGenericSerializable(std::make_pair(std::string("tx"), GetTxHash(height, n)));
+            }
+        }
+
+        // Leave the database unchanged for the next iteration:
+        ok &= txdb.TxnAbort();
+        assert(ok);
+    }
+}
+
+BENCHMARK(ReorganizeTxIndex, 5);
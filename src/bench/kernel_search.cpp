@@ -0,0 +1,108 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data.h>
+
+#include "gridcoin/staking/kernel.h"
+#include "gridcoin/staking/kernel_search.h"
+
+namespace {
+//!
+//! \brief Number of coins in the benchmark wallet. A large staking wallet.
+//!
+constexpr size_t NUM_COINS = 50000;
+constexpr uint32_t BLOCK_TIME = 1700000000;
+constexpr uint64_t STAKE_MODIFIER = 0x0123456789abcdef;
+
+//!
+//! \brief A target that practically no kernel meets, so that each search
+//! hashes every coin as the miner does for most timestamps.
+//!
+constexpr unsigned int HARD_BITS = 0x03000001;
+
+std::vector<CTransaction> MakeCoins()
+{
+    // Take the coins from the transactions of a synthetic block. Each has two
+    // outputs:
+    CBlock block = bench_data::MakeBlock(NUM_COINS / 2);
+    block.vtx.erase(block.vtx.begin(), block.vtx.begin() + 2);
+
+    return std::move(block.vtx);
+}
+} // Anonymous namespace
+
+//!
+//! \brief Search the kernels of a large wallet for one timestamp with the
+//! prepared kernel search that the miner uses.
+//!
+static void StakeKernelSearchFind(benchmark::State& state)
+{
+    GRC::StakeKernelSearch search(STAKE_MODIFIER, HARD_BITS);
+
+    for (const auto& tx : MakeCoins()) {
+        for (uint32_t n = 0; n < tx.vout.size(); ++n) {
+            search.AddCandidate(COutPoint(tx.GetHash(), n), tx.vout[n].nValue, BLOCK_TIME);
+        }
+    }
+
+    uint32_t tx_time = BLOCK_TIME + 86400;
+
+    while (state.KeepRunning()) {
+        bool found = search.Find(tx_time).has_value();
+        assert(!found);
+
+        // The protocol masks the transaction time to 16 seconds:
+        tx_time += 16;
+    }
+}
+
+//!
+//! \brief The same search with the kernels hashed one at a time, as a baseline
+//! for the batched hashing in StakeKernelSearchFind.
+//!
+static void StakeKernelSearchFindSerial(benchmark::State& state)
+{
+    GRC::StakeKernelSearch search(STAKE_MODIFIER, HARD_BITS);
+
+    for (const auto& tx : MakeCoins()) {
+        for (uint32_t n = 0; n < tx.vout.size(); ++n) {
+            search.AddCandidate(COutPoint(tx.GetHash(), n), tx.vout[n].nValue, BLOCK_TIME);
+        }
+    }
+
+    uint32_t tx_time = BLOCK_TIME + 86400;
+
+    while (state.KeepRunning()) {
+        bool found = search.FindSerial(tx_time).has_value();
+        assert(!found);
+
+        tx_time += 16;
+    }
+}
+
+//!
+//! \brief The same search with a kernel hash calculated from scratch for each
+//! coin, as a baseline for StakeKernelSearchFind.
+//!
+static void StakeKernelHashV8(benchmark::State& state)
+{
+    const std::vector<CTransaction> coins = MakeCoins();
+
+    uint32_t tx_time = BLOCK_TIME + 86400;
+
+    while (state.KeepRunning()) {
+        for (const auto& tx : coins) {
+            for (uint32_t n = 0; n < tx.vout.size(); ++n) {
+                GRC::CalculateStakeHashV8(BLOCK_TIME, tx, n, tx_time, STAKE_MODIFIER);
+            }
+        }
+
+        tx_time += 16;
+    }
+}
+
+BENCHMARK(StakeKernelSearchFind, 100);
+BENCHMARK(StakeKernelSearchFindSerial, 100);
+BENCHMARK(StakeKernelHashV8, 20);
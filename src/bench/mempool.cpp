@@ -0,0 +1,100 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data.h>
+
+#include "txmempool.h"
+
+namespace {
+//!
+//! \brief Number of transactions in the benchmark pool. Several times more
+//! than a busy mainnet pool to expose costs that grow with the pool size.
+//!
+constexpr size_t NUM_TXS = 50000;
+
+//!
+//! \brief Length of the chains of unconfirmed transactions that spend each
+//! other in the benchmark pool.
+//!
+constexpr size_t CHAIN_LENGTH = 10;
+
+struct PoolTx
+{
+    CTransaction m_tx;
+    uint256 m_hash;
+    CAmount m_fee;
+};
+
+std::vector<PoolTx> MakePoolTxs()
+{
+    CBlock block = bench_data::MakeBlock(NUM_TXS);
+    std::vector<PoolTx> txs;
+    txs.reserve(NUM_TXS);
+
+    for (size_t i = 0; i < NUM_TXS; ++i) {
+        CTransaction tx = std::move(block.vtx[i + 2]);
+
+        // The first transaction of each chain spends confirmed coins. The rest
+        // spend the first output of the previous transaction:
+        if (i % CHAIN_LENGTH != 0) {
+            tx.vin[0].prevout = COutPoint(txs.back().m_hash, 0);
+        }
+
+        const uint256 hash = tx.GetHash();
+        const CAmount fee = 10000 + (i * 7919) % 1000000;
+
+        txs.push_back({ std::move(tx), hash, fee });
+    }
+
+    return txs;
+}
+} // Anonymous namespace
+
+//!
+//! \brief Fill the pool and walk it in fee rate order as block assembly does.
+//!
+static void MempoolAddAndSelect(benchmark::State& state)
+{
+    const std::vector<PoolTx> txs = MakePoolTxs();
+
+    while (state.KeepRunning()) {
+        CTxMemPool pool;
+
+        for (const auto& pool_tx : txs) {
+            pool.addUnchecked(pool_tx.m_hash, pool_tx.m_tx, pool_tx.m_fee, 1700000000);
+        }
+
+        LOCK(pool.cs);
+
+        uint64_t size = 0;
+
+        for (const auto& entry : pool.GetByFeeRate()) {
+            size += pool.GetEntry(entry.second)->GetSizeWithAncestors();
+        }
+
+        assert(size > 0);
+    }
+}
+
+//!
+//! \brief Fill the pool and evict the lowest fee rate half of it.
+//!
+static void MempoolTrim(benchmark::State& state)
+{
+    const std::vector<PoolTx> txs = MakePoolTxs();
+
+    while (state.KeepRunning()) {
+        CTxMemPool pool;
+
+        for (const auto& pool_tx : txs) {
+            pool.addUnchecked(pool_tx.m_hash, pool_tx.m_tx, pool_tx.m_fee, 1700000000);
+        }
+
+        pool.TrimToSize(pool.DynamicMemoryUsage() / 2);
+    }
+}
+
+BENCHMARK(MempoolAddAndSelect, 2);
+BENCHMARK(MempoolTrim, 2);
@@ -0,0 +1,472 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/chain.h>
+
+#include "chainparams.h"
+#include "clientversion.h"
+#include "gridcoin/beacon.h"
+#include "gridcoin/claim.h"
+#include "gridcoin/mrc.h"
+#include "gridcoin/voting/claims.h"
+#include "gridcoin/voting/payloads.h"
+#include "gridcoin/voting/vote.h"
+#include "main.h"
+#include "protocol.h"
+#include "script.h"
+#include "streams.h"
+#include "util.h"
+#include "util/time.h"
+#include "validation.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace GRC;
+using namespace bench_chain;
+
+namespace {
+int64_t GetPeakRssKb()
+{
+#ifndef WIN32
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef MAC_OSX
+        return usage.ru_maxrss / 1024;
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+
+    return 0;
+}
+
+//!
+//! \brief Read the next block from a block file the way that
+//! LoadExternalBlockFile() scans for the message start.
+//!
+//! \return \c false at the end of the file.
+//!
+bool ReadNextBlock(CAutoFile& blkdat, unsigned int& pos, CBlock& block, unsigned int& size)
+{
+    const CMessageHeader::MessageStartChars& message_start = Params().MessageStart();
+    unsigned char buffer[65536];
+
+    while (true) {
+        fseek(blkdat.Get(), pos, SEEK_SET);
+        const size_t read = fread(buffer, 1, sizeof(buffer), blkdat.Get());
+
+        if (read <= 8) {
+            return false;
+        }
+
+        const void* found = memchr(buffer, message_start[0], read + 1 - CMessageHeader::MESSAGE_START_SIZE);
+
+        if (!found) {
+            pos += sizeof(buffer) - CMessageHeader::MESSAGE_START_SIZE + 1;
+            continue;
+        }
+
+        pos += (const unsigned char*)found - buffer;
+
+        if (memcmp(found, message_start, CMessageHeader::MESSAGE_START_SIZE) != 0) {
+            ++pos;
+            continue;
+        }
+
+        pos += CMessageHeader::MESSAGE_START_SIZE;
+
+        fseek(blkdat.Get(), pos, SEEK_SET);
+        blkdat >> size;
+
+        if (size > 0 && size <= MAX_BLOCK_SIZE) {
+            blkdat >> block;
+            pos += 4 + size;
+
+            return true;
+        }
+    }
+}
+
+//!
+//! \brief Runs the checks of the replay stages and keeps the state that they
+//! accumulate from earlier blocks.
+//!
+class Replayer
+{
+public:
+    explicit Replayer(ReplayStats& stats) : m_stats(stats)
+    {
+    }
+
+    void ProcessBlock(CBlock& block, const int height) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+    {
+        std::string failure;
+
+        const uint64_t hashes_start = CTransaction::GetHashComputations();
+        const int64_t check_start = GetTimeMicros();
+
+        // Like ::ProcessBlock(), share the transaction hashes between stages:
+        block.CacheTxHashes();
+
+        const bool checked = CheckBlock(block, height, true, true, true, false);
+        const int64_t contracts_start = GetTimeMicros();
+
+        if (!checked) {
+            failure = "CheckBlock() failed";
+        } else {
+            CheckBlockContracts(block, height, failure);
+        }
+
+        const int64_t scripts_start = GetTimeMicros();
+
+        if (failure.empty()) {
+            ConnectScripts(block, failure);
+        }
+
+        const int64_t end = GetTimeMicros();
+
+        m_stats.m_stages.m_check_us += contracts_start - check_start;
+        m_stats.m_stages.m_contracts_us += scripts_start - contracts_start;
+        m_stats.m_stages.m_scripts_us += end - scripts_start;
+        m_stats.m_block_us.push_back(end - check_start);
+        m_stats.m_transactions += block.vtx.size();
+        m_stats.m_tx_hashes += CTransaction::GetHashComputations() - hashes_start;
+
+        if (!failure.empty()) {
+            if (m_stats.m_failures++ == 0) {
+                m_stats.m_first_failure = strprintf("block %s at height %d: %s",
+                                                    block.GetHash(true).ToString(), height, failure);
+            }
+        }
+    }
+
+private:
+    ReplayStats& m_stats;
+    std::map<COutPoint, CTxOut> m_outputs;   //!< Unspent outputs of the replayed blocks.
+    std::map<Cpid, CPubKey> m_beacons;       //!< Beacon keys of the replayed beacon contracts.
+
+    bool CheckBlockContracts(const CBlock& block, const int height, std::string& failure)
+    {
+        const Claim& claim = block.GetClaim();
+
+        if (const CpidOption cpid = claim.m_mining_id.TryCpid()) {
+            const auto iter = m_beacons.find(*cpid);
+
+            if (iter == m_beacons.end()
+                || !claim.VerifySignature(iter->second, block.hashPrevBlock, block.vtx[1]))
+            {
+                failure = "bad research reward claim signature";
+                return false;
+            }
+        }
+
+        if (claim.ContainsSuperblock()) {
+            ++m_stats.m_superblocks;
+
+            if (claim.m_quorum_hash != claim.m_superblock->GetHash()) {
+                failure = "superblock does not match the quorum hash";
+                return false;
+            }
+        }
+
+        std::set<uint256> txids;
+
+        for (const auto& tx : block.vtx) {
+            txids.insert(tx.GetHash());
+        }
+
+        for (const auto& mrc_tx : claim.m_mrc_tx_map) {
+            if (!txids.count(mrc_tx.second)) {
+                failure = "claim refers to an MRC outside of the block";
+                return false;
+            }
+        }
+
+        // The chain state holds the inputs that CheckContracts() needs for
+        // administrative contracts. Synthetic chains do not contain them:
+        const MapPrevTx no_inputs;
+
+        for (size_t i = 2; i < block.vtx.size(); ++i) {
+            const CTransaction& tx = block.vtx[i];
+
+            if (!CheckContracts(tx, no_inputs, height)) {
+                failure = "CheckContracts() failed for " + tx.GetHash().ToString();
+                return false;
+            }
+
+            for (const auto& contract : tx.GetContracts()) {
+                ++m_stats.m_contracts;
+
+                if (!CheckContractSignature(block, tx, contract)) {
+                    failure = strprintf("bad %s contract signature in %s",
+                                        contract.m_type.ToString(), tx.GetHash().ToString());
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool CheckContractSignature(const CBlock& block, const CTransaction& tx, const Contract& contract)
+    {
+        switch (contract.m_type.Value()) {
+            case ContractType::BEACON: {
+                const auto payload = contract.SharePayloadAs<BeaconPayload>();
+
+                if (contract.m_action == ContractAction::ADD) {
+                    if (!payload->VerifySignature()) {
+                        return false;
+                    }
+
+                    m_beacons[payload->m_cpid] = payload->m_beacon.m_public_key;
+                }
+
+                return true;
+            }
+            case ContractType::POLL: {
+                const auto payload = contract.SharePayloadAs<PollPayload>();
+
+                return payload->m_claim.m_address_claim.VerifySignature(PackPollMessage(payload->m_poll, tx));
+            }
+            case ContractType::VOTE: {
+                const auto vote = contract.SharePayloadAs<Vote>();
+                const ClaimMessage message = PackVoteMessage(*vote, tx);
+
+                for (const auto& address_claim : vote->m_claim.m_balance_claim.m_address_claims) {
+                    if (!address_claim.VerifySignature(message)) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+            case ContractType::MRC: {
+                const auto mrc = contract.SharePayloadAs<MRC>();
+                const CpidOption cpid = mrc->m_mining_id.TryCpid();
+
+                if (!cpid || mrc->m_last_block_hash != block.hashPrevBlock) {
+                    return false;
+                }
+
+                const auto iter = m_beacons.find(*cpid);
+
+                return iter != m_beacons.end() && mrc->VerifySignature(iter->second, mrc->m_last_block_hash);
+            }
+            default:
+                return true;
+        }
+    }
+
+    void ConnectScripts(const CBlock& block, std::string& failure)
+    {
+        for (const auto& tx : block.vtx) {
+            if (!tx.IsCoinBase()) {
+                for (unsigned int i = 0; i < tx.vin.size(); ++i) {
+                    ++m_stats.m_inputs;
+
+                    const auto iter = m_outputs.find(tx.vin[i].prevout);
+
+                    if (iter == m_outputs.end()) {
+                        ++m_stats.m_unknown_inputs;
+                        continue;
+                    }
+
+                    if (!VerifyScript(tx.vin[i].scriptSig, iter->second.scriptPubKey, tx, i, 0)) {
+                        failure = strprintf("bad signature for input %u of %s", i, tx.GetHash().ToString());
+                        return;
+                    }
+
+                    m_outputs.erase(iter);
+                }
+            }
+
+            const uint256 txid = tx.GetHash();
+
+            for (unsigned int i = 0; i < tx.vout.size(); ++i) {
+                const CTxOut& output = tx.vout[i];
+
+                if (!output.IsEmpty() && !output.scriptPubKey.IsUnspendable()) {
+                    m_outputs.emplace(COutPoint(txid, i), output);
+                }
+            }
+        }
+    }
+};
+
+double Percentile(std::vector<int64_t> values, const double percentile)
+{
+    if (values.empty()) {
+        return 0;
+    }
+
+    std::sort(values.begin(), values.end());
+
+    return values[std::min<size_t>(values.size() - 1, values.size() * percentile)];
+}
+
+double Seconds(const int64_t micros)
+{
+    return micros / 1000000.0;
+}
+} // Anonymous namespace
+
+ReplayStats bench_chain::ReplayBlockFiles(const fs::path& dir, const int start_height)
+{
+    ReplayStats stats;
+    Replayer replayer(stats);
+
+    LOCK(cs_main);
+
+    const int64_t start = GetTimeMicros();
+
+    for (unsigned int file_number = 1; ; ++file_number) {
+        CAutoFile blkdat(fsbridge::fopen(GetBlockFilePath(dir, file_number), "rb"), SER_DISK, CLIENT_VERSION);
+
+        if (blkdat.IsNull()) {
+            break;
+        }
+
+        unsigned int pos = 0;
+
+        while (true) {
+            const int64_t read_start = GetTimeMicros();
+
+            CBlock block;
+            unsigned int size = 0;
+
+            try {
+                if (!ReadNextBlock(blkdat, pos, block, size)) {
+                    break;
+                }
+            } catch (const std::exception& e) {
+                if (stats.m_failures++ == 0) {
+                    stats.m_first_failure = strprintf("blk%04u.dat at %u: %s", file_number, pos, e.what());
+                }
+
+                break;
+            }
+
+            stats.m_stages.m_read_us += GetTimeMicros() - read_start;
+            stats.m_bytes += size;
+
+            replayer.ProcessBlock(block, start_height + stats.m_blocks);
+            ++stats.m_blocks;
+        }
+    }
+
+    stats.m_elapsed_us = GetTimeMicros() - start;
+    stats.m_peak_rss_kb = GetPeakRssKb();
+
+    return stats;
+}
+
+std::string bench_chain::FormatReplayReport(const ReplayStats& stats)
+{
+    const double elapsed = std::max(Seconds(stats.m_elapsed_us), 1e-9);
+    const double megabytes = stats.m_bytes / 1e6;
+
+    std::string report = strprintf(
+        "Replayed %u blocks, %u transactions, %u inputs, %u contracts, %u superblocks, %.2f MB\n"
+        "Elapsed: %.3f s, %.1f blocks/s, %.2f MB/s, peak RSS: %.1f MB\n"
+        "Inputs that spend outputs outside of the files: %u\n"
+        "Transaction hashes computed: %u, %.1f per block\n"
+        "Block latency (us): p50 %.0f, p90 %.0f, p99 %.0f, max %.0f\n",
+        stats.m_blocks, stats.m_transactions, stats.m_inputs, stats.m_contracts, stats.m_superblocks, megabytes,
+        elapsed, stats.m_blocks / elapsed, megabytes / elapsed, stats.m_peak_rss_kb / 1024.0,
+        stats.m_unknown_inputs,
+        stats.m_tx_hashes, stats.m_blocks > 0 ? static_cast<double>(stats.m_tx_hashes) / stats.m_blocks : 0.0,
+        Percentile(stats.m_block_us, 0.5),
+        Percentile(stats.m_block_us, 0.9),
+        Percentile(stats.m_block_us, 0.99),
+        Percentile(stats.m_block_us, 1.0));
+
+    const std::vector<std::pair<std::string, int64_t>> stages {
+        { "read", stats.m_stages.m_read_us },
+        { "check_block", stats.m_stages.m_check_us },
+        { "contracts", stats.m_stages.m_contracts_us },
+        { "scripts", stats.m_stages.m_scripts_us },
+    };
+
+    report += "# Stage, seconds, share\n";
+
+    for (const auto& stage : stages) {
+        report += strprintf("%s, %.3f, %.1f%%\n",
+                            stage.first, Seconds(stage.second), 100 * Seconds(stage.second) / elapsed);
+    }
+
+    if (stats.m_failures > 0) {
+        report += strprintf("Failed blocks: %u (first: %s)\n", stats.m_failures, stats.m_first_failure);
+    }
+
+    return report;
+}
+
+UniValue bench_chain::ReplayReportToJson(const ReplayStats& stats)
+{
+    const double elapsed = std::max(Seconds(stats.m_elapsed_us), 1e-9);
+
+    UniValue stages(UniValue::VOBJ);
+    stages.pushKV("read", Seconds(stats.m_stages.m_read_us));
+    stages.pushKV("check_block", Seconds(stats.m_stages.m_check_us));
+    stages.pushKV("contracts", Seconds(stats.m_stages.m_contracts_us));
+    stages.pushKV("scripts", Seconds(stats.m_stages.m_scripts_us));
+
+    UniValue latency(UniValue::VOBJ);
+    latency.pushKV("p50", Percentile(stats.m_block_us, 0.5));
+    latency.pushKV("p90", Percentile(stats.m_block_us, 0.9));
+    latency.pushKV("p99", Percentile(stats.m_block_us, 0.99));
+    latency.pushKV("max", Percentile(stats.m_block_us, 1.0));
+
+    UniValue json(UniValue::VOBJ);
+    json.pushKV("blocks", stats.m_blocks);
+    json.pushKV("transactions", stats.m_transactions);
+    json.pushKV("inputs", stats.m_inputs);
+    json.pushKV("unknown_inputs", stats.m_unknown_inputs);
+    json.pushKV("contracts", stats.m_contracts);
+    json.pushKV("superblocks", stats.m_superblocks);
+    json.pushKV("tx_hashes", stats.m_tx_hashes);
+    json.pushKV("bytes", stats.m_bytes);
+    json.pushKV("elapsed", elapsed);
+    json.pushKV("blocks_per_second", stats.m_blocks / elapsed);
+    json.pushKV("peak_rss_kb", stats.m_peak_rss_kb);
+    json.pushKV("stages", stages);
+    json.pushKV("block_latency_us", latency);
+    json.pushKV("failures", stats.m_failures);
+
+    if (stats.m_failures > 0) {
+        json.pushKV("first_failure", stats.m_first_failure);
+    }
+
+    return json;
+}
+
+static void ReplaySyntheticChain(benchmark::State& state)
+{
+    ChainOptions options;
+    options.m_blocks = 100;
+    options.m_superblock_interval = 50;
+
+    const fs::path dir = GetDataDir() / "replay_bench";
+
+    if (!HasBlockFiles(dir)) {
+        assert(WriteChain(options, dir));
+    }
+
+    while (state.KeepRunning()) {
+        const ReplayStats stats = ReplayBlockFiles(dir, GetStartHeight());
+        assert(stats.m_failures == 0 && stats.m_blocks == options.m_blocks);
+    }
+}
+
+BENCHMARK(ReplaySyntheticChain, 3);
@@ -0,0 +1,69 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data.h>
+
+#include "gridcoin/scraper/fwd.h"
+#include "support/allocators/zeroafterfree.h"
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <sstream>
+
+extern bool LoadProjectObjectToStatsByCPID(const std::string& project, const SerializeData& ProjectData,
+                                           const double& projectmag, ScraperStats& mScraperStats);
+
+namespace {
+constexpr size_t NUM_PROJECT_CPIDS = 20000;
+
+//!
+//! \brief Build a gzip-compressed project statistics file in the format that
+//! the scrapers publish in their manifests.
+//!
+SerializeData MakeProjectStatsFile()
+{
+    std::stringstream csv;
+    csv << "# total_credit,expavg_time,expavg_credit,cpid\n";
+
+    for (size_t i = 0; i < NUM_PROJECT_CPIDS; ++i) {
+        csv << (i + 1) * 12345 << ","
+            << 1700000000 - i << ","
+            << (i % 5000) * 3.25 + 0.5 << ","
+            << bench_data::MakeCpid(i).ToString() << "\n";
+    }
+
+    std::stringstream compressed;
+
+    boost::iostreams::filtering_istream in;
+    in.push(boost::iostreams::gzip_compressor());
+    in.push(csv);
+    boost::iostreams::copy(in, compressed);
+
+    const std::string data = compressed.str();
+    const std::byte* begin = reinterpret_cast<const std::byte*>(data.data());
+
+    return SerializeData(begin, begin + data.size());
+}
+} // Anonymous namespace
+
+//!
+//! \brief Decompress and parse the statistics of a project into CPID stats,
+//! the step of building the statistics from a convergence that runs for each
+//! project before a superblock can be built or validated.
+//!
+static void ScraperLoadProjectStats(benchmark::State& state)
+{
+    const SerializeData project_data = MakeProjectStatsFile();
+
+    while (state.KeepRunning()) {
+        ScraperStats stats;
+        bool loaded = LoadProjectObjectToStatsByCPID("project", project_data, 1000, stats);
+        assert(loaded && stats.size() >= NUM_PROJECT_CPIDS);
+    }
+}
+
+BENCHMARK(ScraperLoadProjectStats, 20);
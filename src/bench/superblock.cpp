@@ -0,0 +1,253 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data.h>
+
+#include "gridcoin/scraper/scraper.h"
+#include "streams.h"
+
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+namespace {
+//!
+//! \brief Number of CPIDs in the benchmark superblocks. About four times the
+//! number of CPIDs with magnitude in a mainnet superblock.
+//!
+constexpr size_t NUM_CPIDS = 20000;
+constexpr size_t NUM_PROJECTS = 30;
+
+//!
+//! \brief Number of CPIDs in each project part of the benchmark convergence.
+//!
+constexpr size_t NUM_PROJECT_CPIDS = 2000;
+
+//!
+//! \brief Build a compressed project statistics part like the ones that the
+//! scrapers publish in their manifests.
+//!
+CSplitBlob::CPart MakeProjectPart(const size_t project)
+{
+    std::stringstream compressed;
+
+    boost::iostreams::filtering_ostream out;
+    out.push(boost::iostreams::gzip_compressor());
+    out.push(compressed);
+
+    out << "# total credit,recent average total,recent average credit,cpid\n";
+
+    for (size_t i = 0; i < NUM_PROJECT_CPIDS; ++i) {
+        const size_t seed = project * NUM_PROJECT_CPIDS / 2 + i;
+
+        out << seed * 1000 << "," << seed * 20 << "," << seed * 10 << ","
+            << bench_data::MakeCpid(seed).ToString() << "\n";
+    }
+
+    out.reset();
+
+    const std::string data = compressed.str();
+    const Span<const std::byte> bytes = MakeByteSpan(data);
+    const SerializeData part_data(bytes.begin(), bytes.end());
+
+    CSplitBlob::CPart part(Hash(part_data));
+    part.data = part_data;
+
+    return part;
+}
+
+//!
+//! \brief Project parts of a by-project fallback convergence with two
+//! candidate parts for the first project.
+//!
+struct ProjectCandidates
+{
+    ProjectCandidates()
+    {
+        m_parts.reserve(NUM_PROJECTS + 1);
+
+        for (size_t i = 0; i <= NUM_PROJECTS; ++i) {
+            m_parts.push_back(MakeProjectPart(i));
+        }
+
+        // The alternate part for the first project is the last one:
+        for (size_t i = 0; i <= NUM_PROJECTS; ++i) {
+            m_project_parts.emplace_back("project_" + ToString(i < NUM_PROJECTS ? i : 0), &m_parts[i]);
+        }
+    }
+
+    std::vector<CSplitBlob::CPart> m_parts;
+    std::vector<std::pair<std::string, const CSplitBlob::CPart*>> m_project_parts;
+    CSplitBlob::CPart m_beacon_list { uint256 {} };
+};
+} // Anonymous namespace
+
+static void SuperblockQuorumHash(benchmark::State& state)
+{
+    const GRC::Superblock superblock = bench_data::MakeSuperblock(NUM_CPIDS, NUM_PROJECTS);
+
+    while (state.KeepRunning()) {
+        superblock.GetHash(true);
+    }
+}
+
+static void SuperblockSerialize(benchmark::State& state)
+{
+    const GRC::Superblock superblock = bench_data::MakeSuperblock(NUM_CPIDS, NUM_PROJECTS);
+
+    while (state.KeepRunning()) {
+        CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+        stream << superblock;
+    }
+}
+
+static void SuperblockDeserialize(benchmark::State& state)
+{
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+    stream << bench_data::MakeSuperblock(NUM_CPIDS, NUM_PROJECTS);
+
+    while (state.KeepRunning()) {
+        CDataStream copy(stream);
+        GRC::Superblock superblock;
+        copy >> superblock;
+    }
+}
+
+static void SuperblockMagnitudeLookup(benchmark::State& state)
+{
+    const GRC::Superblock superblock = bench_data::MakeSuperblock(NUM_CPIDS, NUM_PROJECTS);
+
+    std::vector<GRC::Cpid> cpids;
+
+    // Look up every CPID in the superblock and as many that are not in it:
+    for (size_t i = 0; i < NUM_CPIDS * 2; ++i) {
+        cpids.push_back(bench_data::MakeCpid(i));
+    }
+
+    while (state.KeepRunning()) {
+        uint64_t total = 0;
+
+        for (const auto& cpid : cpids) {
+            total += superblock.m_cpids.MagnitudeOf(cpid).Scaled();
+        }
+
+        assert(total > 0);
+    }
+}
+
+// Superblock validation computes the stats of a convergence to compare them
+// with the superblock. These compare decoding the project parts one by one
+// with the worker pool, and a by-project fallback that decodes every part for
+// each combination with one that reuses the decoded stats.
+
+static void SuperblockProjectStatsSerial(benchmark::State& state)
+{
+    const ProjectCandidates candidates;
+    const double magnitude_per_project = NETWORK_MAGNITUDE / NUM_PROJECTS;
+
+    while (state.KeepRunning()) {
+        std::vector<ScraperStats> project_stats(NUM_PROJECTS);
+        std::vector<const ScraperStats*> selected;
+
+        for (size_t i = 0; i < NUM_PROJECTS; ++i) {
+            const auto& project_part = candidates.m_project_parts[i];
+
+            LoadProjectObjectToStatsByCPID(
+                project_part.first,
+                project_part.second->data,
+                magnitude_per_project,
+                project_stats[i]);
+
+            selected.push_back(&project_stats[i]);
+        }
+
+        GetScraperStatsFromProjectStats(selected, nullptr);
+    }
+}
+
+static void SuperblockProjectStatsParallel(benchmark::State& state)
+{
+    const ProjectCandidates candidates;
+    const std::vector<std::pair<std::string, const CSplitBlob::CPart*>> project_parts(
+        candidates.m_project_parts.begin(),
+        candidates.m_project_parts.begin() + NUM_PROJECTS);
+
+    while (state.KeepRunning()) {
+        const std::vector<ScraperStats> project_stats = GetProjectStatsFromParts(project_parts, NUM_PROJECTS);
+        std::vector<const ScraperStats*> selected;
+
+        for (const auto& stats : project_stats) {
+            selected.push_back(&stats);
+        }
+
+        GetScraperStatsFromProjectStats(selected, nullptr);
+    }
+}
+
+//!
+//! \brief Compute the stats of both combinations of the candidate parts.
+//!
+//! \param memoize Decode each part once and reuse the stats, like the
+//! validator does, instead of decoding the parts for each combination.
+//!
+void ProjectCombinations(benchmark::State& state, const bool memoize)
+{
+    const ProjectCandidates candidates;
+
+    while (state.KeepRunning()) {
+        std::vector<ScraperStats> project_stats;
+
+        if (memoize) {
+            project_stats = GetProjectStatsFromParts(candidates.m_project_parts, NUM_PROJECTS);
+        }
+
+        for (const size_t first_part : { size_t {0}, NUM_PROJECTS }) {
+            std::vector<std::pair<std::string, const CSplitBlob::CPart*>> combination {
+                candidates.m_project_parts[first_part]
+            };
+
+            std::vector<size_t> indexes { first_part };
+
+            for (size_t i = 1; i < NUM_PROJECTS; ++i) {
+                combination.push_back(candidates.m_project_parts[i]);
+                indexes.push_back(i);
+            }
+
+            std::vector<ScraperStats> decoded;
+
+            if (!memoize) {
+                decoded = GetProjectStatsFromParts(combination, NUM_PROJECTS);
+            }
+
+            std::vector<const ScraperStats*> selected;
+
+            for (size_t i = 0; i < indexes.size(); ++i) {
+                selected.push_back(memoize ? &project_stats[indexes[i]] : &decoded[i]);
+            }
+
+            ScraperStatsAndVerifiedBeacons stats;
+            bool combined = GetScraperStatsFromProjectCombination(selected, &candidates.m_beacon_list, nullptr, stats);
+            assert(combined);
+        }
+    }
+}
+
+static void SuperblockProjectCombinationsRedecode(benchmark::State& state)
+{
+    ProjectCombinations(state, false);
+}
+
+static void SuperblockProjectCombinationsMemoized(benchmark::State& state)
+{
+    ProjectCombinations(state, true);
+}
+
+BENCHMARK(SuperblockQuorumHash, 200);
+BENCHMARK(SuperblockSerialize, 500);
+BENCHMARK(SuperblockDeserialize, 200);
+BENCHMARK(SuperblockMagnitudeLookup, 100);
+BENCHMARK(SuperblockProjectStatsSerial, 5);
+BENCHMARK(SuperblockProjectStatsParallel, 5);
+BENCHMARK(SuperblockProjectCombinationsRedecode, 5);
+BENCHMARK(SuperblockProjectCombinationsMemoized, 5);
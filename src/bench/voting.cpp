@@ -0,0 +1,73 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data.h>
+
+#include "gridcoin/voting/poll.h"
+#include "gridcoin/voting/result.h"
+
+using namespace GRC;
+
+namespace {
+constexpr size_t NUM_CHOICES = 8;
+constexpr size_t NUM_VOTES = 10000;
+
+Poll MakePoll()
+{
+    std::vector<Poll::Choice> choices;
+
+    for (size_t i = 0; i < NUM_CHOICES; ++i) {
+        choices.emplace_back("Choice " + std::to_string(i));
+    }
+
+    return Poll(
+        PollType::SURVEY,
+        PollWeightType::BALANCE_AND_MAGNITUDE,
+        PollResponseType::MULTIPLE_CHOICE,
+        21,
+        "Benchmark poll",
+        "https://gridcoin.us",
+        "Which choices?",
+        Poll::ChoiceList(std::move(choices)),
+        1700000000);
+}
+} // Anonymous namespace
+
+//!
+//! \brief Tally resolved votes into a poll result, the last step of building
+//! the results that the voting RPCs and the GUI display.
+//!
+static void PollResultTally(benchmark::State& state)
+{
+    const Poll poll = MakePoll();
+
+    std::vector<PollResult::VoteDetail> votes(NUM_VOTES);
+
+    for (size_t i = 0; i < NUM_VOTES; ++i) {
+        PollResult::VoteDetail& vote = votes[i];
+        vote.m_amount = (i % 5000 + 1) * COIN;
+        vote.m_mining_id = bench_data::MakeCpid(i);
+        vote.m_magnitude = Magnitude::RoundFrom(i % 1000);
+
+        // One to three choices per vote with the weight split between them:
+        const size_t num_responses = i % 3 + 1;
+
+        for (size_t j = 0; j < num_responses; ++j) {
+            vote.m_responses.emplace_back((i + j) % NUM_CHOICES, vote.m_amount / num_responses);
+        }
+    }
+
+    while (state.KeepRunning()) {
+        PollResult result(poll);
+
+        for (const auto& vote : votes) {
+            result.TallyVote(vote);
+        }
+
+        assert(result.Winner() < NUM_CHOICES);
+    }
+}
+
+BENCHMARK(PollResultTally, 200);
@@ -39,4 +39,12 @@ std::string SHA256AutoDetect();
  */
 void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks);
 
+/** Compute multiple double-SHA256's of messages of up to 55 bytes.
+ *  output:  pointer to a blocks*32 byte output buffer
+ *  input:   pointer to a blocks*64 byte input buffer, each 64 bytes a message
+ *           with the SHA-256 padding and length already appended
+ *  blocks:  the number of hashes to compute.
+ */
+void SHA256D1Block(unsigned char* output, const unsigned char* input, size_t blocks);
+
 #endif // BITCOIN_CRYPTO_SHA256_H
@@ -70,9 +70,10 @@ void inline Write8(unsigned char* out, int offset, __m256i v) {
     WriteLE32(out + 224 + offset, _mm256_extract_epi32(v, 0));
 }
 
-}
-
-void Transform_8way(unsigned char* out, const unsigned char* in)
+/** Double-SHA256 of 8 input blocks. With SINGLE_BLOCK, each block holds a whole padded
+ *  message and the padding block of a 64-byte message is skipped. */
+template <bool SINGLE_BLOCK>
+void inline __attribute__((always_inline)) TransformD(unsigned char* out, const unsigned char* in)
 {
     // Transform 1
     __m256i a = K(0x6a09e667ul);
@@ -160,82 +161,93 @@ void Transform_8way(unsigned char* out, const unsigned char* in)
     g = Add(g, K(0x1f83d9abul));
     h = Add(h, K(0x5be0cd19ul));
 
-    __m256i t0 = a, t1 = b, t2 = c, t3 = d, t4 = e, t5 = f, t6 = g, t7 = h;
+    if constexpr (SINGLE_BLOCK) {
+        w0 = a;
+        w1 = b;
+        w2 = c;
+        w3 = d;
+        w4 = e;
+        w5 = f;
+        w6 = g;
+        w7 = h;
+    } else {
+        __m256i t0 = a, t1 = b, t2 = c, t3 = d, t4 = e, t5 = f, t6 = g, t7 = h;
 
-    // Transform 2
-    Round(a, b, c, d, e, f, g, h, K(0xc28a2f98ul));
-    Round(h, a, b, c, d, e, f, g, K(0x71374491ul));
-    Round(g, h, a, b, c, d, e, f, K(0xb5c0fbcful));
-    Round(f, g, h, a, b, c, d, e, K(0xe9b5dba5ul));
-    Round(e, f, g, h, a, b, c, d, K(0x3956c25bul));
-    Round(d, e, f, g, h, a, b, c, K(0x59f111f1ul));
-    Round(c, d, e, f, g, h, a, b, K(0x923f82a4ul));
-    Round(b, c, d, e, f, g, h, a, K(0xab1c5ed5ul));
-    Round(a, b, c, d, e, f, g, h, K(0xd807aa98ul));
-    Round(h, a, b, c, d, e, f, g, K(0x12835b01ul));
-    Round(g, h, a, b, c, d, e, f, K(0x243185beul));
-    Round(f, g, h, a, b, c, d, e, K(0x550c7dc3ul));
-    Round(e, f, g, h, a, b, c, d, K(0x72be5d74ul));
-    Round(d, e, f, g, h, a, b, c, K(0x80deb1feul));
-    Round(c, d, e, f, g, h, a, b, K(0x9bdc06a7ul));
-    Round(b, c, d, e, f, g, h, a, K(0xc19bf374ul));
-    Round(a, b, c, d, e, f, g, h, K(0x649b69c1ul));
-    Round(h, a, b, c, d, e, f, g, K(0xf0fe4786ul));
-    Round(g, h, a, b, c, d, e, f, K(0x0fe1edc6ul));
-    Round(f, g, h, a, b, c, d, e, K(0x240cf254ul));
-    Round(e, f, g, h, a, b, c, d, K(0x4fe9346ful));
-    Round(d, e, f, g, h, a, b, c, K(0x6cc984beul));
-    Round(c, d, e, f, g, h, a, b, K(0x61b9411eul));
-    Round(b, c, d, e, f, g, h, a, K(0x16f988faul));
-    Round(a, b, c, d, e, f, g, h, K(0xf2c65152ul));
-    Round(h, a, b, c, d, e, f, g, K(0xa88e5a6dul));
-    Round(g, h, a, b, c, d, e, f, K(0xb019fc65ul));
-    Round(f, g, h, a, b, c, d, e, K(0xb9d99ec7ul));
-    Round(e, f, g, h, a, b, c, d, K(0x9a1231c3ul));
-    Round(d, e, f, g, h, a, b, c, K(0xe70eeaa0ul));
-    Round(c, d, e, f, g, h, a, b, K(0xfdb1232bul));
-    Round(b, c, d, e, f, g, h, a, K(0xc7353eb0ul));
-    Round(a, b, c, d, e, f, g, h, K(0x3069bad5ul));
-    Round(h, a, b, c, d, e, f, g, K(0xcb976d5ful));
-    Round(g, h, a, b, c, d, e, f, K(0x5a0f118ful));
-    Round(f, g, h, a, b, c, d, e, K(0xdc1eeefdul));
-    Round(e, f, g, h, a, b, c, d, K(0x0a35b689ul));
-    Round(d, e, f, g, h, a, b, c, K(0xde0b7a04ul));
-    Round(c, d, e, f, g, h, a, b, K(0x58f4ca9dul));
-    Round(b, c, d, e, f, g, h, a, K(0xe15d5b16ul));
-    Round(a, b, c, d, e, f, g, h, K(0x007f3e86ul));
-    Round(h, a, b, c, d, e, f, g, K(0x37088980ul));
-    Round(g, h, a, b, c, d, e, f, K(0xa507ea32ul));
-    Round(f, g, h, a, b, c, d, e, K(0x6fab9537ul));
-    Round(e, f, g, h, a, b, c, d, K(0x17406110ul));
-    Round(d, e, f, g, h, a, b, c, K(0x0d8cd6f1ul));
-    Round(c, d, e, f, g, h, a, b, K(0xcdaa3b6dul));
-    Round(b, c, d, e, f, g, h, a, K(0xc0bbbe37ul));
-    Round(a, b, c, d, e, f, g, h, K(0x83613bdaul));
-    Round(h, a, b, c, d, e, f, g, K(0xdb48a363ul));
-    Round(g, h, a, b, c, d, e, f, K(0x0b02e931ul));
-    Round(f, g, h, a, b, c, d, e, K(0x6fd15ca7ul));
-    Round(e, f, g, h, a, b, c, d, K(0x521afacaul));
-    Round(d, e, f, g, h, a, b, c, K(0x31338431ul));
-    Round(c, d, e, f, g, h, a, b, K(0x6ed41a95ul));
-    Round(b, c, d, e, f, g, h, a, K(0x6d437890ul));
-    Round(a, b, c, d, e, f, g, h, K(0xc39c91f2ul));
-    Round(h, a, b, c, d, e, f, g, K(0x9eccabbdul));
-    Round(g, h, a, b, c, d, e, f, K(0xb5c9a0e6ul));
-    Round(f, g, h, a, b, c, d, e, K(0x532fb63cul));
-    Round(e, f, g, h, a, b, c, d, K(0xd2c741c6ul));
-    Round(d, e, f, g, h, a, b, c, K(0x07237ea3ul));
-    Round(c, d, e, f, g, h, a, b, K(0xa4954b68ul));
-    Round(b, c, d, e, f, g, h, a, K(0x4c191d76ul));
+        // Transform 2
+        Round(a, b, c, d, e, f, g, h, K(0xc28a2f98ul));
+        Round(h, a, b, c, d, e, f, g, K(0x71374491ul));
+        Round(g, h, a, b, c, d, e, f, K(0xb5c0fbcful));
+        Round(f, g, h, a, b, c, d, e, K(0xe9b5dba5ul));
+        Round(e, f, g, h, a, b, c, d, K(0x3956c25bul));
+        Round(d, e, f, g, h, a, b, c, K(0x59f111f1ul));
+        Round(c, d, e, f, g, h, a, b, K(0x923f82a4ul));
+        Round(b, c, d, e, f, g, h, a, K(0xab1c5ed5ul));
+        Round(a, b, c, d, e, f, g, h, K(0xd807aa98ul));
+        Round(h, a, b, c, d, e, f, g, K(0x12835b01ul));
+        Round(g, h, a, b, c, d, e, f, K(0x243185beul));
+        Round(f, g, h, a, b, c, d, e, K(0x550c7dc3ul));
+        Round(e, f, g, h, a, b, c, d, K(0x72be5d74ul));
+        Round(d, e, f, g, h, a, b, c, K(0x80deb1feul));
+        Round(c, d, e, f, g, h, a, b, K(0x9bdc06a7ul));
+        Round(b, c, d, e, f, g, h, a, K(0xc19bf374ul));
+        Round(a, b, c, d, e, f, g, h, K(0x649b69c1ul));
+        Round(h, a, b, c, d, e, f, g, K(0xf0fe4786ul));
+        Round(g, h, a, b, c, d, e, f, K(0x0fe1edc6ul));
+        Round(f, g, h, a, b, c, d, e, K(0x240cf254ul));
+        Round(e, f, g, h, a, b, c, d, K(0x4fe9346ful));
+        Round(d, e, f, g, h, a, b, c, K(0x6cc984beul));
+        Round(c, d, e, f, g, h, a, b, K(0x61b9411eul));
+        Round(b, c, d, e, f, g, h, a, K(0x16f988faul));
+        Round(a, b, c, d, e, f, g, h, K(0xf2c65152ul));
+        Round(h, a, b, c, d, e, f, g, K(0xa88e5a6dul));
+        Round(g, h, a, b, c, d, e, f, K(0xb019fc65ul));
+        Round(f, g, h, a, b, c, d, e, K(0xb9d99ec7ul));
+        Round(e, f, g, h, a, b, c, d, K(0x9a1231c3ul));
+        Round(d, e, f, g, h, a, b, c, K(0xe70eeaa0ul));
+        Round(c, d, e, f, g, h, a, b, K(0xfdb1232bul));
+        Round(b, c, d, e, f, g, h, a, K(0xc7353eb0ul));
+        Round(a, b, c, d, e, f, g, h, K(0x3069bad5ul));
+        Round(h, a, b, c, d, e, f, g, K(0xcb976d5ful));
+        Round(g, h, a, b, c, d, e, f, K(0x5a0f118ful));
+        Round(f, g, h, a, b, c, d, e, K(0xdc1eeefdul));
+        Round(e, f, g, h, a, b, c, d, K(0x0a35b689ul));
+        Round(d, e, f, g, h, a, b, c, K(0xde0b7a04ul));
+        Round(c, d, e, f, g, h, a, b, K(0x58f4ca9dul));
+        Round(b, c, d, e, f, g, h, a, K(0xe15d5b16ul));
+        Round(a, b, c, d, e, f, g, h, K(0x007f3e86ul));
+        Round(h, a, b, c, d, e, f, g, K(0x37088980ul));
+        Round(g, h, a, b, c, d, e, f, K(0xa507ea32ul));
+        Round(f, g, h, a, b, c, d, e, K(0x6fab9537ul));
+        Round(e, f, g, h, a, b, c, d, K(0x17406110ul));
+        Round(d, e, f, g, h, a, b, c, K(0x0d8cd6f1ul));
+        Round(c, d, e, f, g, h, a, b, K(0xcdaa3b6dul));
+        Round(b, c, d, e, f, g, h, a, K(0xc0bbbe37ul));
+        Round(a, b, c, d, e, f, g, h, K(0x83613bdaul));
+        Round(h, a, b, c, d, e, f, g, K(0xdb48a363ul));
+        Round(g, h, a, b, c, d, e, f, K(0x0b02e931ul));
+        Round(f, g, h, a, b, c, d, e, K(0x6fd15ca7ul));
+        Round(e, f, g, h, a, b, c, d, K(0x521afacaul));
+        Round(d, e, f, g, h, a, b, c, K(0x31338431ul));
+        Round(c, d, e, f, g, h, a, b, K(0x6ed41a95ul));
+        Round(b, c, d, e, f, g, h, a, K(0x6d437890ul));
+        Round(a, b, c, d, e, f, g, h, K(0xc39c91f2ul));
+        Round(h, a, b, c, d, e, f, g, K(0x9eccabbdul));
+        Round(g, h, a, b, c, d, e, f, K(0xb5c9a0e6ul));
+        Round(f, g, h, a, b, c, d, e, K(0x532fb63cul));
+        Round(e, f, g, h, a, b, c, d, K(0xd2c741c6ul));
+        Round(d, e, f, g, h, a, b, c, K(0x07237ea3ul));
+        Round(c, d, e, f, g, h, a, b, K(0xa4954b68ul));
+        Round(b, c, d, e, f, g, h, a, K(0x4c191d76ul));
 
-    w0 = Add(t0, a);
-    w1 = Add(t1, b);
-    w2 = Add(t2, c);
-    w3 = Add(t3, d);
-    w4 = Add(t4, e);
-    w5 = Add(t5, f);
-    w6 = Add(t6, g);
-    w7 = Add(t7, h);
+        w0 = Add(t0, a);
+        w1 = Add(t1, b);
+        w2 = Add(t2, c);
+        w3 = Add(t3, d);
+        w4 = Add(t4, e);
+        w5 = Add(t5, f);
+        w6 = Add(t6, g);
+        w7 = Add(t7, h);
+    }
 
     // Transform 3
     a = K(0x6a09e667ul);
@@ -325,4 +337,16 @@ void Transform_8way(unsigned char* out, const unsigned char* in)
 
 }
 
+void Transform_8way(unsigned char* out, const unsigned char* in)
+{
+    TransformD<false>(out, in);
+}
+
+void Transform_8way_1block(unsigned char* out, const unsigned char* in)
+{
+    TransformD<true>(out, in);
+}
+
+}
+
 #endif
@@ -17,6 +17,7 @@
 #include "txdb.h"
 #include "main.h"
 #include "node/blockstorage.h"
+#include "node/prune.h"
 #include "node/ui_interface.h"
 #include "util.h"
 #include "validation.h"
@@ -135,12 +136,14 @@ void CTxDB::Close()
     options.block_cache = nullptr;
     delete activeBatch;
     activeBatch = nullptr;
+    batchOverlay.clear();
 }
 
 bool CTxDB::TxnBegin()
 {
     assert(!activeBatch);
     activeBatch = new leveldb::WriteBatch();
+    batchOverlay.clear();
     return true;
 }
 
@@ -150,6 +153,7 @@ bool CTxDB::TxnCommit()
     leveldb::Status status = pdb->Write(leveldb::WriteOptions(), activeBatch);
     delete activeBatch;
     activeBatch = nullptr;
+    batchOverlay.clear();
     if (!status.ok()) {
         LogPrintf("LevelDB batch commit failure: %s", status.ToString());
         return false;
@@ -157,48 +161,29 @@ bool CTxDB::TxnCommit()
     return true;
 }
 
-class CBatchScanner : public leveldb::WriteBatch::Handler {
-public:
-    std::string needle;
-    bool *deleted;
-    std::string *foundValue;
-    bool foundEntry;
-
-    CBatchScanner() : foundEntry(false) {}
-
-    virtual void Put(const leveldb::Slice& key, const leveldb::Slice& value) {
-        if (key.ToString() == needle) {
-            foundEntry = true;
-            *deleted = false;
-            *foundValue = value.ToString();
-        }
-    }
-
-    virtual void Delete(const leveldb::Slice& key) {
-        if (key.ToString() == needle) {
-            foundEntry = true;
-            *deleted = true;
-        }
-    }
-};
-
 // When performing a read, if we have an active batch we need to check it first
 // before reading from the database, as the rest of the code assumes that once
-// a database transaction begins reads are consistent with it. It would be good
-// to change that assumption in future and avoid the performance hit, though in
-// practice it does not appear to be large.
+// a database transaction begins reads are consistent with it. The overlay holds
+// the outcome of the batch for each key, so this costs a hash lookup instead of
+// a replay of the batch. That matters for large reorganizations that read back
+// many of the transaction index entries that they wrote.
 bool CTxDB::ScanBatch(const CDataStream &key, string *value, bool *deleted) const {
     assert(activeBatch);
     *deleted = false;
-    CBatchScanner scanner;
-    scanner.needle = key.str();
-    scanner.deleted = deleted;
-    scanner.foundValue = value;
-    leveldb::Status status = activeBatch->Iterate(&scanner);
-    if (!status.ok()) {
-        throw runtime_error(status.ToString());
+
+    const auto iter = batchOverlay.find(key.str());
+
+    if (iter == batchOverlay.end()) {
+        return false;
     }
-    return scanner.foundEntry;
+
+    if (iter->second) {
+        *value = *iter->second;
+    } else {
+        *deleted = true;
+    }
+
+    return true;
 }
 
 bool CTxDB::ReadTxIndex(uint256 hash, CTxIndex& txindex)
@@ -460,7 +445,7 @@ bool CTxDB::LoadBlockIndex()
     map<pair<unsigned int, unsigned int>, CBlockIndex*> mapBlockPos;
     for (CBlockIndex* pindex = pindexBest; pindex && pindex->pprev; pindex = pindex->pprev)
     {
-        if (fRequestShutdown || pindex->nHeight < nBestHeight-nCheckDepth)
+        if (fRequestShutdown || pindex->nHeight < nBestHeight-nCheckDepth || IsBlockPruned(pindex))
             break;
         CBlock block;
         if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus()))
@@ -10,7 +10,11 @@
 #include "main.h"
 #include "streams.h"
 
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
+#include <unordered_map>
 #include <leveldb/db.h>
 #include <leveldb/write_batch.h>
 
@@ -57,6 +61,11 @@ private:
     // A batch stores up writes and deletes for atomic application. When this
     // field is non-nullptr, writes/deletes go there instead of directly to disk.
     leveldb::WriteBatch *activeBatch;
+    // Mirrors the pending changes in activeBatch by key so that reads do not
+    // have to replay the whole batch: the latest value written for each key,
+    // or nullopt when the latest change deletes it. An empty map does not
+    // allocate, so it adds nothing to the cost of constructing a CTxDB.
+    std::unordered_map<std::string, std::optional<std::string>> batchOverlay;
     leveldb::Options options;
     bool fReadOnly;
     int nVersion;
@@ -64,7 +73,7 @@ private:
 protected:
     // Returns true and sets (value,false) if activeBatch contains the given key
     // or leaves value alone and sets deleted = true if activeBatch contains a
-    // delete for it.
+    // delete for it. Looks the key up in batchOverlay in constant time.
     bool ScanBatch(const CDataStream &key, std::string *value, bool *deleted) const;
 
     template<typename K, typename T>
@@ -122,6 +131,7 @@ protected:
 
         if (activeBatch) {
             activeBatch->Put(ssKey.str(), ssValue.str());
+            batchOverlay[ssKey.str()] = ssValue.str();
             return true;
         }
         leveldb::Status status = pdb->Put(leveldb::WriteOptions(), ssKey.str(), ssValue.str());
@@ -145,6 +155,7 @@ protected:
         ssKey << key;
         if (activeBatch) {
             activeBatch->Delete(ssKey.str());
+            batchOverlay[ssKey.str()] = std::nullopt;
             return true;
         }
         leveldb::Status status = pdb->Delete(leveldb::WriteOptions(), ssKey.str());
@@ -161,8 +172,8 @@ protected:
 
         if (activeBatch) {
             bool deleted;
-            if (ScanBatch(ssKey, &unused, &deleted) && !deleted) {
-                return true;
+            if (ScanBatch(ssKey, &unused, &deleted)) {
+                return !deleted;
             }
         }
 
@@ -179,6 +190,7 @@ public:
     {
         delete activeBatch;
         activeBatch = nullptr;
+        batchOverlay.clear();
         return true;
     }
 
@@ -215,19 +227,19 @@ public:
 	bool WriteGenericData(const std::string& strKey,const std::string& strData);
 
     template <typename K, typename V>
-    bool ReadGenericSerializable(K& key, V& serialized_data)
+    bool ReadGenericSerializable(const K& key, V& serialized_data)
     {
         return Read(key, serialized_data);
     }
 
     template <typename K, typename V>
-    bool WriteGenericSerializable(K& key, const V& serializable_data)
+    bool WriteGenericSerializable(const K& key, const V& serializable_data)
     {
         return Write(key, serializable_data);
     }
 
     template <typename K>
-    bool EraseGenericSerializable(K& key)
+    bool EraseGenericSerializable(const K& key)
     {
 
         return Erase(key);
@@ -346,6 +358,54 @@ public:
         return status;
     }
 
+    //!
+    //! \brief Visit the entries in key order starting at the first key not less
+    //! than the serialized start key.
+    //!
+    //! Reads the database on disk only: the visitor does not see the writes of
+    //! an active batch.
+    //!
+    //! \param start_key Key to seek to.
+    //! \param visitor   Receives the key and the value streams of each entry.
+    //!                  Returns \c false to stop the iteration.
+    //!
+    //! \return \c false if the visitor threw an exception.
+    //!
+    template <typename K>
+    bool IterateGenericSerializables(
+        const K& start_key,
+        const std::function<bool(CDataStream&, CDataStream&)>& visitor)
+    {
+        bool status = true;
+
+        std::unique_ptr<leveldb::Iterator> iterator(pdb->NewIterator(leveldb::ReadOptions()));
+
+        CDataStream ssStartKey(SER_DISK, CLIENT_VERSION);
+        ssStartKey << start_key;
+
+        for (iterator->Seek(ssStartKey.str()); iterator->Valid(); iterator->Next())
+        {
+            CDataStream ssKey(SER_DISK, CLIENT_VERSION);
+            ssKey.write(MakeByteSpan(iterator->key()));
+
+            CDataStream ssValue(SER_DISK, CLIENT_VERSION);
+            ssValue.write(MakeByteSpan(iterator->value()));
+
+            try
+            {
+                if (!visitor(ssKey, ssValue)) break;
+            }
+            catch (const std::exception& e)
+            {
+                LogPrintf("ERROR: %s: Error %s occurred during iteration of LevelDB.", __func__, e.what());
+                status = false;
+                break;
+            }
+        }
+
+        return status;
+    }
+
     template <typename T, typename K, typename V>
     bool WriteGenericSerializablesFromMap(T& key_type, std::map<K, V>& map)
     {
@@ -338,21 +338,26 @@ BeaconOption BeaconRegistry::TryActive(const Cpid& cpid, const int64_t now) cons
     return nullptr;
 }
 
-std::vector<Beacon_ptr> BeaconRegistry::FindPending(const Cpid& cpid) const
+std::optional<uint256> BeaconRegistry::GetRecordedChainletRoot(const uint256& hash) const
 {
-    // TODO: consider adding a lookup table for pending beacons keyed by CPID.
-    // Since the protocol just needs to look up pending beacons by public key,
-    // we just do a search here. Informational RPCs or local beacon management
-    // only need to call this occasionally.
+    const auto iter = m_chainlet_roots.find(hash);
 
-    std::vector<Beacon_ptr> found;
+    if (iter == m_chainlet_roots.end()) {
+        return std::nullopt;
+    }
 
-    for (const auto& pending_beacon_pair : m_pending) {
-        const Beacon_ptr& beacon_ptr = pending_beacon_pair.second;
+    return iter->second;
+}
 
-        if (beacon_ptr->m_cpid == cpid) {
-            found.emplace_back(beacon_ptr);
-        }
+std::vector<Beacon_ptr> BeaconRegistry::FindPending(const Cpid& cpid) const
+{
+    std::vector<Beacon_ptr> found;
+
+    for (auto iter = m_pending_by_cpid.lower_bound(std::make_pair(cpid, CKeyID()));
+         iter != m_pending_by_cpid.end() && iter->first == cpid;
+         ++iter)
+    {
+        found.emplace_back(m_pending.at(iter->second));
     }
 
     return found;
@@ -390,6 +395,8 @@ void BeaconRegistry::Reset()
 {
     m_beacons.clear();
     m_pending.clear();
+    m_pending_by_cpid.clear();
+    m_chainlet_roots.clear();
     m_expired_pending.clear();
     m_beacon_db.clear();
 }
@@ -436,6 +443,15 @@ bool BeaconRegistry::TryRenewal(Beacon_ptr& current_beacon_ptr, int& height, con
     // Get the iterator to the renewal beacon.
     auto renewal_iter = m_beacon_db.find(renewal.m_hash);
 
+    // The renewal extends the chainlet of the current beacon, so it shares the
+    // root of that chainlet:
+    if (current_beacon_ptr->m_status == BeaconStatusForStorage::ACTIVE && !current_beacon_ptr->m_previous_hash.IsNull()) {
+        m_chainlet_roots[renewal.m_hash] = current_beacon_ptr->m_hash;
+    } else if (const auto root_iter = m_chainlet_roots.find(current_beacon_ptr->m_hash);
+               root_iter != m_chainlet_roots.end()) {
+        m_chainlet_roots[renewal.m_hash] = root_iter->second;
+    }
+
     // Place a smart shared pointer to the renewed beacon in the active beacons map. Note that the
     // subscript form of the insert with the same key replaces the current beacon entry with the
     //renewal.
@@ -535,7 +551,7 @@ void BeaconRegistry::Add(const ContractContext& ctx)
     }
 
     // Insert a pointer to the entry in the m_pending map.
-    m_pending[pending.GetId()] =  m_beacon_db.find(ctx.m_tx.GetHash())->second;
+    SetPending(m_beacon_db.find(ctx.m_tx.GetHash())->second);
 }
 
 void BeaconRegistry::Delete(const ContractContext& ctx)
@@ -551,7 +567,7 @@ void BeaconRegistry::Delete(const ContractContext& ctx)
     const auto payload = ctx->SharePayloadAs<BeaconPayload>();
 
     if (ctx->m_version >= 2) {
-        m_pending.erase(payload->m_beacon.GetId());
+        ErasePending(payload->m_beacon.GetId());
     }
 
     auto iter = m_beacons.find(payload->m_cpid);
@@ -567,12 +583,7 @@ void BeaconRegistry::Delete(const ContractContext& ctx)
     }
 
     // If the beacon exists in the pending map, delete the entry.
-    auto iter2 = m_pending.find(payload->m_beacon.m_public_key.GetID());
-
-    if (iter2 != m_pending.end())
-    {
-        m_pending.erase(payload->m_beacon.m_public_key.GetID());
-    }
+    ErasePending(payload->m_beacon.m_public_key.GetID());
 
     Beacon deleted_beacon(payload->m_beacon);
 
@@ -652,7 +663,7 @@ void BeaconRegistry::Revert(const ContractContext& ctx)
                 }
 
                 // Remove the found pending entry.
-                m_pending.erase(pending_to_revert);
+                ErasePending(pending_to_revert);
 
                 // Also remove this historical record, because in a revert it should not be retained.
                 m_beacon_db.erase(ctx.m_tx.GetHash());
@@ -716,6 +727,7 @@ void BeaconRegistry::Revert(const ContractContext& ctx)
 
                 // Erase the renewal record in the db that was reverted. No reason to keep it.
                 m_beacon_db.erase(renewal_hash);
+                m_chainlet_roots.erase(renewal_hash);
             }
             else
             {
@@ -759,7 +771,7 @@ void BeaconRegistry::Revert(const ContractContext& ctx)
                 }
                 else if (beacon_to_restore_ptr->m_status == BeaconStatusForStorage::PENDING)
                 {
-                    m_pending[beacon_to_restore_ptr->GetId()] = beacon_to_restore_ptr;
+                    SetPending(beacon_to_restore_ptr);
                 }
                 else
                 {
@@ -878,6 +890,33 @@ Beacon_ptr BeaconRegistry::GetBeaconChainletRoot(Beacon_ptr beacon,
         ++i;
     }
 
+    const uint256 head_hash = beacon->m_hash;
+
+    // Skip the walk when the caller does not need the links and the registry
+    // recorded the root when it renewed the beacon:
+    if (beacon_chain_out == nullptr && beacon->Renewed()) {
+        const auto root_iter = m_chainlet_roots.find(head_hash);
+
+        if (root_iter != m_chainlet_roots.end()) {
+            const auto beacon_iter = m_beacon_db.find(root_iter->second);
+
+            // The recorded root must still be an activated beacon that points
+            // back to the pending beacon it was activated from, as the walk
+            // checks below. Otherwise, drop the entry and let the walk report
+            // the corruption:
+            if (beacon_iter != m_beacon_db.end() && beacon_iter->second->m_status == BeaconStatusForStorage::ACTIVE) {
+                const auto pending_iter = m_beacon_db.find(beacon_iter->second->m_previous_hash);
+
+                if (pending_iter != m_beacon_db.end()
+                    && pending_iter->second->m_status == BeaconStatusForStorage::PENDING) {
+                    return beacon_iter->second;
+                }
+            }
+
+            m_chainlet_roots.erase(root_iter);
+        }
+    }
+
     // Walk back the entries in the historical beacon map linked by renewal prev tx hash until the first
     // beacon in the renewal chain is found (the original advertisement). The accrual starts no earlier
     // than here.
@@ -932,9 +971,63 @@ Beacon_ptr BeaconRegistry::GetBeaconChainletRoot(Beacon_ptr beacon,
         // Note that we do not actually walk back to the pending beacon. The parameter beacon remains at the activated beacon.
     }
 
+    if (beacon->m_hash != head_hash) {
+        m_chainlet_roots[head_hash] = beacon->m_hash;
+    }
+
     return beacon;
 }
 
+void BeaconRegistry::SetPending(const Beacon_ptr& beacon)
+{
+    auto iter = m_pending.find(beacon->GetId());
+
+    if (iter != m_pending.end()) {
+        m_pending_by_cpid.erase(std::make_pair(iter->second->m_cpid, iter->first));
+        iter->second = beacon;
+    } else {
+        m_pending.emplace(beacon->GetId(), beacon);
+    }
+
+    m_pending_by_cpid.emplace(beacon->m_cpid, beacon->GetId());
+}
+
+bool BeaconRegistry::InsertPending(const Beacon_ptr& beacon)
+{
+    if (!m_pending.emplace(beacon->GetId(), beacon).second) {
+        return false;
+    }
+
+    m_pending_by_cpid.emplace(beacon->m_cpid, beacon->GetId());
+
+    return true;
+}
+
+BeaconRegistry::PendingBeaconMap::iterator BeaconRegistry::ErasePending(PendingBeaconMap::iterator iter)
+{
+    m_pending_by_cpid.erase(std::make_pair(iter->second->m_cpid, iter->first));
+
+    return m_pending.erase(iter);
+}
+
+void BeaconRegistry::ErasePending(const CKeyID& key_id)
+{
+    auto iter = m_pending.find(key_id);
+
+    if (iter != m_pending.end()) {
+        ErasePending(iter);
+    }
+}
+
+void BeaconRegistry::ReindexPending()
+{
+    m_pending_by_cpid.clear();
+
+    for (const auto& pending_pair : m_pending) {
+        m_pending_by_cpid.emplace(pending_pair.second->m_cpid, pending_pair.first);
+    }
+}
+
 bool BeaconRegistry::NeedsIsContractCorrection()
 {
     return m_beacon_db.NeedsIsContractCorrection();
@@ -1083,7 +1176,7 @@ void BeaconRegistry::ActivatePending(
 
         // Remove the pending beacon entry from the pending map. (Note this entry still exists in the historical
         // table and the db.
-        m_pending.erase(iter_pair.second->GetId());
+        ErasePending(iter_pair.second->GetId());
     }
 
     // Clear the expired pending beacon set. There is no need to retain expired beacons beyond one SB boundary (which is when
@@ -1126,7 +1219,7 @@ void BeaconRegistry::ActivatePending(
             m_expired_pending.insert(m_beacon_db.find(pending_beacon.m_hash)->second);
 
             // Remove the pending beacon entry from the m_pending map.
-            iter = m_pending.erase(iter);
+            iter = ErasePending(iter);
         } else {
             ++iter;
         }
@@ -1162,8 +1255,7 @@ void BeaconRegistry::Deactivate(const uint256 superblock_hash)
             }
 
             // Resurrect the pending record prior to the activation. This points to the pending record still in the db.
-            m_pending[static_cast<PendingBeacon>(*pending_beacon_entry->second).GetId()] =
-                    pending_beacon_entry->second;
+            SetPending(pending_beacon_entry->second);
 
             // Erase the entry from the active beacons map. This also increments the iterator.
             iter = m_beacons.erase(iter);
@@ -1187,7 +1279,7 @@ void BeaconRegistry::Deactivate(const uint256 superblock_hash)
         auto pending_beacon_entry = m_beacon_db.find(iter->m_previous_hash);
 
         // Resurrect pending beacon entry
-        if (!m_pending.insert(std::make_pair(pending_beacon_entry->second->GetId(), pending_beacon_entry->second)).second) {
+        if (!InsertPending(pending_beacon_entry->second)) {
             LogPrintf("WARN: %s: Resurrected pending beacon entry, hash %s, from expired pending beacon for cpid %s during deactivation "
                       " of superblock hash %s already exists in the pending beacon map corresponding to beacon address %s.",
                       __func__,
@@ -1367,6 +1459,8 @@ int BeaconRegistry::Initialize()
 {
     int height = m_beacon_db.Initialize(m_beacons, m_pending, m_expired_pending);
 
+    ReindexPending();
+
     LogPrint(LogFlags::BEACON, "INFO: %s: m_beacon_db size after load: %u", __func__, m_beacon_db.size());
     LogPrint(LogFlags::BEACON, "INFO: %s: m_beacons size after load: %u", __func__, m_beacons.size());
 
@@ -1377,6 +1471,8 @@ void BeaconRegistry::ResetInMemoryOnly()
 {
     m_beacons.clear();
     m_pending.clear();
+    m_pending_by_cpid.clear();
+    m_chainlet_roots.clear();
     m_expired_pending.clear();
     m_beacon_db.clear_in_memory_only();
 }
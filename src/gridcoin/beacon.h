@@ -14,6 +14,7 @@
 #include "gridcoin/cpid.h"
 #include "gridcoin/support/enumbytes.h"
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -621,6 +622,17 @@ public:
     //!
     std::vector<Beacon_ptr> FindPending(const Cpid& cpid) const;
 
+    //!
+    //! \brief Get the chainlet root recorded for a renewed beacon by a renewal
+    //! or by a previous walk in GetBeaconChainletRoot(). Used by the tests.
+    //!
+    //! \param hash Hash of the renewed beacon.
+    //!
+    //! \return Hash of the activated beacon at the root of the chainlet if the
+    //! registry recorded one.
+    //!
+    std::optional<uint256> GetRecordedChainletRoot(const uint256& hash) const;
+
     //!
     //! \brief Find a historical beacon entry from the beacon (txid) hash;
     //! \param txid hash
@@ -775,6 +787,10 @@ public:
     //! beacon to find the initial advertisement. Note that this does NOT traverse non-continuous beacon ownership,
     //! which occurs when a beacon is allowed to expire and must be reverified under a new key.
     //!
+    //! When the caller does not request the links, this returns the root recorded for a renewal instead of walking,
+    //! after checking that the root still points back to a pending beacon. A walk records the root it finds, so this
+    //! modifies the registry like the contract handlers do and the caller must hold cs_main.
+    //!
     //! \param beacon smart shared pointer to beacon entry to begin walking back
     //! \param beacon_chain_out shared pointer to UniValue beacon chain out report array
     //! \return root (advertisement) beacon entry smart shared pointer
@@ -815,6 +831,26 @@ private:
     BeaconMap m_beacons;        //!< Contains the active registered beacons.
     PendingBeaconMap m_pending; //!< Contains beacons awaiting verification.
 
+    //!
+    //! \brief Indexes the keys of the pending beacons by CPID. Keep this in sync
+    //! with m_pending by modifying pending beacons with the *Pending() methods.
+    //!
+    std::set<std::pair<Cpid, CKeyID>> m_pending_by_cpid;
+
+    //!
+    //! \brief Associates the hashes of renewed beacons with the hashes of the
+    //! activated beacons at the roots of their chainlets.
+    //!
+    //! A renewal never changes the root of a chainlet, so the registry records
+    //! the root of each renewal when it renews a beacon instead of walking the
+    //! historical entries back for every accrual calculation. This holds hashes
+    //! rather than smart pointers so that it does not prevent passivation.
+    //!
+    //! GetBeaconChainletRoot() writes this during accrual lookups. Like the rest
+    //! of the registry state, it relies on the callers holding cs_main.
+    //!
+    std::map<uint256, uint256> m_chainlet_roots;
+
     //!
     //! \brief Contains pending beacons that have expired.
     //!
@@ -850,6 +886,39 @@ private:
     //!
     bool TryRenewal(Beacon_ptr& current_beacon_ptr, int& height, const BeaconPayload& payload);
 
+    //!
+    //! \brief Add a beacon to the pending beacon map, replacing any beacon with
+    //! the same public key.
+    //!
+    void SetPending(const Beacon_ptr& beacon);
+
+    //!
+    //! \brief Add a beacon to the pending beacon map unless it already contains
+    //! a beacon with the same public key.
+    //!
+    //! \return \c true if the map did not contain the key.
+    //!
+    bool InsertPending(const Beacon_ptr& beacon);
+
+    //!
+    //! \brief Remove a beacon from the pending beacon map.
+    //!
+    //! \return An iterator to the pending beacon after the removed one.
+    //!
+    PendingBeaconMap::iterator ErasePending(PendingBeaconMap::iterator iter);
+
+    //!
+    //! \brief Remove the beacon with the specified key from the pending beacon
+    //! map if it exists.
+    //!
+    void ErasePending(const CKeyID& key_id);
+
+    //!
+    //! \brief Rebuild the CPID index of the pending beacons after loading the
+    //! pending beacon map from the database.
+    //!
+    void ReindexPending();
+
 public:
     //!
     //! \brief Gets a reference to beacon database.
@@ -0,0 +1,135 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "gridcoin/claim.h"
+#include "gridcoin/contract/cache.h"
+#include "primitives/transaction.h"
+
+using namespace GRC;
+
+namespace {
+ContractCache g_contract_cache;
+
+//!
+//! \brief Determine whether a transaction contains contracts without parsing
+//! a legacy contract.
+//!
+bool HasContracts(const CTransaction& tx)
+{
+    return !tx.vContracts.empty()
+        || (tx.nVersion == 1 && Contract::Detect(tx.hashBoinc));
+}
+
+ContractCache::ContractsPtr NoContracts()
+{
+    static const ContractCache::ContractsPtr no_contracts = std::make_shared<const std::vector<Contract>>();
+
+    return no_contracts;
+}
+} // Anonymous namespace
+
+// -----------------------------------------------------------------------------
+// Global Functions
+// -----------------------------------------------------------------------------
+
+ContractCache& GRC::GetContractCache()
+{
+    return g_contract_cache;
+}
+
+// -----------------------------------------------------------------------------
+// Class: ContractCache
+// -----------------------------------------------------------------------------
+
+ContractCache::ContractCache(const size_t max_transactions, const size_t max_claims)
+    : m_contracts(max_transactions)
+    , m_claims(max_claims)
+{
+}
+
+ContractCache::ContractsPtr ContractCache::GetContracts(const CTransaction& tx)
+{
+    if (!HasContracts(tx)) {
+        return NoContracts();
+    }
+
+    return GetContracts(tx.GetHash(), tx);
+}
+
+ContractCache::ContractsPtr ContractCache::GetContracts(const uint256& txid, const CTransaction& tx)
+{
+    if (!HasContracts(tx)) {
+        return NoContracts();
+    }
+
+    {
+        LOCK(m_mutex);
+
+        if (ContractsPtr contracts = m_contracts.Find(txid)) {
+            ++m_stats.m_hits;
+            return contracts;
+        }
+
+        ++m_stats.m_misses;
+    }
+
+    // Parse outside of the lock. Unlike CTransaction::GetContracts(), this
+    // leaves a legacy transaction that other threads may read unchanged:
+    std::vector<Contract> contracts = tx.vContracts;
+
+    if (contracts.empty()) {
+        contracts.emplace_back(Contract::Parse(tx.hashBoinc));
+    }
+
+    for (auto& contract : contracts) {
+        contract.CacheConvertedPayload();
+    }
+
+    LOCK(m_mutex);
+
+    return m_contracts.Insert(txid, std::make_shared<const std::vector<Contract>>(std::move(contracts)));
+}
+
+ContractCache::ClaimPtr ContractCache::FindClaim(const uint256& block_hash)
+{
+    LOCK(m_mutex);
+
+    if (ClaimPtr claim = m_claims.Find(block_hash)) {
+        ++m_stats.m_hits;
+        return claim;
+    }
+
+    ++m_stats.m_misses;
+
+    return nullptr;
+}
+
+ContractCache::ClaimPtr ContractCache::StoreClaim(const uint256& block_hash, Claim claim)
+{
+    auto shared_claim = std::make_shared<const Claim>(std::move(claim));
+
+    LOCK(m_mutex);
+
+    return m_claims.Insert(block_hash, std::move(shared_claim));
+}
+
+ContractCache::Stats ContractCache::GetStats() const
+{
+    LOCK(m_mutex);
+
+    Stats stats = m_stats;
+    stats.m_transactions = m_contracts.Size();
+    stats.m_claims = m_claims.Size();
+
+    return stats;
+}
+
+void ContractCache::Clear()
+{
+    LOCK(m_mutex);
+
+    m_contracts.Clear();
+    m_claims.Clear();
+    m_stats = Stats();
+}
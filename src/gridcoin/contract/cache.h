@@ -0,0 +1,197 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#ifndef GRIDCOIN_CONTRACT_CACHE_H
+#define GRIDCOIN_CONTRACT_CACHE_H
+
+#include "gridcoin/contract/contract.h"
+#include "sync.h"
+#include "uint256.h"
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class CTransaction;
+
+namespace GRC {
+class Claim;
+
+//!
+//! \brief A bounded cache of the contracts parsed from transactions and of the
+//! claims of blocks, shared immutably by the code that reads them.
+//!
+//! CTransaction::GetContracts() parses the legacy contract of a transaction
+//! again for each copy of the transaction, and Contract::SharePayload() parses
+//! a legacy payload again on each call. The contract dispatcher, the vote
+//! counter, and the beacon lookups of the vote weight resolver see the same
+//! transactions from the memory pool, from blocks, and from the disk. This
+//! cache keeps the contracts of each transaction with the legacy payloads
+//! converted once, and the claims that GetClaimByIndex() reads from blocks.
+//!
+//! A transaction ID commits to the contracts and a block hash commits to the
+//! claim, so entries never become stale. The least recently used entries make
+//! room for new ones.
+//!
+class ContractCache
+{
+public:
+    //!
+    //! \brief The contracts of a transaction. Do NOT modify them, or pull
+    //! payloads from copies of them.
+    //!
+    typedef std::shared_ptr<const std::vector<Contract>> ContractsPtr;
+
+    typedef std::shared_ptr<const Claim> ClaimPtr;
+
+    //!
+    //! \brief Number of transactions that the cache keeps the contracts of.
+    //!
+    static constexpr size_t MAX_TRANSACTIONS = 4096;
+
+    //!
+    //! \brief Number of block claims that the cache keeps. A claim shares
+    //! its superblock.
+    //!
+    static constexpr size_t MAX_CLAIMS = 1024;
+
+    //!
+    //! \brief Counters for the debug log and the tests.
+    //!
+    struct Stats
+    {
+        uint64_t m_hits = 0;
+        uint64_t m_misses = 0;
+        size_t m_transactions = 0;
+        size_t m_claims = 0;
+    };
+
+    //!
+    //! \brief Initialize an empty cache.
+    //!
+    ContractCache(size_t max_transactions = MAX_TRANSACTIONS, size_t max_claims = MAX_CLAIMS);
+
+    //!
+    //! \brief Get the contracts of a transaction.
+    //!
+    //! Transactions without contracts return an empty set without a lookup.
+    //!
+    //! \param tx The transaction. Hashed if it has contracts.
+    //!
+    ContractsPtr GetContracts(const CTransaction& tx);
+
+    //!
+    //! \brief Get the contracts of a transaction with a known hash.
+    //!
+    //! \param txid Hash of the transaction.
+    //! \param tx   The transaction. Parsed only for an entry not yet cached.
+    //!
+    ContractsPtr GetContracts(const uint256& txid, const CTransaction& tx);
+
+    //!
+    //! \brief Get the cached claim of a block.
+    //!
+    //! \return The claim, or \c nullptr when the cache does not contain it.
+    //!
+    ClaimPtr FindClaim(const uint256& block_hash);
+
+    //!
+    //! \brief Add the claim of a block.
+    //!
+    //! \return The cached claim.
+    //!
+    ClaimPtr StoreClaim(const uint256& block_hash, Claim claim);
+
+    //!
+    //! \brief Get the counters of the cache.
+    //!
+    Stats GetStats() const;
+
+    //!
+    //! \brief Remove every entry and reset the counters.
+    //!
+    void Clear();
+
+private:
+    struct TxidHasher
+    {
+        size_t operator()(const uint256& hash) const { return hash.GetUint64(0); }
+    };
+
+    //!
+    //! \brief Maps hashes to shared values and evicts the least recently
+    //! used entry when full.
+    //!
+    template <typename Value>
+    class LruMap
+    {
+    public:
+        explicit LruMap(const size_t max_size) : m_max_size(max_size)
+        {
+        }
+
+        Value Find(const uint256& key)
+        {
+            const auto iter = m_index.find(key);
+
+            if (iter == m_index.end()) {
+                return nullptr;
+            }
+
+            m_entries.splice(m_entries.begin(), m_entries, iter->second);
+
+            return iter->second->second;
+        }
+
+        Value Insert(const uint256& key, Value value)
+        {
+            // Another thread may have inserted the same entry first:
+            if (Value existing = Find(key)) {
+                return existing;
+            }
+
+            m_entries.emplace_front(key, std::move(value));
+            m_index.emplace(key, m_entries.begin());
+
+            if (m_entries.size() > m_max_size) {
+                m_index.erase(m_entries.back().first);
+                m_entries.pop_back();
+            }
+
+            return m_entries.front().second;
+        }
+
+        size_t Size() const
+        {
+            return m_entries.size();
+        }
+
+        void Clear()
+        {
+            m_index.clear();
+            m_entries.clear();
+        }
+
+    private:
+        typedef std::list<std::pair<uint256, Value>> EntryList;
+
+        const size_t m_max_size;
+        EntryList m_entries; //!< Most recently used first.
+        std::unordered_map<uint256, typename EntryList::iterator, TxidHasher> m_index;
+    };
+
+    mutable Mutex m_mutex;
+    LruMap<ContractsPtr> m_contracts GUARDED_BY(m_mutex);
+    LruMap<ClaimPtr> m_claims GUARDED_BY(m_mutex);
+    Stats m_stats GUARDED_BY(m_mutex);
+}; // ContractCache
+
+//!
+//! \brief Get the global contract cache.
+//!
+ContractCache& GetContractCache();
+} // namespace GRC
+
+#endif // GRIDCOIN_CONTRACT_CACHE_H
@@ -9,6 +9,7 @@
 #include "gridcoin/claim.h"
 #include "gridcoin/mrc.h"
 #include "gridcoin/protocol.h"
+#include "gridcoin/contract/cache.h"
 #include "gridcoin/contract/contract.h"
 #include "gridcoin/contract/handler.h"
 #include "gridcoin/contract/registry.h"
@@ -519,7 +520,9 @@ void GRC::ApplyContracts(
     const CBlockIndex* const pindex, const RegistryBookmarks& db_heights,
     bool& out_found_contract)
 {
-    for (const auto& contract : tx.GetContracts()) {
+    const auto contracts = GetContractCache().GetContracts(tx);
+
+    for (const auto& contract : *contracts) {
         // Do not (re)apply contracts that have already been stored/loaded into
         // the relevant entry dbs up to the block BEFORE the relevant db height. Because
         // these db heights are at the block level, and are updated on each relevant entry
@@ -578,7 +581,9 @@ void GRC::ApplyContracts(
 
 bool GRC::ValidateContracts(const CTransaction& tx, int& DoS)
 {
-    for (const auto& contract : tx.GetContracts()) {
+    const auto contracts = GetContractCache().GetContracts(tx);
+
+    for (const auto& contract : *contracts) {
         if (!g_dispatcher.Validate(contract, tx, DoS)) {
             return false;
         }
@@ -589,7 +594,9 @@ bool GRC::ValidateContracts(const CTransaction& tx, int& DoS)
 
 bool GRC::BlockValidateContracts(const CBlockIndex* const pindex, const CTransaction& tx, int& DoS)
 {
-    for (const auto& contract: tx.GetContracts()) {
+    const auto contracts = GetContractCache().GetContracts(tx);
+
+    for (const auto& contract : *contracts) {
         if (!g_dispatcher.BlockValidate({ contract, tx, pindex }, DoS)) {
             return false;
         }
@@ -600,8 +607,10 @@ bool GRC::BlockValidateContracts(const CBlockIndex* const pindex, const CTransac
 
 void GRC::RevertContracts(const CTransaction& tx, const CBlockIndex* const pindex)
 {
+    const auto contracts = GetContractCache().GetContracts(tx);
+
     // Reverse the contracts. Reorganize will load any previous versions:
-    for (const auto& contract : tx.GetContracts()) {
+    for (const auto& contract : *contracts) {
         // V2 contracts are checked upon receipt:
         if (contract.m_version == 1 && !CheckLegacyContract(contract, tx, pindex->nHeight)) {
             continue;
@@ -717,17 +726,47 @@ bool Contract::WellFormed() const
 
 ContractPayload Contract::SharePayload() const
 {
-    // The scraper and protocol entry formats were changed to native later than the others and a new contract
-    // version three is introduced for that. This will be coincident with block v13.
-    if (m_version < 2
-            || (m_type == ContractType::SCRAPER && m_version < 3)
-            || (m_type == ContractType::PROTOCOL && m_version < 3)) {
+    if (m_converted_payload) {
+        return *m_converted_payload;
+    }
+
+    if (HasLegacyPayload()) {
         return m_body.ConvertFromLegacy(m_type.Value(), m_version);
     }
 
     return m_body.m_payload;
 }
 
+void Contract::CacheConvertedPayload()
+{
+    if (m_converted_payload || !HasLegacyPayload()) {
+        return;
+    }
+
+    switch (m_type.Value()) {
+        case ContractType::BEACON:
+        case ContractType::POLL:
+        case ContractType::PROJECT:
+        case ContractType::PROTOCOL:
+        case ContractType::SCRAPER:
+        case ContractType::VOTE:
+            m_converted_payload = m_body.ConvertFromLegacy(m_type.Value(), m_version);
+            break;
+        default:
+            // The other types have no legacy payload to convert:
+            break;
+    }
+}
+
+bool Contract::HasLegacyPayload() const
+{
+    // The scraper and protocol entry formats were changed to native later than the others and a new contract
+    // version three is introduced for that. This will be coincident with block v13.
+    return m_version < 2
+        || (m_type == ContractType::SCRAPER && m_version < 3)
+        || (m_type == ContractType::PROTOCOL && m_version < 3);
+}
+
 void Contract::Log(const std::string& prefix) const
 {
     // TODO: temporary... needs better logging
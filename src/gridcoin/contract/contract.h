@@ -413,9 +413,25 @@ public:
         // Since only handlers for a particular contract type should access the
         // the payload, the derived type is known at the casting site.
         //
+        // Copies of the contract share a payload that CacheConvertedPayload()
+        // converted, so leave it in place:
+        if (m_converted_payload) {
+            return static_cast<const PayloadType&>(**m_converted_payload);
+        }
+
         return std::move(static_cast<PayloadType&>(*SharePayload()));;
     }
 
+    //!
+    //! \brief Convert a legacy payload once so that \c SharePayload() returns
+    //! the converted object instead of parsing the legacy strings each time.
+    //!
+    //! Copies of the contract share the converted payload. Call this while no
+    //! other thread can read the contract, and do NOT modify the contract
+    //! afterward. Deserialization discards the converted payload.
+    //!
+    void CacheConvertedPayload();
+
     //!
     //! \brief Write a message to the debug log with the contract data.
     //!
@@ -457,7 +473,20 @@ public:
 
         m_body.ResetType(m_type.Value());
         m_body.Unserialize(s, m_action.Value());
+        m_converted_payload.reset();
     }
+
+private:
+    //!
+    //! \brief Payload converted from a legacy payload by \c CacheConvertedPayload().
+    //!
+    std::optional<ContractPayload> m_converted_payload;
+
+    //!
+    //! \brief Determine whether the payload is stored in a legacy format that
+    //! \c SharePayload() converts.
+    //!
+    bool HasLegacyPayload() const;
 }; // Contract
 
 //!
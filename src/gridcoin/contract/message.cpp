@@ -154,17 +154,13 @@ std::string SendContractTx(CWalletTx& wtx_new)
         return strError;
     }
 
-    for (const auto& pool_tx : mempool.mapTx) {
-        for (const auto& pool_tx_contract : pool_tx.second.GetContracts()) {
-            if (pool_tx_contract.m_type == GRC::ContractType::SIDESTAKE) {
-                std::string strError = _(
-                    "Error: The mandatory sidestake transaction was rejected. "
-                    "There is already a mandatory sidestake transaction in the mempool. "
-                    "Wait until that transaction is bound in a block.");
-                error("%s: %s", __func__, strError);
-                return strError;
-            }
-        }
+    if (WITH_LOCK(mempool.cs, return !mempool.GetByContractType(GRC::ContractType::SIDESTAKE).empty())) {
+        std::string strError = _(
+            "Error: The mandatory sidestake transaction was rejected. "
+            "There is already a mandatory sidestake transaction in the mempool. "
+            "Wait until that transaction is bound in a block.");
+        error("%s: %s", __func__, strError);
+        return strError;
     }
 
     if (!pwalletMain->CommitTransaction(wtx_new, reserve_key)) {
@@ -13,8 +13,11 @@
 #include "gridcoin/superblock.h"
 #include "node/blockstorage.h"
 #include "util/reverse_iterator.h"
+#include "util/trace.h"
 #include <util/string.h>
 
+#include <algorithm>
+#include <list>
 #include <unordered_map>
 
 using namespace GRC;
@@ -22,6 +25,14 @@ using namespace GRC;
 // TODO: use a header
 ScraperStatsAndVerifiedBeacons  GetScraperStatsByConvergedManifest(const ConvergedManifest& StructConvergedManifest);
 ScraperStatsAndVerifiedBeacons  GetScraperStatsFromSingleManifest(CScraperManifest_shared_ptr& manifest);
+std::vector<ScraperStats> GetProjectStatsFromParts(
+    const std::vector<std::pair<std::string, const CSplitBlob::CPart*>>& project_parts,
+    const unsigned int nActiveProjects);
+bool GetScraperStatsFromProjectCombination(
+    const std::vector<const ScraperStats*>& project_stats,
+    const CSplitBlob::CPart* beacon_list_part,
+    const CSplitBlob::CPart* verified_beacons_part,
+    ScraperStatsAndVerifiedBeacons& stats_and_verified_beacons);
 unsigned int NumScrapersForSupermajority(unsigned int nScraperCount);
 mmCSManifestsBinnedByScraper ScraperCullAndBinCScraperManifests();
 Superblock ScraperGetSuperblockContract(
@@ -246,6 +257,244 @@ private:
     std::deque<SuperblockPtr> m_cache;
 }; // SuperblockIndex
 
+//!
+//! \brief Locates the superblocks of the main chain by height and by time.
+//!
+//! The superblock index only keeps the last few superblocks. Code that needs
+//! an older superblock, like the poll result resolver and the accrual snapshot
+//! rebuild, walked back through the block index to find one and then read the
+//! block from disk again. This history keeps the block index entries of every
+//! superblock in the main chain in ascending order so that a binary search
+//! finds the superblock in effect at any height or time. It decodes the
+//! superblocks on demand and keeps the most recently used ones.
+//!
+//! The history loads from the chain tip at startup, or lazily on the first
+//! lookup.
+//!
+class SuperblockHistory
+{
+    //!
+    //! \brief Number of decoded superblocks to keep.
+    //!
+    static constexpr size_t CACHE_SIZE = 32;
+
+public:
+    //!
+    //! \brief Get the last superblock at or below the specified height.
+    //!
+    //! \return The block index entry of the superblock or \c nullptr when no
+    //! superblock exists at or below the height.
+    //!
+    const CBlockIndex* FindByHeight(const int height)
+    {
+        EnsureLoaded();
+
+        LOCK(m_mutex);
+
+        const auto iter = std::upper_bound(
+            m_entries.begin(),
+            m_entries.end(),
+            height,
+            [](const int height, const CBlockIndex* pindex) { return height < pindex->nHeight; });
+
+        return Resolve(iter);
+    }
+
+    //!
+    //! \brief Get the last superblock with a timestamp at or before the
+    //! specified time.
+    //!
+    //! Superblocks follow each other by at least a day, so their timestamps
+    //! ascend with their heights.
+    //!
+    //! \return The block index entry of the superblock or \c nullptr when no
+    //! superblock exists at or before the time.
+    //!
+    const CBlockIndex* FindByTime(const int64_t time)
+    {
+        EnsureLoaded();
+
+        LOCK(m_mutex);
+
+        const auto iter = std::upper_bound(
+            m_entries.begin(),
+            m_entries.end(),
+            time,
+            [](const int64_t time, const CBlockIndex* pindex) { return time < pindex->GetBlockTime(); });
+
+        return Resolve(iter);
+    }
+
+    //!
+    //! \brief Get the decoded superblock for a block index entry.
+    //!
+    //! \return The superblock, or an empty superblock if the block does not
+    //! contain one or the read failed.
+    //!
+    SuperblockPtr Read(const CBlockIndex* const pindex)
+    {
+        if (!pindex) {
+            return SuperblockPtr::Empty();
+        }
+
+        {
+            LOCK(m_mutex);
+
+            for (auto iter = m_cache.begin(); iter != m_cache.end(); ++iter) {
+                if (iter->first == pindex) {
+                    m_cache.splice(m_cache.begin(), m_cache, iter);
+                    return m_cache.front().second;
+                }
+            }
+        }
+
+        // Read outside of the lock so that lookups do not wait on the disk:
+        SuperblockPtr superblock = SuperblockPtr::ReadFromDisk(pindex);
+
+        if (superblock->WellFormed()) {
+            LOCK(m_mutex);
+            Cache(pindex, superblock);
+        }
+
+        return superblock;
+    }
+
+    //!
+    //! \brief Record a superblock connected to the main chain.
+    //!
+    //! \param pindex     Block index entry of the block that contains it.
+    //! \param superblock The decoded superblock to cache.
+    //!
+    void Push(const CBlockIndex* const pindex, SuperblockPtr superblock)
+    {
+        LOCK(m_mutex);
+
+        if (!m_loaded) {
+            Load(pindex->pprev);
+        }
+
+        Truncate(pindex->nHeight);
+
+        m_entries.push_back(pindex);
+        Cache(pindex, std::move(superblock));
+    }
+
+    //!
+    //! \brief Forget the superblocks at or above the height of a block
+    //! disconnected from the main chain.
+    //!
+    void Pop(const CBlockIndex* const pindex)
+    {
+        LOCK(m_mutex);
+
+        if (m_loaded) {
+            Truncate(pindex->nHeight);
+        }
+    }
+
+    //!
+    //! \brief Build the history from the block index unless it already
+    //! contains the main chain.
+    //!
+    //! \param pindexLast The block to begin loading superblocks backward from.
+    //!
+    void Initialize(const CBlockIndex* const pindexLast)
+    {
+        LOCK(m_mutex);
+
+        if (!m_loaded) {
+            Load(pindexLast);
+        }
+    }
+
+private:
+    typedef std::vector<const CBlockIndex*>::const_iterator EntryIter;
+
+    mutable Mutex m_mutex;
+    std::vector<const CBlockIndex*> m_entries GUARDED_BY(m_mutex); //!< Superblocks by height.
+    std::list<std::pair<const CBlockIndex*, SuperblockPtr>> m_cache GUARDED_BY(m_mutex); //!< Most recently used first.
+    bool m_loaded GUARDED_BY(m_mutex) = false;
+
+    void Load(const CBlockIndex* pindexLast) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        m_entries.clear();
+        m_cache.clear();
+
+        for (; pindexLast; pindexLast = pindexLast->pprev) {
+            if (pindexLast->IsSuperblock()) {
+                m_entries.push_back(pindexLast);
+            }
+        }
+
+        std::reverse(m_entries.begin(), m_entries.end());
+        m_loaded = true;
+
+        LogPrint(BCLog::LogFlags::VERBOSE, "SuperblockHistory::Load(): %u superblocks", m_entries.size());
+    }
+
+    //!
+    //! \brief Load the history from the chain tip on the first lookup.
+    //!
+    //! Lookups can come from threads that do not hold cs_main. It guards the
+    //! chain tip and is taken before m_mutex like the callers of Push() do,
+    //! but only for the one-time load so that lookups do not contend for it.
+    //!
+    void EnsureLoaded() LOCKS_EXCLUDED(m_mutex)
+    {
+        {
+            LOCK(m_mutex);
+
+            if (m_loaded) {
+                return;
+            }
+        }
+
+        LOCK2(cs_main, m_mutex);
+
+        // Another thread or Push() may have loaded the history meanwhile:
+        if (!m_loaded) {
+            Load(pindexBest);
+        }
+    }
+
+    //!
+    //! \brief Get the entry before the upper bound of a search, skipping any
+    //! superblock that failed to connect after the tally loaded it.
+    //!
+    const CBlockIndex* Resolve(EntryIter iter) const EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        while (iter != m_entries.begin()) {
+            --iter;
+
+            if ((*iter)->IsSuperblock()) {
+                return *iter;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void Truncate(const int height) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        while (!m_entries.empty() && m_entries.back()->nHeight >= height) {
+            m_entries.pop_back();
+        }
+
+        m_cache.remove_if([&](const auto& entry) { return entry.first->nHeight >= height; });
+    }
+
+    void Cache(const CBlockIndex* const pindex, SuperblockPtr superblock) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        // Another thread may have read the same superblock first:
+        m_cache.remove_if([&](const auto& entry) { return entry.first == pindex; });
+        m_cache.emplace_front(pindex, std::move(superblock));
+
+        if (m_cache.size() > CACHE_SIZE) {
+            m_cache.pop_back();
+        }
+    }
+}; // SuperblockHistory
+
 //!
 //! \brief A vote for a superblock for legacy quorum consensus.
 //!
@@ -797,38 +1046,71 @@ private: // SuperblockValidator classes
     //! \brief Generates a superblock hash from the contained convergence of
     //! manifest parts for comparison to the validated superblock.
     //!
+    //! The candidate refers to the project statistics that ProjectCombiner
+    //! already computed for each part, so it must not outlive the combiner.
+    //!
     class ConvergenceCandidate
     {
     public:
         //!
-        //! \brief Add the provided manifest part to the convergence.
+        //! \brief Add the provided beacon list or verified beacons manifest
+        //! part to the convergence.
         //!
-        //! \param project_name      Identifies the project to add.
-        //! \param project_part_data Serialized project stats of the part.
+        //! \param part_name Either "BeaconList" or "VerifiedBeacons".
+        //! \param part_ptr  Serialized data of the part.
         //!
-        void AddPart(std::string project_name, CSplitBlob::CPart* project_part_ptr)
+        void AddPart(const std::string& part_name, const CSplitBlob::CPart* part_ptr)
         {
-            m_convergence.ConvergedManifestPartPtrsMap.emplace(
-                std::move(project_name),
-                std::move(project_part_ptr));
+            if (part_name == "BeaconList") {
+                m_beacon_list = part_ptr;
+            } else if (part_name == "VerifiedBeacons") {
+                m_verified_beacons = part_ptr;
+            }
         }
 
         //!
-        //! \brief Calculate a superblock hash from the supplied manifest data
-        //! that matches the set of resolved project parts.
+        //! \brief Add the statistics computed from a project part to the
+        //! convergence.
         //!
-        //! \return A superblock hash generated from the convergence to compare
-        //! to the superblock under validation.
+        //! \param project_stats Statistics of the project, or \c nullptr when
+        //! the part disappeared.
         //!
-        QuorumHash ComputeQuorumHash() const
+        void AddProjectStats(const ScraperStats* project_stats)
         {
-            const ScraperStatsAndVerifiedBeacons stats_and_verified_beacons = GetScraperStatsByConvergedManifest(m_convergence);
+            m_project_stats.emplace_back(project_stats);
+        }
 
-            return QuorumHash::Hash(stats_and_verified_beacons);
+        //!
+        //! \brief Determine whether the set of resolved project parts builds
+        //! a superblock with the same quorum hash as the superblock under
+        //! validation.
+        //!
+        //! \param quorum_segments Sections of the quorum hash of the superblock
+        //! under validation.
+        //!
+        //! \return \c false if a part of the convergence is missing or if the
+        //! hash does not match.
+        //!
+        bool Matches(const QuorumHashSegments& quorum_segments) const
+        {
+            ScraperStatsAndVerifiedBeacons stats_and_verified_beacons;
+
+            return GetScraperStatsFromProjectCombination(
+                    m_project_stats,
+                    m_beacon_list,
+                    m_verified_beacons,
+                    stats_and_verified_beacons)
+                && quorum_segments.Matches(stats_and_verified_beacons);
         }
 
     private:
-        ConvergedManifest m_convergence; //!< Used to compute a superblock hash
+        //!
+        //! \brief Statistics of the selected part of each project owned by
+        //! ProjectCombiner. Null for a part that disappeared.
+        //!
+        std::vector<const ScraperStats*> m_project_stats;
+        const CSplitBlob::CPart* m_beacon_list = nullptr;
+        const CSplitBlob::CPart* m_verified_beacons = nullptr;
     };
 
     //!
@@ -852,6 +1134,10 @@ private: // SuperblockValidator classes
     //! in the superblock is incredibly small, but this provision prevents the
     //! validation of a superblock from failing if a collision ever occurs.
     //!
+    //! The statistics of a project part do not depend on the other parts in
+    //! a combination, so the combiner computes them once for every resolved
+    //! part in parallel and each convergence only merges them.
+    //!
     class ProjectCombiner
     {
     public:
@@ -941,6 +1227,10 @@ private: // SuperblockValidator classes
                 return std::nullopt;
             }
 
+            if (m_current_combination == 0) {
+                ComputeProjectStats();
+            }
+
             ConvergenceCandidate convergence;
             size_t remainder = m_current_combination;
             uint256 latest_manifest;
@@ -960,9 +1250,10 @@ private: // SuperblockValidator classes
 
                 const auto& resolved_part = project.m_resolved_parts[part_index];
 
-                convergence.AddPart(
-                    project_pair.first, // project name
-                    GetResolvedPartPtr(resolved_part.m_part_hash));
+                const auto stats_iter = m_project_stats.find({ project_pair.first, resolved_part.m_part_hash });
+
+                convergence.AddProjectStats(
+                    stats_iter == m_project_stats.end() ? nullptr : &stats_iter->second);
 
                 remainder -= part_index * project.m_combiner_mask;
 
@@ -992,6 +1283,41 @@ private: // SuperblockValidator classes
         size_t m_total_combinations;  //!< Number of project part combinations.
         size_t m_current_combination; //!< Number of the combination to try.
 
+        //!
+        //! \brief Statistics computed from each resolved project part keyed
+        //! by project name and part hash.
+        //!
+        std::map<std::pair<std::string, uint256>, ScraperStats> m_project_stats;
+
+        //!
+        //! \brief Compute the statistics of every resolved project part.
+        //!
+        //! Parts that disappeared have no entry, so the convergences that
+        //! contain them cannot match a superblock.
+        //!
+        void ComputeProjectStats()
+        {
+            std::vector<uint256> part_hashes;
+            std::vector<std::pair<std::string, const CSplitBlob::CPart*>> project_parts;
+
+            for (const auto& project_pair : m_projects) {
+                for (const auto& resolved_part : project_pair.second.m_resolved_parts) {
+                    if (const CSplitBlob::CPart* part = GetResolvedPartPtr(resolved_part.m_part_hash)) {
+                        part_hashes.emplace_back(resolved_part.m_part_hash);
+                        project_parts.emplace_back(project_pair.first, part);
+                    }
+                }
+            }
+
+            std::vector<ScraperStats> project_stats = GetProjectStatsFromParts(project_parts, m_projects.size());
+
+            for (size_t i = 0; i < part_hashes.size(); ++i) {
+                m_project_stats.emplace(
+                    std::make_pair(project_parts[i].first, part_hashes[i]),
+                    std::move(project_stats[i]));
+            }
+        }
+
         //!
         //! \brief Fetch the project part data for the specified part hash.
         //!
@@ -1278,8 +1604,38 @@ private: // SuperblockValidator fields
     const QuorumHash m_quorum_hash;    //!< Hash of the superblock to validate.
     const size_t m_hint_shift;         //!< For testing by-project combinations.
 
+    //!
+    //! \brief Sections of the quorum hash of the superblock to validate.
+    //! Computed when first compared to scraper statistics.
+    //!
+    mutable std::optional<QuorumHashSegments> m_quorum_segments;
+
 private: // SuperblockValidator methods
 
+    //!
+    //! \brief Get the sections of the quorum hash of the superblock.
+    //!
+    const QuorumHashSegments& GetQuorumSegments() const
+    {
+        if (!m_quorum_segments) {
+            m_quorum_segments = QuorumHashSegments::FromSuperblock(*m_superblock);
+        }
+
+        return *m_quorum_segments;
+    }
+
+    //!
+    //! \brief Determine whether a superblock built from the provided scraper
+    //! statistics matches the superblock under validation.
+    //!
+    //! Scraper statistics only produce version 2+ quorum hashes.
+    //!
+    bool MatchesStats(const ScraperStatsAndVerifiedBeacons& stats_and_verified_beacons) const
+    {
+        return m_quorum_hash.Which() == QuorumHash::Kind::SHA256
+            && GetQuorumSegments().Matches(stats_and_verified_beacons);
+    }
+
     //!
     //! \brief Validate the superblock by comparing it to recent past converged
     //! manifests in the cache.
@@ -1394,7 +1750,7 @@ private: // SuperblockValidator methods
     {
         const ScraperStatsAndVerifiedBeacons stats_and_verified_beacons = GetScraperStatsFromSingleManifest(manifest);
 
-        return QuorumHash::Hash(stats_and_verified_beacons) == m_quorum_hash;
+        return MatchesStats(stats_and_verified_beacons);
     }
 
     //!
@@ -1435,8 +1791,12 @@ private: // SuperblockValidator methods
                  "ValidateSuperblock(): by-project possible combinations: %" PRIszu,
                  combiner.TotalCombinations());
 
+        if (m_quorum_hash.Which() != QuorumHash::Kind::SHA256) {
+            return false;
+        }
+
         while (const auto combination_option = combiner.GetNextConvergence()) {
-            if (combination_option->ComputeQuorumHash() == m_quorum_hash) {
+            if (combination_option->Matches(GetQuorumSegments())) {
                 return true;
             }
         }
@@ -1497,6 +1857,11 @@ private: // SuperblockValidator methods
 //!
 SuperblockIndex g_superblock_index;
 
+//!
+//! \brief Locates the superblocks of the main chain.
+//!
+SuperblockHistory g_superblock_history;
+
 //!
 //! \brief Orchestrates superblock voting for legacy quorum consensus.
 //!
@@ -1587,6 +1952,8 @@ bool Quorum::ValidateSuperblock(
     const bool use_cache,
     const size_t hint_bits)
 {
+    TRACE_SPAN("ValidateSuperblock");
+
     using Result = SuperblockValidator::Result;
 
     const Result result = SuperblockValidator(superblock, hint_bits).Validate(use_cache);
@@ -1714,6 +2081,8 @@ void Quorum::LoadSuperblockIndex(const CBlockIndex* pindexLast)
     }
 
     g_superblock_index.Reload(pindexLast);
+
+    g_superblock_history.Initialize(pindexLast);
 }
 
 Superblock Quorum::CreateSuperblock()
@@ -1721,10 +2090,11 @@ Superblock Quorum::CreateSuperblock()
     return ScraperGetSuperblockContract();
 }
 
-void Quorum::PushSuperblock(SuperblockPtr superblock)
+void Quorum::PushSuperblock(SuperblockPtr superblock, const CBlockIndex* const pindex)
 {
     LogPrintf("Quorum::PushSuperblock(%" PRId64 ")", superblock.m_height);
 
+    g_superblock_history.Push(pindex, superblock);
     g_superblock_index.PushSuperblock(std::move(superblock));
 }
 
@@ -1733,6 +2103,22 @@ void Quorum::PopSuperblock(const CBlockIndex* const pindex)
     LogPrintf("Quorum::PopSuperblock(%" PRId64 ")", pindex->nHeight);
 
     g_superblock_index.PopSuperblock();
+    g_superblock_history.Pop(pindex);
+}
+
+const CBlockIndex* Quorum::FindSuperblockIndex(const int height)
+{
+    return g_superblock_history.FindByHeight(height);
+}
+
+const CBlockIndex* Quorum::FindSuperblockIndexByTime(const int64_t time)
+{
+    return g_superblock_history.FindByTime(time);
+}
+
+SuperblockPtr Quorum::ReadSuperblock(const CBlockIndex* const pindex)
+{
+    return g_superblock_history.Read(pindex);
 }
 
 bool Quorum::CommitSuperblock(const uint32_t height)
@@ -216,8 +216,9 @@ public:
     //! \brief Push a new superblock into the tally.
     //!
     //! \param superblock Contains the superblock data to load.
+    //! \param pindex     Represents the block that contains the superblock.
     //!
-    static void PushSuperblock(SuperblockPtr superblock);
+    static void PushSuperblock(SuperblockPtr superblock, const CBlockIndex* const pindex);
 
     //!
     //! \brief Drop the last superblock loaded into the tally.
@@ -226,6 +227,44 @@ public:
     //!
     static void PopSuperblock(const CBlockIndex* const pindex);
 
+    //!
+    //! \brief Find the superblock in effect at the specified height.
+    //!
+    //! This binary searches the superblocks of the main chain instead of
+    //! walking back through the block index. The superblock flags of blocks
+    //! below height 1034768 on mainnet are not reliable, so the search may not
+    //! find some of the earliest superblocks.
+    //!
+    //! \param height Height of a block in the main chain.
+    //!
+    //! \return The block index entry of the last superblock at or below the
+    //! height, or \c nullptr if no superblock exists.
+    //!
+    static const CBlockIndex* FindSuperblockIndex(const int height);
+
+    //!
+    //! \brief Find the superblock in effect at the specified time.
+    //!
+    //! \param time Timestamp as the number of seconds since the UNIX epoch.
+    //!
+    //! \return The block index entry of the last superblock with a timestamp
+    //! at or before the time, or \c nullptr if no superblock exists.
+    //!
+    static const CBlockIndex* FindSuperblockIndexByTime(const int64_t time);
+
+    //!
+    //! \brief Get the superblock contained in a block.
+    //!
+    //! This returns a recently used superblock from memory or reads the block
+    //! from disk.
+    //!
+    //! \param pindex Block index entry of a superblock.
+    //!
+    //! \return The superblock, or an empty superblock when the block does not
+    //! contain one.
+    //!
+    static SuperblockPtr ReadSuperblock(const CBlockIndex* const pindex);
+
     //!
     //! \brief Activate the superblock received at or below the specified
     //! height.
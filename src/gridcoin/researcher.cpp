@@ -692,8 +692,10 @@ BeaconError CheckBeaconTransactionViable(CWallet* wallet, const Cpid& cpid)
         return BeaconError::INSUFFICIENT_FUNDS;
     }
 
-    for (const auto& [_, pool_tx] : mempool.mapTx) {
-        for (const auto& pool_tx_contract : pool_tx.GetContracts()) {
+    LOCK(mempool.cs);
+
+    for (const auto& pool_tx_hash : mempool.GetByContractType(GRC::ContractType::BEACON)) {
+        for (const auto& pool_tx_contract : mempool.GetEntry(pool_tx_hash)->GetTx().GetContracts()) {
             if (pool_tx_contract.m_type == GRC::ContractType::BEACON) {
                 GRC::BeaconPayload pool_tx_beacon = pool_tx_contract.CopyPayloadAs<GRC::BeaconPayload>();
 
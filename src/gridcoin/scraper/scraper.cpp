@@ -35,7 +35,9 @@
 #include <boost/date_time/gregorian/gregorian.hpp>
 #include <boost/date_time/gregorian/greg_date.hpp>
 #include <util/strencodings.h>
+#include <util/trace.h>
 #include <random>
+#include <thread>
 #include <stdexcept>
 #include <util/string.h>
 
@@ -138,6 +140,8 @@ std::atomic<double> MAG_ROUND = 0.01;
 std::atomic<double> NETWORK_MAGNITUDE = 115000;
 /** Define magnitude limit for CPID magnitude entry. */
 std::atomic<double> CPID_MAG_LIMIT = GRC::Magnitude::MAX;
+/** Maximum number of threads that compute the statistics of the project parts of a convergence. */
+constexpr unsigned int MAX_STATS_THREADS = 8;
 
 // The settings below are consensus critical.
 /**
@@ -395,15 +399,38 @@ ScraperStatsAndVerifiedBeacons GetScraperStatsFromSingleManifest(CScraperManifes
 bool LoadProjectFileToStatsByCPID(const std::string& project, const fs::path& file, const double& projectmag,
                                   ScraperStats& mScraperStats);
 /**
- * @brief Computes statistics from a provided project object
- * @param project
- * @param ProjectData
- * @param projectmag
- * @param mScraperStats
- * @return bool true if successful
+ * @brief Computes the statistics of each of the provided project parts on a pool of worker threads. This is the part
+ * of the stats processing for a convergence that does not depend on the other projects.
+ * @param project_parts Project names with the parts that contain their statistics
+ * @param nActiveProjects The number of projects in the convergence, which sets the magnitude per project
+ * @return std::vector<ScraperStats> The statistics of each project part in the same order
+ */
+std::vector<ScraperStats> GetProjectStatsFromParts(
+    const std::vector<std::pair<std::string, const CSplitBlob::CPart*>>& project_parts,
+    const unsigned int nActiveProjects);
+/**
+ * @brief Combines the statistics computed by GetProjectStatsFromParts for a convergence and computes the network-wide
+ * statistics from them.
+ * @param project_stats The statistics of each project in the convergence
+ * @param verified_beacons_part The verified beacons part of the convergence, if any
+ * @return ScraperStatsAndVerifiedBeacons
  */
-bool LoadProjectObjectToStatsByCPID(const std::string& project, const SerializeData& ProjectData, const double& projectmag,
-                                    ScraperStats& mScraperStats);
+ScraperStatsAndVerifiedBeacons GetScraperStatsFromProjectStats(const std::vector<const ScraperStats*>& project_stats,
+                                                               const CSplitBlob::CPart* verified_beacons_part);
+/**
+ * @brief Computes the statistics of a by-project fallback convergence from the statistics computed by
+ * GetProjectStatsFromParts for the selected part of each project. Superblock validation checks each combination of the
+ * candidate project parts this way.
+ * @param project_stats The statistics of the selected part of each project. A null entry marks a part that disappeared.
+ * @param beacon_list_part The beacon list part of the convergence
+ * @param verified_beacons_part The verified beacons part of the convergence, if any
+ * @param stats_and_verified_beacons Receives the statistics of the convergence
+ * @return bool false if a project part or the beacon list part is missing
+ */
+bool GetScraperStatsFromProjectCombination(const std::vector<const ScraperStats*>& project_stats,
+                                           const CSplitBlob::CPart* beacon_list_part,
+                                           const CSplitBlob::CPart* verified_beacons_part,
+                                           ScraperStatsAndVerifiedBeacons& stats_and_verified_beacons);
 /**
  * @brief Computes statistics from a provided project data stream. This is used by LoadProjectFileToStatsByCPID.
  * @param project
@@ -414,14 +441,6 @@ bool LoadProjectObjectToStatsByCPID(const std::string& project, const SerializeD
  */
 bool ProcessProjectStatsFromStreamByCPID(const std::string& project, boostio::filtering_istream& sUncompressedIn,
                                          const double& projectmag, ScraperStats& mScraperStats);
-/**
- * @brief Once the project statistics have been computed for all of the whitelisted projects, this function is called
- * to compute network-wide statistics, and also compute the magnitudes, which cannot be computed until all projects are
- * processed.
- * @param mScraperStats
- * @return bool true if successful
- */
-bool ProcessNetworkWideFromProjectStats(ScraperStats& mScraperStats);
 /**
  * @brief Stores the provided mScraperStats statistics map to file.
  * @param file
@@ -1562,6 +1581,7 @@ void Scraper(bool bSingleShot)
         {
             // Take a lock on cs_Scraper for the main activity portion of the loop.
             LOCK(cs_Scraper);
+            TRACE_SPAN("Scraper::Stats");
 
             // Signal stats event to UI.
             uiInterface.NotifyScraperEvent(scrapereventtypes::Stats, CT_UPDATING, {});
@@ -1641,6 +1661,7 @@ void Scraper(bool bSingleShot)
             // Publish and/or local delete CScraperManifests.
             {
                 LOCK2(cs_StructScraperFileManifest, CScraperManifest::cs_mapManifest);
+                TRACE_SPAN("Scraper::Publish");
 
                 // If the hash is valid and doesn't match (a new one is available), or there are none, then publish a new
                 // one.
@@ -1665,7 +1686,10 @@ void Scraper(bool bSingleShot)
         {
             LOCK(cs_Scraper);
 
-            ScraperHousekeeping();
+            {
+                TRACE_SPAN("Scraper::Housekeeping");
+                ScraperHousekeeping();
+            }
 
             _log(logattribute::INFO, "Scraper", "Sleeping for " + ToString(scraper_sleep() / 1000) +" seconds");
             if (!MilliSleep(scraper_sleep())) return;
@@ -3864,71 +3888,158 @@ ScraperStatsAndVerifiedBeacons GetScraperStatsByCurrentFileManifestState()
     return stats_and_verified_beacons;
 }
 
-ScraperStatsAndVerifiedBeacons GetScraperStatsByConvergedManifest(const ConvergedManifest& StructConvergedManifest)
+std::vector<ScraperStats> GetProjectStatsFromParts(
+    const std::vector<std::pair<std::string, const CSplitBlob::CPart*>>& project_parts,
+    const unsigned int nActiveProjects)
 {
-    _log(logattribute::INFO, "GetScraperStatsByConvergedManifest", "Beginning stats processing.");
+    std::vector<ScraperStats> project_stats(project_parts.size());
+    std::vector<std::exception_ptr> errors(project_parts.size());
 
-    ScraperStatsAndVerifiedBeacons stats_and_verified_beacons;
+    double dMagnitudePerProject = NETWORK_MAGNITUDE / nActiveProjects;
 
-    // Enumerate the count of active projects from the dummy converged manifest. One of the parts
-    // is the beacon list, is not a project, which is why that should not be included in the count.
-    // Populate the verified beacons map, and if it is don't count that either.
-    ScraperPendingBeaconMap VerifiedBeaconMap;
+    // Each project part decompresses and parses independently of the others:
+    std::atomic<size_t> next_part {0};
+
+    const auto worker = [&]() {
+        for (size_t i = next_part++; i < project_parts.size(); i = next_part++) {
+            try {
+                LoadProjectObjectToStatsByCPID(project_parts[i].first,
+                                               project_parts[i].second->data,
+                                               dMagnitudePerProject,
+                                               project_stats[i]);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
 
-    int exclude_parts_from_count = 1;
+    const size_t threads = std::min<size_t>(
+        project_parts.size(),
+        std::clamp<unsigned int>(std::thread::hardware_concurrency(), 1, MAX_STATS_THREADS));
 
-    const auto& iter = StructConvergedManifest.ConvergedManifestPartPtrsMap.find("VerifiedBeacons");
-    if (iter != StructConvergedManifest.ConvergedManifestPartPtrsMap.end())
+    std::vector<std::thread> pool;
+
+    for (size_t i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    return project_stats;
+}
+
+ScraperStatsAndVerifiedBeacons GetScraperStatsFromProjectStats(const std::vector<const ScraperStats*>& project_stats,
+                                                               const CSplitBlob::CPart* verified_beacons_part)
+{
+    ScraperStatsAndVerifiedBeacons stats_and_verified_beacons;
+
+    if (verified_beacons_part)
     {
-        CDataStream part(iter->second->data, SER_NETWORK, 1);
+        CDataStream part(verified_beacons_part->data, SER_NETWORK, 1);
 
         try
         {
-            part >> VerifiedBeaconMap;
+            part >> stats_and_verified_beacons.mVerifiedMap;
         }
         catch (const std::exception& e)
         {
             _log(logattribute::WARNING, __func__, "failed to deserialize verified beacons part: " + std::string(e.what()));
         }
+    }
 
-        ++exclude_parts_from_count;
+    ScraperStats& mScraperStats = stats_and_verified_beacons.mScraperStats;
+
+    for (const ScraperStats* mProjectScraperStats : project_stats)
+    {
+        // Insert into overall map.
+        for (auto const& entry : *mProjectScraperStats)
+        {
+            mScraperStats[entry.first] = entry.second;
+        }
     }
 
-    stats_and_verified_beacons.mVerifiedMap = VerifiedBeaconMap;
+    ProcessNetworkWideFromProjectStats(mScraperStats);
+
+    return stats_and_verified_beacons;
+}
+
+bool GetScraperStatsFromProjectCombination(const std::vector<const ScraperStats*>& project_stats,
+                                           const CSplitBlob::CPart* beacon_list_part,
+                                           const CSplitBlob::CPart* verified_beacons_part,
+                                           ScraperStatsAndVerifiedBeacons& stats_and_verified_beacons)
+{
+    // A convergence without all of its parts cannot match a superblock:
+    if (!beacon_list_part
+        || std::find(project_stats.begin(), project_stats.end(), nullptr) != project_stats.end())
+    {
+        return false;
+    }
+
+    stats_and_verified_beacons = GetScraperStatsFromProjectStats(project_stats, verified_beacons_part);
+
+    return true;
+}
+
+ScraperStatsAndVerifiedBeacons GetScraperStatsByConvergedManifest(const ConvergedManifest& StructConvergedManifest)
+{
+    _log(logattribute::INFO, "GetScraperStatsByConvergedManifest", "Beginning stats processing.");
+
+    // Enumerate the count of active projects from the dummy converged manifest. One of the parts
+    // is the beacon list, is not a project, which is why that should not be included in the count.
+    // Find the verified beacons part, and if it is present don't count that either.
+    const CSplitBlob::CPart* verified_beacons_part = nullptr;
+
+    int exclude_parts_from_count = 1;
+
+    const auto& iter = StructConvergedManifest.ConvergedManifestPartPtrsMap.find("VerifiedBeacons");
+    if (iter != StructConvergedManifest.ConvergedManifestPartPtrsMap.end())
+    {
+        verified_beacons_part = iter->second;
+
+        ++exclude_parts_from_count;
+    }
 
     unsigned int nActiveProjects = StructConvergedManifest.ConvergedManifestPartPtrsMap.size() - exclude_parts_from_count;
     _log(logattribute::INFO, "GetScraperStatsByConvergedManifest",
          "Number of active projects in converged manifest = " + ToString(nActiveProjects));
 
-    double dMagnitudePerProject = NETWORK_MAGNITUDE / nActiveProjects;
-
-    ScraperStats mScraperStats;
-
+    std::vector<std::pair<std::string, const CSplitBlob::CPart*>> project_parts;
 
     for (auto entry = StructConvergedManifest.ConvergedManifestPartPtrsMap.begin();
          entry != StructConvergedManifest.ConvergedManifestPartPtrsMap.end(); ++entry)
     {
-        std::string project = entry->first;
-        ScraperStats mProjectScraperStats;
+        const std::string& project = entry->first;
 
         // Do not process the BeaconList or VerifiedBeacons as a project stats file.
         if (project != "BeaconList" && project != "VerifiedBeacons")
         {
             _log(logattribute::INFO, "GetScraperStatsByConvergedManifest", "Processing stats for project: " + project);
 
-            LoadProjectObjectToStatsByCPID(project, entry->second->data, dMagnitudePerProject, mProjectScraperStats);
-
-            // Insert into overall map.
-            for (auto const& entry2 : mProjectScraperStats)
-            {
-                mScraperStats[entry2.first] = entry2.second;
-            }
+            project_parts.emplace_back(project, entry->second);
         }
     }
 
-    ProcessNetworkWideFromProjectStats(mScraperStats);
+    const std::vector<ScraperStats> project_stats = GetProjectStatsFromParts(project_parts, nActiveProjects);
 
-    stats_and_verified_beacons.mScraperStats = mScraperStats;
+    std::vector<const ScraperStats*> project_stats_ptrs;
+
+    for (const auto& mProjectScraperStats : project_stats)
+    {
+        project_stats_ptrs.push_back(&mProjectScraperStats);
+    }
+
+    ScraperStatsAndVerifiedBeacons stats_and_verified_beacons
+        = GetScraperStatsFromProjectStats(project_stats_ptrs, verified_beacons_part);
 
     _log(logattribute::INFO, "GetScraperStatsByConvergedManifest", "Completed stats processing");
 
@@ -3976,24 +4087,26 @@ ScraperStatsAndVerifiedBeacons GetScraperStatsFromSingleManifest(CScraperManifes
     _log(logattribute::INFO, "GetScraperStatsFromSingleManifest",
          "Number of active projects in converged manifest = " + ToString(nActiveProjects));
 
-    double dMagnitudePerProject = NETWORK_MAGNITUDE / nActiveProjects;
+    std::vector<std::pair<std::string, const CSplitBlob::CPart*>> project_parts;
 
     for (auto entry = StructDummyConvergedManifest.ConvergedManifestPartPtrsMap.begin();
          entry != StructDummyConvergedManifest.ConvergedManifestPartPtrsMap.end(); ++entry)
     {
-        std::string project = entry->first;
-        ScraperStats mProjectScraperStats;
+        const std::string& project = entry->first;
 
         // Do not process the BeaconList or VerifiedBeacons as a project stats file.
         if (project != "BeaconList" && project != "VerifiedBeacons")
         {
             _log(logattribute::INFO, "GetScraperStatsFromSingleManifest", "Processing stats for project: " + project);
 
-            LoadProjectObjectToStatsByCPID(project, entry->second->data, dMagnitudePerProject, mProjectScraperStats);
+            project_parts.emplace_back(project, entry->second);
+        }
+    }
 
-            // Insert into overall map.
-            stats_and_verified_beacons.mScraperStats.insert(mProjectScraperStats.begin(), mProjectScraperStats.end());
-       }
+    for (const auto& mProjectScraperStats : GetProjectStatsFromParts(project_parts, nActiveProjects))
+    {
+        // Insert into overall map.
+        stats_and_verified_beacons.mScraperStats.insert(mProjectScraperStats.begin(), mProjectScraperStats.end());
     }
 
     ProcessNetworkWideFromProjectStats(stats_and_verified_beacons.mScraperStats);
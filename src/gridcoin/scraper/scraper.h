@@ -124,6 +124,57 @@ uint256 GetFileHash(const fs::path& inputfile);
  * @return ScraperStatsAndVerifiedBeacons
  */
 ScraperStatsAndVerifiedBeacons GetScraperStatsByConvergedManifest(const ConvergedManifest& StructConvergedManifest);
+/**
+ * @brief Computes statistics from a provided project object
+ * @param project
+ * @param ProjectData
+ * @param projectmag
+ * @param mScraperStats
+ * @return bool true if successful
+ */
+bool LoadProjectObjectToStatsByCPID(const std::string& project, const SerializeData& ProjectData, const double& projectmag,
+                                    ScraperStats& mScraperStats);
+/**
+ * @brief Computes the statistics of each of the provided project parts on a pool of worker threads. This is the part
+ * of the stats processing for a convergence that does not depend on the other projects.
+ * @param project_parts Project names with the parts that contain their statistics
+ * @param nActiveProjects The number of projects in the convergence, which sets the magnitude per project
+ * @return std::vector<ScraperStats> The statistics of each project part in the same order
+ */
+std::vector<ScraperStats> GetProjectStatsFromParts(
+    const std::vector<std::pair<std::string, const CSplitBlob::CPart*>>& project_parts,
+    const unsigned int nActiveProjects);
+/**
+ * @brief Combines the statistics computed by GetProjectStatsFromParts for a convergence and computes the network-wide
+ * statistics from them.
+ * @param project_stats The statistics of each project in the convergence
+ * @param verified_beacons_part The verified beacons part of the convergence, if any
+ * @return ScraperStatsAndVerifiedBeacons
+ */
+ScraperStatsAndVerifiedBeacons GetScraperStatsFromProjectStats(const std::vector<const ScraperStats*>& project_stats,
+                                                               const CSplitBlob::CPart* verified_beacons_part);
+/**
+ * @brief Computes the statistics of a by-project fallback convergence from the statistics computed by
+ * GetProjectStatsFromParts for the selected part of each project. Superblock validation checks each combination of the
+ * candidate project parts this way.
+ * @param project_stats The statistics of the selected part of each project. A null entry marks a part that disappeared.
+ * @param beacon_list_part The beacon list part of the convergence
+ * @param verified_beacons_part The verified beacons part of the convergence, if any
+ * @param stats_and_verified_beacons Receives the statistics of the convergence
+ * @return bool false if a project part or the beacon list part is missing
+ */
+bool GetScraperStatsFromProjectCombination(const std::vector<const ScraperStats*>& project_stats,
+                                           const CSplitBlob::CPart* beacon_list_part,
+                                           const CSplitBlob::CPart* verified_beacons_part,
+                                           ScraperStatsAndVerifiedBeacons& stats_and_verified_beacons);
+/**
+ * @brief Once the project statistics have been computed for all of the whitelisted projects, this function is called
+ * to compute network-wide statistics, and also compute the magnitudes, which cannot be computed until all projects are
+ * processed.
+ * @param mScraperStats
+ * @return bool true if successful
+ */
+bool ProcessNetworkWideFromProjectStats(ScraperStats& mScraperStats);
 /**
  * @brief Gets a copy of the extended scrapers cache global. This global is an extension of the appcache in that it
  * retains deleted entries with a deleted flag.
@@ -905,8 +905,31 @@ UniValue CScraperManifest::dentry::ToJson() const EXCLUSIVE_LOCKS_REQUIRED(CSpli
     return r;
 }
 
+namespace {
+//!
+//! \brief Format a manifest for listmanifests.
+//!
+UniValue ManifestToJson(const CScraperManifest& manifest, const bool bShowDetails)
+    EXCLUSIVE_LOCKS_REQUIRED(CScraperManifest::cs_mapManifest, CSplitBlob::cs_mapParts, manifest.cs_manifest)
+{
+    if (bShowDetails) return manifest.ToJson();
+
+    UniValue subset(UniValue::VOBJ);
+
+#ifdef SCRAPER_NET_PK_AS_ADDRESS
+    subset.pushKV("scraper (manifest) address", CBitcoinAddress(manifest.pubkey.GetID()).ToString());
+#else
+    subset.pushKV("scraper (manifest) pubkey", manifest.pubkey.GetID().ToString());
+#endif
+    subset.pushKV("manifest datetime", DateTimeStrFormat(manifest.nTime));
+    subset.pushKV("manifest content hash", manifest.nContentHash.GetHex());
+
+    return subset;
+}
+} // anonymous namespace
+
 /** RPC function to list manifests and optionally provide their contents in JSON form. */
-UniValue listmanifests(const UniValue& params, bool fHelp)
+void listmanifests(const UniValue& params, bool fHelp, JSONWriter& result)
 {
     if (fHelp || params.size() > 2)
     {
@@ -919,72 +942,66 @@ UniValue listmanifests(const UniValue& params, bool fHelp)
                 "Show list of known ScraperManifest objects.\n"
                 );
     }
-    UniValue obj(UniValue::VOBJ);
-    UniValue subset(UniValue::VOBJ);
 
     bool bShowDetails = false;
 
     if (params.size() > 0)
         bShowDetails = params[0].get_bool();
 
-    LOCK2(CScraperManifest::cs_mapManifest, CSplitBlob::cs_mapParts);
+    std::vector<uint256> hashes;
 
     if (params.size() > 1)
     {
         uint256 manifest_hash = uint256S(params[1].get_str());
 
-        auto pair = CScraperManifest::mapManifest.find(manifest_hash);
+        LOCK(CScraperManifest::cs_mapManifest);
 
-        if (pair == CScraperManifest::mapManifest.end())
+        if (CScraperManifest::mapManifest.find(manifest_hash) == CScraperManifest::mapManifest.end())
         {
             throw JSONRPCError(RPC_MISC_ERROR, "Manifest with specified hash not found.");
         }
 
-        const uint256& hash = pair->first;
-        const CScraperManifest& manifest = *pair->second;
+        hashes.push_back(manifest_hash);
+    }
+    else
+    {
+        LOCK(CScraperManifest::cs_mapManifest);
 
-        LOCK(manifest.cs_manifest);
+        hashes.reserve(CScraperManifest::mapManifest.size());
 
-        if (bShowDetails)
-            obj.pushKV(hash.GetHex(), manifest.ToJson());
-        else
+        for (const auto& pair : CScraperManifest::mapManifest)
         {
-#ifdef SCRAPER_NET_PK_AS_ADDRESS
-            subset.pushKV("scraper (manifest) address", CBitcoinAddress(manifest.pubkey.GetID()).ToString());
-#else
-            subset.pushKV("scraper (manifest) pubkey", manifest.pubkey.GetID().ToString());
-#endif
-            subset.pushKV("manifest datetime", DateTimeStrFormat(manifest.nTime));
-            subset.pushKV("manifest content hash", manifest.nContentHash.GetHex());
-            obj.pushKV(hash.GetHex(), subset);
+            hashes.push_back(pair.first);
         }
     }
-    else
+
+    result.BeginObject();
+
+    // Format one manifest at a time and hand it to the writer outside of the
+    // locks. A streaming writer may block while the client receives the data.
+    // Skip manifests deleted in the meantime.
+    for (const auto& hash : hashes)
     {
-        for (const auto& pair : CScraperManifest::mapManifest)
+        UniValue manifest_json;
+
         {
-            const uint256& hash = pair.first;
-            const CScraperManifest& manifest = *pair.second;
+            LOCK2(CScraperManifest::cs_mapManifest, CSplitBlob::cs_mapParts);
+
+            auto pair = CScraperManifest::mapManifest.find(hash);
+
+            if (pair == CScraperManifest::mapManifest.end()) continue;
+
+            const CScraperManifest& manifest = *pair->second;
 
             LOCK(manifest.cs_manifest);
 
-            if (bShowDetails)
-                obj.pushKV(hash.GetHex(), manifest.ToJson());
-            else
-            {
-    #ifdef SCRAPER_NET_PK_AS_ADDRESS
-                subset.pushKV("scraper (manifest) address", CBitcoinAddress(manifest.pubkey.GetID()).ToString());
-    #else
-                subset.pushKV("scraper (manifest) pubkey", manifest.pubkey.GetID().ToString());
-    #endif
-                subset.pushKV("manifest datetime", DateTimeStrFormat(manifest.nTime));
-                subset.pushKV("manifest content hash", manifest.nContentHash.GetHex());
-                obj.pushKV(hash.GetHex(), subset);
-            }
+            manifest_json = ManifestToJson(manifest, bShowDetails);
         }
+
+        result.PushKV(hash.GetHex(), manifest_json);
     }
 
-    return obj;
+    result.EndObject();
 }
 
 /** Provides hex string output of part object contents. */
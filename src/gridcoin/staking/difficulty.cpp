@@ -233,7 +233,7 @@ uint64_t GRC::GetStakeWeight(const CWallet& wallet)
 
     LOCK2(cs_main, wallet.cs_wallet);
 
-    if (!wallet.SelectCoinsForStaking(now, coins, unused, balance)) {
+    if (!wallet.SelectCoinsForStaking(now, coins, unused, balance, wallet.GetStakingChainView())) {
         return 0;
     }
 
@@ -413,23 +413,8 @@ bool GRC::ReadStakedInput(
         return error("%s: tx index not found for input tx %s", __func__, prevout_hash.GetHex());
     }
 
-    const CDiskTxPos pos = tx_index.pos;
-    CAutoFile file(OpenBlockFile(pos.nFile, pos.nBlockPos, "rb"), SER_DISK, CLIENT_VERSION);
-
-    if (file.IsNull()) {
-        return error("%s: OpenBlockFile failed", __func__);
-    }
-
-    try {
-        file >> out_header;
-
-        if (fseek(file.Get(), pos.nTxPos, SEEK_SET) != 0) {
-            return error("%s: tx fseek failed", __func__);
-        }
-
-        file >> out_txprev;
-    } catch (...) {
-        return error("%s: deserialize or I/O error", __func__);
+    if (!ReadTxFromDisk(out_txprev, tx_index.pos, &out_header)) {
+        return error("%s: failed to read input tx %s", __func__, prevout_hash.GetHex());
     }
 
     return true;
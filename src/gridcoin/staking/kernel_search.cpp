@@ -0,0 +1,139 @@
+// Copyright (c) 2014-2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "crypto/common.h"
+#include "crypto/sha256.h"
+#include "gridcoin/staking/kernel.h"
+#include "gridcoin/staking/kernel_search.h"
+#include "hash.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace GRC;
+
+namespace {
+//!
+//! \brief Offset of the coinstake timestamp in the kernel preimage.
+//!
+constexpr size_t TX_TIME_OFFSET = StakeKernelSearch::PREIMAGE_SIZE - 4;
+
+//!
+//! \brief Size of a SHA-256 block.
+//!
+constexpr size_t BLOCK_SIZE = 64;
+
+//!
+//! \brief Number of kernels that Find() hashes at once. Matches the widest
+//! multi-way SHA-256 transform.
+//!
+constexpr size_t BATCH_SIZE = 8;
+
+static_assert(StakeKernelSearch::PREIMAGE_SIZE + 9 <= BLOCK_SIZE,
+    "The kernel preimage must fit in a single padded SHA-256 block.");
+
+//!
+//! \brief Determine whether a kernel hash meets the target of a candidate.
+//!
+bool MeetsTarget(const uint256& hash, const StakeKernelSearch::Candidate& candidate)
+{
+    return arith_uint320(UintToArith256(hash)) <= candidate.m_target;
+}
+} // anonymous namespace
+
+// -----------------------------------------------------------------------------
+// Class: StakeKernelSearch
+// -----------------------------------------------------------------------------
+
+StakeKernelSearch::StakeKernelSearch(const uint64_t stake_modifier, const unsigned int bits)
+    : m_stake_modifier(stake_modifier)
+    , m_target(arith_uint256().SetCompact(bits))
+{
+}
+
+void StakeKernelSearch::AddCandidate(const COutPoint& prevout, const CAmount value, const uint32_t block_time)
+{
+    Candidate& candidate = m_candidates.emplace_back();
+
+    candidate.m_prevout = prevout;
+    candidate.m_value = value;
+    candidate.m_weight = CalculateStakeWeightV8(value);
+    candidate.m_target = m_target;
+    candidate.m_target *= arith_uint320(candidate.m_weight);
+
+    // Matches the serialization in CalculateStakeHashV8():
+    unsigned char* preimage = candidate.m_preimage;
+
+    WriteLE64(preimage, m_stake_modifier);
+    WriteLE32(preimage + 8, MaskStakeTime(block_time));
+    std::memcpy(preimage + 12, prevout.hash.begin(), 32);
+    WriteLE32(preimage + 44, prevout.n);
+    WriteLE32(preimage + TX_TIME_OFFSET, 0);
+
+    m_weight_sum += candidate.m_weight;
+    m_value_sum += value / (double) COIN;
+    m_weight_min = std::min(m_weight_min, candidate.m_weight);
+    m_weight_max = std::max(m_weight_max, candidate.m_weight);
+}
+
+uint256 StakeKernelSearch::GetKernelHash(const Candidate& candidate, const uint32_t tx_time) const
+{
+    unsigned char preimage[PREIMAGE_SIZE];
+
+    std::memcpy(preimage, candidate.m_preimage, TX_TIME_OFFSET);
+    WriteLE32(preimage + TX_TIME_OFFSET, MaskStakeTime(tx_time));
+
+    uint256 hash;
+    CHash256().Write(preimage).Finalize(hash);
+
+    return hash;
+}
+
+std::optional<size_t> StakeKernelSearch::Find(const uint32_t tx_time) const
+{
+    unsigned char blocks[BATCH_SIZE * BLOCK_SIZE] = { };
+    unsigned char hashes[BATCH_SIZE * CSHA256::OUTPUT_SIZE];
+    uint256 hash;
+
+    // Every block shares the timestamp and the SHA-256 padding. Only the
+    // candidate's part of the preimage changes between batches:
+    for (size_t i = 0; i < BATCH_SIZE; ++i) {
+        unsigned char* block = blocks + i * BLOCK_SIZE;
+
+        WriteLE32(block + TX_TIME_OFFSET, MaskStakeTime(tx_time));
+        block[PREIMAGE_SIZE] = 0x80;
+        WriteBE64(block + BLOCK_SIZE - 8, PREIMAGE_SIZE * 8);
+    }
+
+    for (size_t start = 0; start < m_candidates.size(); start += BATCH_SIZE) {
+        const size_t count = std::min(BATCH_SIZE, m_candidates.size() - start);
+
+        for (size_t i = 0; i < count; ++i) {
+            std::memcpy(blocks + i * BLOCK_SIZE, m_candidates[start + i].m_preimage, TX_TIME_OFFSET);
+        }
+
+        SHA256D1Block(hashes, blocks, count);
+
+        for (size_t i = 0; i < count; ++i) {
+            std::memcpy(hash.begin(), hashes + i * CSHA256::OUTPUT_SIZE, CSHA256::OUTPUT_SIZE);
+
+            if (MeetsTarget(hash, m_candidates[start + i])) {
+                return start + i;
+            }
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::optional<size_t> StakeKernelSearch::FindSerial(const uint32_t tx_time) const
+{
+    for (size_t i = 0; i < m_candidates.size(); ++i) {
+        if (MeetsTarget(GetKernelHash(m_candidates[i], tx_time), m_candidates[i])) {
+            return i;
+        }
+    }
+
+    return std::nullopt;
+}
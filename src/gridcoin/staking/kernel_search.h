@@ -0,0 +1,139 @@
+// Copyright (c) 2014-2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#ifndef GRIDCOIN_STAKING_KERNEL_SEARCH_H
+#define GRIDCOIN_STAKING_KERNEL_SEARCH_H
+
+#include "amount.h"
+#include "arith_uint256.h"
+#include "primitives/transaction.h"
+#include "uint256.h"
+
+#include <optional>
+#include <vector>
+
+namespace GRC {
+//!
+//! \brief Evaluates the version 8+ stake kernel of many coins for a single
+//! coinstake timestamp.
+//!
+//! The kernel hash of a coin is the double-SHA256 of the stake modifier, the
+//! masked time of the block that contains the coin, the coin's outpoint and the
+//! masked coinstake time. Everything except the coinstake time stays constant
+//! for a stake modifier, so the search serializes a kernel preimage for each
+//! coin once and patches only the timestamp for each attempt. It also scales
+//! the target by each coin's weight once instead of on each attempt.
+//!
+//! The search does not access the block index or the wallet, so it needs no
+//! locks once prepared.
+//!
+class StakeKernelSearch
+{
+public:
+    //!
+    //! \brief Size of the serialized kernel preimage: modifier, block time,
+    //! transaction hash, output index and coinstake time.
+    //!
+    static constexpr size_t PREIMAGE_SIZE = 8 + 4 + 32 + 4 + 4;
+
+    //!
+    //! \brief Per-coin constants of the kernel.
+    //!
+    struct Candidate
+    {
+        COutPoint m_prevout;       //!< Output that the coinstake would spend.
+        CAmount m_value;           //!< Value of the output.
+        int64_t m_weight;          //!< Stake weight of the output.
+        arith_uint320 m_target;    //!< Target scaled by the stake weight.
+        unsigned char m_preimage[PREIMAGE_SIZE]; //!< Kernel without the tx time.
+    };
+
+    //!
+    //! \brief Initialize a search for the specified stake modifier and target.
+    //!
+    //! \param stake_modifier Stake modifier of the chain tip.
+    //! \param bits           Compact difficulty target of the next block.
+    //!
+    StakeKernelSearch(const uint64_t stake_modifier, const unsigned int bits);
+
+    //!
+    //! \brief Add a coin to the search.
+    //!
+    //! \param prevout    Output that the coinstake would spend.
+    //! \param value      Value of the output.
+    //! \param block_time Timestamp of the block that contains the output.
+    //!
+    void AddCandidate(const COutPoint& prevout, const CAmount value, const uint32_t block_time);
+
+    //!
+    //! \brief Get the coins added to the search in the order of addition.
+    //!
+    const std::vector<Candidate>& GetCandidates() const { return m_candidates; }
+
+    //!
+    //! \brief Calculate the kernel hash of a candidate.
+    //!
+    //! \param candidate Candidate prepared by this search.
+    //! \param tx_time   Timestamp of the coinstake transaction.
+    //!
+    //! \return Same value as \c CalculateStakeHashV8() for the coin.
+    //!
+    uint256 GetKernelHash(const Candidate& candidate, const uint32_t tx_time) const;
+
+    //!
+    //! \brief Find the first candidate with a kernel that meets its target.
+    //!
+    //! A kernel preimage fits in a single padded SHA-256 block, so this hashes
+    //! the candidates in batches with the multi-way SHA-256 transforms that the
+    //! CPU supports.
+    //!
+    //! \param tx_time Timestamp of the coinstake transaction.
+    //!
+    //! \return Index of the candidate in \c GetCandidates() if found.
+    //!
+    std::optional<size_t> Find(const uint32_t tx_time) const;
+
+    //!
+    //! \brief Find the first candidate with a kernel that meets its target by
+    //! hashing one candidate at a time with \c GetKernelHash().
+    //!
+    //! \param tx_time Timestamp of the coinstake transaction.
+    //!
+    //! \return The same result as \c Find(). Used to verify the batched search.
+    //!
+    std::optional<size_t> FindSerial(const uint32_t tx_time) const;
+
+    //!
+    //! \brief Get the sum of the weights of the candidates.
+    //!
+    int64_t GetWeightSum() const { return m_weight_sum; }
+
+    //!
+    //! \brief Get the sum of the values of the candidates in units of GRC.
+    //!
+    double GetValueSum() const { return m_value_sum; }
+
+    //!
+    //! \brief Get the smallest weight of the candidates.
+    //!
+    int64_t GetWeightMin() const { return m_weight_min; }
+
+    //!
+    //! \brief Get the largest weight of the candidates.
+    //!
+    int64_t GetWeightMax() const { return m_weight_max; }
+
+private:
+    const uint64_t m_stake_modifier;  //!< Stake modifier of the chain tip.
+    const arith_uint256 m_target;     //!< Unweighted target.
+    std::vector<Candidate> m_candidates;
+
+    int64_t m_weight_sum = 0;
+    double m_value_sum = 0;
+    int64_t m_weight_min = MAX_MONEY;
+    int64_t m_weight_max = 0;
+};
+} // namespace GRC
+
+#endif // GRIDCOIN_STAKING_KERNEL_SEARCH_H
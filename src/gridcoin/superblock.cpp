@@ -152,15 +152,65 @@ public:
     //!
     QuorumHash GetHash() const
     {
-        SuperblockMock mock;
-        ScraperStatsSuperblockBuilder<SuperblockMock> builder(mock);
+        return GetSegments().GetHash();
+    }
 
-        builder.BuildFromStats(m_stats);
+    //!
+    //! \brief Generate the sections of the quorum hash of the wrapped scraper
+    //! statistics.
+    //!
+    //! \return The sections of the hash of a corresponding superblock.
+    //!
+    QuorumHashSegments GetSegments() const
+    {
+        return Build(Sections::ALL).GetSegments();
+    }
 
-        return mock.m_proxy.GetHash();
+    //!
+    //! \brief Determine whether the wrapped scraper statistics produce the
+    //! same zero count, project, and verified beacon sections.
+    //!
+    //! This pass does not feed the CPIDs to the magnitude hashers.
+    //!
+    //! \param segments The sections of the hash of a superblock.
+    //!
+    bool MatchesSmallSections(const QuorumHashSegments& segments) const
+    {
+        const QuorumHashSegments summary = Build(Sections::SMALL).m_segments;
+
+        return summary.m_zero_magnitude_count == segments.m_zero_magnitude_count
+            && summary.m_projects == segments.m_projects
+            && summary.m_verified_beacons == segments.m_verified_beacons;
+    }
+
+    //!
+    //! \brief Determine whether the wrapped scraper statistics produce the
+    //! provided quorum hash sections.
+    //!
+    //! Compares the small sections first. Only statistics that match them
+    //! pass through the CPID magnitude hashers in a second pass.
+    //!
+    //! \param segments The sections of the hash of a superblock.
+    //!
+    //! \return \c true if a corresponding superblock has the same hash.
+    //!
+    bool Matches(const QuorumHashSegments& segments) const
+    {
+        return MatchesSmallSections(segments)
+            && Build(Sections::MAGNITUDES).GetSegments().m_magnitudes == segments.m_magnitudes;
     }
 
 private:
+    //!
+    //! \brief Selects the sections of the quorum hash that a pass builds.
+    //!
+    enum class Sections
+    {
+        ALL,        //!< Every section.
+        SMALL,      //!< The zero count, project, and verified beacon sections.
+        MAGNITUDES, //!< The hash of the CPID magnitude segments.
+    };
+
     //!
     //! \brief Provides a compatible interface for calls to GRC::Superblock that
     //! directly hashes the data passed.
@@ -173,24 +223,23 @@ private:
         //!
         struct HasherProxy
         {
-            CHashWriter m_hasher;            //!< Hashes the supplied data.
             CHashWriter m_small_hasher;      //!< Hashes small mag segment.
             CHashWriter m_medium_hasher;     //!< Hashes medium mag segment.
             CHashWriter m_large_hasher;      //!< Hashes large mag segment.
-            uint32_t m_zero_magnitude_count; //!< Tracks zero-magnitude CPIDs.
-            bool m_zero_magnitude_hashed;    //!< Tracks when to hash the zeros.
+            QuorumHashSegments m_segments;   //!< Collects the other sections.
+            Sections m_sections;             //!< Sections to build.
 
             //!
             //! \brief Initialize a proxy object that hashes supplied superblock
             //! data to produce a quorum hash.
             //!
-            HasherProxy()
-                : m_hasher(CHashWriter(SER_GETHASH, PROTOCOL_VERSION))
-                , m_small_hasher(CHashWriter(SER_GETHASH, PROTOCOL_VERSION))
+            //! \param sections The sections of the quorum hash to build.
+            //!
+            HasherProxy(const Sections sections)
+                : m_small_hasher(CHashWriter(SER_GETHASH, PROTOCOL_VERSION))
                 , m_medium_hasher(CHashWriter(SER_GETHASH, PROTOCOL_VERSION))
                 , m_large_hasher(CHashWriter(SER_GETHASH, PROTOCOL_VERSION))
-                , m_zero_magnitude_count(0)
-                , m_zero_magnitude_hashed(false)
+                , m_sections(sections)
             {
             }
 
@@ -203,9 +252,17 @@ private:
             //!
             void Add(const Cpid cpid, const Magnitude magnitude)
             {
+                if (magnitude.Which() == Magnitude::Kind::ZERO) {
+                    m_segments.m_zero_magnitude_count++;
+                    return;
+                }
+
+                if (m_sections == Sections::SMALL) {
+                    return;
+                }
+
                 switch (magnitude.Which()) {
                     case Magnitude::Kind::ZERO:
-                        m_zero_magnitude_count++;
                         break;
 
                     case Magnitude::Kind::SMALL:
@@ -228,37 +285,26 @@ private:
             }
 
             //!
-            //! \brief Hash a project statistics entry as it would exist in the
-            //! Superblock::ProjectIndex container.
+            //! \brief Serialize a project statistics entry as it would exist in
+            //! the Superblock::ProjectIndex container.
             //!
             //! \param name  Name of the project to hash.
             //! \param stats Project statistics object to hash.
             //!
             void Add(const std::string& name, Superblock::ProjectStats stats)
             {
-                // After ScraperStatsSuperblockBuilder adds every CPID/magnitude
-                // pair to a superblock, it then starts to add projects. We need
-                // to serialize the zero-magnitude CPID count before we hash the
-                // first project:
-                //
-                if (!m_zero_magnitude_hashed) {
-                    m_hasher
-                        << (CHashWriter(SER_GETHASH, PROTOCOL_VERSION)
-                            << m_small_hasher.GetHash()
-                            << m_medium_hasher.GetHash()
-                            << m_large_hasher.GetHash())
-                            .GetHash()
-                        << VARINT(m_zero_magnitude_count);
-
-                    m_zero_magnitude_hashed = true;
+                if (m_sections == Sections::MAGNITUDES) {
+                    return;
                 }
 
-                m_hasher << name << stats;
+                std::vector<unsigned char>& projects = m_segments.m_projects;
+
+                CVectorWriter(SER_GETHASH, PROTOCOL_VERSION, projects, projects.size(), name, stats);
             }
 
             //!
-            //! \brief Hash the verified beacons vector as it would exist in the
-            //! superblock.
+            //! \brief Serialize the verified beacons vector as it would exist
+            //! in the superblock.
             //!
             //! \param verified_beacon_id_map Contains beacon IDs verified by
             //! scraper convergence. Keyed by the RIPEMD-160 hashes of beacon
@@ -266,6 +312,10 @@ private:
             //!
             void Reset(const ScraperPendingBeaconMap& verified_beacon_id_map)
             {
+                if (m_sections == Sections::MAGNITUDES) {
+                    return;
+                }
+
                 std::vector<uint160> key_ids;
                 key_ids.reserve(verified_beacon_id_map.size());
 
@@ -278,17 +328,24 @@ private:
                 //
                 std::sort(key_ids.begin(), key_ids.end());
 
-                m_hasher << key_ids;
+                CVectorWriter(SER_GETHASH, PROTOCOL_VERSION, m_segments.m_verified_beacons, 0, key_ids);
             }
 
             //!
-            //! \brief Get the final hash of the provided superblock data.
+            //! \brief Get the sections of the hash of the provided superblock
+            //! data.
             //!
-            //! \return Quorum hash of the data supplied to the proxy.
+            //! \return Quorum hash sections of the data supplied to the proxy.
             //!
-            QuorumHash GetHash()
+            QuorumHashSegments GetSegments()
             {
-                return QuorumHash(m_hasher.GetHash());
+                m_segments.m_magnitudes = (CHashWriter(SER_GETHASH, PROTOCOL_VERSION)
+                    << m_small_hasher.GetHash()
+                    << m_medium_hasher.GetHash()
+                    << m_large_hasher.GetHash())
+                    .GetHash();
+
+                return m_segments;
             }
         };
 
@@ -300,9 +357,26 @@ private:
         //!
         //! \brief Initialize a mock superblock object.
         //!
-        SuperblockMock() : m_cpids(m_proxy), m_projects(m_proxy), m_verified_beacons(m_proxy) { }
+        //! \param sections The sections of the quorum hash to build.
+        //!
+        SuperblockMock(const Sections sections)
+            : m_proxy(sections), m_cpids(m_proxy), m_projects(m_proxy), m_verified_beacons(m_proxy) { }
     };
 
+    //!
+    //! \brief Pass the wrapped statistics to a hasher for the specified
+    //! sections.
+    //!
+    SuperblockMock::HasherProxy Build(const Sections sections) const
+    {
+        SuperblockMock mock(sections);
+        ScraperStatsSuperblockBuilder<SuperblockMock> builder(mock);
+
+        builder.BuildFromStats(m_stats);
+
+        return std::move(mock.m_proxy);
+    }
+
     const ScraperStatsAndVerifiedBeacons& m_stats; //!< The stats to hash like a Superblock.
 };
 
@@ -1215,3 +1289,64 @@ std::string QuorumHash::ToString() const
 {
     return std::visit(QuorumHashToStringVisitor(), m_hash);
 }
+
+// -----------------------------------------------------------------------------
+// Class: QuorumHashSegments
+// -----------------------------------------------------------------------------
+
+QuorumHashSegments::QuorumHashSegments() : m_zero_magnitude_count(0)
+{
+}
+
+QuorumHashSegments QuorumHashSegments::FromSuperblock(const Superblock& superblock)
+{
+    QuorumHashSegments segments;
+
+    segments.m_magnitudes = superblock.m_cpids.HashSegments();
+    segments.m_zero_magnitude_count = superblock.m_cpids.Zeros();
+
+    CVectorWriter(SER_GETHASH, PROTOCOL_VERSION, segments.m_projects, 0, superblock.m_projects);
+    CVectorWriter(SER_GETHASH, PROTOCOL_VERSION, segments.m_verified_beacons, 0, superblock.m_verified_beacons);
+
+    return segments;
+}
+
+QuorumHashSegments QuorumHashSegments::FromStats(const ScraperStatsAndVerifiedBeacons& stats)
+{
+    return ScraperStatsQuorumHasher(stats).GetSegments();
+}
+
+QuorumHash QuorumHashSegments::GetHash() const
+{
+    // Matches the SER_GETHASH serialization of a superblock:
+    CHashWriter hasher(SER_GETHASH, PROTOCOL_VERSION);
+
+    hasher << m_magnitudes << VARINT(m_zero_magnitude_count);
+    hasher.write(MakeByteSpan(m_projects));
+    hasher.write(MakeByteSpan(m_verified_beacons));
+
+    return QuorumHash(hasher.GetHash());
+}
+
+bool QuorumHashSegments::Matches(const ScraperStatsAndVerifiedBeacons& stats) const
+{
+    return ScraperStatsQuorumHasher(stats).Matches(*this);
+}
+
+bool QuorumHashSegments::MatchesSmallSections(const ScraperStatsAndVerifiedBeacons& stats) const
+{
+    return ScraperStatsQuorumHasher(stats).MatchesSmallSections(*this);
+}
+
+bool QuorumHashSegments::operator==(const QuorumHashSegments& other) const
+{
+    return m_magnitudes == other.m_magnitudes
+        && m_zero_magnitude_count == other.m_zero_magnitude_count
+        && m_projects == other.m_projects
+        && m_verified_beacons == other.m_verified_beacons;
+}
+
+bool QuorumHashSegments::operator!=(const QuorumHashSegments& other) const
+{
+    return !(*this == other);
+}
@@ -15,6 +15,7 @@
 #include <iterator>
 #include <memory>
 #include <string>
+#include <vector>
 
 extern int64_t SCRAPER_CMANIFEST_RETENTION_TIME;
 extern CCriticalSection cs_ScraperGlobals;
@@ -1373,6 +1374,91 @@ private:
     mutable QuorumHash m_hash_cache;
 }; // Superblock
 
+//!
+//! \brief The sections of the quorum hash of a version 2+ superblock.
+//!
+//! A quorum hash streams a hash of the CPID magnitude segments, the number of
+//! zero-magnitude CPIDs, the project statistics, and the verified beacons. The
+//! CPID magnitudes dominate the cost of the hash. This class keeps the digest
+//! of the magnitudes and the serialized form of the small sections so that it
+//! can produce the quorum hash again without the CPIDs, and so that validation
+//! can reject scraper statistics that differ in a small section--for example,
+//! by-project convergence candidates with a different part for a project--
+//! before hashing their CPIDs.
+//!
+//! CONSENSUS: The hash produced by GetHash() matches QuorumHash::Hash() for a
+//! version 2+ superblock. Do not use this class for legacy superblocks.
+//!
+class QuorumHashSegments
+{
+public:
+    uint256 m_magnitudes;            //!< Hash of the CPID magnitude segments.
+    uint32_t m_zero_magnitude_count; //!< Number of zero-magnitude CPIDs.
+
+    //!
+    //! \brief The project statistics serialized as hashed.
+    //!
+    std::vector<unsigned char> m_projects;
+
+    //!
+    //! \brief The verified beacon IDs serialized as hashed.
+    //!
+    std::vector<unsigned char> m_verified_beacons;
+
+    //!
+    //! \brief Initialize an empty set of segments.
+    //!
+    QuorumHashSegments();
+
+    //!
+    //! \brief Get the sections of the quorum hash of a superblock.
+    //!
+    //! \param superblock A version 2+ superblock.
+    //!
+    static QuorumHashSegments FromSuperblock(const Superblock& superblock);
+
+    //!
+    //! \brief Get the sections of the quorum hash of a superblock created from
+    //! the provided scraper statistics.
+    //!
+    //! \param stats Scraper statistics from a convergence to hash.
+    //!
+    static QuorumHashSegments FromStats(const ScraperStatsAndVerifiedBeacons& stats);
+
+    //!
+    //! \brief Combine the sections into a quorum hash.
+    //!
+    //! \return A SHA256 quorum hash equal to the hash of the superblock that
+    //! the sections came from.
+    //!
+    QuorumHash GetHash() const;
+
+    //!
+    //! \brief Determine whether a superblock created from the provided scraper
+    //! statistics produces the same quorum hash.
+    //!
+    //! This compares the zero count, project, and verified beacon sections in
+    //! a first pass over the statistics that does not hash the CPIDs. Only
+    //! statistics that match those sections pass through the CPID magnitude
+    //! hashers in a second pass.
+    //!
+    //! \param stats Scraper statistics from a convergence to compare.
+    //!
+    bool Matches(const ScraperStatsAndVerifiedBeacons& stats) const;
+
+    //!
+    //! \brief Determine whether a superblock created from the provided scraper
+    //! statistics has the same zero count, project, and verified beacon
+    //! sections, without hashing the CPIDs.
+    //!
+    //! \param stats Scraper statistics from a convergence to compare.
+    //!
+    bool MatchesSmallSections(const ScraperStatsAndVerifiedBeacons& stats) const;
+
+    bool operator==(const QuorumHashSegments& other) const;
+    bool operator!=(const QuorumHashSegments& other) const;
+}; // QuorumHashSegments
+
 //!
 //! \brief A smart pointer that wraps a superblock object for shared ownership
 //! with context of its containing block.
@@ -822,18 +822,7 @@ private:
     {
         assert(m_snapshot_baseline_pindex != nullptr);
 
-        for (const CBlockIndex* pindex = m_snapshot_baseline_pindex;
-            pindex;
-            pindex = pindex->pprev)
-        {
-            if (!pindex->IsSuperblock()) {
-                continue;
-            }
-
-            return pindex;
-        }
-
-        return nullptr;
+        return Quorum::FindSuperblockIndex(m_snapshot_baseline_pindex->nHeight);
     }
 
     //!
@@ -845,7 +834,7 @@ private:
     {
         const CBlockIndex* pindex = FindBaselineSuperblockHeight();
 
-        return SuperblockPtr::ReadFromDisk(pindex);
+        return Quorum::ReadSuperblock(pindex);
     }
 
     //!
@@ -1250,45 +1239,42 @@ CAmount Tally::GetNewbieSuperblockAccrualCorrection(const Cpid& cpid, const Supe
         pindex_high = pindex_high->pprev;
     }
 
-    // Set pindex to the block before: (pindex_high->pprev).
-    const CBlockIndex* pindex = pindex_high->pprev;
+    // Step back through the superblocks before the current superblock:
+    const CBlockIndex* pindex = Quorum::FindSuperblockIndex(pindex_high->nHeight - 1);
 
     SuperblockPtr superblock;
     unsigned int period_num = 0;
 
-    while (pindex->nHeight >= pindex_baseline->nHeight)
+    while (pindex && pindex->nHeight >= pindex_baseline->nHeight)
     {
-        if (pindex->IsSuperblock())
-        {
-            superblock = SuperblockPtr::ReadFromDisk(pindex);
-
-            const GRC::Magnitude magnitude = superblock->m_cpids.MagnitudeOf(cpid);
-
-            // Stop the accrual when we get to a superblock that is before the beacon advertisement.
-            if (pindex->nTime < beacon_ptr->m_timestamp) break;
-
-            CAmount period = tally_accrual_period(pindex->nTime, pindex_high->nTime, magnitude);
-
-            LogPrint(BCLog::LogFlags::ACCRUAL, "INFO %s: period_num = %u, "
-                     "low height = %i, high height = %u, magnitude at low height SB = %f, "
-                     "low time = %u, high time = %u, "
-                     "accrual for period = %" PRId64 ", accrual = %" PRId64 ".",
-                     __func__,
-                     period_num,
-                     pindex->nHeight,
-                     pindex_high->nHeight,
-                     magnitude.Floating(),
-                     pindex->nTime,
-                     pindex_high->nTime,
-                     period,
-                     accrual);
-
-            // We are going backwards through the chain.
-            pindex_high = pindex;
-            ++period_num;
-        }
-
-        pindex = pindex->pprev;
+        superblock = Quorum::ReadSuperblock(pindex);
+
+        const GRC::Magnitude magnitude = superblock->m_cpids.MagnitudeOf(cpid);
+
+        // Stop the accrual when we get to a superblock that is before the beacon advertisement.
+        if (pindex->nTime < beacon_ptr->m_timestamp) break;
+
+        CAmount period = tally_accrual_period(pindex->nTime, pindex_high->nTime, magnitude);
+
+        LogPrint(BCLog::LogFlags::ACCRUAL, "INFO %s: period_num = %u, "
+                 "low height = %i, high height = %u, magnitude at low height SB = %f, "
+                 "low time = %u, high time = %u, "
+                 "accrual for period = %" PRId64 ", accrual = %" PRId64 ".",
+                 __func__,
+                 period_num,
+                 pindex->nHeight,
+                 pindex_high->nHeight,
+                 magnitude.Floating(),
+                 pindex->nTime,
+                 pindex_high->nTime,
+                 period,
+                 accrual);
+
+        // We are going backwards through the chain.
+        pindex_high = pindex;
+        ++period_num;
+
+        pindex = Quorum::FindSuperblockIndex(pindex->nHeight - 1);
     }
 
     return accrual;
@@ -8,6 +8,7 @@
 #include "gridcoin/claim.h"
 #include "gridcoin/researcher.h"
 #include "gridcoin/contract/contract.h"
+#include "gridcoin/quorum.h"
 #include "gridcoin/staking/difficulty.h"
 #include "gridcoin/voting/payloads.h"
 #include "gridcoin/voting/registry.h"
@@ -559,12 +560,23 @@ std::optional<CAmount> PollReference::GetActiveVoteWeight(const PollResultOption
     // Rewind from pindex_start to find last superblock before start of the poll to pick up first pool magnitudes
     bool superblock_well_formed = false;
 
-    for (CBlockIndex* pindex = pindex_start; pindex; pindex = pindex->pprev)
+    // Apparently the superblock flags in pindex are broken for superblocks earlier than 1034768 on mainnet and
+    // earlier than 196562 on testnet.
+    // TODO: Repair the index flags loaded in LevelDB. (This will require a special correction routine at startup.)
+    const int reliable_flag_height = fTestNet ? 196562 : 1034768;
+    const CBlockIndex* pindex_rewind = pindex_start;
+
+    // Where the flags are reliable, skip straight to the last superblock at or before the poll start instead of
+    // checking each block on the way:
+    if (const CBlockIndex* pindex_superblock = Quorum::FindSuperblockIndex(pindex_start->nHeight)) {
+        if (pindex_superblock->nHeight >= reliable_flag_height) {
+            pindex_rewind = pindex_superblock;
+        }
+    }
+
+    for (const CBlockIndex* pindex = pindex_rewind; pindex; pindex = pindex->pprev)
     {
-        // Apparently the superblock flags in pindex are broken for superblocks earlier than 1034768 on mainnet and
-        // earlier than 196562 on testnet.
-        // TODO: Repair the index flags loaded in LevelDB. (This will require a special correction routine at startup.)
-        if ((fTestNet && pindex->nHeight < 196562) || (!fTestNet && pindex->nHeight < 1034768) || pindex->IsSuperblock()) {
+        if (pindex->nHeight < reliable_flag_height || pindex->IsSuperblock()) {
 
             const GRC::ClaimOption claim = GetClaimByIndex(pindex);
 
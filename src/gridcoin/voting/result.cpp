@@ -4,6 +4,7 @@
 
 #include "main.h"
 #include "gridcoin/beacon.h"
+#include "gridcoin/contract/cache.h"
 #include "gridcoin/quorum.h"
 #include "gridcoin/superblock.h"
 #include "gridcoin/voting/registry.h"
@@ -11,8 +12,10 @@
 #include "gridcoin/voting/poll.h"
 #include "gridcoin/voting/vote.h"
 #include "gridcoin/researcher.h"
+#include "node/blockstorage.h"
 #include "txdb.h"
 #include "util/reverse_iterator.h"
+#include "util/trace.h"
 #include "wallet/wallet.h"
 #include "init.h"
 
@@ -236,19 +239,11 @@ private:
             throw InvalidVoteError();
         }
 
-        CAutoFile file(OpenBlockFile(tx_index.pos), SER_DISK, CLIENT_VERSION);
-
-        if (file.IsNull()) {
-            error("%s: OpenBlockFile failed", __func__);
-            throw InvalidVoteError();
-        }
-
         CBlockHeader header;
+        CTransaction tx;
 
-        try {
-            file >> header;
-        } catch (...) {
-            error("%s: deserialize or I/O error for block header", __func__);
+        if (!ReadTxFromDisk(tx, tx_index.pos, &header)) {
+            error("%s: failed to read tx", __func__);
             throw InvalidVoteError();
         }
 
@@ -262,21 +257,9 @@ private:
             return Magnitude::Zero();
         }
 
-        if (fseek(file.Get(), tx_index.pos.nTxPos, SEEK_SET) != 0) {
-            error("%s: tx fseek failed", __func__);
-            throw InvalidVoteError();
-        }
+        const auto contracts = GetContractCache().GetContracts(claim.m_beacon_txid, tx);
 
-        CTransaction tx;
-
-        try {
-            file >> tx;
-        } catch (...) {
-            error("%s: deserialize or I/O error for tx", __func__);
-            throw InvalidVoteError();
-        }
-
-        for (const auto& contract : tx.GetContracts()) {
+        for (const auto& contract : *contracts) {
             if (contract.m_type != ContractType::BEACON) {
                 continue;
             }
@@ -372,19 +355,11 @@ private:
             return 0;
         }
 
-        CAutoFile file(OpenBlockFile(tx_index.pos), SER_DISK, CLIENT_VERSION);
-
-        if (file.IsNull()) {
-            error("%s: OpenBlockFile failed", __func__);
-            throw InvalidVoteError();
-        }
-
         CBlockHeader header;
+        CTransaction tx;
 
-        try {
-            file >> header;
-        } catch (...) {
-            error("%s: deserialize or I/O error for block header", __func__);
+        if (!ReadTxFromDisk(tx, tx_index.pos, &header)) {
+            error("%s: failed to read tx", __func__);
             throw InvalidVoteError();
         }
 
@@ -398,20 +373,6 @@ private:
             return 0;
         }
 
-        if (fseek(file.Get(), tx_index.pos.nTxPos, SEEK_SET) != 0) {
-            error("%s: tx fseek failed", __func__);
-            throw InvalidVoteError();
-        }
-
-        CTransaction tx;
-
-        try {
-            file >> tx;
-        } catch (...) {
-            error("%s: deserialize or I/O error for tx", __func__);
-            throw InvalidVoteError();
-        }
-
         if (txo.n >= tx.vout.size()) {
             LogPrint(LogFlags::VOTE, "%s: txo out of range", __func__);
             throw InvalidVoteError();
@@ -504,17 +465,8 @@ private:
             const TxoFrame frame = txo_queue.front();
             txo_queue.pop();
 
-            CAutoFile file(OpenBlockFile(frame.m_pos), SER_DISK, CLIENT_VERSION);
-
-            if (file.IsNull()) {
-                error("%s: OpenBlockFile failed", __func__);
-                throw InvalidVoteError();
-            }
-
-            try {
-                file >> header;
-            } catch (...) {
-                error("%s: deserialize or I/O error for block header", __func__);
+            if (!ReadTxFromDisk(tx, frame.m_pos, &header)) {
+                error("%s: failed to read tx", __func__);
                 throw InvalidVoteError();
             }
 
@@ -522,18 +474,6 @@ private:
                 continue; // Txo spent after the poll finished is irrelevant
             }
 
-            if (fseek(file.Get(), frame.m_pos.nTxPos, SEEK_SET) != 0) {
-                error("%s: tx fseek failed", __func__);
-                throw InvalidVoteError();
-            }
-
-            try {
-                file >> tx;
-            } catch (...) {
-                error("%s: deserialize or I/O error for tx", __func__);
-                throw InvalidVoteError();
-            }
-
             // If we get here, the transaction spends the output referenced
             // by the vote claim within the voting window of the poll. When
             // we can determine that the transaction spends the output as a
@@ -622,15 +562,6 @@ private:
 
         return pindex && pindex->IsInMainChain();
     }
-
-    //!
-    //! \brief Get a file handle to the block file that contains the specified
-    //! transaction position.
-    //!
-    static FILE* OpenBlockFile(const CDiskTxPos& pos)
-    {
-        return ::OpenBlockFile(pos.nFile, pos.nBlockPos, "rb");
-    }
 }; // VoteResolver
 
 //!
@@ -894,7 +825,9 @@ private:
             throw InvalidVoteError();
         }
 
-        for (auto& contract : tx.GetContracts()) {
+        const auto contracts = GetContractCache().GetContracts(txid, tx);
+
+        for (const auto& contract : *contracts) {
             if (contract.m_type != ContractType::VOTE) {
                 continue;
             }
@@ -1093,19 +1026,9 @@ SuperblockPtr ResolveSuperblockForPoll(const Poll& poll)
         return superblock;
     }
 
-    const CBlockIndex* pindex = pindexBest;
-
-    // Seek past the current superblock:
-    for (; pindex && pindex->nHeight >= superblock.m_height; pindex = pindex->pprev);
-
     // Find the superblock active at the end of the poll:
-    for (; pindex; pindex = pindex->pprev) {
-        if (!pindex->IsSuperblock() || poll.Expired(pindex->nTime)) {
-            continue;
-        }
-
-        superblock = SuperblockPtr::ReadFromDisk(pindex);
-        break;
+    if (const CBlockIndex* pindex = Quorum::FindSuperblockIndexByTime(poll.Expiration())) {
+        superblock = Quorum::ReadSuperblock(pindex);
     }
 
     return superblock;
@@ -1176,6 +1099,8 @@ PollResult::PollResult(Poll poll)
 
 PollResultOption PollResult::BuildFor(const PollReference& poll_ref)
 {
+    TRACE_SPAN("PollResult::BuildFor");
+
     g_timer.GetTimes(std::string{"Begin "} + std::string{__func__}, "buildPollTable");
 
     if (PollOption poll = poll_ref.TryReadFromDisk()) {
@@ -0,0 +1,719 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "base58.h"
+#include "chainparams.h"
+#include "hash.h"
+#include "index/addressindex.h"
+#include "index/backfill.h"
+#include "main.h"
+#include "node/blockstorage.h"
+#include "txdb.h"
+#include "util.h"
+#include "util/strencodings.h"
+
+#include <map>
+#include <set>
+
+namespace {
+//! Key type of the address history records.
+const std::string HISTORY_KEY_TYPE = "addrhist";
+
+//! Key type of the unspent output records.
+const std::string UNSPENT_KEY_TYPE = "addrutxo";
+
+//! Key type of the spent-by records.
+const std::string SPENT_KEY_TYPE = "addrspent";
+
+//! Key of the height from which the backfill resumes. Exists while the node
+//! maintains the index.
+const std::string PROGRESS_KEY = "addressindexprogress";
+
+//! Key of the marker that indicates a completed backfill.
+const std::string COMPLETE_KEY = "addressindexcomplete";
+
+//!
+//! \brief Identifies a history record. Serializes the numbers in big-endian
+//! order so that the records of an address sort by position in the chain.
+//!
+class HistoryKey
+{
+public:
+    AddressKey m_address;
+    uint32_t m_height = 0;
+    uint32_t m_tx_position = 0;
+    uint8_t m_spending = 0;
+    uint32_t m_index = 0;
+
+    HistoryKey() = default;
+
+    HistoryKey(
+        const AddressKey& address,
+        const int height,
+        const uint32_t tx_position,
+        const bool spending,
+        const uint32_t index)
+        : m_address(address)
+        , m_height(height)
+        , m_tx_position(tx_position)
+        , m_spending(spending)
+        , m_index(index)
+    {
+    }
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ::Serialize(s, m_address);
+        ser_writedata32be(s, m_height);
+        ser_writedata32be(s, m_tx_position);
+        ::Serialize(s, m_spending);
+        ser_writedata32be(s, m_index);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        ::Unserialize(s, m_address);
+        m_height = ser_readdata32be(s);
+        m_tx_position = ser_readdata32be(s);
+        ::Unserialize(s, m_spending);
+        m_index = ser_readdata32be(s);
+    }
+};
+
+//!
+//! \brief Value of a history record. Only inputs store the spent output.
+//!
+class HistoryValue
+{
+public:
+    uint256 m_txid;
+    CAmount m_amount = 0;
+    COutPoint m_prevout;
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ::Serialize(s, m_txid);
+        ::Serialize(s, m_amount);
+
+        if (!m_prevout.IsNull()) {
+            ::Serialize(s, m_prevout);
+        }
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        ::Unserialize(s, m_txid);
+        ::Unserialize(s, m_amount);
+
+        if (!s.empty()) {
+            ::Unserialize(s, m_prevout);
+        }
+    }
+};
+
+//!
+//! \brief Identifies an unspent output record.
+//!
+class UnspentKey
+{
+public:
+    AddressKey m_address;
+    COutPoint m_outpoint;
+
+    UnspentKey() = default;
+    UnspentKey(const AddressKey& address, const COutPoint& outpoint) : m_address(address), m_outpoint(outpoint)
+    {
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action)
+    {
+        READWRITE(m_address);
+        READWRITE(m_outpoint);
+    }
+};
+
+//!
+//! \brief Value of an unspent output record.
+//!
+class UnspentValue
+{
+public:
+    CAmount m_amount = 0;
+    int32_t m_height = 0;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action)
+    {
+        READWRITE(m_amount);
+        READWRITE(m_height);
+    }
+};
+
+using HistoryRecordKey = std::pair<std::string, HistoryKey>;
+using UnspentRecordKey = std::pair<std::string, UnspentKey>;
+using SpentRecordKey = std::pair<std::string, COutPoint>;
+
+//!
+//! \brief The index records produced by one block.
+//!
+struct BlockRecords
+{
+    std::vector<std::pair<HistoryKey, HistoryValue>> m_history;
+    std::vector<std::pair<UnspentKey, UnspentValue>> m_unspent;
+    std::vector<std::pair<COutPoint, SpentByEntry>> m_spent;
+};
+
+//!
+//! \brief Produce the index records of a block.
+//!
+//! \param spent_outputs Outputs spent by the inputs of the block, in the order
+//!                      of the transactions and their inputs.
+//!
+BlockRecords BuildRecords(const CBlock& block, const int height, const std::vector<CTxOut>& spent_outputs)
+{
+    BlockRecords records;
+    size_t next_spent_output = 0;
+
+    for (uint32_t tx_position = 0; tx_position < block.vtx.size(); ++tx_position) {
+        const CTransaction& tx = block.vtx[tx_position];
+        const uint256 txid = tx.GetHash();
+
+        if (!tx.IsCoinBase()) {
+            for (uint32_t i = 0; i < tx.vin.size(); ++i) {
+                const COutPoint& prevout = tx.vin[i].prevout;
+                const CTxOut& spent_output = spent_outputs[next_spent_output++];
+                const AddressKey address = AddressKey::FromScript(spent_output.scriptPubKey);
+
+                if (address.IsNull()) continue;
+
+                HistoryValue history;
+                history.m_txid = txid;
+                history.m_amount = -spent_output.nValue;
+                history.m_prevout = prevout;
+
+                records.m_history.emplace_back(HistoryKey(address, height, tx_position, true, i), history);
+
+                SpentByEntry spent;
+                spent.m_txid = txid;
+                spent.m_input = i;
+                spent.m_height = height;
+                spent.m_address = address;
+                spent.m_amount = spent_output.nValue;
+
+                records.m_spent.emplace_back(prevout, spent);
+            }
+        }
+
+        for (uint32_t n = 0; n < tx.vout.size(); ++n) {
+            const AddressKey address = AddressKey::FromScript(tx.vout[n].scriptPubKey);
+
+            if (address.IsNull()) continue;
+
+            HistoryValue history;
+            history.m_txid = txid;
+            history.m_amount = tx.vout[n].nValue;
+
+            records.m_history.emplace_back(HistoryKey(address, height, tx_position, false, n), history);
+
+            UnspentValue unspent;
+            unspent.m_amount = tx.vout[n].nValue;
+            unspent.m_height = height;
+
+            records.m_unspent.emplace_back(UnspentKey(address, COutPoint(txid, n)), unspent);
+        }
+    }
+
+    return records;
+}
+
+//!
+//! \brief Read the outputs spent by the inputs of a block.
+//!
+bool ReadSpentOutputs(CTxDB& txdb, const CBlock& block, std::vector<CTxOut>& spent_outputs)
+{
+    std::map<uint256, const CTransaction*> block_txs;
+
+    for (const auto& tx : block.vtx) {
+        block_txs.emplace(tx.GetHash(), &tx);
+    }
+
+    for (const auto& tx : block.vtx) {
+        if (tx.IsCoinBase()) continue;
+
+        for (const auto& txin : tx.vin) {
+            const auto iter = block_txs.find(txin.prevout.hash);
+            CTransaction disk_tx;
+            const CTransaction* prev_tx = &disk_tx;
+
+            if (iter != block_txs.end()) {
+                prev_tx = iter->second;
+            } else if (!txdb.ReadDiskTx(txin.prevout.hash, disk_tx)) {
+                return error("%s: failed to read tx %s", __func__, txin.prevout.hash.ToString());
+            }
+
+            if (txin.prevout.n >= prev_tx->vout.size()) {
+                return error("%s: prevout out of range in tx %s", __func__, tx.GetHash().ToString());
+            }
+
+            spent_outputs.push_back(prev_tx->vout[txin.prevout.n]);
+        }
+    }
+
+    return true;
+}
+
+//!
+//! \brief Find the height of the main chain block that contains a transaction.
+//!
+//! \return -1 if the transaction is not in the main chain.
+//!
+int GetTxHeight(CTxDB& txdb, const uint256& txid) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    CTxIndex txindex;
+    CBlock header;
+
+    if (!txdb.ReadTxIndex(txid, txindex)
+        || !ReadBlockFromDisk(header, txindex.pos.nFile, txindex.pos.nBlockPos, Params().GetConsensus(), false))
+    {
+        return -1;
+    }
+
+    const auto iter = mapBlockIndex.find(header.GetHash());
+
+    if (iter == mapBlockIndex.end() || !iter->second->IsInMainChain()) {
+        return -1;
+    }
+
+    return iter->second->nHeight;
+}
+} // Anonymous namespace
+
+// -----------------------------------------------------------------------------
+// Class: AddressKey
+// -----------------------------------------------------------------------------
+
+AddressKey AddressKey::FromScript(const CScript& script)
+{
+    if (script.empty() || script.IsUnspendable()) {
+        return AddressKey();
+    }
+
+    CTxDestination dest;
+
+    if (ExtractDestination(script, dest)) {
+        if (const CKeyID* key_id = std::get_if<CKeyID>(&dest)) {
+            return AddressKey(Type::PUBKEY_HASH, uint160(*key_id));
+        }
+
+        if (const CScriptID* script_id = std::get_if<CScriptID>(&dest)) {
+            return AddressKey(Type::SCRIPT_HASH, uint160(std::vector<unsigned char>(*script_id)));
+        }
+    }
+
+    return AddressKey(Type::SCRIPT, Hash160(script));
+}
+
+AddressKey AddressKey::Parse(const std::string& address_or_script)
+{
+    const CBitcoinAddress address(address_or_script);
+
+    if (address.IsValid()) {
+        const CTxDestination dest = address.Get();
+
+        if (const CKeyID* key_id = std::get_if<CKeyID>(&dest)) {
+            return AddressKey(Type::PUBKEY_HASH, uint160(*key_id));
+        }
+
+        if (const CScriptID* script_id = std::get_if<CScriptID>(&dest)) {
+            return AddressKey(Type::SCRIPT_HASH, uint160(std::vector<unsigned char>(*script_id)));
+        }
+    }
+
+    if (!address_or_script.empty() && IsHex(address_or_script)) {
+        const std::vector<unsigned char> data = ParseHex(address_or_script);
+
+        return FromScript(CScript(data.begin(), data.end()));
+    }
+
+    return AddressKey();
+}
+
+std::string AddressKey::ToString() const
+{
+    switch (m_type) {
+        case Type::PUBKEY_HASH:
+            return CBitcoinAddress(CTxDestination(CKeyID(m_hash))).ToString();
+        case Type::SCRIPT_HASH:
+            return CBitcoinAddress(CTxDestination(CScriptID(m_hash))).ToString();
+        case Type::SCRIPT:
+            return m_hash.GetHex();
+        case Type::NONE:
+        case Type::OUT_OF_BOUND:
+            break;
+    }
+
+    return std::string();
+}
+
+// -----------------------------------------------------------------------------
+// Class: AddressIndex
+// -----------------------------------------------------------------------------
+
+void AddressIndex::Initialize(const bool enabled)
+{
+    CTxDB txdb;
+    std::string progress_key = PROGRESS_KEY;
+    std::string complete_key = COMPLETE_KEY;
+    int progress = 0;
+    bool complete = false;
+
+    const bool exists = txdb.ReadGenericSerializable(progress_key, progress);
+    txdb.ReadGenericSerializable(complete_key, complete);
+
+    if (!enabled) {
+        if (exists) {
+            LogPrintf("INFO: %s: address index disabled. Deleting it...", __func__);
+
+            std::string history_type = HISTORY_KEY_TYPE;
+            std::string unspent_type = UNSPENT_KEY_TYPE;
+            std::string spent_type = SPENT_KEY_TYPE;
+            HistoryKey history_start;
+            UnspentKey unspent_start;
+            COutPoint spent_start(uint256(), 0);
+
+            txdb.EraseGenericSerializablesByKeyType(history_type, history_start);
+            txdb.EraseGenericSerializablesByKeyType(unspent_type, unspent_start);
+            txdb.EraseGenericSerializablesByKeyType(spent_type, spent_start);
+            txdb.EraseGenericSerializable(complete_key);
+            txdb.EraseGenericSerializable(progress_key);
+        }
+
+        m_enabled = false;
+        m_complete = false;
+
+        return;
+    }
+
+    if (!exists) {
+        txdb.WriteGenericSerializable(progress_key, progress);
+    }
+
+    m_enabled = true;
+    m_complete = complete;
+
+    if (complete) {
+        LogPrintf("INFO: %s: address index enabled (complete).", __func__);
+    } else {
+        LogPrintf("INFO: %s: address index enabled (requires backfill from height %d).", __func__, progress);
+    }
+}
+
+bool AddressIndex::WriteBlock(
+    CTxDB& txdb,
+    const CBlockIndex* const pindex,
+    const CBlock& block,
+    const std::vector<CTxOut>& spent_outputs) const
+{
+    const BlockRecords records = BuildRecords(block, pindex->nHeight, spent_outputs);
+    bool result = true;
+
+    for (const auto& [key, value] : records.m_history) {
+        result &= txdb.WriteGenericSerializable(HistoryRecordKey(HISTORY_KEY_TYPE, key), value);
+    }
+
+    for (const auto& [key, value] : records.m_unspent) {
+        result &= txdb.WriteGenericSerializable(UnspentRecordKey(UNSPENT_KEY_TYPE, key), value);
+    }
+
+    // Erase the unspent records after writing those of the block because an
+    // input may spend an output of an earlier transaction in the same block:
+    for (const auto& [prevout, spent] : records.m_spent) {
+        result &= txdb.WriteGenericSerializable(SpentRecordKey(SPENT_KEY_TYPE, prevout), spent);
+        result &= txdb.EraseGenericSerializable(UnspentRecordKey(UNSPENT_KEY_TYPE, UnspentKey(spent.m_address, prevout)));
+    }
+
+    return result;
+}
+
+bool AddressIndex::EraseBlock(CTxDB& txdb, const CBlockIndex* const pindex, const CBlock& block) const
+{
+    AssertLockHeld(cs_main);
+
+    std::set<uint256> block_txids;
+    bool result = true;
+
+    for (const auto& tx : block.vtx) {
+        block_txids.insert(tx.GetHash());
+    }
+
+    for (uint32_t tx_position = 0; tx_position < block.vtx.size(); ++tx_position) {
+        const CTransaction& tx = block.vtx[tx_position];
+        const uint256 txid = tx.GetHash();
+
+        for (uint32_t n = 0; n < tx.vout.size(); ++n) {
+            const AddressKey address = AddressKey::FromScript(tx.vout[n].scriptPubKey);
+
+            if (address.IsNull()) continue;
+
+            HistoryRecordKey history_key(HISTORY_KEY_TYPE, HistoryKey(address, pindex->nHeight, tx_position, false, n));
+            UnspentRecordKey unspent_key(UNSPENT_KEY_TYPE, UnspentKey(address, COutPoint(txid, n)));
+
+            result &= txdb.EraseGenericSerializable(history_key);
+            result &= txdb.EraseGenericSerializable(unspent_key);
+        }
+
+        if (tx.IsCoinBase()) continue;
+
+        for (uint32_t i = 0; i < tx.vin.size(); ++i) {
+            const COutPoint& prevout = tx.vin[i].prevout;
+            SpentRecordKey spent_key(SPENT_KEY_TYPE, prevout);
+            SpentByEntry spent;
+
+            if (txdb.ReadGenericSerializable(spent_key, spent) && spent.m_txid == txid) {
+                HistoryRecordKey history_key(
+                    HISTORY_KEY_TYPE,
+                    HistoryKey(spent.m_address, pindex->nHeight, tx_position, true, i));
+
+                result &= txdb.EraseGenericSerializable(history_key);
+                result &= txdb.EraseGenericSerializable(spent_key);
+            } else if (m_complete) {
+                // The complete index has a spent-by record for each indexed
+                // output, so the input spends an output that it skips.
+                continue;
+            } else {
+                // The backfill did not reach the spending block yet, but it
+                // may have skipped the unspent record of the output:
+                CTransaction prev_tx;
+
+                if (!txdb.ReadDiskTx(prevout.hash, prev_tx) || prevout.n >= prev_tx.vout.size()) {
+                    return error("%s: failed to read tx %s", __func__, prevout.hash.ToString());
+                }
+
+                spent.m_address = AddressKey::FromScript(prev_tx.vout[prevout.n].scriptPubKey);
+                spent.m_amount = prev_tx.vout[prevout.n].nValue;
+
+                if (spent.m_address.IsNull()) continue;
+            }
+
+            // The output of a transaction in the same block disappears with it:
+            if (block_txids.count(prevout.hash)) continue;
+
+            UnspentValue unspent;
+            unspent.m_amount = spent.m_amount;
+            unspent.m_height = GetTxHeight(txdb, prevout.hash);
+
+            if (unspent.m_height < 0) {
+                return error("%s: failed to find block of tx %s", __func__, prevout.hash.ToString());
+            }
+
+            UnspentRecordKey unspent_key(UNSPENT_KEY_TYPE, UnspentKey(spent.m_address, prevout));
+
+            result &= txdb.WriteGenericSerializable(unspent_key, unspent);
+        }
+    }
+
+    return result;
+}
+
+void AddressIndex::Backfill()
+{
+    if (!m_enabled || m_complete) {
+        return;
+    }
+
+    int start_height = 0;
+
+    {
+        CTxDB txdb("r");
+        std::string key = PROGRESS_KEY;
+        txdb.ReadGenericSerializable(key, start_height);
+    }
+
+    LogPrintf("INFO: %s: building address index from height %d...", __func__, start_height);
+
+    const int64_t start_time = GetTimeMillis();
+
+    BackfillJob<BlockRecords> job;
+    job.m_thread_name = "grc-addrindex";
+    job.m_start_height = start_height;
+
+    job.m_scan = [](CTxDB& txdb, const CBlockIndex* pindex, std::optional<BlockRecords>& record) {
+        CBlock block;
+        std::vector<CTxOut> spent_outputs;
+
+        if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+            return error("%s: failed to read block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+
+        if (!ReadSpentOutputs(txdb, block, spent_outputs)) {
+            return false;
+        }
+
+        record = BuildRecords(block, pindex->nHeight, spent_outputs);
+
+        return true;
+    };
+
+    // Chunks complete out of order, so an output may be spent by a block that
+    // another worker did not commit yet. Write the unspent records only for
+    // outputs that the transaction index reports unspent at commit time:
+    job.m_commit = [](CTxDB& txdb, const CBlockIndex* pindex, const BlockRecords& records) {
+        bool result = true;
+
+        for (const auto& [key, value] : records.m_history) {
+            result &= txdb.WriteGenericSerializable(HistoryRecordKey(HISTORY_KEY_TYPE, key), value);
+        }
+
+        for (const auto& [prevout, spent] : records.m_spent) {
+            result &= txdb.WriteGenericSerializable(SpentRecordKey(SPENT_KEY_TYPE, prevout), spent);
+        }
+
+        uint256 txid;
+        CTxIndex txindex;
+
+        for (const auto& [key, value] : records.m_unspent) {
+            if (key.m_outpoint.hash != txid) {
+                txid = key.m_outpoint.hash;
+
+                if (!txdb.ReadTxIndex(txid, txindex)) {
+                    return error("%s: failed to read tx index of %s", __func__, txid.ToString());
+                }
+            }
+
+            if (key.m_outpoint.n < txindex.vSpent.size() && txindex.vSpent[key.m_outpoint.n].IsNull()) {
+                result &= txdb.WriteGenericSerializable(UnspentRecordKey(UNSPENT_KEY_TYPE, key), value);
+            }
+        }
+
+        return result;
+    };
+
+    job.m_checkpoint = [](CTxDB& txdb, const int height) {
+        std::string key = PROGRESS_KEY;
+
+        return txdb.WriteGenericSerializable(key, height);
+    };
+
+    const std::optional<size_t> written = BackfillMainChain(job);
+
+    if (!written) {
+        LogPrintf("INFO: %s: address index backfill stopped. It resumes at the next start.", __func__);
+        return;
+    }
+
+    CTxDB txdb;
+    std::string key = COMPLETE_KEY;
+
+    if (!txdb.WriteGenericSerializable(key, true)) {
+        error("%s: failed to store address index marker", __func__);
+        return;
+    }
+
+    m_complete = true;
+
+    LogPrintf("INFO: %s: built address index for %u blocks in %" PRId64 " ms.",
+              __func__, *written, GetTimeMillis() - start_time);
+}
+
+void AddressIndex::ReadHistory(
+    CTxDB& txdb,
+    const AddressKey& address,
+    const int start_height,
+    const std::function<bool(const AddressHistoryEntry&)>& visitor) const
+{
+    const HistoryRecordKey start_key(HISTORY_KEY_TYPE, HistoryKey(address, std::max(start_height, 0), 0, false, 0));
+
+    txdb.IterateGenericSerializables(start_key, [&](CDataStream& ssKey, CDataStream& ssValue) {
+        // Check the key type before reading the rest of a key of another type:
+        std::string key_type;
+        ssKey >> key_type;
+
+        if (key_type != HISTORY_KEY_TYPE) {
+            return false;
+        }
+
+        HistoryKey key;
+        ssKey >> key;
+
+        if (key.m_address != address) {
+            return false;
+        }
+
+        HistoryValue value;
+        ssValue >> value;
+
+        AddressHistoryEntry entry;
+        entry.m_height = key.m_height;
+        entry.m_tx_position = key.m_tx_position;
+        entry.m_spending = key.m_spending;
+        entry.m_index = key.m_index;
+        entry.m_txid = value.m_txid;
+        entry.m_amount = value.m_amount;
+        entry.m_prevout = value.m_prevout;
+
+        return visitor(entry);
+    });
+}
+
+void AddressIndex::ReadUnspent(
+    CTxDB& txdb,
+    const AddressKey& address,
+    const std::function<bool(const AddressUnspentEntry&)>& visitor) const
+{
+    const UnspentRecordKey start_key(UNSPENT_KEY_TYPE, UnspentKey(address, COutPoint(uint256(), 0)));
+
+    txdb.IterateGenericSerializables(start_key, [&](CDataStream& ssKey, CDataStream& ssValue) {
+        std::string key_type;
+        ssKey >> key_type;
+
+        if (key_type != UNSPENT_KEY_TYPE) {
+            return false;
+        }
+
+        UnspentKey key;
+        ssKey >> key;
+
+        if (key.m_address != address) {
+            return false;
+        }
+
+        UnspentValue value;
+        ssValue >> value;
+
+        AddressUnspentEntry entry;
+        entry.m_outpoint = key.m_outpoint;
+        entry.m_amount = value.m_amount;
+        entry.m_height = value.m_height;
+
+        return visitor(entry);
+    });
+}
+
+std::optional<SpentByEntry> AddressIndex::ReadSpentBy(CTxDB& txdb, const COutPoint& outpoint) const
+{
+    SpentRecordKey key(SPENT_KEY_TYPE, outpoint);
+    SpentByEntry spent;
+
+    if (!txdb.ReadGenericSerializable(key, spent)) {
+        return std::nullopt;
+    }
+
+    return spent;
+}
+
+AddressIndex& GetAddressIndex()
+{
+    static AddressIndex index;
+
+    return index;
+}
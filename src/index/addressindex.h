@@ -0,0 +1,274 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_ADDRESSINDEX_H
+#define BITCOIN_INDEX_ADDRESSINDEX_H
+
+#include "amount.h"
+#include "gridcoin/support/enumbytes.h"
+#include "primitives/transaction.h"
+#include "script.h"
+#include "serialize.h"
+#include "uint256.h"
+
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+class CBlock;
+class CBlockIndex;
+class CTxDB;
+
+//! Default for -addressindex.
+static constexpr bool DEFAULT_ADDRESSINDEX = false;
+
+//!
+//! \brief Identifies the owner of transaction outputs in the address index.
+//!
+//! Outputs that pay to a public key or key hash share the key ID, so a P2PK
+//! coinstake output and a P2PKH payment appear under the same address. Other
+//! spendable scripts without an address, like bare multisig, appear under the
+//! hash of the script.
+//!
+class AddressKey
+{
+public:
+    enum class Type : uint8_t
+    {
+        NONE = 0,        //!< Output not indexed (empty or unspendable script).
+        PUBKEY_HASH = 1, //!< CKeyID of a P2PKH or P2PK output.
+        SCRIPT_HASH = 2, //!< CScriptID of a P2SH output.
+        SCRIPT = 3,      //!< Hash160 of any other script.
+        OUT_OF_BOUND,
+    };
+
+    Type m_type = Type::NONE;
+    uint160 m_hash;
+
+    AddressKey() = default;
+    AddressKey(const Type type, const uint160& hash) : m_type(type), m_hash(hash)
+    {
+    }
+
+    //!
+    //! \brief Get the key of the owner of an output script.
+    //!
+    //! \return A key of type \c NONE if the index skips the script.
+    //!
+    static AddressKey FromScript(const CScript& script);
+
+    //!
+    //! \brief Parse an address or a hex-encoded output script.
+    //!
+    //! \return A key of type \c NONE if the string is neither.
+    //!
+    static AddressKey Parse(const std::string& address_or_script);
+
+    bool IsNull() const { return m_type == Type::NONE; }
+
+    //!
+    //! \brief Get the address of the key, or the hex script hash for keys of
+    //! type \c SCRIPT.
+    //!
+    std::string ToString() const;
+
+    bool operator==(const AddressKey& other) const
+    {
+        return m_type == other.m_type && m_hash == other.m_hash;
+    }
+
+    bool operator!=(const AddressKey& other) const
+    {
+        return !(*this == other);
+    }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action)
+    {
+        READWRITE(Using<GRC::EnumByte<Type>::Formatter>(m_type));
+        READWRITE(m_hash);
+    }
+};
+
+//!
+//! \brief An entry in the transaction history of an address: either an output
+//! that pays to the address or an input that spends such an output.
+//!
+struct AddressHistoryEntry
+{
+    int m_height = 0;            //!< Height of the block of the transaction.
+    uint32_t m_tx_position = 0;  //!< Position of the transaction in its block.
+    bool m_spending = false;     //!< Whether the entry is an input.
+    uint32_t m_index = 0;        //!< Output or input number in the transaction.
+    uint256 m_txid;              //!< Hash of the transaction.
+    CAmount m_amount = 0;        //!< Value received, or negative value spent.
+    COutPoint m_prevout;         //!< For inputs, the spent output.
+};
+
+//!
+//! \brief An unspent output of an address.
+//!
+struct AddressUnspentEntry
+{
+    COutPoint m_outpoint;
+    CAmount m_amount = 0;
+    int m_height = 0;
+};
+
+//!
+//! \brief Identifies the input that spends an output.
+//!
+struct SpentByEntry
+{
+    uint256 m_txid;       //!< Hash of the spending transaction.
+    uint32_t m_input = 0; //!< Input number in the spending transaction.
+    int m_height = 0;     //!< Height of the block of the spending transaction.
+    AddressKey m_address; //!< Owner of the spent output.
+    CAmount m_amount = 0; //!< Value of the spent output.
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action)
+    {
+        READWRITE(m_txid);
+        READWRITE(m_input);
+        READWRITE(m_height);
+        READWRITE(m_address);
+        READWRITE(m_amount);
+    }
+};
+
+//!
+//! \brief An optional index in the transaction database that maps addresses
+//! to the transactions that pay to or spend from them.
+//!
+//! The index stores three kinds of records:
+//!
+//!  - history: (address, height, tx position, input flag, index) for each
+//!    indexed output and for each input that spends one. Keys sort by address
+//!    and then by position in the chain, so the history of an address is a
+//!    contiguous range that a reader can page through from any height.
+//!  - unspent: (address, outpoint) for each indexed output not yet spent.
+//!  - spent-by: (outpoint) -> spending input, for each spent indexed output.
+//!
+//! ConnectBlock() writes the records of a block in its database transaction:
+//! two puts for each output and two puts and one delete for each input. The
+//! index never rewrites a record for an address as a whole, like a running
+//! balance, so the write volume for a block is proportional to its size no
+//! matter how active its addresses are. Readers compute balances from the
+//! unspent records. DisconnectBlock() reverses the writes.
+//!
+//! When a node enables the index after it already synchronized the chain, a
+//! background backfill reads the existing blocks in parallel. Because chunks
+//! complete out of order, the backfill decides whether an output is unspent
+//! from the spent flags of the transaction index at commit time instead of
+//! replaying spends in chain order. It stores its progress, so it resumes
+//! where it stopped at the next start. Starting a node with the index disabled
+//! deletes the index, because blocks connected without it leave gaps.
+//!
+class AddressIndex
+{
+public:
+    //!
+    //! \brief Maximum number of entries that a single query may return.
+    //!
+    static constexpr size_t MAX_QUERY_RESULTS = 10000;
+
+    //!
+    //! \brief Enable or disable the index at startup.
+    //!
+    //! Call this after loading the block index and before connecting blocks.
+    //!
+    void Initialize(const bool enabled);
+
+    //!
+    //! \brief Determine whether the node maintains the index.
+    //!
+    bool Enabled() const { return m_enabled; }
+
+    //!
+    //! \brief Determine whether the index contains the records of every block
+    //! in the main chain.
+    //!
+    bool Complete() const { return m_complete; }
+
+    //!
+    //! \brief Store the records for a connected block.
+    //!
+    //! \param txdb          Database transaction of the block connection.
+    //! \param pindex        Index entry of the connected block.
+    //! \param block         The connected block.
+    //! \param spent_outputs Outputs spent by the inputs of the block, in the
+    //!                      order of the transactions and their inputs.
+    //!
+    bool WriteBlock(
+        CTxDB& txdb,
+        const CBlockIndex* const pindex,
+        const CBlock& block,
+        const std::vector<CTxOut>& spent_outputs) const;
+
+    //!
+    //! \brief Remove the records for a disconnected block and restore the
+    //! unspent records of the outputs that it spent.
+    //!
+    //! Call this with \c cs_main held.
+    //!
+    bool EraseBlock(CTxDB& txdb, const CBlockIndex* const pindex, const CBlock& block) const;
+
+    //!
+    //! \brief Write the missing records for the blocks in the main chain.
+    //!
+    //! Runs on the calling thread and several worker threads until done or
+    //! until shutdown. Call this after importing blocks.
+    //!
+    void Backfill();
+
+    //!
+    //! \brief Visit the history of an address in chain order.
+    //!
+    //! \param address      Address to query.
+    //! \param start_height Skip entries below this height.
+    //! \param visitor      Called for each entry. Returns \c false to stop.
+    //!
+    void ReadHistory(
+        CTxDB& txdb,
+        const AddressKey& address,
+        const int start_height,
+        const std::function<bool(const AddressHistoryEntry&)>& visitor) const;
+
+    //!
+    //! \brief Visit the unspent outputs of an address in the order of their
+    //! transaction hashes.
+    //!
+    //! \param address Address to query.
+    //! \param visitor Called for each entry. Returns \c false to stop.
+    //!
+    void ReadUnspent(
+        CTxDB& txdb,
+        const AddressKey& address,
+        const std::function<bool(const AddressUnspentEntry&)>& visitor) const;
+
+    //!
+    //! \brief Look up the input that spends an output.
+    //!
+    //! \return \c nullopt if the output is unspent or not indexed.
+    //!
+    std::optional<SpentByEntry> ReadSpentBy(CTxDB& txdb, const COutPoint& outpoint) const;
+
+private:
+    std::atomic<bool> m_enabled{false};
+    std::atomic<bool> m_complete{false};
+};
+
+//!
+//! \brief Get the global address index.
+//!
+AddressIndex& GetAddressIndex();
+
+#endif // BITCOIN_INDEX_ADDRESSINDEX_H
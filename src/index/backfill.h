@@ -0,0 +1,208 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_BACKFILL_H
+#define BITCOIN_INDEX_BACKFILL_H
+
+#include "main.h"
+#include "sync.h"
+#include "txdb.h"
+#include "util.h"
+#include "util/threadnames.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+//! Number of blocks that a backfill worker claims and commits at once.
+static constexpr size_t BACKFILL_CHUNK_SIZE = 1000;
+
+//! Maximum number of threads that read blocks for a backfill.
+static constexpr size_t MAX_BACKFILL_THREADS = 8;
+
+//!
+//! \brief Describes the work of an index backfill over the main chain.
+//!
+//! \tparam Record What the index stores for one block.
+//!
+template <typename Record>
+struct BackfillJob
+{
+    //!
+    //! \brief Name of the worker threads.
+    //!
+    std::string m_thread_name;
+
+    //!
+    //! \brief Height of the first block to process.
+    //!
+    int m_start_height = 0;
+
+    //!
+    //! \brief Produces the record of a block.
+    //!
+    //! Runs on several threads without \c cs_main. Leaves the record empty to
+    //! skip the block. Returns \c false on failure, which stops the backfill.
+    //!
+    std::function<bool(CTxDB&, const CBlockIndex*, std::optional<Record>&)> m_scan;
+
+    //!
+    //! \brief Writes the record of a block that is still in the main chain.
+    //!
+    //! Runs with \c cs_main held inside a database transaction.
+    //!
+    std::function<bool(CTxDB&, const CBlockIndex*, const Record&)> m_commit;
+
+    //!
+    //! \brief Optional. Stores the height below which every block of the
+    //! snapshot is processed, in the same database transaction as the chunk
+    //! that completes it.
+    //!
+    std::function<bool(CTxDB&, int)> m_checkpoint;
+};
+
+//!
+//! \brief Process the blocks of the main chain for an index in parallel.
+//!
+//! Takes a snapshot of the main chain and lets the calling thread and up to
+//! \c MAX_BACKFILL_THREADS - 1 worker threads claim chunks of blocks. A worker
+//! scans its chunk without locks and then commits the records under \c cs_main
+//! so that a block connected or disconnected since the snapshot cannot
+//! interleave with the chunk. The commit skips blocks that left the main chain.
+//!
+//! \return Number of records written, or \c nullopt if the backfill failed or
+//! stopped for shutdown.
+//!
+template <typename Record>
+std::optional<size_t> BackfillMainChain(const BackfillJob<Record>& job)
+{
+    std::vector<const CBlockIndex*> blocks;
+
+    {
+        LOCK(cs_main);
+
+        blocks.reserve(std::max(nBestHeight - job.m_start_height + 1, 0));
+
+        for (const CBlockIndex* pindex = pindexBest;
+             pindex && pindex->nHeight >= job.m_start_height;
+             pindex = pindex->pprev)
+        {
+            blocks.push_back(pindex);
+        }
+    }
+
+    std::reverse(blocks.begin(), blocks.end());
+
+    const size_t chunk_count = (blocks.size() + BACKFILL_CHUNK_SIZE - 1) / BACKFILL_CHUNK_SIZE;
+    std::vector<bool> chunks_done(chunk_count, false); // Guarded by cs_main.
+    size_t contiguous_chunks = 0;                      // Guarded by cs_main.
+
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> written{0};
+    std::atomic<bool> failed{false};
+
+    const auto worker = [&]() {
+        CTxDB txdb;
+        std::vector<std::pair<const CBlockIndex*, Record>> records;
+
+        while (!fShutdown && !failed) {
+            const size_t begin = next.fetch_add(BACKFILL_CHUNK_SIZE);
+
+            if (begin >= blocks.size()) {
+                break;
+            }
+
+            const size_t end = std::min(begin + BACKFILL_CHUNK_SIZE, blocks.size());
+
+            records.clear();
+
+            for (size_t i = begin; i < end && !fShutdown; ++i) {
+                std::optional<Record> record;
+
+                if (!job.m_scan(txdb, blocks[i], record)) {
+                    failed = true;
+                    break;
+                }
+
+                if (record) {
+                    records.emplace_back(blocks[i], std::move(*record));
+                }
+            }
+
+            if (fShutdown || failed) {
+                break;
+            }
+
+            LOCK(cs_main);
+
+            txdb.TxnBegin();
+
+            for (const auto& [pindex, record] : records) {
+                if (!pindex->IsInMainChain()) continue;
+
+                if (!job.m_commit(txdb, pindex, record)) {
+                    failed = true;
+                    break;
+                }
+            }
+
+            chunks_done[begin / BACKFILL_CHUNK_SIZE] = true;
+
+            const size_t previous_contiguous = contiguous_chunks;
+
+            while (contiguous_chunks < chunk_count && chunks_done[contiguous_chunks]) {
+                ++contiguous_chunks;
+            }
+
+            if (job.m_checkpoint && contiguous_chunks > previous_contiguous) {
+                const size_t done = std::min(contiguous_chunks * BACKFILL_CHUNK_SIZE, blocks.size());
+
+                if (!job.m_checkpoint(txdb, blocks[done - 1]->nHeight + 1)) {
+                    failed = true;
+                }
+            }
+
+            if (failed) {
+                txdb.TxnAbort();
+                break;
+            }
+
+            if (!txdb.TxnCommit()) {
+                error("%s: failed to commit %s chunk", __func__, job.m_thread_name);
+                failed = true;
+                break;
+            }
+
+            written += records.size();
+        }
+    };
+
+    const size_t thread_count = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAX_BACKFILL_THREADS);
+    std::vector<std::thread> threads;
+
+    for (size_t i = 1; i < thread_count; ++i) {
+        threads.emplace_back([&worker, &job]() {
+            util::ThreadRename(std::string(job.m_thread_name));
+            worker();
+        });
+    }
+
+    worker();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (fShutdown || failed) {
+        return std::nullopt;
+    }
+
+    return written.load();
+}
+
+#endif // BITCOIN_INDEX_BACKFILL_H
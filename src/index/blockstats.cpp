@@ -0,0 +1,225 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "chainparams.h"
+#include "gridcoin/claim.h"
+#include "index/backfill.h"
+#include "index/blockstats.h"
+#include "main.h"
+#include "node/blockstorage.h"
+#include "txdb.h"
+#include "util.h"
+
+namespace {
+//! Key type of the block stats records in the transaction database.
+const std::string KEY_TYPE = "blockstats";
+
+//! Key of the marker that indicates a completed backfill.
+const std::string COMPLETE_KEY = "blockstatscomplete";
+
+//!
+//! \brief Serializes a block height in big-endian order so that the records
+//! sort by height in the database.
+//!
+class HeightKey
+{
+public:
+    uint32_t m_height;
+
+    explicit HeightKey(const int height) : m_height(height)
+    {
+    }
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata32be(s, m_height);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        m_height = ser_readdata32be(s);
+    }
+};
+
+using RecordKey = std::pair<std::string, HeightKey>;
+
+RecordKey MakeKey(const CBlockIndex* const pindex)
+{
+    return RecordKey(KEY_TYPE, HeightKey(pindex->nHeight));
+}
+} // Anonymous namespace
+
+// -----------------------------------------------------------------------------
+// Class: BlockStats
+// -----------------------------------------------------------------------------
+
+BlockStats BlockStats::FromBlock(const CBlock& block, const uint256& hash, const GRC::MintSummary& mint)
+{
+    const GRC::Claim& claim = block.GetClaim();
+    BlockStats stats;
+
+    stats.m_block_hash = hash;
+    stats.m_block_version = block.nVersion;
+    stats.m_tx_count = block.vtx.size();
+    stats.m_size = GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION);
+    stats.m_proof_of_stake = block.vtx.size() >= 2 && block.vtx[1].IsCoinStake();
+    stats.m_has_superblock = claim.ContainsSuperblock();
+    stats.m_mint = mint.m_total;
+    stats.m_fees = mint.m_fees;
+    stats.m_research_subsidy = claim.m_research_subsidy;
+    stats.m_block_subsidy = claim.m_block_subsidy;
+    stats.m_mining_id = claim.m_mining_id;
+    stats.m_organization = claim.m_organization;
+    stats.m_client_version = claim.m_client_version;
+    stats.m_quorum_hash = claim.m_quorum_hash;
+
+    return stats;
+}
+
+// -----------------------------------------------------------------------------
+// Class: BlockStatsIndex
+// -----------------------------------------------------------------------------
+
+void BlockStatsIndex::Initialize(const bool enabled)
+{
+    CTxDB txdb;
+    std::string key = COMPLETE_KEY;
+    bool complete = false;
+
+    txdb.ReadGenericSerializable(key, complete);
+
+    if (!enabled) {
+        if (complete) {
+            txdb.EraseGenericSerializable(key);
+            LogPrintf("INFO: %s: block stats index disabled. Enabling it again rebuilds it.", __func__);
+        }
+
+        m_enabled = false;
+        m_complete = false;
+
+        return;
+    }
+
+    m_enabled = true;
+    m_complete = complete;
+
+    LogPrintf("INFO: %s: block stats index enabled (%s).", __func__, complete ? "complete" : "requires backfill");
+}
+
+bool BlockStatsIndex::WriteBlock(
+    CTxDB& txdb,
+    const CBlockIndex* const pindex,
+    const CBlock& block,
+    const GRC::MintSummary& mint) const
+{
+    RecordKey key = MakeKey(pindex);
+
+    return txdb.WriteGenericSerializable(key, BlockStats::FromBlock(block, pindex->GetBlockHash(), mint));
+}
+
+bool BlockStatsIndex::EraseBlock(CTxDB& txdb, const CBlockIndex* const pindex) const
+{
+    RecordKey key = MakeKey(pindex);
+
+    return txdb.EraseGenericSerializable(key);
+}
+
+bool BlockStatsIndex::ReadBlock(CTxDB& txdb, const CBlockIndex* const pindex, BlockStats& stats) const
+{
+    RecordKey key = MakeKey(pindex);
+
+    // A record for another block at the same height remains after a node that
+    // ran without the index reorganized the chain:
+    return txdb.ReadGenericSerializable(key, stats)
+        && stats.m_block_hash == pindex->GetBlockHash();
+}
+
+void BlockStatsIndex::Backfill()
+{
+    if (!m_enabled || m_complete) {
+        return;
+    }
+
+    LogPrintf("INFO: %s: building block stats index...", __func__);
+
+    const int64_t start_time = GetTimeMillis();
+
+    BackfillJob<BlockStats> job;
+    job.m_thread_name = "grc-blkstats";
+
+    job.m_scan = [this](CTxDB& txdb, const CBlockIndex* pindex, std::optional<BlockStats>& record) {
+        BlockStats stats;
+        CBlock block;
+
+        if (ReadBlock(txdb, pindex, stats)) {
+            return true;
+        }
+
+        if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+            return error("%s: failed to read block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+
+        record = BlockStats::FromBlock(block, pindex->GetBlockHash(), block.GetMint(txdb));
+
+        return true;
+    };
+
+    job.m_commit = [](CTxDB& txdb, const CBlockIndex* pindex, const BlockStats& stats) {
+        RecordKey key = MakeKey(pindex);
+
+        return txdb.WriteGenericSerializable(key, stats);
+    };
+
+    const std::optional<size_t> written = BackfillMainChain(job);
+
+    if (!written) {
+        LogPrintf("INFO: %s: block stats index backfill stopped. It resumes at the next start.", __func__);
+        return;
+    }
+
+    CTxDB txdb;
+    std::string key = COMPLETE_KEY;
+
+    if (!txdb.WriteGenericSerializable(key, true)) {
+        error("%s: failed to store block stats index marker", __func__);
+        return;
+    }
+
+    m_complete = true;
+
+    LogPrintf("INFO: %s: built block stats index with %u new records in %" PRId64 " ms.",
+              __func__, *written, GetTimeMillis() - start_time);
+}
+
+BlockStatsIndex& GetBlockStatsIndex()
+{
+    static BlockStatsIndex index;
+
+    return index;
+}
+
+bool ReadBlockStats(const CBlockIndex* const pindex, BlockStats& stats, const bool compute_mint)
+{
+    CTxDB txdb("r");
+    const BlockStatsIndex& index = GetBlockStatsIndex();
+
+    if (index.Enabled() && index.ReadBlock(txdb, pindex, stats)) {
+        return true;
+    }
+
+    CBlock block;
+
+    if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+        return false;
+    }
+
+    stats = BlockStats::FromBlock(
+        block,
+        pindex->GetBlockHash(),
+        compute_mint ? block.GetMint(txdb) : GRC::MintSummary());
+
+    return true;
+}
@@ -0,0 +1,184 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_BLOCKSTATS_H
+#define BITCOIN_INDEX_BLOCKSTATS_H
+
+#include "amount.h"
+#include "gridcoin/cpid.h"
+#include "gridcoin/superblock.h"
+#include "serialize.h"
+#include "uint256.h"
+
+#include <atomic>
+#include <string>
+
+class CBlock;
+class CBlockIndex;
+class CTxDB;
+
+namespace GRC {
+class MintSummary;
+}
+
+//! Default for -blockstatsindex.
+static constexpr bool DEFAULT_BLOCKSTATSINDEX = false;
+
+//!
+//! \brief A compact summary of the block data that the data acquisition RPCs
+//! report, so that they do not need to read and parse each block from disk.
+//!
+class BlockStats
+{
+public:
+    //!
+    //! \brief Version number of the serialized record format.
+    //!
+    static constexpr uint32_t CURRENT_VERSION = 1;
+
+    uint32_t m_version = CURRENT_VERSION; //!< Version of the record format.
+
+    uint256 m_block_hash;              //!< Identifies the summarized block.
+    int32_t m_block_version = 0;       //!< Version of the block format.
+    uint32_t m_tx_count = 0;           //!< Number of transactions in the block.
+    uint32_t m_size = 0;               //!< Network serialization size in bytes.
+    bool m_proof_of_stake = false;     //!< Whether the second transaction is a coinstake.
+    bool m_has_superblock = false;     //!< Whether the claim contains a superblock.
+    CAmount m_mint = 0;                //!< Value claimed by the block producer.
+    CAmount m_fees = 0;                //!< Fees paid for the block's transactions.
+    CAmount m_research_subsidy = 0;    //!< Research reward declared in the claim.
+    CAmount m_block_subsidy = 0;       //!< Block reward declared in the claim.
+    GRC::MiningId m_mining_id;         //!< CPID or investor status of the staker.
+    std::string m_organization;        //!< Organization declared in the claim.
+    std::string m_client_version;      //!< Client version declared in the claim.
+    GRC::QuorumHash m_quorum_hash;     //!< Legacy quorum vote of the claim.
+
+    //!
+    //! \brief Summarize a block.
+    //!
+    //! \param block The block to summarize. Must contain its transactions.
+    //! \param hash  Hash of the block.
+    //! \param mint  Value claimed by the block producer and fees in the block.
+    //!
+    static BlockStats FromBlock(const CBlock& block, const uint256& hash, const GRC::MintSummary& mint);
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action)
+    {
+        READWRITE(m_version);
+        READWRITE(m_block_hash);
+        READWRITE(m_block_version);
+        READWRITE(m_tx_count);
+        READWRITE(m_size);
+        READWRITE(m_proof_of_stake);
+        READWRITE(m_has_superblock);
+        READWRITE(m_mint);
+        READWRITE(m_fees);
+        READWRITE(m_research_subsidy);
+        READWRITE(m_block_subsidy);
+        READWRITE(m_mining_id);
+        READWRITE(LIMITED_STRING(m_organization, 256));
+        READWRITE(LIMITED_STRING(m_client_version, 256));
+        READWRITE(m_quorum_hash);
+    }
+};
+
+//!
+//! \brief An optional index in the transaction database that stores a
+//! \c BlockStats record for each block in the main chain.
+//!
+//! ConnectBlock() writes the record of each block that it connects and
+//! DisconnectBlock() erases it in the same database transaction. Records are
+//! keyed by height in big-endian order, so a range of blocks occupies a
+//! contiguous range of keys. Each record carries the hash of its block: a
+//! reader treats a record for a different block as missing.
+//!
+//! When a node enables the index after it already synchronized the chain, a
+//! background backfill reads the existing blocks in parallel and writes their
+//! records once. The index stores a marker when the backfill completes and
+//! removes it when the node starts with the index disabled, because blocks
+//! connected without the index leave gaps.
+//!
+class BlockStatsIndex
+{
+public:
+    //!
+    //! \brief Enable or disable the index at startup.
+    //!
+    //! Call this after loading the block index and before connecting blocks.
+    //!
+    void Initialize(const bool enabled);
+
+    //!
+    //! \brief Determine whether the node maintains the index.
+    //!
+    bool Enabled() const { return m_enabled; }
+
+    //!
+    //! \brief Determine whether the index contains a record for every block
+    //! in the main chain.
+    //!
+    bool Complete() const { return m_complete; }
+
+    //!
+    //! \brief Store the record for a connected block.
+    //!
+    //! \param txdb  Database transaction of the block connection.
+    //! \param pindex Index entry of the connected block.
+    //! \param block The connected block.
+    //! \param mint  Value claimed and fees, as computed by ConnectBlock().
+    //!
+    bool WriteBlock(
+        CTxDB& txdb,
+        const CBlockIndex* const pindex,
+        const CBlock& block,
+        const GRC::MintSummary& mint) const;
+
+    //!
+    //! \brief Remove the record for a disconnected block.
+    //!
+    bool EraseBlock(CTxDB& txdb, const CBlockIndex* const pindex) const;
+
+    //!
+    //! \brief Load the record of a block from the index.
+    //!
+    //! \return \c false if the index does not contain a record for the block.
+    //!
+    bool ReadBlock(CTxDB& txdb, const CBlockIndex* const pindex, BlockStats& stats) const;
+
+    //!
+    //! \brief Write the missing records for the blocks in the main chain.
+    //!
+    //! Runs on the calling thread and several worker threads until done or
+    //! until shutdown. Call this after importing blocks.
+    //!
+    void Backfill();
+
+private:
+    std::atomic<bool> m_enabled{false};
+    std::atomic<bool> m_complete{false};
+};
+
+//!
+//! \brief Get the global block stats index.
+//!
+BlockStatsIndex& GetBlockStatsIndex();
+
+//!
+//! \brief Get the stats of a block from the index or, if the index does not
+//! contain its record, by reading the block from disk.
+//!
+//! \param pindex       Index entry of the block.
+//! \param stats        Receives the stats of the block.
+//! \param compute_mint Whether a block read from disk needs \c m_mint and
+//!                     \c m_fees, which requires reading its inputs. When
+//!                     \c false, those fields may be zero.
+//!
+//! \return \c false if the block cannot be read from disk.
+//!
+bool ReadBlockStats(const CBlockIndex* const pindex, BlockStats& stats, const bool compute_mint = true);
+
+#endif // BITCOIN_INDEX_BLOCKSTATS_H
@@ -8,12 +8,17 @@
 #include "gridcoin/support/block_finder.h"
 #include "util.h"
 #include "util/threadnames.h"
+#include "util/trace.h"
 #include "net.h"
 #include "txdb.h"
+#include "index/addressindex.h"
+#include "index/blockstats.h"
+#include "wallet/rescan.h"
 #include "wallet/walletdb.h"
 #include "banman.h"
 #include "random.h"
 #include "rpc/server.h"
+#include "rpc/workqueue.h"
 #include "init.h"
 #include "node/ui_interface.h"
 #include "scheduler.h"
@@ -22,6 +27,7 @@
 #include "gridcoin/contract/registry.h"
 #include "miner.h"
 #include "node/blockstorage.h"
+#include "node/prune.h"
 #include <util/syserror.h>
 
 #include <boost/algorithm/string/predicate.hpp>
@@ -51,6 +57,11 @@ extern unsigned int nMinerSleep;
 extern bool fUseFastIndex;
 // Dump addresses to banlist.dat every 5 minutes (300 s)
 static constexpr int DUMP_BANS_INTERVAL = 300;
+static constexpr bool DEFAULT_LOCKSTATS = false;
+static constexpr int64_t DEFAULT_LOCKSTATSINTERVAL = 0;
+static constexpr bool DEFAULT_TRACE = false;
+static constexpr int64_t DEFAULT_TRACEBUFFER = 10000;
+static constexpr int64_t DEFAULT_TRACESLOWMS = 1000;
 
 // RPC client default timeout.
 extern constexpr int DEFAULT_WAIT_CLIENT_TIMEOUT = 0;
@@ -186,6 +197,7 @@ void Shutdown(void* parg)
         ECC_Stop();
         UninterruptibleSleep(std::chrono::milliseconds{50});
         LogPrintf("Gridcoin exited");
+        LogInstance().StopAsyncWriter();
         fExit = true;
     }
     else
@@ -281,6 +293,34 @@ void AddLoggingArgs(ArgsManager& argsman)
     argsman.AddArg("-logtimemicros", strprintf("Add microsecond precision to debug timestamps (default: %u)",
                                                DEFAULT_LOGTIMEMICROS),
                    ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-logasync", strprintf("Write log messages from a dedicated thread instead of the thread that"
+                                          " logs them. A crash loses the messages that still wait for the"
+                                          " thread, so it is off by default (default: %u)", DEFAULT_LOGASYNC),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-logqueuesize=<n>", strprintf("Number of log messages that may wait for the log writer thread"
+                                                  " (default: %u)", DEFAULT_LOGQUEUESIZE),
+                   ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-logoverflow=<policy>", "What a thread does when it logs a message while the log queue is full:"
+                                            " \"block\" waits for room, \"drop\" discards the message and counts it"
+                                            " (default: block)",
+                   ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-lockstats", strprintf("Record how long each lock site waits for and holds its lock. See the"
+                                           " getlockstats RPC (default: %u)", DEFAULT_LOCKSTATS),
+                   ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-lockstatsinterval=<n>", strprintf("With -lockstats, write the most contended lock sites to the"
+                                                       " debug log every <n> seconds. 0 disables (default: %u)",
+                                                       DEFAULT_LOCKSTATSINTERVAL),
+                   ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-trace", strprintf("Record the latency of block processing, staking, scraper, superblock and"
+                                       " poll spans. See the gettracestats and exporttrace RPCs (default: %u)",
+                                       DEFAULT_TRACE),
+                   ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-tracebuffer=<n>", strprintf("With -trace, number of recent spans to keep for exporttrace"
+                                                 " (default: %u)", DEFAULT_TRACEBUFFER),
+                   ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
+    argsman.AddArg("-traceslowms=<n>", strprintf("With -trace, keep spans that take at least <n> milliseconds in"
+                                                 " the list of slow spans (default: %u)", DEFAULT_TRACESLOWMS),
+                   ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-printtoconsole", "Send trace/debug info to console (default: 0) )",
                    ArgsManager::ALLOW_ANY, OptionsCategory::DEBUG_TEST);
     argsman.AddArg("-printtodebugger", "Send trace/debug info to debugger (default: 0)",
@@ -342,6 +382,15 @@ void SetupServerArgs()
                                                     "(%d to %d, default: %d)",
                                                     nMinDbCache, nMaxTxIndexCache, nDefaultDbCache),
                    ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-blockstatsindex", strprintf("Maintain an index of per-block statistics for the getblockstats,"
+                                                 " exportstats and getrecentblocks RPCs (default: %u)",
+                                                 DEFAULT_BLOCKSTATSINDEX),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-addressindex", strprintf("Maintain an index of the transactions and unspent outputs of each"
+                                              " address for the getaddresshistory, getaddressbalance and"
+                                              " getaddressutxos RPCs (default: %u)",
+                                              DEFAULT_ADDRESSINDEX),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-dblogsize=<n>", "Set database disk log size in megabytes (default: 100)",
                    ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-synctime", "Sync time with other nodes. Disable if time on your system is precise e.g. syncing with"
@@ -373,6 +422,12 @@ void SetupServerArgs()
                    ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-blockmaxsize=<n>", strprintf("Set maximum block size in bytes (default: %u)", MAX_BLOCK_SIZE_GEN/2),
                    ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-maxmempool=<n>", strprintf("Keep the transaction memory pool below <n> megabytes (default: %u)",
+                                                DEFAULT_MAX_MEMPOOL_SIZE),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-mempoolexpiry=<n>", strprintf("Do not keep transactions in the mempool longer than <n> hours "
+                                                   "(default: %u)", DEFAULT_MEMPOOL_EXPIRY),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-snapshotdownload", "Download and apply latest snapshot",
                    ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-snapshoturl=<url>", "Optional: URL for the snapshot.zip file (ex: "
@@ -397,6 +452,25 @@ void SetupServerArgs()
                    ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-reindex", "Rebuild chain state and block index from the blk*.dat files on disk",
                    ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-compressblocks", strprintf("Compress the blocks written to new block files when that saves at"
+                                                " least 1/8 of their size. Reading one transaction then inflates"
+                                                " its whole block, and earlier versions cannot read the compressed"
+                                                " blocks (default: %u)",
+                                                DEFAULT_COMPRESS_BLOCKS),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-convertblockfiles", strprintf("Rewrite the block files of earlier versions in the background to"
+                                                   " checksum and compress their blocks. Earlier versions cannot read"
+                                                   " the converted files (default: %u)",
+                                                   DEFAULT_CONVERT_BLOCK_FILES),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-prune=<n>", strprintf("Reduce storage requirements by deleting old block files to keep them"
+                                           " under <n> MiB (default: 0 = disabled, minimum: %u). The block index,"
+                                           " the superblocks, the transactions with unspent outputs and the blocks"
+                                           " of the contract, beacon and poll lookback windows remain, so staking,"
+                                           " MRC and voting keep working. Once blocks are pruned, -reindex, -rescan"
+                                           " and the RPCs that read old blocks are not available. See doc/pruning.md.",
+                                           MIN_PRUNE_TARGET_MIB),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-settings=<file>", strprintf("Specify path to dynamic settings data file. Can be disabled with"
                                                  " -nosettings. File is written at runtime and not meant to be edited by"
                                                  " users (use %s instead for custom settings). Relative paths will be"
@@ -481,6 +555,9 @@ void SetupServerArgs()
                    ArgsManager::ALLOW_ANY, OptionsCategory::WALLET);
     argsman.AddArg("-rescanmrcrequests", "Rescan the block chain for missing mrc request transactions",
                    ArgsManager::ALLOW_ANY, OptionsCategory::WALLET);
+    argsman.AddArg("-rescanthreads=<n>", strprintf("Number of threads that read blocks during a wallet rescan "
+                   "(0 = number of cores, default: %d)", wallet::DEFAULT_RESCAN_THREADS),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::WALLET);
     argsman.AddArg("-salvagewallet", "Attempt to recover private keys from a corrupt wallet.dat",
                    ArgsManager::ALLOW_ANY, OptionsCategory::WALLET);
     argsman.AddArg("-zapwallettxes", "Delete all wallet transactions and only recover those parts of the blockchain through"
@@ -596,6 +673,16 @@ void SetupServerArgs()
                    ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpcthreads=<n>", "Set the number of threads to service RPC calls (default: 4)",
                    ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
+    argsman.AddArg("-rpcworkqueue=<n>", strprintf("Set the depth of the work queue to service RPC calls. Requests "
+                                                  "beyond the depth are rejected with HTTP 503 (default: %u)",
+                                                  DEFAULT_RPC_WORK_QUEUE),
+                   ArgsManager::ALLOW_INT, OptionsCategory::RPC);
+    argsman.AddArg("-rpcservertimeout=<n>", strprintf("Timeout in seconds before an idle RPC connection closes "
+                                                      "(default: %d)", DEFAULT_RPC_SERVER_TIMEOUT),
+                   ArgsManager::ALLOW_INT, OptionsCategory::RPC);
+    argsman.AddArg("-rpcmethodlimit=<method>:<n>", "Limit the number of concurrent calls of an RPC method to <n> "
+                                                   "threads. Can be specified multiple times",
+                   ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpcssl", "Use OpenSSL (https) for JSON-RPC connections", ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
     argsman.AddArg("-rpcsslcertificatechainfile=<file.cert>", "Server certificate file (default: server.cert)",
                    ArgsManager::ALLOW_ANY, OptionsCategory::RPC);
@@ -792,6 +879,31 @@ void InitLogging()
        strprintf("Could not open debug log file %s", LogInstance().m_file_path.string());
     }
 
+    InstallLogFlushHandlers();
+
+    if (gArgs.GetBoolArg("-logasync", DEFAULT_LOGASYNC))
+    {
+        BCLog::OverflowPolicy overflow_policy = BCLog::OverflowPolicy::BLOCK;
+
+        if (!GetLogOverflowPolicy(overflow_policy, gArgs.GetArg("-logoverflow", "block")))
+        {
+            InitWarning(strprintf("Unsupported log overflow policy %s=%s.", "-logoverflow", gArgs.GetArg("-logoverflow", "")));
+        }
+
+        LogInstance().StartAsyncWriter(
+            std::max<int64_t>(1, gArgs.GetArg("-logqueuesize", DEFAULT_LOGQUEUESIZE)),
+            overflow_policy);
+    }
+
+    g_lock_profiling = gArgs.GetBoolArg("-lockstats", DEFAULT_LOCKSTATS);
+
+    if (gArgs.GetBoolArg("-trace", DEFAULT_TRACE))
+    {
+        EnableTracing(true,
+                      std::max<int64_t>(0, gArgs.GetArg("-tracebuffer", DEFAULT_TRACEBUFFER)),
+                      std::max<int64_t>(0, gArgs.GetArg("-traceslowms", DEFAULT_TRACESLOWMS)) * 1000);
+    }
+
     if (!LogInstance().m_log_timestamps)
     {
         LogPrintf("Startup time: %s\n", FormatISO8601DateTime(GetTime()));
@@ -1006,6 +1118,26 @@ bool AppInit2(ThreadHandlerPtr threads)
             return InitError(strprintf(_("Invalid amount for -mininput=<amount>: '%s'"), gArgs.GetArg("-mininput", "")));
     }
 
+    fCompressBlocks = gArgs.GetBoolArg("-compressblocks", DEFAULT_COMPRESS_BLOCKS);
+
+    const int64_t prune_target_mib = gArgs.GetArg("-prune", 0);
+
+    if (prune_target_mib < 0)
+        return InitError(_("Prune cannot be configured with a negative value."));
+
+    if (prune_target_mib > 0)
+    {
+        if ((uint64_t) prune_target_mib < MIN_PRUNE_TARGET_MIB)
+            return InitError(strprintf(_("Prune configured below the minimum of %d MiB. Please use a higher number."),
+                                       MIN_PRUNE_TARGET_MIB));
+
+        fPruneMode = true;
+        nPruneTarget = (uint64_t) prune_target_mib * 1024 * 1024;
+
+        LogPrintf("Prune mode enabled: old block files will be deleted to keep them under %" PRId64 " MiB",
+                  prune_target_mib);
+    }
+
     // ********************************************************* Step 4: application initialization: dir lock, daemonize, pidfile, debug log
     if (!CreatePidFile(gArgs)) {
         // Detailed error printed inside CreatePidFile().
@@ -1249,6 +1381,13 @@ bool AppInit2(ThreadHandlerPtr threads)
     // existing block data files from blk*.dat to blk*.dat.orig to prepare for reloading index from block data files.
     // This is the first half of reindex. The second half is below in the import blocks section.
     if (gArgs.GetBoolArg("-reindex")) {
+        // Pruning deletes the oldest block file first. The stubs that it
+        // leaves in later files do not form a chain to reindex:
+        if (!fs::exists(BlockFilePath(1)) && fs::exists(BlockFilePath(2))) {
+            return InitError(_("The block files were pruned, so -reindex cannot rebuild the chain from them. "
+                               "Remove -reindex, or delete the block data to synchronize again."));
+        }
+
         uiInterface.InitMessage(_("Resetting block chain index to prepare for reindexing..."));
 
         if (!GRC::Upgrade::ResetBlockchainData(false) || !GRC::Upgrade::MoveBlockDataFiles(block_data_files_to_load)) {
@@ -1272,6 +1411,33 @@ bool AppInit2(ThreadHandlerPtr threads)
 
     g_timer.GetTimes("Finished loading block chain", "init");
 
+    GetBlockStatsIndex().Initialize(gArgs.GetBoolArg("-blockstatsindex", DEFAULT_BLOCKSTATSINDEX));
+    GetAddressIndex().Initialize(gArgs.GetBoolArg("-addressindex", DEFAULT_ADDRESSINDEX));
+
+    // The index backfills read every block from the genesis block:
+    if ((fPruneMode || HavePrunedBlocks())
+        && ((GetBlockStatsIndex().Enabled() && !GetBlockStatsIndex().Complete())
+            || (GetAddressIndex().Enabled() && !GetAddressIndex().Complete())))
+    {
+        return InitError(_("-blockstatsindex and -addressindex must finish building before the node prunes blocks. "
+                           "Start without -prune until the indexes are complete."));
+    }
+
+    if (HavePrunedBlocks())
+    {
+        if (gArgs.GetBoolArg("-rescan"))
+            return InitError(_("Rescans are not possible because blocks were pruned."));
+
+        for (const auto& contract_type : GRC::RegistryBookmarks::CONTRACT_TYPES_WITH_REG_DB) {
+            const std::string history_arg = "-clear" + GRC::Contract::Type::ToString(contract_type) + "history";
+
+            if (gArgs.GetBoolArg(history_arg, false)) {
+                return InitError(strprintf(_("%s replays the contracts from the first version 11 block, but blocks "
+                                             "were pruned."), history_arg));
+            }
+        }
+    }
+
     if (gArgs.GetBoolArg("-printblockindex") || gArgs.GetBoolArg("-printblocktree"))
     {
         PrintBlockTree();
@@ -1390,6 +1556,14 @@ bool AppInit2(ThreadHandlerPtr threads)
         walletdb.ReadAttribute("mrc_request_correction_scan_complete", mrc_request_correction_scan_complete);
     }
 
+    // A wallet last synchronized at a pruned block missed transactions that
+    // only a rescan of the pruned blocks can find:
+    if (pindexRescan && pindexRescan != pindexBest && IsBlockPruned(pindexRescan))
+    {
+        return InitError(_("The wallet was last synchronized at a block that was pruned. Restore a wallet that is in "
+                           "sync, or delete the block data to synchronize again."));
+    }
+
     // If rescan is NOT specified and mrc_request_correction_scan_complete is false and the wallet best height
     // is greater than the V12 height, where MRC requests became possible, then perform a correction rescan for
     // MRC requests from the BlockV12Height block to the wallet best height - 1. From the wallet best height to
@@ -1555,6 +1729,27 @@ bool AppInit2(ThreadHandlerPtr threads)
         LogPrintf("mapAddressBook.size() = %" PRIszu,  pwalletMain->mapAddressBook.size());
     }
 
+    if (GetBlockStatsIndex().Enabled() && !GetBlockStatsIndex().Complete())
+    {
+        threadGroup.create_thread(std::bind(&TraceThread<std::function<void()>>, "blockstats", [] {
+            GetBlockStatsIndex().Backfill();
+        }));
+    }
+
+    if (GetAddressIndex().Enabled() && !GetAddressIndex().Complete())
+    {
+        threadGroup.create_thread(std::bind(&TraceThread<std::function<void()>>, "addressindex", [] {
+            GetAddressIndex().Backfill();
+        }));
+    }
+
+    if (gArgs.GetBoolArg("-convertblockfiles", DEFAULT_CONVERT_BLOCK_FILES))
+    {
+        threadGroup.create_thread(std::bind(&TraceThread<std::function<void()>>, "blockconvert", [] {
+            ConvertBlockFiles();
+        }));
+    }
+
     if (!threads->createThread(StartNode, nullptr, "Start Thread"))
         InitError(_("Error: could not start node"));
 
@@ -1588,6 +1783,20 @@ bool AppInit2(ThreadHandlerPtr threads)
         g_banman->DumpBanlist();
     }, std::chrono::seconds{DUMP_BANS_INTERVAL});
 
+    // Transactions stay in the memory pool for hours, so expiring them periodically instead of on each accepted
+    // transaction is precise enough.
+    scheduler.scheduleEvery([]{
+        ExpireMempool(mempool);
+    }, std::chrono::seconds{MEMPOOL_EXPIRY_INTERVAL});
+
+    if (const int64_t interval = gArgs.GetArg("-lockstatsinterval", DEFAULT_LOCKSTATSINTERVAL);
+        g_lock_profiling && interval > 0)
+    {
+        scheduler.scheduleEvery([]{
+            LogLockStats(10);
+        }, std::chrono::seconds{interval});
+    }
+
     GRC::ScheduleBackgroundJobs(scheduler);
 
     #if HAVE_SYSTEM
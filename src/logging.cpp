@@ -14,6 +14,8 @@
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 
+#include <cstdlib>
+#include <limits>
 #include <mutex>
 #include <set>
 
@@ -21,6 +23,14 @@ extern ArgsManager gArgs;
 
 const char * const DEFAULT_DEBUGLOGFILE = "debug.log";
 
+namespace {
+//! Maximum number of queued messages that the writer thread writes at once.
+constexpr size_t MAX_WRITE_BATCH = 1024;
+
+//! How long the writer thread sleeps before it checks an empty queue again.
+constexpr std::chrono::milliseconds WRITER_IDLE_TIMEOUT{100};
+} // Anonymous namespace
+
 BCLog::Logger& LogInstance()
 {
 /**
@@ -91,11 +101,253 @@ bool BCLog::Logger::StartLogging()
 
 void BCLog::Logger::DisconnectTestLogger()
 {
+    StopAsyncWriter();
+
     std::lock_guard<std::mutex> scoped_lock(m_cs);
     m_buffering = true;
     if (m_fileout != nullptr) fclose(m_fileout);
     m_fileout = nullptr;
     m_print_callbacks.clear();
+    m_has_callbacks = false;
+}
+
+// -----------------------------------------------------------------------------
+// Class: MessageQueue
+// -----------------------------------------------------------------------------
+
+BCLog::MessageQueue::MessageQueue(const size_t capacity)
+    : m_mask([&] {
+        size_t rounded = 2;
+        while (rounded < capacity) rounded <<= 1;
+        return rounded - 1;
+    }())
+    , m_slots(new Slot[m_mask + 1])
+{
+    for (size_t i = 0; i <= m_mask; ++i) {
+        m_slots[i].m_sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool BCLog::MessageQueue::TryPush(std::string& message)
+{
+    size_t pos = m_push_pos.load(std::memory_order_relaxed);
+    Slot* slot;
+
+    while (true) {
+        slot = &m_slots[pos & m_mask];
+        const size_t sequence = slot->m_sequence.load(std::memory_order_acquire);
+        const intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+        if (diff == 0) {
+            // The slot is free. Claim it unless another producer did first:
+            if (m_push_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The slot still holds the message from the previous lap:
+            return false;
+        } else {
+            pos = m_push_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->m_message = std::move(message);
+    slot->m_sequence.store(pos + 1, std::memory_order_release);
+
+    return true;
+}
+
+bool BCLog::MessageQueue::TryPop(std::string& message)
+{
+    const size_t pos = m_pop_pos.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[pos & m_mask];
+
+    if (slot.m_sequence.load(std::memory_order_acquire) != pos + 1) {
+        return false;
+    }
+
+    message = std::move(slot.m_message);
+    slot.m_message.clear();
+    slot.m_sequence.store(pos + m_mask + 1, std::memory_order_release);
+    m_pop_pos.store(pos + 1, std::memory_order_relaxed);
+
+    return true;
+}
+
+bool BCLog::MessageQueue::Empty() const
+{
+    const size_t pos = m_pop_pos.load(std::memory_order_relaxed);
+
+    return m_slots[pos & m_mask].m_sequence.load(std::memory_order_acquire) != pos + 1;
+}
+
+// -----------------------------------------------------------------------------
+// Class: Logger - asynchronous writer
+// -----------------------------------------------------------------------------
+
+void BCLog::Logger::StartAsyncWriter(const size_t queue_size, const OverflowPolicy policy)
+{
+    std::lock_guard<std::mutex> scoped_lock(m_cs);
+
+    assert(!m_buffering);
+
+    if (m_async) return;
+
+    // Threads that observed the previous writer may still hold the queue, so
+    // it lives as long as the logger once created:
+    if (!m_queue) {
+        m_queue = std::make_unique<MessageQueue>(queue_size);
+    }
+
+    m_overflow_policy = policy;
+    m_stop_writer = false;
+    m_writer = std::thread(&BCLog::Logger::WriterThread, this);
+    m_async = true;
+}
+
+void BCLog::Logger::StopAsyncWriter()
+{
+    if (!m_async.exchange(false)) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        m_stop_writer = true;
+    }
+
+    m_writer_cond.notify_one();
+    m_writer.join();
+
+    // Write any messages from threads that queued them as the writer stopped:
+    Flush();
+}
+
+void BCLog::Logger::Flush()
+{
+    std::lock_guard<std::mutex> scoped_lock(m_cs);
+
+    DrainQueue(std::numeric_limits<size_t>::max());
+
+    if (m_fileout != nullptr) fflush(m_fileout);
+    if (m_print_to_console) fflush(stdout);
+}
+
+bool BCLog::Logger::EnqueueMessage(std::string& str)
+{
+    while (!m_queue->TryPush(str)) {
+        if (m_overflow_policy == OverflowPolicy::DROP) {
+            ++m_dropped;
+            return true;
+        }
+
+        // The writer stopped while this thread waited. Write synchronously:
+        if (!m_async) {
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    // Pairs with the fence in WriterThread() so that either the writer sees
+    // the new message or this thread sees that the writer sleeps:
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (m_writer_sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(m_writer_mutex);
+        m_writer_cond.notify_one();
+    }
+
+    return true;
+}
+
+size_t BCLog::Logger::DrainQueue(const size_t max_count)
+{
+    if (!m_queue) return 0;
+
+    std::string batch;
+    std::string message;
+    size_t count = 0;
+
+    while (count < max_count && m_queue->TryPop(message)) {
+        batch += message;
+        ++count;
+    }
+
+    const uint64_t dropped = m_dropped.load();
+
+    if (dropped != m_dropped_reported) {
+        if (m_log_timestamps) {
+            batch += FormatISO8601DateTime(GetTime()) + ' ';
+        }
+
+        batch += strprintf("WARNING: Logger: discarded %u messages because the log queue was full\n",
+                           dropped - m_dropped_reported);
+        m_dropped_reported = dropped;
+    }
+
+    if (!batch.empty()) {
+        WriteOutputs(batch);
+    }
+
+    return count;
+}
+
+void BCLog::Logger::WriterThread()
+{
+    util::ThreadRename("grc-logger");
+
+    while (true) {
+        size_t written;
+
+        {
+            std::lock_guard<std::mutex> scoped_lock(m_cs);
+            written = DrainQueue(MAX_WRITE_BATCH);
+        }
+
+        if (written > 0) continue;
+        if (m_stop_writer) return;
+
+        std::unique_lock<std::mutex> lock(m_writer_mutex);
+
+        m_writer_sleeping = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (!m_stop_writer && m_queue->Empty()) {
+            m_writer_cond.wait_for(lock, WRITER_IDLE_TIMEOUT);
+        }
+
+        m_writer_sleeping = false;
+    }
+}
+
+namespace {
+void FlushLogAtExit()
+{
+    LogInstance().StopAsyncWriter();
+}
+} // Anonymous namespace
+
+void InstallLogFlushHandlers()
+{
+    static std::once_flag installed;
+
+    std::call_once(installed, [] {
+        std::atexit(FlushLogAtExit);
+    });
+}
+
+bool GetLogOverflowPolicy(BCLog::OverflowPolicy& policy, const std::string& str)
+{
+    if (str == "block") {
+        policy = BCLog::OverflowPolicy::BLOCK;
+        return true;
+    }
+
+    if (str == "drop") {
+        policy = BCLog::OverflowPolicy::DROP;
+        return true;
+    }
+
+    return false;
 }
 
 void BCLog::Logger::EnableCategory(BCLog::LogFlags flag)
@@ -274,7 +526,6 @@ namespace BCLog {
 
 void BCLog::Logger::LogPrintStr(const std::string& str)
 {
-    std::lock_guard<std::mutex> scoped_lock(m_cs);
     std::string str_prefixed = LogEscapeMessage(str);
 
     if (m_log_threadnames && m_started_new_line) {
@@ -286,20 +537,54 @@ void BCLog::Logger::LogPrintStr(const std::string& str)
 
     m_started_new_line = !str.empty() && str[str.size()-1] == '\n';
 
+    bool called_back = false;
+
+    if (m_async) {
+        // Call the slots on this thread rather than on the writer thread. A
+        // slot that logs from the writer thread would wait on itself when the
+        // queue is full:
+        if (m_has_callbacks) {
+            std::lock_guard<std::mutex> scoped_lock(m_cs);
+
+            for (const auto& cb : m_print_callbacks) {
+                cb(str_prefixed);
+            }
+
+            called_back = true;
+        }
+
+        if (EnqueueMessage(str_prefixed)) {
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> scoped_lock(m_cs);
+
     if (m_buffering) {
         // buffer if we haven't started logging yet
         m_msgs_before_open.push_back(str_prefixed);
         return;
     }
 
+    // Keep the order of any messages queued before the writer stopped:
+    DrainQueue(std::numeric_limits<size_t>::max());
+
+    if (!called_back) {
+        for (const auto& cb : m_print_callbacks) {
+            cb(str_prefixed);
+        }
+    }
+
+    WriteOutputs(str_prefixed);
+}
+
+void BCLog::Logger::WriteOutputs(const std::string& str)
+{
     if (m_print_to_console) {
         // print to console
-        fwrite(str_prefixed.data(), 1, str_prefixed.size(), stdout);
+        fwrite(str.data(), 1, str.size(), stdout);
         fflush(stdout);
     }
-    for (const auto& cb : m_print_callbacks) {
-        cb(str_prefixed);
-    }
     if (m_print_to_file) {
         assert(m_fileout != nullptr);
 
@@ -313,7 +598,7 @@ void BCLog::Logger::LogPrintStr(const std::string& str)
                 m_fileout = new_fileout;
             }
         }
-        FileWriteStr(str_prefixed, m_fileout);
+        FileWriteStr(str, m_fileout);
     }
 }
 
@@ -10,10 +10,13 @@
 #include <tinyformat.h>
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <boost/date_time/posix_time/posix_time.hpp>
@@ -24,6 +27,8 @@ static const bool DEFAULT_LOGTIMEMICROS = false;
 static const bool DEFAULT_LOGIPS        = false;
 static const bool DEFAULT_LOGTIMESTAMPS = true;
 static const bool DEFAULT_LOGTHREADNAMES = false;
+static const bool DEFAULT_LOGASYNC = false;
+static const size_t DEFAULT_LOGQUEUESIZE = 8192;
 extern const char* const DEFAULT_DEBUGLOGFILE;
 
 extern bool fLogIPs;
@@ -83,13 +88,104 @@ namespace BCLog {
         ALL         = ~(uint32_t)0,
     };
 
+    //!
+    //! \brief Bounded, lock-free queue of formatted log messages.
+    //!
+    //! Any number of threads may push messages concurrently without taking a
+    //! lock. Only one thread at a time may pop messages: the logger serializes
+    //! its consumers with its own mutex.
+    //!
+    //! This is the sequence-numbered ring buffer described by Dmitry Vyukov.
+    //! Each slot stores the position that it expects next, so a producer claims
+    //! a slot with one compare-and-swap and publishes the message by advancing
+    //! the slot's sequence number.
+    //!
+    class MessageQueue
+    {
+    public:
+        //!
+        //! \brief Initialize an empty queue.
+        //!
+        //! \param capacity Number of messages that the queue holds. Rounded up
+        //! to the next power of two.
+        //!
+        explicit MessageQueue(size_t capacity);
+
+        //!
+        //! \brief Add a message to the queue if it has room.
+        //!
+        //! \param message Moved into the queue when the call succeeds.
+        //!
+        //! \return \c false if the queue is full.
+        //!
+        bool TryPush(std::string& message);
+
+        //!
+        //! \brief Remove the oldest message from the queue. Single consumer.
+        //!
+        //! \return \c false if the queue contains no published message.
+        //!
+        bool TryPop(std::string& message);
+
+        //!
+        //! \brief Determine whether the consumer would find no message to pop.
+        //!
+        bool Empty() const;
+
+        //!
+        //! \brief Get the number of messages that the queue holds.
+        //!
+        size_t Capacity() const { return m_mask + 1; }
+
+    private:
+        struct Slot
+        {
+            std::atomic<size_t> m_sequence;
+            std::string m_message;
+        };
+
+        const size_t m_mask;
+        std::unique_ptr<Slot[]> m_slots;
+
+        // Keep the positions on separate cache lines to avoid false sharing
+        // between the producers and the consumer:
+        alignas(64) std::atomic<size_t> m_push_pos{0};
+        alignas(64) std::atomic<size_t> m_pop_pos{0};
+    };
+
+    //!
+    //! \brief Determines what a thread does when it logs a message while the
+    //! asynchronous writer's queue is full.
+    //!
+    enum class OverflowPolicy
+    {
+        BLOCK, //!< Wait for the writer thread to make room.
+        DROP,  //!< Discard the message and count it.
+    };
+
     class Logger
     {
     private:
         mutable std::mutex m_cs;                   // Can not use Mutex from sync.h because in debug mode it would cause a deadlock when a potential deadlock was detected
         FILE* m_fileout = nullptr;                 // GUARDED_BY(m_cs)
         std::list<std::string> m_msgs_before_open; // GUARDED_BY(m_cs)
-        bool m_buffering{true};                    //!< Buffer messages before logging can be started. GUARDED_BY(m_cs)
+        std::atomic<bool> m_buffering{true};       //!< Buffer messages before logging can be started. Written under m_cs.
+        std::atomic<bool> m_has_callbacks{false};  //!< Whether m_print_callbacks is not empty. Written under m_cs.
+
+        //! Messages waiting for the writer thread. Consumed under m_cs.
+        std::unique_ptr<MessageQueue> m_queue;
+        std::thread m_writer;
+        std::atomic<bool> m_async{false};
+        std::atomic<bool> m_stop_writer{false};
+        OverflowPolicy m_overflow_policy{OverflowPolicy::BLOCK};
+
+        //! Wakes the writer thread when it sleeps on an empty queue.
+        std::mutex m_writer_mutex;
+        std::condition_variable m_writer_cond;
+        std::atomic<bool> m_writer_sleeping{false};
+
+        std::atomic<uint64_t> m_dropped{0};
+        uint64_t m_dropped_reported{0};            // GUARDED_BY(m_cs)
 
         /**
          * m_started_new_line is a state variable that will suppress printing of
@@ -103,6 +199,17 @@ namespace BCLog {
 
         std::string LogTimestampStr(const std::string& str);
 
+        /** Queue a formatted message for the writer thread. Returns false if the writer does not accept it. */
+        bool EnqueueMessage(std::string& str);
+
+        /** Write formatted text to the console and to the log file. */
+        void WriteOutputs(const std::string& str); // EXCLUSIVE_LOCKS_REQUIRED(m_cs)
+
+        /** Write up to max_count queued messages. Returns the number written. */
+        size_t DrainQueue(size_t max_count); // EXCLUSIVE_LOCKS_REQUIRED(m_cs)
+
+        void WriterThread();
+
         /** Slots that connect to the print signal */
         std::list<std::function<void(const std::string&)>> m_print_callbacks /* GUARDED_BY(m_cs) */ {};
 
@@ -124,8 +231,7 @@ namespace BCLog {
         /** Returns whether logs will be written to any output */
         bool Enabled() const
         {
-            std::lock_guard<std::mutex> scoped_lock(m_cs);
-            return m_buffering || m_print_to_console || m_print_to_file || !m_print_callbacks.empty();
+            return m_buffering || m_print_to_console || m_print_to_file || m_has_callbacks;
         }
 
         /** Connect a slot to the print signal and return the connection */
@@ -133,6 +239,7 @@ namespace BCLog {
         {
             std::lock_guard<std::mutex> scoped_lock(m_cs);
             m_print_callbacks.push_back(std::move(fun));
+            m_has_callbacks = true;
             return --m_print_callbacks.end();
         }
 
@@ -141,6 +248,7 @@ namespace BCLog {
         {
             std::lock_guard<std::mutex> scoped_lock(m_cs);
             m_print_callbacks.erase(it);
+            m_has_callbacks = !m_print_callbacks.empty();
         }
 
         /** Start logging (and flush all buffered messages) */
@@ -148,6 +256,39 @@ namespace BCLog {
         /** Only for testing */
         void DisconnectTestLogger();
 
+        //!
+        //! \brief Move writing to the outputs off the logging threads.
+        //!
+        //! Threads that log a message format it and place it in a lock-free
+        //! queue. A dedicated thread writes the queued messages in batches. The
+        //! print signal slots still run on the logging threads. Call this after
+        //! StartLogging().
+        //!
+        //! \param queue_size Number of messages that the queue holds.
+        //! \param policy     What a thread does when the queue is full.
+        //!
+        void StartAsyncWriter(size_t queue_size, OverflowPolicy policy);
+
+        //!
+        //! \brief Write every queued message, stop the writer thread and return
+        //! to writing on the logging threads.
+        //!
+        void StopAsyncWriter();
+
+        //!
+        //! \brief Write the messages queued so far to the outputs.
+        //!
+        //! Messages that the calling thread logged before the call appear in
+        //! the outputs when it returns.
+        //!
+        void Flush();
+
+        /** Returns whether a writer thread writes the log messages */
+        bool IsAsync() const { return m_async; }
+
+        /** Returns the number of messages discarded because the queue was full */
+        uint64_t GetDroppedCount() const { return m_dropped; }
+
         void ShrinkDebugFile();
 
         bool archive(bool fImmediate, fs::path pfile_out);
@@ -168,6 +309,16 @@ namespace BCLog {
 
 BCLog::Logger& LogInstance();
 
+/**
+ * Flush the log when the process calls exit(). A crash loses the messages still
+ * in the queue: nothing that drains it is safe to run in a signal handler, so
+ * -logasync is off by default.
+ */
+void InstallLogFlushHandlers();
+
+/** Parse an overflow policy name for -logoverflow. Returns false if the name is unknown. */
+bool GetLogOverflowPolicy(BCLog::OverflowPolicy& policy, const std::string& str);
+
 /** Return true if log accepts specified category */
 static inline bool LogAcceptCategory(BCLog::LogFlags category)
 {
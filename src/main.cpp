@@ -6,8 +6,10 @@
 #include "amount.h"
 #include "chainparams.h"
 #include "consensus/merkle.h"
+#include "crypto/common.h"
 #include "gridcoin/voting/registry.h"
 #include "util.h"
+#include "util/trace.h"
 #include "net.h"
 #include "streams.h"
 #include "alert.h"
@@ -18,6 +20,7 @@
 #include "gridcoin/beacon.h"
 #include "gridcoin/claim.h"
 #include "gridcoin/mrc.h"
+#include "gridcoin/contract/cache.h"
 #include "gridcoin/contract/contract.h"
 #include "gridcoin/contract/registry.h"
 #include "gridcoin/project.h"
@@ -35,6 +38,7 @@
 #include "gridcoin/tally.h"
 #include "gridcoin/tx_message.h"
 #include "node/blockstorage.h"
+#include "node/prune.h"
 #include "policy/fees.h"
 #include "policy/policy.h"
 #include "random.h"
@@ -44,7 +48,9 @@
 #include <boost/thread.hpp>
 #include <boost/range/adaptor/reversed.hpp>
 #include <ctime>
+#include <future>
 #include <math.h>
+#include <thread>
 
 extern bool AskForOutstandingBlocks(uint256 hashStart);
 extern bool GridcoinServices();
@@ -64,8 +70,6 @@ set<CWallet*> setpwalletRegistered;
 CCriticalSection cs_main;
 CCriticalSection cs_tx_val_commit_to_disk;
 
-CTxMemPool mempool;
-
 ///////////////////////MINOR VERSION////////////////////////////////
 
 extern int64_t GetCoinYearReward(int64_t nTime);
@@ -339,6 +343,10 @@ int CMerkleTx::SetMerkleBranch(const CBlock* pblock) EXCLUSIVE_LOCKS_REQUIRED(cs
         pblock = &blockTmp;
     }
 
+    // Pruning keeps only some transactions of a block with the original
+    // header, so the position of the tx in the stub means nothing:
+    const bool fRelocated = pblock == &blockTmp && IsRelocatedBlock(blockTmp);
+
     // Update the tx's hashBlock
     hashBlock = pblock->GetHash(true);
 
@@ -352,6 +360,8 @@ int CMerkleTx::SetMerkleBranch(const CBlock* pblock) EXCLUSIVE_LOCKS_REQUIRED(cs
         LogPrintf("ERROR: SetMerkleBranch() : couldn't find tx in block");
         return 0;
     }
+    if (fRelocated)
+        nIndex = -1;
 
     // Is the tx in a block that's in the main chain
     BlockMap::iterator mi = mapBlockIndex.find(hashBlock);
@@ -406,13 +416,9 @@ bool AcceptToMemoryPool(CTxMemPool& pool, CTransaction &tx, bool* pfMissingInput
     if (pool.exists(hash))
         return false;
 
-    // is there already a transaction in the mempool that has a MRC contract with the same CPID?
-    //
-    // Note: I really hate this check because it has to iterate over the entire mempool to look for an offender,
-    // but I am sufficiently concerned about MRC DoS that it is necessary to stop duplicate MRC request transactions
-    // from the same CPID in the accept to memory pool stage.
-    //
-    // We have implemented a bloom filter to help with the overhead.
+    // is there already a transaction in the mempool that has a MRC contract with the same CPID? The memory pool
+    // indexes MRC transactions by CPID so that duplicate MRC requests from the same CPID are stopped at the accept to
+    // memory pool stage without iterating over the entire mempool.
     bool tx_contains_valid_mrc = false;
 
     for (const auto& contract : tx.GetContracts()) {
@@ -420,52 +426,18 @@ bool AcceptToMemoryPool(CTxMemPool& pool, CTransaction &tx, bool* pfMissingInput
             GRC::MRC mrc = contract.CopyPayloadAs<GRC::MRC>();
 
             GRC::Cpid cpid = *(mrc.m_mining_id.TryCpid());
-            // A small bloom filter based on the last and first byte of CPID.
-            uint64_t k = 1 << (cpid.Raw().front() & 0x3F);
-            k |= 1 << (cpid.Raw().back() & 0x3F);
-
-            if ((mempool.m_mrc_bloom & k) != k) {
-                // The cpid definitely does not exist in the mempool.
-                mempool.m_mrc_bloom |= k;
-                tx_contains_valid_mrc = true;
-
-                continue;
-            }
-            // The cpid might exist in the mempool.
-
-            if (mempool.m_mrc_bloom_dirty) {
-                mempool.m_mrc_bloom = 0;
+            uint256 pool_tx_hash;
+
+            // A transaction already in the mempool already has the same CPID as the incoming transaction.
+            // Reject and put a stiff DoS...
+            if (pool.GetMRCForCpid(cpid, pool_tx_hash)) {
+                return tx.DoS(25, error("%s: MRC contract in tx %s has the same CPID as an existing transaction "
+                                        "in the memory pool, %s.",
+                                        __func__,
+                                        tx.GetHash().ToString(),
+                                        pool_tx_hash.ToString()));
             }
 
-            bool found{false};
-            for (const auto& [_, pool_tx] : mempool.mapTx) {
-                for (const auto& pool_tx_contract : pool_tx.GetContracts()) {
-                    if (pool_tx_contract.m_type == GRC::ContractType::MRC) {
-                        GRC::MRC pool_tx_mrc = pool_tx_contract.CopyPayloadAs<GRC::MRC>();
-
-                        GRC::Cpid other_cpid = *(pool_tx_mrc.m_mining_id.TryCpid());
-                        mempool.m_mrc_bloom |= 1 << (other_cpid.Raw().front() & 0x3F);
-                        mempool.m_mrc_bloom |= 1 << (other_cpid.Raw().back() & 0x3F);
-
-                        // A transaction already in the mempool already has the same CPID as the incoming transaction.
-                        // Reject and put a stiff DoS...
-                        if (!found && cpid == other_cpid) {
-                            found = true;
-                            tx.DoS(25, error("%s: MRC contract in tx %s has the same CPID as an existing transaction "
-                                             "in the memory pool, %s.",
-                                             __func__,
-                                             tx.GetHash().ToString(),
-                                             pool_tx.GetHash().ToString()));
-
-                            if (!mempool.m_mrc_bloom_dirty) return false;
-                        }
-                    }
-                }
-            }
-
-            mempool.m_mrc_bloom_dirty = false;
-            if (found) return false;
-
             tx_contains_valid_mrc = true;
         }
     }
@@ -501,6 +473,8 @@ bool AcceptToMemoryPool(CTxMemPool& pool, CTransaction &tx, bool* pfMissingInput
         }
     }
 
+    CAmount nFees = 0;
+
     {
         CTxDB txdb("r");
 
@@ -528,7 +502,7 @@ bool AcceptToMemoryPool(CTxMemPool& pool, CTransaction &tx, bool* pfMissingInput
         // you should add code here to check that the transaction does a
         // reasonable number of ECDSA signature verifications.
 
-        CAmount nFees = GetValueIn(tx, mapInputs) - tx.GetValueOut();
+        nFees = GetValueIn(tx, mapInputs) - tx.GetValueOut();
         unsigned int nSize = ::GetSerializeSize(tx, SER_NETWORK, PROTOCOL_VERSION);
 
         // Don't accept it if it can't get into a block
@@ -553,11 +527,6 @@ bool AcceptToMemoryPool(CTxMemPool& pool, CTransaction &tx, bool* pfMissingInput
 
             return false;
         }
-
-        // If we accepted a transaction with a valid mrc contract, then signal MRC changed.
-        if (tx_contains_valid_mrc) {
-            uiInterface.MRCChanged();
-        }
     }
 
     // Store transaction in memory
@@ -568,7 +537,29 @@ bool AcceptToMemoryPool(CTxMemPool& pool, CTransaction &tx, bool* pfMissingInput
             LogPrint(BCLog::LogFlags::MEMPOOL, "AcceptToMemoryPool : replacing tx %s with new version", ptxOld->GetHash().ToString());
             pool.remove(*ptxOld);
         }
-        pool.addUnchecked(hash, tx);
+        pool.addUnchecked(hash, tx, nFees);
+
+        // Keep the memory pool within its configured size. Once it outgrows the limit, the transactions with the
+        // lowest fee rate are evicted with their descendants until the pool fits again. Expired transactions are
+        // removed on a timer by ExpireMempool():
+        const size_t max_usage = gArgs.GetArg("-maxmempool", DEFAULT_MAX_MEMPOOL_SIZE) * 1000000;
+
+        if (pool.DynamicMemoryUsage() > max_usage) {
+            std::vector<uint256> evicted;
+            pool.TrimToSize(max_usage, &evicted);
+
+            LogPrint(BCLog::LogFlags::MEMPOOL, "AcceptToMemoryPool : evicted %" PRIszu " transactions to stay under "
+                     "the memory pool size limit", evicted.size());
+        }
+
+        if (!pool.exists(hash)) {
+            return error("AcceptToMemoryPool : %s: mempool full", hash.ToString());
+        }
+    }
+
+    // If we accepted a transaction with a valid mrc contract, then signal MRC changed.
+    if (tx_contains_valid_mrc) {
+        uiInterface.MRCChanged();
     }
 
     ///// are we sure this is ok when loading transactions or restoring block txes
@@ -581,75 +572,17 @@ bool AcceptToMemoryPool(CTxMemPool& pool, CTransaction &tx, bool* pfMissingInput
     return true;
 }
 
-bool CTxMemPool::addUnchecked(const uint256& hash, CTransaction &tx)
+void ExpireMempool(CTxMemPool& pool)
 {
-    // Add to memory pool without checking anything.  Don't call this directly,
-    // call AcceptToMemoryPool to properly check the transaction first.
-    {
-        mapTx[hash] = tx;
-        for (unsigned int i = 0; i < tx.vin.size(); i++)
-            mapNextTx[tx.vin[i].prevout] = CInPoint(&mapTx[hash], i);
-    }
-    return true;
-}
+    // Expire() removes the descendants of the expired transactions as well. Take cs_main so that the removal does
+    // not interleave with a transaction that AcceptToMemoryPool() is connecting to its in-pool parents:
+    LOCK(cs_main);
 
+    const size_t expired = pool.Expire(GetTime() - gArgs.GetArg("-mempoolexpiry", DEFAULT_MEMPOOL_EXPIRY) * 60 * 60);
 
-bool CTxMemPool::remove(const CTransaction &tx, bool fRecursive)
-{
-    m_mrc_bloom_dirty = true;
-    // Remove transaction from memory pool
-    {
-        LOCK(cs);
-        uint256 hash = tx.GetHash();
-        if (mapTx.count(hash))
-        {
-            if (fRecursive) {
-                for (unsigned int i = 0; i < tx.vout.size(); i++) {
-                    std::map<COutPoint, CInPoint>::iterator it = mapNextTx.find(COutPoint(hash, i));
-                    if (it != mapNextTx.end())
-                        remove(*it->second.ptx, true);
-                }
-            }
-            for (auto const& txin : tx.vin)
-                mapNextTx.erase(txin.prevout);
-            mapTx.erase(hash);
-        }
-    }
-    return true;
-}
-
-bool CTxMemPool::removeConflicts(const CTransaction &tx)
-{
-    m_mrc_bloom_dirty = true;
-    // Remove transactions which depend on inputs of tx, recursively
-    LOCK(cs);
-    for (auto const &txin : tx.vin)
-    {
-        std::map<COutPoint, CInPoint>::iterator it = mapNextTx.find(txin.prevout);
-        if (it != mapNextTx.end()) {
-            const CTransaction &txConflict = *it->second.ptx;
-            if (txConflict != tx)
-                remove(txConflict, true);
-        }
+    if (expired > 0) {
+        LogPrint(BCLog::LogFlags::MEMPOOL, "%s: removed %" PRIszu " expired transactions", __func__, expired);
     }
-    return true;
-}
-
-void CTxMemPool::clear()
-{
-    LOCK(cs);
-    mapTx.clear();
-    mapNextTx.clear();
-}
-
-void CTxMemPool::queryHashes(std::vector<uint256>& vtxid)
-{
-    vtxid.clear();
-
-    LOCK(cs);
-    vtxid.reserve(mapTx.size());
-    for (map<uint256, CTransaction>::iterator mi = mapTx.begin(); mi != mapTx.end(); ++mi)
-        vtxid.push_back(mi->first);
 }
 
 int CMerkleTx::GetDepthInMainChainINTERNAL(CBlockIndex* &pindexRet) const EXCLUSIVE_LOCKS_REQUIRED(cs_main)
@@ -1051,6 +984,8 @@ bool DisconnectBlocksBatch(CTxDB& txdb, list<CTransaction>& vResurrect, unsigned
 bool ReorganizeChain(CTxDB& txdb, unsigned &cnt_dis, unsigned &cnt_con, CBlock &blockNew, CBlockIndex* pindexNew)
 EXCLUSIVE_LOCKS_REQUIRED(cs_main)
 {
+    TRACE_SPAN("ReorganizeChain");
+
     assert(pindexNew);
     assert(pindexNew->GetBlockHash()==blockNew.GetHash(true));
     /* note: it was already determined that this chain is better than current best */
@@ -1197,13 +1132,19 @@ EXCLUSIVE_LOCKS_REQUIRED(cs_main)
             // AcceptToMemoryPool. Here we just need to do a staleness check.
             std::vector<CTransaction> to_be_erased;
 
-            for (const auto& [_, pool_tx] : mempool.mapTx) {
-                for (const auto& pool_tx_contract : pool_tx.GetContracts()) {
-                    if (pool_tx_contract.m_type == GRC::ContractType::MRC) {
-                        GRC::MRC pool_tx_mrc = pool_tx_contract.CopyPayloadAs<GRC::MRC>();
+            {
+                LOCK(mempool.cs);
+
+                for (const auto& pool_tx_hash : mempool.GetByContractType(GRC::ContractType::MRC)) {
+                    const CTransaction& pool_tx = mempool.GetEntry(pool_tx_hash)->GetTx();
 
-                        if (pool_tx_mrc.m_last_block_hash != hashBestChain) {
-                            to_be_erased.push_back(pool_tx);
+                    for (const auto& pool_tx_contract : pool_tx.GetContracts()) {
+                        if (pool_tx_contract.m_type == GRC::ContractType::MRC) {
+                            GRC::MRC pool_tx_mrc = pool_tx_contract.CopyPayloadAs<GRC::MRC>();
+
+                            if (pool_tx_mrc.m_last_block_hash != hashBestChain) {
+                                to_be_erased.push_back(pool_tx);
+                            }
                         }
                     }
                 }
@@ -1349,6 +1290,11 @@ bool SetBestChain(CTxDB& txdb, CBlock &blockNew, CBlockIndex* pindexNew) EXCLUSI
         pindexNew->GetBlockTime(),
         blockNew.nBits);
 
+    // A failed prune leaves the block files in place. The chain is fine:
+    if (!PruneBlockFiles(txdb)) {
+        LogPrintf("WARNING: %s: failed to prune the block files", __func__);
+    }
+
     return GridcoinServices();
 }
 
@@ -1462,6 +1408,10 @@ bool ProcessBlock(CNode* pfrom, CBlock* pblock, bool generated_by_me) EXCLUSIVE_
 {
     AssertLockHeld(cs_main);
 
+    // The block is complete at this point, so the checks below and the block
+    // connection can share the transaction hashes:
+    pblock->CacheTxHashes();
+
     // Check for duplicate
     uint256 hash = pblock->GetHash(true);
     if (mapBlockIndex.count(hash))
@@ -1585,7 +1535,7 @@ bool CheckDiskSpace(uint64_t nAdditionalBytes)
     return true;
 }
 
-static fs::path BlockFilePath(unsigned int nFile)
+fs::path BlockFilePath(unsigned int nFile)
 {
     string strBlockFn = strprintf("blk%04u.dat", nFile);
     return GetDataDir() / strBlockFn;
@@ -1616,13 +1566,24 @@ FILE* AppendBlockFile(unsigned int& nFileRet)
     nFileRet = 0;
     while (true)
     {
+        // Never recreate a file that pruning deleted:
+        if (IsBlockFilePruned(nCurrentBlockFile))
+        {
+            nCurrentBlockFile++;
+            continue;
+        }
         FILE* file = OpenBlockFile(nCurrentBlockFile, 0, "ab");
         if (!file)
             return nullptr;
         if (fseek(file, 0, SEEK_END) != 0)
             return nullptr;
-        // FAT32 file size max 4GB, fseek and ftell max 2GB, so we must stay under 2GB
-        if (ftell(file) < (long)(0x7F000000 - MAX_SIZE))
+        if (ftell(file) == 0 && !WriteBlockFileHeader(nCurrentBlockFile, file))
+        {
+            fclose(file);
+            return nullptr;
+        }
+        // A converted file ends with the table of its block positions:
+        if (ftell(file) < (long)(GetMaxBlockFileSize() - MAX_SIZE) && !IsConvertedBlockFile(nCurrentBlockFile))
         {
             nFileRet = nCurrentBlockFile;
             return file;
@@ -1652,6 +1613,8 @@ bool LoadBlockIndex(bool fAllowNew)
     // Load block index
     //
     CTxDB txdb("cr+");
+    if (!LoadPrunedBlockFiles(txdb))
+        return false;
     if (!txdb.LoadBlockIndex())
         return false;
 
@@ -1841,6 +1804,92 @@ void PrintBlockTree() EXCLUSIVE_LOCKS_REQUIRED(cs_main)
     }
 }
 
+//!
+//! \brief Number of blocks that each worker thread deserializes ahead of the
+//! validation of an import.
+//!
+static constexpr size_t IMPORT_BLOCKS_PER_THREAD = 16;
+
+//!
+//! \brief Maximum number of threads that deserialize imported blocks.
+//!
+static constexpr size_t MAX_IMPORT_THREADS = 8;
+
+std::vector<ImportedBlock> ReadImportWindow(BlockFileReader& reader, const size_t threads)
+{
+    std::vector<ImportedBlock> window;
+
+    while (window.empty()) {
+        window.resize(threads * IMPORT_BLOCKS_PER_THREAD);
+        size_t count = 0;
+
+        while (count < window.size() && reader.Next(window[count].m_pos, window[count].m_data)) {
+            ++count;
+        }
+
+        if (count == 0) {
+            return { };
+        }
+
+        window.resize(count);
+
+        std::atomic<size_t> next { 0 };
+
+        const auto worker = [&]() {
+            for (size_t i = next++; i < window.size(); i = next++) {
+                ImportedBlock& item = window[i];
+
+                try {
+                    CDataStream stream(MakeByteSpan(item.m_data), SER_DISK, CLIENT_VERSION);
+                    stream >> item.m_block;
+                    item.m_valid = true;
+
+                    // The size of the record covers more than the block. The
+                    // rest may hold the next blocks:
+                    if (!stream.empty()) {
+                        item.m_resync_pos = item.m_pos + item.m_data.size() - stream.size();
+                    }
+                } catch (const std::exception& e) {
+                    LogPrintf("WARNING: %s: failed to deserialize block at %u: %s", __func__, item.m_pos, e.what());
+                    item.m_resync_pos = item.m_pos;
+                    continue;
+                }
+
+                std::vector<unsigned char>().swap(item.m_data);
+
+                item.m_block.CacheTxHashes();
+                item.m_block.GetHash(true);
+            }
+        };
+
+        std::vector<std::thread> pool;
+
+        for (size_t t = 1; t < std::min(threads, window.size()); ++t) {
+            pool.emplace_back(worker);
+        }
+
+        worker();
+
+        for (auto& thread : pool) {
+            thread.join();
+        }
+
+        // A record with a corrupt size may swallow the blocks after it. Read
+        // the file again from the data of the first such record and drop the
+        // blocks found after it:
+        const auto corrupt = std::find_if(window.begin(), window.end(), [](const ImportedBlock& item) {
+            return item.m_resync_pos != 0;
+        });
+
+        if (corrupt != window.end()) {
+            reader.Resync(corrupt->m_resync_pos);
+            window.erase(corrupt->m_valid ? corrupt + 1 : corrupt, window.end());
+        }
+    }
+
+    return window;
+}
+
 bool LoadExternalBlockFile(FILE* fileIn, size_t file_size, unsigned int percent_start, unsigned int percent_end)
 {
     int64_t nStart = GetTimeMillis();
@@ -1853,79 +1902,73 @@ bool LoadExternalBlockFile(FILE* fileIn, size_t file_size, unsigned int percent_
         uiInterface.InitMessage(_("Block file load progress ") + ToString(percent_start) + "%");
     }
 
-    {
-        LOCK(cs_main);
-        try {
-            CAutoFile blkdat(fileIn, SER_DISK, CLIENT_VERSION);
-            unsigned int nPos = 0;
-            while (nPos != (unsigned int)-1 && !fRequestShutdown)
-            {
-                unsigned char pchData[65536];
-                do {
-                    fseek(blkdat.Get(), nPos, SEEK_SET);
-                    int nRead = fread(pchData, 1, sizeof(pchData), blkdat.Get());
-                    if (nRead <= 8)
-                    {
-                        nPos = (unsigned int)-1;
-                        break;
-                    }
-                    void* nFind = memchr(pchData, Params().MessageStart()[0], nRead + 1 - CMessageHeader::MESSAGE_START_SIZE);
-                    if (nFind)
-                    {
-                        if (memcmp(nFind, Params().MessageStart(), CMessageHeader::MESSAGE_START_SIZE) == 0)
-                        {
-                            nPos += ((unsigned char*)nFind - pchData) + CMessageHeader::MESSAGE_START_SIZE;
-                            break;
-                        }
-                        nPos += ((unsigned char*)nFind - pchData) + 1;
-                    }
-                    else
-                        nPos += sizeof(pchData) - CMessageHeader::MESSAGE_START_SIZE + 1;
-                } while(!fRequestShutdown);
+    // The import runs as a pipeline: a prefetch thread reads the next window
+    // of blocks from the file and deserializes them with a pool of workers
+    // while this thread validates the current window. Only validation holds
+    // cs_main, one block at a time, so the node stays responsive.
+    const size_t threads = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, MAX_IMPORT_THREADS);
 
-                if (nPos == (unsigned int)-1) {
-                    if (display_progress) {
-                        uiInterface.InitMessage(_("Block file load progress ") + ToString(percent_end) + "%");
-                    }
+    CAutoFile blkdat(fileIn, SER_DISK, CLIENT_VERSION);
+    BlockFileReader reader(blkdat.Get());
+
+    try {
+        std::vector<ImportedBlock> window = ReadImportWindow(reader, threads);
 
+        while (!window.empty() && !fRequestShutdown) {
+            std::future<std::vector<ImportedBlock>> prefetch = std::async(
+                std::launch::async,
+                ReadImportWindow,
+                std::ref(reader),
+                threads);
+
+            for (ImportedBlock& item : window) {
+                if (fRequestShutdown) {
                     break;
                 }
 
-                fseek(blkdat.Get(), nPos, SEEK_SET);
-                unsigned int nSize;
-                blkdat >> nSize;
-                if (nSize > 0 && nSize <= MAX_BLOCK_SIZE)
+                if (!item.m_valid) {
+                    continue;
+                }
+
+                bool processed;
+
                 {
-                    CBlock block;
-                    blkdat >> block;
-                    if (ProcessBlock(nullptr, &block, false)) {
-                        ++nLoaded;
+                    LOCK(cs_main);
+                    processed = ProcessBlock(nullptr, &item.m_block, false);
+                }
 
-                        if (display_progress) {
-                            unsigned int percent_progress = percent_start + (uint64_t) nPos
-                                    * (uint64_t) (percent_end - percent_start) / file_size;
+                if (!processed) {
+                    continue;
+                }
 
-                            if (percent_progress != cached_percent_progress) {
-                                uiInterface.InitMessage(_("Block file load progress ") + ToString(percent_progress) + "%");
-                                LogPrintf("INFO: %s: blocks/s: %f, progress: %u%%", __func__,
-                                          nLoaded / ((GetTimeMillis() - nStart) / 1000.0), percent_progress);
+                ++nLoaded;
 
-                                cached_percent_progress = percent_progress;
-                            }
-                        } else if (nLoaded % 10000 == 0) {
-                            LogPrintf("Blocks/s: %f", nLoaded / ((GetTimeMillis() - nStart) / 1000.0));
-                        }
+                if (display_progress) {
+                    unsigned int percent_progress = percent_start + item.m_pos
+                            * (uint64_t) (percent_end - percent_start) / file_size;
+
+                    if (percent_progress != cached_percent_progress) {
+                        uiInterface.InitMessage(_("Block file load progress ") + ToString(percent_progress) + "%");
+                        LogPrintf("INFO: %s: blocks/s: %f, progress: %u%%", __func__,
+                                  nLoaded / ((GetTimeMillis() - nStart) / 1000.0), percent_progress);
 
-                        nPos += 4 + nSize;
+                        cached_percent_progress = percent_progress;
                     }
+                } else if (nLoaded % 10000 == 0) {
+                    LogPrintf("Blocks/s: %f", nLoaded / ((GetTimeMillis() - nStart) / 1000.0));
                 }
             }
+
+            window = prefetch.get();
         }
-        catch (std::exception &e) {
-            LogPrintf("%s() : Deserialize or I/O error caught during load",
-                   __PRETTY_FUNCTION__);
-        }
+    } catch (const std::exception& e) {
+        LogPrintf("%s: I/O error caught during load: %s", __func__, e.what());
     }
+
+    if (display_progress && !fRequestShutdown) {
+        uiInterface.InitMessage(_("Block file load progress ") + ToString(percent_end) + "%");
+    }
+
     LogPrintf("Loaded %i blocks from external file in %" PRId64 "ms", nLoaded, GetTimeMillis() - nStart);
     return nLoaded > 0;
 }
@@ -2368,7 +2411,11 @@ bool static ProcessMessage(CNode* pfrom, string strCommand, CDataStream& vRecv,
             {
                 // Send block from disk
                 BlockMap::iterator mi = mapBlockIndex.find(inv.hash);
-                if (mi != mapBlockIndex.end())
+                if (mi != mapBlockIndex.end() && IsBlockPruned(mi->second))
+                {
+                    LogPrint(BCLog::LogFlags::NET, "getdata: block %s is pruned", inv.hash.ToString());
+                }
+                else if (mi != mapBlockIndex.end())
                 {
                     CBlock block;
                     ReadBlockFromDisk(block, mi->second, Params().GetConsensus());
@@ -2499,6 +2546,11 @@ bool static ProcessMessage(CNode* pfrom, string strCommand, CDataStream& vRecv,
                     pfrom->PushInventory(CInv(MSG_BLOCK, hashBestChain));
                 break;
             }
+            if (IsBlockPruned(pindex))
+            {
+                LogPrint(BCLog::LogFlags::NET, "getblocks stopping at pruned block %d", pindex->nHeight);
+                break;
+            }
             pfrom->PushInventory(CInv(MSG_BLOCK, pindex->GetBlockHash()));
             if (--nLimit <= 0)
             {
@@ -2552,6 +2604,7 @@ bool static ProcessMessage(CNode* pfrom, string strCommand, CDataStream& vRecv,
         vector<uint256> vEraseQueue;
         CTransaction tx;
         vRecv >> tx;
+        tx.CacheHash();
 
         CInv inv(MSG_TX, tx.GetHash());
         pfrom->AddInventoryKnown(inv);
@@ -3128,15 +3181,23 @@ bool SendMessages(CNode* pto, bool fSendTrickle)
 
 GRC::ClaimOption GetClaimByIndex(const CBlockIndex* const pblockindex)
 {
+    if (!pblockindex || !pblockindex->IsInMainChain()) {
+        return std::nullopt;
+    }
+
+    // The tally, the vote weight calculation, and the superblock reports
+    // read the claims of the same blocks again:
+    if (const auto claim = GRC::GetContractCache().FindClaim(pblockindex->GetBlockHash())) {
+        return *claim;
+    }
+
     CBlock block;
 
-    if (!pblockindex || !pblockindex->IsInMainChain()
-        || !ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
-    {
+    if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus())) {
         return std::nullopt;
     }
 
-    return block.PullClaim();
+    return *GRC::GetContractCache().StoreClaim(pblockindex->GetBlockHash(), block.PullClaim());
 }
 
 GRC::MintSummary CBlock::GetMint() const EXCLUSIVE_LOCKS_REQUIRED(cs_main)
@@ -3144,6 +3205,12 @@ GRC::MintSummary CBlock::GetMint() const EXCLUSIVE_LOCKS_REQUIRED(cs_main)
     AssertLockHeld(cs_main);
 
     CTxDB txdb("r");
+
+    return GetMint(txdb);
+}
+
+GRC::MintSummary CBlock::GetMint(CTxDB& txdb) const
+{
     GRC::MintSummary mint;
 
     for (const auto& tx : vtx) {
@@ -20,6 +20,7 @@
 #include "sync.h"
 #include "script.h"
 #include "scrypt.h"
+#include "txmempool.h"
 #include "validation.h"
 
 #include <map>
@@ -27,6 +28,7 @@
 #include <set>
 
 class CWallet;
+class BlockFileReader;
 class CBlock;
 class CBlockIndex;
 class CKeyItem;
@@ -36,7 +38,6 @@ class CAddress;
 class CBitcoinAddress;
 class CInv;
 class CNode;
-class CTxMemPool;
 
 namespace GRC {
 class Claim;
@@ -120,6 +121,7 @@ void SyncWithWallets(const CTransaction& tx, const CBlock* pblock = nullptr, boo
 void UpdatedTransaction(const uint256& hashTx);
 bool ProcessBlock(CNode* pfrom, CBlock* pblock, bool Generated_By_Me);
 bool CheckDiskSpace(uint64_t nAdditionalBytes=0);
+fs::path BlockFilePath(unsigned int nFile);
 FILE* OpenBlockFile(unsigned int nFile, unsigned int nBlockPos, const char* pszMode="rb");
 FILE* AppendBlockFile(unsigned int& nFileRet);
 bool LoadBlockIndex(bool fAllowNew=true);
@@ -143,6 +145,8 @@ bool OutOfSyncByAge();
 /** (try to) add transaction to memory pool **/
 bool AcceptToMemoryPool(CTxMemPool& pool, CTransaction &tx,
                         bool* pfMissingInputs);
+/** Remove the transactions older than -mempoolexpiry hours from the memory pool. Runs on the scheduler. **/
+void ExpireMempool(CTxMemPool& pool);
 bool SetBestChain(CTxDB& txdb, CBlock &blockNew, CBlockIndex* pindexNew);
 
 
@@ -406,6 +410,7 @@ public:
     GRC::SuperblockPtr GetSuperblock() const;
     GRC::SuperblockPtr GetSuperblock(const CBlockIndex* const pindex) const;
     GRC::MintSummary GetMint() const;
+    GRC::MintSummary GetMint(CTxDB& txdb) const;
     GRC::MRCFees GetMRCFees() const;
 
     // entropy bit for stake modifier if chosen by modifier
@@ -429,6 +434,17 @@ public:
         return !IsProofOfStake();
     }
 
+    //!
+    //! \brief Cache the hash of each transaction once the block can no longer
+    //! change. See CTransaction::CacheHash().
+    //!
+    void CacheTxHashes()
+    {
+        for (auto& tx : vtx) {
+            tx.CacheHash();
+        }
+    }
+
     // ppcoin: get max transaction timestamp
     int64_t GetMaxTransactionTime() const
     {
@@ -457,6 +473,33 @@ public:
     }
 };
 
+//!
+//! \brief A block found in a block file by the import reader.
+//!
+struct ImportedBlock
+{
+    uint64_t m_pos = 0;                 //!< File position of the stored block.
+    std::vector<unsigned char> m_data;  //!< Serialized block. Empty after deserialization.
+    CBlock m_block;
+    bool m_valid = false;               //!< Whether the block deserialized.
+    uint64_t m_resync_pos = 0;          //!< Where to read the file again after a corrupt size, or zero.
+};
+
+//!
+//! \brief Read the next blocks of a file and deserialize them using the
+//! specified number of threads.
+//!
+//! Workers also cache the block and transaction hashes so that validation
+//! does not compute them under \c cs_main.
+//!
+//! When the size of a record does not match the block in it, the reader
+//! continues from the data of that record and the window ends there, so a
+//! corrupt size does not swallow the blocks after it.
+//!
+//! \return The blocks in file order. Empty at the end of the file.
+//!
+std::vector<ImportedBlock> ReadImportWindow(BlockFileReader& reader, size_t threads);
+
 /** The block chain is a tree shaped structure starting with the
  * genesis block at the root, with each block potentially having multiple
  * candidates to be the next block.  pprev and pnext link a path through the
@@ -1100,47 +1143,4 @@ public:
     }
 };
 
-
-
-
-
-
-class CTxMemPool
-{
-public:
-    mutable CCriticalSection cs;
-    std::map<uint256, CTransaction> mapTx;
-    std::map<COutPoint, CInPoint> mapNextTx;
-    uint64_t m_mrc_bloom{0};
-    bool m_mrc_bloom_dirty{false};
-
-    bool addUnchecked(const uint256& hash, CTransaction &tx);
-    bool remove(const CTransaction &tx, bool fRecursive = false);
-    bool removeConflicts(const CTransaction &tx);
-    void clear();
-    void queryHashes(std::vector<uint256>& vtxid);
-
-    unsigned long size() const
-    {
-        LOCK(cs);
-        return mapTx.size();
-    }
-
-    bool exists(uint256 hash) const
-    {
-        LOCK(cs);
-        return (mapTx.count(hash) != 0);
-    }
-
-    bool lookup(uint256 hash, CTransaction& result) const
-    {
-        LOCK(cs);
-        std::map<uint256, CTransaction>::const_iterator i = mapTx.find(hash);
-        if (i == mapTx.end()) return false;
-        result = i->second;
-        return true;
-    }
-};
-
-extern CTxMemPool mempool;
 #endif
@@ -18,6 +18,7 @@
 #include "gridcoin/researcher.h"
 #include "gridcoin/staking/difficulty.h"
 #include "gridcoin/staking/kernel.h"
+#include "gridcoin/staking/kernel_search.h"
 #include "gridcoin/staking/reward.h"
 #include "gridcoin/staking/status.h"
 #include "gridcoin/tally.h"
@@ -25,6 +26,7 @@
 #include "policy/fees.h"
 #include "random.h"
 #include "util.h"
+#include "util/trace.h"
 #include "validation.h"
 #include "wallet/wallet.h"
 
@@ -41,27 +43,6 @@ using namespace std;
 unsigned int nMinerSleep;
 
 namespace {
-class COrphan
-{
-public:
-    CTransaction* ptx;
-    set<uint256> setDependsOn;
-    double dFeePerKb;
-
-    COrphan(CTransaction* ptxIn)
-    {
-        ptx = ptxIn;
-        dFeePerKb = 0;
-    }
-
-    void print() const
-    {
-        LogPrintf("COrphan(hash=%s, dFeePerKb=%.1f)",
-               ptx->GetHash().ToString().substr(0,10), dFeePerKb);
-        for (auto const& hash : setDependsOn)
-            LogPrintf("   setDependsOn %s", hash.ToString().substr(0,10));
-    }
-};
 
 //!
 //! \brief Sign the research reward claim context for a newly-minted block.
@@ -364,108 +345,18 @@ bool CreateRestOfTheBlock(CBlock &block, CBlockIndex* pindexPrev,
         LOCK2(cs_main, mempool.cs);
         CTxDB txdb("r");
 
-        // Priority order to process transactions
-        list<COrphan> vOrphan; // list memory doesn't move
-        map<uint256, vector<COrphan*> > mapDependers;
+        // The memory pool maintains its entries in descending order of ancestor score: the fee rate of the package of
+        // a transaction and its in-pool ancestors. Each transaction is added together with its ancestors that are not
+        // in the block yet, so a child that pays a high fee also pays for its parents. Once a package is in the block,
+        // the packages of its descendants shrink. Those are re-scored in modified_scores, which is merged with the
+        // index, and their stale index entries are skipped.
+        const CTxMemPool::FeeRateIndex& by_ancestor_score = mempool.GetByAncestorScore();
+        CTxMemPool::FeeRateIndex::const_iterator next_by_score = by_ancestor_score.begin();
 
-        // This vector will be sorted into a priority queue:
-        std::vector<std::pair<double, CTransaction*>> vecPriority;
-        vecPriority.reserve(mempool.mapTx.size());
-
-        Fraction foundation_fee_fraction = FoundationSideStakeAllocation();
-
-        for (auto& [_, tx] : mempool.mapTx)
-        {
-            if (tx.IsCoinBase() || tx.IsCoinStake() || !IsFinalTx(tx, nHeight))
-                continue;
-
-            // Double-check that contracts pass contextual validation again so
-            // that we don't include a transaction that disrupts validation of
-            // the block. Note that this is especially important now that there
-            // are block level rules that cannot be checked for transactions
-            // that are just in the mempool. Note that the only block level rules
-            // currently implemented depend on block height only, so the
-            // pindex_contract_validate only has the block height filled out.
-            //
-            int DoS = 0; // Unused here.
-            if (!tx.GetContracts().empty() && !GRC::BlockValidateContracts(&pindex_contract_validate, tx, DoS)) {
-                LogPrint(BCLog::LogFlags::MINER,
-                    "%s: contract failed contextual validation. Skipped tx %s",
-                    __func__,
-                    tx.GetHash().ToString());
-
-                continue;
-            }
-
-            COrphan* porphan = nullptr;
-            int64_t nTotalIn = 0;
-            bool fMissingInputs = false;
-
-            for (auto const& txin : tx.vin)
-            {
-                // Read prev transaction
-                CTransaction txPrev;
-                CTxIndex txindex;
-
-                LogPrint(BCLog::LogFlags::NOISY, "Enumerating tx %s ",tx.GetHash().GetHex());
-
-                if (!ReadTxFromDisk(txPrev, txdb, txin.prevout, txindex))
-                {
-                    // This should never happen; all transactions in the memory
-                    // pool should connect to either transactions in the chain
-                    // or other transactions in the memory pool.
-                    if (!mempool.mapTx.count(txin.prevout.hash))
-                    {
-                        LogPrintf("ERROR: mempool transaction missing input");
-
-                        fMissingInputs = true;
-                        if (porphan) vOrphan.pop_back();
-
-                        break;
-                    }
-
-                    // Has to wait for dependencies
-                    if (!porphan)
-                    {
-                        // Use list for automatic deletion
-                        vOrphan.push_back(COrphan(&tx));
-                        porphan = &vOrphan.back();
-                        LogPrint(BCLog::LogFlags::NOISY, "Orphan tx %s ",tx.GetHash().GetHex());
-                    }
-                    mapDependers[txin.prevout.hash].push_back(porphan);
-                    porphan->setDependsOn.insert(txin.prevout.hash);
-                    nTotalIn += mempool.mapTx[txin.prevout.hash].vout[txin.prevout.n].nValue;
-
-                    continue;
-                }
-                int64_t nValueIn = txPrev.vout[txin.prevout.n].nValue;
-                nTotalIn += nValueIn;
-            }
-            if (fMissingInputs) continue;
-
-            unsigned int nTxSize = ::GetSerializeSize(tx, SER_NETWORK, PROTOCOL_VERSION);
-
-            // This is a more accurate fee-per-kilobyte than is used by the client code, because the
-            // client code rounds up the size to the nearest 1K. That's good, because it gives an
-            // incentive to create smaller transactions.
-            CAmount total_fee = nTotalIn - tx.GetValueOut();
-            if (!tx.vContracts.empty() && tx.vContracts[0].m_type == GRC::ContractType::MRC) {
-                const auto& mrc = *tx.vContracts[0].SharePayloadAs<GRC::MRC>();
-
-                total_fee += mrc.m_fee - mrc.m_fee * foundation_fee_fraction.GetNumerator()
-                                                   / foundation_fee_fraction.GetDenominator();
-            }
-            double dFeePerKb =  (double)total_fee / (double(nTxSize)/1000.0);
-
-            if (porphan)
-            {
-                porphan->dFeePerKb = dFeePerKb;
-            }
-            else
-            {
-                vecPriority.push_back(std::make_pair(dFeePerKb, &tx));
-            }
-        }
+        CTxMemPool::FeeRateIndex modified_scores;
+        std::map<uint256, double> modified_score_of;
+        std::set<uint256> in_block;
+        std::set<uint256> failed;
 
         // Collect transactions into block
         map<uint256, CTxIndex> mapTestPool;
@@ -484,38 +375,53 @@ bool CreateRestOfTheBlock(CBlock &block, CBlockIndex* pindexPrev,
 
         int nBlockSigOps = 100;
 
-        std::make_heap(vecPriority.begin(), vecPriority.end());
+        // Check one transaction of a package and add it to the block. The parents of the transaction are already in
+        // the block because the package is added in dependency order. Sets fee_too_low when the transaction does not
+        // pay the minimum fee.
+        const auto add_to_block = [&](const CTxMemPoolEntry& entry, bool& fee_too_low) {
+            const CTransaction& tx = entry.GetTx();
 
-        while (!vecPriority.empty())
-        {
-            // Take highest priority transaction off the priority queue:
-            double dFeePerKb = vecPriority.front().first;
-            CTransaction& tx = *(vecPriority.front().second);
+            if (tx.IsCoinBase() || tx.IsCoinStake() || !IsFinalTx(tx, nHeight))
+                return false;
+
+            // Double-check that contracts pass contextual validation again so
+            // that we don't include a transaction that disrupts validation of
+            // the block. Note that this is especially important now that there
+            // are block level rules that cannot be checked for transactions
+            // that are just in the mempool. Note that the only block level rules
+            // currently implemented depend on block height only, so the
+            // pindex_contract_validate only has the block height filled out.
+            //
+            int DoS = 0; // Unused here.
+            if (!tx.GetContracts().empty() && !GRC::BlockValidateContracts(&pindex_contract_validate, tx, DoS)) {
+                LogPrint(BCLog::LogFlags::MINER,
+                    "CreateRestOfTheBlock: contract failed contextual validation. Skipped tx %s",
+                    entry.GetHash().ToString());
 
-            std::pop_heap(vecPriority.begin(), vecPriority.end());
-            vecPriority.pop_back();
+                return false;
+            }
 
             // Size limits
-            unsigned int nTxSize = ::GetSerializeSize(tx, SER_NETWORK, PROTOCOL_VERSION);
+            unsigned int nTxSize = entry.GetTxSize();
 
             if (nBlockSize + nTxSize >= nBlockMaxSize)
             {
                 LogPrintf("Tx size too large for tx %s blksize %" PRIu64 ", tx size %" PRId64,
-                          tx.GetHash().GetHex(), nBlockSize, nTxSize);
-                continue;
+                          entry.GetHash().GetHex(), nBlockSize, nTxSize);
+                return false;
             }
 
             // Legacy limits on sigOps:
             unsigned int nTxSigOps = GetLegacySigOpCount(tx);
             if (nBlockSigOps + nTxSigOps >= MAX_BLOCK_SIGOPS)
             {
-                continue;
+                return false;
             }
 
             // Timestamp limit
             if (tx.nTime >  block.nTime)
             {
-                continue;
+                return false;
             }
 
             // Transaction fee
@@ -528,8 +434,8 @@ bool CreateRestOfTheBlock(CBlock &block, CBlockIndex* pindexPrev,
             bool fInvalid;
             if (!FetchInputs(tx, txdb, mapTestPoolTmp, false, true, mapInputs, fInvalid))
             {
-                LogPrint(BCLog::LogFlags::NOISY, "Unable to fetch inputs for tx %s ", tx.GetHash().GetHex());
-                continue;
+                LogPrint(BCLog::LogFlags::NOISY, "Unable to fetch inputs for tx %s ", entry.GetHash().GetHex());
+                return false;
             }
 
             CAmount nTxFees = GetValueIn(tx, mapInputs) - tx.GetValueOut();
@@ -537,25 +443,24 @@ bool CreateRestOfTheBlock(CBlock &block, CBlockIndex* pindexPrev,
             {
                 LogPrint(BCLog::LogFlags::NOISY,
                          "Not including tx %s  due to TxFees of %" PRId64 ", bare min fee is %" PRId64,
-                         tx.GetHash().GetHex(), nTxFees, nMinFee);
+                         entry.GetHash().GetHex(), nTxFees, nMinFee);
 
-                // Since transactions are sorted by fee, the fee of rest must also be lower
-                // than required.
-                break;
+                fee_too_low = true;
+                return false;
             }
 
             nTxSigOps += GetP2SHSigOpCount(tx, mapInputs);
             if (nBlockSigOps + nTxSigOps >= MAX_BLOCK_SIGOPS)
             {
                 LogPrint(BCLog::LogFlags::NOISY, "Not including tx %s due to exceeding max sigops of %d, sigops is %d",
-                    tx.GetHash().GetHex(), (nBlockSigOps+nTxSigOps), MAX_BLOCK_SIGOPS);
-                continue;
+                    entry.GetHash().GetHex(), (nBlockSigOps+nTxSigOps), MAX_BLOCK_SIGOPS);
+                return false;
             }
 
             if (!ConnectInputs(tx, txdb, mapInputs, mapTestPoolTmp, CDiskTxPos(1,1,1), pindexPrev, false, true))
             {
-                LogPrint(BCLog::LogFlags::NOISY, "Unable to connect inputs for tx %s ",tx.GetHash().GetHex());
-                continue;
+                LogPrint(BCLog::LogFlags::NOISY, "Unable to connect inputs for tx %s ",entry.GetHash().GetHex());
+                return false;
             }
 
             // Non-mrc transactions set ignore_transaction to false;
@@ -595,7 +500,7 @@ bool CreateRestOfTheBlock(CBlock &block, CBlockIndex* pindexPrev,
                                 // mrc transaction in the mempool for a given cpid in mrc fee order, not the last
                                 // for the available slots for mrc. Note that AcceptToMemoryBlock now also enforces
                                 // uniqueness of transactions in the mempool for each CPID.
-                                if (mrc_map.insert(make_pair(*mrc_cpid, make_pair(tx.GetHash(), mrc))).second) {
+                                if (mrc_map.insert(make_pair(*mrc_cpid, make_pair(entry.GetHash(), mrc))).second) {
                                     // If an entry was successfully inserted into the mrc_map, adjust the block size upward
                                     // by the size of one coinstake output, because there will be one output added per
                                     // mrc entry in this map later in CreateMRCRewards.
@@ -621,9 +526,9 @@ bool CreateRestOfTheBlock(CBlock &block, CBlockIndex* pindexPrev,
                 } // contract type is SIDESTAKE
             } // contracts not empty
 
-            if (ignore_transaction) continue;
+            if (ignore_transaction) return false;
 
-            mapTestPoolTmp[tx.GetHash()] = CTxIndex(CDiskTxPos(1,1,1), tx.vout.size());
+            mapTestPoolTmp[entry.GetHash()] = CTxIndex(CDiskTxPos(1,1,1), tx.vout.size());
             swap(mapTestPool, mapTestPoolTmp);
 
             block.vtx.push_back(tx);
@@ -634,25 +539,172 @@ bool CreateRestOfTheBlock(CBlock &block, CBlockIndex* pindexPrev,
             if (LogInstance().WillLogCategory(BCLog::LogFlags::NOISY) || gArgs.GetBoolArg("-printpriority"))
             {
                 LogPrintf("feerate %.1f GRC/KB txid %s",
-                       dFeePerKb, tx.GetHash().ToString());
+                       entry.GetFeePerKb(), entry.GetHash().ToString());
             }
 
-            // Add transactions that depend on this one to the priority queue
-            uint256 hash = tx.GetHash();
-            if (mapDependers.count(hash))
+            return true;
+        };
+
+        while (true)
+        {
+            // Take the package with the highest score from either the re-scored descendants or the index:
+            while (next_by_score != by_ancestor_score.end()
+                   && (in_block.count(next_by_score->second)
+                       || failed.count(next_by_score->second)
+                       || modified_score_of.count(next_by_score->second)))
+            {
+                ++next_by_score;
+            }
+
+            const CTxMemPoolEntry* head = nullptr;
+
+            if (!modified_scores.empty()
+                && (next_by_score == by_ancestor_score.end() || modified_scores.begin()->first >= next_by_score->first))
+            {
+                head = mempool.GetEntry(modified_scores.begin()->second);
+
+                modified_score_of.erase(head->GetHash());
+                modified_scores.erase(modified_scores.begin());
+
+                // A re-scored transaction may have entered the block as an ancestor of another package since:
+                if (in_block.count(head->GetHash()) || failed.count(head->GetHash())) {
+                    continue;
+                }
+            }
+            else if (next_by_score != by_ancestor_score.end())
+            {
+                head = mempool.GetEntry(next_by_score->second);
+
+                ++next_by_score;
+            }
+            else
             {
-                for (auto& porphan : mapDependers[hash])
-                {
-                    if (!porphan->setDependsOn.empty())
-                    {
-                        porphan->setDependsOn.erase(hash);
-                        if (porphan->setDependsOn.empty())
-                        {
-                            vecPriority.push_back(std::make_pair(porphan->dFeePerKb, porphan->ptx));
-                            std::push_heap(vecPriority.begin(), vecPriority.end());
-                        }
+                break;
+            }
+
+            // The package holds the ancestors that are not in the block yet. A transaction with fewer in-pool
+            // ancestors cannot descend from one with more, so ordering by that count puts parents first:
+            std::vector<const CTxMemPoolEntry*> package;
+            bool ancestor_failed = false;
+
+            for (const auto& ancestor_hash : head->GetAncestors()) {
+                if (in_block.count(ancestor_hash)) {
+                    continue;
+                }
+
+                if (failed.count(ancestor_hash)) {
+                    ancestor_failed = true;
+                    break;
+                }
+
+                package.push_back(mempool.GetEntry(ancestor_hash));
+            }
+
+            if (ancestor_failed) {
+                LogPrint(BCLog::LogFlags::NOISY, "Orphan tx %s ", head->GetHash().GetHex());
+
+                failed.insert(head->GetHash());
+                continue;
+            }
+
+            package.push_back(head);
+
+            std::sort(package.begin(), package.end(), [](const CTxMemPoolEntry* a, const CTxMemPoolEntry* b) {
+                return a->GetAncestors().size() < b->GetAncestors().size();
+            });
+
+            // A single transaction leaves the block unchanged when it fails. The transactions of a larger package
+            // that made it in before the failure are taken out again:
+            const size_t vtx_size = block.vtx.size();
+            const uint64_t block_size = nBlockSize;
+            const int block_sig_ops = nBlockSigOps;
+            const int64_t fees = nFees;
+            const bool sidestake_bound = mandatory_sidestake_bound;
+            std::map<uint256, CTxIndex> test_pool;
+            std::map<GRC::Cpid, std::pair<uint256, GRC::MRC>> mrcs;
+
+            if (package.size() > 1) {
+                test_pool = mapTestPool;
+                mrcs = mrc_map;
+            }
+
+            const CTxMemPoolEntry* failed_entry = nullptr;
+            bool fee_too_low = false;
+
+            for (const auto& entry : package) {
+                if (!add_to_block(*entry, fee_too_low)) {
+                    failed_entry = entry;
+                    break;
+                }
+            }
+
+            if (failed_entry != nullptr) {
+                // Since packages are sorted by score, the fee of the rest must also be lower than required:
+                if (fee_too_low && package.size() == 1) {
+                    break;
+                }
+
+                if (package.size() > 1) {
+                    block.vtx.resize(vtx_size);
+                    nBlockSize = block_size;
+                    nBlockSigOps = block_sig_ops;
+                    nFees = fees;
+                    mandatory_sidestake_bound = sidestake_bound;
+                    mapTestPool = std::move(test_pool);
+                    mrc_map = std::move(mrcs);
+                }
+
+                failed.insert(failed_entry->GetHash());
+                failed.insert(head->GetHash());
+                continue;
+            }
+
+            for (const auto& entry : package) {
+                in_block.insert(entry->GetHash());
+            }
+
+            // Re-score the descendants of the package that remain outside of the block:
+            std::set<uint256> descendants;
+            std::vector<uint256> queue;
+
+            for (const auto& entry : package) {
+                queue.insert(queue.end(), entry->GetChildren().begin(), entry->GetChildren().end());
+            }
+
+            while (!queue.empty()) {
+                const uint256 hash = queue.back();
+                queue.pop_back();
+
+                if (in_block.count(hash) || failed.count(hash) || !descendants.insert(hash).second) {
+                    continue;
+                }
+
+                const CTxMemPoolEntry* descendant = mempool.GetEntry(hash);
+                CAmount package_fees = descendant->GetModifiedFee();
+                uint64_t package_size = descendant->GetTxSize();
+
+                for (const auto& ancestor_hash : descendant->GetAncestors()) {
+                    if (!in_block.count(ancestor_hash)) {
+                        const CTxMemPoolEntry* ancestor = mempool.GetEntry(ancestor_hash);
+
+                        package_fees += ancestor->GetModifiedFee();
+                        package_size += ancestor->GetTxSize();
                     }
                 }
+
+                const double score = descendant->GetPackageScore(package_fees, package_size);
+                const auto modified = modified_score_of.find(hash);
+
+                if (modified != modified_score_of.end()) {
+                    modified_scores.erase(std::make_pair(modified->second, hash));
+                    modified->second = score;
+                } else {
+                    modified_score_of.emplace(hash, score);
+                }
+
+                modified_scores.emplace(score, hash);
+
+                queue.insert(queue.end(), descendant->GetChildren().begin(), descendant->GetChildren().end());
             }
         }
 
@@ -671,28 +723,54 @@ bool CreateRestOfTheBlock(CBlock &block, CBlockIndex* pindexPrev,
 }
 
 
-bool CreateCoinStake(CBlock &blocknew, CKey &key,
-    vector<const CWalletTx*> &StakeInputs,
-    CWallet &wallet, CBlockIndex* pindexPrev) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+namespace {
+//!
+//! \brief Immutable view of the chain tip and of the stakeable coins that a
+//! stake attempt searches for a kernel without holding cs_main.
+//!
+//! The snapshot copies everything that the kernel search needs, including the
+//! outpoints of the coins, so that it stays valid when the wallet or the chain
+//! changes during the search. A found kernel is only used if the chain tip is
+//! still the snapshot's tip when cs_main is re-acquired.
+//!
+struct StakeSnapshot
 {
-    std::string function = __func__;
-    function += ": ";
+    StakeSnapshot(CBlockIndex* tip, const uint64_t stake_modifier, const unsigned int bits, const uint32_t tx_time)
+        : m_tip(tip)
+        , m_tx_time(tx_time)
+        , m_kernel_search(stake_modifier, bits)
+    {
+    }
 
-    int64_t CoinWeight;
-    arith_uint256 StakeKernelHash;
-    CTxDB txdb("r");
-    int64_t StakeWeightSum = 0;
-    double StakeValueSum = 0;
-    int64_t StakeWeightMin = MAX_MONEY;
-    int64_t StakeWeightMax = 0;
-    CTransaction &txnew = blocknew.vtx[1]; // second tx is coinstake
+    CBlockIndex* const m_tip;             //!< Block that the new block extends.
+    const uint32_t m_tx_time;             //!< Masked coinstake timestamp.
+    int64_t m_balance = 0;                //!< Balance for the efficiency calculation.
+    GRC::StakeKernelSearch m_kernel_search; //!< Kernels of the stakeable coins.
+};
 
-    bool kernel_found = false;
+//!
+//! \brief Select the stakeable coins and prepare their kernels for the chain
+//! tip. Needs no cs_main.
+//!
+//! \param snapshot       Receives the snapshot to search.
+//! \param chain          Chain state of the wallet's coins, captured under
+//! cs_main together with \p pindexPrev.
+//! \param stake_modifier Stake modifier for \p pindexPrev.
+//!
+//! \return \c false if the wallet cannot stake now.
+//!
+bool TakeStakeSnapshot(
+    std::optional<StakeSnapshot>& snapshot,
+    const CBlock& blocknew,
+    CWallet& wallet,
+    CBlockIndex* pindexPrev,
+    const StakingChainView& chain,
+    const uint64_t stake_modifier)
+{
+    std::string function = __func__;
+    function += ": ";
 
-    //initialize the transaction
-    txnew.nTime = GRC::MaskStakeTime(blocknew.nTime);
-    txnew.vin.clear();
-    txnew.vout.clear();
+    const uint32_t tx_time = GRC::MaskStakeTime(blocknew.nTime);
 
     // Choose coins to use
     vector<pair<const CWalletTx*,unsigned int>> CoinsToStake;
@@ -701,16 +779,16 @@ bool CreateCoinStake(CBlock &blocknew, CKey &key,
     // This will be used to calculate the staking efficiency.
     int64_t balance = 0;
 
-    if (!wallet.SelectCoinsForStaking(txnew.nTime, CoinsToStake, error_flag, balance, true))
+    if (!wallet.SelectCoinsForStaking(tx_time, CoinsToStake, error_flag, balance, chain, true))
     {
         g_miner_status.UpdateLastSearch(
-            kernel_found,
-            txnew.nTime,
+            false,
+            tx_time,
             blocknew.nVersion,
-            StakeWeightSum,
-            StakeValueSum,
+            0,
+            0,
             0, // This should be set to zero for an unsuccessful iteration due to no stakeable coins.
-            StakeWeightMax,
+            0,
             GRC::CalculateStakeWeightV8(balance));
 
         g_miner_status.UpdateCurrentErrors(error_flag);
@@ -723,126 +801,167 @@ bool CreateCoinStake(CBlock &blocknew, CKey &key,
     g_timer.GetTimes(function + "SelectCoinsForStaking", "miner");
 
     LogPrint(BCLog::LogFlags::MINER, "CreateCoinStake: Staking nTime/16 = %d Bits = %u",
-             txnew.nTime/16, blocknew.nBits);
+             tx_time/16, blocknew.nBits);
 
-    uint64_t StakeModifier = 0;
-    int nHeight_mod = 0;
+    snapshot.emplace(pindexPrev, stake_modifier, blocknew.nBits, tx_time);
 
-    if (!GRC::FindStakeModifierRev(StakeModifier, pindexPrev, nHeight_mod)) return false;
-
-    LogPrint(BCLog::LogFlags::MISC, "FindStakeModifierRev(): pindex->nHeight = %i, "
-                                    "pindex->nStakeModifier = %" PRId64,
-                                    nHeight_mod, StakeModifier);
+    snapshot->m_balance = balance;
 
+    // Serialize the kernel of each coin once for this stake modifier so that
+    // the search needs neither the wallet nor the block index:
     for (const auto& pcoin : CoinsToStake)
     {
         const CWalletTx &CoinTx = *pcoin.first; //transaction that produced this coin
         unsigned int CoinTxN = pcoin.second; //index of this coin inside it
 
-        unsigned int block_time;
+        const auto state = chain.m_txs.find(CoinTx.GetHash());
 
-        block_time = mapBlockIndex[CoinTx.hashBlock]->nTime;
+        if (state == chain.m_txs.end() || state->second.m_block_time == 0) {
+            continue;
+        }
 
-        StakeValueSum += CoinTx.vout[CoinTxN].nValue / (double) COIN;
+        snapshot->m_kernel_search.AddCandidate(
+            COutPoint(CoinTx.GetHash(), CoinTxN),
+            CoinTx.vout[CoinTxN].nValue,
+            state->second.m_block_time);
+    }
 
-        CoinWeight = GRC::CalculateStakeWeightV8(CoinTx, CoinTxN);
+    g_timer.GetTimes(function + "prepare stake kernels", "miner");
 
-        StakeKernelHash = UintToArith256(GRC::CalculateStakeHashV8(block_time, CoinTx, CoinTxN, txnew.nTime, StakeModifier));
+    return true;
+}
+
+//!
+//! \brief Search the snapshot for a kernel. Needs no locks.
+//!
+//! \return Index of the candidate coin with a kernel that meets the target.
+//!
+std::optional<size_t> SearchStakeKernel(const StakeSnapshot& snapshot, const int block_version)
+{
+    const GRC::StakeKernelSearch& kernel_search = snapshot.m_kernel_search;
+    const std::optional<size_t> kernel_index = kernel_search.Find(snapshot.m_tx_time);
 
-        arith_uint320 StakeTarget = arith_uint256().SetCompact(blocknew.nBits);
-        StakeTarget *= arith_uint320(CoinWeight);
-        StakeWeightSum += CoinWeight;
-        StakeWeightMin = std::min(StakeWeightMin, CoinWeight);
-        StakeWeightMax = std::max(StakeWeightMax, CoinWeight);
-        double StakeKernelDiff = GRC::GetBlockDifficulty(StakeKernelHash.GetCompact())*CoinWeight;
+    if (kernel_index) {
+        const GRC::StakeKernelSearch::Candidate& candidate = kernel_search.GetCandidates()[*kernel_index];
+        const arith_uint256 StakeKernelHash = UintToArith256(kernel_search.GetKernelHash(candidate, snapshot.m_tx_time));
 
         LogPrint(BCLog::LogFlags::MINER,
-                 "CreateCoinStake: V%d Time %d, Bits %u, Weight %" PRId64 "\n"
+                 "CreateCoinStake: V%d Time %d, Weight %" PRId64 "\n"
                  " Stk %72s\n"
                  " Trg %72s\n"
-                 " Diff %0.7f of %0.7f",
-                 blocknew.nVersion,
-                 txnew.nTime,
-                 blocknew.nBits,
-                 CoinWeight,
+                 " Diff %0.7f",
+                 block_version,
+                 snapshot.m_tx_time,
+                 candidate.m_weight,
                  StakeKernelHash.GetHex(),
-                 StakeTarget.GetHex(),
-                 StakeKernelDiff,
-                 GRC::GetBlockDifficulty(blocknew.nBits));
+                 candidate.m_target.GetHex(),
+                 GRC::GetBlockDifficulty(StakeKernelHash.GetCompact()) * candidate.m_weight);
+    }
 
-        if (arith_uint320(StakeKernelHash) <= StakeTarget)
-        {
-            // Found a kernel
-            LogPrintf("CreateCoinStake: Found Kernel");
-            vector<valtype> vSolutions;
-            txnouttype whichType;
-            CScript scriptPubKeyOut;
-            CScript scriptPubKeyKernel;
-            scriptPubKeyKernel = CoinTx.vout[CoinTxN].scriptPubKey;
-
-            if (!Solver(scriptPubKeyKernel, whichType, vSolutions))
-            {
-                LogPrintf("CreateCoinStake: failed to parse kernel");
-                break;
-            }
+    g_miner_status.UpdateLastSearch(
+        kernel_index.has_value(),
+        snapshot.m_tx_time,
+        block_version,
+        kernel_search.GetWeightSum(),
+        kernel_search.GetValueSum(),
+        kernel_search.GetWeightMin(),
+        kernel_search.GetWeightMax(),
+        GRC::CalculateStakeWeightV8(snapshot.m_balance));
+
+    return kernel_index;
+}
+} // anonymous namespace
 
-            if (whichType == TX_PUBKEYHASH) // pay to address type
-            {
-                // convert to pay to public key type
-                if (!wallet.GetKey(uint160(vSolutions[0]), key))
-                {
-                    LogPrintf("CreateCoinStake: failed to get key for kernel type = %d", whichType);
-                    break;  // unable to find corresponding public key
-                }
-                scriptPubKeyOut << key.GetPubKey() << OP_CHECKSIG;
-            }
-            else if (whichType == TX_PUBKEY)  // pay to public key type
-            {
-                valtype& vchPubKey = vSolutions[0];
-                if (!wallet.GetKey(Hash160(vchPubKey), key)
-                    || key.GetPubKey() != CPubKey(vchPubKey))
-                {
-                    LogPrintf("CreateCoinStake: failed to get key for kernel type = %d", whichType);
-                    break;  // unable to find corresponding public key
-                }
+//!
+//! \brief Build the coinstake transaction that spends the kernel found by the
+//! search of a stake snapshot.
+//!
+bool CreateCoinStake(CBlock &blocknew, CKey &key,
+    vector<const CWalletTx*> &StakeInputs,
+    CWallet &wallet,
+    const StakeSnapshot& snapshot,
+    const size_t kernel_index) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    TRACE_SPAN("CreateCoinStake");
 
-                scriptPubKeyOut = scriptPubKeyKernel;
-            }
-            else
-            {
-                LogPrintf("CreateCoinStake: no support for kernel type = %d", whichType);
-                break;  // only support pay to public key and pay to address
-            }
+    CTransaction &txnew = blocknew.vtx[1]; // second tx is coinstake
+
+    //initialize the transaction
+    txnew.nTime = snapshot.m_tx_time;
+    txnew.vin.clear();
+    txnew.vout.clear();
+
+    const COutPoint& kernel = snapshot.m_kernel_search.GetCandidates()[kernel_index].m_prevout;
+
+    LOCK(wallet.cs_wallet);
 
-            txnew.vin.push_back(CTxIn(CoinTx.GetHash(), CoinTxN));
-            StakeInputs.push_back(pcoin.first);
+    // The wallet may have spent or dropped the coin while the search ran:
+    const auto mi = wallet.mapWallet.find(kernel.hash);
 
-            int64_t nCredit = CoinTx.vout[CoinTxN].nValue;
+    if (mi == wallet.mapWallet.end()
+        || kernel.n >= mi->second.vout.size()
+        || mi->second.IsSpent(kernel.n))
+    {
+        LogPrintf("CreateCoinStake: kernel %s no longer available", kernel.ToString());
+        return false;
+    }
 
-            txnew.vout.push_back(CTxOut(0, CScript())); // First Must be empty
-            txnew.vout.push_back(CTxOut(nCredit, scriptPubKeyOut));
+    const CWalletTx &CoinTx = mi->second; //transaction that produced this coin
+    unsigned int CoinTxN = kernel.n; //index of this coin inside it
 
-            LogPrintf("CreateCoinStake: added kernel type = %d credit = %f", whichType, CoinToDouble(nCredit));
+    // Found a kernel
+    LogPrintf("CreateCoinStake: Found Kernel");
+    vector<valtype> vSolutions;
+    txnouttype whichType;
+    CScript scriptPubKeyOut;
+    CScript scriptPubKeyKernel;
+    scriptPubKeyKernel = CoinTx.vout[CoinTxN].scriptPubKey;
 
-            kernel_found = true;
+    if (!Solver(scriptPubKeyKernel, whichType, vSolutions))
+    {
+        LogPrintf("CreateCoinStake: failed to parse kernel");
+        return false;
+    }
 
-            break;
-        } // if (StakeKernelHash <= StakeTarget)
-    } // for (const auto& pcoin : CoinsToStake)
+    if (whichType == TX_PUBKEYHASH) // pay to address type
+    {
+        // convert to pay to public key type
+        if (!wallet.GetKey(uint160(vSolutions[0]), key))
+        {
+            LogPrintf("CreateCoinStake: failed to get key for kernel type = %d", whichType);
+            return false;  // unable to find corresponding public key
+        }
+        scriptPubKeyOut << key.GetPubKey() << OP_CHECKSIG;
+    }
+    else if (whichType == TX_PUBKEY)  // pay to public key type
+    {
+        valtype& vchPubKey = vSolutions[0];
+        if (!wallet.GetKey(Hash160(vchPubKey), key)
+            || key.GetPubKey() != CPubKey(vchPubKey))
+        {
+            LogPrintf("CreateCoinStake: failed to get key for kernel type = %d", whichType);
+            return false;  // unable to find corresponding public key
+        }
 
-    g_miner_status.UpdateLastSearch(
-        kernel_found,
-        txnew.nTime,
-        blocknew.nVersion,
-        StakeWeightSum,
-        StakeValueSum,
-        StakeWeightMin,
-        StakeWeightMax,
-        GRC::CalculateStakeWeightV8(balance));
-
-    g_timer.GetTimes(function + "stake UTXO loop", "miner");
-
-    return kernel_found;
+        scriptPubKeyOut = scriptPubKeyKernel;
+    }
+    else
+    {
+        LogPrintf("CreateCoinStake: no support for kernel type = %d", whichType);
+        return false;  // only support pay to public key and pay to address
+    }
+
+    txnew.vin.push_back(CTxIn(CoinTx.GetHash(), CoinTxN));
+    StakeInputs.push_back(&CoinTx);
+
+    int64_t nCredit = CoinTx.vout[CoinTxN].nValue;
+
+    txnew.vout.push_back(CTxOut(0, CScript())); // First Must be empty
+    txnew.vout.push_back(CTxOut(nCredit, scriptPubKeyOut));
+
+    LogPrintf("CreateCoinStake: added kernel type = %d credit = %f", whichType, CoinToDouble(nCredit));
+
+    return true;
 }
 
 void SplitCoinStakeOutput(CBlock &blocknew, int64_t &nReward, bool &fEnableStakeSplit, bool &fEnableSideStaking,
@@ -1385,33 +1504,79 @@ void StakeMiner(CWallet *pwallet)
         std::map<GRC::Cpid, std::pair<uint256, GRC::MRC>> mrc_map;
         std::map<GRC::Cpid, uint256> mrc_tx_map;
 
-        LOCK(cs_main);
+        CBlockIndex* pindexPrev = nullptr;
+        StakingChainView chain;
+        uint64_t stake_modifier = 0;
+        std::optional<StakeSnapshot> snapshot;
+
+        // * Capture the chain tip, its stake modifier, and the depths of the
+        // wallet's coins. This is the only part of the kernel search that
+        // needs cs_main.
+        {
+            LOCK(cs_main);
+
+            g_timer.GetTimes(function + "lock cs_main for snapshot", "miner");
+
+            pindexPrev = pindexBest;
+
+            // * Create a bare block
 
-        g_timer.GetTimes(function + "lock cs_main", "miner");
+            // This transition code is to handle the v12 to v13 transition. The other transition handling
+            // for block versions in the stakeminer have been removed, because no blocks of an earlier version
+            // than v13 can be staked now, since the chain is past the v12 transition height.
+            if (!IsV13Enabled(pindexPrev->nHeight + 1)) {
+                StakeBlock.nVersion = 12;
+            }
+
+            StakeBlock.nTime = GetAdjustedTime();
+            StakeBlock.nNonce = 0;
+            StakeBlock.nBits = GRC::GetNextTargetRequired(pindexPrev);
+            StakeBlock.vtx.resize(2);
+
+            int nHeight_mod = 0;
+
+            if (!GRC::FindStakeModifierRev(stake_modifier, pindexPrev, nHeight_mod)) continue;
+
+            LogPrint(BCLog::LogFlags::MISC, "FindStakeModifierRev(): pindex->nHeight = %i, "
+                                            "pindex->nStakeModifier = %" PRId64,
+                                            nHeight_mod, stake_modifier);
+
+            chain = pwallet->GetStakingChainView();
+
+            g_timer.GetTimes(function + "staking chain view (cs_main held)", "miner");
+        }
 
-        CBlockIndex* pindexPrev = pindexBest;
+        // * Select the stakeable coins under cs_wallet only.
+        if (!TakeStakeSnapshot(snapshot, StakeBlock, *pwallet, pindexPrev, chain, stake_modifier)) continue;
 
-        // * Create a bare block
+        g_timer.GetTimes(function + "stake snapshot (cs_main released)", "miner");
 
-        // This transition code is to handle the v12 to v13 transition. The other transition handling
-        // for block versions in the stakeminer have been removed, because no blocks of an earlier version
-        // than v13 can be staked now, since the chain is past the v12 transition height.
-        if (!IsV13Enabled(pindexPrev->nHeight + 1)) {
-            StakeBlock.nVersion = 12;
+        // * Search for a kernel without holding cs_main so that block validation
+        // and RPC calls proceed meanwhile.
+        const std::optional<size_t> kernel_index = SearchStakeKernel(*snapshot, StakeBlock.nVersion);
+
+        g_timer.GetTimes(function + "stake kernel search (cs_main released)", "miner");
+
+        if (!kernel_index) continue;
+
+        // * Re-acquire cs_main to assemble and submit the block. The kernel is
+        // only valid for the tip that the snapshot was taken from.
+        LOCK(cs_main);
+
+        g_timer.GetTimes(function + "lock cs_main for assembly", "miner");
+
+        if (pindexBest != snapshot->m_tip) {
+            LogPrint(BCLog::LogFlags::MINER, "%s: chain tip changed during the kernel search", __func__);
+            continue;
         }
 
-        StakeBlock.nTime = GetAdjustedTime();
-        StakeBlock.nNonce = 0;
-        StakeBlock.nBits = GRC::GetNextTargetRequired(pindexPrev);
-        StakeBlock.vtx.resize(2);
-        //tx 0 is coin_base
         CTransaction &StakeTX = StakeBlock.vtx[1]; //tx 1 is coin_stake
 
         // * Try to create a CoinStake transaction
         CKey BlockKey;
         vector<const CWalletTx*> StakeInputs;
 
-        bool createcoinstake_success = CreateCoinStake(StakeBlock, BlockKey, StakeInputs, *pwallet, pindexPrev);
+        bool createcoinstake_success = CreateCoinStake(StakeBlock, BlockKey, StakeInputs, *pwallet, *snapshot, *kernel_index);
 
         g_timer.GetTimes(function + "CreateCoinStake", "miner");
 
@@ -5,13 +5,630 @@
 
 #include "chainparams.h"
 #include "clientversion.h"
+#include "consensus/consensus.h"
+#include "crypto/common.h"
+#include "hash.h"
 #include "main.h"
+#include "node/blockstorage.h"
+#include "node/prune.h"
 #include "protocol.h"
 #include "serialize.h"
+#include "streams.h"
+#include "sync.h"
+#include "util.h"
 #include "validation.h"
 
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <stdio.h>
 
+bool fCompressBlocks = DEFAULT_COMPRESS_BLOCKS;
+
+namespace {
+/** Bytes that the block file reader reads from the file at a time. */
+constexpr size_t BLOCK_FILE_READ_SIZE = 8 << 20;
+
+/**
+ * Size of the header of a version 2 block file: the message start, a zero
+ * size that the legacy readers skip, the version, and the flags.
+ */
+constexpr size_t BLOCK_FILE_HEADER_SIZE = CMessageHeader::MESSAGE_START_SIZE + 12;
+
+/** Flag of a version 2 file rewritten from a legacy file. It ends with the table of the legacy positions. */
+constexpr uint32_t BLOCK_FILE_CONVERTED = 1;
+
+/** Seed of the block checksums. */
+constexpr uint32_t BLOCK_CHECKSUM_SEED = 0x47524331;
+
+/** A block is stored compressed only when that saves at least 1/8 of its size. */
+constexpr size_t MIN_COMPRESSION_SAVINGS = 8;
+
+/** Bytes of decompressed blocks that the block reader keeps for the next reads. */
+constexpr size_t DECOMPRESSED_BLOCK_CACHE_SIZE = 16 << 20;
+
+enum class BlockCompression : uint8_t
+{
+    NONE = 0,
+    ZLIB = 1,
+};
+
+/**
+ * Precedes each block in a version 2 file: the message start, the size of
+ * the stored block, the compression, the size of the serialized block, and
+ * the checksum of the stored block. The block position in the index points
+ * after the frame.
+ */
+struct BlockFrame
+{
+    static constexpr size_t SIZE = CMessageHeader::MESSAGE_START_SIZE + 13;
+
+    uint32_t m_stored_size = 0;
+    BlockCompression m_compression = BlockCompression::NONE;
+    uint32_t m_raw_size = 0;
+    uint32_t m_checksum = 0;
+
+    void Encode(unsigned char* out, const CMessageHeader::MessageStartChars& message_start) const
+    {
+        memcpy(out, message_start, CMessageHeader::MESSAGE_START_SIZE);
+        out += CMessageHeader::MESSAGE_START_SIZE;
+
+        WriteLE32(out, m_stored_size);
+        out[4] = static_cast<unsigned char>(m_compression);
+        WriteLE32(out + 5, m_raw_size);
+        WriteLE32(out + 9, m_checksum);
+    }
+
+    bool Decode(const unsigned char* in)
+    {
+        if (memcmp(in, Params().MessageStart(), CMessageHeader::MESSAGE_START_SIZE) != 0) {
+            return false;
+        }
+
+        in += CMessageHeader::MESSAGE_START_SIZE;
+
+        m_stored_size = ReadLE32(in);
+        m_compression = static_cast<BlockCompression>(in[4]);
+        m_raw_size = ReadLE32(in + 5);
+        m_checksum = ReadLE32(in + 9);
+
+        if (m_stored_size == 0 || m_stored_size > MAX_BLOCK_SIZE || m_raw_size > MAX_BLOCK_SIZE) {
+            return false;
+        }
+
+        switch (m_compression) {
+            case BlockCompression::NONE: return m_raw_size == m_stored_size;
+            case BlockCompression::ZLIB: return true;
+        }
+
+        return false;
+    }
+};
+
+/** Format of a block file. */
+struct BlockFileInfo
+{
+    uint32_t m_version = BLOCK_FILE_VERSION_LEGACY;
+    uint32_t m_flags = 0;
+
+    /** For a converted file: the legacy position of each block and its position in the file, by legacy position. */
+    std::vector<std::pair<uint32_t, uint32_t>> m_positions;
+};
+
+/**
+ * Guards g_block_files. Readers share it to look up the format of a file and
+ * open the file. Loading a format, writing a new file and replacing a file
+ * take it exclusively.
+ */
+std::shared_mutex g_block_files_mutex;
+
+/** Formats of the block files read or written so far. Never changes for a file except when it is converted. */
+std::map<unsigned int, std::shared_ptr<const BlockFileInfo>> g_block_files;
+
+/**
+ * Keeps the most recently read compressed blocks decompressed, by the file
+ * and the position of the block in the index.
+ *
+ * Reading a transaction from a compressed block inflates the whole block.
+ * Validation reads the inputs of a block from the same few blocks, so this
+ * inflates each of them once. The position in the index does not change
+ * when a file is converted. Pruning a file drops its entries.
+ */
+class DecompressedBlockCache
+{
+public:
+    typedef std::shared_ptr<const std::vector<unsigned char>> DataPtr;
+
+    explicit DecompressedBlockCache(const size_t max_bytes) : m_max_bytes(max_bytes)
+    {
+    }
+
+    DataPtr Find(const unsigned int nFile, const unsigned int nBlockPos)
+    {
+        LOCK(m_mutex);
+
+        const auto iter = m_index.find(std::make_pair(nFile, nBlockPos));
+
+        if (iter == m_index.end()) {
+            return nullptr;
+        }
+
+        m_entries.splice(m_entries.begin(), m_entries, iter->second);
+
+        return iter->second->second;
+    }
+
+    void Insert(const unsigned int nFile, const unsigned int nBlockPos, DataPtr data)
+    {
+        LOCK(m_mutex);
+
+        const auto key = std::make_pair(nFile, nBlockPos);
+
+        // Another thread may have inserted the same block first:
+        if (m_index.count(key) || data->size() > m_max_bytes) {
+            return;
+        }
+
+        m_bytes += data->size();
+        m_entries.emplace_front(key, std::move(data));
+        m_index.emplace(key, m_entries.begin());
+
+        while (m_bytes > m_max_bytes) {
+            Erase(std::prev(m_entries.end()));
+        }
+    }
+
+    void ForgetFile(const unsigned int nFile)
+    {
+        LOCK(m_mutex);
+
+        for (auto iter = m_entries.begin(); iter != m_entries.end();) {
+            iter = iter->first.first == nFile ? Erase(iter) : std::next(iter);
+        }
+    }
+
+private:
+    typedef std::pair<unsigned int, unsigned int> Key;
+    typedef std::list<std::pair<Key, DataPtr>> EntryList;
+
+    const size_t m_max_bytes;
+
+    Mutex m_mutex;
+    EntryList m_entries GUARDED_BY(m_mutex);              //!< Most recently used first.
+    std::map<Key, EntryList::iterator> m_index GUARDED_BY(m_mutex);
+    size_t m_bytes GUARDED_BY(m_mutex) = 0;
+
+    EntryList::iterator Erase(const EntryList::iterator iter) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        m_bytes -= iter->second->size();
+        m_index.erase(iter->first);
+
+        return m_entries.erase(iter);
+    }
+};
+
+DecompressedBlockCache g_decompressed_blocks(DECOMPRESSED_BLOCK_CACHE_SIZE);
+
+uint32_t BlockChecksum(Span<const unsigned char> data)
+{
+    // Detects storage corruption. Not a commitment: the block hash and the
+    // merkle root check the content.
+    return MurmurHash3(BLOCK_CHECKSUM_SEED, data);
+}
+
+void EncodeFileHeader(unsigned char* out, const uint32_t flags)
+{
+    memcpy(out, Params().MessageStart(), CMessageHeader::MESSAGE_START_SIZE);
+    out += CMessageHeader::MESSAGE_START_SIZE;
+
+    WriteLE32(out, 0);
+    WriteLE32(out + 4, BLOCK_FILE_VERSION);
+    WriteLE32(out + 8, flags);
+}
+
+bool DecodeFileHeader(const unsigned char* in, BlockFileInfo& info)
+{
+    if (memcmp(in, Params().MessageStart(), CMessageHeader::MESSAGE_START_SIZE) != 0) {
+        return false;
+    }
+
+    in += CMessageHeader::MESSAGE_START_SIZE;
+
+    // A legacy file starts with the size of the first block:
+    if (ReadLE32(in) != 0) {
+        return false;
+    }
+
+    info.m_version = ReadLE32(in + 4);
+    info.m_flags = ReadLE32(in + 8);
+
+    return true;
+}
+
+bool CompressBlock(Span<const unsigned char> data, std::vector<unsigned char>& out)
+{
+    namespace io = boost::iostreams;
+
+    std::string compressed;
+
+    try {
+        io::filtering_ostream stream;
+        stream.push(io::zlib_compressor(io::zlib::best_speed));
+        stream.push(io::back_inserter(compressed));
+        stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+        stream.reset();
+    } catch (const std::exception& e) {
+        return error("%s: %s", __func__, e.what());
+    }
+
+    out.assign(compressed.begin(), compressed.end());
+
+    return true;
+}
+
+bool DecompressBlock(Span<const unsigned char> stored, const uint32_t raw_size, std::vector<unsigned char>& out)
+{
+    namespace io = boost::iostreams;
+
+    out.resize(raw_size);
+
+    try {
+        io::filtering_istream stream;
+        stream.push(io::zlib_decompressor());
+        stream.push(io::array_source(reinterpret_cast<const char*>(stored.data()), stored.size()));
+        stream.read(reinterpret_cast<char*>(out.data()), raw_size);
+
+        if (static_cast<uint32_t>(stream.gcount()) != raw_size
+            || stream.get() != std::char_traits<char>::eof())
+        {
+            return error("%s: size does not match the frame", __func__);
+        }
+    } catch (const std::exception& e) {
+        return error("%s: %s", __func__, e.what());
+    }
+
+    return true;
+}
+
+/** Check a stored block against its frame and get the serialized block. */
+bool DecodeBlock(const BlockFrame& frame, Span<const unsigned char> stored, std::vector<unsigned char>& out)
+{
+    if (BlockChecksum(stored) != frame.m_checksum) {
+        return error("%s: checksum mismatch", __func__);
+    }
+
+    if (frame.m_compression == BlockCompression::NONE) {
+        out.assign(stored.begin(), stored.end());
+        return true;
+    }
+
+    return DecompressBlock(stored, frame.m_raw_size, out);
+}
+
+/** Append a serialized block to a version 2 file. */
+bool WriteBlockRecord(
+    FILE* file,
+    Span<const unsigned char> data,
+    const CMessageHeader::MessageStartChars& message_start,
+    unsigned int& block_pos)
+{
+    BlockFrame frame;
+    Span<const unsigned char> stored = data;
+    std::vector<unsigned char> compressed;
+
+    frame.m_raw_size = data.size();
+
+    if (fCompressBlocks
+        && CompressBlock(data, compressed)
+        && compressed.size() <= data.size() - data.size() / MIN_COMPRESSION_SAVINGS)
+    {
+        frame.m_compression = BlockCompression::ZLIB;
+        stored = compressed;
+    }
+
+    frame.m_stored_size = stored.size();
+    frame.m_checksum = BlockChecksum(stored);
+
+    unsigned char frame_data[BlockFrame::SIZE];
+    frame.Encode(frame_data, message_start);
+
+    const long frame_pos = ftell(file);
+
+    if (frame_pos < 0) {
+        return error("%s: ftell failed", __func__);
+    }
+
+    if (fwrite(frame_data, 1, sizeof(frame_data), file) != sizeof(frame_data)
+        || fwrite(stored.data(), 1, stored.size(), file) != stored.size())
+    {
+        return error("%s: write failed", __func__);
+    }
+
+    block_pos = frame_pos + BlockFrame::SIZE;
+
+    return true;
+}
+
+/**
+ * Read the format of a block file.
+ *
+ * @param[out] cache Whether the format is final: false for a file too short
+ * to hold a file header yet.
+ */
+std::shared_ptr<const BlockFileInfo> ReadBlockFileInfo(const unsigned int nFile, bool& cache)
+{
+    CAutoFile file(OpenBlockFile(nFile, 0, "rb"), SER_DISK, CLIENT_VERSION);
+
+    cache = false;
+
+    if (file.IsNull()) {
+        return nullptr;
+    }
+
+    auto info = std::make_shared<BlockFileInfo>();
+    unsigned char header[BLOCK_FILE_HEADER_SIZE];
+
+    if (fread(header, 1, sizeof(header), file.Get()) != sizeof(header)) {
+        return info;
+    }
+
+    cache = true;
+
+    if (!DecodeFileHeader(header, *info)) {
+        return info;
+    }
+
+    if (info->m_version != BLOCK_FILE_VERSION) {
+        cache = false;
+        error("%s: block file %u has unknown version %u", __func__, nFile, info->m_version);
+        return nullptr;
+    }
+
+    if (!(info->m_flags & BLOCK_FILE_CONVERTED)) {
+        return info;
+    }
+
+    // The table of positions ends the file, followed by its size and checksum:
+    unsigned char footer[8];
+
+    if (fseek(file.Get(), -(long) sizeof(footer), SEEK_END) != 0
+        || fread(footer, 1, sizeof(footer), file.Get()) != sizeof(footer))
+    {
+        cache = false;
+        error("%s: failed to read the position table of block file %u", __func__, nFile);
+        return nullptr;
+    }
+
+    const uint32_t count = ReadLE32(footer);
+    const long file_size = ftell(file.Get());
+
+    if (file_size < (long) (BLOCK_FILE_HEADER_SIZE + sizeof(footer))
+        || count > (file_size - BLOCK_FILE_HEADER_SIZE - sizeof(footer)) / 8)
+    {
+        cache = false;
+        error("%s: invalid position table in block file %u", __func__, nFile);
+        return nullptr;
+    }
+
+    std::vector<unsigned char> table(count * 8);
+
+    if (fseek(file.Get(), file_size - sizeof(footer) - table.size(), SEEK_SET) != 0
+        || fread(table.data(), 1, table.size(), file.Get()) != table.size()
+        || BlockChecksum(table) != ReadLE32(footer + 4))
+    {
+        cache = false;
+        error("%s: corrupt position table in block file %u", __func__, nFile);
+        return nullptr;
+    }
+
+    info->m_positions.reserve(count);
+
+    for (size_t i = 0; i < table.size(); i += 8) {
+        info->m_positions.emplace_back(ReadLE32(&table[i]), ReadLE32(&table[i + 4]));
+    }
+
+    return info;
+}
+
+/** Get the cached format of a block file. Call with g_block_files_mutex held, shared or exclusively. */
+std::shared_ptr<const BlockFileInfo> FindBlockFileInfo(const unsigned int nFile)
+{
+    const auto iter = g_block_files.find(nFile);
+
+    return iter != g_block_files.end() ? iter->second : nullptr;
+}
+
+/** Get the format of a block file, reading it if needed. Call with g_block_files_mutex held exclusively. */
+std::shared_ptr<const BlockFileInfo> LoadBlockFileInfo(const unsigned int nFile)
+{
+    if (auto info = FindBlockFileInfo(nFile)) {
+        return info;
+    }
+
+    bool cache = false;
+    std::shared_ptr<const BlockFileInfo> info = ReadBlockFileInfo(nFile, cache);
+
+    if (cache) {
+        g_block_files.emplace(nFile, info);
+    }
+
+    return info;
+}
+
+std::shared_ptr<const BlockFileInfo> GetBlockFileInfo(const unsigned int nFile)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(g_block_files_mutex);
+
+        if (auto info = FindBlockFileInfo(nFile)) {
+            return info;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(g_block_files_mutex);
+
+    return LoadBlockFileInfo(nFile);
+}
+
+/**
+ * Reads the parts of a block in a block file: the whole block, the header,
+ * or single transactions at their offsets in the serialized block.
+ *
+ * Legacy blocks and blocks stored raw are read in place from the file, so a
+ * transaction costs one seek as before. Compressed blocks, and the version 2
+ * blocks read whole, are read into memory and checked against the checksum
+ * of the frame. Decompressed blocks stay in a small cache for the next reads.
+ */
+class BlockRecordReader
+{
+public:
+    explicit BlockRecordReader(const int ser_type) : m_ser_type(ser_type)
+    {
+    }
+
+    /**
+     * Find a block in its file.
+     *
+     * @param whole Read and check the whole block.
+     */
+    bool Open(const unsigned int nFile, const unsigned int nBlockPos, const bool whole)
+    {
+        if ((m_data = g_decompressed_blocks.Find(nFile, nBlockPos))) {
+            m_in_memory = true;
+            return true;
+        }
+
+        std::shared_ptr<const BlockFileInfo> info;
+
+        // A conversion replaces the file and its format together:
+        {
+            std::shared_lock<std::shared_mutex> lock(g_block_files_mutex);
+
+            if ((info = FindBlockFileInfo(nFile))) {
+                m_file.emplace(OpenBlockFile(nFile, 0, "rb"), m_ser_type, CLIENT_VERSION);
+            }
+        }
+
+        if (!info) {
+            std::unique_lock<std::shared_mutex> lock(g_block_files_mutex);
+
+            if (!(info = LoadBlockFileInfo(nFile))) {
+                return error("%s: failed to read the format of block file %u", __func__, nFile);
+            }
+
+            m_file.emplace(OpenBlockFile(nFile, 0, "rb"), m_ser_type, CLIENT_VERSION);
+        }
+
+        if (m_file->IsNull()) {
+            return error("%s: OpenBlockFile failed", __func__);
+        }
+
+        m_pos = nBlockPos;
+
+        if (info->m_flags & BLOCK_FILE_CONVERTED) {
+            const auto iter = std::lower_bound(
+                info->m_positions.begin(),
+                info->m_positions.end(),
+                std::make_pair(static_cast<uint32_t>(nBlockPos), uint32_t{0}));
+
+            if (iter == info->m_positions.end() || iter->first != nBlockPos) {
+                return error("%s: no block at position %u of block file %u", __func__, nBlockPos, nFile);
+            }
+
+            m_pos = iter->second;
+        }
+
+        if (info->m_version == BLOCK_FILE_VERSION_LEGACY) {
+            return true;
+        }
+
+        BlockFrame frame;
+        unsigned char frame_data[BlockFrame::SIZE];
+
+        if (m_pos < BlockFrame::SIZE
+            || fseek(m_file->Get(), m_pos - BlockFrame::SIZE, SEEK_SET) != 0
+            || fread(frame_data, 1, sizeof(frame_data), m_file->Get()) != sizeof(frame_data)
+            || !frame.Decode(frame_data))
+        {
+            return error("%s: no block frame at position %u of block file %u", __func__, nBlockPos, nFile);
+        }
+
+        if (frame.m_compression == BlockCompression::NONE && !whole) {
+            return true;
+        }
+
+        std::vector<unsigned char> stored(frame.m_stored_size);
+
+        if (fread(stored.data(), 1, stored.size(), m_file->Get()) != stored.size()) {
+            return error("%s: truncated block at position %u of block file %u", __func__, nBlockPos, nFile);
+        }
+
+        if (frame.m_compression == BlockCompression::NONE) {
+            if (BlockChecksum(stored) != frame.m_checksum) {
+                return error("%s: checksum mismatch at position %u of block file %u", __func__, nBlockPos, nFile);
+            }
+
+            m_data = std::make_shared<const std::vector<unsigned char>>(std::move(stored));
+        } else {
+            std::vector<unsigned char> data;
+
+            if (!DecodeBlock(frame, stored, data)) {
+                return error("%s: corrupt block at position %u of block file %u", __func__, nBlockPos, nFile);
+            }
+
+            m_data = std::make_shared<const std::vector<unsigned char>>(std::move(data));
+            g_decompressed_blocks.Insert(nFile, nBlockPos, m_data);
+        }
+
+        m_in_memory = true;
+
+        return true;
+    }
+
+    /** Deserialize an object at an offset in the serialized block. */
+    template <typename T>
+    bool Read(const unsigned int offset, T& obj)
+    {
+        try {
+            if (m_in_memory) {
+                if (offset > m_data->size()) {
+                    return false;
+                }
+
+                // Contract payloads deserialize from CDataStream or CAutoFile only:
+                CDataStream stream(Span<const unsigned char>(*m_data).subspan(offset), m_ser_type, CLIENT_VERSION);
+                stream >> obj;
+            } else {
+                if (fseek(m_file->Get(), m_pos + offset, SEEK_SET) != 0) {
+                    return false;
+                }
+
+                *m_file >> obj;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    const int m_ser_type;
+    std::optional<CAutoFile> m_file;
+    unsigned int m_pos = 0;             //!< File position of the stored block.
+    bool m_in_memory = false;
+    std::shared_ptr<const std::vector<unsigned char>> m_data; //!< Serialized block when read into memory.
+};
+} // Anonymous namespace
 
 bool WriteBlockToDisk(const CBlock& block, unsigned int& nFileRet, unsigned int& nBlockPosRet,
                       const CMessageHeader::MessageStartChars& messageStart)
@@ -24,16 +641,27 @@ bool WriteBlockToDisk(const CBlock& block, unsigned int& nFileRet, unsigned int&
     if (fileout.IsNull())
         return error("%s: AppendBlockFile failed", __func__);
 
-    // Write index header
-    unsigned int nSize = GetSerializeSize(fileout, block);
-    fileout << messageStart << nSize;
+    if (GetBlockFileVersion(nFileRet) == BLOCK_FILE_VERSION)
+    {
+        CDataStream data(SER_DISK, CLIENT_VERSION);
+        data << block;
 
-    // Write block
-    long fileOutPos = ftell(fileout.Get());
-    if (fileOutPos < 0)
-        return error("%s: ftell failed", __func__);
-    nBlockPosRet = fileOutPos;
-    fileout << block;
+        if (!WriteBlockRecord(fileout.Get(), MakeUCharSpan(data), messageStart, nBlockPosRet))
+            return error("%s: failed to write block", __func__);
+    }
+    else
+    {
+        // Write index header
+        unsigned int nSize = GetSerializeSize(fileout, block);
+        fileout << messageStart << nSize;
+
+        // Write block
+        long fileOutPos = ftell(fileout.Get());
+        if (fileOutPos < 0)
+            return error("%s: ftell failed", __func__);
+        nBlockPosRet = fileOutPos;
+        fileout << block;
+    }
 
     // Flush stdio buffers and commit to disk before returning
     fflush(fileout.Get());
@@ -45,27 +673,23 @@ bool WriteBlockToDisk(const CBlock& block, unsigned int& nFileRet, unsigned int&
 
 
 bool ReadBlockFromDisk(CBlock& block, unsigned int nFile, unsigned int nBlockPos,
-                       const Consensus::Params& params, bool fReadTransactions=true)
+                       const Consensus::Params& params, bool fReadTransactions)
 {
     block.SetNull();
 
     const int ser_flags = SER_DISK | (fReadTransactions ? 0 : SER_BLOCKHEADERONLY);
 
-    // Open history file to read
-    CAutoFile filein(OpenBlockFile(nFile, nBlockPos, "rb"), ser_flags, CLIENT_VERSION);
-    if (filein.IsNull())
-        return error("%s: OpenBlockFile failed", __func__);
+    BlockRecordReader reader(ser_flags);
+    if (!reader.Open(nFile, nBlockPos, fReadTransactions))
+        return false;
 
     // Read block
-    try {
-        filein >> block;
-    }
-    catch (std::exception &e) {
+    if (!reader.Read(0, block))
         return error("%s: deserialize or I/O error", __func__);
-    }
 
-    // Check the header
-    if (fReadTransactions && block.IsProofOfWork() && !CheckProofOfWork(block.GetHash(true), block.nBits, params))
+    // Check the header. A stub relocated by pruning can lack the coinstake:
+    if (fReadTransactions && block.IsProofOfWork() && !CheckProofOfWork(block.GetHash(true), block.nBits, params)
+        && !IsRelocatedBlock(block))
         return error("%s: errors in block header", __func__);
 
     return true;
@@ -73,7 +697,7 @@ bool ReadBlockFromDisk(CBlock& block, unsigned int nFile, unsigned int nBlockPos
 
 
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& params,
-                       bool fReadTransactions=true)
+                       bool fReadTransactions)
 {
     if (!fReadTransactions)
     {
@@ -82,6 +706,12 @@ bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus
         return true;
     }
 
+    // Hold the position of the block until the read finishes:
+    const PrunedBlockReadLock prune_lock;
+
+    if (prune_lock.IsBlockPruned(pindex))
+        return error("%s: block %s is pruned", __func__, pindex->GetBlockHash().GetHex());
+
     if (!ReadBlockFromDisk(block, pindex->nFile, pindex->nBlockPos, params, fReadTransactions))
         return false;
 
@@ -91,3 +721,335 @@ bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus
     return true;
 }
 
+
+bool ReadTxFromDisk(CTransaction& tx, const CDiskTxPos& pos, CBlockHeader* header)
+{
+    tx.SetNull();
+
+    BlockRecordReader reader(SER_DISK);
+    if (!reader.Open(pos.nFile, pos.nBlockPos, false))
+        return false;
+
+    if (header && !reader.Read(0, *header))
+        return error("%s: deserialize or I/O error for block header", __func__);
+
+    if (pos.nTxPos < pos.nBlockPos || !reader.Read(pos.nTxPos - pos.nBlockPos, tx))
+        return error("%s: deserialize or I/O error", __func__);
+
+    return true;
+}
+
+
+bool WriteBlockFileHeader(unsigned int nFile, FILE* file)
+{
+    unsigned char header[BLOCK_FILE_HEADER_SIZE];
+    EncodeFileHeader(header, 0);
+
+    if (fwrite(header, 1, sizeof(header), file) != sizeof(header) || fflush(file) != 0)
+        return error("%s: failed to write the header of block file %u", __func__, nFile);
+
+    auto info = std::make_shared<BlockFileInfo>();
+    info->m_version = BLOCK_FILE_VERSION;
+
+    std::unique_lock<std::shared_mutex> lock(g_block_files_mutex);
+    g_block_files[nFile] = std::move(info);
+
+    return true;
+}
+
+
+uint32_t GetBlockFileVersion(unsigned int nFile)
+{
+    const auto info = GetBlockFileInfo(nFile);
+
+    return info ? info->m_version : 0;
+}
+
+
+bool IsConvertedBlockFile(unsigned int nFile)
+{
+    const auto info = GetBlockFileInfo(nFile);
+
+    return info && (info->m_flags & BLOCK_FILE_CONVERTED);
+}
+
+
+void ForgetBlockFile(unsigned int nFile)
+{
+    {
+        std::unique_lock<std::shared_mutex> lock(g_block_files_mutex);
+        g_block_files.erase(nFile);
+    }
+
+    g_decompressed_blocks.ForgetFile(nFile);
+}
+
+
+bool ConvertBlockFile(unsigned int nFile)
+{
+    if (GetBlockFileVersion(nFile) != BLOCK_FILE_VERSION_LEGACY)
+        return error("%s: block file %u is not a legacy file", __func__, nFile);
+
+    const fs::path path = BlockFilePath(nFile);
+    const fs::path temp_path = path.string() + ".tmp";
+    const int64_t start_time = GetTimeMillis();
+
+    CAutoFile filein(fsbridge::fopen(path, "rb"), SER_DISK, CLIENT_VERSION);
+    CAutoFile fileout(fsbridge::fopen(temp_path, "wb"), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull() || fileout.IsNull())
+        return error("%s: failed to open block file %u", __func__, nFile);
+
+    auto info = std::make_shared<BlockFileInfo>();
+    info->m_version = BLOCK_FILE_VERSION;
+    info->m_flags = BLOCK_FILE_CONVERTED;
+
+    unsigned char header[BLOCK_FILE_HEADER_SIZE];
+    EncodeFileHeader(header, info->m_flags);
+
+    bool ok = fwrite(header, 1, sizeof(header), fileout.Get()) == sizeof(header);
+
+    BlockFileReader reader(filein.Get());
+    uint64_t legacy_pos = 0;
+    std::vector<unsigned char> data;
+
+    while (ok && !fShutdown && reader.Next(legacy_pos, data)) {
+        unsigned int block_pos = 0;
+        ok = WriteBlockRecord(fileout.Get(), data, Params().MessageStart(), block_pos);
+        info->m_positions.emplace_back(legacy_pos, block_pos);
+    }
+
+    // The table of the legacy positions, its size, and its checksum:
+    std::vector<unsigned char> table(info->m_positions.size() * 8);
+
+    for (size_t i = 0; i < info->m_positions.size(); ++i) {
+        WriteLE32(&table[i * 8], info->m_positions[i].first);
+        WriteLE32(&table[i * 8 + 4], info->m_positions[i].second);
+    }
+
+    unsigned char footer[8];
+    WriteLE32(footer, info->m_positions.size());
+    WriteLE32(footer + 4, BlockChecksum(table));
+
+    ok = ok
+        && fwrite(table.data(), 1, table.size(), fileout.Get()) == table.size()
+        && fwrite(footer, 1, sizeof(footer), fileout.Get()) == sizeof(footer)
+        && fflush(fileout.Get()) == 0
+        && FileCommit(fileout.Get());
+
+    const int64_t new_size = ftell(fileout.Get());
+    const int64_t old_size = ftell(filein.Get());
+
+    fileout.fclose();
+    filein.fclose();
+
+    if (!ok) {
+        fs::remove(temp_path);
+        return error("%s: failed to write the converted block file %u", __func__, nFile);
+    }
+
+    if (fShutdown) {
+        fs::remove(temp_path);
+        return true;
+    }
+
+    {
+        LOCK(cs_main);
+
+        if (IsBlockFilePruned(nFile)) {
+            fs::remove(temp_path);
+            return true;
+        }
+
+        // Readers open the file and look up its format under this lock:
+        std::unique_lock<std::shared_mutex> lock(g_block_files_mutex);
+
+        if (!RenameOver(temp_path, path)) {
+            fs::remove(temp_path);
+            return error("%s: failed to replace block file %u", __func__, nFile);
+        }
+
+        g_block_files[nFile] = std::move(info);
+    }
+
+    LogPrintf("%s: converted block file %u: %" PRId64 " -> %" PRId64 " bytes in %" PRId64 " ms",
+              __func__, nFile, old_size, new_size, GetTimeMillis() - start_time);
+
+    return true;
+}
+
+
+void ConvertBlockFiles()
+{
+    unsigned int nLastFile = 0;
+
+    {
+        LOCK(cs_main);
+
+        // Move the append position past the full files. Blocks never go to
+        // the files before it again:
+        FILE* file = AppendBlockFile(nLastFile);
+        if (!file) {
+            error("%s: AppendBlockFile failed", __func__);
+            return;
+        }
+
+        fclose(file);
+    }
+
+    unsigned int converted = 0;
+
+    for (unsigned int nFile = 1; nFile < nLastFile && !fShutdown; ++nFile) {
+        if (WITH_LOCK(cs_main, return IsBlockFilePruned(nFile)))
+            continue;
+
+        if (GetBlockFileVersion(nFile) != BLOCK_FILE_VERSION_LEGACY)
+            continue;
+
+        if (!ConvertBlockFile(nFile)) {
+            LogPrintf("WARNING: %s: block file conversion stopped. It resumes at the next start.", __func__);
+            return;
+        }
+
+        ++converted;
+    }
+
+    LogPrintf("%s: converted %u legacy block files", __func__, converted);
+}
+
+
+BlockFileReader::BlockFileReader(FILE* file) : m_file(file)
+{
+}
+
+bool BlockFileReader::Next(uint64_t& pos, std::vector<unsigned char>& data)
+{
+    const auto& message_start = Params().MessageStart();
+
+    if (m_version == 0) {
+        BlockFileInfo info;
+
+        m_version = BLOCK_FILE_VERSION_LEGACY;
+
+        if (Fill(BLOCK_FILE_HEADER_SIZE) && DecodeFileHeader(m_buffer.data(), info)) {
+            m_version = info.m_version;
+            m_offset = BLOCK_FILE_HEADER_SIZE;
+        }
+    }
+
+    while (!fRequestShutdown) {
+        if (!Fill(CMessageHeader::MESSAGE_START_SIZE + sizeof(uint32_t)))
+            return false;
+
+        const auto begin = m_buffer.begin() + m_offset;
+        const auto found = std::search(
+            begin,
+            m_buffer.end(),
+            message_start,
+            message_start + CMessageHeader::MESSAGE_START_SIZE);
+
+        if (found == m_buffer.end()) {
+            // Keep the bytes that may begin a message start in the next read:
+            m_offset = m_buffer.size() - (CMessageHeader::MESSAGE_START_SIZE - 1);
+            continue;
+        }
+
+        m_offset = found - m_buffer.begin();
+
+        if (m_version != BLOCK_FILE_VERSION_LEGACY) {
+            BlockFrame frame;
+
+            if (!Fill(BlockFrame::SIZE))
+                return false;
+
+            if (!frame.Decode(m_buffer.data() + m_offset)) {
+                // Not a block. Continue the search after the message start:
+                m_offset += CMessageHeader::MESSAGE_START_SIZE;
+                continue;
+            }
+
+            if (!Fill(BlockFrame::SIZE + frame.m_stored_size)) {
+                // The frame runs past the end of the file. Continue the
+                // search after the message start:
+                m_offset += CMessageHeader::MESSAGE_START_SIZE;
+                continue;
+            }
+
+            const Span<const unsigned char> stored(m_buffer.data() + m_offset + BlockFrame::SIZE, frame.m_stored_size);
+
+            if (!DecodeBlock(frame, stored, data)) {
+                LogPrintf("WARNING: %s: skipped corrupt block at %u", __func__, m_buffer_pos + m_offset);
+                m_offset += CMessageHeader::MESSAGE_START_SIZE;
+                continue;
+            }
+
+            pos = m_buffer_pos + m_offset + BlockFrame::SIZE;
+            m_offset += BlockFrame::SIZE + frame.m_stored_size;
+
+            return true;
+        }
+
+        m_offset += CMessageHeader::MESSAGE_START_SIZE;
+
+        if (!Fill(sizeof(uint32_t)))
+            return false;
+
+        const uint32_t size = ReadLE32(m_buffer.data() + m_offset);
+
+        // Not a block. Continue the search after the message start:
+        if (size == 0 || size > MAX_BLOCK_SIZE)
+            continue;
+
+        // The size runs past the end of the file. It may be corrupt, so
+        // continue the search after the message start:
+        if (!Fill(sizeof(uint32_t) + size))
+            continue;
+
+        const auto block_data = m_buffer.begin() + m_offset + sizeof(uint32_t);
+
+        pos = m_buffer_pos + m_offset + sizeof(uint32_t);
+        data.assign(block_data, block_data + size);
+        m_offset += sizeof(uint32_t) + size;
+
+        return true;
+    }
+
+    return false;
+}
+
+void BlockFileReader::Resync(const uint64_t pos)
+{
+    if (pos >= m_buffer_pos && pos <= m_buffer_pos + m_buffer.size()) {
+        m_offset = pos - m_buffer_pos;
+        return;
+    }
+
+    m_buffer.clear();
+    m_buffer_pos = pos;
+    m_offset = 0;
+    m_eof = fseek(m_file, pos, SEEK_SET) != 0;
+
+    if (m_eof) {
+        LogPrintf("ERROR: %s: failed to seek to %u", __func__, pos);
+    }
+}
+
+bool BlockFileReader::Fill(const size_t bytes)
+{
+    while (m_buffer.size() - m_offset < bytes) {
+        if (m_eof)
+            return false;
+
+        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + m_offset);
+        m_buffer_pos += m_offset;
+        m_offset = 0;
+
+        const size_t size = m_buffer.size();
+        m_buffer.resize(size + std::max(bytes, BLOCK_FILE_READ_SIZE));
+
+        const size_t read = fread(m_buffer.data() + size, 1, m_buffer.size() - size, m_file);
+        m_buffer.resize(size + read);
+        m_eof = read == 0;
+    }
+
+    return true;
+}
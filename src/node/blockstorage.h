@@ -8,18 +8,129 @@
 
 #include "protocol.h"
 
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
 class CBlock;
+class CBlockHeader;
 class CBlockIndex;
+class CDiskTxPos;
+class CTransaction;
 
 namespace Consensus {
 struct Params;
 }
 
+/** Block files written before version 2: the message start, the size, and the block of each record. */
+static constexpr uint32_t BLOCK_FILE_VERSION_LEGACY = 1;
+
+/**
+ * Block files that start with a file header and frame each block with its
+ * stored size, its compression, and a checksum.
+ */
+static constexpr uint32_t BLOCK_FILE_VERSION = 2;
+
+/** Default for -compressblocks. Off so that earlier versions can read the blocks at their index positions. */
+static constexpr bool DEFAULT_COMPRESS_BLOCKS = false;
+
+/** Default for -convertblockfiles. */
+static constexpr bool DEFAULT_CONVERT_BLOCK_FILES = false;
+
+/** Set by -compressblocks. Compress the blocks written to version 2 files when it saves space. */
+extern bool fCompressBlocks;
+
 bool WriteBlockToDisk(const CBlock& block, unsigned int& nFileRet, unsigned int& nBlockPosRet, const CMessageHeader::MessageStartChars& messageStart);
 
 bool ReadBlockFromDisk(CBlock& block, unsigned int nFile, unsigned int nBlockPos, const Consensus::Params& params, bool fReadTransactions=true);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& params, bool fReadTransactions=true);
 
+/**
+ * Read a transaction at a transaction index position and, optionally, the
+ * header of the block that contains it.
+ *
+ * The transaction position is the offset of the transaction in the
+ * serialized block added to the block position, so it stays valid when the
+ * block is stored compressed or its file is converted.
+ */
+bool ReadTxFromDisk(CTransaction& tx, const CDiskTxPos& pos, CBlockHeader* header);
 
-#endif // BITCOIN_NODE_BLOCKSTORAGE_H
+/** Start a new block file in the current format. Called for an empty file opened to append. */
+bool WriteBlockFileHeader(unsigned int nFile, FILE* file);
+
+/** Get the format version of a block file, or 0 if the file does not exist. */
+uint32_t GetBlockFileVersion(unsigned int nFile);
+
+/** Determine whether a block file was rewritten from a legacy file. New blocks never go to such a file. */
+bool IsConvertedBlockFile(unsigned int nFile);
 
+/** Drop the cached format and decompressed blocks of a block file that was deleted. */
+void ForgetBlockFile(unsigned int nFile);
+
+/**
+ * Rewrite a legacy block file in the version 2 format.
+ *
+ * The blocks keep their positions in the block index and the transaction
+ * index: the new file ends with a table from the legacy position of each
+ * block to its new position. The new file replaces the legacy file with one
+ * rename, so an interrupted conversion leaves the legacy file in place.
+ */
+bool ConvertBlockFile(unsigned int nFile);
+
+/** Convert the legacy block files that no longer receive new blocks, oldest first, until shutdown. */
+void ConvertBlockFiles();
+
+/**
+ * Reads a block file in large chunks and finds the blocks in it: the message
+ * start followed by the size and the serialized block in legacy files, or by
+ * the frame and the stored block in version 2 files.
+ *
+ * Replaces fseek() and fread() calls for each 64 KB window and each block
+ * with sequential reads of BLOCK_FILE_READ_SIZE bytes.
+ */
+class BlockFileReader
+{
+public:
+    explicit BlockFileReader(FILE* file);
+
+    /**
+     * Find the next block in the file.
+     *
+     * @param[out] pos  File position of the stored block.
+     * @param[out] data Serialized block. Checked and decompressed for a
+     *                  version 2 file.
+     *
+     * A size that runs past the end of the file does not stop the reader. It
+     * continues the search after the message start of the record instead.
+     *
+     * @return false at the end of the file.
+     */
+    bool Next(uint64_t& pos, std::vector<unsigned char>& data);
+
+    /**
+     * Continue the search for blocks at the specified file position.
+     *
+     * Callers use this to skip back into the data of a record when its size
+     * is corrupt and the stored block does not deserialize, because the
+     * record may have swallowed the blocks after it.
+     *
+     * @param pos File position to continue the search from.
+     */
+    void Resync(uint64_t pos);
+
+private:
+    FILE* m_file;
+    std::vector<unsigned char> m_buffer;
+    size_t m_offset = 0;       //!< Position of the reader in the buffer.
+    uint64_t m_buffer_pos = 0; //!< File position of the start of the buffer.
+    bool m_eof = false;
+    uint32_t m_version = 0;    //!< Format of the file. Zero until the first block.
+
+    /**
+     * Read from the file until the buffer holds at least the specified
+     * number of bytes after the position of the reader.
+     */
+    bool Fill(size_t bytes);
+};
+
+#endif // BITCOIN_NODE_BLOCKSTORAGE_H
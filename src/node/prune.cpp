@@ -0,0 +1,502 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "chainparams.h"
+#include "clientversion.h"
+#include "consensus/merkle.h"
+#include "gridcoin/beacon.h"
+#include "gridcoin/voting/poll.h"
+#include "main.h"
+#include "node/blockstorage.h"
+#include "node/prune.h"
+#include "txdb.h"
+#include "util.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <set>
+
+bool fPruneMode = false;
+uint64_t nPruneTarget = 0;
+
+namespace {
+//! Key of the set of pruned block files in the transaction database.
+const std::string PRUNED_FILES_KEY = "prunedfiles";
+
+//! Time kept past the longest lookback window to cover the time until the
+//! next prune: a new block file starts at most every few weeks.
+constexpr int64_t PRUNE_MARGIN = 30 * 24 * 60 * 60;
+
+//! Guards the pruned file set and the positions of the blocks that a prune
+//! relocates against the block readers that do not hold cs_main.
+std::shared_mutex g_pruned_files_mutex;
+
+//! Block files deleted by pruning. Guarded by g_pruned_files_mutex.
+std::set<unsigned int> g_pruned_files;
+
+//! Whether g_pruned_files contains any file. Readable without the lock so
+//! that block reads can check for relocated blocks while holding it.
+std::atomic<bool> g_have_pruned_files{false};
+
+//! Block file of the chain tip at the last call to PruneBlockFiles().
+unsigned int g_last_prune_check_file = 0;
+
+//!
+//! \brief Determine whether a transaction has an output that a later
+//! transaction can still spend.
+//!
+bool HasUnspentOutputs(const CTransaction& tx, const CTxIndex& txindex)
+{
+    for (size_t i = 0; i < tx.vout.size() && i < txindex.vSpent.size(); ++i) {
+        if (txindex.vSpent[i].IsNull()
+            && !tx.vout[i].IsEmpty()
+            && !tx.vout[i].scriptPubKey.IsUnspendable())
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//!
+//! \brief Get the position of the first transaction of a block written at a
+//! position in a block file.
+//!
+unsigned int GetFirstTxPos(const CBlock& block, const unsigned int block_pos)
+{
+    return block_pos
+        + ::GetSerializeSize<CBlockHeader>(block, SER_DISK, CLIENT_VERSION)
+        + GetSizeOfCompactSize(block.vtx.size());
+}
+
+//!
+//! \brief Tracks the transaction index entries that a prune rewrites so that
+//! each relocation sees the changes of the relocations before it.
+//!
+class TxIndexUpdates
+{
+public:
+    explicit TxIndexUpdates(CTxDB& txdb) : m_txdb(txdb)
+    {
+    }
+
+    bool Read(const uint256& hash, CTxIndex& txindex)
+    {
+        const auto iter = m_entries.find(hash);
+
+        if (iter != m_entries.end()) {
+            txindex = iter->second;
+            return true;
+        }
+
+        return m_txdb.ReadTxIndex(hash, txindex);
+    }
+
+    void Write(const uint256& hash, const CTxIndex& txindex)
+    {
+        m_entries[hash] = txindex;
+    }
+
+    //!
+    //! \brief Point the index entries of a relocated transaction and of the
+    //! outputs that it spends to the new position of the transaction.
+    //!
+    bool Move(const CTransaction& tx, const CDiskTxPos& old_pos, const CDiskTxPos& new_pos)
+    {
+        const uint256 hash = tx.GetHash();
+        CTxIndex txindex;
+
+        if (!Read(hash, txindex)) {
+            return false;
+        }
+
+        txindex.pos = new_pos;
+        Write(hash, txindex);
+
+        if (tx.IsCoinBase()) {
+            return true;
+        }
+
+        for (const auto& txin : tx.vin) {
+            CTxIndex prev;
+
+            if (!Read(txin.prevout.hash, prev) || txin.prevout.n >= prev.vSpent.size()) {
+                continue;
+            }
+
+            if (prev.vSpent[txin.prevout.n] == old_pos) {
+                prev.vSpent[txin.prevout.n] = new_pos;
+                Write(txin.prevout.hash, prev);
+            }
+        }
+
+        return true;
+    }
+
+    bool Commit()
+    {
+        for (const auto& entry : m_entries) {
+            if (!m_txdb.UpdateTxIndex(entry.first, entry.second)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    size_t size() const
+    {
+        return m_entries.size();
+    }
+
+private:
+    CTxDB& m_txdb;
+    std::map<uint256, CTxIndex> m_entries;
+};
+
+//!
+//! \brief A block rewritten whole to a new position.
+//!
+struct MovedBlock
+{
+    CBlockIndex* m_pindex;
+    unsigned int m_file;
+    unsigned int m_block_pos;
+};
+} // Anonymous namespace
+
+unsigned int GetMaxBlockFileSize()
+{
+    // FAT32 file size max 4GB, fseek and ftell max 2GB, so we must stay under 2GB
+    return fPruneMode ? PRUNE_BLOCKFILE_SIZE : 0x7F000000;
+}
+
+int64_t GetPruneTimeLimit(const int64_t tip_time)
+{
+    const int64_t lookback = std::max({
+        Params().GetConsensus().StandardContractReplayLookback,
+        GRC::Beacon::MAX_AGE,
+        int64_t {GRC::Poll::MAX_DURATION_DAYS} * 24 * 60 * 60,
+    });
+
+    return tip_time - lookback - PRUNE_MARGIN;
+}
+
+bool IsBlockFilePruned(const unsigned int file)
+{
+    std::shared_lock<std::shared_mutex> lock(g_pruned_files_mutex);
+
+    return g_pruned_files.count(file) > 0;
+}
+
+bool IsBlockPruned(const CBlockIndex* const pindex)
+{
+    return PrunedBlockReadLock().IsBlockPruned(pindex);
+}
+
+bool HavePrunedBlocks()
+{
+    return g_have_pruned_files;
+}
+
+PrunedBlockReadLock::PrunedBlockReadLock() : m_lock(g_pruned_files_mutex)
+{
+}
+
+bool PrunedBlockReadLock::IsBlockPruned(const CBlockIndex* const pindex) const
+{
+    return pindex && g_pruned_files.count(pindex->nFile) > 0;
+}
+
+bool IsRelocatedBlock(const CBlock& block)
+{
+    return HavePrunedBlocks() && BlockMerkleRoot(block) != block.hashMerkleRoot;
+}
+
+bool LoadPrunedBlockFiles(CTxDB& txdb)
+{
+    std::unique_lock<std::shared_mutex> lock(g_pruned_files_mutex);
+
+    g_pruned_files.clear();
+    g_have_pruned_files = false;
+    g_last_prune_check_file = 0;
+
+    // The set is absent until the first prune:
+    if (!txdb.ReadGenericSerializable(PRUNED_FILES_KEY, g_pruned_files)) {
+        g_pruned_files.clear();
+        return true;
+    }
+
+    g_have_pruned_files = !g_pruned_files.empty();
+
+    // A prune commits the set before it deletes the file:
+    for (const auto& file : g_pruned_files) {
+        const fs::path path = BlockFilePath(file);
+
+        try {
+            if (fs::remove(path)) {
+                LogPrintf("%s: removed block file %s left by an interrupted prune", __func__, path.string());
+            }
+        } catch (const fs::filesystem_error& e) {
+            return error("%s: failed to remove %s: %s", __func__, path.string(), e.what());
+        }
+    }
+
+    LogPrintf("%s: %u block files were pruned", __func__, g_pruned_files.size());
+
+    return true;
+}
+
+bool PruneBlockFile(CTxDB& txdb, const unsigned int file, const std::vector<CBlockIndex*>& blocks)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    AssertLockHeld(cs_main);
+
+    TxIndexUpdates updates(txdb);
+    std::vector<MovedBlock> moved_blocks;
+    std::set<unsigned int> written_files;
+    size_t relocated_txs = 0;
+
+    for (CBlockIndex* const pindex : blocks) {
+        CBlock block;
+
+        if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus())) {
+            return error("%s: failed to read block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+
+        // The superblocks feed the tally and the poll weights long after the
+        // retention window. Keep them whole. For other blocks, keep only the
+        // transactions that later blocks can spend from:
+        CBlock copy(block.GetBlockHeader());
+        std::vector<CDiskTxPos> old_positions;
+        unsigned int old_tx_pos = GetFirstTxPos(block, pindex->nBlockPos);
+
+        copy.vchBlockSig = block.vchBlockSig;
+
+        if (pindex->IsSuperblock()) {
+            copy.vtx = block.vtx;
+        }
+
+        for (const auto& tx : block.vtx) {
+            const CDiskTxPos old_pos(file, pindex->nBlockPos, old_tx_pos);
+            old_tx_pos += ::GetSerializeSize(tx, SER_DISK, CLIENT_VERSION);
+
+            CTxIndex txindex;
+
+            // Skip a transaction with the hash of a later one (BIP30):
+            if (!updates.Read(tx.GetHash(), txindex) || txindex.pos != old_pos) {
+                if (pindex->IsSuperblock()) {
+                    old_positions.emplace_back();
+                }
+
+                continue;
+            }
+
+            if (pindex->IsSuperblock()) {
+                old_positions.push_back(old_pos);
+            } else if (HasUnspentOutputs(tx, txindex)) {
+                copy.vtx.push_back(tx);
+                old_positions.push_back(old_pos);
+            }
+        }
+
+        if (copy.vtx.empty()) {
+            continue;
+        }
+
+        unsigned int new_file = 0;
+        unsigned int new_block_pos = 0;
+
+        if (!WriteBlockToDisk(copy, new_file, new_block_pos, Params().MessageStart())) {
+            return error("%s: failed to relocate block %s", __func__, pindex->GetBlockHash().ToString());
+        }
+
+        if (new_file == file) {
+            return error("%s: block file %u is the current block file", __func__, file);
+        }
+
+        written_files.insert(new_file);
+
+        unsigned int new_tx_pos = GetFirstTxPos(copy, new_block_pos);
+
+        for (size_t i = 0; i < copy.vtx.size(); ++i) {
+            const CDiskTxPos new_pos(new_file, new_block_pos, new_tx_pos);
+            new_tx_pos += ::GetSerializeSize(copy.vtx[i], SER_DISK, CLIENT_VERSION);
+
+            if (old_positions[i].IsNull()) {
+                continue;
+            }
+
+            if (!updates.Move(copy.vtx[i], old_positions[i], new_pos)) {
+                return error("%s: failed to read the index of tx %s", __func__, copy.vtx[i].GetHash().ToString());
+            }
+
+            ++relocated_txs;
+        }
+
+        if (pindex->IsSuperblock()) {
+            moved_blocks.push_back({ pindex, new_file, new_block_pos });
+        }
+    }
+
+    // The copies must reach the disk before the index points to them:
+    for (const auto& written_file : written_files) {
+        FILE* const fileout = OpenBlockFile(written_file, 0, "ab");
+
+        if (!fileout || !FileCommit(fileout)) {
+            if (fileout) fclose(fileout);
+            return error("%s: failed to flush block file %u", __func__, written_file);
+        }
+
+        fclose(fileout);
+    }
+
+    std::set<unsigned int> pruned_files;
+
+    {
+        std::shared_lock<std::shared_mutex> lock(g_pruned_files_mutex);
+        pruned_files = g_pruned_files;
+    }
+
+    pruned_files.insert(file);
+
+    if (!txdb.TxnBegin()) {
+        return error("%s: TxnBegin failed", __func__);
+    }
+
+    bool ok = updates.Commit();
+
+    for (const auto& moved : moved_blocks) {
+        CDiskBlockIndex disk_index(moved.m_pindex);
+        disk_index.nFile = moved.m_file;
+        disk_index.nBlockPos = moved.m_block_pos;
+
+        ok = ok && txdb.WriteBlockIndex(disk_index);
+    }
+
+    ok = ok && txdb.WriteGenericSerializable(PRUNED_FILES_KEY, pruned_files);
+
+    if (!ok || !txdb.TxnCommit()) {
+        txdb.TxnAbort();
+        return error("%s: failed to update the index for block file %u", __func__, file);
+    }
+
+    // Wait for the readers of the old block positions to finish:
+    {
+        std::unique_lock<std::shared_mutex> lock(g_pruned_files_mutex);
+
+        for (const auto& moved : moved_blocks) {
+            moved.m_pindex->nFile = moved.m_file;
+            moved.m_pindex->nBlockPos = moved.m_block_pos;
+        }
+
+        g_pruned_files.insert(file);
+        g_have_pruned_files = true;
+        ForgetBlockFile(file);
+
+        const fs::path path = BlockFilePath(file);
+
+        try {
+            fs::remove(path);
+        } catch (const fs::filesystem_error& e) {
+            // The next start finishes the removal:
+            LogPrintf("WARNING: %s: failed to remove %s: %s", __func__, path.string(), e.what());
+        }
+    }
+
+    LogPrintf("%s: pruned block file %u of %u blocks: relocated %u superblocks and %u transactions",
+              __func__,
+              file,
+              blocks.size(),
+              moved_blocks.size(),
+              relocated_txs);
+
+    return true;
+}
+
+bool PruneBlockFiles(CTxDB& txdb) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    AssertLockHeld(cs_main);
+
+    if (!fPruneMode || !pindexBest || pindexBest->nFile == g_last_prune_check_file) {
+        return true;
+    }
+
+    g_last_prune_check_file = pindexBest->nFile;
+
+    std::map<unsigned int, uint64_t> file_sizes;
+    uint64_t total_size = 0;
+
+    for (unsigned int file = 1; ; ++file) {
+        if (IsBlockFilePruned(file)) {
+            continue;
+        }
+
+        const fs::path path = BlockFilePath(file);
+
+        if (!fs::exists(path)) {
+            break;
+        }
+
+        file_sizes[file] = fs::file_size(path);
+        total_size += file_sizes[file];
+    }
+
+    if (total_size <= nPruneTarget || file_sizes.size() < 2) {
+        return true;
+    }
+
+    std::map<unsigned int, int64_t> newest_block_times;
+
+    for (const auto& iter : mapBlockIndex) {
+        int64_t& newest = newest_block_times[iter.second->nFile];
+        newest = std::max(newest, iter.second->GetBlockTime());
+    }
+
+    const int64_t time_limit = GetPruneTimeLimit(pindexBest->GetBlockTime());
+    const unsigned int last_file = file_sizes.rbegin()->first;
+
+    for (const auto& file_size : file_sizes) {
+        const unsigned int file = file_size.first;
+
+        if (total_size <= nPruneTarget
+            || file == last_file
+            || file == pindexBest->nFile
+            || newest_block_times[file] > time_limit)
+        {
+            break;
+        }
+
+        std::vector<CBlockIndex*> blocks;
+
+        for (const auto& iter : mapBlockIndex) {
+            if (iter.second->nFile == file && iter.second->IsInMainChain()) {
+                blocks.push_back(iter.second);
+            }
+        }
+
+        std::sort(blocks.begin(), blocks.end(), [](const CBlockIndex* a, const CBlockIndex* b) {
+            return a->nHeight < b->nHeight;
+        });
+
+        if (!PruneBlockFile(txdb, file, blocks)) {
+            return false;
+        }
+
+        total_size -= file_size.second;
+    }
+
+    if (total_size > nPruneTarget) {
+        LogPrint(BCLog::LogFlags::VERBOSE,
+                 "%s: block files take %u MiB above the target of %u MiB to keep the retention window",
+                 __func__,
+                 (total_size - nPruneTarget) >> 20,
+                 nPruneTarget >> 20);
+    }
+
+    return true;
+}
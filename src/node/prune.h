@@ -0,0 +1,134 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_PRUNE_H
+#define BITCOIN_NODE_PRUNE_H
+
+#include "sync.h"
+
+#include <cstdint>
+#include <shared_mutex>
+#include <vector>
+
+class CBlock;
+class CBlockIndex;
+class CTxDB;
+
+extern CCriticalSection cs_main;
+
+//! Smallest -prune target in MiB. The retention window can need more.
+static constexpr uint64_t MIN_PRUNE_TARGET_MIB = 1024;
+
+//! Size at which a node in pruning mode starts a new block file.
+static constexpr unsigned int PRUNE_BLOCKFILE_SIZE = 128 * 1024 * 1024;
+
+//! Set by -prune. Old block files are deleted to stay under the target.
+extern bool fPruneMode;
+
+//! Target size in bytes of the block files set by -prune.
+extern uint64_t nPruneTarget;
+
+//!
+//! \brief Get the size at which AppendBlockFile() starts a new block file.
+//!
+unsigned int GetMaxBlockFileSize();
+
+//!
+//! \brief Get the timestamp of the newest block that pruning may remove.
+//!
+//! Every lookback window that starts from the chain tip fits within the
+//! retention window: the contract replay, the beacon age, the longest poll,
+//! and the tally. A margin covers the time until the next prune.
+//!
+//! \param tip_time Timestamp of the chain tip.
+//!
+int64_t GetPruneTimeLimit(int64_t tip_time);
+
+//!
+//! \brief Determine whether a block file was deleted by pruning.
+//!
+bool IsBlockFilePruned(unsigned int file);
+
+//!
+//! \brief Determine whether the data of a block was deleted by pruning.
+//!
+//! The block index entry remains. The transactions with unspent outputs of
+//! the block stay readable at the positions in the transaction index.
+//!
+bool IsBlockPruned(const CBlockIndex* pindex);
+
+//!
+//! \brief Determine whether the node deleted any block files.
+//!
+bool HavePrunedBlocks();
+
+//!
+//! \brief Keeps a prune from moving blocks or deleting a block file while
+//! the holder reads a block at the position in its block index entry.
+//!
+//! Block readers do not hold cs_main. A prune takes the lock exclusively to
+//! publish the new block positions and to delete the file. Do not call the
+//! other functions of this header while holding one.
+//!
+class PrunedBlockReadLock
+{
+public:
+    PrunedBlockReadLock();
+
+    //!
+    //! \brief Determine whether the data of a block was deleted by pruning.
+    //!
+    bool IsBlockPruned(const CBlockIndex* pindex) const;
+
+private:
+    std::shared_lock<std::shared_mutex> m_lock;
+};
+
+//!
+//! \brief Determine whether a block read from a transaction index position
+//! is a stub that pruning relocated: the header of the original block and
+//! only some of its transactions.
+//!
+bool IsRelocatedBlock(const CBlock& block);
+
+//!
+//! \brief Load the set of pruned block files from the transaction database
+//! and finish deleting the files of an interrupted prune.
+//!
+//! \return \c false if the set cannot be read.
+//!
+bool LoadPrunedBlockFiles(CTxDB& txdb);
+
+//!
+//! \brief Delete one block file after relocating the data still needed from
+//! the blocks in it.
+//!
+//! Superblocks move whole to the current block file and the block index
+//! entries follow them. For every other block, a stub with the header, the
+//! coinbase, the coinstake, and the transactions that still have unspent
+//! outputs moves to the current block file, and the transaction index points
+//! to the copies. The pruned file set and the new positions commit in one
+//! database transaction before the file is deleted.
+//!
+//! \param txdb   Transaction database to update.
+//! \param file   Number of the block file to delete.
+//! \param blocks Main chain blocks stored in the file, in height order.
+//!
+//! \return \c false if the data cannot be relocated. The file then remains.
+//!
+bool PruneBlockFile(CTxDB& txdb, unsigned int file, const std::vector<CBlockIndex*>& blocks)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+//!
+//! \brief Delete the oldest block files outside of the retention window
+//! until the block files fit in the -prune target.
+//!
+//! Does nothing unless pruning is enabled and the chain tip moved to a new
+//! block file since the last call.
+//!
+//! \return \c false if a block file cannot be pruned.
+//!
+bool PruneBlockFiles(CTxDB& txdb) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+#endif // BITCOIN_NODE_PRUNE_H
@@ -47,6 +47,8 @@ std::string CTxOut::ToString() const
 }
 
 
+std::atomic<uint64_t> CTransaction::m_hash_computations{0};
+
 std::string CTransaction::ToStringShort() const
 {
     std::string str;
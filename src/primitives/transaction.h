@@ -11,6 +11,7 @@
 #include "script.h"
 #include "serialize.h"
 
+#include <atomic>
 #include <stdexcept>
 
 /** An inpoint - a combination of a transaction and an index n into its vin */
@@ -232,6 +233,10 @@ public:
     template <typename Stream, typename Operation>
     inline void SerializationOp(Stream& s, Operation ser_action)
     {
+        if (ser_action.ForRead()) {
+            m_hash_cache = HashCache();
+        }
+
         READWRITE(nVersion);
         READWRITE(nTime);
         READWRITE(vin);
@@ -255,6 +260,7 @@ public:
         nDoS = 0;  // Denial-of-service prevention
         hashBoinc = "";
         vContracts.clear();
+        m_hash_cache = HashCache();
     }
 
     bool IsNull() const
@@ -264,7 +270,46 @@ public:
 
     uint256 GetHash() const
     {
-        return SerializeHash(*this);
+        if (!m_hash_cache.m_hash.IsNull()) {
+            return m_hash_cache.m_hash;
+        }
+
+        return ComputeHash();
+    }
+
+    //!
+    //! \brief Compute the hash of the transaction once and return it from
+    //! GetHash() from now on.
+    //!
+    //! The validation pipeline hashes the same transaction many times: for the
+    //! merkle root, the transaction index, the mempool, the wallet, and the log
+    //! messages. It caches the hashes of the transactions that it receives once
+    //! they can no longer change: the transactions of a block that it processes
+    //! or connects and the transactions that it adds to the memory pool.
+    //!
+    //! The fields of a transaction remain public for the miner and the wallet,
+    //! so the cache cannot detect changes. Do NOT modify a transaction after
+    //! caching its hash. Deserialization and SetNull() clear the cache. Copies
+    //! and moves do not take the cache with them, so a copy of a transaction
+    //! is always safe to modify.
+    //!
+    //! Call this while no other thread can read the transaction.
+    //!
+    void CacheHash()
+    {
+        if (m_hash_cache.m_hash.IsNull()) {
+            m_hash_cache.m_hash = ComputeHash();
+        }
+    }
+
+    //!
+    //! \brief Get the number of times that any transaction computed its hash.
+    //!
+    //! For benchmarks that count the hashes computed by each block.
+    //!
+    static uint64_t GetHashComputations()
+    {
+        return m_hash_computations.load(std::memory_order_relaxed);
     }
 
     bool IsCoinBase() const
@@ -340,6 +385,30 @@ public:
         return std::move(vContracts);
     }
 
+private:
+    //!
+    //! \brief Holds the cached hash. Copies and moves start empty so that the
+    //! cache stays with the transaction object that set it.
+    //!
+    struct HashCache
+    {
+        uint256 m_hash;
+
+        HashCache() = default;
+        HashCache(const HashCache&) {}
+        HashCache& operator=(const HashCache&) { m_hash.SetNull(); return *this; }
+    };
+
+    static std::atomic<uint64_t> m_hash_computations;
+
+    HashCache m_hash_cache;
+
+    uint256 ComputeHash() const
+    {
+        m_hash_computations.fetch_add(1, std::memory_order_relaxed);
+
+        return SerializeHash(*this);
+    }
 };
 
 #endif // BITCOIN_PRIMITIVES_TRANSACTION_H
@@ -339,50 +339,42 @@ void MRCModel::refresh() EXCLUSIVE_LOCKS_REQUIRED(cs_main)
 
     bool found{false};
 
-    // This sorts the MRCs in descending order of MRC fees to allow determination of the payout limit fee.
+    // The memory pool keeps the MRCs in descending order of MRC fees, which allows determination of the payout limit
+    // fee without sorting the mempool here.
+    {
+        LOCK(mempool.cs);
 
-    // ---------- mrc fee --- mrc ------ descending order
-    std::multimap<CAmount, GRC::MRC, std::greater<CAmount>> mrc_multimap;
+        const CTxMemPool::MRCFeeIndex& mrcs_by_fee = mempool.GetMRCsByFee();
 
-    for (const auto& [_, tx] : mempool.mapTx) {
-        if (!tx.GetContracts().empty()) {
-            // By protocol the MRC contract MUST be the only one in the transaction.
-            const GRC::Contract& contract = tx.GetContracts()[0];
+        for (const auto& [mempool_mrc_fee, tx_hash] : mrcs_by_fee) {
+            for (const auto& mempool_mrc_cpid : mempool.GetEntry(tx_hash)->GetMRCCpids()) {
+                found |= m_mrc.m_mining_id == mempool_mrc_cpid;
+            }
 
-            if (contract.m_type == GRC::ContractType::MRC) {
-                GRC::MRC mempool_mrc = contract.CopyPayloadAs<GRC::MRC>();
+            if (!found && mempool_mrc_fee >= m_mrc.m_fee) ++m_mrc_pos;
+            m_mrc_queue_head_fee = std::max(m_mrc_queue_head_fee, mempool_mrc_fee);
+            m_mrc_queue_tail_fee = std::min(m_mrc_queue_tail_fee, mempool_mrc_fee);
 
-                mrc_multimap.insert(std::make_pair(mempool_mrc.m_fee, mempool_mrc));
-            } // match to mrc contract type
-        } // contract present in transaction?
-    }
-
-    for (const auto& [_, mempool_mrc] : mrc_multimap) {
-        found |= m_mrc.m_mining_id == mempool_mrc.m_mining_id;
-
-        if (!found && mempool_mrc.m_fee >= m_mrc.m_fee) ++m_mrc_pos;
-        m_mrc_queue_head_fee = std::max(m_mrc_queue_head_fee, mempool_mrc.m_fee);
-        m_mrc_queue_tail_fee = std::min(m_mrc_queue_tail_fee, mempool_mrc.m_fee);
-
-        ++m_mrc_queue_length;
-    }
+            ++m_mrc_queue_length;
+        }
 
-    // The tail fee converges from the max numeric limit of CAmount; however, when the above loop is done
-    // it cannot end up with a number higher than the head fee. This can happen if there are no MRC transactions
-    // in the loop.
-    m_mrc_queue_tail_fee = std::min(m_mrc_queue_head_fee, m_mrc_queue_tail_fee);
+        // The tail fee converges from the max numeric limit of CAmount; however, when the above loop is done
+        // it cannot end up with a number higher than the head fee. This can happen if there are no MRC transactions
+        // in the loop.
+        m_mrc_queue_tail_fee = std::min(m_mrc_queue_head_fee, m_mrc_queue_tail_fee);
 
-    // Here we select the minimum of the mrc_multimap.size() - 1 in the case where the multimap does not reach the
-    // m_mrc_output_limit - 1, or the m_mrc_output_limit - 1 if the multimap indicates the queue is (over)full,
-    // i.e. the number of MRC's in the queue exceeds the m_mrc_output_limit for paying in a block.
-    int pay_limit_fee_pos = std::min<int>(mrc_multimap.size(), m_mrc_output_limit) - 1;
+        // Here we select the minimum of the number of MRCs in the mempool - 1 in the case where the queue does not reach
+        // the m_mrc_output_limit - 1, or the m_mrc_output_limit - 1 if the index indicates the queue is (over)full,
+        // i.e. the number of MRC's in the queue exceeds the m_mrc_output_limit for paying in a block.
+        int pay_limit_fee_pos = std::min<int>(mrcs_by_fee.size(), m_mrc_output_limit) - 1;
 
-    if (pay_limit_fee_pos >= 0) {
-        std::multimap<CAmount, GRC::MRC, std::greater<CAmount>>::iterator iter = mrc_multimap.begin();
+        if (pay_limit_fee_pos >= 0) {
+            CTxMemPool::MRCFeeIndex::const_iterator iter = mrcs_by_fee.begin();
 
-        std::advance(iter, pay_limit_fee_pos);
+            std::advance(iter, pay_limit_fee_pos);
 
-        m_mrc_queue_pay_limit_fee = iter->first;
+            m_mrc_queue_pay_limit_fee = iter->first;
+        }
     }
 
     m_mrc_queue_pay_limit_fee = std::min(m_mrc_queue_head_fee, m_mrc_queue_pay_limit_fee);
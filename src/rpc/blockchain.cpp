@@ -9,11 +9,15 @@
 #include "gridcoin/scraper/scraper_registry.h"
 #include "gridcoin/sidestake.h"
 #include "node/blockstorage.h"
+#include "node/prune.h"
 #include <util/string.h>
 #include "gridcoin/mrc.h"
 #include "gridcoin/support/block_finder.h"
+#include "index/addressindex.h"
 
 #include <univalue.h>
+#include <limits>
+#include <optional>
 #include <stdexcept>
 
 extern CCriticalSection cs_ConvergedScraperStatsCache;
@@ -155,6 +159,13 @@ UniValue SuperblockToJson(const GRC::SuperblockPtr& superblock)
     return SuperblockToJson(*superblock);
 }
 
+void EnsureBlockNotPruned(const CBlockIndex* pindex)
+{
+    if (IsBlockPruned(pindex)) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Block not available (pruned data)");
+    }
+}
+
 UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool fPrintTransactionDetail)
 {
     UniValue result(UniValue::VOBJ);
@@ -347,6 +358,8 @@ UniValue dumpcontracts(const UniValue& params, bool fHelp)
         if (pblockindex->nHeight == low_height) break;
     }
 
+    EnsureBlockNotPruned(pblockindex);
+
     // From this point we have to go down two somewhat different paths based on whether a minimalist text output
     // is desired or the full serialization output.
     if (txids_only) {
@@ -570,6 +583,7 @@ UniValue getmrcinfo(const UniValue& params, bool fHelp)
             continue;
         }
 
+        EnsureBlockNotPruned(blockindex);
         ReadBlockFromDisk(block, blockindex, Params().GetConsensus());
 
         // Get the claim which is where MRCs are actually paid.
@@ -759,6 +773,7 @@ UniValue showblock(const UniValue& params, bool fHelp)
 
     if (pblockindex == nullptr)
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+    EnsureBlockNotPruned(pblockindex);
     CBlock block;
     ReadBlockFromDisk(block, pblockindex, Params().GetConsensus());
     return blockToJSON(block, pblockindex, false);
@@ -896,6 +911,7 @@ UniValue getblock(const UniValue& params, bool fHelp)
 
     CBlock block;
     CBlockIndex* pblockindex = mapBlockIndex[hash];
+    EnsureBlockNotPruned(pblockindex);
     ReadBlockFromDisk(block, pblockindex, Params().GetConsensus());
 
     return blockToJSON(block, pblockindex, params.size() > 1 ? params[1].get_bool() : false);
@@ -920,6 +936,7 @@ UniValue getblockbynumber(const UniValue& params, bool fHelp)
     CBlock block;
 
     CBlockIndex* pblockindex = GRC::BlockFinder::FindByHeight(nHeight);
+    EnsureBlockNotPruned(pblockindex);
     ReadBlockFromDisk(block, pblockindex, Params().GetConsensus());
 
     return blockToJSON(block, pblockindex, params.size() > 1 ? params[1].get_bool() : false);
@@ -945,12 +962,13 @@ UniValue getblockbymintime(const UniValue& params, bool fHelp)
     CBlock block;
 
     CBlockIndex* pblockindex = GRC::BlockFinder::FindByMinTime(nTimestamp);
+    EnsureBlockNotPruned(pblockindex);
     ReadBlockFromDisk(block, pblockindex, Params().GetConsensus());
 
     return blockToJSON(block, pblockindex, params.size() > 1 ? params[1].get_bool() : false);
 }
 
-UniValue getblocksbatch(const UniValue& params, bool fHelp)
+void getblocksbatch(const UniValue& params, bool fHelp, JSONWriter& result)
 {
     g_timer.InitTimer(__func__, LogInstance().WillLogCategory(BCLog::LogFlags::RPC));
 
@@ -970,9 +988,6 @@ UniValue getblocksbatch(const UniValue& params, bool fHelp)
                 "the given block-number or hash.\n");
     }
 
-    UniValue result(UniValue::VOBJ);
-    UniValue blocks(UniValue::VARR);
-
     int nHeight = 0;
     uint256 hash;
     bool block_hash_provided = false;
@@ -1025,62 +1040,436 @@ UniValue getblocksbatch(const UniValue& params, bool fHelp)
     bool transaction_details = false;
     if (params.size() > 2) transaction_details = params[2].get_bool();
 
-    LOCK(cs_main);
+    std::vector<CBlockIndex*> batch;
+
+    {
+        LOCK(cs_main);
 
-    g_timer.GetTimes("Finished validating parameters", __func__);
+        g_timer.GetTimes("Finished validating parameters", __func__);
 
-    CBlockIndex* pblockindex_head = nullptr;
-    CBlockIndex* pblockindex = nullptr;
+        CBlockIndex* pblockindex_head = nullptr;
+        CBlockIndex* pblockindex = nullptr;
 
-    // Find the starting block's index entry point by either rewinding from the head (if the block number was
-    // provided), or directly from the mapBlockIndex, if the hash was provided.
+        // Find the starting block's index entry point by either rewinding from the head (if the block number was
+        // provided), or directly from the mapBlockIndex, if the hash was provided.
 
-    // Select the block index for the head of the chain.
-    pblockindex_head = mapBlockIndex[hashBestChain];
+        // Select the block index for the head of the chain.
+        pblockindex_head = mapBlockIndex[hashBestChain];
 
-    if (!block_hash_provided)
+        if (!block_hash_provided)
+        {
+            pblockindex = pblockindex_head;
+
+            // Rewind to the block corresponding to the specified height.
+            while (pblockindex->nHeight > nHeight)
+            {
+                pblockindex = pblockindex->pprev;
+            }
+
+        }
+        else
+        {
+            pblockindex = mapBlockIndex[hash];
+        }
+
+        g_timer.GetTimes("Finished finding starting block", __func__);
+
+        // Collect the batch up front so that the result can start with the count:
+        while (pblockindex && (int) batch.size() < batch_size)
+        {
+            batch.push_back(pblockindex);
+
+            if (pblockindex == pblockindex_head) break;
+
+            pblockindex = pblockindex->pnext;
+        }
+    }
+
+    result.BeginObject();
+    result.PushKV("block_count", (int) batch.size());
+    result.Key("blocks");
+    result.BeginArray();
+
+    // Format one block at a time and hand it to the writer outside of the lock.
+    // A streaming writer may block while the client receives the data.
+    for (CBlockIndex* pblockindex : batch)
     {
-        pblockindex = pblockindex_head;
+        UniValue block_json;
 
-        // Rewind to the block corresponding to the specified height.
-        while (pblockindex->nHeight > nHeight)
         {
-            pblockindex = pblockindex->pprev;
+            LOCK(cs_main);
+
+            EnsureBlockNotPruned(pblockindex);
+
+            CBlock block;
+            if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
+            {
+                throw runtime_error("Error reading block from specified batch.");
+            }
+
+            block_json = blockToJSON(block, pblockindex, transaction_details);
         }
 
+        result.Value(block_json);
     }
-    else
+
+    result.EndArray();
+    result.EndObject();
+
+    g_timer.GetTimes("Finished populating result for block batch", __func__);
+}
+
+namespace {
+//!
+//! \brief Get the address index and parse the address parameter of an address
+//! index RPC.
+//!
+const AddressIndex& GetAddressIndexForRPC(const UniValue& param, AddressKey& address)
+{
+    const AddressIndex& index = GetAddressIndex();
+
+    if (!index.Enabled()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "The address index is disabled. Restart the wallet with -addressindex.");
+    }
+
+    address = AddressKey::Parse(param.get_str());
+
+    if (address.IsNull()) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address or script.");
+    }
+
+    return index;
+}
+
+//!
+//! \brief Maximum number of history entries that one getaddressbalance call
+//! reads to total the amounts received and spent by an address.
+//!
+constexpr size_t MAX_BALANCE_HISTORY_ENTRIES = 10 * AddressIndex::MAX_QUERY_RESULTS;
+
+//!
+//! \brief Parse the optional skip and count parameters of an address index RPC.
+//!
+void ParseAddressPaging(const UniValue& params, const size_t first, size_t& skip, size_t& count)
+{
+    skip = 0;
+    count = 100;
+
+    if (params.size() > first) {
+        const int value = params[first].get_int();
+
+        if (value < 0) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "skip must not be negative.");
+        }
+
+        skip = value;
+    }
+
+    if (params.size() > first + 1) {
+        const int value = params[first + 1].get_int();
+
+        if (value < 1 || (size_t) value > AddressIndex::MAX_QUERY_RESULTS) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("count must be between 1 and %u, inclusive.",
+                                                                AddressIndex::MAX_QUERY_RESULTS));
+        }
+
+        count = value;
+    }
+}
+} // Anonymous namespace
+
+void getaddresshistory(const UniValue& params, bool fHelp, JSONWriter& result)
+{
+    if (fHelp || params.size() < 1 || params.size() > 4)
     {
-        pblockindex = mapBlockIndex[hash];
+        throw runtime_error(
+                "getaddresshistory <address or script> [start height] [skip] [count]\n"
+                "\n"
+                "<address or script> an address, or the hex output script for outputs\n"
+                "without an address\n"
+                "\n"
+                "[start height] optional height of the first block to include (default: 0)\n"
+                "\n"
+                "[skip] optional number of entries to skip from the start height (default: 0)\n"
+                "\n"
+                "[count] optional maximum number of entries to return (default: 100,\n"
+                "limited to 10000)\n"
+                "\n"
+                "Returns the outputs that pay to the address and the inputs that spend\n"
+                "them in chain order. Requires -addressindex. Page through a long history\n"
+                "by passing next_height and next_skip of a result to the next call.\n");
     }
 
-    g_timer.GetTimes("Finished finding starting block", __func__);
+    AddressKey address;
+    const AddressIndex& index = GetAddressIndexForRPC(params[0], address);
+
+    const int start_height = params.size() > 1 ? params[1].get_int() : 0;
+    size_t skip;
+    size_t count;
+
+    ParseAddressPaging(params, 2, skip, count);
+
+    CTxDB txdb("r");
+    std::vector<AddressHistoryEntry> entries;
+    bool more = false;
+    int skipped_height = -1; // Height of the last skipped entry.
+    int skipped_at_height = 0;
+
+    index.ReadHistory(txdb, address, start_height, [&](const AddressHistoryEntry& entry) {
+        if (skip > 0) {
+            if (entry.m_height != skipped_height) {
+                skipped_height = entry.m_height;
+                skipped_at_height = 0;
+            }
+
+            ++skipped_at_height;
+            --skip;
+
+            return true;
+        }
+
+        if (entries.size() == count) {
+            more = true;
+            return false;
+        }
+
+        entries.push_back(entry);
+
+        return true;
+    });
 
-    int i = 0;
-    while (i < batch_size)
+    result.BeginObject();
+    result.PushKV("address", address.ToString());
+    result.PushKV("index_complete", index.Complete());
+    result.PushKV("count", (int) entries.size());
+    result.Key("entries");
+    result.BeginArray();
+
+    for (const auto& entry : entries)
     {
-        CBlock block;
-        if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
-        {
-            throw runtime_error("Error reading block from specified batch.");
+        UniValue json(UniValue::VOBJ);
+
+        json.pushKV("txid", entry.m_txid.GetHex());
+        json.pushKV("height", entry.m_height);
+        json.pushKV("type", entry.m_spending ? "input" : "output");
+        json.pushKV(entry.m_spending ? "input" : "vout", (uint64_t) entry.m_index);
+        json.pushKV("amount", ValueFromAmount(entry.m_amount));
+
+        if (entry.m_spending) {
+            json.pushKV("prevout_txid", entry.m_prevout.hash.GetHex());
+            json.pushKV("prevout_vout", (uint64_t) entry.m_prevout.n);
+        } else if (const auto spent = index.ReadSpentBy(txdb, COutPoint(entry.m_txid, entry.m_index))) {
+            UniValue spent_json(UniValue::VOBJ);
+
+            spent_json.pushKV("txid", spent->m_txid.GetHex());
+            spent_json.pushKV("input", (uint64_t) spent->m_input);
+            spent_json.pushKV("height", spent->m_height);
+
+            json.pushKV("spent_by", spent_json);
         }
 
-        blocks.push_back(blockToJSON(block, pblockindex, transaction_details));
-        ++i;
+        result.Value(json);
+    }
+
+    result.EndArray();
 
-        if (pblockindex == pblockindex_head) break;
+    if (more) {
+        // Resume after the last entry: skip the entries at its height that
+        // this call returned or skipped.
+        const int next_height = entries.back().m_height;
+        int next_skip = 0;
 
-        pblockindex = pblockindex->pnext;
+        for (auto iter = entries.rbegin(); iter != entries.rend() && iter->m_height == next_height; ++iter) {
+            ++next_skip;
+        }
+
+        if (entries.front().m_height == next_height && skipped_height == next_height) {
+            next_skip += skipped_at_height;
+        }
+
+        result.PushKV("next_height", next_height);
+        result.PushKV("next_skip", next_skip);
     }
 
-    result.pushKV("block_count", i);
-    result.pushKV("blocks", blocks);
+    result.EndObject();
+}
 
-    g_timer.GetTimes("Finished populating result for block batch", __func__);
+UniValue getaddressbalance(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() < 1 || params.size() > 3)
+    {
+        throw runtime_error(strprintf(
+                "getaddressbalance <address or script> [start height] [end height]\n"
+                "\n"
+                "<address or script> an address, or the hex output script for outputs\n"
+                "without an address\n"
+                "\n"
+                "[start height] optional height of the first block to total (default: 0)\n"
+                "\n"
+                "[end height] optional height of the last block to total (default: the\n"
+                "chain tip)\n"
+                "\n"
+                "Returns the current balance of the address and the totals that it\n"
+                "received and spent in the blocks of the height range. Requires\n"
+                "-addressindex. One call totals at most %u history entries. When\n"
+                "the range holds more, pass next_height of the result as the start\n"
+                "height of the next call and add up the totals.\n",
+                MAX_BALANCE_HISTORY_ENTRIES));
+    }
+
+    AddressKey address;
+    const AddressIndex& index = GetAddressIndexForRPC(params[0], address);
+
+    const int start_height = params.size() > 1 ? params[1].get_int() : 0;
+    const int end_height = params.size() > 2 ? params[2].get_int() : std::numeric_limits<int>::max();
+
+    if (end_height < start_height) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "end height must not be below the start height.");
+    }
+
+    CTxDB txdb("r");
+    CAmount balance = 0;
+    CAmount received = 0;
+    CAmount spent = 0;
+    int unspent_count = 0;
+    int tx_count = 0;
+    uint256 last_txid;
+    size_t history_entries = 0;
+    int last_height = -1;
+    std::optional<int> next_height;
+
+    index.ReadUnspent(txdb, address, [&](const AddressUnspentEntry& entry) {
+        balance += entry.m_amount;
+        ++unspent_count;
+
+        return true;
+    });
+
+    index.ReadHistory(txdb, address, start_height, [&](const AddressHistoryEntry& entry) {
+        if (entry.m_height > end_height) {
+            return false;
+        }
+
+        // Stop at a block boundary so that the next call resumes from
+        // next_height without counting any entry twice:
+        if (history_entries >= MAX_BALANCE_HISTORY_ENTRIES && entry.m_height != last_height) {
+            next_height = entry.m_height;
+            return false;
+        }
+
+        ++history_entries;
+        last_height = entry.m_height;
+
+        if (entry.m_spending) {
+            spent -= entry.m_amount;
+        } else {
+            received += entry.m_amount;
+        }
+
+        if (entry.m_txid != last_txid) {
+            last_txid = entry.m_txid;
+            ++tx_count;
+        }
+
+        return true;
+    });
+
+    UniValue result(UniValue::VOBJ);
+
+    result.pushKV("address", address.ToString());
+    result.pushKV("index_complete", index.Complete());
+    result.pushKV("balance", ValueFromAmount(balance));
+    result.pushKV("received", ValueFromAmount(received));
+    result.pushKV("spent", ValueFromAmount(spent));
+    result.pushKV("unspent_outputs", unspent_count);
+    result.pushKV("transactions", tx_count);
+
+    if (next_height) {
+        result.pushKV("next_height", *next_height);
+    }
 
     return result;
 }
 
+void getaddressutxos(const UniValue& params, bool fHelp, JSONWriter& result)
+{
+    if (fHelp || params.size() < 1 || params.size() > 3)
+    {
+        throw runtime_error(
+                "getaddressutxos <address or script> [skip] [count]\n"
+                "\n"
+                "<address or script> an address, or the hex output script for outputs\n"
+                "without an address\n"
+                "\n"
+                "[skip] optional number of outputs to skip (default: 0)\n"
+                "\n"
+                "[count] optional maximum number of outputs to return (default: 100,\n"
+                "limited to 10000)\n"
+                "\n"
+                "Returns the unspent outputs of the address in the order of their\n"
+                "transaction hashes. Requires -addressindex.\n");
+    }
+
+    AddressKey address;
+    const AddressIndex& index = GetAddressIndexForRPC(params[0], address);
+
+    size_t skip;
+    size_t count;
+
+    ParseAddressPaging(params, 1, skip, count);
+
+    int best_height;
+
+    {
+        LOCK(cs_main);
+        best_height = nBestHeight;
+    }
+
+    CTxDB txdb("r");
+    std::vector<AddressUnspentEntry> entries;
+    bool more = false;
+
+    index.ReadUnspent(txdb, address, [&](const AddressUnspentEntry& entry) {
+        if (skip > 0) {
+            --skip;
+            return true;
+        }
+
+        if (entries.size() == count) {
+            more = true;
+            return false;
+        }
+
+        entries.push_back(entry);
+
+        return true;
+    });
+
+    result.BeginObject();
+    result.PushKV("address", address.ToString());
+    result.PushKV("index_complete", index.Complete());
+    result.PushKV("count", (int) entries.size());
+    result.PushKV("more", more);
+    result.Key("utxos");
+    result.BeginArray();
+
+    for (const auto& entry : entries)
+    {
+        UniValue json(UniValue::VOBJ);
+
+        json.pushKV("txid", entry.m_outpoint.hash.GetHex());
+        json.pushKV("vout", (uint64_t) entry.m_outpoint.n);
+        json.pushKV("amount", ValueFromAmount(entry.m_amount));
+        json.pushKV("height", entry.m_height);
+        json.pushKV("confirmations", std::max(best_height - entry.m_height + 1, 0));
+
+        result.Value(json);
+    }
+
+    result.EndArray();
+    result.EndObject();
+}
+
 UniValue backupprivatekeys(const UniValue& params, bool fHelp)
 {
     if (fHelp || params.size() != 0)
@@ -1774,7 +2163,7 @@ UniValue beaconstatus(const UniValue& params, bool fHelp)
     return res;
 }
 
-UniValue beaconaudit(const UniValue& params, bool fHelp)
+void beaconaudit(const UniValue& params, bool fHelp, JSONWriter& result)
 {
     if (fHelp || params.size() > 2)
         throw runtime_error(
@@ -1834,6 +2223,8 @@ UniValue beaconaudit(const UniValue& params, bool fHelp)
 
     // This form of block index traversal starts at the first V11 block and continues to pIndexBest (inclusive).
     while (block_index) {
+        EnsureBlockNotPruned(block_index);
+
         CBlock block;
 
         if (!ReadBlockFromDisk(block, block_index, Params().GetConsensus())) {
@@ -1886,11 +2277,12 @@ UniValue beaconaudit(const UniValue& params, bool fHelp)
               cpids.size(),
               beacon_contracts.size());
 
-    UniValue res(UniValue::VOBJ);
-    UniValue beacons_to_output(UniValue::VARR);
-
     GRC::BeaconRegistry& beacon_registry = GRC::GetBeaconRegistry();
 
+    result.BeginObject();
+    result.Key("cpids_with_more_than_one_beacon_contract_in_block");
+    result.BeginArray();
+
     for (const auto& cpid_to_output : cpids) {
         UniValue beacon_contracts_output(UniValue::VARR);
         auto beacon_contracts_to_output = beacon_contracts.equal_range(cpid_to_output);
@@ -1963,13 +2355,12 @@ UniValue beaconaudit(const UniValue& params, bool fHelp)
         if (!beacon_contracts_output.empty()) {
             beacon.pushKV("cpid", cpid_to_output.ToString());
             beacon.pushKV("contracts", beacon_contracts_output);
-            beacons_to_output.push_back(beacon);
+            result.Value(beacon);
         }
     }
 
-    res.pushKV("cpids_with_more_than_one_beacon_contract_in_block", beacons_to_output);
-
-    return res;
+    result.EndArray();
+    result.EndObject();
 }
 
 UniValue explainmagnitude(const UniValue& params, bool fHelp)
@@ -3037,53 +3428,45 @@ UniValue SuperblockReport(int lookback, bool displaycontract, std::string cpid)
 {
     UniValue results(UniValue::VARR);
 
-    CBlockIndex* pblockindex = pindexBest;
-    if (!pblockindex) return results;
+    if (!pindexBest) return results;
 
     const GRC::CpidOption cpid_parsed = GRC::MiningId::Parse(cpid).TryCpid();
 
-    for (int i = 0; i < lookback; )
+    for (const CBlockIndex* pblockindex = GRC::Quorum::FindSuperblockIndex(pindexBest->nHeight);
+         pblockindex && (int) results.size() < lookback;
+         pblockindex = GRC::Quorum::FindSuperblockIndex(pblockindex->nHeight - 1))
     {
-        if (pblockindex->IsInMainChain() && pblockindex->IsSuperblock())
-        {
-            const GRC::ClaimOption claim = GetClaimByIndex(pblockindex);
-
-            if (claim && claim->ContainsSuperblock())
-            {
-                const GRC::Superblock& superblock = *claim->m_superblock;
-
-                UniValue c(UniValue::VOBJ);
-                c.pushKV("height", ToString(pblockindex->nHeight));
-                c.pushKV("block", pblockindex->GetBlockHash().GetHex());
-                c.pushKV("date", TimestampToHRDate(pblockindex->nTime));
-                c.pushKV("wallet_version", claim->m_client_version);
-
-                c.pushKV("total_cpids", (int)superblock.m_cpids.TotalCount());
-                c.pushKV("active_beacons", (int)superblock.m_cpids.size());
-                c.pushKV("inactive_beacons", (int)superblock.m_cpids.Zeros());
+        const GRC::ClaimOption claim = GetClaimByIndex(pblockindex);
 
-                c.pushKV("total_magnitude", superblock.m_cpids.TotalMagnitude());
-                c.pushKV("average_magnitude", superblock.m_cpids.AverageMagnitude());
+        if (claim && claim->ContainsSuperblock())
+        {
+            const GRC::Superblock& superblock = *claim->m_superblock;
 
-                c.pushKV("total_projects", (int)superblock.m_projects.size());
+            UniValue c(UniValue::VOBJ);
+            c.pushKV("height", ToString(pblockindex->nHeight));
+            c.pushKV("block", pblockindex->GetBlockHash().GetHex());
+            c.pushKV("date", TimestampToHRDate(pblockindex->nTime));
+            c.pushKV("wallet_version", claim->m_client_version);
 
-                if (cpid_parsed)
-                {
-                    c.pushKV("magnitude", superblock.m_cpids.MagnitudeOf(*cpid_parsed).Floating());
-                }
+            c.pushKV("total_cpids", (int)superblock.m_cpids.TotalCount());
+            c.pushKV("active_beacons", (int)superblock.m_cpids.size());
+            c.pushKV("inactive_beacons", (int)superblock.m_cpids.Zeros());
 
-                if (displaycontract)
-                    c.pushKV("contract_contents", SuperblockToJson(superblock));
+            c.pushKV("total_magnitude", superblock.m_cpids.TotalMagnitude());
+            c.pushKV("average_magnitude", superblock.m_cpids.AverageMagnitude());
 
-                results.push_back(c);
+            c.pushKV("total_projects", (int)superblock.m_projects.size());
 
-                ++i;
+            if (cpid_parsed)
+            {
+                c.pushKV("magnitude", superblock.m_cpids.MagnitudeOf(*cpid_parsed).Floating());
             }
-        }
 
-        if (!pblockindex->pprev) break;
-        pblockindex = pblockindex->pprev;
+            if (displaycontract)
+                c.pushKV("contract_contents", SuperblockToJson(superblock));
 
+            results.push_back(c);
+        }
     }
 
     return results;
@@ -3141,6 +3524,8 @@ UniValue GetJSONVersionReport(const int64_t lookback, const bool full_version)
         pindex && pindex->nHeight > min_height;
         pindex = pindex->pprev)
     {
+        EnsureBlockNotPruned(pindex);
+
         CBlock block;
         ReadBlockFromDisk(block, pindex, Params().GetConsensus());
 
@@ -3229,6 +3614,10 @@ UniValue getburnreport(const UniValue& params, bool fHelp)
 
     LOCK(cs_main);
 
+    if (HavePrunedBlocks()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "The burn report needs every block, but some are pruned.");
+    }
+
     // For now, we only consider transaction outputs with scripts that a node
     // will immediately refuse to evaluate:
     //
@@ -3353,50 +3742,42 @@ UniValue createmrcrequest(const UniValue& params, const bool fHelp) {
     int queue_length{0};
     int limit = static_cast<int>(GetMRCOutputLimit(pindex->nVersion, false));
 
-    // This sorts the MRCs in descending order of MRC fees to allow determination of the payout limit fee.
-
-    // ---------- mrc fee --- mrc ------ descending order
-    std::multimap<CAmount, GRC::MRC, std::greater<CAmount>> mrc_multimap;
-
-    for (const auto& [_, tx] : mempool.mapTx) {
-        if (!tx.GetContracts().empty()) {
-            // By protocol the MRC contract MUST be the only one in the transaction.
-            const GRC::Contract& contract = tx.GetContracts()[0];
-
-            if (contract.m_type == GRC::ContractType::MRC) {
-                GRC::MRC mempool_mrc = contract.CopyPayloadAs<GRC::MRC>();
+    // The memory pool keeps the MRCs in descending order of MRC fees, which allows determination of the payout limit
+    // fee without sorting the mempool here.
+    {
+        LOCK(mempool.cs);
 
-                mrc_multimap.insert(std::make_pair(mempool_mrc.m_fee, mempool_mrc));
-            } // match to mrc contract type
-        } // contract present in transaction?
-    }
+        const CTxMemPool::MRCFeeIndex& mrcs_by_fee = mempool.GetMRCsByFee();
 
-    for (const auto& [_, mempool_mrc] : mrc_multimap) {
-        found |= mrc.m_mining_id == mempool_mrc.m_mining_id;
+        for (const auto& [mempool_mrc_fee, tx_hash] : mrcs_by_fee) {
+            for (const auto& mempool_mrc_cpid : mempool.GetEntry(tx_hash)->GetMRCCpids()) {
+                found |= mrc.m_mining_id == mempool_mrc_cpid;
+            }
 
-        if (!found && mempool_mrc.m_fee >= mrc.m_fee) ++pos;
-        head_fee = std::max(head_fee, mempool_mrc.m_fee);
-        tail_fee = std::min(tail_fee, mempool_mrc.m_fee);
+            if (!found && mempool_mrc_fee >= mrc.m_fee) ++pos;
+            head_fee = std::max(head_fee, mempool_mrc_fee);
+            tail_fee = std::min(tail_fee, mempool_mrc_fee);
 
-        ++queue_length;
-    }
+            ++queue_length;
+        }
 
-    // The tail fee converges from the max numeric limit of CAmount; however, when the above loop is done
-    // it cannot end up with a number higher than the head fee. This can happen if there are no MRC transactions
-    // in the loop.
-    tail_fee = std::min(head_fee, tail_fee);
+        // The tail fee converges from the max numeric limit of CAmount; however, when the above loop is done
+        // it cannot end up with a number higher than the head fee. This can happen if there are no MRC transactions
+        // in the loop.
+        tail_fee = std::min(head_fee, tail_fee);
 
-    // Here we select the minimum of the mrc_multimap.size() - 1 in the case where the multimap does not reach the
-    // m_mrc_output_limit - 1, or the m_mrc_output_limit - 1 if the multimap indicates the queue is (over)full,
-    // i.e. the number of MRC's in the queue exceeds the m_mrc_output_limit for paying in a block.
-    int pay_limit_fee_pos = std::min<int>(mrc_multimap.size(), limit) - 1;
+        // Here we select the minimum of the number of MRCs in the mempool - 1 in the case where the queue does not reach
+        // the m_mrc_output_limit - 1, or the m_mrc_output_limit - 1 if the index indicates the queue is (over)full,
+        // i.e. the number of MRC's in the queue exceeds the m_mrc_output_limit for paying in a block.
+        int pay_limit_fee_pos = std::min<int>(mrcs_by_fee.size(), limit) - 1;
 
-    if (pay_limit_fee_pos >= 0) {
-        std::multimap<CAmount, GRC::MRC, std::greater<CAmount>>::iterator iter = mrc_multimap.begin();
+        if (pay_limit_fee_pos >= 0) {
+            CTxMemPool::MRCFeeIndex::const_iterator iter = mrcs_by_fee.begin();
 
-        std::advance(iter, pay_limit_fee_pos);
+            std::advance(iter, pay_limit_fee_pos);
 
-        pay_limit_fee = iter->first;
+            pay_limit_fee = iter->first;
+        }
     }
 
     pay_limit_fee = std::min(head_fee, pay_limit_fee);
@@ -212,6 +212,9 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "getblockstats"          , 0 },
     { "getblockstats"          , 1 },
     { "getblockstats"          , 2 },
+    { "getlockstats"           , 0 },
+    { "getlockstats"           , 2 },
+    { "gettracestats"          , 0 },
     { "inspectaccrualsnapshot" , 0 },
     { "listmanifests"          , 0 },
     { "sendalert"              , 2 },
@@ -228,6 +231,13 @@ static const CRPCConvertParam vRPCConvertParams[] =
 
     // Network
     { "getaddednodeinfo"       , 0 },
+    { "getaddressbalance"      , 1 },
+    { "getaddressbalance"      , 2 },
+    { "getaddresshistory"      , 1 },
+    { "getaddresshistory"      , 2 },
+    { "getaddresshistory"      , 3 },
+    { "getaddressutxos"        , 1 },
+    { "getaddressutxos"        , 2 },
     { "getnodeaddresses"       , 0 },
     { "getblock"               , 1 },
     { "getblockbynumber"       , 0 },
@@ -13,6 +13,7 @@
 #include "gridcoin/staking/difficulty.h"
 #include "gridcoin/superblock.h"
 #include "gridcoin/support/block_finder.h"
+#include "index/blockstats.h"
 #include "node/blockstorage.h"
 #include "util.h"
 #include <util/string.h>
@@ -142,21 +143,21 @@ UniValue rpc_getblockstats(const UniValue& params, bool fHelp)
 
         blockcount++;
 
-        CBlock block;
-        if (!ReadBlockFromDisk(block, cur->nFile,cur->nBlockPos, Params().GetConsensus()))
+        BlockStats stats;
+        if (!ReadBlockStats(cur, stats))
         {
             throw runtime_error("getblockstats: failed to read block");
         }
 
-        if (!block.vtx.size()) throw runtime_error("getblockstats: block has zero transactions");
+        if (!stats.m_tx_count) throw runtime_error("getblockstats: block has zero transactions");
 
         unsigned txcountinblock = 0;
 
-        if (block.vtx.size() >= 2)
+        if (stats.m_tx_count >= 2)
         {
-            txcountinblock += block.vtx.size() - 2;
+            txcountinblock += stats.m_tx_count - 2;
 
-            if (block.vtx[1].IsCoinStake())
+            if (stats.m_proof_of_stake)
             {
                 poscount++;
                 double diff = GRC::GetDifficulty(cur);
@@ -170,26 +171,23 @@ UniValue rpc_getblockstats(const UniValue& params, bool fHelp)
             }
         }
 
-        const GRC::MintSummary mint = block.GetMint();
-
         transactioncount += txcountinblock;
         emptyblockscount += (txcountinblock == 0);
-        c_blockversion[block.nVersion]++;
-        const Claim claim = block.GetClaim();
-        c_cpid[claim.m_mining_id.ToString()]++;
-        c_org[claim.m_organization]++;
-        c_version[claim.m_client_version]++;
-        researchtotal += claim.m_research_subsidy;
-        interesttotal += claim.m_block_subsidy;
-        researchcount += claim.HasResearchReward();
-        minttotal += mint.m_total;
-        feetotal += mint.m_fees;
-        unsigned sizeblock = GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION);
+        c_blockversion[stats.m_block_version]++;
+        c_cpid[stats.m_mining_id.ToString()]++;
+        c_org[stats.m_organization]++;
+        c_version[stats.m_client_version]++;
+        researchtotal += stats.m_research_subsidy;
+        interesttotal += stats.m_block_subsidy;
+        researchcount += stats.m_mining_id.Which() == MiningId::Kind::CPID;
+        minttotal += stats.m_mint;
+        feetotal += stats.m_fees;
+        unsigned sizeblock = stats.m_size;
         size_min_blk = std::min(size_min_blk,sizeblock);
         size_max_blk = std::max(size_max_blk,sizeblock);
         size_sum_blk += sizeblock;
 
-        if (claim.ContainsSuperblock())
+        if (stats.m_has_superblock)
         {
             ++super_count;
 
@@ -418,29 +416,28 @@ UniValue rpc_exportstats(const UniValue& params, bool fHelp)
         cnt_investor += !! (cur->nFlags & CBlockIndex::INVESTOR_CPID);
         cnt_contract += !! cur->IsContract();
 
-        CBlock block;
-        if (!ReadBlockFromDisk(block, cur->nFile, cur->nBlockPos, Params().GetConsensus()))
+        BlockStats stats;
+        if (!ReadBlockStats(cur, stats, false))
             throw runtime_error("failed to read block");
 
-        cnt_trans += block.vtx.size()-2; /* 2 transactions are special */
-        cnt_empty += ( block.vtx.size()<=2 );
-        double i_size = GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION);
+        cnt_trans += stats.m_tx_count-2; /* 2 transactions are special */
+        cnt_empty += ( stats.m_tx_count<=2 );
+        double i_size = stats.m_size;
         sum_size= sum_size + i_size;
         min_size=std::min(min_size,i_size);
         max_size=std::max(max_size,i_size);
 
-        const Claim& claim = block.GetClaim();
-        cnt_quorumvote += (claim.m_quorum_hash.Valid());
-        if (claim.m_quorum_hash.Valid()
-            && claim.m_quorum_hash != "d41d8cd98f00b204e9800998ecf8427e")
+        cnt_quorumvote += (stats.m_quorum_hash.Valid());
+        if (stats.m_quorum_hash.Valid()
+            && stats.m_quorum_hash != "d41d8cd98f00b204e9800998ecf8427e")
         {
             cnt_quorumcurr += 1;
         }
 
-        const double i_research = claim.m_research_subsidy;
+        const double i_research = stats.m_research_subsidy;
         sum_research= sum_research + i_research;
         max_research=std::max(max_research,i_research);
-        const double i_interest = claim.m_block_subsidy;
+        const double i_interest = stats.m_block_subsidy;
         sum_interest= sum_interest + i_interest;
         max_interest=std::max(max_interest,i_interest);
 
@@ -602,37 +599,35 @@ UniValue rpc_getrecentblocks(const UniValue& params, bool fHelp)
 
         if( (detail<100 && detail>=20) || (detail>=120) )
         {
-            CBlock block;
-            if (!ReadBlockFromDisk(block, cur->nFile, cur->nBlockPos, Params().GetConsensus())) {
+            BlockStats stats;
+            if (!ReadBlockStats(cur, stats, false)) {
                 throw runtime_error("failed to read block");
             }
 
-            if (!block.vtx.size()) throw runtime_error("getblockstats: block has zero transactions");
-
-            const Claim& claim = block.GetClaim();
+            if (!stats.m_tx_count) throw runtime_error("getblockstats: block has zero transactions");
 
             if(detail<100)
             {
                 if(detail>=20)
                 {
-                    line+="<|>"+claim.m_organization
-                        + "<|>"+claim.m_client_version
-                        + "<|>"+ToString(block.vtx.size()-2);
+                    line+="<|>"+stats.m_organization
+                        + "<|>"+stats.m_client_version
+                        + "<|>"+ToString(stats.m_tx_count-2);
                 }
                 if(detail==21)
                 {
-                    line+="<|>"+claim.m_mining_id.ToString()
-                        + "<|>"+(claim.m_quorum_hash.Valid() ? claim.m_quorum_hash.ToString() : "--");
+                    line+="<|>"+stats.m_mining_id.ToString()
+                        + "<|>"+(stats.m_quorum_hash.Valid() ? stats.m_quorum_hash.ToString() : "--");
                 }
             }
             else
             {
-                result2.pushKV("interest", ValueFromAmount(claim.m_block_subsidy));
-                result2.pushKV("organization", claim.m_organization);
-                result2.pushKV("cversion", claim.m_client_version);
-                result2.pushKV("quorum_hash", claim.m_quorum_hash.ToString());
-                result2.pushKV("superblocksize", claim.m_quorum_hash.ToString());
-                result2.pushKV("vtxsz", (int64_t)block.vtx.size() );
+                result2.pushKV("interest", ValueFromAmount(stats.m_block_subsidy));
+                result2.pushKV("organization", stats.m_organization);
+                result2.pushKV("cversion", stats.m_client_version);
+                result2.pushKV("quorum_hash", stats.m_quorum_hash.ToString());
+                result2.pushKV("superblocksize", stats.m_quorum_hash.ToString());
+                result2.pushKV("vtxsz", (int64_t)stats.m_tx_count );
             }
         }
         if(detail<100)
@@ -0,0 +1,165 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "rpc/jsonwriter.h"
+
+#include <cassert>
+
+// -----------------------------------------------------------------------------
+// Class: UniValueWriter
+// -----------------------------------------------------------------------------
+
+void UniValueWriter::Begin(const UniValue::VType type)
+{
+    m_stack.emplace_back(std::move(m_key), UniValue(type));
+    m_key.clear();
+}
+
+void UniValueWriter::End()
+{
+    assert(!m_stack.empty());
+
+    std::pair<std::string, UniValue> container = std::move(m_stack.back());
+    m_stack.pop_back();
+
+    m_key = std::move(container.first);
+    Value(container.second);
+}
+
+void UniValueWriter::BeginObject()
+{
+    Begin(UniValue::VOBJ);
+}
+
+void UniValueWriter::EndObject()
+{
+    End();
+}
+
+void UniValueWriter::BeginArray()
+{
+    Begin(UniValue::VARR);
+}
+
+void UniValueWriter::EndArray()
+{
+    End();
+}
+
+void UniValueWriter::Key(const std::string& key)
+{
+    m_key = key;
+}
+
+void UniValueWriter::Value(const UniValue& value)
+{
+    if (m_stack.empty()) {
+        m_result = value;
+    } else if (m_stack.back().second.isObject()) {
+        m_stack.back().second.pushKV(m_key, value);
+    } else {
+        m_stack.back().second.push_back(value);
+    }
+
+    m_key.clear();
+}
+
+UniValue UniValueWriter::Release()
+{
+    assert(m_stack.empty());
+
+    return std::move(m_result);
+}
+
+// -----------------------------------------------------------------------------
+// Class: JSONStreamWriter
+// -----------------------------------------------------------------------------
+
+JSONStreamWriter::JSONStreamWriter(Sink sink, const size_t buffer_size)
+    : m_sink(std::move(sink))
+    , m_buffer_size(buffer_size)
+{
+    m_buffer.reserve(buffer_size);
+}
+
+void JSONStreamWriter::Separate()
+{
+    if (m_after_key) {
+        m_after_key = false;
+        return;
+    }
+
+    if (!m_first.empty()) {
+        if (!m_first.back()) {
+            m_buffer += ',';
+        }
+
+        m_first.back() = false;
+    }
+}
+
+void JSONStreamWriter::FlushIfFull()
+{
+    if (m_buffer.size() >= m_buffer_size) {
+        Flush();
+    }
+}
+
+void JSONStreamWriter::BeginObject()
+{
+    Separate();
+    m_buffer += '{';
+    m_first.push_back(true);
+}
+
+void JSONStreamWriter::EndObject()
+{
+    assert(!m_first.empty());
+
+    m_first.pop_back();
+    m_buffer += '}';
+    FlushIfFull();
+}
+
+void JSONStreamWriter::BeginArray()
+{
+    Separate();
+    m_buffer += '[';
+    m_first.push_back(true);
+}
+
+void JSONStreamWriter::EndArray()
+{
+    assert(!m_first.empty());
+
+    m_first.pop_back();
+    m_buffer += ']';
+    FlushIfFull();
+}
+
+void JSONStreamWriter::Key(const std::string& key)
+{
+    Separate();
+    m_buffer += UniValue(key).write();
+    m_buffer += ':';
+    m_after_key = true;
+}
+
+void JSONStreamWriter::Value(const UniValue& value)
+{
+    Separate();
+    m_buffer += value.write();
+    FlushIfFull();
+}
+
+void JSONStreamWriter::Flush()
+{
+    if (m_buffer.empty()) {
+        return;
+    }
+
+    m_sink(m_buffer);
+    m_flushed += m_buffer.size();
+    m_buffer.clear();
+}
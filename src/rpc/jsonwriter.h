@@ -0,0 +1,142 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_RPC_JSONWRITER_H
+#define BITCOIN_RPC_JSONWRITER_H
+
+#include <univalue.h>
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+//!
+//! \brief Receives the result of an RPC command one JSON element at a time.
+//!
+//! Commands that can produce large results write them through this interface
+//! instead of returning a UniValue tree. The writer either assembles a tree for
+//! callers that need one or serializes each element as it arrives so that the
+//! server can send the reply while the command still runs.
+//!
+//! The calls must form one well-formed JSON value: inside an object, each value
+//! follows a Key() call. Use the existing UniValue helpers for the elements,
+//! like blockToJSON(), and pass their results to Value().
+//!
+class JSONWriter
+{
+public:
+    virtual ~JSONWriter() = default;
+
+    virtual void BeginObject() = 0;
+    virtual void EndObject() = 0;
+    virtual void BeginArray() = 0;
+    virtual void EndArray() = 0;
+
+    //!
+    //! \brief Set the key of the next value in the current object.
+    //!
+    virtual void Key(const std::string& key) = 0;
+
+    //!
+    //! \brief Write a complete value.
+    //!
+    virtual void Value(const UniValue& value) = 0;
+
+    //!
+    //! \brief Write a key and its value to the current object.
+    //!
+    void PushKV(const std::string& key, const UniValue& value)
+    {
+        Key(key);
+        Value(value);
+    }
+};
+
+//!
+//! \brief Assembles the written elements into a UniValue tree.
+//!
+class UniValueWriter : public JSONWriter
+{
+public:
+    void BeginObject() override;
+    void EndObject() override;
+    void BeginArray() override;
+    void EndArray() override;
+    void Key(const std::string& key) override;
+    void Value(const UniValue& value) override;
+
+    //!
+    //! \brief Take the assembled value.
+    //!
+    UniValue Release();
+
+private:
+    //!
+    //! \brief Containers not yet closed, each with its key in the parent.
+    //!
+    std::vector<std::pair<std::string, UniValue>> m_stack;
+    std::string m_key;
+    UniValue m_result;
+
+    void Begin(const UniValue::VType type);
+    void End();
+};
+
+//!
+//! \brief Serializes the written elements to compact JSON and passes the text
+//! to a sink in pieces of about the buffer size.
+//!
+//! The output is identical to UniValue::write() of the equivalent tree.
+//!
+class JSONStreamWriter : public JSONWriter
+{
+public:
+    typedef std::function<void(const std::string&)> Sink;
+
+    //! Default number of bytes buffered before the writer calls the sink.
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    //!
+    //! \brief Initialize a writer.
+    //!
+    //! \param sink        Receives the serialized JSON. May throw to abort.
+    //! \param buffer_size Number of bytes to buffer before calling the sink.
+    //!
+    explicit JSONStreamWriter(Sink sink, const size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+    void BeginObject() override;
+    void EndObject() override;
+    void BeginArray() override;
+    void EndArray() override;
+    void Key(const std::string& key) override;
+    void Value(const UniValue& value) override;
+
+    //!
+    //! \brief Pass any buffered text to the sink.
+    //!
+    void Flush();
+
+    //!
+    //! \brief Get the number of bytes passed to the sink so far.
+    //!
+    size_t GetBytesFlushed() const { return m_flushed; }
+
+private:
+    Sink m_sink;
+    const size_t m_buffer_size;
+    std::string m_buffer;
+    std::vector<bool> m_first;  //!< Whether each open container is empty.
+    bool m_after_key = false;
+    size_t m_flushed = 0;
+
+    //!
+    //! \brief Write a comma if the current container has a previous element.
+    //!
+    void Separate();
+
+    void FlushIfFull();
+};
+
+#endif // BITCOIN_RPC_JSONWRITER_H
@@ -347,7 +347,7 @@ UniValue auditsnapshotaccrual(const UniValue& params, bool fHelp)
         {
             if (pindex_superblock->IsSuperblock()
                     && (retry_from_baseline || pindex_superblock->nTime >= beacon_ptr->m_timestamp)) {
-                superblock = SuperblockPtr::ReadFromDisk(pindex_superblock);
+                superblock = GRC::Quorum::ReadSuperblock(pindex_superblock);
                 break;
             }
         }
@@ -493,7 +493,7 @@ UniValue auditsnapshotaccrual(const UniValue& params, bool fHelp)
             }
 
             if (pindex->IsSuperblock()) {
-                superblock = SuperblockPtr::ReadFromDisk(pindex);
+                superblock = GRC::Quorum::ReadSuperblock(pindex);
             }
         }
 
@@ -3,10 +3,14 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or https://opensource.org/licenses/mit-license.php.
 
+#include "fs.h"
 #include "protocol.h"
+#include "sync.h"
 #include "util.h"
+#include "util/trace.h"
 
 #include <univalue.h>
+#include <algorithm>
 #include <stdexcept>
 
 using namespace std;
@@ -83,6 +87,196 @@ UniValue logging(const UniValue& params, bool fHelp)
     return result;
 }
 
+UniValue getlockstats(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() > 3)
+    {
+        throw runtime_error(
+            "getlockstats [count] [sort] [reset]\n"
+            "\n"
+            "[count] -> Maximum number of lock sites to list (default: 20).\n"
+            "[sort]  -> Order of the sites: wait, hold, or count (default: wait).\n"
+            "[reset] -> Zero the statistics after reading them (default: false).\n"
+            "\n"
+            "Lists the lock sites (file:line) that waited for or held their locks the\n"
+            "longest. The node records these statistics when started with -lockstats.\n"
+            );
+    }
+
+    const size_t count = params.size() > 0 ? std::max(0, params[0].get_int()) : 20;
+    const std::string sort = params.size() > 1 ? params[1].get_str() : "wait";
+    const bool reset = params.size() > 2 && params[2].get_bool();
+
+    std::vector<LockSiteStats> stats = GetLockStats();
+
+    if (reset) {
+        ResetLockStats();
+    }
+
+    if (sort == "wait") {
+        std::sort(stats.begin(), stats.end(), [](const LockSiteStats& a, const LockSiteStats& b) {
+            return a.total_wait_ns > b.total_wait_ns;
+        });
+    } else if (sort == "hold") {
+        std::sort(stats.begin(), stats.end(), [](const LockSiteStats& a, const LockSiteStats& b) {
+            return a.total_hold_ns > b.total_hold_ns;
+        });
+    } else if (sort == "count") {
+        std::sort(stats.begin(), stats.end(), [](const LockSiteStats& a, const LockSiteStats& b) {
+            return a.acquisitions > b.acquisitions;
+        });
+    } else {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "sort must be wait, hold, or count");
+    }
+
+    UniValue sites(UniValue::VARR);
+
+    for (size_t i = 0; i < stats.size() && i < count; ++i) {
+        const LockSiteStats& site = stats[i];
+        const uint64_t acquisitions = std::max<uint64_t>(1, site.acquisitions);
+        UniValue entry(UniValue::VOBJ);
+
+        entry.pushKV("name", site.name);
+        entry.pushKV("site", strprintf("%s:%d", site.file, site.line));
+        entry.pushKV("acquisitions", site.acquisitions);
+        entry.pushKV("contended", site.contended);
+        entry.pushKV("try_failures", site.try_failures);
+        entry.pushKV("total_wait_ms", site.total_wait_ns / 1e6);
+        entry.pushKV("max_wait_ms", site.max_wait_ns / 1e6);
+        entry.pushKV("avg_wait_us", site.total_wait_ns / 1e3 / acquisitions);
+        entry.pushKV("total_hold_ms", site.total_hold_ns / 1e6);
+        entry.pushKV("max_hold_ms", site.max_hold_ns / 1e6);
+        entry.pushKV("avg_hold_us", site.total_hold_ns / 1e3 / acquisitions);
+
+        sites.push_back(entry);
+    }
+
+    UniValue result(UniValue::VOBJ);
+
+    result.pushKV("enabled", g_lock_profiling.load());
+    result.pushKV("site_count", (uint64_t)stats.size());
+    result.pushKV("sites", sites);
+
+    return result;
+}
+
+namespace {
+UniValue SpanRecordToJson(const TraceSpanRecord& record, const std::vector<std::string>& thread_names)
+{
+    UniValue json(UniValue::VOBJ);
+
+    json.pushKV("name", record.m_name);
+    json.pushKV("parent", record.m_parent ? record.m_parent : "");
+    json.pushKV("depth", record.m_depth);
+    json.pushKV("thread", (size_t)record.m_thread < thread_names.size() ? thread_names[record.m_thread] : "");
+    json.pushKV("start", FormatISO8601DateTime(record.m_start_us / 1000000));
+    json.pushKV("duration_ms", record.m_duration_us / 1e3);
+
+    return json;
+}
+} // Anonymous namespace
+
+UniValue gettracestats(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() > 1)
+    {
+        throw runtime_error(
+            "gettracestats [reset]\n"
+            "\n"
+            "[reset] -> Discard the statistics and buffered spans after reading them (default: false).\n"
+            "\n"
+            "Shows the latency percentiles of each traced span and the recent slow spans.\n"
+            "The node records spans when started with -trace.\n"
+            );
+    }
+
+    const bool reset = params.size() > 0 && params[0].get_bool();
+
+    std::vector<TraceSiteStats> stats = GetTraceStats();
+    const std::vector<TraceSpanRecord> slow_spans = GetSlowSpans();
+    const std::vector<std::string> thread_names = GetTraceThreadNames();
+
+    if (reset) {
+        ResetTracing();
+    }
+
+    std::sort(stats.begin(), stats.end(), [](const TraceSiteStats& a, const TraceSiteStats& b) {
+        return a.m_total_us > b.m_total_us;
+    });
+
+    UniValue spans(UniValue::VARR);
+
+    for (const auto& site : stats) {
+        UniValue entry(UniValue::VOBJ);
+
+        entry.pushKV("name", site.m_name);
+        entry.pushKV("count", site.m_count);
+        entry.pushKV("total_ms", site.m_total_us / 1e3);
+        entry.pushKV("avg_ms", site.m_total_us / 1e3 / site.m_count);
+        entry.pushKV("p50_ms", site.m_p50_us / 1e3);
+        entry.pushKV("p90_ms", site.m_p90_us / 1e3);
+        entry.pushKV("p99_ms", site.m_p99_us / 1e3);
+        entry.pushKV("p999_ms", site.m_p999_us / 1e3);
+        entry.pushKV("max_ms", site.m_max_us / 1e3);
+
+        spans.push_back(entry);
+    }
+
+    UniValue slow(UniValue::VARR);
+
+    for (auto it = slow_spans.rbegin(); it != slow_spans.rend(); ++it) {
+        slow.push_back(SpanRecordToJson(*it, thread_names));
+    }
+
+    UniValue result(UniValue::VOBJ);
+
+    result.pushKV("enabled", g_tracing.load());
+    result.pushKV("spans", spans);
+    result.pushKV("slow_spans", slow);
+
+    return result;
+}
+
+UniValue exporttrace(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() != 1)
+    {
+        throw runtime_error(
+            "exporttrace <filename>\n"
+            "\n"
+            "<filename> -> File to write the trace to\n"
+            "\n"
+            "Writes the recent spans recorded by -trace as Chrome trace event JSON that\n"
+            "chrome://tracing or https://ui.perfetto.dev can open.\n"
+            "If a path is not specified in the filename, the data directory is used.\n"
+            );
+    }
+
+    fs::path path = fs::path(params[0].get_str());
+
+    // If provided filename does not have a path, then append parent path, otherwise leave alone.
+    if (path.parent_path().empty()) {
+        path = GetDataDir() / path;
+    }
+
+    fsbridge::ofstream file;
+    file.open(path);
+
+    if (!file.is_open()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Cannot open trace file");
+    }
+
+    WriteChromeTrace(file);
+    file.close();
+
+    UniValue result(UniValue::VOBJ);
+
+    result.pushKV("filename", path.string());
+    result.pushKV("spans", (uint64_t)GetRecentSpans().size());
+
+    return result;
+}
+
 
 UniValue listsettings(const UniValue& params, bool fHelp)
 {
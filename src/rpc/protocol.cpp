@@ -52,6 +52,17 @@ std::string rfc1123Time()
     return DateTimeStrFormat("%a, %d %b %Y %H:%M:%S +0000", GetTime());
 }
 
+static const char* HTTPStatusText(int nStatus)
+{
+    if (nStatus == HTTP_OK) return "OK";
+    if (nStatus == HTTP_BAD_REQUEST) return "Bad Request";
+    if (nStatus == HTTP_FORBIDDEN) return "Forbidden";
+    if (nStatus == HTTP_NOT_FOUND) return "Not Found";
+    if (nStatus == HTTP_INTERNAL_SERVER_ERROR) return "Internal Server Error";
+    if (nStatus == HTTP_SERVICE_UNAVAILABLE) return "Service Unavailable";
+    return "";
+}
+
 std::string HTTPReply(int nStatus, const std::string& strMsg, bool keepalive)
 {
     if (nStatus == HTTP_UNAUTHORIZED)
@@ -71,13 +82,6 @@ std::string HTTPReply(int nStatus, const std::string& strMsg, bool keepalive)
             "</HEAD>\r\n"
             "<BODY><H1>401 Unauthorized.</H1></BODY>\r\n"
             "</HTML>\r\n", rfc1123Time().c_str(), FormatFullVersion().c_str());
-    const char *cStatus;
-         if (nStatus == HTTP_OK) cStatus = "OK";
-    else if (nStatus == HTTP_BAD_REQUEST) cStatus = "Bad Request";
-    else if (nStatus == HTTP_FORBIDDEN) cStatus = "Forbidden";
-    else if (nStatus == HTTP_NOT_FOUND) cStatus = "Not Found";
-    else if (nStatus == HTTP_INTERNAL_SERVER_ERROR) cStatus = "Internal Server Error";
-    else cStatus = "";
     return strprintf(
             "HTTP/1.1 %d %s\r\n"
             "Date: %s\r\n"
@@ -88,7 +92,7 @@ std::string HTTPReply(int nStatus, const std::string& strMsg, bool keepalive)
             "\r\n"
             "%s",
         nStatus,
-        cStatus,
+        HTTPStatusText(nStatus),
         rfc1123Time(),
         keepalive ? "keep-alive" : "close",
         strMsg.size(),
@@ -96,6 +100,28 @@ std::string HTTPReply(int nStatus, const std::string& strMsg, bool keepalive)
         strMsg);
 }
 
+std::string HTTPChunkedReplyHeader(int nStatus, bool keepalive)
+{
+    return strprintf(
+            "HTTP/1.1 %d %s\r\n"
+            "Date: %s\r\n"
+            "Connection: %s\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "Content-Type: application/json\r\n"
+            "Server: gridcoin-json-rpc/%s\r\n"
+            "\r\n",
+        nStatus,
+        HTTPStatusText(nStatus),
+        rfc1123Time(),
+        keepalive ? "keep-alive" : "close",
+        FormatFullVersion());
+}
+
+std::string HTTPChunk(const std::string& data)
+{
+    return strprintf("%x\r\n%s\r\n", data.size(), data);
+}
+
 int ReadHTTPHeaders(std::basic_istream<char>& stream, std::map<std::string, std::string>& mapHeadersRet)
 {
     int nLen = 0;
@@ -208,7 +234,43 @@ int ReadHTTPMessage(std::basic_istream<char>& stream, std::map<std::string,
         return HTTP_INTERNAL_SERVER_ERROR;
 
     // Read message
-    if (nLen > 0)
+    if (ToLower(mapHeadersRet["transfer-encoding"]) == "chunked")
+    {
+        // The server streams large results in chunks of unknown total size:
+        while (true)
+        {
+            std::string strSize;
+            std::getline(stream, strSize);
+
+            // Chunk sizes are hexadecimal, optionally followed by extensions:
+            const std::string strHex = TrimString(strSize.substr(0, strSize.find(';')));
+
+            if (!stream.good() || strHex.empty() || strHex.size() > 8
+                || strHex.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos)
+                return HTTP_INTERNAL_SERVER_ERROR;
+
+            const size_t nChunk = std::stoul(strHex, nullptr, 16);
+
+            if (nChunk == 0)
+                break;
+
+            if (strMessageRet.size() + nChunk > MAX_SIZE)
+                return HTTP_INTERNAL_SERVER_ERROR;
+
+            std::vector<char> vch(nChunk);
+            stream.read(&vch[0], nChunk);
+            strMessageRet.append(vch.begin(), vch.end());
+
+            // Skip the line break after the chunk data:
+            std::string strLineBreak;
+            std::getline(stream, strLineBreak);
+        }
+
+        // Skip the trailer section that ends the message:
+        std::string strTrailer;
+        while (std::getline(stream, strTrailer) && !strTrailer.empty() && strTrailer != "\r") { }
+    }
+    else if (nLen > 0)
     {
         std::vector<char> vch(nLen);
         stream.read(&vch[0], nLen);
@@ -228,6 +290,76 @@ int ReadHTTPMessage(std::basic_istream<char>& stream, std::map<std::string,
     return HTTP_OK;
 }
 
+bool HTTPRequest::KeepAlive() const
+{
+    const auto iter = m_headers.find("connection");
+
+    return iter != m_headers.end() && iter->second != "close";
+}
+
+HTTPParseResult ParseHTTPRequest(std::string& buffer, HTTPRequest& request)
+{
+    // Headers end with an empty line. Accept a bare \n like the stream parser:
+    size_t header_end = buffer.find("\r\n\r\n");
+    size_t separator_size = 4;
+
+    const size_t bare_end = buffer.find("\n\n");
+
+    if (bare_end < header_end) {
+        header_end = bare_end;
+        separator_size = 2;
+    }
+
+    if (header_end == std::string::npos) {
+        return buffer.size() > MAX_HTTP_HEADERS_SIZE
+            ? HTTPParseResult::INVALID
+            : HTTPParseResult::INCOMPLETE;
+    }
+
+    header_end += separator_size;
+
+    if (header_end > MAX_HTTP_HEADERS_SIZE) {
+        return HTTPParseResult::INVALID;
+    }
+
+    std::istringstream stream(buffer.substr(0, header_end));
+    HTTPRequest parsed;
+    int content_length = 0;
+
+    try {
+        if (!ReadHTTPRequestLine(stream, parsed.m_proto, parsed.m_method, parsed.m_uri)) {
+            return HTTPParseResult::INVALID;
+        }
+
+        content_length = ReadHTTPHeaders(stream, parsed.m_headers);
+    } catch (const std::exception& e) {
+        LogPrint(BCLog::LogFlags::RPC, "%s: %s", __func__, e.what());
+        return HTTPParseResult::INVALID;
+    }
+
+    if (content_length < 0 || content_length > (int)MAX_SIZE) {
+        return HTTPParseResult::INVALID;
+    }
+
+    if (buffer.size() - header_end < (size_t)content_length) {
+        return HTTPParseResult::INCOMPLETE;
+    }
+
+    parsed.m_body = buffer.substr(header_end, content_length);
+    buffer.erase(0, header_end + content_length);
+
+    // Apply the same connection defaults as ReadHTTPMessage():
+    std::string& connection = parsed.m_headers["connection"];
+
+    if (connection != "close" && connection != "keep-alive") {
+        connection = parsed.m_proto >= 1 ? "keep-alive" : "close";
+    }
+
+    request = std::move(parsed);
+
+    return HTTPParseResult::COMPLETE;
+}
+
 //
 // JSON-RPC protocol.  Bitcoin speaks version 1.0 for maximum compatibility,
 // but uses JSON-RPC 1.1/2.0 standards for parts of the 1.0 standard that were
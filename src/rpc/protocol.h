@@ -38,8 +38,12 @@ enum HTTPStatusCode
     HTTP_FORBIDDEN             = 403,
     HTTP_NOT_FOUND             = 404,
     HTTP_INTERNAL_SERVER_ERROR = 500,
+    HTTP_SERVICE_UNAVAILABLE   = 503,
 };
 
+//! Maximum size of the request line and headers of an HTTP request.
+static constexpr size_t MAX_HTTP_HEADERS_SIZE = 8192;
+
 //! Gridcoin RPC error codes
 enum RPCErrorCode
 {
@@ -163,55 +167,52 @@ private:
     boost::asio::ssl::stream<typename Protocol::socket>& stream;
 };
 
-class AcceptedConnection
+//!
+//! \brief An HTTP request received by the RPC server.
+//!
+struct HTTPRequest
 {
-public:
-    virtual ~AcceptedConnection() {}
-
-    virtual std::iostream& stream() = 0;
-    virtual std::string peer_address_to_string() const = 0;
-    virtual void close() = 0;
+    std::string m_method;                          //!< GET or POST.
+    std::string m_uri;                             //!< Absolute path.
+    int m_proto = 0;                               //!< Minor version of HTTP/1.x.
+    std::map<std::string, std::string> m_headers;  //!< Lowercase names.
+    std::string m_body;
+
+    //!
+    //! \brief Determine whether the client asked to keep the connection open.
+    //!
+    bool KeepAlive() const;
 };
 
-template <typename Protocol>
-class AcceptedConnectionImpl : public AcceptedConnection
+//!
+//! \brief Result of an attempt to parse an HTTP request from a buffer.
+//!
+enum class HTTPParseResult
 {
-public:
-    AcceptedConnectionImpl(
-            ioContext& io_context,
-            boost::asio::ssl::context &context,
-            bool fUseSSL) :
-        sslStream(io_context, context),
-        _d(sslStream, fUseSSL),
-        _stream(_d)
-    {
-    }
-
-    virtual std::iostream& stream()
-    {
-        return _stream;
-    }
-
-    virtual std::string peer_address_to_string() const
-    {
-        return peer.address().to_string();
-    }
-
-    virtual void close()
-    {
-        _stream.close();
-    }
-
-    typename Protocol::endpoint peer;
-    boost::asio::ssl::stream<typename Protocol::socket> sslStream;
-
-private:
-    SSLIOStreamDevice<Protocol> _d;
-    boost::iostreams::stream< SSLIOStreamDevice<Protocol> > _stream;
+    INCOMPLETE, //!< Need more data.
+    COMPLETE,   //!< Parsed one request.
+    INVALID,    //!< Malformed or oversized request.
 };
 
+//!
+//! \brief Parse one HTTP request from the data received on a connection.
+//!
+//! The non-blocking RPC server calls this each time that it receives data. The
+//! function does not consume anything from an incomplete request. When the
+//! request is complete, it removes the request from the buffer and leaves any
+//! pipelined requests that follow it.
+//!
+//! \param buffer  Data received but not yet parsed.
+//! \param request Receives the parsed request.
+//!
+HTTPParseResult ParseHTTPRequest(std::string& buffer, HTTPRequest& request);
+
 std::string HTTPPost(const std::string& strMsg, const std::map<std::string,std::string>& mapRequestHeaders);
 std::string HTTPReply(int nStatus, const std::string& strMsg, bool keepalive);
+//! Headers of a reply with a body sent in chunks of HTTPChunk().
+std::string HTTPChunkedReplyHeader(int nStatus, bool keepalive);
+//! Frame data as a chunk of a chunked reply. Empty data ends the reply.
+std::string HTTPChunk(const std::string& data);
 bool ReadHTTPRequestLine(std::basic_istream<char>& stream, int &proto,
                          std::string& http_method, std::string& http_uri);
 int ReadHTTPStatus(std::basic_istream<char>& stream, int &proto);
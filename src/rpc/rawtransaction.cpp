@@ -18,6 +18,7 @@
 #include "gridcoin/tx_message.h"
 #include "gridcoin/voting/payloads.h"
 #include "node/blockstorage.h"
+#include "node/prune.h"
 #include "policy/policy.h"
 #include "policy/fees.h"
 #include "primitives/transaction.h"
@@ -60,6 +61,12 @@ std::vector<std::pair<std::string, std::string>> GetTxStakeBoincHashInfo(const C
 
         pindex = mi->second;
 
+        if (IsBlockPruned(pindex))
+        {
+            res.push_back(std::make_pair(_("ERROR"), _("Block pruned")));
+            return res;
+        }
+
         if (!ReadBlockFromDisk(block, pindex, Params().GetConsensus()))
         {
             res.push_back(std::make_pair(_("ERROR"), _("Block read failed")));
@@ -1112,6 +1119,8 @@ UniValue consolidatemsunspent(const UniValue& params, bool fHelp)
             pblkindex = pblkindex->pnext;
             nBlockCurrent = pblkindex->nHeight;
 
+            EnsureBlockNotPruned(pblkindex);
+
             CBlock block;
 
             if (!ReadBlockFromDisk(block, pblkindex, Params().GetConsensus()))
@@ -1309,6 +1318,8 @@ UniValue scanforunspent(const UniValue& params, bool fHelp)
         {
             pblkindex = pblkindex->pnext;
 
+            EnsureBlockNotPruned(pblkindex);
+
             CBlock block;
 
             if (!ReadBlockFromDisk(block, pblkindex, Params().GetConsensus()))
@@ -12,6 +12,7 @@
 #include "client.h"
 #include "protocol.h"
 #include "random.h"
+#include "rpc/workqueue.h"
 #include "wallet/db.h"
 #include "util.h"
 
@@ -27,6 +28,7 @@
 #include <algorithm>
 #include <stdexcept>
 
+#include <future>
 #include <memory>
 
 using namespace std;
@@ -41,6 +43,8 @@ static std::string strRPCUserColonPass;
 static ioContext* rpc_io_service = nullptr;
 static ssl::context* rpc_ssl_context = nullptr;
 static boost::thread_group* rpc_worker_group = nullptr;
+static RPCWorkQueue* rpc_work_queue = nullptr;
+static int rpc_worker_threads = 0;
 
 const UniValue emptyobj(UniValue::VOBJ);
 
@@ -281,178 +285,189 @@ UniValue stop(const UniValue& params, bool fHelp)
 // This also has improved the performance of rpc outputs.
 
 static const CRPCCommand vRPCCommands[] =
-{ //  name                      function                 category
-  //  ------------------------  -----------------------  -----------------
-    { "help",                    &help,                    cat_null          },
+{ //  name                      function                 category          concurrent  streaming function
+  //  ------------------------  -----------------------  ----------------  ----------  ------------------
+    { "help",                    &help,                    cat_null,         true  },
 
   // Wallet commands
-    { "addmultisigaddress",      &addmultisigaddress,      cat_wallet        },
-    { "addredeemscript",         &addredeemscript,         cat_wallet        },
-    { "backupprivatekeys",       &backupprivatekeys,       cat_wallet        },
-    { "backupwallet",            &backupwallet,            cat_wallet        },
-    { "burn",                    &burn,                    cat_wallet        },
-    { "checkwallet",             &checkwallet,             cat_wallet        },
-    { "createrawtransaction",    &createrawtransaction,    cat_wallet        },
-    { "consolidatemsunspent",    &consolidatemsunspent,    cat_wallet        },
-    { "decoderawtransaction",    &decoderawtransaction,    cat_wallet        },
-    { "decodescript",            &decodescript,            cat_wallet        },
-    { "dumpprivkey",             &dumpprivkey,             cat_wallet        },
-    { "dumpwallet",              &dumpwallet,              cat_wallet        },
-    { "encryptwallet",           &encryptwallet,           cat_wallet        },
-    { "getaccount",              &getaccount,              cat_wallet        },
-    { "getaccountaddress",       &getaccountaddress,       cat_wallet        },
-    { "getaddressesbyaccount",   &getaddressesbyaccount,   cat_wallet        },
-    { "getbalance",              &getbalance,              cat_wallet        },
-    { "getbalancedetail",        &getbalancedetail,        cat_wallet        },
-    { "getnewaddress",           &getnewaddress,           cat_wallet        },
-    { "getnewpubkey",            &getnewpubkey,            cat_wallet        },
-    { "getrawtransaction",       &getrawtransaction,       cat_wallet        },
-    { "getrawwallettransaction", &getrawwallettransaction, cat_wallet        },
-    { "getreceivedbyaccount",    &getreceivedbyaccount,    cat_wallet        },
-    { "getreceivedbyaddress",    &getreceivedbyaddress,    cat_wallet        },
-    { "gettransaction",          &gettransaction,          cat_wallet        },
-    { "getunconfirmedbalance",   &getunconfirmedbalance,   cat_wallet        },
-    { "getwalletinfo",           &getwalletinfo,           cat_wallet        },
-    { "importprivkey",           &importprivkey,           cat_wallet        },
-    { "importwallet",            &importwallet,            cat_wallet        },
-    { "keypoolrefill",           &keypoolrefill,           cat_wallet        },
-    { "listaccounts",            &listaccounts,            cat_wallet        },
-    { "listaddressgroupings",    &listaddressgroupings,    cat_wallet        },
-    { "listreceivedbyaccount",   &listreceivedbyaccount,   cat_wallet        },
-    { "listreceivedbyaddress",   &listreceivedbyaddress,   cat_wallet        },
-    { "listsinceblock",          &listsinceblock,          cat_wallet        },
-    { "liststakes",              &liststakes,              cat_wallet        },
-    { "listtransactions",        &listtransactions,        cat_wallet        },
-    { "listunspent",             &listunspent,             cat_wallet        },
-    { "consolidateunspent",      &consolidateunspent,      cat_wallet        },
-    { "makekeypair",             &makekeypair,             cat_wallet        },
-    { "maintainbackups",         &maintainbackups,         cat_wallet        },
-    { "move",                    &movecmd,                 cat_wallet        },
-    { "rainbymagnitude",         &rainbymagnitude,         cat_wallet        },
-    { "repairwallet",            &repairwallet,            cat_wallet        },
-    { "resendtx",                &resendtx,                cat_wallet        },
-    { "reservebalance",          &reservebalance,          cat_wallet        },
-    { "scanforunspent",          &scanforunspent,          cat_wallet        },
-    { "sendfrom",                &sendfrom,                cat_wallet        },
-    { "sendmany",                &sendmany,                cat_wallet        },
-    { "sendrawtransaction",      &sendrawtransaction,      cat_wallet        },
-    { "sendtoaddress",           &sendtoaddress,           cat_wallet        },
-    { "setaccount",              &setaccount,              cat_wallet        },
-    { "sethdseed",               &sethdseed,               cat_wallet        },
-    { "settxfee",                &settxfee,                cat_wallet        },
-    { "signmessage",             &signmessage,             cat_wallet        },
-    { "signrawtransaction",      &signrawtransaction,      cat_wallet        },
-    { "upgradewallet",           &upgradewallet,           cat_wallet        },
-    { "validateaddress",         &validateaddress,         cat_wallet        },
-    { "validatepubkey",          &validatepubkey,          cat_wallet        },
-    { "verifymessage",           &verifymessage,           cat_wallet        },
-    { "walletlock",              &walletlock,              cat_wallet        },
-    { "walletpassphrase",        &walletpassphrase,        cat_wallet        },
-    { "walletpassphrasechange",  &walletpassphrasechange,  cat_wallet        },
-    { "walletdiagnose",          &walletdiagnose,          cat_wallet        },
+    { "addmultisigaddress",      &addmultisigaddress,      cat_wallet,       false },
+    { "addredeemscript",         &addredeemscript,         cat_wallet,       false },
+    { "backupprivatekeys",       &backupprivatekeys,       cat_wallet,       false },
+    { "backupwallet",            &backupwallet,            cat_wallet,       false },
+    { "burn",                    &burn,                    cat_wallet,       false },
+    { "checkwallet",             &checkwallet,             cat_wallet,       false },
+    { "createrawtransaction",    &createrawtransaction,    cat_wallet,       false },
+    { "consolidatemsunspent",    &consolidatemsunspent,    cat_wallet,       false },
+    { "decoderawtransaction",    &decoderawtransaction,    cat_wallet,       true  },
+    { "decodescript",            &decodescript,            cat_wallet,       true  },
+    { "dumpprivkey",             &dumpprivkey,             cat_wallet,       false },
+    { "dumpwallet",              &dumpwallet,              cat_wallet,       false },
+    { "encryptwallet",           &encryptwallet,           cat_wallet,       false },
+    { "getaccount",              &getaccount,              cat_wallet,       true  },
+    { "getaccountaddress",       &getaccountaddress,       cat_wallet,       false },
+    { "getaddressesbyaccount",   &getaddressesbyaccount,   cat_wallet,       true  },
+    { "getbalance",              &getbalance,              cat_wallet,       true  },
+    { "getbalancedetail",        &getbalancedetail,        cat_wallet,       true  },
+    { "getnewaddress",           &getnewaddress,           cat_wallet,       false },
+    { "getnewpubkey",            &getnewpubkey,            cat_wallet,       false },
+    { "getrawtransaction",       &getrawtransaction,       cat_wallet,       true  },
+    { "getrawwallettransaction", &getrawwallettransaction, cat_wallet,       true  },
+    { "getreceivedbyaccount",    &getreceivedbyaccount,    cat_wallet,       true  },
+    { "getreceivedbyaddress",    &getreceivedbyaddress,    cat_wallet,       true  },
+    { "gettransaction",          &gettransaction,          cat_wallet,       true  },
+    { "getunconfirmedbalance",   &getunconfirmedbalance,   cat_wallet,       true  },
+    { "getwalletinfo",           &getwalletinfo,           cat_wallet,       true  },
+    { "importprivkey",           &importprivkey,           cat_wallet,       false },
+    { "importwallet",            &importwallet,            cat_wallet,       false },
+    { "keypoolrefill",           &keypoolrefill,           cat_wallet,       false },
+    { "listaccounts",            &listaccounts,            cat_wallet,       true  },
+    { "listaddressgroupings",    &listaddressgroupings,    cat_wallet,       true  },
+    { "listreceivedbyaccount",   &listreceivedbyaccount,   cat_wallet,       true  },
+    { "listreceivedbyaddress",   &listreceivedbyaddress,   cat_wallet,       true  },
+    { "listsinceblock",          &listsinceblock,          cat_wallet,       true  },
+    { "liststakes",              &liststakes,              cat_wallet,       true  },
+    { "listtransactions",        &listtransactions,        cat_wallet,       true  },
+    { "listunspent",             &listunspent,             cat_wallet,       true  },
+    { "consolidateunspent",      &consolidateunspent,      cat_wallet,       false },
+    { "makekeypair",             &makekeypair,             cat_wallet,       false },
+    { "maintainbackups",         &maintainbackups,         cat_wallet,       false },
+    { "move",                    &movecmd,                 cat_wallet,       false },
+    { "rainbymagnitude",         &rainbymagnitude,         cat_wallet,       false },
+    { "repairwallet",            &repairwallet,            cat_wallet,       false },
+    { "resendtx",                &resendtx,                cat_wallet,       false },
+    { "reservebalance",          &reservebalance,          cat_wallet,       false },
+    { "scanforunspent",          &scanforunspent,          cat_wallet,       false },
+    { "sendfrom",                &sendfrom,                cat_wallet,       false },
+    { "sendmany",                &sendmany,                cat_wallet,       false },
+    { "sendrawtransaction",      &sendrawtransaction,      cat_wallet,       false },
+    { "sendtoaddress",           &sendtoaddress,           cat_wallet,       false },
+    { "setaccount",              &setaccount,              cat_wallet,       false },
+    { "sethdseed",               &sethdseed,               cat_wallet,       false },
+    { "settxfee",                &settxfee,                cat_wallet,       false },
+    { "signmessage",             &signmessage,             cat_wallet,       false },
+    { "signrawtransaction",      &signrawtransaction,      cat_wallet,       false },
+    { "upgradewallet",           &upgradewallet,           cat_wallet,       false },
+    { "validateaddress",         &validateaddress,         cat_wallet,       true  },
+    { "validatepubkey",          &validatepubkey,          cat_wallet,       true  },
+    { "verifymessage",           &verifymessage,           cat_wallet,       true  },
+    { "walletlock",              &walletlock,              cat_wallet,       false },
+    { "walletpassphrase",        &walletpassphrase,        cat_wallet,       false },
+    { "walletpassphrasechange",  &walletpassphrasechange,  cat_wallet,       false },
+    { "walletdiagnose",          &walletdiagnose,          cat_wallet,       false },
 
   // Staking commands
-    { "advertisebeacon",         &advertisebeacon,         cat_staking        },
-    { "beaconconvergence",       &beaconconvergence,       cat_staking        },
-    { "beaconreport",            &beaconreport,            cat_staking        },
-    { "beaconstatus",            &beaconstatus,            cat_staking        },
-    { "createmrcrequest",        &createmrcrequest,        cat_staking        },
-    { "explainmagnitude",        &explainmagnitude,        cat_staking        },
-    { "getlaststake",            &getlaststake,            cat_staking        },
-    { "getmrcinfo",              &getmrcinfo,              cat_staking        },
-    { "getstakinginfo",          &getstakinginfo,          cat_staking        },
-    { "getmininginfo",           &getstakinginfo,          cat_staking        }, //alias for getstakinginfo (compatibility)
-    { "lifetime",                &lifetime,                cat_staking        },
-    { "magnitude",               &magnitude,               cat_staking        },
-    { "pendingbeaconreport",     &pendingbeaconreport,     cat_staking        },
-    { "resetcpids",              &resetcpids,              cat_staking        },
-    { "revokebeacon",            &revokebeacon,            cat_staking        },
-    { "superblockage",           &superblockage,           cat_staking        },
-    { "superblocks",             &superblocks,             cat_staking        },
+    { "advertisebeacon",         &advertisebeacon,         cat_staking,      false },
+    { "beaconconvergence",       &beaconconvergence,       cat_staking,      true  },
+    { "beaconreport",            &beaconreport,            cat_staking,      true  },
+    { "beaconstatus",            &beaconstatus,            cat_staking,      true  },
+    { "createmrcrequest",        &createmrcrequest,        cat_staking,      false },
+    { "explainmagnitude",        &explainmagnitude,        cat_staking,      true  },
+    { "getlaststake",            &getlaststake,            cat_staking,      true  },
+    { "getmrcinfo",              &getmrcinfo,              cat_staking,      true  },
+    { "getstakinginfo",          &getstakinginfo,          cat_staking,      true  },
+    { "getmininginfo",           &getstakinginfo,          cat_staking,      true  }, //alias for getstakinginfo (compatibility)
+    { "lifetime",                &lifetime,                cat_staking,      true  },
+    { "magnitude",               &magnitude,               cat_staking,      true  },
+    { "pendingbeaconreport",     &pendingbeaconreport,     cat_staking,      true  },
+    { "resetcpids",              &resetcpids,              cat_staking,      false },
+    { "revokebeacon",            &revokebeacon,            cat_staking,      false },
+    { "superblockage",           &superblockage,           cat_staking,      true  },
+    { "superblocks",             &superblocks,             cat_staking,      true  },
 
   // Developer commands
-    { "auditsnapshotaccrual",    &auditsnapshotaccrual,    cat_developer     },
-    { "auditsnapshotaccruals",   &auditsnapshotaccruals,   cat_developer     },
-    { "addkey",                  &addkey,                  cat_developer     },
-    { "beaconaudit",             &beaconaudit,             cat_developer     },
-    { "changesettings",          &changesettings,          cat_developer     },
-    { "currentcontractaverage",  &currentcontractaverage,  cat_developer     },
-    { "debug",                   &debug,                   cat_developer     },
-    { "dumpcontracts",           &dumpcontracts,           cat_developer     },
-    { "exportstats1",            &rpc_exportstats,         cat_developer     },
-    { "getblockstats",           &rpc_getblockstats,       cat_developer     },
-    { "getrecentblocks",         &rpc_getrecentblocks,     cat_developer     },
-    { "inspectaccrualsnapshot",  &inspectaccrualsnapshot,  cat_developer     },
-    { "listalerts",              &listalerts,              cat_developer     },
-    { "listprojects",            &listprojects,            cat_developer     },
-    { "listprotocolentries",     &listprotocolentries,     cat_developer     },
-    { "listresearcheraccounts",  &listresearcheraccounts,  cat_developer     },
-    { "listscrapers",            &listscrapers,            cat_developer     },
-    { "listmandatorysidestakes", &listmandatorysidestakes, cat_developer     },
-    { "listsettings",            &listsettings,            cat_developer     },
-    { "logging",                 &logging,                 cat_developer     },
-    { "network",                 &network,                 cat_developer     },
-    { "parseaccrualsnapshotfile",&parseaccrualsnapshotfile,cat_developer     },
-    { "parselegacysb",           &parselegacysb,           cat_developer     },
-    { "projects",                &projects,                cat_developer     },
-    { "readdata",                &readdata,                cat_developer     },
-    { "reorganize",              &rpc_reorganize,          cat_developer     },
-    { "sendalert",               &sendalert,               cat_developer     },
-    { "sendalert2",              &sendalert2,              cat_developer     },
-    { "sendblock",               &sendblock,               cat_developer     },
-    { "superblockaverage",       &superblockaverage,       cat_developer     },
-    { "versionreport",           &versionreport,           cat_developer     },
-    { "writedata",               &writedata,               cat_developer     },
-
-    { "listmanifests",           &listmanifests,           cat_developer     },
-    { "getmpart",                &getmpart,                cat_developer     },
-    { "sendscraperfilemanifest", &sendscraperfilemanifest, cat_developer     },
-    { "savescraperfilemanifest", &savescraperfilemanifest, cat_developer     },
-    { "deletecscrapermanifest",  &deletecscrapermanifest,  cat_developer     },
-    { "archivelog",              &archivelog,              cat_developer     },
-    { "testnewsb",               &testnewsb,               cat_developer     },
-    { "convergencereport",       &convergencereport,       cat_developer     },
-    { "scraperreport",           &scraperreport,           cat_developer     },
+    { "auditsnapshotaccrual",    &auditsnapshotaccrual,    cat_developer,    true  },
+    { "auditsnapshotaccruals",   &auditsnapshotaccruals,   cat_developer,    true  },
+    { "addkey",                  &addkey,                  cat_developer,    false },
+    { "beaconaudit",             &BufferStreamedResult<beaconaudit>,
+                                                           cat_developer,    true,  &beaconaudit },
+    { "changesettings",          &changesettings,          cat_developer,    false },
+    { "currentcontractaverage",  &currentcontractaverage,  cat_developer,    true  },
+    { "debug",                   &debug,                   cat_developer,    false },
+    { "dumpcontracts",           &dumpcontracts,           cat_developer,    false },
+    { "exportstats1",            &rpc_exportstats,         cat_developer,    false },
+    { "exporttrace",             &exporttrace,             cat_developer,    false },
+    { "getblockstats",           &rpc_getblockstats,       cat_developer,    true  },
+    { "getlockstats",            &getlockstats,            cat_developer,    true  },
+    { "gettracestats",           &gettracestats,           cat_developer,    true  },
+    { "getrecentblocks",         &rpc_getrecentblocks,     cat_developer,    true  },
+    { "inspectaccrualsnapshot",  &inspectaccrualsnapshot,  cat_developer,    true  },
+    { "listalerts",              &listalerts,              cat_developer,    true  },
+    { "listprojects",            &listprojects,            cat_developer,    true  },
+    { "listprotocolentries",     &listprotocolentries,     cat_developer,    true  },
+    { "listresearcheraccounts",  &listresearcheraccounts,  cat_developer,    true  },
+    { "listscrapers",            &listscrapers,            cat_developer,    true  },
+    { "listmandatorysidestakes", &listmandatorysidestakes, cat_developer,    true  },
+    { "listsettings",            &listsettings,            cat_developer,    true  },
+    { "logging",                 &logging,                 cat_developer,    false },
+    { "network",                 &network,                 cat_developer,    false },
+    { "parseaccrualsnapshotfile",&parseaccrualsnapshotfile,cat_developer,    false },
+    { "parselegacysb",           &parselegacysb,           cat_developer,    false },
+    { "projects",                &projects,                cat_developer,    false },
+    { "readdata",                &readdata,                cat_developer,    false },
+    { "reorganize",              &rpc_reorganize,          cat_developer,    false },
+    { "sendalert",               &sendalert,               cat_developer,    false },
+    { "sendalert2",              &sendalert2,              cat_developer,    false },
+    { "sendblock",               &sendblock,               cat_developer,    false },
+    { "superblockaverage",       &superblockaverage,       cat_developer,    true  },
+    { "versionreport",           &versionreport,           cat_developer,    true  },
+    { "writedata",               &writedata,               cat_developer,    false },
+
+    { "listmanifests",           &BufferStreamedResult<listmanifests>,
+                                                           cat_developer,    true,  &listmanifests },
+    { "getmpart",                &getmpart,                cat_developer,    true  },
+    { "sendscraperfilemanifest", &sendscraperfilemanifest, cat_developer,    false },
+    { "savescraperfilemanifest", &savescraperfilemanifest, cat_developer,    false },
+    { "deletecscrapermanifest",  &deletecscrapermanifest,  cat_developer,    false },
+    { "archivelog",              &archivelog,              cat_developer,    false },
+    { "testnewsb",               &testnewsb,               cat_developer,    false },
+    { "convergencereport",       &convergencereport,       cat_developer,    true  },
+    { "scraperreport",           &scraperreport,           cat_developer,    true  },
 
   // Network commands
-    { "addnode",                 &addnode,                 cat_network       },
-    { "askforoutstandingblocks", &askforoutstandingblocks, cat_network       },
-    { "getblockchaininfo",       &getblockchaininfo,       cat_network       },
-    { "getnetworkinfo",          &getnetworkinfo,          cat_network       },
-    { "clearbanned",             &clearbanned,             cat_network       },
-    { "currenttime",             &currenttime,             cat_network       },
-    { "getaddednodeinfo",        &getaddednodeinfo,        cat_network       },
-    { "getnodeaddresses",        &getnodeaddresses,        cat_network       },
-    { "getbestblockhash",        &getbestblockhash,        cat_network       },
-    { "getblock",                &getblock,                cat_network       },
-    { "getblockbynumber",        &getblockbynumber,        cat_network       },
-    { "getblockbymintime",       &getblockbymintime,       cat_network       },
-    { "getblocksbatch",          &getblocksbatch,          cat_network       },
-    { "getblockcount",           &getblockcount,           cat_network       },
-    { "getblockhash",            &getblockhash,            cat_network       },
-    { "getburnreport",           &getburnreport,           cat_network       },
-    { "getcheckpoint",           &getcheckpoint,           cat_network       },
-    { "getconnectioncount",      &getconnectioncount,      cat_network       },
-    { "getdifficulty",           &getdifficulty,           cat_network       },
-    { "getinfo",                 &getinfo,                 cat_network       },
-    { "getnettotals",            &getnettotals,            cat_network       },
-    { "getpeerinfo",             &getpeerinfo,             cat_network       },
-    { "getrawmempool",           &getrawmempool,           cat_network       },
-    { "listbanned",              &listbanned,              cat_network       },
-    { "networktime",             &networktime,             cat_network       },
-    { "ping",                    &ping,                    cat_network       },
-    { "setban",                  &setban,                  cat_network       },
-    { "showblock",               &showblock,               cat_network       },
-    { "stop",                    &stop,                    cat_network       },
+    { "addnode",                 &addnode,                 cat_network,      false },
+    { "askforoutstandingblocks", &askforoutstandingblocks, cat_network,      false },
+    { "getblockchaininfo",       &getblockchaininfo,       cat_network,      true  },
+    { "getnetworkinfo",          &getnetworkinfo,          cat_network,      true  },
+    { "clearbanned",             &clearbanned,             cat_network,      false },
+    { "currenttime",             &currenttime,             cat_network,      true  },
+    { "getaddednodeinfo",        &getaddednodeinfo,        cat_network,      true  },
+    { "getaddressbalance",       &getaddressbalance,       cat_network,      true  },
+    { "getaddresshistory",       &BufferStreamedResult<getaddresshistory>,
+                                                           cat_network,      true,  &getaddresshistory },
+    { "getaddressutxos",         &BufferStreamedResult<getaddressutxos>,
+                                                           cat_network,      true,  &getaddressutxos },
+    { "getnodeaddresses",        &getnodeaddresses,        cat_network,      true  },
+    { "getbestblockhash",        &getbestblockhash,        cat_network,      true  },
+    { "getblock",                &getblock,                cat_network,      true  },
+    { "getblockbynumber",        &getblockbynumber,        cat_network,      true  },
+    { "getblockbymintime",       &getblockbymintime,       cat_network,      true  },
+    { "getblocksbatch",          &BufferStreamedResult<getblocksbatch>,
+                                                           cat_network,      true,  &getblocksbatch },
+    { "getblockcount",           &getblockcount,           cat_network,      true  },
+    { "getblockhash",            &getblockhash,            cat_network,      true  },
+    { "getburnreport",           &getburnreport,           cat_network,      true  },
+    { "getcheckpoint",           &getcheckpoint,           cat_network,      true  },
+    { "getconnectioncount",      &getconnectioncount,      cat_network,      true  },
+    { "getdifficulty",           &getdifficulty,           cat_network,      true  },
+    { "getinfo",                 &getinfo,                 cat_network,      true  },
+    { "getnettotals",            &getnettotals,            cat_network,      true  },
+    { "getpeerinfo",             &getpeerinfo,             cat_network,      true  },
+    { "getrawmempool",           &getrawmempool,           cat_network,      true  },
+    { "listbanned",              &listbanned,              cat_network,      true  },
+    { "networktime",             &networktime,             cat_network,      true  },
+    { "ping",                    &ping,                    cat_network,      false },
+    { "setban",                  &setban,                  cat_network,      false },
+    { "showblock",               &showblock,               cat_network,      true  },
+    { "stop",                    &stop,                    cat_network,      false },
 
   // Voting commands
-    { "addpoll",                 &addpoll,                 cat_voting        },
-    { "getpollresults",          &getpollresults,          cat_voting        },
-    { "getvotingclaim",          &getvotingclaim,          cat_voting        },
-    { "listpolls",               &listpolls,               cat_voting        },
-    { "vote",                    &vote,                    cat_voting        },
-    { "votebyid",                &votebyid,                cat_voting        },
-    { "votedetails",             &votedetails,             cat_voting        },
+    { "addpoll",                 &addpoll,                 cat_voting,       false },
+    { "getpollresults",          &getpollresults,          cat_voting,       true  },
+    { "getvotingclaim",          &getvotingclaim,          cat_voting,       true  },
+    { "listpolls",               &listpolls,               cat_voting,       true  },
+    { "vote",                    &vote,                    cat_voting,       false },
+    { "votebyid",                &votebyid,                cat_voting,       false },
+    { "votedetails",             &votedetails,             cat_voting,       true  },
 };
 
 static constexpr const char* DEPRECATED_RPCS[] {
@@ -485,15 +500,15 @@ const CRPCCommand* CRPCTable::operator[](string name) const
     return it->second;
 }
 
-void ErrorReply(std::ostream& stream, const UniValue& objError, const UniValue& id)
+int ErrorReply(const UniValue& objError, const UniValue& id, std::string& strReply)
 {
     // Send error reply from json-rpc error object
     int nStatus = HTTP_INTERNAL_SERVER_ERROR;
     int code = find_value(objError, "code").get_int();
     if (code == RPC_INVALID_REQUEST) nStatus = HTTP_BAD_REQUEST;
     else if (code == RPC_METHOD_NOT_FOUND) nStatus = HTTP_NOT_FOUND;
-    string strReply = JSONRPCReply(NullUniValue, objError, id);
-    stream << HTTPReply(nStatus, strReply, false) << std::flush;
+    strReply = JSONRPCReply(NullUniValue, objError, id);
+    return nStatus;
 }
 
 bool ClientAllowed(const boost::asio::ip::address& address)
@@ -519,47 +534,445 @@ bool ClientAllowed(const boost::asio::ip::address& address)
     return false;
 }
 
-void ServiceConnection(AcceptedConnection *conn);
+static int JSONRPCExecRequest(const UniValue& valRequest, std::string& strReply);
+static int JSONRPCExecStreamed(const UniValue& valRequest, const JSONStreamWriter::Sink& sink, std::string& strReply);
+
+namespace {
+//!
+//! \brief Services the HTTP requests of a single RPC client connection without
+//! blocking a thread.
+//!
+//! The network thread reads and parses requests asynchronously and places them
+//! in the work queue. A worker thread executes the request and posts the reply
+//! to the network thread, which writes it and then reads the next request, if
+//! the client keeps the connection alive. An idle connection holds no thread:
+//! it waits for data until -rpcservertimeout expires.
+//!
+//! Only the network thread touches the socket, the timer and the state of the
+//! connection. It is the only thread that runs the I/O context, so posting to
+//! the context serializes the work of the connection like a strand.
+//!
+class RPCConnection : public std::enable_shared_from_this<RPCConnection>
+{
+public:
+    RPCConnection(ioContext& io_context, ssl::context& context, const bool fUseSSL)
+        : m_io_context(io_context)
+        , m_stream(io_context, context)
+        , m_use_ssl(fUseSSL)
+        , m_timer(io_context)
+    {
+    }
+
+    ip::tcp::socket::lowest_layer_type& socket()
+    {
+        return m_stream.lowest_layer();
+    }
+
+    //!
+    //! \brief Begin to service the connection after it was accepted.
+    //!
+    void Start()
+    {
+        // Restrict callers by IP.  It is important to do this before reading
+        // anything, to filter out certain DoS and misbehaving clients.
+        if (!ClientAllowed(m_peer.address())) {
+            // Only send a 403 if we're not using SSL to prevent a DoS during the SSL handshake.
+            if (!m_use_ssl) {
+                SendReply(HTTP_FORBIDDEN, "", false);
+            } else {
+                Close();
+            }
+
+            return;
+        }
+
+        if (!m_use_ssl) {
+            ReadRequest();
+            return;
+        }
+
+        ArmTimer(std::chrono::seconds(m_timeout), [this]() { Close(); });
+
+        m_stream.async_handshake(
+            ssl::stream_base::server,
+            [self = shared_from_this()](const boost::system::error_code& error) {
+                self->CancelTimer();
+
+                if (!error) {
+                    self->ReadRequest();
+                }
+            });
+    }
+
+    //!
+    //! \brief Send a reply to the client. Callable from any thread.
+    //!
+    //! \param status    HTTP status code.
+    //! \param body      Body of the reply.
+    //! \param keepalive Whether to read another request after the reply.
+    //!
+    void SendReply(const int status, std::string body, const bool keepalive)
+    {
+        m_io_context.post([self = shared_from_this(), status, body = std::move(body), keepalive]() {
+            self->WriteReply(status, body, keepalive);
+        });
+    }
+
+    //!
+    //! \brief Execute a request with a streaming command and send the result
+    //! as it is produced, using chunked transfer encoding. Runs on a worker.
+    //!
+    //! The worker waits for each chunk to reach the client: this holds the
+    //! command back while the client receives the data, so the server buffers
+    //! at most about one chunk of the result. A client that does not accept a
+    //! chunk within -rpcservertimeout loses the connection, which releases the
+    //! worker. If the command fails before it produced the first chunk, the
+    //! client receives the usual error reply. A failure after that point can
+    //! only close the connection.
+    //!
+    void StreamReply(const UniValue& valRequest, bool keepalive)
+    {
+        keepalive = keepalive && !fShutdown;
+
+        bool started = false;
+
+        const auto sink = [&](const std::string& data) {
+            if (!started) {
+                started = true;
+                WriteSync(HTTPChunkedReplyHeader(HTTP_OK, keepalive));
+            }
+
+            WriteSync(HTTPChunk(data));
+        };
+
+        std::string strReply;
+        const int status = JSONRPCExecStreamed(valRequest, sink, strReply);
+
+        if (!started) {
+            SendReply(status, std::move(strReply), keepalive);
+            return;
+        }
+
+        boost::system::error_code error;
+
+        if (status != HTTP_OK) {
+            LogPrint(BCLog::LogFlags::RPC, "%s: streamed reply to %s failed after it started",
+                     __func__, m_peer.address().to_string());
+
+            error = boost::asio::error::operation_aborted;
+        } else {
+            try {
+                WriteSync(HTTPChunk(""));
+            } catch (const boost::system::system_error& e) {
+                error = e.code();
+            }
+        }
+
+        m_io_context.post([self = shared_from_this(), error, keepalive]() {
+            self->m_keepalive = keepalive;
+            self->OnReplySent(error);
+        });
+    }
+
+    ip::tcp::endpoint m_peer;
+
+    //!
+    //! \brief Seconds that an idle connection stays open. Set by StartRPCThreads().
+    //!
+    static int64_t m_timeout;
+
+    //!
+    //! \brief Executes the requests of all connections. Set by StartRPCThreads().
+    //!
+    static RPCWorkQueue* m_work_queue;
+
+private:
+    ioContext& m_io_context;
+    ssl::stream<ip::tcp::socket> m_stream;
+    const bool m_use_ssl;
+    boost::asio::steady_timer m_timer;
+    std::atomic<uint64_t> m_timer_generation{0};
+    std::array<char, 16384> m_read_buffer;
+    std::string m_received;
+    std::string m_reply;
+    bool m_keepalive = false;
+
+    //!
+    //! \brief Run an action after a delay unless canceled first.
+    //!
+    //! The generation counter discards an expiration that the network thread
+    //! already queued when the timer was canceled or re-armed. Runs on the
+    //! network thread, like the expiration.
+    //!
+    template <typename Action>
+    void ArmTimer(const std::chrono::milliseconds delay, Action action)
+    {
+        const uint64_t generation = ++m_timer_generation;
+
+        m_timer.expires_at(std::chrono::steady_clock::now() + delay);
+        m_timer.async_wait(
+            [self = shared_from_this(), generation, action](const boost::system::error_code& error) {
+                if (!error && self->m_timer_generation == generation) {
+                    action();
+                }
+            });
+    }
+
+    void CancelTimer()
+    {
+        ++m_timer_generation;
+        m_timer.cancel();
+    }
+
+    //!
+    //! \brief Write a reply to the client. Runs on the network thread.
+    //!
+    void WriteReply(const int status, const std::string& body, const bool keepalive)
+    {
+        m_keepalive = keepalive && !fShutdown;
+        m_reply = HTTPReply(status, body, m_keepalive);
+
+        const auto handler = [self = shared_from_this()](const boost::system::error_code& error, size_t) {
+            self->m_reply.clear();
+            self->OnReplySent(error);
+        };
+
+        if (m_use_ssl) {
+            boost::asio::async_write(m_stream, boost::asio::buffer(m_reply), handler);
+        } else {
+            boost::asio::async_write(m_stream.next_layer(), boost::asio::buffer(m_reply), handler);
+        }
+    }
+
+    //!
+    //! \brief Handle the next request received from the client, reading more
+    //! data first if the buffer does not contain a complete request.
+    //!
+    void ReadRequest()
+    {
+        HTTPRequest request;
+
+        switch (ParseHTTPRequest(m_received, request)) {
+            case HTTPParseResult::COMPLETE:
+                HandleRequest(std::move(request));
+                return;
+            case HTTPParseResult::INVALID:
+                SendReply(HTTP_BAD_REQUEST, "", false);
+                return;
+            case HTTPParseResult::INCOMPLETE:
+                break;
+        }
+
+        ArmTimer(std::chrono::seconds(m_timeout), [this]() {
+            LogPrint(BCLog::LogFlags::RPC, "%s: closing idle connection from %s",
+                     __func__, m_peer.address().to_string());
+            Close();
+        });
+
+        const auto handler = [self = shared_from_this()](const boost::system::error_code& error, size_t bytes) {
+            self->CancelTimer();
+
+            if (error) {
+                self->Close();
+                return;
+            }
+
+            self->m_received.append(self->m_read_buffer.data(), bytes);
+            self->ReadRequest();
+        };
+
+        if (m_use_ssl) {
+            m_stream.async_read_some(boost::asio::buffer(m_read_buffer), handler);
+        } else {
+            m_stream.next_layer().async_read_some(boost::asio::buffer(m_read_buffer), handler);
+        }
+    }
+
+    void HandleRequest(HTTPRequest request)
+    {
+        if (request.m_uri != "/") {
+            SendReply(HTTP_NOT_FOUND, "", false);
+            return;
+        }
+
+        // Check authorization
+        if (request.m_headers.count("authorization") == 0) {
+            SendReply(HTTP_UNAUTHORIZED, "", false);
+            return;
+        }
+
+        if (!HTTPAuthorized(request.m_headers)) {
+            LogPrintf("ThreadRPCServer incorrect password attempt from %s\n", m_peer.address().to_string());
+
+            /* Deter brute-forcing short passwords.
+               If this results in a DOS the user really
+               shouldn't have their RPC port exposed.*/
+            if (gArgs.GetArgs("-rpcpassword").size() < 20) {
+                ArmTimer(std::chrono::milliseconds(250), [this]() { SendReply(HTTP_UNAUTHORIZED, "", false); });
+            } else {
+                SendReply(HTTP_UNAUTHORIZED, "", false);
+            }
+
+            return;
+        }
+
+        const bool keepalive = request.KeepAlive();
+
+        // Parse the request here so that the connection can answer malformed
+        // requests and queue limits without occupying a worker:
+        UniValue valRequest(UniValue::VSTR);
+
+        if (!valRequest.read(request.m_body)) {
+            std::string strReply;
+            const int status = ErrorReply(JSONRPCError(RPC_PARSE_ERROR, "Parse error"), NullUniValue, strReply);
+
+            SendReply(status, strReply, false);
+            return;
+        }
+
+        std::string method;
+        UniValue id = NullUniValue;
+
+        if (valRequest.isObject()) {
+            const UniValue& valMethod = find_value(valRequest, "method");
+
+            if (valMethod.isStr()) method = valMethod.get_str();
+
+            id = find_value(valRequest, "id");
+        }
+
+        // Chunked transfer encoding requires HTTP/1.1:
+        const CRPCCommand* pcmd = method.empty() ? nullptr : tableRPC[method];
+        const bool stream = pcmd && pcmd->stream_actor && request.m_proto >= 1;
+
+        const bool queued = m_work_queue->Enqueue(
+            method,
+            [self = shared_from_this(), valRequest = std::move(valRequest), keepalive, stream]() {
+                if (stream) {
+                    self->StreamReply(valRequest, keepalive);
+                    return;
+                }
+
+                std::string strReply;
+                const int status = JSONRPCExecRequest(valRequest, strReply);
+
+                self->SendReply(status, std::move(strReply), keepalive);
+            });
+
+        if (!queued) {
+            SendReply(
+                HTTP_SERVICE_UNAVAILABLE,
+                JSONRPCReply(NullUniValue, JSONRPCError(RPC_MISC_ERROR, "Work queue depth exceeded"), id),
+                keepalive);
+        }
+    }
+
+    //!
+    //! \brief Write data to the client and wait for the write to finish. Runs
+    //! on a worker.
+    //!
+    //! The network thread performs the write so that the deadline timer can
+    //! close the connection of a client that stalls.
+    //!
+    //! \throws boost::system::system_error if the write fails or times out.
+    //!
+    void WriteSync(std::string data)
+    {
+        const auto buffer = std::make_shared<std::string>(std::move(data));
+        const auto done = std::make_shared<std::promise<boost::system::error_code>>();
+        std::future<boost::system::error_code> result = done->get_future();
+
+        m_io_context.post([self = shared_from_this(), buffer, done]() {
+            self->ArmTimer(std::chrono::seconds(m_timeout), [self]() {
+                LogPrint(BCLog::LogFlags::RPC, "%s: closing stalled streamed reply to %s",
+                         __func__, self->m_peer.address().to_string());
+                self->Close();
+            });
+
+            const auto handler = [self, buffer, done](const boost::system::error_code& error, size_t) {
+                self->CancelTimer();
+                done->set_value(error);
+            };
+
+            if (self->m_use_ssl) {
+                boost::asio::async_write(self->m_stream, boost::asio::buffer(*buffer), handler);
+            } else {
+                boost::asio::async_write(self->m_stream.next_layer(), boost::asio::buffer(*buffer), handler);
+            }
+        });
+
+        // The timer completes the write. Only a stopped network thread leaves
+        // the write pending past the deadline:
+        if (result.wait_for(std::chrono::seconds(m_timeout + 5)) != std::future_status::ready) {
+            throw boost::system::system_error(boost::asio::error::timed_out);
+        }
+
+        const boost::system::error_code error = result.get();
+
+        if (error) {
+            throw boost::system::system_error(error);
+        }
+    }
+
+    //!
+    //! \brief Read the next request after a reply unless the connection ends.
+    //!
+    void OnReplySent(const boost::system::error_code& error)
+    {
+        if (error || !m_keepalive || fShutdown) {
+            Close();
+            return;
+        }
+
+        ReadRequest();
+    }
+
+    void Close()
+    {
+        CancelTimer();
+
+        boost::system::error_code ignored;
+        m_stream.lowest_layer().shutdown(ip::tcp::socket::shutdown_both, ignored);
+        m_stream.lowest_layer().close(ignored);
+    }
+}; // RPCConnection
+
+int64_t RPCConnection::m_timeout = DEFAULT_RPC_SERVER_TIMEOUT;
+RPCWorkQueue* RPCConnection::m_work_queue = nullptr;
 
 // Forward declaration required for RPCListen
-template <typename Protocol>
-static void RPCAcceptHandler(boost::shared_ptr< basic_socket_acceptor<Protocol> > acceptor,
-                             ssl::context& context,
-                             bool fUseSSL,
-                             AcceptedConnection* conn,
-                             const boost::system::error_code& error);
+void RPCAcceptHandler(boost::shared_ptr<ip::tcp::acceptor> acceptor,
+                      ssl::context& context,
+                      bool fUseSSL,
+                      std::shared_ptr<RPCConnection> conn,
+                      const boost::system::error_code& error);
 
 /**
  * Sets up I/O resources to accept and handle a new connection.
  */
-template <typename Protocol>
-static void RPCListen(boost::shared_ptr< basic_socket_acceptor<Protocol> > acceptor,
-                      ssl::context& context,
-                      const bool fUseSSL)
+void RPCListen(boost::shared_ptr<ip::tcp::acceptor> acceptor,
+               ssl::context& context,
+               const bool fUseSSL)
 {
     // Accept connection
-    AcceptedConnectionImpl<Protocol>* conn = new AcceptedConnectionImpl<Protocol>(GetIOServiceFromPtr(acceptor), context, fUseSSL);
+    auto conn = std::make_shared<RPCConnection>(GetIOServiceFromPtr(acceptor), context, fUseSSL);
 
     acceptor->async_accept(
-                conn->sslStream.lowest_layer(),
-                conn->peer,
-                boost::bind(&RPCAcceptHandler<Protocol>,
-                            acceptor,
-                            boost::ref(context),
-                            fUseSSL,
-                            conn,
-                            boost::asio::placeholders::error));
+        conn->socket(),
+        conn->m_peer,
+        [acceptor, &context, fUseSSL, conn](const boost::system::error_code& error) {
+            RPCAcceptHandler(acceptor, context, fUseSSL, conn, error);
+        });
 }
 
 /**
  * Accept and handle incoming connection.
  */
-template <typename Protocol>
-static void RPCAcceptHandler(boost::shared_ptr< basic_socket_acceptor<Protocol> > acceptor,
-                             ssl::context& context,
-                             const bool fUseSSL,
-                             AcceptedConnection* conn,
-                             const boost::system::error_code& error)
+void RPCAcceptHandler(boost::shared_ptr<ip::tcp::acceptor> acceptor,
+                      ssl::context& context,
+                      const bool fUseSSL,
+                      std::shared_ptr<RPCConnection> conn,
+                      const boost::system::error_code& error)
 {
     // Immediately start accepting new connections, except when we're cancelled or our socket is closed.
     if (error != asio::error::operation_aborted && acceptor->is_open())
@@ -567,25 +980,9 @@ static void RPCAcceptHandler(boost::shared_ptr< basic_socket_acceptor<Protocol>
 
     // TODO : Actually handle errors
     if (!error)
-    {
-        // Restrict callers by IP.  It is important to
-        // do this before starting client thread, to filter out
-        // certain DoS and misbehaving clients.
-        AcceptedConnectionImpl<ip::tcp>* tcp_conn = dynamic_cast< AcceptedConnectionImpl<ip::tcp>* >(conn);
-        if (tcp_conn && !ClientAllowed(tcp_conn->peer.address()))
-        {
-            // Only send a 403 if we're not using SSL to prevent a DoS during the SSL handshake.
-            if (!fUseSSL)
-                conn->stream() << HTTPReply(HTTP_FORBIDDEN, "", false) << std::flush;
-        }
-        else
-            ServiceConnection(conn);
-
-        conn->close();
-    }
-
-    delete conn;
+        conn->Start();
 }
+} // anonymous namespace
 
 void StartRPCThreads()
 {
@@ -623,6 +1020,9 @@ void StartRPCThreads()
 
     assert(rpc_io_service == nullptr);
     rpc_io_service = new ioContext();
+    rpc_work_queue = new RPCWorkQueue(
+        std::max<int64_t>(1, gArgs.GetArg("-rpcworkqueue", DEFAULT_RPC_WORK_QUEUE)),
+        RPCWorkQueue::ParseMethodLimits(gArgs.GetArgs("-rpcmethodlimit")));
     rpc_ssl_context = new ssl::context(ssl::context::sslv23);
 
     if (fUseSSL)
@@ -703,9 +1103,18 @@ void StartRPCThreads()
         return;
     }
 
+    RPCConnection::m_timeout = std::max<int64_t>(1, gArgs.GetArg("-rpcservertimeout", DEFAULT_RPC_SERVER_TIMEOUT));
+    RPCConnection::m_work_queue = rpc_work_queue;
+
+    // A single network thread services every connection without blocking. The
+    // worker threads execute the requests:
     rpc_worker_group = new boost::thread_group();
-    for (int i = 0; i < gArgs.GetArg("-rpcthreads", 4); i++)
-        rpc_worker_group->create_thread(boost::bind(&ioContext::run, rpc_io_service));
+    rpc_worker_group->create_thread(boost::bind(&ioContext::run, rpc_io_service));
+
+    rpc_worker_threads = std::max<int64_t>(1, gArgs.GetArg("-rpcthreads", 4));
+
+    for (int i = 0; i < rpc_worker_threads; i++)
+        rpc_worker_group->create_thread(boost::bind(&RPCWorkQueue::Run, rpc_work_queue));
 }
 
 void StopRPCThreads()
@@ -717,6 +1126,7 @@ void StopRPCThreads()
         return;
     }
 
+    rpc_work_queue->Interrupt();
     rpc_io_service->stop();
     if (rpc_worker_group != nullptr) {
         rpc_worker_group->join_all();
@@ -728,6 +1138,9 @@ void StopRPCThreads()
     rpc_ssl_context = nullptr;
     delete rpc_io_service;
     rpc_io_service = nullptr;
+    delete rpc_work_queue;
+    rpc_work_queue = nullptr;
+    rpc_worker_threads = 0;
 }
 
 class JSONRequest
@@ -796,94 +1209,255 @@ static UniValue JSONRPCExecOne(const UniValue& req)
     return rpc_result;
 }
 
-static string JSONRPCExecBatch(const UniValue& vReq)
+namespace {
+//!
+//! \brief Maximum number of RPC workers that help to execute one batch.
+//!
+constexpr size_t MAX_BATCH_HELPERS = 4;
+
+//!
+//! \brief Get the method name of a batch element, or an empty string if it
+//! has none.
+//!
+std::string GetRequestMethod(const UniValue& req)
 {
-    UniValue ret(UniValue::VARR);
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(vReq[reqIdx]));
+    if (!req.isObject()) return "";
 
-    return UniValue(ret).write() + "\n";
+    const UniValue& valMethod = find_value(req, "method");
+
+    return valMethod.isStr() ? valMethod.get_str() : "";
 }
 
-void ServiceConnection(AcceptedConnection *conn)
+//!
+//! \brief Determine whether a batch element calls a command that may execute
+//! in parallel with the other elements.
+//!
+bool IsConcurrentRequest(const UniValue& req)
 {
-    bool fRun = true;
-    while (fRun && !fShutdown)
-    {
-        int nProto = 0;
-        map<string, string> mapHeaders;
-        string strRequest, strMethod, strURI;
+    const std::string method = GetRequestMethod(req);
+    if (method.empty()) return false;
 
-        // Read HTTP request line
-        if (!ReadHTTPRequestLine(conn->stream(), nProto, strMethod, strURI))
-            break;
+    const CRPCCommand* pcmd = tableRPC[method];
 
-        // Read HTTP message headers and body
-        ReadHTTPMessage(conn->stream(), mapHeaders, strRequest, nProto);
+    return pcmd && pcmd->concurrent;
+}
 
-        if (strURI != "/") {
-            conn->stream() << HTTPReply(HTTP_NOT_FOUND, "", false) << std::flush;
-            break;
+//!
+//! \brief A run of consecutive concurrent elements of a batch request.
+//!
+//! The thread that services the batch claims any element of the run. Each RPC
+//! worker that helps claims only the elements of the method that it was queued
+//! for, so the -rpcmethodlimit accounting of the work queue covers it. Each
+//! element writes its result to its own slot, so the results stay in request
+//! order. A helper that starts after the run finished claims nothing and
+//! touches no request data.
+//!
+class BatchSegment
+{
+public:
+    BatchSegment(const UniValue& requests, std::vector<UniValue>& results, const size_t begin, const size_t end)
+        : m_requests(requests)
+        , m_results(results)
+        , m_begin(begin)
+        , m_size(end - begin)
+        , m_claimed(new std::atomic<bool>[end - begin])
+    {
+        m_methods.reserve(m_size);
+
+        for (size_t i = begin; i < end; ++i) {
+            m_methods.emplace_back(GetRequestMethod(requests[i]));
+            m_claimed[i - begin] = false;
         }
+    }
 
-        // Check authorization
-        if (mapHeaders.count("authorization") == 0)
-        {
-            conn->stream() << HTTPReply(HTTP_UNAUTHORIZED, "", false) << std::flush;
-            break;
+    //!
+    //! \brief Get the method of an element of the run.
+    //!
+    //! \param i Position of the element in the run.
+    //!
+    const std::string& GetMethod(const size_t i) const
+    {
+        return m_methods[i];
+    }
+
+    //!
+    //! \brief Execute elements until none remain unclaimed.
+    //!
+    //! \param method Only execute the elements of this method. Executes every
+    //! element when empty.
+    //!
+    void Work(const std::string& method = "")
+    {
+        size_t executed = 0;
+
+        for (size_t i = 0; i < m_size; ++i) {
+            if ((!method.empty() && m_methods[i] != method) || m_claimed[i].exchange(true)) {
+                continue;
+            }
+
+            m_results[m_begin + i] = JSONRPCExecOne(m_requests[m_begin + i]);
+            ++executed;
         }
-        if (!HTTPAuthorized(mapHeaders))
-        {
-            LogPrintf("ThreadRPCServer incorrect password attempt from %s\n", conn->peer_address_to_string());
-            /* Deter brute-forcing short passwords.
-               If this results in a DOS the user really
-               shouldn't have their RPC port exposed.*/
-            if (gArgs.GetArgs("-rpcpassword").size() < 20)
-                UninterruptibleSleep(std::chrono::milliseconds{250});
 
-            conn->stream() << HTTPReply(HTTP_UNAUTHORIZED, "", false) << std::flush;
-            break;
+        if (executed > 0) {
+            {
+                LOCK(m_mutex);
+                m_done += executed;
+            }
+
+            m_cond.notify_all();
         }
-        if (mapHeaders["connection"] == "close")
-            fRun = false;
+    }
 
-        JSONRequest jreq;
-        try
-        {
-            // Parse request
-            UniValue valRequest(UniValue::VSTR);
-            if (!valRequest.read(strRequest))
-                throw JSONRPCError(RPC_PARSE_ERROR, "Parse error");
+    //!
+    //! \brief Wait for the elements claimed by other threads to finish.
+    //!
+    void Wait()
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_done == m_size; });
+    }
 
-            string strReply;
+private:
+    const UniValue& m_requests;
+    std::vector<UniValue>& m_results;
+    const size_t m_begin;
+    const size_t m_size;
+    std::vector<std::string> m_methods;
+    std::unique_ptr<std::atomic<bool>[]> m_claimed;
+
+    Mutex m_mutex;
+    std::condition_variable m_cond;
+    size_t m_done GUARDED_BY(m_mutex) = 0;
+};
 
-            // singleton request
-            if (valRequest.isObject()) {
-                jreq.parse(valRequest);
+//!
+//! \brief Execute the concurrent batch elements in [begin, end) on the calling
+//! thread and on up to MAX_BATCH_HELPERS RPC worker threads.
+//!
+//! The calling thread works through the elements itself, so the batch finishes
+//! even if every other worker is busy or the work queue rejects the helpers.
+//! Helpers queue under the names of the methods that they execute and only
+//! use the free half of the work queue, so a batch cannot take the slots of
+//! other clients or run a method past its -rpcmethodlimit.
+//!
+void JSONRPCExecConcurrent(const UniValue& vReq, std::vector<UniValue>& results, const size_t begin, const size_t end)
+{
+    auto segment = std::make_shared<BatchSegment>(vReq, results, begin, end);
 
-                UniValue result = tableRPC.execute(jreq.strMethod, jreq.params);
+    const size_t helpers = rpc_work_queue
+        ? std::min({ end - begin - 1, static_cast<size_t>(std::max(rpc_worker_threads - 1, 0)), MAX_BATCH_HELPERS })
+        : 0;
 
-                // Send reply
-                strReply = JSONRPCReply(result, NullUniValue, jreq.id);
+    const size_t reserve = helpers > 0 ? std::max<size_t>(1, rpc_work_queue->GetMaxDepth() / 2) : 0;
 
-            // array of requests
-            } else if (valRequest.isArray())
-                strReply = JSONRPCExecBatch(valRequest.get_array());
-            else
-                throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
+    // Spread the helpers over the run so that they cover its mix of methods.
+    // The calling thread starts from the front:
+    for (size_t i = 0; i < helpers; ++i) {
+        const std::string& method = segment->GetMethod(end - begin - 1 - i * (end - begin - 1) / helpers);
 
-            conn->stream() << HTTPReply(HTTP_OK, strReply, fRun) << std::flush;
-        }
-        catch (UniValue& objError)
-        {
-            ErrorReply(conn->stream(), objError, jreq.id);
+        if (!rpc_work_queue->Enqueue(method, [segment, method]() { segment->Work(method); }, reserve)) {
             break;
         }
-        catch (std::exception& e)
-        {
-            ErrorReply(conn->stream(), JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id);
-            break;
+    }
+
+    segment->Work();
+    segment->Wait();
+}
+} // anonymous namespace
+
+static string JSONRPCExecBatch(const UniValue& vReq)
+{
+    std::vector<UniValue> results(vReq.size());
+
+    // Elements that call a command with side effects act as barriers: they run
+    // alone, after every element before them, in request order.
+    for (size_t reqIdx = 0; reqIdx < vReq.size();)
+    {
+        if (!IsConcurrentRequest(vReq[reqIdx])) {
+            results[reqIdx] = JSONRPCExecOne(vReq[reqIdx]);
+            ++reqIdx;
+            continue;
+        }
+
+        size_t end = reqIdx + 1;
+        while (end < vReq.size() && IsConcurrentRequest(vReq[end])) ++end;
+
+        if (end - reqIdx == 1) {
+            results[reqIdx] = JSONRPCExecOne(vReq[reqIdx]);
+        } else {
+            JSONRPCExecConcurrent(vReq, results, reqIdx, end);
         }
+
+        reqIdx = end;
+    }
+
+    UniValue ret(UniValue::VARR);
+    for (auto& result : results)
+        ret.push_back(std::move(result));
+
+    return UniValue(ret).write() + "\n";
+}
+
+static int JSONRPCExecRequest(const UniValue& valRequest, std::string& strReply)
+{
+    JSONRequest jreq;
+    try
+    {
+        // singleton request
+        if (valRequest.isObject()) {
+            jreq.parse(valRequest);
+
+            UniValue result = tableRPC.execute(jreq.strMethod, jreq.params);
+
+            // Send reply
+            strReply = JSONRPCReply(result, NullUniValue, jreq.id);
+
+        // array of requests
+        } else if (valRequest.isArray())
+            strReply = JSONRPCExecBatch(valRequest.get_array());
+        else
+            throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
+
+        return HTTP_OK;
+    }
+    catch (UniValue& objError)
+    {
+        return ErrorReply(objError, jreq.id, strReply);
+    }
+    catch (std::exception& e)
+    {
+        return ErrorReply(JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id, strReply);
+    }
+}
+
+static int JSONRPCExecStreamed(const UniValue& valRequest, const JSONStreamWriter::Sink& sink, std::string& strReply)
+{
+    JSONRequest jreq;
+    JSONStreamWriter writer(sink);
+
+    try
+    {
+        jreq.parse(valRequest);
+
+        // Same layout as JSONRPCReply():
+        writer.BeginObject();
+        writer.Key("result");
+        tableRPC.execute(jreq.strMethod, jreq.params, writer);
+        writer.PushKV("error", NullUniValue);
+        writer.PushKV("id", jreq.id);
+        writer.EndObject();
+        writer.Flush();
+
+        return HTTP_OK;
+    }
+    catch (UniValue& objError)
+    {
+        return ErrorReply(objError, jreq.id, strReply);
+    }
+    catch (std::exception& e)
+    {
+        return ErrorReply(JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id, strReply);
     }
 }
 
@@ -922,6 +1496,32 @@ UniValue CRPCTable::execute(const std::string& strMethod, const UniValue& params
 }
 
 
+void CRPCTable::execute(const std::string& strMethod, const UniValue& params, JSONWriter& result) const
+{
+    const CRPCCommand *pcmd = tableRPC[strMethod];
+    if (!pcmd)
+        throw JSONRPCError(RPC_METHOD_NOT_FOUND, "Method not found");
+
+    if (!pcmd->stream_actor) {
+        result.Value(execute(strMethod, params));
+        return;
+    }
+
+    try
+    {
+        const int64_t nRPCtimebegin = GetTimeMillis();
+
+        pcmd->stream_actor(params, false, result);
+
+        LogPrint(BCLog::LogFlags::RPC, "RPCTime : Command %s -> Totaltime %" PRId64 "ms (streamed)",
+                 strMethod, GetTimeMillis() - nRPCtimebegin);
+    }
+    catch (std::exception& e)
+    {
+        throw JSONRPCError(RPC_MISC_ERROR, e.what());
+    }
+}
+
 std::vector<std::string> CRPCTable::listCommands() const
 {
     std::vector<std::string> commandList;
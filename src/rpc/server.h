@@ -13,6 +13,8 @@
 class CBlockIndex;
 class uint256;
 
+#include "rpc/jsonwriter.h"
+
 #include <univalue.h>
 
 void StartRPCThreads();
@@ -35,6 +37,25 @@ void RPCTypeCheckObj(const UniValue& o,
 
 typedef UniValue(*rpcfn_type)(const UniValue& params, bool fHelp);
 
+//!
+//! \brief Handler for a command that writes its result through a JSONWriter so
+//! that the server can send a large result while the command produces it.
+//!
+typedef void(*rpcstreamfn_type)(const UniValue& params, bool fHelp, JSONWriter& result);
+
+//!
+//! \brief Adapts a streaming command handler to the rpcfn_type interface for
+//! callers that need the result as a UniValue.
+//!
+template <rpcstreamfn_type stream_actor>
+UniValue BufferStreamedResult(const UniValue& params, bool fHelp)
+{
+    UniValueWriter writer;
+    stream_actor(params, fHelp, writer);
+
+    return writer.Release();
+}
+
 enum rpccategory
 {
     cat_null,
@@ -51,6 +72,18 @@ public:
     std::string name;
     rpcfn_type actor;
     rpccategory category;
+
+    //!
+    //! \brief Whether the command only reads state so that the elements of a
+    //! batch request that call it may execute in parallel and in any order.
+    //!
+    bool concurrent;
+
+    //!
+    //! \brief Optional handler that streams the result. The server prefers it
+    //! over \c actor for a single request from an HTTP/1.1 client.
+    //!
+    rpcstreamfn_type stream_actor = nullptr;
 };
 
 /**
@@ -74,6 +107,16 @@ public:
      */
     UniValue execute(const std::string &method, const UniValue& params) const;
 
+    /**
+     * Execute a method and write the result through a JSON writer. Uses the
+     * streaming handler of the command when it has one.
+     * @param method   Method to execute
+     * @param params   Array of arguments (JSON objects)
+     * @param result   Receives the result of the call.
+     * @throws an exception when an error happens.
+     */
+    void execute(const std::string &method, const UniValue& params, JSONWriter& result) const;
+
     /**
     * Returns a list of registered commands
     * @returns List of registered commands.
@@ -89,6 +132,7 @@ extern UniValue ValueFromAmount(int64_t amount);
 
 extern std::string HelpRequiringPassphrase();
 extern void EnsureWalletIsUnlocked();
+extern void EnsureBlockNotPruned(const CBlockIndex* pindex);
 
 //
 // Utilities: convert hex-encoded Values
@@ -188,11 +232,14 @@ extern UniValue superblocks(const UniValue& params, bool fHelp);
 extern UniValue auditsnapshotaccrual(const UniValue& params, bool fHelp);
 extern UniValue auditsnapshotaccruals(const UniValue& params, bool fHelp);
 extern UniValue addkey(const UniValue& params, bool fHelp);
-extern UniValue beaconaudit(const UniValue& params, bool fHelp);
+extern void beaconaudit(const UniValue& params, bool fHelp, JSONWriter& result);
 extern UniValue currentcontractaverage(const UniValue& params, bool fHelp);
 extern UniValue debug(const UniValue& params, bool fHelp);
 extern UniValue dumpcontracts(const UniValue& params, bool fHelp);
+extern UniValue exporttrace(const UniValue& params, bool fHelp);
 extern UniValue rpc_getblockstats(const UniValue& params, bool fHelp);
+extern UniValue getlockstats(const UniValue& params, bool fHelp);
+extern UniValue gettracestats(const UniValue& params, bool fHelp);
 extern UniValue inspectaccrualsnapshot(const UniValue& params, bool fHelp);
 extern UniValue listalerts(const UniValue& params, bool fHelp);
 extern UniValue listprojects(const UniValue& params, bool fHelp);
@@ -215,7 +262,7 @@ extern UniValue superblockaverage(const UniValue& params, bool fHelp);
 extern UniValue versionreport(const UniValue& params, bool fhelp);
 extern UniValue writedata(const UniValue& params, bool fHelp);
 
-extern UniValue listmanifests(const UniValue& params, bool fHelp);
+extern void listmanifests(const UniValue& params, bool fHelp, JSONWriter& result);
 extern UniValue getmanifest(const UniValue& params, bool fHelp);
 extern UniValue getmpart(const UniValue& params, bool fHelp);
 extern UniValue sendscraperfilemanifest(const UniValue& params, bool fHelp);
@@ -233,12 +280,15 @@ extern UniValue changesettings(const UniValue& params, bool fHelp);
 extern UniValue clearbanned(const UniValue& params, bool fHelp);
 extern UniValue currenttime(const UniValue& params, bool fHelp);
 extern UniValue getaddednodeinfo(const UniValue& params, bool fHelp);
+extern UniValue getaddressbalance(const UniValue& params, bool fHelp);
+extern void getaddresshistory(const UniValue& params, bool fHelp, JSONWriter& result);
+extern void getaddressutxos(const UniValue& params, bool fHelp, JSONWriter& result);
 extern UniValue getnodeaddresses(const UniValue& params, bool fHelp);
 extern UniValue getbestblockhash(const UniValue& params, bool fHelp);
 extern UniValue getblock(const UniValue& params, bool fHelp);
 extern UniValue getblockbynumber(const UniValue& params, bool fHelp);
 extern UniValue getblockbymintime(const UniValue& params, bool fHelp);
-extern UniValue getblocksbatch(const UniValue& params, bool fHelp);
+extern void getblocksbatch(const UniValue& params, bool fHelp, JSONWriter& result);
 extern UniValue getblockchaininfo(const UniValue& params, bool fHelp);
 extern UniValue getblockcount(const UniValue& params, bool fHelp);
 extern UniValue getblockhash(const UniValue& params, bool fHelp);
@@ -0,0 +1,139 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "logging.h"
+#include "rpc/workqueue.h"
+#include "util/strencodings.h"
+
+#include <algorithm>
+
+RPCWorkQueue::RPCWorkQueue(const size_t max_depth, std::map<std::string, size_t> method_limits)
+    : m_max_depth(max_depth)
+    , m_method_limits(std::move(method_limits))
+{
+}
+
+std::map<std::string, size_t> RPCWorkQueue::ParseMethodLimits(const std::vector<std::string>& args)
+{
+    std::map<std::string, size_t> limits;
+
+    for (const auto& arg : args) {
+        const size_t separator = arg.rfind(':');
+        int32_t limit = 0;
+
+        if (separator == std::string::npos
+            || separator == 0
+            || !ParseInt32(arg.substr(separator + 1), &limit)
+            || limit <= 0)
+        {
+            LogPrintf("WARNING: %s: ignoring malformed -rpcmethodlimit=%s", __func__, arg);
+            continue;
+        }
+
+        limits[arg.substr(0, separator)] = limit;
+    }
+
+    return limits;
+}
+
+bool RPCWorkQueue::Enqueue(std::string method, WorkItem item, const size_t reserve)
+{
+    {
+        LOCK(m_mutex);
+
+        if (m_interrupted) {
+            return false;
+        }
+
+        if (m_queue.size() + reserve >= m_max_depth) {
+            if (reserve == 0) {
+                ++m_rejected;
+                LogPrint(BCLog::LogFlags::RPC, "%s: work queue depth %u exceeded, rejected %s",
+                         __func__, m_max_depth, method);
+            }
+
+            return false;
+        }
+
+        m_queue.push_back({ std::move(method), std::move(item) });
+    }
+
+    m_cond.notify_one();
+
+    return true;
+}
+
+std::deque<RPCWorkQueue::Job>::iterator RPCWorkQueue::FindRunnable()
+{
+    if (m_method_limits.empty()) {
+        return m_queue.begin();
+    }
+
+    return std::find_if(m_queue.begin(), m_queue.end(), [&](const Job& job) {
+        const auto limit = m_method_limits.find(job.m_method);
+
+        return limit == m_method_limits.end() || m_running[job.m_method] < limit->second;
+    });
+}
+
+void RPCWorkQueue::Run()
+{
+    WAIT_LOCK(m_mutex, lock);
+
+    while (!m_interrupted) {
+        auto iter = FindRunnable();
+
+        if (iter == m_queue.end()) {
+            // Wait for a new request or for a limited method to finish:
+            m_cond.wait(lock);
+            continue;
+        }
+
+        Job job = std::move(*iter);
+        m_queue.erase(iter);
+        ++m_running[job.m_method];
+
+        {
+            REVERSE_LOCK(lock);
+
+            try {
+                job.m_item();
+            } catch (const std::exception& e) {
+                LogPrintf("ERROR: %s: unhandled exception in RPC work item: %s", __func__, e.what());
+            }
+        }
+
+        if (--m_running[job.m_method] == 0) {
+            m_running.erase(job.m_method);
+        }
+
+        // Another thread may wait for this method's limit to free up:
+        if (m_method_limits.count(job.m_method)) {
+            m_cond.notify_all();
+        }
+    }
+}
+
+void RPCWorkQueue::Interrupt()
+{
+    {
+        LOCK(m_mutex);
+        m_interrupted = true;
+        m_queue.clear();
+    }
+
+    m_cond.notify_all();
+}
+
+size_t RPCWorkQueue::GetDepth() const
+{
+    LOCK(m_mutex);
+    return m_queue.size();
+}
+
+uint64_t RPCWorkQueue::GetRejectedCount() const
+{
+    LOCK(m_mutex);
+    return m_rejected;
+}
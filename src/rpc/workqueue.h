@@ -0,0 +1,118 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_RPC_WORKQUEUE_H
+#define BITCOIN_RPC_WORKQUEUE_H
+
+#include "sync.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+//! Default for -rpcworkqueue: maximum number of requests waiting for a thread.
+static constexpr size_t DEFAULT_RPC_WORK_QUEUE = 256;
+
+//! Default for -rpcservertimeout: seconds before an idle connection closes.
+static constexpr int DEFAULT_RPC_SERVER_TIMEOUT = 30;
+
+//!
+//! \brief Bounded queue of RPC requests serviced by the RPC worker threads.
+//!
+//! The network thread parses requests and places them in the queue. When the
+//! queue holds the maximum number of waiting requests, it rejects new ones so
+//! that the server can reply immediately instead of accumulating a backlog.
+//!
+//! A method may have a concurrency limit. The workers skip over the queued
+//! requests for a method that already runs on the limit's number of threads,
+//! so one expensive method cannot occupy every worker.
+//!
+class RPCWorkQueue
+{
+public:
+    typedef std::function<void()> WorkItem;
+
+    //!
+    //! \brief Initialize an empty queue.
+    //!
+    //! \param max_depth     Number of waiting requests that the queue accepts.
+    //! \param method_limits Maximum number of concurrent calls by method name.
+    //!
+    RPCWorkQueue(const size_t max_depth, std::map<std::string, size_t> method_limits = {});
+
+    //!
+    //! \brief Parse method concurrency limits in the format of -rpcmethodlimit.
+    //!
+    //! \param args Entries formatted as <method>:<n>. Skips malformed entries.
+    //!
+    static std::map<std::string, size_t> ParseMethodLimits(const std::vector<std::string>& args);
+
+    //!
+    //! \brief Add a request to the queue.
+    //!
+    //! \param method  Name of the RPC method that the request calls. Batches
+    //!                and other requests without a single method pass an empty
+    //!                name.
+    //! \param item    Executes the request and sends the reply.
+    //! \param reserve Number of slots to leave free for other requests. Work
+    //!                that is optional, like the helpers of a batch, passes a
+    //!                non-zero value and does not count as rejected.
+    //!
+    //! \return \c false if the queue is full or stopped.
+    //!
+    bool Enqueue(std::string method, WorkItem item, size_t reserve = 0);
+
+    //!
+    //! \brief Get the number of waiting requests that the queue accepts.
+    //!
+    size_t GetMaxDepth() const { return m_max_depth; }
+
+    //!
+    //! \brief Service the queue on the calling thread until interrupted.
+    //!
+    void Run();
+
+    //!
+    //! \brief Stop the threads that service the queue and discard the waiting
+    //! requests.
+    //!
+    void Interrupt();
+
+    //!
+    //! \brief Get the number of requests that wait for a thread.
+    //!
+    size_t GetDepth() const;
+
+    //!
+    //! \brief Get the number of requests rejected because the queue was full.
+    //!
+    uint64_t GetRejectedCount() const;
+
+private:
+    struct Job
+    {
+        std::string m_method;
+        WorkItem m_item;
+    };
+
+    const size_t m_max_depth;
+    const std::map<std::string, size_t> m_method_limits;
+
+    mutable Mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<Job> m_queue GUARDED_BY(m_mutex);
+    std::map<std::string, size_t> m_running GUARDED_BY(m_mutex);
+    uint64_t m_rejected GUARDED_BY(m_mutex) = 0;
+    bool m_interrupted GUARDED_BY(m_mutex) = false;
+
+    //!
+    //! \brief Find the first queued request that a thread may start now.
+    //!
+    std::deque<Job>::iterator FindRunnable() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+};
+
+#endif // BITCOIN_RPC_WORKQUEUE_H
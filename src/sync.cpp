@@ -7,8 +7,13 @@
 #include <util/threadnames.h>
 
 #include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
 #include <set>
 #include <memory>
+#include <tuple>
+#include <unordered_map>
 
 #ifdef DEBUG_LOCKCONTENTION
 #if !defined(HAVE_THREAD_LOCAL)
@@ -21,6 +26,223 @@ void PrintLockContention(const char* pszName, const char* pszFile, int nLine)
 }
 #endif /* DEBUG_LOCKCONTENTION */
 
+//
+// Lock contention profiler.
+//
+// Each thread owns a table of counters per lock site. The owner updates it
+// under the table's mutex, which only contends with a reader that merges the
+// tables. A lock object keeps a pointer to its counters so that the release
+// does not look the site up again. Tables are never freed: the counters of a
+// thread that exited remain part of the statistics, and a lock taken by a
+// static destructor after the thread-local storage of the main thread is gone
+// still finds a valid table.
+//
+
+std::atomic<bool> g_lock_profiling{false};
+
+struct LockSiteCounters {
+    std::mutex* table_mutex;
+    const char* name;
+    const char* file;
+    int line;
+    uint64_t acquisitions = 0;
+    uint64_t contended = 0;
+    uint64_t try_failures = 0;
+    int64_t total_wait_ns = 0;
+    int64_t max_wait_ns = 0;
+    int64_t total_hold_ns = 0;
+    int64_t max_hold_ns = 0;
+};
+
+namespace {
+struct LockSiteKey {
+    const char* name;
+    const char* file;
+    int line;
+
+    bool operator==(const LockSiteKey& other) const
+    {
+        return name == other.name && file == other.file && line == other.line;
+    }
+};
+
+struct LockSiteKeyHasher {
+    size_t operator()(const LockSiteKey& key) const
+    {
+        return std::hash<const void*>()(key.file) ^ (std::hash<const void*>()(key.name) << 1) ^ key.line;
+    }
+};
+
+struct ThreadLockTable {
+    std::mutex mutex;
+    std::unordered_map<LockSiteKey, LockSiteCounters, LockSiteKeyHasher> sites;
+};
+
+std::mutex& LockTablesMutex()
+{
+    static std::mutex* mutex = new std::mutex();
+    return *mutex;
+}
+
+std::vector<ThreadLockTable*>& LockTables()
+{
+    static std::vector<ThreadLockTable*>* tables = new std::vector<ThreadLockTable*>();
+    return *tables;
+}
+
+ThreadLockTable& GetThreadLockTable()
+{
+    thread_local ThreadLockTable* table = nullptr;
+
+    if (!table) {
+        table = new ThreadLockTable();
+
+        std::lock_guard<std::mutex> lock(LockTablesMutex());
+        LockTables().push_back(table);
+    }
+
+    return *table;
+}
+
+LockSiteCounters& GetLockSiteCounters(ThreadLockTable& table, const char* pszName, const char* pszFile, int nLine)
+{
+    auto it = table.sites.find(LockSiteKey{pszName, pszFile, nLine});
+
+    if (it == table.sites.end()) {
+        LockSiteCounters counters;
+        counters.table_mutex = &table.mutex;
+        counters.name = pszName;
+        counters.file = pszFile;
+        counters.line = nLine;
+
+        it = table.sites.emplace(LockSiteKey{pszName, pszFile, nLine}, counters).first;
+    }
+
+    return it->second;
+}
+} // namespace
+
+int64_t LockProfilerNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+LockSiteCounters* RecordLockAcquired(const char* pszName, const char* pszFile, int nLine, int64_t wait_ns, bool contended)
+{
+    ThreadLockTable& table = GetThreadLockTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    LockSiteCounters& counters = GetLockSiteCounters(table, pszName, pszFile, nLine);
+
+    ++counters.acquisitions;
+    counters.contended += contended;
+    counters.total_wait_ns += wait_ns;
+    counters.max_wait_ns = std::max(counters.max_wait_ns, wait_ns);
+
+    return &counters;
+}
+
+void RecordLockReleased(LockSiteCounters* counters, int64_t hold_ns)
+{
+    std::lock_guard<std::mutex> lock(*counters->table_mutex);
+
+    counters->total_hold_ns += hold_ns;
+    counters->max_hold_ns = std::max(counters->max_hold_ns, hold_ns);
+}
+
+void RecordLockTryFailed(const char* pszName, const char* pszFile, int nLine)
+{
+    ThreadLockTable& table = GetThreadLockTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    ++GetLockSiteCounters(table, pszName, pszFile, nLine).try_failures;
+}
+
+std::vector<LockSiteStats> GetLockStats()
+{
+    // Sites in different translation units may share a file and line with
+    // different string literal addresses, so merge by value:
+    std::map<std::tuple<std::string, std::string, int>, LockSiteStats> merged;
+
+    {
+        std::lock_guard<std::mutex> tables_lock(LockTablesMutex());
+
+        for (ThreadLockTable* table : LockTables()) {
+            std::lock_guard<std::mutex> lock(table->mutex);
+
+            for (const auto& entry : table->sites) {
+                const LockSiteCounters& counters = entry.second;
+                LockSiteStats& stats = merged[std::make_tuple(counters.file, counters.name, counters.line)];
+
+                stats.acquisitions += counters.acquisitions;
+                stats.contended += counters.contended;
+                stats.try_failures += counters.try_failures;
+                stats.total_wait_ns += counters.total_wait_ns;
+                stats.max_wait_ns = std::max(stats.max_wait_ns, counters.max_wait_ns);
+                stats.total_hold_ns += counters.total_hold_ns;
+                stats.max_hold_ns = std::max(stats.max_hold_ns, counters.max_hold_ns);
+            }
+        }
+    }
+
+    std::vector<LockSiteStats> result;
+    result.reserve(merged.size());
+
+    for (auto& entry : merged) {
+        LockSiteStats& stats = entry.second;
+        stats.file = std::get<0>(entry.first);
+        stats.name = std::get<1>(entry.first);
+        stats.line = std::get<2>(entry.first);
+
+        result.push_back(std::move(stats));
+    }
+
+    return result;
+}
+
+void ResetLockStats()
+{
+    std::lock_guard<std::mutex> tables_lock(LockTablesMutex());
+
+    for (ThreadLockTable* table : LockTables()) {
+        std::lock_guard<std::mutex> lock(table->mutex);
+
+        // Keep the entries: lock objects may point to them.
+        for (auto& entry : table->sites) {
+            LockSiteCounters& counters = entry.second;
+
+            counters.acquisitions = 0;
+            counters.contended = 0;
+            counters.try_failures = 0;
+            counters.total_wait_ns = 0;
+            counters.max_wait_ns = 0;
+            counters.total_hold_ns = 0;
+            counters.max_hold_ns = 0;
+        }
+    }
+}
+
+void LogLockStats(size_t max_sites)
+{
+    std::vector<LockSiteStats> stats = GetLockStats();
+
+    std::sort(stats.begin(), stats.end(), [](const LockSiteStats& a, const LockSiteStats& b) {
+        return a.total_wait_ns > b.total_wait_ns;
+    });
+
+    LogPrintf("Lock contention: %u sites, top %u by total wait:", stats.size(), std::min(max_sites, stats.size()));
+
+    for (size_t i = 0; i < stats.size() && i < max_sites; ++i) {
+        const LockSiteStats& site = stats[i];
+
+        LogPrintf("  %s at %s:%d: %u acquired, %u contended, wait %.3f ms (max %.3f ms),"
+                  " hold %.3f ms (max %.3f ms)",
+                  site.name, site.file, site.line, site.acquisitions, site.contended,
+                  site.total_wait_ns / 1e6, site.max_wait_ns / 1e6,
+                  site.total_hold_ns / 1e6, site.max_hold_ns / 1e6);
+    }
+}
+
 #ifdef DEBUG_LOCKORDER
 //
 // Early deadlock detection.
@@ -0,0 +1,184 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "index/addressindex.h"
+#include "key.h"
+#include "main.h"
+#include "script.h"
+#include "txdb.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+CScript GetPayToKeyHash(const CKey& key)
+{
+    CScript script;
+    script.SetDestination(key.GetPubKey().GetID());
+
+    return script;
+}
+
+CScript GetPayToKey(const CKey& key)
+{
+    CScript script;
+    script << key.GetPubKey() << OP_CHECKSIG;
+
+    return script;
+}
+
+CKey MakeKey()
+{
+    CKey key;
+    key.MakeNewKey(true);
+
+    return key;
+}
+
+std::vector<AddressHistoryEntry> ReadHistory(CTxDB& txdb, const AddressKey& address, const int start_height = 0)
+{
+    std::vector<AddressHistoryEntry> entries;
+
+    GetAddressIndex().ReadHistory(txdb, address, start_height, [&](const AddressHistoryEntry& entry) {
+        entries.push_back(entry);
+        return true;
+    });
+
+    return entries;
+}
+
+std::vector<AddressUnspentEntry> ReadUnspent(CTxDB& txdb, const AddressKey& address)
+{
+    std::vector<AddressUnspentEntry> entries;
+
+    GetAddressIndex().ReadUnspent(txdb, address, [&](const AddressUnspentEntry& entry) {
+        entries.push_back(entry);
+        return true;
+    });
+
+    return entries;
+}
+} // Anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(addressindex_tests)
+
+BOOST_AUTO_TEST_CASE(it_maps_scripts_to_address_keys)
+{
+    const CKey key = MakeKey();
+    const AddressKey by_hash = AddressKey::FromScript(GetPayToKeyHash(key));
+
+    BOOST_CHECK(by_hash.m_type == AddressKey::Type::PUBKEY_HASH);
+    BOOST_CHECK(by_hash.m_hash == uint160(key.GetPubKey().GetID()));
+
+    // A pay-to-pubkey coinstake output belongs to the same address:
+    BOOST_CHECK(AddressKey::FromScript(GetPayToKey(key)) == by_hash);
+
+    CScript p2sh;
+    p2sh.SetDestination(CScriptID(GetPayToKey(key)));
+    BOOST_CHECK(AddressKey::FromScript(p2sh).m_type == AddressKey::Type::SCRIPT_HASH);
+
+    CScript multisig;
+    multisig.SetMultisig(1, {key.GetPubKey(), MakeKey().GetPubKey()});
+    const AddressKey by_script = AddressKey::FromScript(multisig);
+    BOOST_CHECK(by_script.m_type == AddressKey::Type::SCRIPT);
+    BOOST_CHECK(by_script.m_hash == Hash160(multisig));
+
+    CScript op_return;
+    op_return << OP_RETURN;
+    BOOST_CHECK(AddressKey::FromScript(op_return).IsNull());
+    BOOST_CHECK(AddressKey::FromScript(CScript()).IsNull());
+}
+
+BOOST_AUTO_TEST_CASE(it_parses_addresses_and_scripts)
+{
+    const CKey key = MakeKey();
+    const AddressKey expected = AddressKey::FromScript(GetPayToKeyHash(key));
+
+    BOOST_CHECK(AddressKey::Parse(expected.ToString()) == expected);
+
+    const CScript script = GetPayToKey(key);
+    BOOST_CHECK(AddressKey::Parse(HexStr(script)) == expected);
+
+    BOOST_CHECK(AddressKey::Parse("").IsNull());
+    BOOST_CHECK(AddressKey::Parse("not an address").IsNull());
+}
+
+BOOST_AUTO_TEST_CASE(it_indexes_and_removes_a_block)
+{
+    const CKey key_a = MakeKey();
+    const CKey key_b = MakeKey();
+    const AddressKey address_a = AddressKey::FromScript(GetPayToKeyHash(key_a));
+    const AddressKey address_b = AddressKey::FromScript(GetPayToKeyHash(key_b));
+
+    // The second transaction spends the first output of the first one and
+    // pays to both addresses:
+    CBlock block;
+    block.vtx.resize(2);
+
+    block.vtx[0].vin.resize(1);
+    block.vtx[0].vin[0].prevout.SetNull();
+    block.vtx[0].vout.emplace_back(10 * COIN, GetPayToKeyHash(key_a));
+
+    block.vtx[1].vin.resize(1);
+    block.vtx[1].vin[0].prevout = COutPoint(block.vtx[0].GetHash(), 0);
+    block.vtx[1].vout.emplace_back(4 * COIN, GetPayToKeyHash(key_b));
+    block.vtx[1].vout.emplace_back(6 * COIN, GetPayToKey(key_a));
+
+    const std::vector<CTxOut> spent_outputs { block.vtx[0].vout[0] };
+
+    uint256 hash = uint256S("a");
+    CBlockIndex pindex;
+    pindex.nHeight = 500;
+    pindex.phashBlock = &hash;
+
+    const AddressIndex& index = GetAddressIndex();
+    CTxDB txdb;
+
+    BOOST_CHECK(index.WriteBlock(txdb, &pindex, block, spent_outputs));
+
+    const std::vector<AddressHistoryEntry> history_a = ReadHistory(txdb, address_a);
+
+    BOOST_REQUIRE_EQUAL(history_a.size(), 3U);
+    BOOST_CHECK(!history_a[0].m_spending);
+    BOOST_CHECK_EQUAL(history_a[0].m_amount, 10 * COIN);
+
+    // The outputs of a transaction sort before its inputs:
+    BOOST_CHECK(!history_a[1].m_spending);
+    BOOST_CHECK_EQUAL(history_a[1].m_index, 1U);
+    BOOST_CHECK_EQUAL(history_a[1].m_amount, 6 * COIN);
+    BOOST_CHECK_EQUAL(history_a[1].m_height, 500);
+    BOOST_CHECK(history_a[2].m_spending);
+    BOOST_CHECK_EQUAL(history_a[2].m_amount, -10 * COIN);
+    BOOST_CHECK(history_a[2].m_prevout == COutPoint(block.vtx[0].GetHash(), 0));
+
+    BOOST_CHECK(ReadHistory(txdb, address_a, 501).empty());
+
+    // The spent output of the first transaction is not unspent:
+    const std::vector<AddressUnspentEntry> unspent_a = ReadUnspent(txdb, address_a);
+
+    BOOST_REQUIRE_EQUAL(unspent_a.size(), 1U);
+    BOOST_CHECK(unspent_a[0].m_outpoint == COutPoint(block.vtx[1].GetHash(), 1));
+    BOOST_CHECK_EQUAL(unspent_a[0].m_amount, 6 * COIN);
+
+    BOOST_CHECK_EQUAL(ReadUnspent(txdb, address_b).size(), 1U);
+
+    const std::optional<SpentByEntry> spent = index.ReadSpentBy(txdb, COutPoint(block.vtx[0].GetHash(), 0));
+
+    BOOST_REQUIRE(spent.has_value());
+    BOOST_CHECK(spent->m_txid == block.vtx[1].GetHash());
+    BOOST_CHECK_EQUAL(spent->m_input, 0U);
+    BOOST_CHECK(spent->m_address == address_a);
+
+    {
+        LOCK(cs_main);
+        BOOST_CHECK(index.EraseBlock(txdb, &pindex, block));
+    }
+
+    BOOST_CHECK(ReadHistory(txdb, address_a).empty());
+    BOOST_CHECK(ReadHistory(txdb, address_b).empty());
+    BOOST_CHECK(ReadUnspent(txdb, address_a).empty());
+    BOOST_CHECK(ReadUnspent(txdb, address_b).empty());
+    BOOST_CHECK(!index.ReadSpentBy(txdb, COutPoint(block.vtx[0].GetHash(), 0)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
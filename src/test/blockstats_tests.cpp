@@ -0,0 +1,138 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "gridcoin/claim.h"
+#include "gridcoin/contract/contract.h"
+#include "index/blockstats.h"
+#include "main.h"
+#include "streams.h"
+#include "txdb.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+//!
+//! \brief Create a version 11 proof-of-stake block with a researcher claim.
+//!
+CBlock GetStakedBlock()
+{
+    CBlock block;
+    block.nVersion = 11;
+    block.vtx.resize(3);
+
+    block.vtx[0].vin.resize(1);
+    block.vtx[0].vin[0].prevout.SetNull();
+    block.vtx[0].vout.resize(1);
+
+    // A coinstake spends an output and leaves the first output empty:
+    block.vtx[1].vin.resize(1);
+    block.vtx[1].vin[0].prevout.hash = uint256S("1");
+    block.vtx[1].vout.resize(2);
+    block.vtx[1].vout[0].SetEmpty();
+    block.vtx[1].vout[1].nValue = 100 * COIN;
+
+    block.vtx[2].vin.resize(1);
+    block.vtx[2].vin[0].prevout.hash = uint256S("2");
+    block.vtx[2].vout.resize(1);
+
+    GRC::Claim claim(2);
+    claim.m_mining_id = GRC::Cpid::Parse("00010203040506070809101112131415");
+    claim.m_client_version = "v5.4.5.0";
+    claim.m_organization = "Example Org";
+    claim.m_block_subsidy = 10 * COIN;
+    claim.m_research_subsidy = 123 * COIN;
+
+    block.vtx[0].vContracts.emplace_back(GRC::MakeContract<GRC::Claim>(GRC::ContractAction::ADD, std::move(claim)));
+
+    return block;
+}
+} // Anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(blockstats_tests)
+
+BOOST_AUTO_TEST_CASE(it_summarizes_a_block)
+{
+    const CBlock block = GetStakedBlock();
+    const uint256 hash = uint256S("abc");
+
+    GRC::MintSummary mint;
+    mint.m_total = 133 * COIN;
+    mint.m_fees = COIN / 100;
+
+    const BlockStats stats = BlockStats::FromBlock(block, hash, mint);
+
+    BOOST_CHECK(stats.m_block_hash == hash);
+    BOOST_CHECK_EQUAL(stats.m_block_version, 11);
+    BOOST_CHECK_EQUAL(stats.m_tx_count, 3U);
+    BOOST_CHECK_EQUAL(stats.m_size, GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION));
+    BOOST_CHECK(stats.m_proof_of_stake);
+    BOOST_CHECK(!stats.m_has_superblock);
+    BOOST_CHECK_EQUAL(stats.m_mint, 133 * COIN);
+    BOOST_CHECK_EQUAL(stats.m_fees, COIN / 100);
+    BOOST_CHECK_EQUAL(stats.m_research_subsidy, 123 * COIN);
+    BOOST_CHECK_EQUAL(stats.m_block_subsidy, 10 * COIN);
+    BOOST_CHECK_EQUAL(stats.m_mining_id.ToString(), "00010203040506070809101112131415");
+    BOOST_CHECK_EQUAL(stats.m_organization, "Example Org");
+    BOOST_CHECK_EQUAL(stats.m_client_version, "v5.4.5.0");
+}
+
+BOOST_AUTO_TEST_CASE(it_round_trips_a_record_through_serialization)
+{
+    GRC::MintSummary mint;
+    mint.m_total = 42;
+
+    const BlockStats expected = BlockStats::FromBlock(GetStakedBlock(), uint256S("abc"), mint);
+
+    CDataStream stream(SER_DISK, CLIENT_VERSION);
+    stream << expected;
+
+    BlockStats stats;
+    stream >> stats;
+
+    BOOST_CHECK_EQUAL(stats.m_version, BlockStats::CURRENT_VERSION);
+    BOOST_CHECK(stats.m_block_hash == expected.m_block_hash);
+    BOOST_CHECK_EQUAL(stats.m_tx_count, expected.m_tx_count);
+    BOOST_CHECK_EQUAL(stats.m_size, expected.m_size);
+    BOOST_CHECK_EQUAL(stats.m_proof_of_stake, expected.m_proof_of_stake);
+    BOOST_CHECK_EQUAL(stats.m_mint, 42);
+    BOOST_CHECK_EQUAL(stats.m_research_subsidy, expected.m_research_subsidy);
+    BOOST_CHECK(stats.m_mining_id == expected.m_mining_id);
+    BOOST_CHECK_EQUAL(stats.m_organization, expected.m_organization);
+    BOOST_CHECK_EQUAL(stats.m_client_version, expected.m_client_version);
+    BOOST_CHECK(stats.m_quorum_hash == expected.m_quorum_hash);
+}
+
+BOOST_AUTO_TEST_CASE(it_ignores_records_of_other_blocks_at_the_same_height)
+{
+    const CBlock block = GetStakedBlock();
+    const BlockStatsIndex& index = GetBlockStatsIndex();
+
+    uint256 hash_a = uint256S("a");
+    uint256 hash_b = uint256S("b");
+
+    CBlockIndex pindex_a;
+    pindex_a.nHeight = 1000;
+    pindex_a.phashBlock = &hash_a;
+
+    CBlockIndex pindex_b;
+    pindex_b.nHeight = 1000;
+    pindex_b.phashBlock = &hash_b;
+
+    CTxDB txdb;
+    BlockStats stats;
+
+    BOOST_CHECK(!index.ReadBlock(txdb, &pindex_a, stats));
+    BOOST_CHECK(index.WriteBlock(txdb, &pindex_a, block, GRC::MintSummary()));
+
+    BOOST_CHECK(index.ReadBlock(txdb, &pindex_a, stats));
+    BOOST_CHECK(stats.m_block_hash == hash_a);
+
+    // A reorganization replaced the block at this height:
+    BOOST_CHECK(!index.ReadBlock(txdb, &pindex_b, stats));
+
+    BOOST_CHECK(index.EraseBlock(txdb, &pindex_a));
+    BOOST_CHECK(!index.ReadBlock(txdb, &pindex_a, stats));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,391 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "chainparams.h"
+#include "clientversion.h"
+#include "consensus/merkle.h"
+#include "index/disktxpos.h"
+#include "main.h"
+#include "node/blockstorage.h"
+#include "streams.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+//! Block file for the legacy test blocks, far from the files of the node.
+constexpr unsigned int LEGACY_TEST_FILE = 2000;
+
+//!
+//! \brief Make a block with a coinstake and a payment to many outputs of the
+//! same script, which compresses well.
+//!
+CBlock MakeBlock(const int height, const size_t outputs)
+{
+    CBlock block;
+    block.nVersion = 11;
+    block.nTime = 1700000000 + height;
+
+    CTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].prevout.SetNull();
+    coinbase.vin[0].scriptSig = CScript() << height;
+    coinbase.vout.resize(1);
+    coinbase.vout[0].SetEmpty();
+    block.vtx.push_back(coinbase);
+
+    CTransaction coinstake;
+    coinstake.vin.emplace_back(COutPoint(uint256S("a"), height));
+    coinstake.vout.resize(1);
+    coinstake.vout[0].SetEmpty();
+    coinstake.vout.emplace_back(10 * COIN, CScript() << OP_TRUE);
+    block.vtx.push_back(coinstake);
+
+    CTransaction payment;
+    payment.vin.emplace_back(COutPoint(uint256S("b"), height));
+
+    for (size_t i = 0; i < outputs; ++i) {
+        payment.vout.emplace_back(COIN, CScript() << OP_DUP << OP_HASH160 << std::vector<unsigned char>(20, 1));
+    }
+
+    block.vtx.push_back(payment);
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+
+    return block;
+}
+
+//!
+//! \brief Get the transaction index position of the last transaction in a
+//! block the way that ConnectBlock() does.
+//!
+CDiskTxPos GetLastTxPos(const CBlock& block, const unsigned int file, const unsigned int block_pos)
+{
+    unsigned int tx_pos = block_pos
+        + ::GetSerializeSize<CBlockHeader>(block, SER_DISK, CLIENT_VERSION)
+        + GetSizeOfCompactSize(block.vtx.size());
+
+    for (size_t i = 0; i + 1 < block.vtx.size(); ++i) {
+        tx_pos += ::GetSerializeSize(block.vtx[i], SER_DISK, CLIENT_VERSION);
+    }
+
+    return CDiskTxPos(file, block_pos, tx_pos);
+}
+
+void CheckReadableAt(const CBlock& expected, const unsigned int file, const unsigned int block_pos)
+{
+    CBlock block;
+    BOOST_CHECK(ReadBlockFromDisk(block, file, block_pos, Params().GetConsensus()));
+    BOOST_CHECK(block.GetHash(true) == expected.GetHash(true));
+    BOOST_CHECK_EQUAL(block.vtx.size(), expected.vtx.size());
+
+    CBlock header;
+    BOOST_CHECK(ReadBlockFromDisk(header, file, block_pos, Params().GetConsensus(), false));
+    BOOST_CHECK(header.GetHash(true) == expected.GetHash(true));
+
+    CTransaction tx;
+    CBlockHeader tx_header;
+    BOOST_CHECK(ReadTxFromDisk(tx, GetLastTxPos(expected, file, block_pos), &tx_header));
+    BOOST_CHECK(tx.GetHash() == expected.vtx.back().GetHash());
+    BOOST_CHECK(tx_header.GetHash(true) == expected.GetHash(true));
+}
+
+//!
+//! \brief Write a legacy block record: the message start, the size, and the
+//! serialized block.
+//!
+void WriteLegacyRecord(CAutoFile& fileout, const CBlock& block)
+{
+    fileout << Params().MessageStart() << (unsigned int) GetSerializeSize(fileout, block) << block;
+}
+
+//!
+//! \brief Open a file for the block file reader tests in the data directory.
+//!
+CAutoFile OpenImportFile(const char* mode)
+{
+    return CAutoFile(fsbridge::fopen(GetDataDir() / "import_test.dat", mode), SER_DISK, CLIENT_VERSION);
+}
+
+//!
+//! \brief Read every block from the import test file with the block file
+//! reader.
+//!
+std::vector<CBlock> ReadImportFile()
+{
+    CAutoFile filein = OpenImportFile("rb");
+    BOOST_REQUIRE(!filein.IsNull());
+
+    BlockFileReader reader(filein.Get());
+    std::vector<CBlock> blocks;
+    uint64_t pos = 0;
+    std::vector<unsigned char> data;
+
+    while (reader.Next(pos, data)) {
+        CDataStream stream(MakeByteSpan(data), SER_DISK, CLIENT_VERSION);
+        stream >> blocks.emplace_back();
+    }
+
+    return blocks;
+}
+
+//!
+//! \brief Read every valid block from the import test file in import windows.
+//!
+std::vector<CBlock> ReadImportFileWindows(const size_t threads)
+{
+    CAutoFile filein = OpenImportFile("rb");
+    BOOST_REQUIRE(!filein.IsNull());
+
+    BlockFileReader reader(filein.Get());
+    std::vector<CBlock> blocks;
+
+    for (auto window = ReadImportWindow(reader, threads); !window.empty(); window = ReadImportWindow(reader, threads)) {
+        for (const auto& item : window) {
+            if (item.m_valid) {
+                blocks.push_back(item.m_block);
+            }
+        }
+    }
+
+    return blocks;
+}
+
+void CheckSameBlocks(const std::vector<CBlock>& blocks, const std::vector<CBlock>& expected)
+{
+    BOOST_REQUIRE_EQUAL(blocks.size(), expected.size());
+
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        BOOST_CHECK(blocks[i].GetHash(true) == expected[i].GetHash(true));
+    }
+}
+} // Anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(blockstorage_tests)
+
+BOOST_AUTO_TEST_CASE(it_writes_and_reads_framed_blocks)
+{
+    LOCK(cs_main);
+
+    for (const bool compress : { true, false }) {
+        fCompressBlocks = compress;
+
+        const CBlock block = MakeBlock(compress ? 1 : 2, 200);
+        unsigned int file = 0;
+        unsigned int block_pos = 0;
+
+        BOOST_REQUIRE(WriteBlockToDisk(block, file, block_pos, Params().MessageStart()));
+        BOOST_CHECK_EQUAL(GetBlockFileVersion(file), BLOCK_FILE_VERSION);
+
+        CheckReadableAt(block, file, block_pos);
+    }
+
+    fCompressBlocks = DEFAULT_COMPRESS_BLOCKS;
+}
+
+BOOST_AUTO_TEST_CASE(it_detects_corrupt_blocks)
+{
+    LOCK(cs_main);
+
+    const CBlock block = MakeBlock(3, 200);
+    unsigned int file = 0;
+    unsigned int block_pos = 0;
+
+    BOOST_REQUIRE(WriteBlockToDisk(block, file, block_pos, Params().MessageStart()));
+
+    {
+        CAutoFile fileout(OpenBlockFile(file, 0, "rb+"), SER_DISK, CLIENT_VERSION);
+        BOOST_REQUIRE(!fileout.IsNull());
+        BOOST_REQUIRE(fseek(fileout.Get(), block_pos + 10, SEEK_SET) == 0);
+
+        const unsigned char byte = fgetc(fileout.Get()) ^ 0xff;
+
+        BOOST_REQUIRE(fseek(fileout.Get(), block_pos + 10, SEEK_SET) == 0);
+        BOOST_REQUIRE(fputc(byte, fileout.Get()) != EOF);
+    }
+
+    CBlock read_block;
+    BOOST_CHECK(!ReadBlockFromDisk(read_block, file, block_pos, Params().GetConsensus()));
+}
+
+BOOST_AUTO_TEST_CASE(it_reuses_decompressed_blocks_until_the_file_is_forgotten)
+{
+    LOCK(cs_main);
+
+    fCompressBlocks = true;
+
+    const CBlock block = MakeBlock(4, 200);
+    unsigned int file = 0;
+    unsigned int block_pos = 0;
+
+    BOOST_REQUIRE(WriteBlockToDisk(block, file, block_pos, Params().MessageStart()));
+
+    fCompressBlocks = DEFAULT_COMPRESS_BLOCKS;
+
+    const CDiskTxPos tx_pos = GetLastTxPos(block, file, block_pos);
+    CTransaction tx;
+
+    BOOST_REQUIRE(ReadTxFromDisk(tx, tx_pos, nullptr));
+
+    {
+        CAutoFile fileout(OpenBlockFile(file, 0, "rb+"), SER_DISK, CLIENT_VERSION);
+        BOOST_REQUIRE(!fileout.IsNull());
+        BOOST_REQUIRE(fseek(fileout.Get(), block_pos + 10, SEEK_SET) == 0);
+
+        const unsigned char byte = fgetc(fileout.Get()) ^ 0xff;
+
+        BOOST_REQUIRE(fseek(fileout.Get(), block_pos + 10, SEEK_SET) == 0);
+        BOOST_REQUIRE(fputc(byte, fileout.Get()) != EOF);
+    }
+
+    // The next reads of the block use the decompressed copy:
+    CBlock read_block;
+    BOOST_CHECK(ReadTxFromDisk(tx, tx_pos, nullptr));
+    BOOST_CHECK(tx.GetHash() == block.vtx.back().GetHash());
+    BOOST_CHECK(ReadBlockFromDisk(read_block, file, block_pos, Params().GetConsensus()));
+    BOOST_CHECK(read_block.GetHash(true) == block.GetHash(true));
+
+    // Until the file is forgotten:
+    ForgetBlockFile(file);
+    BOOST_CHECK(!ReadTxFromDisk(tx, tx_pos, nullptr));
+    BOOST_CHECK(!ReadBlockFromDisk(read_block, file, block_pos, Params().GetConsensus()));
+}
+
+BOOST_AUTO_TEST_CASE(it_converts_legacy_block_files)
+{
+    LOCK(cs_main);
+
+    std::vector<CBlock> blocks;
+    std::vector<unsigned int> positions;
+
+    {
+        CAutoFile fileout(OpenBlockFile(LEGACY_TEST_FILE, 0, "ab"), SER_DISK, CLIENT_VERSION);
+        BOOST_REQUIRE(!fileout.IsNull());
+
+        for (int height = 10; height < 13; ++height) {
+            blocks.push_back(MakeBlock(height, 100));
+
+            fileout << Params().MessageStart() << (unsigned int) GetSerializeSize(fileout, blocks.back());
+            positions.push_back(ftell(fileout.Get()));
+            fileout << blocks.back();
+        }
+    }
+
+    BOOST_CHECK_EQUAL(GetBlockFileVersion(LEGACY_TEST_FILE), BLOCK_FILE_VERSION_LEGACY);
+
+    const auto legacy_size = fs::file_size(BlockFilePath(LEGACY_TEST_FILE));
+
+    BOOST_REQUIRE(ConvertBlockFile(LEGACY_TEST_FILE));
+    BOOST_CHECK_EQUAL(GetBlockFileVersion(LEGACY_TEST_FILE), BLOCK_FILE_VERSION);
+    BOOST_CHECK(IsConvertedBlockFile(LEGACY_TEST_FILE));
+    BOOST_CHECK(fs::file_size(BlockFilePath(LEGACY_TEST_FILE)) < legacy_size);
+
+    // The block index and the transaction index keep the legacy positions:
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        CheckReadableAt(blocks[i], LEGACY_TEST_FILE, positions[i]);
+    }
+
+    // A reader that starts without the cached format finds the position table:
+    ForgetBlockFile(LEGACY_TEST_FILE);
+    CheckReadableAt(blocks[1], LEGACY_TEST_FILE, positions[1]);
+
+    CBlock block;
+    BOOST_CHECK(!ReadBlockFromDisk(block, LEGACY_TEST_FILE, positions[1] + 1, Params().GetConsensus()));
+}
+
+BOOST_AUTO_TEST_CASE(it_finds_a_message_start_split_across_reads)
+{
+    const std::vector<CBlock> expected { MakeBlock(20, 10), MakeBlock(21, 10) };
+
+    {
+        CAutoFile fileout = OpenImportFile("wb");
+        BOOST_REQUIRE(!fileout.IsNull());
+
+        // The reader reads 8 MiB at a time. Split the first message start
+        // across the first two reads:
+        const std::vector<unsigned char> padding((8 << 20) - 2, 0);
+        BOOST_REQUIRE(fwrite(padding.data(), 1, padding.size(), fileout.Get()) == padding.size());
+
+        for (const auto& block : expected) {
+            WriteLegacyRecord(fileout, block);
+        }
+    }
+
+    CheckSameBlocks(ReadImportFile(), expected);
+}
+
+BOOST_AUTO_TEST_CASE(it_stops_at_a_truncated_final_record)
+{
+    const std::vector<CBlock> expected { MakeBlock(22, 10), MakeBlock(23, 10) };
+
+    {
+        CAutoFile fileout = OpenImportFile("wb");
+        BOOST_REQUIRE(!fileout.IsNull());
+
+        for (const auto& block : expected) {
+            WriteLegacyRecord(fileout, block);
+        }
+
+        // The size of the last record runs past the end of the file:
+        fileout << Params().MessageStart() << (unsigned int) 1000;
+        fileout.write(MakeByteSpan(std::vector<unsigned char>(10, 0xff)));
+    }
+
+    CheckSameBlocks(ReadImportFile(), expected);
+    CheckSameBlocks(ReadImportFileWindows(2), expected);
+}
+
+BOOST_AUTO_TEST_CASE(it_resyncs_after_a_corrupt_record_size)
+{
+    const std::vector<CBlock> expected { MakeBlock(24, 10), MakeBlock(25, 10), MakeBlock(26, 10), MakeBlock(27, 10) };
+
+    {
+        CAutoFile fileout = OpenImportFile("wb");
+        BOOST_REQUIRE(!fileout.IsNull());
+
+        // A size larger than any block:
+        fileout << Params().MessageStart() << (unsigned int) (MAX_BLOCK_SIZE + 1);
+        WriteLegacyRecord(fileout, expected[0]);
+
+        // A size that swallows the next record after data that does not
+        // deserialize:
+        const std::vector<unsigned char> junk(100, 0xff);
+        fileout << Params().MessageStart() << (unsigned int) (junk.size() + 200);
+        fileout.write(MakeByteSpan(junk));
+        WriteLegacyRecord(fileout, expected[1]);
+
+        // A size that swallows the next record after a whole block:
+        fileout << Params().MessageStart()
+                << (unsigned int) (GetSerializeSize(fileout, expected[2]) + 200)
+                << expected[2];
+        WriteLegacyRecord(fileout, expected[3]);
+
+        // A size that runs past the end of the file before the last block:
+        fileout << Params().MessageStart() << (unsigned int) MAX_BLOCK_SIZE;
+        WriteLegacyRecord(fileout, MakeBlock(28, 10));
+    }
+
+    std::vector<CBlock> with_last = expected;
+    with_last.push_back(MakeBlock(28, 10));
+
+    CheckSameBlocks(ReadImportFileWindows(1), with_last);
+    CheckSameBlocks(ReadImportFileWindows(4), with_last);
+}
+
+BOOST_AUTO_TEST_CASE(it_imports_blocks_out_of_order)
+{
+    std::vector<CBlock> expected;
+
+    {
+        CAutoFile fileout = OpenImportFile("wb");
+        BOOST_REQUIRE(!fileout.IsNull());
+
+        for (int height = 40; height > 30; --height) {
+            expected.push_back(MakeBlock(height, 10));
+            WriteLegacyRecord(fileout, expected.back());
+        }
+    }
+
+    CheckSameBlocks(ReadImportFileWindows(2), expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,163 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "hash.h"
+#include "main.h"
+#include "txdb.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+constexpr int REORG_DEPTH = 500;
+constexpr int TXS_PER_BLOCK = 4;
+
+//!
+//! \brief Get a unique transaction hash for a position in a test chain.
+//!
+uint256 GetTxHash(const std::string& chain, const int height, const int n)
+{
+    return (CHashWriter(SER_GETHASH, 0) << chain << height << n).GetHash();
+}
+
+bool EraseTx(CTxDB& txdb, const uint256& hash)
+{
+    return txdb.EraseGenericSerializable(std::make_pair(std::string("tx"), hash));
+}
+
+//!
+//! \brief Index the transactions of a block like ConnectBlock(): add an entry
+//! for each transaction and mark the output that it spends in the entry of
+//! the previous block's transaction.
+//!
+void ConnectTestBlock(CTxDB& txdb, const std::string& chain, const int height, const std::string& prev_chain)
+{
+    for (int n = 0; n < TXS_PER_BLOCK; ++n) {
+        const CDiskTxPos pos(1, height, n);
+
+        if (height > 0) {
+            CTxIndex prev;
+            BOOST_REQUIRE(txdb.ReadTxIndex(GetTxHash(prev_chain, height - 1, n), prev));
+            BOOST_REQUIRE(prev.vSpent[0].IsNull());
+
+            prev.vSpent[0] = pos;
+            BOOST_REQUIRE(txdb.UpdateTxIndex(GetTxHash(prev_chain, height - 1, n), prev));
+        }
+
+        BOOST_REQUIRE(txdb.UpdateTxIndex(GetTxHash(chain, height, n), CTxIndex(pos, 1)));
+    }
+}
+
+//!
+//! \brief Remove the transactions of a block from the index like
+//! DisconnectBlock(): unmark the spent outputs and erase the entries.
+//!
+void DisconnectTestBlock(CTxDB& txdb, const std::string& chain, const int height)
+{
+    for (int n = 0; n < TXS_PER_BLOCK; ++n) {
+        CTxIndex txindex;
+        BOOST_REQUIRE(txdb.ReadTxIndex(GetTxHash(chain, height, n), txindex));
+        BOOST_REQUIRE(txindex.vSpent[0].IsNull());
+
+        if (height > 0) {
+            CTxIndex prev;
+            BOOST_REQUIRE(txdb.ReadTxIndex(GetTxHash(chain, height - 1, n), prev));
+            BOOST_REQUIRE(prev.vSpent[0] == txindex.pos);
+
+            prev.vSpent[0].SetNull();
+            BOOST_REQUIRE(txdb.UpdateTxIndex(GetTxHash(chain, height - 1, n), prev));
+        }
+
+        BOOST_REQUIRE(EraseTx(txdb, GetTxHash(chain, height, n)));
+    }
+}
+} // Anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(dbwrapper_tests)
+
+BOOST_AUTO_TEST_CASE(it_reads_its_own_writes_in_a_batch)
+{
+    CTxDB txdb;
+    const uint256 hash = GetTxHash("batch", 0, 0);
+    const CTxIndex stored(CDiskTxPos(1, 2, 3), 1);
+    const CTxIndex updated(CDiskTxPos(4, 5, 6), 2);
+    CTxIndex txindex;
+
+    BOOST_CHECK(txdb.UpdateTxIndex(hash, stored));
+
+    BOOST_CHECK(txdb.TxnBegin());
+    BOOST_CHECK(txdb.ReadTxIndex(hash, txindex));
+    BOOST_CHECK(txindex == stored);
+
+    // Writes and deletes in the batch shadow the database:
+    BOOST_CHECK(txdb.UpdateTxIndex(hash, updated));
+    BOOST_CHECK(txdb.ReadTxIndex(hash, txindex));
+    BOOST_CHECK(txindex == updated);
+
+    BOOST_CHECK(EraseTx(txdb, hash));
+    BOOST_CHECK(!txdb.ReadTxIndex(hash, txindex));
+    BOOST_CHECK(!txdb.ContainsTx(hash));
+
+    BOOST_CHECK(txdb.UpdateTxIndex(hash, updated));
+    BOOST_CHECK(txdb.ContainsTx(hash));
+
+    // Aborting discards the batch:
+    BOOST_CHECK(txdb.TxnAbort());
+    BOOST_CHECK(txdb.ReadTxIndex(hash, txindex));
+    BOOST_CHECK(txindex == stored);
+
+    // A new batch starts empty:
+    BOOST_CHECK(txdb.TxnBegin());
+    BOOST_CHECK(txdb.ReadTxIndex(hash, txindex));
+    BOOST_CHECK(txindex == stored);
+
+    BOOST_CHECK(EraseTx(txdb, hash));
+    BOOST_CHECK(txdb.TxnCommit());
+    BOOST_CHECK(!txdb.ReadTxIndex(hash, txindex));
+    BOOST_CHECK(!txdb.ContainsTx(hash));
+}
+
+BOOST_AUTO_TEST_CASE(it_reorganizes_500_blocks_in_one_batch)
+{
+    CTxDB txdb;
+
+    for (int height = 0; height < REORG_DEPTH; ++height) {
+        ConnectTestBlock(txdb, "old", height, "old");
+    }
+
+    // Replace every block above the first one with a block of the new chain
+    // in a single transaction like ReorganizeChain():
+    BOOST_REQUIRE(txdb.TxnBegin());
+
+    for (int height = REORG_DEPTH - 1; height > 0; --height) {
+        DisconnectTestBlock(txdb, "old", height);
+    }
+
+    for (int height = 1; height <= REORG_DEPTH; ++height) {
+        ConnectTestBlock(txdb, "new", height, height == 1 ? "old" : "new");
+    }
+
+    const auto check_reorganized = [&]() {
+        CTxIndex txindex;
+
+        for (int n = 0; n < TXS_PER_BLOCK; ++n) {
+            BOOST_CHECK(txdb.ReadTxIndex(GetTxHash("old", 0, n), txindex));
+            BOOST_CHECK(txindex.vSpent[0] == CDiskTxPos(1, 1, n));
+
+            for (int height = 1; height < REORG_DEPTH; ++height) {
+                BOOST_CHECK(!txdb.ContainsTx(GetTxHash("old", height, n)));
+                BOOST_CHECK(txdb.ReadTxIndex(GetTxHash("new", height, n), txindex));
+                BOOST_CHECK(txindex.vSpent[0] == CDiskTxPos(1, height + 1, n));
+            }
+
+            BOOST_CHECK(txdb.ReadTxIndex(GetTxHash("new", REORG_DEPTH, n), txindex));
+            BOOST_CHECK(txindex.vSpent[0].IsNull());
+        }
+    };
+
+    check_reorganized();
+    BOOST_CHECK(txdb.TxnCommit());
+    check_reorganized();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
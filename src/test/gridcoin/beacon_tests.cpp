@@ -847,6 +847,36 @@ public:
     size_t m_reinit_beacon_db_size = 0;
 };
 
+//!
+//! \brief The transaction, block and contract of a beacon advertisement for
+//! the registry tests.
+//!
+struct BeaconAdvertisement
+{
+    CTransaction m_tx;
+    CBlockIndex m_index;
+    GRC::Contract m_contract;
+
+    BeaconAdvertisement(const CPubKey& public_key, const GRC::Cpid& cpid, const int64_t time)
+    {
+        m_tx.nTime = time;
+
+        m_index.nVersion = 13;
+        m_index.nHeight = time;
+        m_index.nTime = time;
+
+        GRC::Beacon beacon {public_key, time, m_tx.GetHash()};
+        beacon.m_cpid = cpid;
+
+        m_contract = GRC::MakeContract<GRC::BeaconPayload>(3, GRC::ContractAction::ADD, GRC::BeaconPayload {2, cpid, beacon});
+    }
+
+    GRC::ContractContext Context() const
+    {
+        return GRC::ContractContext {m_contract, m_tx, &m_index};
+    }
+};
+
 } // anonymous namespace
 
 // -----------------------------------------------------------------------------
@@ -1319,6 +1349,7 @@ BOOST_AUTO_TEST_CASE(beacon_registry_GetBeaconChainletRoot_test)
     uint256 activated_beacon_hash = Hash(block2_phash, pending_beacons[0]->m_hash);
 
     BOOST_CHECK(registry.GetBeaconDB().size() == 2);
+    BOOST_CHECK(registry.FindPending(TestKey::Cpid()).empty());
 
     GRC::Beacon_ptr chainlet_head = registry.Try(TestKey::Cpid());
 
@@ -1416,6 +1447,9 @@ BOOST_AUTO_TEST_CASE(beacon_registry_GetBeaconChainletRoot_test)
 
         BOOST_CHECK(chainlet_root->m_hash == activated_beacon_hash);
         BOOST_CHECK_EQUAL(beacon_chain_out_ptr->size(), 3);
+
+        // The root recorded at renewal matches the walk:
+        BOOST_CHECK(registry.GetBeaconChainletRoot(chainlet_head)->m_hash == activated_beacon_hash);
     }
 
     // Let's corrupt the activation beacon to have a previous beacon hash that refers circularly back to the chain head...
@@ -1660,4 +1694,123 @@ BOOST_AUTO_TEST_CASE(beacon_registry_GetBeaconChainletRoot_test_2)
     }
 }
 
+BOOST_AUTO_TEST_CASE(beacon_registry_chainlet_root_record_test)
+{
+    FastRandomContext rng(uint256 {0});
+
+    GRC::BeaconRegistry& registry = GRC::GetBeaconRegistry();
+    registry.Reset();
+
+    const BeaconAdvertisement advertisement(TestKey::Public(), TestKey::Cpid(), 1);
+    registry.Add(advertisement.Context());
+
+    const uint256 superblock_hash = rng.rand256();
+    registry.ActivatePending({TestKey::KeyId()}, 2, superblock_hash, 2);
+
+    const uint256 activated_hash = Hash(superblock_hash, advertisement.m_tx.GetHash());
+
+    const BeaconAdvertisement renewal(TestKey::Public(), TestKey::Cpid(), 3);
+    const uint256 renewal_hash = renewal.m_tx.GetHash();
+    registry.Add(renewal.Context());
+
+    // The renewal records the root of its chainlet:
+    BOOST_CHECK(registry.GetRecordedChainletRoot(renewal_hash) == activated_hash);
+    BOOST_CHECK(registry.GetBeaconChainletRoot(registry.Try(TestKey::Cpid()))->m_hash == activated_hash);
+
+    // Reverting the renewal drops the record:
+    registry.Revert(renewal.Context());
+
+    BOOST_CHECK(!registry.GetRecordedChainletRoot(renewal_hash).has_value());
+    BOOST_CHECK(registry.Try(TestKey::Cpid())->m_hash == activated_hash);
+
+    registry.Add(renewal.Context());
+
+    BOOST_CHECK(registry.GetRecordedChainletRoot(renewal_hash) == activated_hash);
+
+    // Point the root at the renewal instead of the pending beacon that it was
+    // activated from. The recorded root must not hide the corruption:
+    registry.FindHistorical(activated_hash)->m_previous_hash = renewal_hash;
+
+    BOOST_CHECK_THROW(registry.GetBeaconChainletRoot(registry.Try(TestKey::Cpid())), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(beacon_registry_pending_index_follows_deactivation_test)
+{
+    FastRandomContext rng(uint256 {0});
+
+    GRC::BeaconRegistry& registry = GRC::GetBeaconRegistry();
+    registry.Reset();
+
+    const BeaconAdvertisement advertisement(TestKey::Public(), TestKey::Cpid(), 1);
+    registry.Add(advertisement.Context());
+
+    const uint256 superblock_hash = rng.rand256();
+    registry.ActivatePending({TestKey::KeyId()}, 2, superblock_hash, 2);
+
+    BOOST_CHECK(registry.FindPending(TestKey::Cpid()).empty());
+
+    // Reverting the superblock restores the pending beacon:
+    registry.Deactivate(superblock_hash);
+
+    const std::vector<GRC::Beacon_ptr> pending = registry.FindPending(TestKey::Cpid());
+
+    BOOST_REQUIRE_EQUAL(pending.size(), 1);
+    BOOST_CHECK(pending[0]->m_hash == advertisement.m_tx.GetHash());
+    BOOST_CHECK(pending[0]->m_status == GRC::BeaconStatusForStorage::PENDING);
+
+    registry.ActivatePending({TestKey::KeyId()}, 2, superblock_hash, 2);
+
+    BOOST_CHECK(registry.FindPending(TestKey::Cpid()).empty());
+}
+
+BOOST_AUTO_TEST_CASE(beacon_registry_FindPending_test)
+{
+    GRC::BeaconRegistry& registry = GRC::GetBeaconRegistry();
+    registry.Reset();
+
+    CKey key_2;
+    key_2.MakeNewKey(true);
+    CKey key_3;
+    key_3.MakeNewKey(true);
+
+    const GRC::Cpid cpid_a = TestKey::Cpid();
+    const GRC::Cpid cpid_b = GRC::Cpid::Parse("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+
+    const BeaconAdvertisement advertisement_1(TestKey::Public(), cpid_a, 1);
+    const BeaconAdvertisement advertisement_2(key_2.GetPubKey(), cpid_a, 2);
+    const BeaconAdvertisement advertisement_3(key_3.GetPubKey(), cpid_b, 3);
+
+    registry.Add(advertisement_1.Context());
+    registry.Add(advertisement_2.Context());
+    registry.Add(advertisement_3.Context());
+
+    const auto key_ids = [&](const GRC::Cpid& cpid) {
+        std::set<CKeyID> ids;
+
+        for (const auto& beacon : registry.FindPending(cpid)) {
+            BOOST_CHECK(beacon->m_cpid == cpid);
+            ids.insert(beacon->GetId());
+        }
+
+        return ids;
+    };
+
+    BOOST_CHECK(key_ids(cpid_a) == std::set<CKeyID>({TestKey::KeyId(), key_2.GetPubKey().GetID()}));
+    BOOST_CHECK(key_ids(cpid_b) == std::set<CKeyID>({key_3.GetPubKey().GetID()}));
+    BOOST_CHECK(registry.FindPending(GRC::Cpid::Parse("00000000000000000000000000000001")).empty());
+
+    // Advertising the second key for another CPID moves its pending beacon:
+    const BeaconAdvertisement advertisement_4(key_2.GetPubKey(), cpid_b, 4);
+    registry.Add(advertisement_4.Context());
+
+    BOOST_CHECK(key_ids(cpid_a) == std::set<CKeyID>({TestKey::KeyId()}));
+    BOOST_CHECK(key_ids(cpid_b) == std::set<CKeyID>({key_2.GetPubKey().GetID(), key_3.GetPubKey().GetID()}));
+
+    // Reverting an advertisement removes its pending beacon from the index:
+    registry.Revert(advertisement_1.Context());
+
+    BOOST_CHECK(registry.FindPending(cpid_a).empty());
+    BOOST_CHECK_EQUAL(registry.FindPending(cpid_b).size(), 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,7 @@
 // file COPYING or https://opensource.org/licenses/mit-license.php.
 
 #include "hash.h"
+#include "gridcoin/contract/cache.h"
 #include "gridcoin/contract/contract.h"
 #include "gridcoin/project.h"
 #include "wallet/wallet.h"
@@ -778,4 +779,88 @@ BOOST_AUTO_TEST_CASE(it_deserializes_from_a_stream)
     BOOST_CHECK(payload->LegacyKeyString() == "test");
 }
 
+BOOST_AUTO_TEST_CASE(it_shares_a_cached_converted_payload_with_copies)
+{
+    GRC::Contract contract = TestMessage::V1();
+    contract.CacheConvertedPayload();
+
+    BOOST_CHECK(&*contract.SharePayload() == &*contract.SharePayload());
+
+    // Pulling the payload from a copy leaves the shared payload in place:
+    GRC::Contract copy = contract;
+    const GRC::Project project = copy.PullPayloadAs<GRC::Project>();
+
+    BOOST_CHECK_EQUAL(project.m_name, "test");
+    BOOST_CHECK_EQUAL(contract.SharePayloadAs<GRC::Project>()->m_name, "test");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(ContractCache)
+
+BOOST_AUTO_TEST_CASE(it_caches_the_contracts_of_a_transaction)
+{
+    GRC::ContractCache cache;
+
+    CTransaction tx;
+    tx.nVersion = 1;
+    tx.hashBoinc = "<MT>project</MT><MK>test</MK><MV>test</MV><MA>A</MA>";
+
+    const GRC::ContractCache::ContractsPtr contracts = cache.GetContracts(tx);
+
+    BOOST_REQUIRE_EQUAL(contracts->size(), 1);
+    BOOST_CHECK(contracts->front().m_type == GRC::ContractType::PROJECT);
+    BOOST_CHECK_EQUAL(contracts->front().SharePayloadAs<GRC::Project>()->m_name, "test");
+
+    // The legacy payload converts once:
+    BOOST_CHECK(&*contracts->front().SharePayload() == &*contracts->front().SharePayload());
+
+    // The transaction stays unchanged for other threads:
+    BOOST_CHECK(tx.vContracts.empty());
+
+    BOOST_CHECK(cache.GetContracts(tx) == contracts);
+    BOOST_CHECK(cache.GetContracts(tx.GetHash(), CTransaction()) == contracts);
+
+    const GRC::ContractCache::Stats stats = cache.GetStats();
+
+    BOOST_CHECK_EQUAL(stats.m_hits, 1);
+    BOOST_CHECK_EQUAL(stats.m_misses, 1);
+    BOOST_CHECK_EQUAL(stats.m_transactions, 1);
+}
+
+BOOST_AUTO_TEST_CASE(it_skips_transactions_without_contracts)
+{
+    GRC::ContractCache cache;
+
+    BOOST_CHECK(cache.GetContracts(CTransaction())->empty());
+    BOOST_CHECK_EQUAL(cache.GetStats().m_misses, 0);
+    BOOST_CHECK_EQUAL(cache.GetStats().m_transactions, 0);
+}
+
+BOOST_AUTO_TEST_CASE(it_evicts_the_least_recently_used_transactions)
+{
+    GRC::ContractCache cache(2, 2);
+    std::vector<CTransaction> txs(3);
+
+    for (size_t i = 0; i < txs.size(); ++i) {
+        txs[i].nTime = i;
+        txs[i].vContracts.push_back(TestMessage::Current());
+    }
+
+    cache.GetContracts(txs[0]);
+    cache.GetContracts(txs[1]);
+    cache.GetContracts(txs[0]);
+    cache.GetContracts(txs[2]);
+
+    BOOST_CHECK_EQUAL(cache.GetStats().m_transactions, 2);
+    BOOST_CHECK_EQUAL(cache.GetStats().m_hits, 1);
+
+    // The first transaction was used last before the third:
+    cache.GetContracts(txs[0]);
+    BOOST_CHECK_EQUAL(cache.GetStats().m_hits, 2);
+
+    cache.GetContracts(txs[1]);
+    BOOST_CHECK_EQUAL(cache.GetStats().m_hits, 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
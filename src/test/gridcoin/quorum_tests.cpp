@@ -0,0 +1,152 @@
+// Copyright (c) 2014-2021 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "main.h"
+#include "gridcoin/quorum.h"
+#include "gridcoin/superblock.h"
+
+#include <boost/test/unit_test.hpp>
+#include <array>
+#include <vector>
+
+namespace {
+//!
+//! \brief A chain of block index entries for the superblock history to walk.
+//!
+//! Pops the superblocks that a test pushes when it goes out of scope so that
+//! the history contains no dangling entries.
+//!
+template<size_t Size>
+class SuperblockChain
+{
+public:
+    static constexpr int64_t GENESIS_TIME = 1600000000;
+    static constexpr int64_t SPACING = 90;
+
+    SuperblockChain()
+    {
+        for (size_t height = 0; height < Size; ++height) {
+            Link(blocks[height], height ? &blocks[height - 1] : nullptr);
+        }
+    }
+
+    ~SuperblockChain()
+    {
+        while (!m_pushed.empty()) {
+            Pop();
+        }
+    }
+
+    //!
+    //! \brief Link a block index entry to its parent.
+    //!
+    static void Link(CBlockIndex& block, CBlockIndex* const pprev)
+    {
+        block.SetNull();
+        block.pprev = pprev;
+        block.nHeight = pprev ? pprev->nHeight + 1 : 0;
+        block.nTime = GENESIS_TIME + block.nHeight * SPACING;
+    }
+
+    //!
+    //! \brief Connect a superblock like ConnectBlock() does.
+    //!
+    void Push(CBlockIndex& block)
+    {
+        LOCK(cs_main);
+
+        block.MarkAsSuperblock();
+        GRC::Quorum::PushSuperblock(GRC::SuperblockPtr::BindShared(GRC::Superblock(), &block), &block);
+        m_pushed.push_back(&block);
+    }
+
+    //!
+    //! \brief Disconnect the last superblock like DisconnectBlocksBatch() does.
+    //!
+    void Pop()
+    {
+        LOCK(cs_main);
+
+        GRC::Quorum::PopSuperblock(m_pushed.back());
+        m_pushed.pop_back();
+    }
+
+    std::array<CBlockIndex, Size> blocks;
+
+private:
+    std::vector<const CBlockIndex*> m_pushed;
+};
+} // Anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(Quorum__SuperblockHistory)
+
+BOOST_AUTO_TEST_CASE(it_finds_the_superblock_in_effect_at_a_height)
+{
+    SuperblockChain<30> chain;
+
+    chain.Push(chain.blocks[10]);
+    chain.Push(chain.blocks[20]);
+
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndex(9) == nullptr);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndex(10) == &chain.blocks[10]);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndex(15) == &chain.blocks[10]);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndex(19) == &chain.blocks[10]);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndex(20) == &chain.blocks[20]);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndex(29) == &chain.blocks[20]);
+}
+
+BOOST_AUTO_TEST_CASE(it_finds_the_superblock_in_effect_at_a_time)
+{
+    SuperblockChain<30> chain;
+
+    chain.Push(chain.blocks[10]);
+    chain.Push(chain.blocks[20]);
+
+    const int64_t time_10 = chain.blocks[10].GetBlockTime();
+    const int64_t time_20 = chain.blocks[20].GetBlockTime();
+
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndexByTime(time_10 - 1) == nullptr);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndexByTime(time_10) == &chain.blocks[10]);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndexByTime(time_10 + 1) == &chain.blocks[10]);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndexByTime(time_20 - 1) == &chain.blocks[10]);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndexByTime(time_20) == &chain.blocks[20]);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndexByTime(time_20 + 1) == &chain.blocks[20]);
+}
+
+BOOST_AUTO_TEST_CASE(it_replaces_superblocks_across_a_reorganization)
+{
+    SuperblockChain<30> chain;
+    std::array<CBlockIndex, 10> fork;
+
+    // The fork branches off after block 19:
+    for (size_t i = 0; i < fork.size(); ++i) {
+        SuperblockChain<30>::Link(fork[i], i ? &fork[i - 1] : &chain.blocks[19]);
+    }
+
+    chain.Push(chain.blocks[10]);
+    chain.Push(chain.blocks[20]);
+
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndex(25) == &chain.blocks[20]);
+
+    // Disconnect the superblock at height 20 and connect one at height 22
+    // on the fork:
+    chain.Pop();
+    chain.Push(fork[2]);
+
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndex(20) == &chain.blocks[10]);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndex(21) == &chain.blocks[10]);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndex(22) == &fork[2]);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndex(25) == &fork[2]);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndexByTime(fork[2].GetBlockTime()) == &fork[2]);
+
+    // Reorganize back to the original chain:
+    chain.Pop();
+    chain.Push(chain.blocks[20]);
+
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndex(22) == &chain.blocks[20]);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndex(25) == &chain.blocks[20]);
+    BOOST_CHECK(GRC::Quorum::FindSuperblockIndex(19) == &chain.blocks[10]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,110 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <boost/test/unit_test.hpp>
+
+#include <gridcoin/staking/kernel.h>
+#include <gridcoin/staking/kernel_search.h>
+#include <primitives/transaction.h>
+#include <test/test_gridcoin.h>
+
+namespace {
+CTransaction MakeCoinTx(const unsigned int lock_time)
+{
+    CTransaction tx;
+    tx.nTime = 1700000000;
+    tx.nLockTime = lock_time; // Distinguishes the hashes.
+    tx.vin.emplace_back(COutPoint(InsecureRand256(), 0));
+    tx.vout.emplace_back(1000 * COIN, CScript() << OP_TRUE);
+    tx.vout.emplace_back(2000 * COIN, CScript() << OP_TRUE);
+
+    return tx;
+}
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(stake_kernel_search_tests)
+
+BOOST_AUTO_TEST_CASE(it_matches_the_consensus_kernel_hash)
+{
+    const uint64_t stake_modifier = 0x0123456789abcdef;
+    const uint32_t block_time = 1700000123;
+    const uint32_t tx_time = 1700086411;
+
+    GRC::StakeKernelSearch search(stake_modifier, 0x1d00ffff);
+
+    const CTransaction tx = MakeCoinTx(1);
+
+    for (unsigned int n = 0; n < tx.vout.size(); ++n) {
+        search.AddCandidate(COutPoint(tx.GetHash(), n), tx.vout[n].nValue, block_time);
+    }
+
+    BOOST_REQUIRE_EQUAL(search.GetCandidates().size(), 2);
+
+    for (unsigned int n = 0; n < tx.vout.size(); ++n) {
+        const GRC::StakeKernelSearch::Candidate& candidate = search.GetCandidates()[n];
+
+        BOOST_CHECK(search.GetKernelHash(candidate, tx_time)
+                    == GRC::CalculateStakeHashV8(block_time, tx, n, tx_time, stake_modifier));
+        BOOST_CHECK_EQUAL(candidate.m_weight, GRC::CalculateStakeWeightV8(tx, n));
+    }
+
+    BOOST_CHECK_EQUAL(search.GetWeightSum(), GRC::CalculateStakeWeightV8(3000 * COIN));
+    BOOST_CHECK_EQUAL(search.GetWeightMin(), GRC::CalculateStakeWeightV8(1000 * COIN));
+    BOOST_CHECK_EQUAL(search.GetWeightMax(), GRC::CalculateStakeWeightV8(2000 * COIN));
+}
+
+BOOST_AUTO_TEST_CASE(it_finds_the_first_kernel_that_meets_the_target)
+{
+    const CTransaction tx = MakeCoinTx(2);
+
+    // A target close to the maximum, scaled by any weight above one, accepts
+    // every kernel hash:
+    GRC::StakeKernelSearch easy(1, 0x207fffff);
+    easy.AddCandidate(COutPoint(tx.GetHash(), 0), tx.vout[0].nValue, 1700000000);
+    easy.AddCandidate(COutPoint(tx.GetHash(), 1), tx.vout[1].nValue, 1700000000);
+
+    const std::optional<size_t> found = easy.Find(1700086400);
+
+    BOOST_REQUIRE(found.has_value());
+    BOOST_CHECK_EQUAL(*found, 0);
+
+    // A target of one accepts practically nothing:
+    GRC::StakeKernelSearch hard(1, 0x03000001);
+    hard.AddCandidate(COutPoint(tx.GetHash(), 0), tx.vout[0].nValue, 1700000000);
+    hard.AddCandidate(COutPoint(tx.GetHash(), 1), tx.vout[1].nValue, 1700000000);
+
+    BOOST_CHECK(!hard.Find(1700086400).has_value());
+}
+
+BOOST_AUTO_TEST_CASE(it_finds_the_same_kernel_as_the_serial_search)
+{
+    // A candidate count that is not a multiple of the batch size exercises
+    // the partial last batch:
+    const size_t num_candidates = 21;
+
+    // Scaled by the weights below, this target accepts a few percent of the
+    // kernels, so the searches find a kernel at some timestamps only:
+    GRC::StakeKernelSearch search(0x0123456789abcdef, 0x1f00d000);
+
+    for (size_t i = 0; i < num_candidates; ++i) {
+        search.AddCandidate(COutPoint(InsecureRand256(), i), (i + 1) * 2 * COIN, 1700000000 + i);
+    }
+
+    size_t found_count = 0;
+
+    for (uint32_t tx_time = 1700086400; tx_time < 1700086400 + 300 * 16; tx_time += 16) {
+        const std::optional<size_t> found = search.Find(tx_time);
+
+        BOOST_CHECK(found == search.FindSerial(tx_time));
+
+        if (found) {
+            ++found_count;
+        }
+    }
+
+    BOOST_CHECK(found_count > 0);
+    BOOST_CHECK(found_count < 300);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
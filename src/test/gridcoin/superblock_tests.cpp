@@ -5,6 +5,7 @@
 #include "base58.h"
 #include "compat/endian.h"
 #include <gridcoin/md5.h>
+#include "gridcoin/scraper/scraper.h"
 #include "gridcoin/scraper/scraper_net.h"
 #include "gridcoin/superblock.h"
 #include "gridcoin/support/xml.h"
@@ -12,6 +13,8 @@
 
 #include <array>
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
 #include <boost/test/unit_test.hpp>
 #include <iostream>
 #include <vector>
@@ -521,6 +524,38 @@ ConvergedScraperStats GetTestConvergence(
 
     return convergence;
 }
+
+//!
+//! \brief Build a manifest part that contains project statistics compressed
+//! like the stats files published by the scrapers.
+//!
+//! \param seed Varies the credit of each CPID in the project.
+//!
+CSplitBlob::CPart GetTestProjectPart(const double seed)
+{
+    const ScraperStatsMeta meta;
+    std::stringstream compressed;
+
+    boost::iostreams::filtering_ostream out;
+    out.push(boost::iostreams::gzip_compressor());
+    out.push(compressed);
+
+    out << "# total credit,recent average total,recent average credit,cpid\n"
+        << seed * 1000 << "," << seed * 20 << "," << seed * 10 << "," << meta.cpid1_str << "\n"
+        << seed * 3000 << "," << seed * 60 << "," << seed * 30 << "," << meta.cpid2_str << "\n"
+        << seed * 5000 << "," << seed * 40 << "," << seed + 7 << "," << meta.cpid3_str << "\n";
+
+    out.reset();
+
+    const std::string data = compressed.str();
+    const Span<const std::byte> bytes = MakeByteSpan(data);
+    const SerializeData part_data(bytes.begin(), bytes.end());
+
+    CSplitBlob::CPart part(Hash(part_data));
+    part.data = part_data;
+
+    return part;
+}
 } // anonymous namespace
 
 // -----------------------------------------------------------------------------
@@ -2136,6 +2171,47 @@ BOOST_AUTO_TEST_CASE(it_hashes_a_set_of_scraper_statistics_like_a_superblock)
     BOOST_CHECK(quorum_hash == superblock.GetHash());
 }
 
+BOOST_AUTO_TEST_CASE(it_hashes_the_segments_of_a_superblock_like_the_superblock)
+{
+    const ScraperStatsMeta meta;
+    ScraperStatsAndVerifiedBeacons stats_and_verified_beacons = GetTestScraperStats(meta);
+
+    const GRC::Superblock superblock = GRC::Superblock::FromStats(stats_and_verified_beacons);
+    const GRC::QuorumHashSegments segments = GRC::QuorumHashSegments::FromSuperblock(superblock);
+
+    BOOST_CHECK(segments.m_magnitudes == superblock.m_cpids.HashSegments());
+    BOOST_CHECK(segments.GetHash() == superblock.GetHash());
+    BOOST_CHECK(GRC::QuorumHashSegments::FromStats(stats_and_verified_beacons) == segments);
+    BOOST_CHECK(segments.MatchesSmallSections(stats_and_verified_beacons));
+    BOOST_CHECK(segments.Matches(stats_and_verified_beacons));
+
+    // A change to a non-zero CPID magnitude passes the first pass and fails
+    // the comparison of the magnitude hashes:
+    ScraperStatsAndVerifiedBeacons cpid_changed = stats_and_verified_beacons;
+
+    for (auto& entry : cpid_changed.mScraperStats) {
+        if (entry.first.objecttype == statsobjecttype::byCPID && entry.second.statsvalue.dMag >= 1) {
+            entry.second.statsvalue.dMag += 1;
+            break;
+        }
+    }
+
+    BOOST_CHECK(segments.MatchesSmallSections(cpid_changed));
+    BOOST_CHECK(!segments.Matches(cpid_changed));
+
+    // A change to a project section fails the first pass:
+    for (auto& entry : stats_and_verified_beacons.mScraperStats) {
+        if (entry.first.objecttype == statsobjecttype::byProject) {
+            entry.second.statsvalue.dRAC += 1000;
+            break;
+        }
+    }
+
+    BOOST_CHECK(!segments.MatchesSmallSections(stats_and_verified_beacons));
+    BOOST_CHECK(!segments.Matches(stats_and_verified_beacons));
+    BOOST_CHECK(GRC::QuorumHashSegments::FromStats(stats_and_verified_beacons) != segments);
+}
+
 BOOST_AUTO_TEST_CASE(it_parses_a_sha256_hash_string)
 {
     const std::vector<unsigned char> expected {
@@ -2493,3 +2569,148 @@ BOOST_AUTO_TEST_CASE(it_deserializes_from_a_stream_for_md5)
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+// -----------------------------------------------------------------------------
+// Scraper statistics by project
+// -----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE(ScraperStatsByProject)
+
+BOOST_AUTO_TEST_CASE(it_computes_the_same_stats_in_parallel_as_a_serial_merge)
+{
+    CSplitBlob::CPart beacon_list(uint256 {});
+    std::map<std::string, CSplitBlob::CPart> project_parts;
+
+    // Use more projects than stats worker threads:
+    for (int i = 1; i <= 12; ++i) {
+        project_parts.emplace("project_" + ToString(i), GetTestProjectPart(i));
+    }
+
+    ConvergedManifest convergence;
+    convergence.ConvergedManifestPartPtrsMap.emplace("BeaconList", &beacon_list);
+
+    for (auto& project_pair : project_parts) {
+        convergence.ConvergedManifestPartPtrsMap.emplace(project_pair.first, &project_pair.second);
+    }
+
+    const ScraperStatsAndVerifiedBeacons parallel = GetScraperStatsByConvergedManifest(convergence);
+
+    ScraperStatsAndVerifiedBeacons serial;
+
+    for (const auto& project_pair : project_parts) {
+        ScraperStats project_stats;
+
+        BOOST_REQUIRE(LoadProjectObjectToStatsByCPID(
+            project_pair.first,
+            project_pair.second.data,
+            NETWORK_MAGNITUDE / project_parts.size(),
+            project_stats));
+
+        serial.mScraperStats.insert(project_stats.begin(), project_stats.end());
+    }
+
+    ProcessNetworkWideFromProjectStats(serial.mScraperStats);
+
+    BOOST_REQUIRE_EQUAL(parallel.mScraperStats.size(), serial.mScraperStats.size());
+
+    auto serial_iter = serial.mScraperStats.begin();
+
+    for (const auto& entry : parallel.mScraperStats) {
+        BOOST_CHECK(entry.first.objecttype == serial_iter->first.objecttype);
+        BOOST_CHECK_EQUAL(entry.first.objectID, serial_iter->first.objectID);
+        BOOST_CHECK_EQUAL(entry.second.statsvalue.dTC, serial_iter->second.statsvalue.dTC);
+        BOOST_CHECK_EQUAL(entry.second.statsvalue.dRAC, serial_iter->second.statsvalue.dRAC);
+        BOOST_CHECK_EQUAL(entry.second.statsvalue.dAvgRAC, serial_iter->second.statsvalue.dAvgRAC);
+        BOOST_CHECK_EQUAL(entry.second.statsvalue.dMag, serial_iter->second.statsvalue.dMag);
+
+        ++serial_iter;
+    }
+
+    BOOST_CHECK(GRC::QuorumHash::Hash(parallel) == GRC::QuorumHash::Hash(serial));
+}
+
+BOOST_AUTO_TEST_CASE(it_matches_a_superblock_with_an_alternate_project_part)
+{
+    CSplitBlob::CPart beacon_list(uint256 {});
+    CSplitBlob::CPart project_1_part_a = GetTestProjectPart(1);
+    CSplitBlob::CPart project_1_part_b = GetTestProjectPart(2);
+    CSplitBlob::CPart project_2_part = GetTestProjectPart(3);
+
+    // The superblock comes from a convergence with the second candidate part
+    // for project 1:
+    ConvergedManifest convergence;
+    convergence.ConvergedManifestPartPtrsMap.emplace("BeaconList", &beacon_list);
+    convergence.ConvergedManifestPartPtrsMap.emplace("project_1", &project_1_part_b);
+    convergence.ConvergedManifestPartPtrsMap.emplace("project_2", &project_2_part);
+
+    const GRC::QuorumHashSegments segments = GRC::QuorumHashSegments::FromSuperblock(
+        GRC::Superblock::FromStats(GetScraperStatsByConvergedManifest(convergence)));
+
+    // Validation computes the stats of every candidate part once:
+    const std::vector<ScraperStats> project_stats = GetProjectStatsFromParts({
+        { "project_1", &project_1_part_a },
+        { "project_1", &project_1_part_b },
+        { "project_2", &project_2_part },
+    }, 2);
+
+    ScraperStatsAndVerifiedBeacons stats;
+
+    BOOST_REQUIRE(GetScraperStatsFromProjectCombination(
+        { &project_stats[0], &project_stats[2] },
+        &beacon_list,
+        nullptr,
+        stats));
+
+    BOOST_CHECK(!segments.Matches(stats));
+
+    BOOST_REQUIRE(GetScraperStatsFromProjectCombination(
+        { &project_stats[1], &project_stats[2] },
+        &beacon_list,
+        nullptr,
+        stats));
+
+    BOOST_CHECK(segments.Matches(stats));
+}
+
+BOOST_AUTO_TEST_CASE(it_rejects_a_combination_with_a_missing_project_part)
+{
+    CSplitBlob::CPart beacon_list(uint256 {});
+    CSplitBlob::CPart project_1_part = GetTestProjectPart(1);
+
+    const std::vector<ScraperStats> project_stats = GetProjectStatsFromParts({
+        { "project_1", &project_1_part },
+    }, 2);
+
+    ScraperStatsAndVerifiedBeacons stats;
+
+    BOOST_CHECK(!GetScraperStatsFromProjectCombination(
+        { &project_stats[0], nullptr },
+        &beacon_list,
+        nullptr,
+        stats));
+
+    BOOST_CHECK(stats.mScraperStats.empty());
+}
+
+BOOST_AUTO_TEST_CASE(it_rejects_a_combination_without_a_beacon_list)
+{
+    CSplitBlob::CPart project_1_part = GetTestProjectPart(1);
+    CSplitBlob::CPart project_2_part = GetTestProjectPart(2);
+
+    const std::vector<ScraperStats> project_stats = GetProjectStatsFromParts({
+        { "project_1", &project_1_part },
+        { "project_2", &project_2_part },
+    }, 2);
+
+    ScraperStatsAndVerifiedBeacons stats;
+
+    BOOST_CHECK(!GetScraperStatsFromProjectCombination(
+        { &project_stats[0], &project_stats[1] },
+        nullptr,
+        nullptr,
+        stats));
+
+    BOOST_CHECK(stats.mScraperStats.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
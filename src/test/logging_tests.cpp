@@ -0,0 +1,253 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <fs.h>
+#include <logging.h>
+#include <random.h>
+
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+fs::path TempLogPath()
+{
+    return fs::temp_directory_path() / ("logging_tests_" + GetRandHash().ToString() + ".log");
+}
+
+std::vector<std::string> ReadLines(const fs::path& path)
+{
+    std::ifstream file(path.string());
+    std::vector<std::string> lines;
+
+    for (std::string line; std::getline(file, line);) {
+        if (!line.empty()) lines.push_back(line);
+    }
+
+    return lines;
+}
+
+//!
+//! \brief Log \p count messages from each of \p threads threads.
+//!
+void LogConcurrently(BCLog::Logger& logger, const int threads, const int count)
+{
+    std::vector<std::thread> producers;
+
+    for (int t = 0; t < threads; ++t) {
+        producers.emplace_back([&logger, t, count] {
+            for (int i = 0; i < count; ++i) {
+                logger.LogPrintStr(strprintf("thread %d message %d\n", t, i));
+            }
+        });
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+}
+} // Anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(logging_tests)
+
+BOOST_AUTO_TEST_CASE(message_queue_rounds_capacity_to_a_power_of_two)
+{
+    BOOST_CHECK_EQUAL(BCLog::MessageQueue(1).Capacity(), 2U);
+    BOOST_CHECK_EQUAL(BCLog::MessageQueue(5).Capacity(), 8U);
+    BOOST_CHECK_EQUAL(BCLog::MessageQueue(8).Capacity(), 8U);
+}
+
+BOOST_AUTO_TEST_CASE(message_queue_pops_in_order_and_rejects_when_full)
+{
+    BCLog::MessageQueue queue(4);
+    std::string message;
+
+    BOOST_CHECK(queue.Empty());
+    BOOST_CHECK(!queue.TryPop(message));
+
+    for (int i = 0; i < 4; ++i) {
+        message = std::to_string(i);
+        BOOST_CHECK(queue.TryPush(message));
+    }
+
+    message = "overflow";
+    BOOST_CHECK(!queue.TryPush(message));
+    BOOST_CHECK_EQUAL(message, "overflow");
+
+    // Wrap around the ring:
+    for (int lap = 0; lap < 3; ++lap) {
+        for (int i = 0; i < 4; ++i) {
+            BOOST_CHECK(queue.TryPop(message));
+            BOOST_CHECK_EQUAL(message, std::to_string(lap * 4 + i));
+
+            message = std::to_string((lap + 1) * 4 + i);
+            BOOST_CHECK(queue.TryPush(message));
+        }
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        BOOST_CHECK(queue.TryPop(message));
+    }
+
+    BOOST_CHECK(queue.Empty());
+}
+
+BOOST_AUTO_TEST_CASE(message_queue_keeps_each_producers_order_under_contention)
+{
+    constexpr int PRODUCERS = 4;
+    constexpr int COUNT = 20000;
+
+    BCLog::MessageQueue queue(64);
+    std::vector<std::thread> producers;
+
+    for (int t = 0; t < PRODUCERS; ++t) {
+        producers.emplace_back([&queue, t] {
+            for (int i = 0; i < COUNT; ++i) {
+                std::string message = std::to_string(t) + ":" + std::to_string(i);
+                while (!queue.TryPush(message)) std::this_thread::yield();
+            }
+        });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    int received = 0;
+    bool in_order = true;
+
+    while (received < PRODUCERS * COUNT) {
+        std::string message;
+
+        if (!queue.TryPop(message)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        const size_t separator = message.find(':');
+        const int t = std::stoi(message.substr(0, separator));
+        const int i = std::stoi(message.substr(separator + 1));
+
+        in_order &= next[t] == i;
+        next[t] = i + 1;
+        ++received;
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    BOOST_CHECK(in_order);
+    BOOST_CHECK(queue.Empty());
+}
+
+BOOST_AUTO_TEST_CASE(async_writer_writes_every_message_when_it_blocks_on_overflow)
+{
+    const fs::path path = TempLogPath();
+
+    BCLog::Logger logger;
+    logger.m_print_to_file = true;
+    logger.m_file_path = path;
+    logger.m_log_timestamps = false;
+
+    BOOST_REQUIRE(logger.StartLogging());
+    logger.StartAsyncWriter(8, BCLog::OverflowPolicy::BLOCK);
+    BOOST_CHECK(logger.IsAsync());
+
+    LogConcurrently(logger, 4, 2000);
+
+    // Flush() makes the messages logged so far visible without stopping:
+    logger.LogPrintStr("flushed\n");
+    logger.Flush();
+    BOOST_CHECK_EQUAL(ReadLines(path).back(), "flushed");
+
+    logger.StopAsyncWriter();
+    BOOST_CHECK(!logger.IsAsync());
+
+    // Logging continues synchronously after the writer stops:
+    logger.LogPrintStr("stopped\n");
+    logger.DisconnectTestLogger();
+
+    const std::vector<std::string> lines = ReadLines(path);
+
+    BOOST_CHECK_EQUAL(lines.size(), 4U * 2000 + 2);
+    BOOST_CHECK_EQUAL(lines.back(), "stopped");
+    BOOST_CHECK_EQUAL(logger.GetDroppedCount(), 0U);
+
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(async_writer_counts_messages_that_it_drops_on_overflow)
+{
+    const fs::path path = TempLogPath();
+
+    BCLog::Logger logger;
+    logger.m_print_to_file = true;
+    logger.m_file_path = path;
+    logger.m_log_timestamps = false;
+
+    BOOST_REQUIRE(logger.StartLogging());
+    logger.StartAsyncWriter(2, BCLog::OverflowPolicy::DROP);
+
+    LogConcurrently(logger, 4, 2000);
+
+    logger.StopAsyncWriter();
+    logger.DisconnectTestLogger();
+
+    size_t written = 0;
+    size_t notices = 0;
+
+    for (const auto& line : ReadLines(path)) {
+        if (line.find("messages because the log queue was full") != std::string::npos) {
+            ++notices;
+        } else {
+            ++written;
+        }
+    }
+
+    BOOST_CHECK_EQUAL(written + logger.GetDroppedCount(), 4U * 2000);
+    BOOST_CHECK_EQUAL(notices > 0, logger.GetDroppedCount() > 0);
+
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(async_writer_calls_print_slots_on_the_logging_thread)
+{
+    BCLog::Logger logger;
+    logger.m_log_timestamps = false;
+
+    std::vector<std::thread::id> slot_threads;
+    logger.PushBackCallback([&](const std::string&) {
+        slot_threads.push_back(std::this_thread::get_id());
+    });
+
+    BOOST_REQUIRE(logger.StartLogging());
+    logger.StartAsyncWriter(2, BCLog::OverflowPolicy::BLOCK);
+
+    for (int i = 0; i < 10; ++i) {
+        logger.LogPrintStr(strprintf("message %d\n", i));
+    }
+
+    logger.StopAsyncWriter();
+    logger.DisconnectTestLogger();
+
+    BOOST_CHECK_EQUAL(slot_threads.size(), 10U);
+
+    for (const auto& id : slot_threads) {
+        BOOST_CHECK(id == std::this_thread::get_id());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(it_parses_log_overflow_policies)
+{
+    BCLog::OverflowPolicy policy = BCLog::OverflowPolicy::BLOCK;
+
+    BOOST_CHECK(GetLogOverflowPolicy(policy, "drop"));
+    BOOST_CHECK(policy == BCLog::OverflowPolicy::DROP);
+    BOOST_CHECK(GetLogOverflowPolicy(policy, "block"));
+    BOOST_CHECK(policy == BCLog::OverflowPolicy::BLOCK);
+    BOOST_CHECK(!GetLogOverflowPolicy(policy, "discard"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
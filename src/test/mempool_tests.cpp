@@ -0,0 +1,274 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "main.h"
+#include "test/test_gridcoin.h"
+#include "txmempool.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+//!
+//! \brief Create a transaction that spends the specified outputs.
+//!
+CTransaction MakeTx(const std::vector<COutPoint>& prevouts, const unsigned int outputs, const unsigned int lock_time)
+{
+    CTransaction tx;
+    tx.nTime = 0;
+    tx.nLockTime = lock_time; // Distinguishes the hashes.
+
+    for (const auto& prevout : prevouts) {
+        tx.vin.emplace_back(prevout);
+        tx.vin.back().scriptSig = CScript() << OP_11;
+    }
+
+    for (unsigned int i = 0; i < outputs; ++i) {
+        tx.vout.emplace_back(COIN, CScript() << OP_11 << OP_EQUAL);
+    }
+
+    return tx;
+}
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(mempool_tests)
+
+BOOST_AUTO_TEST_CASE(it_orders_entries_by_fee_rate)
+{
+    CTxMemPool pool;
+
+    const CTransaction tx_low = MakeTx({ COutPoint(InsecureRand256(), 0) }, 1, 1);
+    const CTransaction tx_high = MakeTx({ COutPoint(InsecureRand256(), 0) }, 1, 2);
+    const CTransaction tx_mid = MakeTx({ COutPoint(InsecureRand256(), 0) }, 1, 3);
+
+    pool.addUnchecked(tx_low.GetHash(), tx_low, 1000, 1);
+    pool.addUnchecked(tx_high.GetHash(), tx_high, 100000, 2);
+    pool.addUnchecked(tx_mid.GetHash(), tx_mid, 10000, 3);
+
+    LOCK(pool.cs);
+
+    std::vector<uint256> by_fee_rate;
+    for (const auto& [_, hash] : pool.GetByFeeRate()) {
+        by_fee_rate.push_back(hash);
+    }
+
+    BOOST_REQUIRE_EQUAL(by_fee_rate.size(), 3);
+    BOOST_CHECK(by_fee_rate[0] == tx_high.GetHash());
+    BOOST_CHECK(by_fee_rate[1] == tx_mid.GetHash());
+    BOOST_CHECK(by_fee_rate[2] == tx_low.GetHash());
+
+    std::vector<uint256> by_time;
+    for (const auto& [_, hash] : pool.GetByEntryTime()) {
+        by_time.push_back(hash);
+    }
+
+    BOOST_REQUIRE_EQUAL(by_time.size(), 3);
+    BOOST_CHECK(by_time[0] == tx_low.GetHash());
+    BOOST_CHECK(by_time[2] == tx_mid.GetHash());
+}
+
+BOOST_AUTO_TEST_CASE(it_orders_entries_by_ancestor_score)
+{
+    CTxMemPool pool;
+
+    // A parent that pays a low fee with a child that pays a high fee:
+    const CTransaction parent = MakeTx({ COutPoint(InsecureRand256(), 0) }, 1, 1);
+    const CTransaction child = MakeTx({ COutPoint(parent.GetHash(), 0) }, 1, 2);
+    const CTransaction other = MakeTx({ COutPoint(InsecureRand256(), 0) }, 1, 3);
+
+    pool.addUnchecked(parent.GetHash(), parent, 1000);
+    pool.addUnchecked(child.GetHash(), child, 100000);
+    pool.addUnchecked(other.GetHash(), other, 10000);
+
+    LOCK(pool.cs);
+
+    const CTxMemPoolEntry* child_entry = pool.GetEntry(child.GetHash());
+
+    BOOST_REQUIRE(child_entry != nullptr);
+    BOOST_CHECK(child_entry->GetAncestorScore() < child_entry->GetFeePerKb());
+
+    std::vector<uint256> by_score;
+    for (const auto& [_, hash] : pool.GetByAncestorScore()) {
+        by_score.push_back(hash);
+    }
+
+    // The package of the child pays more per kilobyte than the other entry:
+    BOOST_REQUIRE_EQUAL(by_score.size(), 3);
+    BOOST_CHECK(by_score[0] == child.GetHash());
+    BOOST_CHECK(by_score[1] == other.GetHash());
+    BOOST_CHECK(by_score[2] == parent.GetHash());
+}
+
+BOOST_AUTO_TEST_CASE(it_tracks_ancestors_incrementally)
+{
+    CTxMemPool pool;
+
+    const CTransaction parent = MakeTx({ COutPoint(InsecureRand256(), 0) }, 2, 1);
+    const CTransaction child = MakeTx({ COutPoint(parent.GetHash(), 0) }, 1, 2);
+    const CTransaction grandchild = MakeTx({ COutPoint(child.GetHash(), 0), COutPoint(parent.GetHash(), 1) }, 1, 3);
+
+    pool.addUnchecked(parent.GetHash(), parent, 1000);
+    pool.addUnchecked(child.GetHash(), child, 1000);
+    pool.addUnchecked(grandchild.GetHash(), grandchild, 1000);
+
+    {
+        LOCK(pool.cs);
+
+        const CTxMemPoolEntry* entry = pool.GetEntry(grandchild.GetHash());
+
+        BOOST_REQUIRE(entry != nullptr);
+        BOOST_CHECK_EQUAL(entry->GetParents().size(), 2);
+        BOOST_CHECK_EQUAL(entry->GetAncestors().size(), 2);
+        BOOST_CHECK_EQUAL(entry->GetModFeesWithAncestors(), 3000);
+        BOOST_CHECK_EQUAL(pool.GetEntry(parent.GetHash())->GetChildren().size(), 2);
+    }
+
+    // Confirming the parent in a block removes it non-recursively. The remaining
+    // entries no longer count it as an ancestor:
+    pool.remove(parent);
+
+    {
+        LOCK(pool.cs);
+
+        const CTxMemPoolEntry* entry = pool.GetEntry(grandchild.GetHash());
+
+        BOOST_REQUIRE(entry != nullptr);
+        BOOST_CHECK_EQUAL(entry->GetParents().size(), 1);
+        BOOST_CHECK_EQUAL(entry->GetAncestors().size(), 1);
+        BOOST_CHECK_EQUAL(entry->GetModFeesWithAncestors(), 2000);
+        BOOST_CHECK(pool.GetEntry(child.GetHash())->GetParents().empty());
+
+        // The ancestor score index follows the shrunk packages:
+        BOOST_CHECK_EQUAL(pool.GetByAncestorScore().size(), 2);
+        BOOST_CHECK(pool.GetByAncestorScore().count(std::make_pair(entry->GetAncestorScore(), grandchild.GetHash())));
+    }
+
+    // Removing the child recursively also removes the grandchild:
+    pool.remove(child, true);
+
+    BOOST_CHECK_EQUAL(pool.size(), 0);
+    BOOST_CHECK(pool.mapNextTx.empty());
+    BOOST_CHECK_EQUAL(pool.DynamicMemoryUsage(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(it_links_a_parent_added_after_its_descendants)
+{
+    CTxMemPool pool;
+
+    const CTransaction grandparent = MakeTx({ COutPoint(InsecureRand256(), 0) }, 1, 1);
+    const CTransaction parent = MakeTx({ COutPoint(grandparent.GetHash(), 0) }, 1, 2);
+    const CTransaction child = MakeTx({ COutPoint(parent.GetHash(), 0) }, 1, 3);
+    const CTransaction grandchild = MakeTx({ COutPoint(child.GetHash(), 0) }, 1, 4);
+
+    // A reorganization resurrects the parent after its spenders entered the pool:
+    pool.addUnchecked(grandparent.GetHash(), grandparent, 1000);
+    pool.addUnchecked(child.GetHash(), child, 1000);
+    pool.addUnchecked(grandchild.GetHash(), grandchild, 1000);
+    pool.addUnchecked(parent.GetHash(), parent, 1000);
+
+    {
+        LOCK(pool.cs);
+
+        const CTxMemPoolEntry* parent_entry = pool.GetEntry(parent.GetHash());
+        const CTxMemPoolEntry* child_entry = pool.GetEntry(child.GetHash());
+        const CTxMemPoolEntry* grandchild_entry = pool.GetEntry(grandchild.GetHash());
+
+        BOOST_REQUIRE(parent_entry != nullptr);
+        BOOST_REQUIRE(child_entry != nullptr);
+        BOOST_REQUIRE(grandchild_entry != nullptr);
+
+        BOOST_CHECK(parent_entry->GetChildren() == std::set<uint256> { child.GetHash() });
+        BOOST_CHECK_EQUAL(parent_entry->GetAncestors().size(), 1);
+        BOOST_CHECK(child_entry->GetParents() == std::set<uint256> { parent.GetHash() });
+        BOOST_CHECK_EQUAL(child_entry->GetAncestors().size(), 2);
+        BOOST_CHECK_EQUAL(child_entry->GetModFeesWithAncestors(), 3000);
+        BOOST_CHECK_EQUAL(grandchild_entry->GetAncestors().size(), 3);
+        BOOST_CHECK_EQUAL(grandchild_entry->GetModFeesWithAncestors(), 4000);
+        BOOST_CHECK_EQUAL(
+            grandchild_entry->GetSizeWithAncestors(),
+            ::GetSerializeSize(grandparent, SER_NETWORK, PROTOCOL_VERSION)
+                + ::GetSerializeSize(parent, SER_NETWORK, PROTOCOL_VERSION)
+                + ::GetSerializeSize(child, SER_NETWORK, PROTOCOL_VERSION)
+                + ::GetSerializeSize(grandchild, SER_NETWORK, PROTOCOL_VERSION));
+    }
+
+    // Removing the parent recursively removes its descendants with it:
+    pool.remove(parent, true);
+
+    BOOST_CHECK_EQUAL(pool.size(), 1);
+    BOOST_CHECK(pool.exists(grandparent.GetHash()));
+}
+
+BOOST_AUTO_TEST_CASE(it_evicts_the_lowest_fee_rate_with_descendants)
+{
+    CTxMemPool pool;
+
+    const CTransaction cheap_parent = MakeTx({ COutPoint(InsecureRand256(), 0) }, 1, 1);
+    const CTransaction rich_child = MakeTx({ COutPoint(cheap_parent.GetHash(), 0) }, 1, 2);
+    const CTransaction rich = MakeTx({ COutPoint(InsecureRand256(), 0) }, 1, 3);
+
+    pool.addUnchecked(cheap_parent.GetHash(), cheap_parent, 1000);
+    pool.addUnchecked(rich_child.GetHash(), rich_child, 1000000);
+    pool.addUnchecked(rich.GetHash(), rich, 100000);
+
+    const size_t usage = pool.DynamicMemoryUsage();
+    size_t rich_usage;
+
+    {
+        LOCK(pool.cs);
+        rich_usage = pool.GetEntry(rich.GetHash())->GetUsage();
+    }
+
+    std::vector<uint256> removed;
+    pool.TrimToSize(usage - 1, &removed);
+
+    BOOST_CHECK_EQUAL(removed.size(), 2);
+    BOOST_CHECK(!pool.exists(cheap_parent.GetHash()));
+    BOOST_CHECK(!pool.exists(rich_child.GetHash()));
+    BOOST_CHECK(pool.exists(rich.GetHash()));
+    BOOST_CHECK_EQUAL(pool.DynamicMemoryUsage(), rich_usage);
+}
+
+BOOST_AUTO_TEST_CASE(it_expires_old_entries_with_descendants)
+{
+    CTxMemPool pool;
+
+    const CTransaction old_parent = MakeTx({ COutPoint(InsecureRand256(), 0) }, 1, 1);
+    const CTransaction new_child = MakeTx({ COutPoint(old_parent.GetHash(), 0) }, 1, 2);
+    const CTransaction unrelated = MakeTx({ COutPoint(InsecureRand256(), 0) }, 1, 3);
+
+    pool.addUnchecked(old_parent.GetHash(), old_parent, 1000, 100);
+    pool.addUnchecked(new_child.GetHash(), new_child, 1000, 300);
+    pool.addUnchecked(unrelated.GetHash(), unrelated, 1000, 300);
+
+    BOOST_CHECK_EQUAL(pool.Expire(200), 2);
+    BOOST_CHECK_EQUAL(pool.size(), 1);
+    BOOST_CHECK(pool.exists(unrelated.GetHash()));
+}
+
+BOOST_AUTO_TEST_CASE(it_counts_transactions_entering_and_leaving)
+{
+    CTxMemPool pool;
+
+    const CTransaction parent = MakeTx({ COutPoint(InsecureRand256(), 0) }, 1, 1);
+    const CTransaction child = MakeTx({ COutPoint(parent.GetHash(), 0) }, 1, 2);
+
+    const uint64_t initial = pool.GetTransactionsUpdated();
+
+    pool.addUnchecked(parent.GetHash(), parent, 1000);
+    pool.addUnchecked(child.GetHash(), child, 1000);
+    BOOST_CHECK_EQUAL(pool.GetTransactionsUpdated(), initial + 2);
+
+    // A duplicate does not enter the pool:
+    pool.addUnchecked(parent.GetHash(), parent, 1000);
+    BOOST_CHECK_EQUAL(pool.GetTransactionsUpdated(), initial + 2);
+
+    // Removing the parent recursively also removes the child:
+    pool.remove(parent, true);
+    BOOST_CHECK_EQUAL(pool.GetTransactionsUpdated(), initial + 4);
+
+    pool.clear();
+    BOOST_CHECK(pool.GetTransactionsUpdated() > initial + 4);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
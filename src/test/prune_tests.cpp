@@ -0,0 +1,260 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "chainparams.h"
+#include "clientversion.h"
+#include "consensus/merkle.h"
+#include "gridcoin/beacon.h"
+#include "gridcoin/voting/poll.h"
+#include "key.h"
+#include "main.h"
+#include "node/blockstorage.h"
+#include "node/prune.h"
+#include "streams.h"
+#include "txdb.h"
+#include "validation.h"
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+//! Block file for the test blocks, far from the files of the node.
+constexpr unsigned int TEST_FILE = 1000;
+
+CScript MakeScript()
+{
+    CKey key;
+    key.MakeNewKey(true);
+
+    CScript script;
+    script.SetDestination(key.GetPubKey().GetID());
+
+    return script;
+}
+
+CTransaction MakeCoinbase(const int height)
+{
+    CTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].prevout.SetNull();
+    tx.vin[0].scriptSig = CScript() << height;
+    tx.vout.resize(1);
+    tx.vout[0].SetEmpty();
+
+    return tx;
+}
+
+CTransaction MakeCoinstake(const COutPoint& prevout, const CAmount amount)
+{
+    CTransaction tx;
+    tx.vin.emplace_back(prevout);
+    tx.vout.resize(1);
+    tx.vout[0].SetEmpty();
+    tx.vout.emplace_back(amount, MakeScript());
+
+    return tx;
+}
+
+CTransaction MakePayment(const COutPoint& prevout, const std::vector<CAmount>& amounts)
+{
+    CTransaction tx;
+    tx.vin.emplace_back(prevout);
+
+    for (const auto& amount : amounts) {
+        tx.vout.emplace_back(amount, MakeScript());
+    }
+
+    return tx;
+}
+
+//!
+//! \brief Append a block to the test block file like WriteBlockToDisk() and
+//! index its transactions like ConnectBlock().
+//!
+void StoreTestBlock(CTxDB& txdb, CBlock& block, CBlockIndex& index, uint256& hash)
+{
+    block.nVersion = 11;
+    block.nTime = 1700000000 + index.nHeight;
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    hash = block.GetHash(true);
+    index.phashBlock = &hash;
+    index.nVersion = block.nVersion;
+    index.hashMerkleRoot = block.hashMerkleRoot;
+    index.nTime = block.nTime;
+    index.nBits = block.nBits;
+    index.nNonce = block.nNonce;
+    index.nFile = TEST_FILE;
+
+    CAutoFile file(OpenBlockFile(TEST_FILE, 0, "ab"), SER_DISK, CLIENT_VERSION);
+    BOOST_REQUIRE(!file.IsNull());
+
+    file << Params().MessageStart() << (unsigned int) GetSerializeSize(file, block);
+    index.nBlockPos = ftell(file.Get());
+    file << block;
+
+    unsigned int tx_pos = index.nBlockPos
+        + ::GetSerializeSize<CBlockHeader>(block, SER_DISK, CLIENT_VERSION)
+        + GetSizeOfCompactSize(block.vtx.size());
+
+    for (const auto& tx : block.vtx) {
+        BOOST_REQUIRE(txdb.UpdateTxIndex(tx.GetHash(), CTxIndex(CDiskTxPos(TEST_FILE, index.nBlockPos, tx_pos), tx.vout.size())));
+        tx_pos += ::GetSerializeSize(tx, SER_DISK, CLIENT_VERSION);
+    }
+}
+
+CTxIndex ReadIndex(CTxDB& txdb, const CTransaction& tx)
+{
+    CTxIndex txindex;
+    BOOST_REQUIRE(txdb.ReadTxIndex(tx.GetHash(), txindex));
+
+    return txindex;
+}
+
+void MarkSpent(CTxDB& txdb, const CTransaction& tx, const unsigned int n, const CDiskTxPos& spender)
+{
+    CTxIndex txindex = ReadIndex(txdb, tx);
+    txindex.vSpent[n] = spender;
+    BOOST_REQUIRE(txdb.UpdateTxIndex(tx.GetHash(), txindex));
+}
+
+//!
+//! \brief Read a transaction and its block header from a transaction index
+//! position the way that the stake kernel and the vote weight resolver do.
+//!
+void CheckReadableAt(const CTxIndex& txindex, const CTransaction& expected_tx, const uint256& expected_block)
+{
+    CTransaction tx;
+    BOOST_CHECK(ReadTxFromDisk(tx, txindex.pos));
+    BOOST_CHECK(tx.GetHash() == expected_tx.GetHash());
+
+    CBlock header;
+    BOOST_CHECK(ReadBlockFromDisk(header, txindex.pos.nFile, txindex.pos.nBlockPos, Params().GetConsensus(), false));
+    BOOST_CHECK(header.GetHash(true) == expected_block);
+}
+} // Anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(prune_tests)
+
+BOOST_AUTO_TEST_CASE(it_keeps_the_lookback_windows)
+{
+    const int64_t tip_time = 1700000000;
+    const int64_t limit = GetPruneTimeLimit(tip_time);
+
+    // The contract replay, the beacon age, and the poll duration start at
+    // most this far back from the tip:
+    BOOST_CHECK(limit <= tip_time - Params().GetConsensus().StandardContractReplayLookback);
+    BOOST_CHECK(limit <= tip_time - GRC::Beacon::MAX_AGE);
+    BOOST_CHECK(limit <= tip_time - int64_t {GRC::Poll::MAX_DURATION_DAYS} * 24 * 60 * 60);
+}
+
+BOOST_AUTO_TEST_CASE(it_relocates_what_staking_mrc_and_voting_need)
+{
+    LOCK(cs_main);
+    CTxDB txdb;
+
+    // An earlier transaction that the payment in the first block spends:
+    const CTransaction funding = MakePayment(COutPoint(uint256S("f"), 0), {5 * COIN});
+    BOOST_REQUIRE(txdb.UpdateTxIndex(funding.GetHash(), CTxIndex(CDiskTxPos(TEST_FILE - 1, 0, 0), 1)));
+
+    // The first block has an unspent coinstake output that can stake again
+    // and a payment with one unspent output that can carry vote weight:
+    CBlock block_a;
+    CBlockIndex index_a;
+    uint256 hash_a;
+    index_a.nHeight = 100;
+    block_a.vtx.push_back(MakeCoinbase(100));
+    block_a.vtx.push_back(MakeCoinstake(COutPoint(uint256S("a"), 1), 10 * COIN));
+    block_a.vtx.push_back(MakePayment(COutPoint(funding.GetHash(), 0), {2 * COIN, 3 * COIN}));
+    StoreTestBlock(txdb, block_a, index_a, hash_a);
+
+    // The second block spends everything that it creates:
+    CBlock block_b;
+    CBlockIndex index_b;
+    uint256 hash_b;
+    index_b.nHeight = 101;
+    block_b.vtx.push_back(MakeCoinbase(101));
+    block_b.vtx.push_back(MakeCoinstake(COutPoint(uint256S("b"), 1), 10 * COIN));
+    block_b.vtx.push_back(MakePayment(COutPoint(block_a.vtx[2].GetHash(), 0), {2 * COIN}));
+    StoreTestBlock(txdb, block_b, index_b, hash_b);
+
+    // The third block is a superblock with nothing left to spend:
+    CBlock block_s;
+    CBlockIndex index_s;
+    uint256 hash_s;
+    index_s.nHeight = 102;
+    index_s.MarkAsSuperblock();
+    block_s.vtx.push_back(MakeCoinbase(102));
+    block_s.vtx.push_back(MakeCoinstake(COutPoint(uint256S("c"), 1), 10 * COIN));
+    StoreTestBlock(txdb, block_s, index_s, hash_s);
+
+    const CDiskTxPos later_spend(TEST_FILE + 1, 0, 0);
+    const CTxIndex old_payment_a = ReadIndex(txdb, block_a.vtx[2]);
+    const CTxIndex old_payment_b = ReadIndex(txdb, block_b.vtx[2]);
+
+    MarkSpent(txdb, funding, 0, old_payment_a.pos);
+    MarkSpent(txdb, block_a.vtx[2], 0, old_payment_b.pos);
+    MarkSpent(txdb, block_b.vtx[1], 1, later_spend);
+    MarkSpent(txdb, block_b.vtx[2], 0, later_spend);
+    MarkSpent(txdb, block_s.vtx[1], 1, later_spend);
+
+    BOOST_REQUIRE(PruneBlockFile(txdb, TEST_FILE, {&index_a, &index_b, &index_s}));
+
+    BOOST_CHECK(IsBlockFilePruned(TEST_FILE));
+    BOOST_CHECK(!fs::exists(BlockFilePath(TEST_FILE)));
+
+    // The pruned blocks refuse to load:
+    CBlock block;
+    BOOST_CHECK(IsBlockPruned(&index_a));
+    BOOST_CHECK(IsBlockPruned(&index_b));
+    BOOST_CHECK(!ReadBlockFromDisk(block, &index_a, Params().GetConsensus()));
+
+    // Staking: the unspent coinstake output and its block header remain for
+    // the stake kernel and the coin age:
+    const CTxIndex coinstake_a = ReadIndex(txdb, block_a.vtx[1]);
+    BOOST_CHECK(coinstake_a.pos.nFile != TEST_FILE);
+    CheckReadableAt(coinstake_a, block_a.vtx[1], hash_a);
+
+    // Voting: the unspent payment output remains for the vote weight, and
+    // the spent marker of its input follows the relocated copy:
+    const CTxIndex payment_a = ReadIndex(txdb, block_a.vtx[2]);
+    BOOST_CHECK(payment_a.pos.nFile != TEST_FILE);
+    BOOST_CHECK(payment_a.vSpent[0] == old_payment_b.pos);
+    BOOST_CHECK(payment_a.vSpent[1].IsNull());
+    CheckReadableAt(payment_a, block_a.vtx[2], hash_a);
+    BOOST_CHECK(ReadIndex(txdb, funding).vSpent[0] == payment_a.pos);
+
+    // The stub holds only the kept transactions under the original header:
+    BOOST_CHECK(ReadBlockFromDisk(block, payment_a.pos.nFile, payment_a.pos.nBlockPos, Params().GetConsensus()));
+    BOOST_CHECK(block.GetHash(true) == hash_a);
+    BOOST_CHECK_EQUAL(block.vtx.size(), 2U);
+    BOOST_CHECK(IsRelocatedBlock(block));
+
+    // Fully spent transactions are gone:
+    CTransaction tx;
+    BOOST_CHECK(ReadIndex(txdb, block_b.vtx[2]).pos == old_payment_b.pos);
+    BOOST_CHECK(!ReadTxFromDisk(tx, old_payment_b.pos));
+    BOOST_CHECK(ReadIndex(txdb, block_a.vtx[0]).pos.nFile == TEST_FILE);
+
+    // MRC and the tally: the superblock moves whole with its index entry:
+    BOOST_CHECK(!IsBlockPruned(&index_s));
+    BOOST_CHECK(ReadBlockFromDisk(block, &index_s, Params().GetConsensus()));
+    BOOST_CHECK(block.GetHash(true) == hash_s);
+    BOOST_CHECK(!IsRelocatedBlock(block));
+    BOOST_CHECK(ReadIndex(txdb, block_s.vtx[1]).pos.nBlockPos == index_s.nBlockPos);
+
+    CDiskBlockIndex disk_index;
+    BOOST_CHECK(txdb.ReadBlockIndex(hash_s, disk_index));
+    BOOST_CHECK_EQUAL(disk_index.nFile, index_s.nFile);
+    BOOST_CHECK_EQUAL(disk_index.nBlockPos, index_s.nBlockPos);
+
+    // The pruned file set survives a restart:
+    BOOST_CHECK(LoadPrunedBlockFiles(txdb));
+    BOOST_CHECK(IsBlockFilePruned(TEST_FILE));
+
+    // Leave no pruned files for the other tests:
+    BOOST_CHECK(txdb.EraseGenericSerializable(std::string("prunedfiles")));
+    BOOST_CHECK(LoadPrunedBlockFiles(txdb));
+    BOOST_CHECK(!HavePrunedBlocks());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -7,10 +7,14 @@
 #include <rpc/client.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
+#include <rpc/workqueue.h>
 
 #include <univalue.h>
 
+#include <future>
+#include <sstream>
 #include <stdexcept>
+#include <thread>
 
 using namespace std;
 
@@ -119,4 +123,200 @@ BOOST_AUTO_TEST_CASE(rpc_parse_monetary_values)
     BOOST_CHECK_EQUAL(AmountFromValue(ValueFromString("20999999.99999999")), 2099999999999999LL);
 }
 
+BOOST_AUTO_TEST_CASE(rpc_marks_only_read_only_commands_concurrent)
+{
+    BOOST_CHECK(tableRPC["getblock"]->concurrent);
+    BOOST_CHECK(tableRPC["getblockhash"]->concurrent);
+    BOOST_CHECK(tableRPC["gettransaction"]->concurrent);
+
+    BOOST_CHECK(!tableRPC["sendtoaddress"]->concurrent);
+    BOOST_CHECK(!tableRPC["getnewaddress"]->concurrent);
+    BOOST_CHECK(!tableRPC["walletpassphrase"]->concurrent);
+    BOOST_CHECK(!tableRPC["stop"]->concurrent);
+}
+
+BOOST_AUTO_TEST_CASE(rpc_json_writers_match_univalue_serialization)
+{
+    UniValue block(UniValue::VOBJ);
+    block.pushKV("hash", "00ff");
+    block.pushKV("height", 42);
+    block.pushKV("tx", UniValue(UniValue::VARR));
+    block.pushKV("escaped \"key\"", "line\nbreak");
+
+    UniValue blocks(UniValue::VARR);
+    blocks.push_back(block);
+    blocks.push_back(block);
+
+    UniValue expected(UniValue::VOBJ);
+    expected.pushKV("block_count", 2);
+    expected.pushKV("blocks", blocks);
+    expected.pushKV("empty", UniValue(UniValue::VOBJ));
+
+    const auto write = [&](JSONWriter& writer) {
+        writer.BeginObject();
+        writer.PushKV("block_count", 2);
+        writer.Key("blocks");
+        writer.BeginArray();
+        writer.Value(block);
+        writer.Value(block);
+        writer.EndArray();
+        writer.Key("empty");
+        writer.BeginObject();
+        writer.EndObject();
+        writer.EndObject();
+    };
+
+    UniValueWriter tree_writer;
+    write(tree_writer);
+    BOOST_CHECK_EQUAL(tree_writer.Release().write(), expected.write());
+
+    // A tiny buffer passes each element to the sink separately:
+    std::vector<std::string> pieces;
+    JSONStreamWriter stream_writer([&](const std::string& data) { pieces.push_back(data); }, 1);
+    write(stream_writer);
+    stream_writer.Flush();
+
+    std::string streamed;
+    for (const auto& piece : pieces) streamed += piece;
+
+    BOOST_CHECK(pieces.size() > 1);
+    BOOST_CHECK_EQUAL(streamed, expected.write());
+    BOOST_CHECK_EQUAL(stream_writer.GetBytesFlushed(), streamed.size());
+}
+
+BOOST_AUTO_TEST_CASE(rpc_read_chunked_http_reply)
+{
+    const std::string body = "{\"result\":[1,2,3],\"error\":null,\"id\":1}";
+
+    std::istringstream stream(
+        HTTPChunkedReplyHeader(HTTP_OK, true).substr(HTTPChunkedReplyHeader(HTTP_OK, true).find("\r\n") + 2)
+        + HTTPChunk(body.substr(0, 10))
+        + HTTPChunk(body.substr(10))
+        + HTTPChunk(""));
+
+    std::map<std::string, std::string> headers;
+    std::string message;
+
+    BOOST_CHECK_EQUAL(ReadHTTPMessage(stream, headers, message, 1), HTTP_OK);
+    BOOST_CHECK_EQUAL(headers["transfer-encoding"], "chunked");
+    BOOST_CHECK_EQUAL(message, body);
+}
+
+BOOST_AUTO_TEST_CASE(rpc_parse_pipelined_http_requests)
+{
+    const std::string body = "{\"method\":\"getblockcount\",\"params\":[],\"id\":1}";
+    const std::string message = "POST / HTTP/1.1\r\n"
+                                "Authorization: Basic dXNlcjpwYXNz\r\n"
+                                "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                                "\r\n" + body;
+
+    HTTPRequest request;
+
+    // A partial request consumes nothing:
+    std::string buffer = message.substr(0, message.size() - 5);
+    BOOST_CHECK(ParseHTTPRequest(buffer, request) == HTTPParseResult::INCOMPLETE);
+    BOOST_CHECK_EQUAL(buffer.size(), message.size() - 5);
+
+    // Two pipelined requests parse one at a time:
+    buffer = message + message;
+    BOOST_CHECK(ParseHTTPRequest(buffer, request) == HTTPParseResult::COMPLETE);
+    BOOST_CHECK_EQUAL(buffer, message);
+    BOOST_CHECK_EQUAL(request.m_method, "POST");
+    BOOST_CHECK_EQUAL(request.m_uri, "/");
+    BOOST_CHECK_EQUAL(request.m_proto, 1);
+    BOOST_CHECK_EQUAL(request.m_body, body);
+    BOOST_CHECK_EQUAL(request.m_headers["authorization"], "Basic dXNlcjpwYXNz");
+    BOOST_CHECK(request.KeepAlive());
+
+    BOOST_CHECK(ParseHTTPRequest(buffer, request) == HTTPParseResult::COMPLETE);
+    BOOST_CHECK(buffer.empty());
+
+    buffer = "POST / HTTP/1.0\r\nConnection: close\r\n\r\n";
+    BOOST_CHECK(ParseHTTPRequest(buffer, request) == HTTPParseResult::COMPLETE);
+    BOOST_CHECK(!request.KeepAlive());
+
+    buffer = "DELETE / HTTP/1.1\r\n\r\n";
+    BOOST_CHECK(ParseHTTPRequest(buffer, request) == HTTPParseResult::INVALID);
+
+    buffer = "POST / HTTP/1.1\r\nContent-Length: x\r\n\r\n";
+    BOOST_CHECK(ParseHTTPRequest(buffer, request) == HTTPParseResult::INVALID);
+
+    buffer = "POST / HTTP/1.1\r\n" + std::string(MAX_HTTP_HEADERS_SIZE, 'a');
+    BOOST_CHECK(ParseHTTPRequest(buffer, request) == HTTPParseResult::INVALID);
+}
+
+BOOST_AUTO_TEST_CASE(rpc_work_queue_rejects_requests_beyond_its_depth)
+{
+    RPCWorkQueue queue(2);
+
+    BOOST_CHECK(queue.Enqueue("getblockcount", []() { }));
+    BOOST_CHECK(queue.Enqueue("getblockcount", []() { }));
+    BOOST_CHECK(!queue.Enqueue("getblockcount", []() { }));
+    BOOST_CHECK_EQUAL(queue.GetDepth(), 2);
+    BOOST_CHECK_EQUAL(queue.GetRejectedCount(), 1);
+
+    queue.Interrupt();
+
+    BOOST_CHECK_EQUAL(queue.GetDepth(), 0);
+    BOOST_CHECK(!queue.Enqueue("getblockcount", []() { }));
+}
+
+BOOST_AUTO_TEST_CASE(rpc_work_queue_leaves_reserved_slots_to_other_requests)
+{
+    RPCWorkQueue queue(4);
+
+    // Optional work only takes the slots beyond the reserve:
+    BOOST_CHECK(queue.Enqueue("getblock", []() { }, 2));
+    BOOST_CHECK(queue.Enqueue("getblock", []() { }, 2));
+    BOOST_CHECK(!queue.Enqueue("getblock", []() { }, 2));
+    BOOST_CHECK_EQUAL(queue.GetRejectedCount(), 0);
+
+    BOOST_CHECK(queue.Enqueue("getblockcount", []() { }));
+    BOOST_CHECK(queue.Enqueue("getblockcount", []() { }));
+    BOOST_CHECK_EQUAL(queue.GetDepth(), 4);
+
+    queue.Interrupt();
+}
+
+BOOST_AUTO_TEST_CASE(rpc_work_queue_applies_method_limits)
+{
+    const auto limits = RPCWorkQueue::ParseMethodLimits({ "slow:1", "malformed", "zero:0" });
+
+    BOOST_REQUIRE_EQUAL(limits.size(), 1);
+    BOOST_CHECK_EQUAL(limits.at("slow"), 1);
+
+    RPCWorkQueue queue(16, limits);
+
+    std::promise<void> release_first_slow;
+    std::shared_future<void> release = release_first_slow.get_future().share();
+    std::promise<void> first_slow_started;
+    std::promise<void> fast_done;
+    std::atomic<bool> second_slow_started { false };
+
+    queue.Enqueue("slow", [&]() { first_slow_started.set_value(); release.wait(); });
+    queue.Enqueue("slow", [&]() { second_slow_started = true; });
+    queue.Enqueue("fast", [&]() { fast_done.set_value(); });
+
+    std::thread worker1(&RPCWorkQueue::Run, &queue);
+    std::thread worker2(&RPCWorkQueue::Run, &queue);
+
+    // The second worker skips the limited method and runs the fast request:
+    first_slow_started.get_future().wait();
+    fast_done.get_future().wait();
+    BOOST_CHECK(!second_slow_started);
+    BOOST_CHECK_EQUAL(queue.GetDepth(), 1);
+
+    release_first_slow.set_value();
+
+    while (queue.GetDepth() > 0) {
+        std::this_thread::yield();
+    }
+
+    queue.Interrupt();
+    worker1.join();
+    worker2.join();
+
+    BOOST_CHECK(second_slow_started);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
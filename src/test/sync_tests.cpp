@@ -4,8 +4,10 @@
 
 #include <sync.h>
 
+#include <algorithm>
 #include <mutex>
 #include <stdexcept>
+#include <thread>
 
 #include <boost/test/unit_test.hpp>
 
@@ -47,4 +49,51 @@ BOOST_AUTO_TEST_CASE(potential_deadlock_detected)
     #endif
 }
 
+BOOST_AUTO_TEST_CASE(lock_profiler_records_lock_sites)
+{
+    const bool prev_lock_profiling = g_lock_profiling;
+    g_lock_profiling = true;
+
+    CCriticalSection profiled_mutex;
+    const int lock_line = __LINE__ + 3;
+
+    for (int i = 0; i < 3; ++i) {
+        LOCK(profiled_mutex);
+    }
+
+    {
+        LOCK(profiled_mutex);
+        std::thread([&] { TRY_LOCK(profiled_mutex, locked); BOOST_CHECK(!locked); }).join();
+    }
+
+    g_lock_profiling = prev_lock_profiling;
+
+    const std::vector<LockSiteStats> stats = GetLockStats();
+
+    const auto find_site = [&](const int line) {
+        return std::find_if(stats.begin(), stats.end(), [&](const LockSiteStats& site) {
+            return site.name == "profiled_mutex" && site.line == line;
+        });
+    };
+
+    const auto loop_site = find_site(lock_line);
+    BOOST_REQUIRE(loop_site != stats.end());
+    BOOST_CHECK_EQUAL(loop_site->acquisitions, 3U);
+    BOOST_CHECK_EQUAL(loop_site->contended, 0U);
+    BOOST_CHECK(loop_site->total_hold_ns >= loop_site->max_hold_ns);
+
+    // The failed TRY_LOCK on the other thread counts in the merged statistics:
+    const auto try_site = find_site(lock_line + 5);
+    BOOST_REQUIRE(try_site != stats.end());
+    BOOST_CHECK_EQUAL(try_site->acquisitions, 0U);
+    BOOST_CHECK_EQUAL(try_site->try_failures, 1U);
+
+    ResetLockStats();
+
+    for (const auto& site : GetLockStats()) {
+        BOOST_CHECK_EQUAL(site.acquisitions, 0U);
+        BOOST_CHECK_EQUAL(site.try_failures, 0U);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
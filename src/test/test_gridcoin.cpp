@@ -44,6 +44,8 @@ struct TestingSetup {
         // Forces logger to log to the console, and also not log to the debug.log file.
         gArgs.ForceSetArg("-debuglogfile", "none");
         gArgs.SoftSetBoolArg("-printtoconsole", true);
+        // Keep log output in order with the test framework's output:
+        gArgs.SoftSetBoolArg("-logasync", false);
 
         InitLogging();
         ECC_Start();
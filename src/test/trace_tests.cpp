@@ -0,0 +1,137 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "util/trace.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+namespace {
+void TraceNested()
+{
+    TRACE_SPAN("trace_tests::outer");
+    {
+        TRACE_SPAN("trace_tests::inner");
+    }
+}
+
+std::vector<TraceSiteStats>::const_iterator FindSite(const std::vector<TraceSiteStats>& stats, const std::string& name)
+{
+    return std::find_if(stats.begin(), stats.end(), [&](const TraceSiteStats& site) {
+        return site.m_name == name;
+    });
+}
+} // Anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(trace_tests)
+
+BOOST_AUTO_TEST_CASE(histogram_buckets_cover_values_with_bounded_error)
+{
+    for (uint64_t value : {0, 1, 7, 8, 15, 16, 17, 1000, 123456789}) {
+        const int bucket = TraceHistogram::BucketFor(value);
+
+        BOOST_CHECK(TraceHistogram::BucketLowerBound(bucket) <= value);
+        BOOST_CHECK(TraceHistogram::BucketLowerBound(bucket + 1) > value);
+        BOOST_CHECK(value - TraceHistogram::BucketLowerBound(bucket) <= value / TraceHistogram::SUB_BUCKETS);
+    }
+
+    BOOST_CHECK_LT(TraceHistogram::BucketFor(UINT64_MAX), TraceHistogram::BUCKETS);
+}
+
+BOOST_AUTO_TEST_CASE(histogram_reports_quantiles)
+{
+    TraceHistogram histogram;
+
+    BOOST_CHECK_EQUAL(histogram.ValueAtQuantile(0.5), 0U);
+
+    for (int64_t value = 1; value <= 1000; ++value) {
+        histogram.Record(value);
+    }
+
+    BOOST_CHECK_EQUAL(histogram.Count(), 1000U);
+    BOOST_CHECK_EQUAL(histogram.Max(), 1000U);
+    BOOST_CHECK_EQUAL(histogram.Total(), 500500U);
+
+    const uint64_t p50 = histogram.ValueAtQuantile(0.5);
+    BOOST_CHECK(p50 >= 500 && p50 <= 500 + 500 / TraceHistogram::SUB_BUCKETS);
+    BOOST_CHECK_EQUAL(histogram.ValueAtQuantile(1.0), 1000U);
+
+    histogram.Reset();
+    BOOST_CHECK_EQUAL(histogram.Count(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(spans_record_nesting_when_enabled)
+{
+    ResetTracing();
+    TraceNested();
+
+    // Disabled tracing records nothing:
+    const std::vector<TraceSiteStats> disabled_stats = GetTraceStats();
+    BOOST_CHECK(FindSite(disabled_stats, "trace_tests::outer") == disabled_stats.end());
+
+    EnableTracing(true, 16, 0);
+    TraceNested();
+    TraceNested();
+    EnableTracing(false, 16, 0);
+
+    const std::vector<TraceSiteStats> stats = GetTraceStats();
+    const auto outer = FindSite(stats, "trace_tests::outer");
+    const auto inner = FindSite(stats, "trace_tests::inner");
+
+    BOOST_REQUIRE(outer != stats.end());
+    BOOST_REQUIRE(inner != stats.end());
+    BOOST_CHECK_EQUAL(outer->m_count, 2U);
+    BOOST_CHECK_EQUAL(inner->m_count, 2U);
+
+    // The inner span ends first:
+    const std::vector<TraceSpanRecord> spans = GetRecentSpans();
+
+    BOOST_REQUIRE_EQUAL(spans.size(), 4U);
+    BOOST_CHECK_EQUAL(spans[0].m_name, "trace_tests::inner");
+    BOOST_CHECK_EQUAL(spans[0].m_parent, "trace_tests::outer");
+    BOOST_CHECK_EQUAL(spans[0].m_depth, 1);
+    BOOST_CHECK_EQUAL(spans[1].m_name, "trace_tests::outer");
+    BOOST_CHECK(spans[1].m_parent == nullptr);
+    BOOST_CHECK_EQUAL(spans[1].m_depth, 0);
+
+    // A zero threshold keeps every span as slow:
+    BOOST_CHECK_EQUAL(GetSlowSpans().size(), 4U);
+
+    std::ostringstream out;
+    WriteChromeTrace(out);
+
+    BOOST_CHECK(out.str().find("\"traceEvents\"") != std::string::npos);
+    BOOST_CHECK(out.str().find("\"name\":\"trace_tests::inner\"") != std::string::npos);
+
+    ResetTracing();
+    BOOST_CHECK(GetRecentSpans().empty());
+
+    const std::vector<TraceSiteStats> reset_stats = GetTraceStats();
+    BOOST_CHECK(FindSite(reset_stats, "trace_tests::outer") == reset_stats.end());
+}
+
+BOOST_AUTO_TEST_CASE(span_ring_keeps_the_most_recent_spans)
+{
+    ResetTracing();
+    EnableTracing(true, 3, 0);
+
+    for (int i = 0; i < 5; ++i) {
+        TraceNested();
+    }
+
+    EnableTracing(false, 3, 0);
+
+    const std::vector<TraceSpanRecord> spans = GetRecentSpans();
+
+    BOOST_REQUIRE_EQUAL(spans.size(), 3U);
+    BOOST_CHECK_EQUAL(spans[0].m_name, "trace_tests::outer");
+    BOOST_CHECK_EQUAL(spans[1].m_name, "trace_tests::inner");
+    BOOST_CHECK_EQUAL(spans[2].m_name, "trace_tests::outer");
+
+    ResetTracing();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
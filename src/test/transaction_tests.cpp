@@ -338,4 +338,48 @@ BOOST_AUTO_TEST_CASE(test_GetThrow)
     BOOST_CHECK_THROW(AreInputsStandard(t1, missingInputs), runtime_error);
 }
 
+BOOST_AUTO_TEST_CASE(it_caches_the_hash_only_for_the_same_object)
+{
+    CTransaction tx;
+    tx.vin.resize(1);
+    tx.vout.resize(1);
+    tx.vout[0].nValue = 10 * COIN;
+
+    const uint256 hash = tx.GetHash();
+
+    tx.CacheHash();
+    const uint64_t computations = CTransaction::GetHashComputations();
+
+    BOOST_CHECK(tx.GetHash() == hash);
+    BOOST_CHECK(tx.GetHash() == hash);
+    BOOST_CHECK_EQUAL(CTransaction::GetHashComputations(), computations);
+
+    // A copy starts without the cache and can change:
+    CTransaction copy(tx);
+    copy.vout[0].nValue = 20 * COIN;
+    BOOST_CHECK(copy.GetHash() != hash);
+
+    copy = tx;
+    BOOST_CHECK(copy.GetHash() == hash);
+    copy.vout[0].nValue = 20 * COIN;
+    BOOST_CHECK(copy.GetHash() != hash);
+
+    copy.CacheHash();
+    CTransaction moved(std::move(copy));
+    moved.vout[0].nValue = 10 * COIN;
+    BOOST_CHECK(moved.GetHash() == hash);
+
+    // Deserialization and SetNull() clear the cache:
+    moved.vout[0].nValue = 30 * COIN;
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+    stream << moved;
+    stream >> tx;
+    BOOST_CHECK(tx.GetHash() == moved.GetHash());
+    BOOST_CHECK(tx.GetHash() != hash);
+
+    tx.CacheHash();
+    tx.SetNull();
+    BOOST_CHECK(tx.GetHash() != moved.GetHash());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
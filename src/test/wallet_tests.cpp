@@ -1,7 +1,10 @@
 #include <boost/test/unit_test.hpp>
 
 #include "gridcoin/sidestake.h"
+#include "init.h"
 #include "main.h"
+#include "test/test_gridcoin.h"
+#include "wallet/rescan.h"
 #include "wallet/wallet.h"
 
 // how many times to run all the tests to have a chance to catch errors that only show up with particular random shuffles
@@ -302,4 +305,129 @@ BOOST_AUTO_TEST_CASE(coin_selection_tests)
     empty_wallet();
 }
 
+BOOST_AUTO_TEST_CASE(it_tracks_unspent_transactions_incrementally)
+{
+    CWalletDB walletdb(pwalletMain->strWalletFile);
+    LOCK2(cs_main, pwalletMain->cs_wallet);
+
+    const size_t initial_count = pwalletMain->GetUnspentTxCount();
+
+    CKey key;
+    key.MakeNewKey(true);
+
+    CScript script;
+    script.SetDestination(key.GetPubKey().GetID());
+
+    CTransaction funding;
+    funding.nTime = 0;
+    funding.vin.emplace_back(COutPoint(InsecureRand256(), 0));
+    funding.vout.emplace_back(COIN, script);
+
+    // The output does not belong to the wallet until it knows the key:
+    pwalletMain->AddToWallet(CWalletTx(pwalletMain, funding), &walletdb);
+    BOOST_CHECK_EQUAL(pwalletMain->GetUnspentTxCount(), initial_count);
+
+    // Importing the key claims the output of the existing transaction:
+    BOOST_REQUIRE(pwalletMain->AddKey(key));
+    pwalletMain->MarkDirty();
+    BOOST_CHECK_EQUAL(pwalletMain->GetUnspentTxCount(), initial_count + 1);
+
+    CTransaction spend;
+    spend.nTime = 0;
+    spend.vin.emplace_back(COutPoint(funding.GetHash(), 0));
+    spend.vout.emplace_back(COIN / 2, CScript() << OP_TRUE);
+
+    // Spending the only output of ours removes the funding transaction:
+    pwalletMain->AddToWallet(CWalletTx(pwalletMain, spend), &walletdb);
+    BOOST_CHECK(pwalletMain->mapWallet.at(funding.GetHash()).IsSpent(0));
+    BOOST_CHECK_EQUAL(pwalletMain->GetUnspentTxCount(), initial_count);
+
+    BOOST_CHECK(pwalletMain->EraseFromWallet(spend.GetHash()));
+    BOOST_CHECK(pwalletMain->EraseFromWallet(funding.GetHash()));
+    BOOST_CHECK_EQUAL(pwalletMain->GetUnspentTxCount(), initial_count);
+}
+
+BOOST_AUTO_TEST_CASE(rescan_filter_matches_wallet_transactions)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    BOOST_REQUIRE(pwalletMain->AddKey(key));
+
+    CScript script;
+    script.SetDestination(key.GetPubKey().GetID());
+
+    CTransaction to_wallet;
+    to_wallet.nTime = 0;
+    to_wallet.vin.emplace_back(COutPoint(InsecureRand256(), 0));
+    to_wallet.vout.emplace_back(COIN, script);
+
+    CTransaction unrelated;
+    unrelated.nTime = 0;
+    unrelated.vin.emplace_back(COutPoint(InsecureRand256(), 0));
+    unrelated.vout.emplace_back(COIN, CScript() << OP_TRUE);
+
+    {
+        const wallet::RescanFilter filter(*pwalletMain);
+
+        BOOST_CHECK(filter.Matches(to_wallet));
+        BOOST_CHECK(!filter.Matches(unrelated));
+    }
+
+    CWalletDB walletdb(pwalletMain->strWalletFile);
+    pwalletMain->AddToWallet(CWalletTx(pwalletMain, to_wallet), &walletdb);
+
+    CTransaction spend;
+    spend.nTime = 0;
+    spend.vin.emplace_back(COutPoint(to_wallet.GetHash(), 0));
+    spend.vout.emplace_back(COIN / 2, CScript() << OP_TRUE);
+
+    {
+        // A transaction that spends from a wallet transaction matches even
+        // when none of its outputs belong to the wallet:
+        const wallet::RescanFilter filter(*pwalletMain);
+
+        BOOST_CHECK(filter.Matches(spend));
+    }
+
+    BOOST_CHECK(pwalletMain->EraseFromWallet(to_wallet.GetHash()));
+}
+
+BOOST_AUTO_TEST_CASE(it_recalculates_time_locked_balances_when_the_time_changes)
+{
+    CWalletDB walletdb(pwalletMain->strWalletFile);
+    LOCK2(cs_main, pwalletMain->cs_wallet);
+
+    const int64_t now = GetAdjustedTime();
+    SetMockTime(now);
+
+    CKey key;
+    key.MakeNewKey(true);
+    BOOST_REQUIRE(pwalletMain->AddKey(key));
+
+    CScript script;
+    script.SetDestination(key.GetPubKey().GetID());
+
+    // A non-final input makes the lock time apply:
+    CTransaction locked;
+    locked.nTime = 0;
+    locked.nLockTime = now + 100;
+    locked.vin.emplace_back(COutPoint(InsecureRand256(), 0));
+    locked.vin[0].nSequence = 0;
+    locked.vout.emplace_back(COIN, script);
+
+    const CAmount initial_unconfirmed = pwalletMain->GetUnconfirmedBalance();
+
+    pwalletMain->AddToWallet(CWalletTx(pwalletMain, locked), &walletdb);
+
+    // The transaction is not final yet, so the wallet counts it as unconfirmed:
+    BOOST_CHECK_EQUAL(pwalletMain->GetUnconfirmedBalance(), initial_unconfirmed + COIN);
+
+    // Once the lock time passes, the memoized balance must not hide the change:
+    SetMockTime(now + 200);
+    BOOST_CHECK_EQUAL(pwalletMain->GetUnconfirmedBalance(), initial_unconfirmed);
+
+    BOOST_CHECK(pwalletMain->EraseFromWallet(locked.GetHash()));
+    SetMockTime(0);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,425 @@
+// Copyright (c) 2009-2010 Satoshi Nakamoto
+// Copyright (c) 2009-2012 The Bitcoin developers
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "txmempool.h"
+#include "gridcoin/contract/contract.h"
+#include "gridcoin/mrc.h"
+#include "main.h"
+#include "serialize.h"
+#include "util/time.h"
+#include "version.h"
+
+CTxMemPool mempool;
+
+namespace {
+//!
+//! \brief Approximate bookkeeping overhead of a single node in one of the
+//! ordered containers that the pool uses for its indexes.
+//!
+constexpr size_t INDEX_NODE_OVERHEAD = 4 * sizeof(void*) + sizeof(uint256) + sizeof(int64_t);
+
+const std::set<uint256> EMPTY_HASH_SET;
+} // anonymous namespace
+
+// -----------------------------------------------------------------------------
+// Class: CTxMemPoolEntry
+// -----------------------------------------------------------------------------
+
+CTxMemPoolEntry::CTxMemPoolEntry(const CTransaction& tx, const CAmount fee, const int64_t time)
+    : m_tx(tx)
+    , m_hash(tx.GetHash())
+    , m_fee(fee)
+    , m_modified_fee(fee)
+    , m_tx_size(::GetSerializeSize(tx, SER_NETWORK, PROTOCOL_VERSION))
+    , m_time(time)
+{
+    for (const auto& contract : m_tx.GetContracts()) {
+        m_contract_types |= 1 << static_cast<int>(contract.m_type.Value());
+
+        if (contract.m_type == GRC::ContractType::MRC) {
+            const auto& mrc = *contract.SharePayloadAs<GRC::MRC>();
+
+            if (const GRC::CpidOption cpid = mrc.m_mining_id.TryCpid()) {
+                m_mrc_cpids.push_back(*cpid);
+            }
+
+            // The staker that binds the MRC collects the part of the MRC fee
+            // that is not allocated to the foundation:
+            const Fraction foundation_fee_fraction = FoundationSideStakeAllocation();
+
+            m_mrc_fee = mrc.m_fee;
+            m_modified_fee += mrc.m_fee - mrc.m_fee * foundation_fee_fraction.GetNumerator()
+                                                    / foundation_fee_fraction.GetDenominator();
+        }
+    }
+
+    // This is a more accurate fee-per-kilobyte than is used by the client code,
+    // because the client code rounds up the size to the nearest 1K. That gives
+    // an incentive to create smaller transactions.
+    m_fee_per_kb = (double)m_modified_fee / (double(m_tx_size) / 1000.0);
+
+    m_size_with_ancestors = m_tx_size;
+    m_mod_fees_with_ancestors = m_modified_fee;
+
+    // The entry itself, the transaction vectors, one mapNextTx node per input,
+    // and one node in each of the fee rate, ancestor score, entry time and
+    // by-hash indexes:
+    m_usage = sizeof(CTxMemPoolEntry)
+        + m_tx_size
+        + m_tx.vin.capacity() * sizeof(CTxIn)
+        + m_tx.vout.capacity() * sizeof(CTxOut)
+        + m_tx.vin.size() * (INDEX_NODE_OVERHEAD + sizeof(COutPoint) + sizeof(CInPoint))
+        + 4 * INDEX_NODE_OVERHEAD;
+}
+
+double CTxMemPoolEntry::GetPackageScore(const CAmount package_fees, const uint64_t package_size) const
+{
+    return std::min(m_fee_per_kb, (double)package_fees / (double(package_size) / 1000.0));
+}
+
+// -----------------------------------------------------------------------------
+// Class: CTxMemPool
+// -----------------------------------------------------------------------------
+
+bool CTxMemPool::addUnchecked(const uint256& hash, const CTransaction& tx, const CAmount fee, int64_t time)
+{
+    // Add to memory pool without checking anything.  Don't call this directly,
+    // call AcceptToMemoryPool to properly check the transaction first.
+    LOCK(cs);
+
+    if (time == 0) {
+        time = GetTime();
+    }
+
+    auto inserted = mapTx.emplace(hash, CTxMemPoolEntry(tx, fee, time));
+
+    if (!inserted.second) {
+        return false;
+    }
+
+    CTxMemPoolEntry& entry = inserted.first->second;
+    entry.m_tx.CacheHash();
+
+    for (unsigned int i = 0; i < entry.m_tx.vin.size(); i++) {
+        const COutPoint& prevout = entry.m_tx.vin[i].prevout;
+
+        mapNextTx[prevout] = CInPoint(&entry.m_tx, i);
+
+        auto parent = mapTx.find(prevout.hash);
+
+        if (parent != mapTx.end()) {
+            entry.m_parents.insert(prevout.hash);
+            parent->second.m_children.insert(hash);
+        }
+    }
+
+    // A transaction resurrected from a disconnected block can enter the pool
+    // after the transactions that spend it:
+    for (unsigned int i = 0; i < entry.m_tx.vout.size(); i++) {
+        const auto spender = mapNextTx.find(COutPoint(hash, i));
+
+        if (spender == mapNextTx.end()) {
+            continue;
+        }
+
+        const uint256 child_hash = spender->second.ptx->GetHash();
+        auto child = mapTx.find(child_hash);
+
+        if (child != mapTx.end()) {
+            entry.m_children.insert(child_hash);
+            child->second.m_parents.insert(hash);
+        }
+    }
+
+    // The ancestors of a new entry are its in-pool parents and their ancestors:
+    for (const auto& parent_hash : entry.m_parents) {
+        const CTxMemPoolEntry& parent = mapTx.at(parent_hash);
+
+        entry.m_ancestors.insert(parent_hash);
+        entry.m_ancestors.insert(parent.m_ancestors.begin(), parent.m_ancestors.end());
+    }
+
+    for (const auto& ancestor_hash : entry.m_ancestors) {
+        const CTxMemPoolEntry& ancestor = mapTx.at(ancestor_hash);
+
+        entry.m_size_with_ancestors += ancestor.m_tx_size;
+        entry.m_mod_fees_with_ancestors += ancestor.m_modified_fee;
+    }
+
+    // Everything that descends from a resurrected entry gains the entry and its
+    // ancestors as ancestors:
+    if (!entry.m_children.empty()) {
+        std::set<uint256> descendants;
+        CalculateDescendants(hash, descendants);
+
+        std::set<uint256> new_ancestors = entry.m_ancestors;
+        new_ancestors.insert(hash);
+
+        for (const auto& descendant_hash : descendants) {
+            if (descendant_hash == hash) {
+                continue;
+            }
+
+            CTxMemPoolEntry& descendant = mapTx.at(descendant_hash);
+
+            m_by_ancestor_score.erase(std::make_pair(descendant.GetAncestorScore(), descendant_hash));
+
+            for (const auto& ancestor_hash : new_ancestors) {
+                if (descendant.m_ancestors.insert(ancestor_hash).second) {
+                    const CTxMemPoolEntry& ancestor = mapTx.at(ancestor_hash);
+
+                    descendant.m_size_with_ancestors += ancestor.m_tx_size;
+                    descendant.m_mod_fees_with_ancestors += ancestor.m_modified_fee;
+                }
+            }
+
+            m_by_ancestor_score.emplace(descendant.GetAncestorScore(), descendant_hash);
+        }
+    }
+
+    m_by_fee_rate.emplace(entry.m_fee_per_kb, hash);
+    m_by_ancestor_score.emplace(entry.GetAncestorScore(), hash);
+    m_by_entry_time.emplace(entry.m_time, hash);
+
+    for (const auto& type : GRC::CONTRACT_TYPES) {
+        if (entry.HasContractType(type)) {
+            m_by_contract_type[type].insert(hash);
+        }
+    }
+
+    for (const auto& cpid : entry.m_mrc_cpids) {
+        m_mrc_by_cpid.emplace(cpid, hash);
+    }
+
+    if (entry.HasContractType(GRC::ContractType::MRC)) {
+        m_mrc_by_fee.emplace(entry.m_mrc_fee, hash);
+    }
+
+    m_total_usage += entry.m_usage;
+    ++m_transactions_updated;
+
+    return true;
+}
+
+void CTxMemPool::CalculateDescendants(const uint256& hash, std::set<uint256>& descendants) const
+{
+    std::vector<uint256> stage { hash };
+
+    while (!stage.empty()) {
+        const uint256 next = stage.back();
+        stage.pop_back();
+
+        if (!descendants.insert(next).second) {
+            continue;
+        }
+
+        const auto iter = mapTx.find(next);
+
+        if (iter == mapTx.end()) {
+            continue;
+        }
+
+        for (const auto& child_hash : iter->second.m_children) {
+            stage.push_back(child_hash);
+        }
+    }
+}
+
+void CTxMemPool::RemoveUnchecked(std::map<uint256, CTxMemPoolEntry>::iterator iter)
+{
+    const uint256 hash = iter->first;
+    const CTxMemPoolEntry& entry = iter->second;
+
+    for (const auto& txin : entry.m_tx.vin) {
+        mapNextTx.erase(txin.prevout);
+    }
+
+    for (const auto& parent_hash : entry.m_parents) {
+        auto parent = mapTx.find(parent_hash);
+
+        if (parent != mapTx.end()) {
+            parent->second.m_children.erase(hash);
+        }
+    }
+
+    // Detach the entry from the ancestor sets of everything that descends from
+    // it. This happens when a parent leaves the pool because a block confirms
+    // it while its children remain:
+    std::set<uint256> descendants;
+    CalculateDescendants(hash, descendants);
+
+    for (const auto& descendant_hash : descendants) {
+        if (descendant_hash == hash) {
+            continue;
+        }
+
+        CTxMemPoolEntry& descendant = mapTx.at(descendant_hash);
+
+        if (descendant.m_ancestors.count(hash)) {
+            m_by_ancestor_score.erase(std::make_pair(descendant.GetAncestorScore(), descendant_hash));
+
+            descendant.m_ancestors.erase(hash);
+            descendant.m_size_with_ancestors -= entry.m_tx_size;
+            descendant.m_mod_fees_with_ancestors -= entry.m_modified_fee;
+
+            m_by_ancestor_score.emplace(descendant.GetAncestorScore(), descendant_hash);
+        }
+
+        descendant.m_parents.erase(hash);
+    }
+
+    m_by_fee_rate.erase(std::make_pair(entry.m_fee_per_kb, hash));
+    m_by_ancestor_score.erase(std::make_pair(entry.GetAncestorScore(), hash));
+    m_by_entry_time.erase(std::make_pair(entry.m_time, hash));
+
+    for (auto& [_, hashes] : m_by_contract_type) {
+        hashes.erase(hash);
+    }
+
+    for (const auto& cpid : entry.m_mrc_cpids) {
+        auto mrc_iter = m_mrc_by_cpid.find(cpid);
+
+        if (mrc_iter != m_mrc_by_cpid.end() && mrc_iter->second == hash) {
+            m_mrc_by_cpid.erase(mrc_iter);
+        }
+    }
+
+    m_mrc_by_fee.erase(std::make_pair(entry.m_mrc_fee, hash));
+
+    m_total_usage -= entry.m_usage;
+    ++m_transactions_updated;
+
+    mapTx.erase(iter);
+}
+
+bool CTxMemPool::remove(const CTransaction &tx, bool fRecursive)
+{
+    // Remove transaction from memory pool
+    {
+        LOCK(cs);
+        uint256 hash = tx.GetHash();
+        if (mapTx.count(hash))
+        {
+            if (fRecursive) {
+                for (unsigned int i = 0; i < tx.vout.size(); i++) {
+                    std::map<COutPoint, CInPoint>::iterator it = mapNextTx.find(COutPoint(hash, i));
+                    if (it != mapNextTx.end())
+                        remove(*it->second.ptx, true);
+                }
+            }
+            RemoveUnchecked(mapTx.find(hash));
+        }
+    }
+    return true;
+}
+
+bool CTxMemPool::removeConflicts(const CTransaction &tx)
+{
+    // Remove transactions which depend on inputs of tx, recursively
+    LOCK(cs);
+    for (auto const &txin : tx.vin)
+    {
+        std::map<COutPoint, CInPoint>::iterator it = mapNextTx.find(txin.prevout);
+        if (it != mapNextTx.end()) {
+            const CTransaction &txConflict = *it->second.ptx;
+            if (txConflict != tx)
+                remove(txConflict, true);
+        }
+    }
+    return true;
+}
+
+void CTxMemPool::clear()
+{
+    LOCK(cs);
+    mapTx.clear();
+    mapNextTx.clear();
+    m_by_fee_rate.clear();
+    m_by_ancestor_score.clear();
+    m_by_entry_time.clear();
+    m_by_contract_type.clear();
+    m_mrc_by_cpid.clear();
+    m_mrc_by_fee.clear();
+    m_total_usage = 0;
+    ++m_transactions_updated;
+}
+
+void CTxMemPool::queryHashes(std::vector<uint256>& vtxid)
+{
+    vtxid.clear();
+
+    LOCK(cs);
+    vtxid.reserve(mapTx.size());
+    for (const auto& [hash, _] : mapTx)
+        vtxid.push_back(hash);
+}
+
+void CTxMemPool::TrimToSize(const size_t limit, std::vector<uint256>* removed)
+{
+    LOCK(cs);
+
+    while (!m_by_fee_rate.empty() && m_total_usage > limit) {
+        std::set<uint256> stage;
+        CalculateDescendants(m_by_fee_rate.rbegin()->second, stage);
+
+        for (const auto& hash : stage) {
+            auto iter = mapTx.find(hash);
+
+            if (iter == mapTx.end()) continue;
+
+            if (removed) {
+                removed->push_back(hash);
+            }
+
+            RemoveUnchecked(iter);
+        }
+    }
+}
+
+size_t CTxMemPool::Expire(const int64_t time)
+{
+    LOCK(cs);
+
+    std::set<uint256> stage;
+
+    for (const auto& [entry_time, hash] : m_by_entry_time) {
+        if (entry_time >= time) break;
+
+        CalculateDescendants(hash, stage);
+    }
+
+    for (const auto& hash : stage) {
+        auto iter = mapTx.find(hash);
+
+        if (iter != mapTx.end()) {
+            RemoveUnchecked(iter);
+        }
+    }
+
+    return stage.size();
+}
+
+const CTxMemPoolEntry* CTxMemPool::GetEntry(const uint256& hash) const
+{
+    const auto iter = mapTx.find(hash);
+
+    if (iter == mapTx.end()) {
+        return nullptr;
+    }
+
+    return &iter->second;
+}
+
+const std::set<uint256>& CTxMemPool::GetByContractType(const GRC::ContractType type) const
+{
+    const auto iter = m_by_contract_type.find(type);
+
+    if (iter == m_by_contract_type.end()) {
+        return EMPTY_HASH_SET;
+    }
+
+    return iter->second;
+}
@@ -0,0 +1,356 @@
+// Copyright (c) 2009-2010 Satoshi Nakamoto
+// Copyright (c) 2009-2012 The Bitcoin developers
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_TXMEMPOOL_H
+#define BITCOIN_TXMEMPOOL_H
+
+#include "amount.h"
+#include "gridcoin/contract/payload.h"
+#include "gridcoin/cpid.h"
+#include "primitives/transaction.h"
+#include "sync.h"
+#include "uint256.h"
+
+#include <functional>
+#include <map>
+#include <set>
+#include <vector>
+
+//! Default for -maxmempool, maximum megabytes of memory pool memory usage.
+static const unsigned int DEFAULT_MAX_MEMPOOL_SIZE = 300;
+//! Default for -mempoolexpiry, expiration time for memory pool transactions in hours.
+static const unsigned int DEFAULT_MEMPOOL_EXPIRY = 336;
+//! Interval in seconds between the removals of expired memory pool transactions.
+static const unsigned int MEMPOOL_EXPIRY_INTERVAL = 10 * 60;
+
+//!
+//! \brief A transaction in the memory pool together with the metadata that the
+//! pool indexes it by.
+//!
+//! Entries are immutable once added to the pool except for the in-pool
+//! relationship fields which the pool updates as parents and children come and
+//! go. The fee values are computed once on acceptance so that consumers like
+//! block assembly do not need to read the transaction inputs back from disk to
+//! order the pool.
+//!
+class CTxMemPoolEntry
+{
+public:
+    //!
+    //! \brief Initialize a memory pool entry.
+    //!
+    //! \param tx   The accepted transaction.
+    //! \param fee  Value of the inputs minus the value of the outputs.
+    //! \param time Time that the transaction entered the pool.
+    //!
+    CTxMemPoolEntry(const CTransaction& tx, const CAmount fee, const int64_t time);
+
+    const CTransaction& GetTx() const { return m_tx; }
+    const uint256& GetHash() const { return m_hash; }
+
+    //!
+    //! \brief Get the fee paid by the transaction itself (inputs - outputs).
+    //!
+    CAmount GetFee() const { return m_fee; }
+
+    //!
+    //! \brief Get the fee that the staker of the block would collect for this
+    //! transaction.
+    //!
+    //! This includes the staker's share of the fee of a manual reward claim in
+    //! addition to the transaction fee.
+    //!
+    CAmount GetModifiedFee() const { return m_modified_fee; }
+
+    unsigned int GetTxSize() const { return m_tx_size; }
+    int64_t GetTime() const { return m_time; }
+
+    //!
+    //! \brief Get the modified fee per kilobyte used to order the pool.
+    //!
+    double GetFeePerKb() const { return m_fee_per_kb; }
+
+    //!
+    //! \brief Get the approximate number of bytes of memory used by the entry
+    //! and its index nodes.
+    //!
+    size_t GetUsage() const { return m_usage; }
+
+    //!
+    //! \brief Determine whether the transaction contains a contract of the
+    //! specified type.
+    //!
+    bool HasContractType(const GRC::ContractType type) const
+    {
+        return (m_contract_types & (1 << static_cast<int>(type))) != 0;
+    }
+
+    //!
+    //! \brief Get the CPIDs of the manual reward claims in the transaction.
+    //!
+    const std::vector<GRC::Cpid>& GetMRCCpids() const { return m_mrc_cpids; }
+
+    //!
+    //! \brief Get the fee of the manual reward claim in the transaction, if any.
+    //!
+    CAmount GetMRCFee() const { return m_mrc_fee; }
+
+    //!
+    //! \brief Get the hashes of the in-pool transactions that this transaction
+    //! spends outputs of directly.
+    //!
+    const std::set<uint256>& GetParents() const { return m_parents; }
+
+    //!
+    //! \brief Get the hashes of the in-pool transactions that spend outputs of
+    //! this transaction directly.
+    //!
+    const std::set<uint256>& GetChildren() const { return m_children; }
+
+    //!
+    //! \brief Get the hashes of all in-pool transactions that must be included
+    //! in a block before this one.
+    //!
+    const std::set<uint256>& GetAncestors() const { return m_ancestors; }
+
+    uint64_t GetSizeWithAncestors() const { return m_size_with_ancestors; }
+    CAmount GetModFeesWithAncestors() const { return m_mod_fees_with_ancestors; }
+
+    //!
+    //! \brief Get the modified fee per kilobyte of a package of the transaction
+    //! and some of its ancestors, or of the transaction alone if that is lower.
+    //!
+    //! A transaction with a lower fee rate than its ancestors does not raise the
+    //! rate of the package, so it is ordered by its own rate.
+    //!
+    //! \param package_fees Modified fees of the package.
+    //! \param package_size Serialized size of the package.
+    //!
+    double GetPackageScore(const CAmount package_fees, const uint64_t package_size) const;
+
+    //!
+    //! \brief Get the score that orders the entry for block assembly: the fee
+    //! rate of the package of the transaction and all of its in-pool ancestors.
+    //!
+    double GetAncestorScore() const
+    {
+        return GetPackageScore(m_mod_fees_with_ancestors, m_size_with_ancestors);
+    }
+
+private:
+    friend class CTxMemPool;
+
+    CTransaction m_tx;             //!< The transaction.
+    uint256 m_hash;                //!< Cached hash of the transaction.
+    CAmount m_fee;                 //!< Inputs minus outputs.
+    CAmount m_modified_fee;        //!< Fee plus the staker's share of an MRC fee.
+    unsigned int m_tx_size;        //!< Serialized size of the transaction.
+    int64_t m_time;                //!< Time of entry into the pool.
+    double m_fee_per_kb;           //!< Modified fee per 1000 serialized bytes.
+    size_t m_usage;                //!< Approximate memory used by the entry.
+    uint32_t m_contract_types = 0; //!< Bitmask of contained contract types.
+    std::vector<GRC::Cpid> m_mrc_cpids;
+    CAmount m_mrc_fee = 0;
+
+    std::set<uint256> m_parents;
+    std::set<uint256> m_children;
+    std::set<uint256> m_ancestors;
+    uint64_t m_size_with_ancestors;
+    CAmount m_mod_fees_with_ancestors;
+};
+
+//!
+//! \brief Memory pool of transactions that are valid to include in the next
+//! block.
+//!
+//! The pool stores the transactions by hash and maintains secondary indexes
+//! ordered by fee rate, ancestor score, entry time and contract type so that
+//! block assembly, manual reward claim selection and eviction read pre-sorted
+//! views instead of sorting the whole pool on each call. Relationships between transactions in
+//! the pool are tracked incrementally as transactions enter and leave.
+//!
+class CTxMemPool
+{
+public:
+    //!
+    //! \brief Entries ordered by descending modified fee rate, then hash.
+    //!
+    typedef std::set<std::pair<double, uint256>, std::greater<std::pair<double, uint256>>> FeeRateIndex;
+
+    //!
+    //! \brief Entries ordered by ascending entry time, then hash.
+    //!
+    typedef std::set<std::pair<int64_t, uint256>> EntryTimeIndex;
+
+    //!
+    //! \brief Manual reward claims ordered by descending MRC fee, then hash.
+    //!
+    typedef std::set<std::pair<CAmount, uint256>, std::greater<std::pair<CAmount, uint256>>> MRCFeeIndex;
+
+    mutable CCriticalSection cs;
+    std::map<uint256, CTxMemPoolEntry> mapTx;
+    std::map<COutPoint, CInPoint> mapNextTx;
+
+    //!
+    //! \brief Add a transaction to the pool without checking anything.
+    //!
+    //! Don't call this directly, call AcceptToMemoryPool to properly check the
+    //! transaction first.
+    //!
+    //! \param hash Hash of the transaction.
+    //! \param tx   The transaction to add.
+    //! \param fee  Value of the inputs minus the value of the outputs.
+    //! \param time Entry time. Zero selects the current time.
+    //!
+    bool addUnchecked(const uint256& hash, const CTransaction& tx, const CAmount fee, int64_t time = 0);
+    bool remove(const CTransaction &tx, bool fRecursive = false);
+    bool removeConflicts(const CTransaction &tx);
+    void clear();
+    void queryHashes(std::vector<uint256>& vtxid);
+
+    //!
+    //! \brief Evict the transactions with the lowest fee rate, together with
+    //! their in-pool descendants, until the pool uses no more than the limit.
+    //!
+    //! \param limit   Maximum memory usage in bytes.
+    //! \param removed If supplied, receives the hashes of evicted transactions.
+    //!
+    void TrimToSize(const size_t limit, std::vector<uint256>* removed = nullptr);
+
+    //!
+    //! \brief Remove transactions that entered the pool before the specified
+    //! time, together with their in-pool descendants.
+    //!
+    //! \return Number of transactions removed.
+    //!
+    size_t Expire(const int64_t time);
+
+    //!
+    //! \brief Get the approximate memory used by the pool in bytes.
+    //!
+    size_t DynamicMemoryUsage() const
+    {
+        LOCK(cs);
+        return m_total_usage;
+    }
+
+    //!
+    //! \brief Get a counter incremented whenever a transaction enters or leaves
+    //! the pool.
+    //!
+    //! Results memoized from the pool membership of transactions, like the
+    //! wallet balances, compare this to detect that they became stale.
+    //!
+    uint64_t GetTransactionsUpdated() const
+    {
+        LOCK(cs);
+        return m_transactions_updated;
+    }
+
+    //!
+    //! \brief Look up the entry for the specified transaction hash.
+    //!
+    //! \return A pointer to the entry valid while \c cs is held, or \c nullptr.
+    //!
+    const CTxMemPoolEntry* GetEntry(const uint256& hash) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    //!
+    //! \brief Get the pool entries in descending order of fee rate. Callers must
+    //! hold \c cs while iterating.
+    //!
+    const FeeRateIndex& GetByFeeRate() const EXCLUSIVE_LOCKS_REQUIRED(cs) { return m_by_fee_rate; }
+
+    //!
+    //! \brief Get the pool entries in descending order of ancestor score. Block
+    //! assembly selects transactions together with their ancestors in this
+    //! order. Callers must hold \c cs while iterating.
+    //!
+    const FeeRateIndex& GetByAncestorScore() const EXCLUSIVE_LOCKS_REQUIRED(cs) { return m_by_ancestor_score; }
+
+    //!
+    //! \brief Get the pool entries in ascending order of entry time. Callers
+    //! must hold \c cs while iterating.
+    //!
+    const EntryTimeIndex& GetByEntryTime() const EXCLUSIVE_LOCKS_REQUIRED(cs) { return m_by_entry_time; }
+
+    //!
+    //! \brief Get the hashes of the transactions that contain a contract of the
+    //! specified type. Callers must hold \c cs while iterating.
+    //!
+    const std::set<uint256>& GetByContractType(const GRC::ContractType type) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    //!
+    //! \brief Get the manual reward claims in the pool in descending order of
+    //! MRC fee. Callers must hold \c cs while iterating.
+    //!
+    const MRCFeeIndex& GetMRCsByFee() const EXCLUSIVE_LOCKS_REQUIRED(cs) { return m_mrc_by_fee; }
+
+    //!
+    //! \brief Look up the hash of the transaction in the pool that contains a
+    //! manual reward claim for the specified CPID.
+    //!
+    //! \return \c true if a transaction was found and \p hash_out set.
+    //!
+    bool GetMRCForCpid(const GRC::Cpid& cpid, uint256& hash_out) const
+    {
+        LOCK(cs);
+
+        const auto iter = m_mrc_by_cpid.find(cpid);
+
+        if (iter == m_mrc_by_cpid.end()) return false;
+
+        hash_out = iter->second;
+
+        return true;
+    }
+
+    unsigned long size() const
+    {
+        LOCK(cs);
+        return mapTx.size();
+    }
+
+    bool exists(uint256 hash) const
+    {
+        LOCK(cs);
+        return (mapTx.count(hash) != 0);
+    }
+
+    bool lookup(uint256 hash, CTransaction& result) const
+    {
+        LOCK(cs);
+        std::map<uint256, CTxMemPoolEntry>::const_iterator i = mapTx.find(hash);
+        if (i == mapTx.end()) return false;
+        result = i->second.GetTx();
+        return true;
+    }
+
+private:
+    FeeRateIndex m_by_fee_rate GUARDED_BY(cs);
+    FeeRateIndex m_by_ancestor_score GUARDED_BY(cs);
+    EntryTimeIndex m_by_entry_time GUARDED_BY(cs);
+    std::map<GRC::ContractType, std::set<uint256>> m_by_contract_type GUARDED_BY(cs);
+    std::map<GRC::Cpid, uint256> m_mrc_by_cpid GUARDED_BY(cs);
+    MRCFeeIndex m_mrc_by_fee GUARDED_BY(cs);
+    size_t m_total_usage GUARDED_BY(cs) = 0;
+    uint64_t m_transactions_updated GUARDED_BY(cs) = 0;
+
+    //!
+    //! \brief Collect the hashes of the specified transaction and all of its
+    //! in-pool descendants.
+    //!
+    void CalculateDescendants(const uint256& hash, std::set<uint256>& descendants) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    //!
+    //! \brief Remove a single entry and detach it from the indexes and from the
+    //! relationship sets of the remaining entries.
+    //!
+    void RemoveUnchecked(std::map<uint256, CTxMemPoolEntry>::iterator iter) EXCLUSIVE_LOCKS_REQUIRED(cs);
+};
+
+extern CTxMemPool mempool;
+
+#endif // BITCOIN_TXMEMPOOL_H
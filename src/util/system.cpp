@@ -720,6 +720,7 @@ void PrintException(std::exception* pex, const char* pszThread)
 {
     std::string message = FormatException(pex, pszThread);
     LogPrintf("\n\n************************\n%s", message);
+    LogInstance().Flush();
     tfm::format(std::cerr, "\n\n************************\n%s\n", message.c_str());
     strMiscWarning = message;
     throw;
@@ -729,6 +730,7 @@ void PrintExceptionContinue(std::exception* pex, const char* pszThread)
 {
     std::string message = FormatException(pex, pszThread);
     LogPrintf("\n\n************************\n%s", message);
+    LogInstance().Flush();
     tfm::format(std::cerr, "\n\n************************\n%s\n", message.c_str());
     strMiscWarning = message;
 }
@@ -0,0 +1,398 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include <util/trace.h>
+#include <util/threadnames.h>
+#include <util/time.h>
+
+#include <univalue.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+std::atomic<bool> g_tracing{false};
+
+namespace {
+//!
+//! \brief A fixed-size buffer that keeps the most recent span records.
+//!
+class SpanRing
+{
+public:
+    void Resize(size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (capacity == m_capacity) {
+            return;
+        }
+
+        m_records.clear();
+        m_records.reserve(capacity);
+        m_capacity = capacity;
+        m_next = 0;
+    }
+
+    void Push(const TraceSpanRecord& record)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_capacity == 0) {
+            return;
+        }
+
+        if (m_records.size() < m_capacity) {
+            m_records.push_back(record);
+        } else {
+            m_records[m_next] = record;
+        }
+
+        m_next = (m_next + 1) % m_capacity;
+    }
+
+    std::vector<TraceSpanRecord> Get() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_records.size() < m_capacity) {
+            return m_records;
+        }
+
+        std::vector<TraceSpanRecord> records;
+        records.reserve(m_records.size());
+        records.insert(records.end(), m_records.begin() + m_next, m_records.end());
+        records.insert(records.end(), m_records.begin(), m_records.begin() + m_next);
+
+        return records;
+    }
+
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_records.clear();
+        m_next = 0;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<TraceSpanRecord> m_records;
+    size_t m_capacity = 0;
+    size_t m_next = 0;
+};
+
+//!
+//! \brief State shared by all spans. Never destroyed, so that spans that end
+//! during static destruction still find it.
+//!
+struct Tracer
+{
+    std::mutex m_registry_mutex;
+    std::vector<TraceSite*> m_sites;
+    std::vector<std::string> m_thread_names;
+
+    SpanRing m_recent;
+    SpanRing m_slow;
+    std::atomic<int64_t> m_slow_threshold_us{std::numeric_limits<int64_t>::max()};
+};
+
+Tracer& GetTracer()
+{
+    static Tracer* tracer = new Tracer();
+    return *tracer;
+}
+
+thread_local TraceSpan* t_current_span = nullptr;
+thread_local int t_thread_number = -1;
+
+int GetThreadNumber()
+{
+    if (t_thread_number < 0) {
+        Tracer& tracer = GetTracer();
+        std::lock_guard<std::mutex> lock(tracer.m_registry_mutex);
+
+        t_thread_number = tracer.m_thread_names.size();
+        tracer.m_thread_names.push_back(util::ThreadGetInternalName());
+    }
+
+    return t_thread_number;
+}
+} // Anonymous namespace
+
+// -----------------------------------------------------------------------------
+// Class: TraceHistogram
+// -----------------------------------------------------------------------------
+
+int TraceHistogram::BucketFor(uint64_t value)
+{
+    if (value < SUB_BUCKETS) {
+        return value;
+    }
+
+    int exponent = 63;
+
+    while (!(value >> exponent)) {
+        --exponent;
+    }
+
+    const int sub_bucket = (value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub_bucket;
+}
+
+uint64_t TraceHistogram::BucketLowerBound(int bucket)
+{
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+
+    if (bucket >= BUCKETS) {
+        return std::numeric_limits<uint64_t>::max();
+    }
+
+    const int exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    const uint64_t sub_bucket = bucket % SUB_BUCKETS;
+
+    return (SUB_BUCKETS + sub_bucket) << (exponent - SUB_BUCKET_BITS);
+}
+
+void TraceHistogram::Record(int64_t value)
+{
+    const uint64_t unsigned_value = std::max<int64_t>(0, value);
+
+    m_buckets[BucketFor(unsigned_value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(unsigned_value, std::memory_order_relaxed);
+
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+
+    while (unsigned_value > max
+        && !m_max.compare_exchange_weak(max, unsigned_value, std::memory_order_relaxed))
+    {
+    }
+}
+
+uint64_t TraceHistogram::Count() const
+{
+    return m_count.load(std::memory_order_relaxed);
+}
+
+uint64_t TraceHistogram::ValueAtQuantile(double quantile) const
+{
+    // Sum the buckets rather than read m_count so that a concurrent Record()
+    // cannot leave the rank beyond the buckets:
+    uint64_t count = 0;
+
+    for (const auto& bucket : m_buckets) {
+        count += bucket.load(std::memory_order_relaxed);
+    }
+
+    if (count == 0) {
+        return 0;
+    }
+
+    const uint64_t rank = std::max<uint64_t>(1, std::ceil(std::clamp(quantile, 0.0, 1.0) * count));
+    uint64_t seen = 0;
+
+    for (int bucket = 0; bucket < BUCKETS; ++bucket) {
+        seen += m_buckets[bucket].load(std::memory_order_relaxed);
+
+        if (seen >= rank) {
+            return std::min(BucketLowerBound(bucket + 1) - 1, Max());
+        }
+    }
+
+    return Max();
+}
+
+void TraceHistogram::Reset()
+{
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+
+    m_count.store(0, std::memory_order_relaxed);
+    m_total.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+// Class: TraceSite
+// -----------------------------------------------------------------------------
+
+TraceSite::TraceSite(const char* name) : m_name(name)
+{
+    Tracer& tracer = GetTracer();
+    std::lock_guard<std::mutex> lock(tracer.m_registry_mutex);
+
+    tracer.m_sites.push_back(this);
+}
+
+// -----------------------------------------------------------------------------
+// Class: TraceSpan
+// -----------------------------------------------------------------------------
+
+void TraceSpan::Begin(TraceSite& site)
+{
+    m_site = &site;
+    m_parent = t_current_span;
+    m_depth = m_parent ? m_parent->m_depth + 1 : 0;
+    m_start_us = GetTimeMicros();
+
+    t_current_span = this;
+}
+
+void TraceSpan::End()
+{
+    TraceSpanRecord record;
+    record.m_name = m_site->m_name;
+    record.m_thread = GetThreadNumber();
+    record.m_depth = m_depth;
+    record.m_start_us = m_start_us;
+    record.m_duration_us = std::max<int64_t>(0, GetTimeMicros() - m_start_us);
+
+    // An enclosing span that began before tracing was enabled did not record
+    // itself as the current span, so the parent is only a traced span:
+    if (m_parent) {
+        record.m_parent = m_parent->m_site->m_name;
+    }
+
+    t_current_span = m_parent;
+
+    m_site->m_histogram.Record(record.m_duration_us);
+
+    Tracer& tracer = GetTracer();
+    tracer.m_recent.Push(record);
+
+    if (record.m_duration_us >= tracer.m_slow_threshold_us.load(std::memory_order_relaxed)) {
+        tracer.m_slow.Push(record);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Functions
+// -----------------------------------------------------------------------------
+
+void EnableTracing(bool enable, size_t buffer_size, int64_t slow_threshold_us)
+{
+    Tracer& tracer = GetTracer();
+
+    tracer.m_recent.Resize(buffer_size);
+    tracer.m_slow.Resize(std::min<size_t>(buffer_size, 100));
+    tracer.m_slow_threshold_us = slow_threshold_us;
+
+    g_tracing = enable;
+}
+
+std::vector<TraceSiteStats> GetTraceStats()
+{
+    Tracer& tracer = GetTracer();
+    std::lock_guard<std::mutex> lock(tracer.m_registry_mutex);
+
+    std::vector<TraceSiteStats> stats;
+
+    for (const TraceSite* site : tracer.m_sites) {
+        const TraceHistogram& histogram = site->m_histogram;
+
+        if (histogram.Count() == 0) {
+            continue;
+        }
+
+        TraceSiteStats site_stats;
+        site_stats.m_name = site->m_name;
+        site_stats.m_count = histogram.Count();
+        site_stats.m_total_us = histogram.Total();
+        site_stats.m_max_us = histogram.Max();
+        site_stats.m_p50_us = histogram.ValueAtQuantile(0.5);
+        site_stats.m_p90_us = histogram.ValueAtQuantile(0.9);
+        site_stats.m_p99_us = histogram.ValueAtQuantile(0.99);
+        site_stats.m_p999_us = histogram.ValueAtQuantile(0.999);
+
+        stats.push_back(std::move(site_stats));
+    }
+
+    return stats;
+}
+
+std::vector<TraceSpanRecord> GetRecentSpans()
+{
+    return GetTracer().m_recent.Get();
+}
+
+std::vector<TraceSpanRecord> GetSlowSpans()
+{
+    return GetTracer().m_slow.Get();
+}
+
+std::vector<std::string> GetTraceThreadNames()
+{
+    Tracer& tracer = GetTracer();
+    std::lock_guard<std::mutex> lock(tracer.m_registry_mutex);
+
+    return tracer.m_thread_names;
+}
+
+void ResetTracing()
+{
+    Tracer& tracer = GetTracer();
+
+    {
+        std::lock_guard<std::mutex> lock(tracer.m_registry_mutex);
+
+        for (TraceSite* site : tracer.m_sites) {
+            site->m_histogram.Reset();
+        }
+    }
+
+    tracer.m_recent.Clear();
+    tracer.m_slow.Clear();
+}
+
+void WriteChromeTrace(std::ostream& out)
+{
+    UniValue events(UniValue::VARR);
+
+    const std::vector<std::string> thread_names = GetTraceThreadNames();
+
+    for (size_t i = 0; i < thread_names.size(); ++i) {
+        UniValue args(UniValue::VOBJ);
+        args.pushKV("name", thread_names[i]);
+
+        UniValue event(UniValue::VOBJ);
+        event.pushKV("name", "thread_name");
+        event.pushKV("ph", "M");
+        event.pushKV("pid", 1);
+        event.pushKV("tid", (uint64_t)i);
+        event.pushKV("args", args);
+
+        events.push_back(event);
+    }
+
+    for (const auto& record : GetRecentSpans()) {
+        UniValue event(UniValue::VOBJ);
+        event.pushKV("name", record.m_name);
+        event.pushKV("cat", "gridcoin");
+        event.pushKV("ph", "X");
+        event.pushKV("ts", record.m_start_us);
+        event.pushKV("dur", record.m_duration_us);
+        event.pushKV("pid", 1);
+        event.pushKV("tid", record.m_thread);
+
+        if (record.m_parent) {
+            UniValue args(UniValue::VOBJ);
+            args.pushKV("parent", record.m_parent);
+            event.pushKV("args", args);
+        }
+
+        events.push_back(event);
+    }
+
+    UniValue trace(UniValue::VOBJ);
+    trace.pushKV("traceEvents", events);
+    trace.pushKV("displayTimeUnit", "ms");
+
+    out << trace.write();
+}
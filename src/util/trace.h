@@ -0,0 +1,214 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_UTIL_TRACE_H
+#define BITCOIN_UTIL_TRACE_H
+
+#include <util/macros.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//!
+//! \brief Whether TRACE_SPAN scopes record their timings.
+//!
+//! The structured counterpart of the MilliTimer lap logging: a disabled tracer
+//! costs each span one relaxed atomic load. Set with EnableTracing().
+//!
+extern std::atomic<bool> g_tracing;
+
+//!
+//! \brief A latency histogram with logarithmic buckets in the style of an HDR
+//! histogram.
+//!
+//! Values below 8 microseconds have a bucket each. Above that, each power of
+//! two splits into 8 linear sub-buckets, so a percentile read from the buckets
+//! is off by at most 12.5%. Recording is a few relaxed atomic operations.
+//!
+class TraceHistogram
+{
+public:
+    static constexpr int SUB_BUCKET_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    //!
+    //! \brief Get the bucket that holds a value.
+    //!
+    static int BucketFor(uint64_t value);
+
+    //!
+    //! \brief Get the smallest value that falls in a bucket.
+    //!
+    static uint64_t BucketLowerBound(int bucket);
+
+    //!
+    //! \brief Add a value, in microseconds.
+    //!
+    void Record(int64_t value);
+
+    //!
+    //! \brief Get the number of recorded values.
+    //!
+    uint64_t Count() const;
+
+    //!
+    //! \brief Get an upper bound for the value at a quantile.
+    //!
+    //! \param quantile Between 0 and 1, like 0.99 for the 99th percentile.
+    //!
+    //! \return The largest value in the bucket of the quantile, capped at the
+    //! largest recorded value, or 0 when the histogram is empty.
+    //!
+    uint64_t ValueAtQuantile(double quantile) const;
+
+    uint64_t Total() const { return m_total.load(std::memory_order_relaxed); }
+    uint64_t Max() const { return m_max.load(std::memory_order_relaxed); }
+
+    //!
+    //! \brief Discard the recorded values.
+    //!
+    void Reset();
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> m_buckets {};
+    std::atomic<uint64_t> m_count {0};
+    std::atomic<uint64_t> m_total {0};
+    std::atomic<uint64_t> m_max {0};
+};
+
+//!
+//! \brief A named place in the code that TRACE_SPAN measures.
+//!
+//! Sites are function-local statics that register themselves with the tracer
+//! the first time that execution reaches them and live until the process ends.
+//!
+class TraceSite
+{
+public:
+    explicit TraceSite(const char* name);
+
+    const char* const m_name;
+    TraceHistogram m_histogram;
+};
+
+//!
+//! \brief A completed span.
+//!
+struct TraceSpanRecord
+{
+    const char* m_name = nullptr;   //!< Name of the span site.
+    const char* m_parent = nullptr; //!< Name of the enclosing span, if any.
+    int m_thread = 0;               //!< Sequence number of the thread. See GetTraceThreadNames().
+    int m_depth = 0;                //!< Number of enclosing spans.
+    int64_t m_start_us = 0;         //!< Start as microseconds since the epoch.
+    int64_t m_duration_us = 0;
+};
+
+//!
+//! \brief Measures a scope. Use the TRACE_SPAN macro instead.
+//!
+class TraceSpan
+{
+public:
+    explicit TraceSpan(TraceSite& site)
+    {
+        if (g_tracing.load(std::memory_order_relaxed)) {
+            Begin(site);
+        }
+    }
+
+    ~TraceSpan()
+    {
+        if (m_site) {
+            End();
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    TraceSite* m_site = nullptr;
+    TraceSpan* m_parent = nullptr;
+    int m_depth = 0;
+    int64_t m_start_us = 0;
+
+    void Begin(TraceSite& site);
+    void End();
+};
+
+//!
+//! \brief Measure the rest of the enclosing scope as a span named \p name.
+//!
+//! Spans nest: a span begun while another span of the same thread is open
+//! records that span as its parent.
+//!
+#define TRACE_SPAN(name)                                                      \
+    static TraceSite PASTE2(trace_site_, __LINE__)(name);                     \
+    TraceSpan PASTE2(trace_span_, __LINE__)(PASTE2(trace_site_, __LINE__))
+
+//!
+//! \brief Latency statistics of one span site, in microseconds.
+//!
+struct TraceSiteStats
+{
+    std::string m_name;
+    uint64_t m_count = 0;
+    uint64_t m_total_us = 0;
+    uint64_t m_max_us = 0;
+    uint64_t m_p50_us = 0;
+    uint64_t m_p90_us = 0;
+    uint64_t m_p99_us = 0;
+    uint64_t m_p999_us = 0;
+};
+
+//!
+//! \brief Turn span recording on or off.
+//!
+//! \param enable            Whether to record spans.
+//! \param buffer_size       Number of recent spans to keep for export.
+//! \param slow_threshold_us Spans at least this long also go to the buffer of
+//!                          slow spans.
+//!
+void EnableTracing(bool enable, size_t buffer_size, int64_t slow_threshold_us);
+
+//!
+//! \brief Get the statistics of each site that recorded a span.
+//!
+std::vector<TraceSiteStats> GetTraceStats();
+
+//!
+//! \brief Get the recent spans, oldest first.
+//!
+std::vector<TraceSpanRecord> GetRecentSpans();
+
+//!
+//! \brief Get the recent spans that took at least the slow threshold, oldest
+//! first.
+//!
+std::vector<TraceSpanRecord> GetSlowSpans();
+
+//!
+//! \brief Get the names of the threads that recorded spans, indexed by the
+//! thread sequence numbers in the span records.
+//!
+std::vector<std::string> GetTraceThreadNames();
+
+//!
+//! \brief Discard the histograms and the buffered spans.
+//!
+void ResetTracing();
+
+//!
+//! \brief Write the recent spans as Chrome trace event JSON, the format that
+//! chrome://tracing and Perfetto load.
+//!
+void WriteChromeTrace(std::ostream& out);
+
+#endif // BITCOIN_UTIL_TRACE_H
@@ -20,10 +20,13 @@
 #include "gridcoin/staking/kernel.h"
 #include "gridcoin/staking/spam.h"
 #include "gridcoin/tally.h"
+#include "index/addressindex.h"
+#include "index/blockstats.h"
 #include "node/blockstorage.h"
 #include "policy/fees.h"
 #include "serialize.h"
 #include "util.h"
+#include "util/trace.h"
 #include "validation.h"
 #include "wallet/wallet.h"
 
@@ -36,33 +39,9 @@ extern GRC::ChainTrustCache g_chain_trust;
 static constexpr CAmount nGenesisSupply = 340569880;
 bool fColdBoot = true;
 
-bool ReadTxFromDisk(CTransaction& tx, CDiskTxPos pos, FILE** pfileRet)
+bool ReadTxFromDisk(CTransaction& tx, CDiskTxPos pos)
 {
-    tx.SetNull();
-
-    CAutoFile filein(OpenBlockFile(pos.nFile, 0, pfileRet ? "rb+" : "rb"), SER_DISK, CLIENT_VERSION);
-    if (filein.IsNull())
-        return error("ReadTxFromDisk() : OpenBlockFile failed");
-
-    // Read transaction
-    if (fseek(filein.Get(), pos.nTxPos, SEEK_SET) != 0)
-        return error("ReadTxFromDisk() : fseek failed");
-
-    try {
-        filein >> tx;
-    }
-    catch (std::exception &e) {
-        return error("%s() : deserialize or I/O error", __PRETTY_FUNCTION__);
-    }
-
-    // Return file pointer
-    if (pfileRet)
-    {
-        if (fseek(filein.Get(), pos.nTxPos, SEEK_SET) != 0)
-            return error("ReadTxFromDisk() : second fseek failed");
-        *pfileRet = filein.release();
-    }
-    return true;
+    return ReadTxFromDisk(tx, pos, nullptr);
 }
 
 bool ReadTxFromDisk(CTransaction& tx, CTxDB& txdb, COutPoint prevout, CTxIndex& txindexRet)
@@ -280,7 +259,7 @@ bool DisconnectInputs(CTransaction& tx, CTxDB& txdb)
 }
 
 
-bool FetchInputs(CTransaction& tx, CTxDB& txdb, const std::map<uint256, CTxIndex>& mapTestPool,
+bool FetchInputs(const CTransaction& tx, CTxDB& txdb, const std::map<uint256, CTxIndex>& mapTestPool,
                  bool fBlock, bool fMiner, MapPrevTx& inputsRet, bool& fInvalid)
 {
     // FetchInputs can return false either because we just haven't seen some inputs
@@ -354,7 +333,7 @@ bool FetchInputs(CTransaction& tx, CTxDB& txdb, const std::map<uint256, CTxIndex
     return true;
 }
 
-bool ConnectInputs(CTransaction& tx, CTxDB& txdb, MapPrevTx inputs, std::map<uint256, CTxIndex>& mapTestPool, const CDiskTxPos& posThisTx,
+bool ConnectInputs(const CTransaction& tx, CTxDB& txdb, MapPrevTx inputs, std::map<uint256, CTxIndex>& mapTestPool, const CDiskTxPos& posThisTx,
     const CBlockIndex* pindexBlock, bool fBlock, bool fMiner)
 {
     // Take over previous transactions' spent pointers
@@ -565,6 +544,8 @@ bool CheckProofOfWork(uint256 hash, unsigned int nBits, const Consensus::Params&
 
 bool DisconnectBlock(CBlock& block, CTxDB& txdb, CBlockIndex* pindex)
 {
+    TRACE_SPAN("DisconnectBlock");
+
     // Disconnect in reverse order
     bool bDiscTxFailed = false;
     for (int i = block.vtx.size() - 1; i >= 0; i--)
@@ -575,6 +556,12 @@ bool DisconnectBlock(CBlock& block, CTxDB& txdb, CBlockIndex* pindex)
         }
     }
 
+    if (GetBlockStatsIndex().Enabled() && !GetBlockStatsIndex().EraseBlock(txdb, pindex))
+        return error("%s: EraseBlock for block stats index failed", __func__);
+
+    if (GetAddressIndex().Enabled() && !GetAddressIndex().EraseBlock(txdb, pindex, block))
+        return error("%s: EraseBlock for address index failed", __func__);
+
     // Update block index on disk without changing it in memory.
     // The memory index structure will be changed after the db commits.
     // Brod: I do not like this...
@@ -1510,7 +1497,7 @@ bool TryLoadSuperblock(
         uiInterface.BeaconChanged();
     }
 
-    GRC::Quorum::PushSuperblock(std::move(superblock));
+    GRC::Quorum::PushSuperblock(std::move(superblock), pindex);
 
     return true;
 }
@@ -1609,6 +1596,12 @@ bool GridcoinConnectBlock(
 
 bool ConnectBlock(CBlock& block, CTxDB& txdb, CBlockIndex* pindex, bool fJustCheck)
 {
+    TRACE_SPAN("ConnectBlock");
+
+    // Blocks read from disk for a reorganization did not pass through
+    // ProcessBlock(), so cache the transaction hashes here as well:
+    block.CacheTxHashes();
+
     // Check it again in case a previous version let a bad block in, but skip BlockSig checking
     if (!CheckBlock(block, pindex->nHeight, !fJustCheck, !fJustCheck, false, false))
     {
@@ -1636,6 +1629,10 @@ bool ConnectBlock(CBlock& block, CTxDB& txdb, CBlockIndex* pindex, bool fJustChe
 
     bool bIsDPOR = false;
 
+    // Outputs spent by the block in input order, for the address index:
+    const bool index_addresses = !fJustCheck && GetAddressIndex().Enabled();
+    std::vector<CTxOut> spent_outputs;
+
     if (block.nVersion >= 8 && pindex->nStakeModifier == 0)
     {
         uint256 tmp_hashProof;
@@ -1763,6 +1760,12 @@ bool ConnectBlock(CBlock& block, CTxDB& txdb, CBlockIndex* pindex, bool fJustChe
 
             if (!ConnectInputs(tx, txdb, mapInputs, mapQueuedChanges, posThisTx, pindex, true, false))
                 return false;
+
+            if (index_addresses)
+            {
+                for (const auto& txin : tx.vin)
+                    spent_outputs.push_back(mapInputs.at(txin.prevout.hash).second.vout[txin.prevout.n]);
+            }
         }
 
         mapQueuedChanges[hashTx] = CTxIndex(posThisTx, tx.vout.size());
@@ -1794,6 +1797,19 @@ bool ConnectBlock(CBlock& block, CTxDB& txdb, CBlockIndex* pindex, bool fJustChe
             return error("%s: UpdateTxIndex failed", __func__);
     }
 
+    if (GetBlockStatsIndex().Enabled())
+    {
+        GRC::MintSummary mint;
+        mint.m_total = block.vtx[0].GetValueOut() + nStakeReward;
+        mint.m_fees = nFees;
+
+        if (!GetBlockStatsIndex().WriteBlock(txdb, pindex, block, mint))
+            return error("%s: WriteBlock for block stats index failed", __func__);
+    }
+
+    if (index_addresses && !GetAddressIndex().WriteBlock(txdb, pindex, block, spent_outputs))
+        return error("%s: WriteBlock for address index failed", __func__);
+
     // Update block index on disk without changing it in memory.
     // The memory index structure will be changed after the db commits.
     if (pindex->pprev)
@@ -2029,6 +2045,7 @@ bool CheckBlock(const CBlock& block, int height1, bool fCheckPOW, bool fCheckMer
 bool AcceptBlock(CBlock& block, bool generated_by_me) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
 {
     AssertLockHeld(cs_main);
+    TRACE_SPAN("AcceptBlock");
 
     if (block.nVersion > CBlock::CURRENT_VERSION)
         return block.DoS(100, error("%s: reject unknown block version %d", __func__, block.nVersion));
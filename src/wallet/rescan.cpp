@@ -0,0 +1,434 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#include "chainparams.h"
+#include "init.h"
+#include "logging.h"
+#include "main.h"
+#include "node/blockstorage.h"
+#include "script.h"
+#include "util.h"
+#include "util/time.h"
+#include "wallet/rescan.h"
+#include "wallet/wallet.h"
+
+#include <algorithm>
+#include <future>
+#include <optional>
+#include <thread>
+
+using namespace wallet;
+
+namespace {
+//!
+//! \brief Number of blocks that each worker thread reads ahead of the wallet.
+//!
+constexpr size_t BLOCKS_PER_THREAD = 16;
+
+//!
+//! \brief Maximum number of blocks applied to the wallet under one lock.
+//!
+constexpr size_t BLOCKS_PER_LOCK = 32;
+
+//!
+//! \brief Minimum number of seconds between progress messages in the log.
+//!
+constexpr int64_t PROGRESS_INTERVAL = 10;
+
+std::atomic<bool> g_scanning { false };
+std::atomic<size_t> g_scanned_blocks { 0 };
+std::atomic<size_t> g_total_blocks { 0 };
+std::atomic<int64_t> g_scan_start_time { 0 };
+
+//!
+//! \brief A block read by a worker thread with the positions of transactions
+//! that passed the filter.
+//!
+struct ScannedBlock
+{
+    explicit ScannedBlock(const CBlockIndex* index) : m_index(index)
+    {
+    }
+
+    const CBlockIndex* m_index;
+    CBlock m_block;
+    std::vector<unsigned int> m_matches;
+    bool m_read = false;
+};
+
+//!
+//! \brief Read the blocks of a window and apply the filter to them using the
+//! specified number of threads.
+//!
+void ReadWindow(std::vector<ScannedBlock>& window, const RescanFilter& filter, const size_t threads)
+{
+    std::atomic<size_t> next { 0 };
+
+    const auto worker = [&]() {
+        for (size_t i = next++; i < window.size(); i = next++) {
+            ScannedBlock& item = window[i];
+
+            item.m_read = ReadBlockFromDisk(item.m_block, item.m_index, Params().GetConsensus());
+
+            if (!item.m_read) {
+                continue;
+            }
+
+            for (unsigned int n = 0; n < item.m_block.vtx.size(); ++n) {
+                if (filter.Matches(item.m_block.vtx[n])) {
+                    item.m_matches.push_back(n);
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+
+    for (size_t t = 1; t < std::min(threads, window.size()); ++t) {
+        pool.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto& thread : pool) {
+        thread.join();
+    }
+}
+
+//!
+//! \brief Collect the blocks that connected to the chain after the specified
+//! block.
+//!
+std::vector<const CBlockIndex*> CollectFollowingBlocks(const CBlockIndex* pindex)
+{
+    LOCK(cs_main);
+
+    std::vector<const CBlockIndex*> blocks;
+
+    for (pindex = pindex->pnext; pindex; pindex = pindex->pnext) {
+        blocks.push_back(pindex);
+    }
+
+    return blocks;
+}
+
+//!
+//! \brief Collect the blocks of the main chain that replace a block that a
+//! reorganization disconnected.
+//!
+//! \param pindex     The disconnected block.
+//! \param end_height Height of the last block to collect, or -1 to collect
+//!                   the blocks up to the chain tip.
+//!
+//! \return The main chain blocks after the fork point of the disconnected
+//! block.
+//!
+std::vector<const CBlockIndex*> CollectReplacementBlocks(const CBlockIndex* pindex, const int end_height)
+    EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    AssertLockHeld(cs_main);
+
+    while (pindex->pprev && !pindex->IsInMainChain()) {
+        pindex = pindex->pprev;
+    }
+
+    std::vector<const CBlockIndex*> blocks;
+
+    for (pindex = pindex->pnext; pindex; pindex = pindex->pnext) {
+        if (end_height >= 0 && pindex->nHeight > end_height) {
+            break;
+        }
+
+        blocks.push_back(pindex);
+    }
+
+    return blocks;
+}
+} // anonymous namespace
+
+// -----------------------------------------------------------------------------
+// Class: RescanFilter
+// -----------------------------------------------------------------------------
+
+RescanFilter::RescanFilter(const CWallet& wallet) : m_keystore(wallet)
+{
+    wallet.GetKeys(m_keys);
+
+    LOCK(wallet.cs_wallet);
+
+    for (const auto& item : wallet.mapWallet) {
+        m_txs.insert(item.first);
+    }
+}
+
+bool RescanFilter::HaveCScript(const CScriptID& hash) const
+{
+    return m_keystore.HaveCScript(hash);
+}
+
+bool RescanFilter::GetCScript(const CScriptID& hash, CScript& redeemScriptOut) const
+{
+    return m_keystore.GetCScript(hash, redeemScriptOut);
+}
+
+bool RescanFilter::Matches(const CTransaction& tx) const
+{
+    if (m_txs.count(tx.GetHash())) {
+        return true;
+    }
+
+    for (const auto& txin : tx.vin) {
+        if (m_txs.count(txin.prevout.hash)) {
+            return true;
+        }
+    }
+
+    for (const auto& txout : tx.vout) {
+        if (::IsMine(*this, txout.scriptPubKey) != ISMINE_NO) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+// Class: Rescanner
+// -----------------------------------------------------------------------------
+
+Rescanner::Rescanner(CWallet& wallet, std::string description)
+    : m_wallet(wallet)
+    , m_description(std::move(description))
+    , m_threads([]() {
+        int64_t threads = gArgs.GetArg("-rescanthreads", DEFAULT_RESCAN_THREADS);
+
+        if (threads <= 0) {
+            threads = std::thread::hardware_concurrency();
+        }
+
+        return std::clamp<size_t>(threads, 1, 16);
+    }())
+{
+}
+
+int Rescanner::Scan(
+    std::vector<const CBlockIndex*> blocks,
+    const bool update,
+    const TxPredicate& predicate,
+    const bool follow_chain)
+{
+    int ret = 0;
+
+    if (blocks.empty()) {
+        return ret;
+    }
+
+    const RescanFilter filter(m_wallet);
+    const size_t window_size = m_threads * BLOCKS_PER_THREAD;
+    const int64_t start_time = GetTimeMillis();
+    int64_t last_progress_time = GetTime();
+
+    g_scanning = true;
+    g_scanned_blocks = 0;
+    g_total_blocks = blocks.size();
+    g_scan_start_time = GetTime();
+
+    LogPrintf("%s: scanning %u blocks using %u threads.", m_description, blocks.size(), m_threads);
+
+    // Hashes of the transactions that entered the wallet during this scan. The
+    // filter snapshot does not know about these, so the scanning thread checks
+    // the inputs of the remaining transactions against them:
+    std::set<uint256> found;
+
+    const auto make_window = [&](size_t begin) {
+        std::vector<ScannedBlock> window;
+        const size_t end = std::min(begin + window_size, blocks.size());
+
+        window.reserve(end - begin);
+
+        for (size_t i = begin; i < end; ++i) {
+            window.emplace_back(blocks[i]);
+        }
+
+        return window;
+    };
+
+    // The blocks after the scanned range that a reorganization may replace
+    // the remaining blocks with:
+    const int end_height = follow_chain ? -1 : blocks.back()->nHeight;
+
+    size_t offset = 0;
+    std::vector<ScannedBlock> window = make_window(offset);
+    ReadWindow(window, filter, m_threads);
+
+    while (!window.empty()) {
+        const size_t window_begin = offset;
+        offset += window.size();
+
+        // Position in the blocks of the first block that a reorganization
+        // disconnected after the workers read it:
+        std::optional<size_t> reorganized;
+
+        // Prefetch the next window while this thread applies the current one:
+        std::vector<ScannedBlock> next_window = make_window(offset);
+        std::future<void> prefetch = std::async(
+            std::launch::async,
+            ReadWindow,
+            std::ref(next_window),
+            std::cref(filter),
+            m_threads);
+
+        for (size_t chunk = 0; chunk < window.size() && !reorganized; chunk += BLOCKS_PER_LOCK) {
+            {
+                LOCK2(cs_main, m_wallet.cs_wallet);
+
+                for (size_t i = chunk; i < std::min(chunk + BLOCKS_PER_LOCK, window.size()); ++i) {
+                    const ScannedBlock& item = window[i];
+
+                    // The workers read the window without cs_main. Do not apply
+                    // the transactions of a block that left the main chain:
+                    if (!item.m_index->IsInMainChain()) {
+                        const size_t position = window_begin + i;
+                        std::vector<const CBlockIndex*> replacement
+                            = CollectReplacementBlocks(item.m_index, end_height);
+
+                        LogPrintf("%s: block %s at height %d left the main chain. "
+                                  "Scanning %u blocks from the fork point.",
+                                  m_description,
+                                  item.m_index->GetBlockHash().ToString(),
+                                  item.m_index->nHeight,
+                                  replacement.size());
+
+                        blocks.resize(position);
+                        blocks.insert(blocks.end(), replacement.begin(), replacement.end());
+                        g_total_blocks = blocks.size();
+                        g_scanned_blocks = position;
+
+                        reorganized = position;
+                        break;
+                    }
+
+                    if (!item.m_read) {
+                        LogPrintf("WARNING: %s: failed to read block %s at height %d.",
+                                  m_description,
+                                  item.m_index->GetBlockHash().ToString(),
+                                  item.m_index->nHeight);
+                        continue;
+                    }
+
+                    auto match = item.m_matches.begin();
+
+                    for (unsigned int n = 0; n < item.m_block.vtx.size(); ++n) {
+                        const CTransaction& tx = item.m_block.vtx[n];
+                        bool candidate = false;
+
+                        if (match != item.m_matches.end() && *match == n) {
+                            candidate = true;
+                            ++match;
+                        } else if (!found.empty()) {
+                            for (const auto& txin : tx.vin) {
+                                if (found.count(txin.prevout.hash)) {
+                                    candidate = true;
+                                    break;
+                                }
+                            }
+                        }
+
+                        if (!candidate || (predicate && !predicate(tx))) {
+                            continue;
+                        }
+
+                        if (m_wallet.AddToWalletIfInvolvingMe(tx, &item.m_block, update)) {
+                            ++ret;
+                        }
+
+                        if (m_wallet.mapWallet.count(tx.GetHash())) {
+                            found.insert(tx.GetHash());
+                        }
+                    }
+                }
+            }
+
+            if (reorganized) {
+                break;
+            }
+
+            g_scanned_blocks += std::min(BLOCKS_PER_LOCK, window.size() - chunk);
+
+            if (GetTime() - last_progress_time >= PROGRESS_INTERVAL) {
+                const size_t scanned = g_scanned_blocks;
+                const size_t total = g_total_blocks;
+                const int64_t elapsed = GetTime() - g_scan_start_time;
+
+                LogPrintf("%s: scanned %u of %u blocks (%.1f%%), %d seconds remaining.",
+                          m_description,
+                          scanned,
+                          total,
+                          100.0 * scanned / total,
+                          scanned ? elapsed * (total - scanned) / scanned : 0);
+
+                last_progress_time = GetTime();
+            }
+        }
+
+        prefetch.wait();
+
+        if (ShutdownRequested()) {
+            LogPrintf("%s: canceled by shutdown.", m_description);
+            break;
+        }
+
+        // Drop the prefetched blocks and continue from the fork point:
+        if (reorganized) {
+            offset = *reorganized;
+            window = make_window(offset);
+            ReadWindow(window, filter, m_threads);
+
+            continue;
+        }
+
+        window = std::move(next_window);
+
+        // Blocks may have connected to the chain while the scan ran without the
+        // lock. Extend the scan to catch up to the new tip:
+        if (window.empty() && follow_chain) {
+            std::vector<const CBlockIndex*> following = CollectFollowingBlocks(blocks.back());
+
+            if (!following.empty()) {
+                blocks.insert(blocks.end(), following.begin(), following.end());
+                g_total_blocks = blocks.size();
+
+                window = make_window(offset);
+                ReadWindow(window, filter, m_threads);
+            }
+        }
+    }
+
+    g_scanning = false;
+
+    LogPrintf("%s: scanned %u blocks in %d ms, %d wallet transactions added or updated.",
+              m_description,
+              blocks.size(),
+              GetTimeMillis() - start_time,
+              ret);
+
+    return ret;
+}
+
+bool Rescanner::IsScanning()
+{
+    return g_scanning;
+}
+
+double Rescanner::GetProgress()
+{
+    const size_t total = g_total_blocks;
+
+    return total ? static_cast<double>(g_scanned_blocks) / total : 0;
+}
+
+int64_t Rescanner::GetDuration()
+{
+    return g_scanning ? GetTime() - g_scan_start_time : 0;
+}
@@ -0,0 +1,134 @@
+// Copyright (c) 2024 The Gridcoin developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://opensource.org/licenses/mit-license.php.
+
+#ifndef GRIDCOIN_WALLET_RESCAN_H
+#define GRIDCOIN_WALLET_RESCAN_H
+
+#include "keystore.h"
+#include "uint256.h"
+
+#include <atomic>
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+
+class CBlockIndex;
+class CTransaction;
+class CWallet;
+
+namespace wallet {
+//! Default for -rescanthreads. Zero selects the number of available cores.
+static constexpr int DEFAULT_RESCAN_THREADS = 0;
+
+//!
+//! \brief Snapshot of the keys and transactions of a wallet that a rescan uses
+//! to pre-filter the transactions of each block without the wallet lock.
+//!
+//! The filter implements the key store interface so that it produces the same
+//! answer as the wallet for \c IsMine(). It holds only the key IDs; it cannot
+//! sign anything. Redeem scripts resolve through the wallet's key store which
+//! only takes the key store lock.
+//!
+class RescanFilter : public CKeyStore
+{
+public:
+    //!
+    //! \brief Take a snapshot of the keys and transactions of the wallet.
+    //!
+    //! \param wallet The wallet to scan for. Takes the wallet lock.
+    //!
+    explicit RescanFilter(const CWallet& wallet);
+
+    bool AddKey(const CKey& key) override { return false; }
+    bool HaveKey(const CKeyID& address) const override { return m_keys.count(address) > 0; }
+    bool GetKey(const CKeyID& address, CKey& keyOut) const override { return false; }
+    void GetKeys(std::set<CKeyID>& setAddress) const override { setAddress = m_keys; }
+    bool AddCScript(const CScript& redeemScript) override { return false; }
+    bool HaveCScript(const CScriptID& hash) const override;
+    bool GetCScript(const CScriptID& hash, CScript& redeemScriptOut) const override;
+
+    //!
+    //! \brief Determine whether the transaction may involve the wallet.
+    //!
+    //! A transaction may involve the wallet when the wallet already contains it,
+    //! when it spends an output of a wallet transaction, or when one of its
+    //! outputs belongs to the wallet. The result is a superset of the matches
+    //! of \c CWallet::AddToWalletIfInvolvingMe() for the snapshot.
+    //!
+    bool Matches(const CTransaction& tx) const;
+
+private:
+    const CKeyStore& m_keystore;   //!< Resolves redeem scripts.
+    std::set<CKeyID> m_keys;       //!< IDs of the keys in the wallet.
+    std::set<uint256> m_txs;       //!< Hashes of the wallet transactions.
+};
+
+//!
+//! \brief Reads and filters blocks for wallet transactions in parallel and then
+//! applies the matches to the wallet in chain order.
+//!
+//! Worker threads read and deserialize a window of blocks ahead of the wallet
+//! and test each transaction against a \c RescanFilter. The scanning thread
+//! then passes the matches to \c CWallet::AddToWalletIfInvolvingMe() in short
+//! batches under \c cs_main and the wallet lock. While it applies one window,
+//! the workers prefetch the next.
+//!
+class Rescanner
+{
+public:
+    //!
+    //! \brief Additional condition that a matched transaction must satisfy to
+    //! enter the wallet.
+    //!
+    typedef std::function<bool(const CTransaction&)> TxPredicate;
+
+    //!
+    //! \brief Initialize a rescan.
+    //!
+    //! \param wallet      Wallet to add the matched transactions to.
+    //! \param description Describes the scan in log messages.
+    //!
+    Rescanner(CWallet& wallet, std::string description);
+
+    //!
+    //! \brief Scan the specified blocks.
+    //!
+    //! \param blocks       Blocks to read, in chain order.
+    //! \param update       Update transactions that already exist in the wallet.
+    //! \param predicate    Optional condition for matched transactions.
+    //! \param follow_chain Continue with the blocks connected to the chain tip
+    //!                     while the scan ran.
+    //!
+    //! \return Number of transactions added to or updated in the wallet.
+    //!
+    int Scan(
+        std::vector<const CBlockIndex*> blocks,
+        const bool update,
+        const TxPredicate& predicate = nullptr,
+        const bool follow_chain = false);
+
+    //!
+    //! \brief Determine whether a rescan is in progress.
+    //!
+    static bool IsScanning();
+
+    //!
+    //! \brief Get the fraction of blocks scanned by the current rescan.
+    //!
+    static double GetProgress();
+
+    //!
+    //! \brief Get the number of seconds since the current rescan started.
+    //!
+    static int64_t GetDuration();
+
+private:
+    CWallet& m_wallet;
+    const std::string m_description;
+    const size_t m_threads;
+};
+} // namespace wallet
+
+#endif // GRIDCOIN_WALLET_RESCAN_H
@@ -15,6 +15,7 @@
 #include "gridcoin/staking/difficulty.h"
 #include "gridcoin/staking/status.h"
 #include "gridcoin/tx_message.h"
+#include "wallet/rescan.h"
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
 #include "wallet/ismine.h"
@@ -164,6 +165,17 @@ UniValue getwalletinfo(const UniValue& params, bool fHelp)
             res.pushKV("masterkeyid", masterKeyID.GetHex());
     }
 
+    if (wallet::Rescanner::IsScanning()) {
+        UniValue scanning(UniValue::VOBJ);
+
+        scanning.pushKV("duration", wallet::Rescanner::GetDuration());
+        scanning.pushKV("progress", wallet::Rescanner::GetProgress());
+
+        res.pushKV("scanning", scanning);
+    } else {
+        res.pushKV("scanning", false);
+    }
+
     res.pushKV("staking", g_miner_status.StakingActive());
     res.pushKV("mining-error", g_miner_status.FormatErrors());
 
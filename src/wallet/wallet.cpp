@@ -5,6 +5,7 @@
 
 #include "chainparams.h"
 #include "txdb.h"
+#include "wallet/rescan.h"
 #include "wallet/wallet.h"
 #include "wallet/walletdb.h"
 #include "crypter.h"
@@ -26,6 +27,7 @@
 #include "gridcoin/support/block_finder.h"
 #include "policy/fees.h"
 #include "node/blockstorage.h"
+#include "node/prune.h"
 
 #include <stdexcept>
 
@@ -49,6 +51,22 @@ struct CompareValueOnly
         return t1.first < t2.first;
     }
 };
+
+//!
+//! \brief Determine whether IsFinalTx() for the transaction or for one of the
+//! supporting transactions that IsTrusted() checks can change with the
+//! adjusted time alone.
+//!
+bool HasTimeLock(const CWalletTx& wtx)
+{
+    if (wtx.nLockTime >= LOCKTIME_THRESHOLD) {
+        return true;
+    }
+
+    return std::any_of(wtx.vtxPrev.begin(), wtx.vtxPrev.end(), [](const CMerkleTx& prev) {
+        return prev.nLockTime >= LOCKTIME_THRESHOLD;
+    });
+}
 } // anonymous namespace
 
 // -----------------------------------------------------------------------------
@@ -458,6 +476,7 @@ void CWallet::WalletUpdateSpent(const CTransaction &tx, bool fBlock, CWalletDB*
                     LogPrint(BCLog::LogFlags::VERBOSE, "WalletUpdateSpent found spent coin %s gC %s", FormatMoney(wtx.GetCredit()), wtx.GetHash().ToString());
                     wtx.MarkSpent(txin.prevout.n);
                     wtx.WriteToDisk(pwalletdb);
+                    UpdateUnspent(wtx);
                     NotifyTransactionChanged(this, txin.prevout.hash, CT_UPDATED);
                 }
             }
@@ -475,6 +494,7 @@ void CWallet::WalletUpdateSpent(const CTransaction &tx, bool fBlock, CWalletDB*
                 {
                     wtx.MarkUnspent(&txout - &tx.vout[0]);
                     wtx.WriteToDisk(pwalletdb);
+                    UpdateUnspent(wtx);
                     NotifyTransactionChanged(this, hash, CT_UPDATED);
                 }
             }
@@ -489,7 +509,76 @@ void CWallet::MarkDirty()
         LOCK(cs_wallet);
         for (auto &item : mapWallet)
             item.second.MarkDirty();
+
+        // Callers mark the wallet dirty after importing keys which may change
+        // the ownership of outputs that the wallet already knows about:
+        RebuildUnspent();
+    }
+}
+
+void CWallet::UpdateUnspent(const CWalletTx& wtx)
+{
+    AssertLockHeld(cs_wallet);
+
+    ++m_balance_generation;
+
+    for (unsigned int i = 0; i < wtx.vout.size(); ++i) {
+        if (!wtx.IsSpent(i) && IsMine(wtx.vout[i]) != ISMINE_NO) {
+            m_unspent_txs.insert(wtx.GetHash());
+            return;
+        }
+    }
+
+    m_unspent_txs.erase(wtx.GetHash());
+}
+
+void CWallet::RebuildUnspent()
+{
+    AssertLockHeld(cs_wallet);
+
+    m_unspent_txs.clear();
+
+    for (const auto& item : mapWallet) {
+        UpdateUnspent(item.second);
     }
+
+    ++m_balance_generation;
+}
+
+CWallet::BalanceCache& CWallet::GetBalanceCache() const
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
+
+    // The depth of each transaction, and thus the category that its outputs
+    // belong to, only changes with the chain tip or when the transaction
+    // enters or leaves the mempool:
+    const uint64_t mempool_updates = mempool.GetTransactionsUpdated();
+
+    if (m_balance_cache.m_tip != hashBestChain
+        || m_balance_cache.m_generation != m_balance_generation
+        || m_balance_cache.m_mempool_updates != mempool_updates)
+    {
+        m_balance_cache = BalanceCache();
+        m_balance_cache.m_tip = hashBestChain;
+        m_balance_cache.m_generation = m_balance_generation;
+        m_balance_cache.m_mempool_updates = mempool_updates;
+    }
+
+    // The trusted and unconfirmed balances check IsFinalTx() against the
+    // adjusted time. When a coin has a time-based lock, they stay valid only
+    // for the second that they were calculated in:
+    const int64_t now = GetAdjustedTime();
+
+    if (m_balance_cache.m_time_locked && m_balance_cache.m_time != now) {
+        m_balance_cache.m_balance.reset();
+        m_balance_cache.m_unconfirmed.reset();
+        m_balance_cache.m_time_locked = false;
+    }
+
+    m_balance_cache.m_time = now;
+
+    return m_balance_cache;
 }
 
 bool CWallet::AddToWallet(const CWalletTx& wtxIn, CWalletDB* pwalletdb)
@@ -548,6 +637,8 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, CWalletDB* pwalletdb)
         if (fInsertedNew || fUpdated)
             if (!wtx.WriteToDisk(pwalletdb))
                 return false;
+
+        UpdateUnspent(wtx);
         if(!fQtActive)
         {
             // If default receiving address gets used, replace it with a new one
@@ -622,7 +713,14 @@ bool CWallet::EraseFromWallet(uint256 hash)
 {
     LOCK(cs_wallet);
 
-    return fFileBacked && mapWallet.erase(hash) && CWalletDB(strWalletFile).EraseTx(hash);
+    if (!fFileBacked || !mapWallet.erase(hash)) {
+        return false;
+    }
+
+    m_unspent_txs.erase(hash);
+    ++m_balance_generation;
+
+    return CWalletDB(strWalletFile).EraseTx(hash);
 }
 
 
@@ -1087,31 +1185,33 @@ bool CWalletTx::WriteToDisk(CWalletDB *pwalletdb)
 // exist in the wallet will be updated.
 int CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, bool fUpdate)
 {
-    int ret = 0;
+    std::vector<const CBlockIndex*> blocks;
+    size_t pruned_blocks = 0;
 
-    CBlockIndex* pindex = pindexStart;
     {
         LOCK2(cs_main, cs_wallet);
-        while (pindex)
+        for (const CBlockIndex* pindex = pindexStart; pindex; pindex = pindex->pnext)
         {
             // no need to read and scan block, if block was created before
             // our wallet birthday (as adjusted for block time variability)
             if (nTimeFirstKey && (pindex->nTime < (nTimeFirstKey - 7200))) {
-                pindex = pindex->pnext;
                 continue;
             }
 
-            CBlock block;
-            ReadBlockFromDisk(block, pindex, Params().GetConsensus());
-            for (auto const& tx : block.vtx)
-            {
-                if (AddToWalletIfInvolvingMe(tx, &block, fUpdate))
-                    ret++;
+            if (IsBlockPruned(pindex)) {
+                ++pruned_blocks;
+                continue;
             }
-            pindex = pindex->pnext;
+
+            blocks.push_back(pindex);
         }
     }
-    return ret;
+
+    if (pruned_blocks > 0) {
+        LogPrintf("WARNING: %s: skipped %u pruned blocks", __func__, pruned_blocks);
+    }
+
+    return wallet::Rescanner(*this, "ScanForWalletTransactions").Scan(std::move(blocks), fUpdate, nullptr, true);
 }
 
 // Scan the block chain (starting in pindexStart) for MRC request transactions.
@@ -1122,37 +1222,29 @@ int CWallet::ScanForWalletTransactions(CBlockIndex* pindexStart, bool fUpdate)
 // is very small, since a successful MRC request costs 0.011 GRC.
 int CWallet::ScanForMRCRequests(CBlockIndex* pindexStart, CBlockIndex* pindexEnd, bool fUpdate)
 {
-    int ret = 0;
+    std::vector<const CBlockIndex*> blocks;
 
     {
         LOCK2(cs_main, cs_wallet);
-        for(CBlockIndex* pindex = pindexStart; pindex && pindex->nHeight < pindexEnd->nHeight;)
+        for (const CBlockIndex* pindex = pindexStart; pindex && pindex->nHeight < pindexEnd->nHeight; pindex = pindex->pnext)
         {
             // no need to read and scan block, if block was created before
             // our wallet birthday (as adjusted for block time variability)
             if (nTimeFirstKey && (pindex->nTime < (nTimeFirstKey - 7200))) {
-                pindex = pindex->pnext;
                 continue;
             }
 
-            if (pindex->ResearchMRCSubsidy() > 0) {
-                // If at pindex there were MRC payment(s), then pindex->pprev there
-                // were MRC requests.
-                CBlock block;
-                ReadBlockFromDisk(block, pindex->pprev, Params().GetConsensus());
-                for (auto const& tx : block.vtx)
-                {
-                    if (!tx.GetContracts().empty()
-                            && tx.GetContracts()[0].m_type == GRC::ContractType::MRC
-                            && AddToWalletIfInvolvingMe(tx, &block, fUpdate))
-                        ret++;
-                }
+            // If at pindex there were MRC payment(s), then pindex->pprev there
+            // were MRC requests.
+            if (pindex->ResearchMRCSubsidy() > 0 && !IsBlockPruned(pindex->pprev)) {
+                blocks.push_back(pindex->pprev);
             }
-
-            pindex = pindex->pnext;
         }
     }
-    return ret;
+
+    return wallet::Rescanner(*this, "ScanForMRCRequests").Scan(std::move(blocks), fUpdate, [](const CTransaction& tx) {
+        return !tx.GetContracts().empty() && tx.GetContracts()[0].m_type == GRC::ContractType::MRC;
+    });
 }
 
 
@@ -1200,6 +1292,7 @@ void CWallet::ReacceptWalletTransactions()
                     CWalletDB walletdb(strWalletFile);
 
                     wtx.WriteToDisk(&walletdb);
+                    UpdateUnspent(wtx);
                 }
             }
             else
@@ -1420,50 +1513,77 @@ bool CWalletTx::RevalidateTransaction(CTxDB& txdb)
 
 int64_t CWallet::GetBalance() const
 {
-    int64_t nTotal = 0;
-    {
-        LOCK2(cs_main, cs_wallet);
-        for (map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
+    LOCK2(cs_main, cs_wallet);
+
+    BalanceCache& cache = GetBalanceCache();
+
+    if (!cache.m_balance) {
+        int64_t nTotal = 0;
+
+        for (const auto& hash : m_unspent_txs)
         {
-            const CWalletTx* pcoin = &it->second;
+            const CWalletTx* pcoin = &mapWallet.at(hash);
             if (pcoin->IsTrusted() && (pcoin->IsConfirmed() || pcoin->fFromMe))
                 nTotal += pcoin->GetAvailableCredit();
+            if (HasTimeLock(*pcoin))
+                cache.m_time_locked = true;
         }
+
+        cache.m_balance = nTotal;
     }
 
-    return nTotal;
+    return *cache.m_balance;
 }
 
 int64_t CWallet::GetUnconfirmedBalance() const
 {
-    int64_t nTotal = 0;
-    {
-        LOCK2(cs_main, cs_wallet);
-        for (map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
+    LOCK2(cs_main, cs_wallet);
+
+    BalanceCache& cache = GetBalanceCache();
+
+    if (!cache.m_unconfirmed) {
+        int64_t nTotal = 0;
+
+        for (const auto& hash : m_unspent_txs)
         {
-            const CWalletTx* pcoin = &it->second;
+            const CWalletTx* pcoin = &mapWallet.at(hash);
             if (!IsFinalTx(*pcoin) || (!pcoin->IsConfirmed() && !pcoin->fFromMe && pcoin->IsInMainChain())) {
                 nTotal += pcoin->GetAvailableCredit();
             }
+            if (HasTimeLock(*pcoin)) {
+                cache.m_time_locked = true;
+            }
         }
+
+        cache.m_unconfirmed = nTotal;
     }
-    return nTotal;
+
+    return *cache.m_unconfirmed;
 }
 
 int64_t CWallet::GetImmatureBalance() const
 {
-    int64_t nTotal = 0;
-    {
-        LOCK2(cs_main, cs_wallet);
-        for (map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
+    LOCK2(cs_main, cs_wallet);
+
+    BalanceCache& cache = GetBalanceCache();
+
+    if (!cache.m_immature) {
+        int64_t nTotal = 0;
+
+        // Immature outputs cannot be spent, so an immature coinbase with outputs
+        // that belong to the wallet always appears in the unspent set:
+        for (const auto& hash : m_unspent_txs)
         {
-            const CWalletTx& pcoin = it->second;
+            const CWalletTx& pcoin = mapWallet.at(hash);
             if (pcoin.IsCoinBase() && pcoin.GetBlocksToMaturity() > 0 && pcoin.IsInMainChain()) {
                 nTotal += GetCredit(pcoin);
             }
         }
+
+        cache.m_immature = nTotal;
     }
-    return nTotal;
+
+    return *cache.m_immature;
 }
 
 // populate vCoins with vector of spendable COutputs
@@ -1473,9 +1593,9 @@ void CWallet::AvailableCoins(vector<COutput>& vCoins, bool fOnlyConfirmed, const
 
     {
         LOCK2(cs_main, cs_wallet);
-        for (map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
+        for (const auto& hash : m_unspent_txs)
         {
-            const CWalletTx* pcoin = &it->second;
+            const CWalletTx* pcoin = &mapWallet.at(hash);
             int nDepth = pcoin->GetDepthInMainChain();
 
             if (!fIncludeStakedCoins) {
@@ -1505,7 +1625,7 @@ void CWallet::AvailableCoins(vector<COutput>& vCoins, bool fOnlyConfirmed, const
             for (unsigned int i = 0; i < pcoin->vout.size(); i++)
 			{
                 if ((!(pcoin->IsSpent(i)) && (IsMine(pcoin->vout[i]) != ISMINE_NO) && pcoin->vout[i].nValue >= nMinimumInputValue &&
-                     (!coinControl || !coinControl->HasSelected() || coinControl->IsSelected(it->first, i))) ||
+                     (!coinControl || !coinControl->HasSelected() || coinControl->IsSelected(hash, i))) ||
                     (fIncludeStakedCoins && pcoin->IsCoinStake() && pcoin->GetBlocksToMaturity() > 0 && pcoin->GetDepthInMainChain() > 0)) {
                     vCoins.push_back(COutput(pcoin, i, nDepth));
                 }
@@ -1514,13 +1634,41 @@ void CWallet::AvailableCoins(vector<COutput>& vCoins, bool fOnlyConfirmed, const
     }
 }
 
-// A lock must be taken on cs_main before calling this function.
-void CWallet::AvailableCoinsForStaking(vector<COutput>& vCoins, unsigned int nSpendTime, int64_t& balance_out) const EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+StakingChainView CWallet::GetStakingChainView() const EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    AssertLockHeld(cs_main);
+    LOCK(cs_wallet);
+
+    StakingChainView chain;
+
+    for (const auto& hash : m_unspent_txs)
+    {
+        const CWalletTx& wtx = mapWallet.at(hash);
+        StakingChainView::TxState state;
+        CBlockIndex* pindex = nullptr;
+
+        state.m_depth = wtx.GetDepthInMainChain(pindex);
+
+        // This is a slightly different standard than IsTrusted() for the balance, to include recently staked amounts:
+        state.m_trusted = state.m_depth > 0 || (wtx.fFromMe && (wtx.IsCoinStake() || wtx.AreDependenciesConfirmed()));
+
+        if (pindex) {
+            state.m_block_time = pindex->nTime;
+        }
+
+        chain.m_txs.emplace_hint(chain.m_txs.end(), hash, state);
+    }
+
+    return chain;
+}
+
+// The chain state comes from GetStakingChainView(), so this only needs cs_wallet.
+void CWallet::AvailableCoinsForStaking(vector<COutput>& vCoins, unsigned int nSpendTime, int64_t& balance_out,
+                                       const StakingChainView& chain) const
 {
 
     vCoins.clear();
     {
-        AssertLockHeld(cs_main);
         LOCK(cs_wallet);
 
         std::string function = __func__;
@@ -1529,23 +1677,28 @@ void CWallet::AvailableCoinsForStaking(vector<COutput>& vCoins, unsigned int nSp
         unsigned int transactions = 0;
         unsigned int txns_w_avail_outputs = 0;
 
-        for (const auto& it : mapWallet)
+        // Only transactions with unspent outputs that belong to the wallet can
+        // contribute to the balance or provide coins to stake:
+        for (const auto& hash : m_unspent_txs)
         {
-            const CWalletTx* pcoin = &it.second;
+            const CWalletTx* pcoin = &mapWallet.at(hash);
 
             // Track number of transactions processed for instrumentation purposes.
             ++transactions;
 
-            int nDepth = pcoin->GetDepthInMainChain();
+            const auto state = chain.m_txs.find(hash);
+
+            // The transaction arrived after the chain state was captured. It cannot be mature yet:
+            if (state == chain.m_txs.end()) continue;
+
+            const int nDepth = state->second.m_depth;
             std::vector<std::pair<const CWalletTx*, int>> possible_vCoins;
 
-            // Do the balance computation here after the GetDepthInMainChain() call.
-            // This avoids the expensive IsTrusted() and IsConfirmed() calls in the GetBalance() function, which each
-            // have a call to GetDepthInMainChain(). We also want to use a slightly different standard for the balance
-            // calculation here, to include recently staked amounts. The number here should be equal or very close to
-            // the "Total" field on the GUI overview screen. This is the proper number to use to be able to do the
-            // efficiency calculations.
-            if (nDepth > 0 || (pcoin->fFromMe && (pcoin->AreDependenciesConfirmed() || pcoin->IsCoinStake())))
+            // Do the balance computation here with the depth from the chain view. This avoids the expensive
+            // IsTrusted() and IsConfirmed() calls in the GetBalance() function, which each have a call to
+            // GetDepthInMainChain(). The number here should be equal or very close to the "Total" field on the GUI
+            // overview screen. This is the proper number to use to be able to do the efficiency calculations.
+            if (state->second.m_trusted)
             {
                 for (unsigned int i = 0; i < pcoin->vout.size(); ++i)
                 {
@@ -1559,16 +1712,14 @@ void CWallet::AvailableCoinsForStaking(vector<COutput>& vCoins, unsigned int nSp
                 }
             }
 
-            // If there are no possible (pre-qualified) outputs, continue, so we avoid the expensive GetDepthInMainChain()
-            // call.
+            // If there are no possible (pre-qualified) outputs, continue.
             if (possible_vCoins.empty()) continue;
 
             // Filtering by tx timestamp instead of block timestamp may give false positives but never false negatives
             if (pcoin->nTime + nStakeMinAge > nSpendTime) continue;
 
-            // We avoid GetBlocksToMaturity(), because that also calls GetDepthInMainChain(), so the older code,
-            // to get nDepth, still had to call GetDepthInMainChain(), so that meant it was called twice for EVERY
-            // every transaction in the wallet. Wasteful.
+            // We avoid GetBlocksToMaturity(), because that calls GetDepthInMainChain(), which needs cs_main. The
+            // depth from the chain view is enough.
             int blocks_to_maturity = 0;
 
             // If coinbase or coinstake, blocks_to_maturity must be 0. (This means a minimum depth of
@@ -1662,30 +1813,32 @@ static void ApproximateBestSubset(vector<pair<int64_t, pair<const CWalletTx*,uns
 // ppcoin: total coins staked (non-spendable until maturity)
 int64_t CWallet::GetStake() const
 {
-    int64_t nTotal = 0;
     LOCK2(cs_main, cs_wallet);
-    for (map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
-    {
-        const CWalletTx* pcoin = &it->second;
-        if (pcoin->IsCoinStake() && pcoin->GetBlocksToMaturity() > 0 && pcoin->GetDepthInMainChain() > 0) {
-            nTotal += CWallet::GetCredit(*pcoin);
+
+    BalanceCache& cache = GetBalanceCache();
+
+    if (!cache.m_stake) {
+        int64_t nTotal = 0;
+
+        // Immature stake outputs cannot be spent, so each immature coinstake of
+        // ours appears in the unspent set:
+        for (const auto& hash : m_unspent_txs)
+        {
+            const CWalletTx* pcoin = &mapWallet.at(hash);
+            if (pcoin->IsCoinStake() && pcoin->GetBlocksToMaturity() > 0 && pcoin->GetDepthInMainChain() > 0) {
+                nTotal += CWallet::GetCredit(*pcoin);
+            }
         }
+
+        cache.m_stake = nTotal;
     }
-    return nTotal;
+
+    return *cache.m_stake;
 }
 
 int64_t CWallet::GetNewMint() const
 {
-    int64_t nTotal = 0;
-    LOCK2(cs_main, cs_wallet);
-    for (map<uint256, CWalletTx>::const_iterator it = mapWallet.begin(); it != mapWallet.end(); ++it)
-    {
-        const CWalletTx* pcoin = &it->second;
-        if (pcoin->IsCoinStake() && pcoin->GetBlocksToMaturity() > 0 && pcoin->GetDepthInMainChain() > 0) {
-            nTotal += CWallet::GetCredit(*pcoin);
-        }
-    }
-    return nTotal;
+    return GetStake();
 }
 
 // This comparator is needed since std::sort alone cannot sort COutput
@@ -1879,7 +2032,8 @@ bool CWallet::SelectCoins(int64_t nTargetValue, unsigned int nSpendTime, set<pai
 bool CWallet::SelectCoinsForStaking(unsigned int nSpendTime, std::vector<pair<const CWalletTx*,unsigned int> >& vCoinsRet,
                                     GRC::MinerStatus::ErrorFlags& not_staking_error,
                                     int64_t& balance_out,
-                                    bool fMiner) const EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+                                    const StakingChainView& chain,
+                                    bool fMiner) const
 {
     std::string function = __func__;
     function += ": ";
@@ -1898,7 +2052,7 @@ bool CWallet::SelectCoinsForStaking(unsigned int nSpendTime, std::vector<pair<co
     // the balance_out as a by-product.
     // For that 210000 transaction wallet, all of these changes have reduced the time in the miner loop from >750 msec
     // down to < 450 msec.
-    AvailableCoinsForStaking(vCoins, nSpendTime, balance_out);
+    AvailableCoinsForStaking(vCoins, nSpendTime, balance_out, chain);
 
     int64_t BalanceToConsider = balance_out;
 
@@ -2316,6 +2470,7 @@ bool CWallet::CommitTransaction(CWalletTx& wtxNew, CReserveKey& reservekey)
                 coin.BindWallet(this);
                 coin.MarkSpent(txin.prevout.n);
                 coin.WriteToDisk(pwalletdb);
+                UpdateUnspent(coin);
                 NotifyTransactionChanged(this, coin.GetHash(), CT_UPDATED);
             }
 
@@ -2420,6 +2575,8 @@ DBErrors CWallet::LoadWallet(bool& fFirstRunRet)
         LOCK(cs_wallet);
 
         fFirstRunRet = !vchDefaultKey.IsValid();
+
+        RebuildUnspent();
     }
 
     NewThread(ThreadFlushWalletDB, &strWalletFile);
@@ -2866,6 +3023,7 @@ void CWallet::FixSpentCoins(int& nMismatchFound, int64_t& nBalanceInQuestion, bo
                 {
                     pcoin->MarkUnspent(n);
                     pcoin->WriteToDisk(&walletdb);
+                    UpdateUnspent(*pcoin);
                 }
             }
             else if ((IsMine(pcoin->vout[n]) != ISMINE_NO) && !pcoin->IsSpent(n) && (txindex.vSpent.size() > n && !txindex.vSpent[n].IsNull()))
@@ -2878,6 +3036,7 @@ void CWallet::FixSpentCoins(int& nMismatchFound, int64_t& nBalanceInQuestion, bo
                 {
                     pcoin->MarkSpent(n);
                     pcoin->WriteToDisk(&walletdb);
+                    UpdateUnspent(*pcoin);
                 }
             }
         }
@@ -2904,6 +3063,7 @@ void CWallet::DisableTransaction(const CTransaction &tx)
             {
                 prev.MarkUnspent(txin.prevout.n);
                 prev.WriteToDisk(&walletdb);
+                UpdateUnspent(prev);
             }
         }
     }
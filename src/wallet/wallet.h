@@ -6,6 +6,7 @@
 #ifndef BITCOIN_WALLET_WALLET_H
 #define BITCOIN_WALLET_WALLET_H
 
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -73,6 +74,25 @@ public:
     }
 };
 
+//!
+//! \brief Chain state of the unspent wallet transactions that staking coin
+//! selection needs.
+//!
+//! The stake miner captures the view under cs_main and then selects the coins
+//! while it holds cs_wallet only.
+//!
+struct StakingChainView
+{
+    struct TxState
+    {
+        int m_depth = 0;          //!< Depth in the main chain, -1 if neither in the chain nor the mempool.
+        bool m_trusted = false;   //!< Counts toward the staking balance.
+        int64_t m_block_time = 0; //!< Time of the main chain block that contains the transaction.
+    };
+
+    std::map<uint256, TxState> m_txs; //!< Keyed by transaction hash.
+};
+
 /** A CWallet is an extension of a keystore, which also maintains a set of transactions and balances,
  * and provides the ability to create new transactions.
  */
@@ -91,6 +111,63 @@ private:
     /* the HD chain data model (external chain counters) */
     CHDChain hdChain;
 
+    //!
+    //! \brief Hashes of the wallet transactions that have at least one output
+    //! which belongs to the wallet and is not spent yet.
+    //!
+    //! The balance and coin selection routines iterate over this set instead of
+    //! the entire mapWallet. A transaction without unspent outputs of ours does
+    //! not contribute to any of them. The wallet updates the set incrementally
+    //! whenever it adds, erases, or changes the spent state of a transaction.
+    //!
+    std::set<uint256> m_unspent_txs GUARDED_BY(cs_wallet);
+
+    //!
+    //! \brief Incremented on each change to the wallet that can affect one of
+    //! the balances.
+    //!
+    uint64_t m_balance_generation GUARDED_BY(cs_wallet) = 0;
+
+    //!
+    //! \brief Balances memoized for the chain tip, the wallet state and the
+    //! mempool state that they were calculated for.
+    //!
+    struct BalanceCache
+    {
+        uint256 m_tip;
+        uint64_t m_generation = 0;
+        uint64_t m_mempool_updates = 0; //!< Mempool update counter.
+        int64_t m_time = 0;             //!< Adjusted time of the last lookup.
+        bool m_time_locked = false;     //!< A coin has a time-based lock time.
+        std::optional<CAmount> m_balance;
+        std::optional<CAmount> m_unconfirmed;
+        std::optional<CAmount> m_immature;
+        std::optional<CAmount> m_stake;
+    };
+
+    mutable BalanceCache m_balance_cache GUARDED_BY(cs_wallet);
+
+    //!
+    //! \brief Get the memoized balances, reset if the chain tip, the wallet or
+    //! the mempool changed since the balances were calculated.
+    //!
+    //! The trusted and unconfirmed balances also reset when the adjusted time
+    //! changes if a coin has a time-based lock time, because IsFinalTx() then
+    //! depends on the time.
+    //!
+    BalanceCache& GetBalanceCache() const EXCLUSIVE_LOCKS_REQUIRED(cs_main, cs_wallet);
+
+    //!
+    //! \brief Add the transaction to or remove it from the unspent set based on
+    //! its current outputs and spent flags.
+    //!
+    void UpdateUnspent(const CWalletTx& wtx) EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
+    //!
+    //! \brief Recalculate the unspent set from the entire mapWallet.
+    //!
+    void RebuildUnspent() EXCLUSIVE_LOCKS_REQUIRED(cs_wallet);
+
 public:
     /// Main wallet lock.
     /// This lock protects all the fields added by CWallet
@@ -187,9 +264,16 @@ public:
         return wallet::IsFeatureSupported(nWalletVersion, wf);
     }
 
-    void AvailableCoinsForStaking(std::vector<COutput>& vCoins, unsigned int nSpendTime, int64_t& nBalanceOut) const;
+    //!
+    //! \brief Capture the depths and block times of the unspent wallet
+    //! transactions for staking coin selection.
+    //!
+    StakingChainView GetStakingChainView() const EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    void AvailableCoinsForStaking(std::vector<COutput>& vCoins, unsigned int nSpendTime, int64_t& nBalanceOut,
+                                  const StakingChainView& chain) const;
     bool SelectCoinsForStaking(unsigned int nSpendTime, std::vector<std::pair<const CWalletTx*,unsigned int> >& vCoinsRet,
-                               GRC::MinerStatus::ErrorFlags& not_staking_error, int64_t& balance_out, bool fMiner = false) const;
+                               GRC::MinerStatus::ErrorFlags& not_staking_error, int64_t& balance_out,
+                               const StakingChainView& chain, bool fMiner = false) const;
     void AvailableCoins(std::vector<COutput>& vCoins, bool fOnlyConfirmed = true, const CCoinControl* coinControl = nullptr,
                         bool fIncludeStakingCoins = false) const;
     bool SelectCoinsMinConf(int64_t nTargetValue, unsigned int nSpendTime, int nConfMine, int nConfTheirs, std::vector<COutput> vCoins,
@@ -243,6 +327,17 @@ public:
     TxItems OrderedTxItems(std::list<CAccountingEntry>& acentries, std::string strAccount = "");
 
     void MarkDirty();
+
+    //!
+    //! \brief Get the number of wallet transactions with outputs that belong to
+    //! the wallet and are not spent yet.
+    //!
+    size_t GetUnspentTxCount() const
+    {
+        LOCK(cs_wallet);
+        return m_unspent_txs.size();
+    }
+
     bool AddToWallet(const CWalletTx& wtxIn, CWalletDB *pwalletdb);
     bool AddToWalletIfInvolvingMe(const CTransaction& tx, const CBlock* pblock, bool fUpdate = false, bool fFindBlock = false);
     bool EraseFromWallet(uint256 hash);